@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 进程级内容寻址 Blob 存储
+ *
+ * 按内容哈希去重保存不可变字节缓冲：相同内容只保留一份，由各子系统（文件缓存、工具结果缓存、
+ * 项目结构缓存等）共享引用；最后一个引用释放时缓冲自动回收。
+ * 每次 intern 返回的句柄都会计入调用方声明的子系统，用于按子系统统计内存占用。
+ * 所有操作都是线程安全的。
+ */
+class BlobStore {
+public:
+    using Blob = std::shared_ptr<const std::string>;
+
+    /**
+     * @brief 单个子系统的引用统计
+     */
+    struct SubsystemStats {
+        size_t liveRefs{0};         // 存活句柄数
+        size_t referencedBytes{0};  // 句柄引用的字节数（共享缓冲按引用方各自计入）
+    };
+
+    /**
+     * @brief 存储统计
+     */
+    struct Stats {
+        size_t uniqueBlobs{0};        // 去重后的缓冲数
+        size_t uniqueBytes{0};        // 去重后实际占用的字节数
+        size_t referencedBytes{0};    // 所有句柄引用的字节数之和
+        size_t dedupHits{0};          // intern 命中已有缓冲的次数
+        std::map<std::string, SubsystemStats> subsystems;
+
+        /**
+         * @brief 去重节省的字节数
+         */
+        size_t savedBytes() const { return referencedBytes > uniqueBytes ? referencedBytes - uniqueBytes : 0; }
+
+        nlohmann::json toJson() const;
+    };
+
+    BlobStore();
+    ~BlobStore() = default;
+
+    BlobStore(const BlobStore&) = delete;
+    BlobStore& operator=(const BlobStore&) = delete;
+
+    /**
+     * @brief 获取进程级共享实例
+     */
+    static BlobStore& shared();
+
+    /**
+     * @brief 保存内容并返回共享句柄（已有相同内容时复用已有缓冲，content 被丢弃）
+     * @param content 内容（按值传入，未命中时直接移动进存储）
+     * @param subsystem 计入的子系统名称
+     */
+    Blob intern(std::string content, std::string_view subsystem);
+
+    /**
+     * @brief 同 intern，但只在未命中时才复制内容
+     */
+    Blob internView(std::string_view content, std::string_view subsystem);
+
+    /**
+     * @brief 获取统计信息
+     */
+    Stats getStats() const;
+
+private:
+    struct Counters {
+        std::atomic<size_t> liveRefs{0};
+        std::atomic<size_t> referencedBytes{0};
+    };
+
+    struct Impl {
+        mutable std::mutex mutex;
+        // 内容哈希 -> 缓冲（哈希冲突时同一桶内保存多个，命中时比较内容）
+        std::unordered_map<size_t, std::vector<std::weak_ptr<const std::string>>> buckets;
+        std::map<std::string, Counters, std::less<>> subsystems;  // 节点地址稳定，句柄直接持有计数器指针
+        std::atomic<size_t> uniqueBlobs{0};
+        std::atomic<size_t> uniqueBytes{0};
+        std::atomic<size_t> dedupHits{0};
+        std::atomic<size_t> releasedSinceSweep{0};
+    };
+
+    std::shared_ptr<Impl> m_impl;
+
+    Blob lookupLocked(size_t hash, std::string_view content) const;
+    Blob insertLocked(size_t hash, std::string content);
+    Blob makeLease(Blob master, std::string_view subsystem);
+    void sweepLocked();
+};
+
+} // namespace naw::desktop_pet::service
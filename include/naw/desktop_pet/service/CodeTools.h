@@ -2,6 +2,8 @@
 
 #include "naw/desktop_pet/service/ToolManager.h"
 
+#include <atomic>
+
 namespace naw::desktop_pet::service {
 
 // 前向声明
@@ -21,6 +23,14 @@ public:
      */
     static void registerAllTools(ToolManager& toolManager);
 
+    /**
+     * @brief 预热 get_project_structure 的白名单与结构缓存（默认参数）
+     * @param projectRoot 项目根路径
+     * @param cancel 取消标志（可为空）；扫描时逐目录检查，被取消时不写入缓存
+     * @return 成功构建（或命中）缓存返回 true
+     */
+    static bool prewarmProjectStructure(const std::string& projectRoot, const std::atomic<bool>* cancel = nullptr);
+
 private:
     /**
      * @brief 注册 read_file 工具
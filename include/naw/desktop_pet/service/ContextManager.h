@@ -11,6 +11,7 @@
 // 前向声明
 namespace naw::desktop_pet::service {
     class APIClient;
+    class ProjectContextCollector;
 }
 
 #include <chrono>
@@ -36,6 +37,7 @@ struct ProjectContext {
     std::string projectRoot;      // 项目根路径
     std::string structureSummary; // 项目结构摘要
     std::vector<std::string> relevantFiles;  // 相关文件列表
+    std::string relevantCode;     // 按Token预算打包的相关代码片段（可选）
 };
 
 // 代码上下文结构
@@ -64,6 +66,8 @@ struct ContextConfig {
     bool includeMemoryEvents{false};        // 是否包含记忆事件
     size_t maxHistoryMessages{50};          // 最大历史消息数
     std::optional<std::string> projectPath;  // 项目路径（可选，如果为空则自动检测）
+    size_t contextSnippetTokens{1024};      // 项目/代码上下文片段的Token预算（0表示不注入代码片段）
+    bool warmStartProject{true};            // 配置了 projectPath 时在启动阶段后台预热项目分析
 };
 
 /**
@@ -182,6 +186,25 @@ public:
      */
     types::ChatMessage buildCodeContext(const CodeContext& codeContext) const;
 
+    /**
+     * @brief 构建代码上下文（按Token预算打包）
+     *
+     * 将 filePaths 和 fileContent 切分为函数/类级片段，按与 query 的相关性排序，
+     * 在 tokenBudget 内选取片段，代替整文件注入。
+     *
+     * @param codeContext 代码上下文
+     * @param query 用户问题（用于相关性排序）
+     * @param modelId 模型ID（用于Token估算）
+     * @param tokenBudget 片段Token预算
+     * @return 代码上下文消息
+     */
+    types::ChatMessage buildCodeContext(
+        const CodeContext& codeContext,
+        const std::string& query,
+        const std::string& modelId,
+        size_t tokenBudget
+    ) const;
+
     /**
      * @brief 构建记忆事件上下文
      * @param events 记忆事件列表
@@ -276,6 +299,19 @@ public:
      */
     ContextConfig getConfig() const { return m_config; }
 
+    // ========== 项目预热 ==========
+
+    /**
+     * @brief 按当前配置的 projectPath 启动项目后台预热
+     * @return 启动了新的预热返回 true（未配置路径、已关闭预热或已在预热时返回 false）
+     */
+    bool startProjectWarmup();
+
+    /**
+     * @brief 获取项目预热进度（JSON：state/stage/partial_available/files_total/files_indexed/elapsed_ms）
+     */
+    nlohmann::json getProjectWarmupStatus() const;
+
     // ========== 工具与LLM集成 ==========
 
     /**
@@ -319,6 +355,9 @@ private:
     // 工具管理器（可选，用于Function Calling）
     ToolManager* m_toolManager{nullptr};
 
+    // 项目上下文收集器（跨请求复用，保留文件缓存和依赖图）
+    std::unique_ptr<ProjectContextCollector> m_projectCollector;
+
     // 内部方法
     /**
      * @brief 获取或创建会话历史
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "naw/desktop_pet/service/FileContentCache.h"
+#include "naw/desktop_pet/service/ProjectDependencyGraph.h"
+#include "naw/desktop_pet/service/utils/TokenCounter.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 代码片段（函数/类级切片）
+ */
+struct ContextSnippet {
+    std::string filePath;     // 所属文件
+    size_t startLine{0};      // 起始行号（从1开始）
+    size_t endLine{0};        // 结束行号（包含）
+    std::string symbol;       // 函数/类名（可能为空）
+    std::string text;         // 片段内容
+    double score{0.0};        // 相关性评分
+    size_t tokens{0};         // 渲染后的Token数
+};
+
+/**
+ * @brief 打包器配置
+ */
+struct ContextPackerConfig {
+    size_t tokenBudget{1024};           // Token预算
+    double dependencyWeight{0.4};       // 依赖距离权重
+    double recencyWeight{0.2};          // 最近编辑权重
+    double lexicalWeight{0.4};          // 词法相似度权重
+    double recencyHalfLifeHours{24.0};  // 最近编辑评分的半衰时间（小时）
+    int maxDependencyDepth{2};          // 依赖图搜索深度
+    size_t maxScannedFiles{256};        // 词法初筛时最多读取内容的候选文件数（先按路径词项与依赖/最近编辑排序）
+    size_t maxCandidateFiles{64};       // 词法初筛后参与切片评分的候选文件数
+    size_t maxSnippetLines{80};         // 单个片段最大行数（超出则拆分）
+};
+
+/**
+ * @brief 打包结果
+ */
+struct PackedContext {
+    std::vector<ContextSnippet> snippets;  // 选中的片段（按文件、行号排序）
+    size_t totalTokens{0};                 // 选中片段的Token总数
+    size_t candidateSnippets{0};           // 参与排序的片段数
+
+    bool empty() const { return snippets.empty(); }
+
+    /**
+     * @brief 渲染为注入上下文的文本
+     */
+    std::string render() const;
+
+    /**
+     * @brief 选中片段涉及的文件（去重，保持顺序）
+     */
+    std::vector<std::string> files() const;
+};
+
+/**
+ * @brief 按Token预算打包相关代码片段
+ *
+ * 将候选文件切分为函数/类级片段，按 依赖距离、最近编辑时间、与用户问题的词法相似度
+ * 加权评分，再用 TokenEstimator 精确计数，在预算内贪心选取评分最高的片段。
+ */
+class ContextPacker {
+public:
+    /**
+     * @brief 待打包的文档
+     */
+    struct Document {
+        std::string path;                              // 文件路径（用于显示）
+        std::shared_ptr<const std::string> content;    // 文件内容
+        double dependencyScore{0.0};                   // 依赖距离评分（0-1）
+        double recencyScore{0.0};                      // 最近编辑评分（0-1）
+    };
+
+    /**
+     * @brief 构造函数
+     * @param estimator Token估算器（需在打包器生命周期内有效）
+     * @param modelId 模型ID（用于Token估算）
+     * @param config 打包配置
+     * @param fileCache 文件内容缓存（为空时使用 FileContentCache::shared()）
+     */
+    ContextPacker(
+        const utils::TokenEstimator& estimator,
+        std::string modelId,
+        ContextPackerConfig config = {},
+        std::shared_ptr<FileContentCache> fileCache = nullptr
+    );
+
+    /**
+     * @brief 从候选文件中打包相关片段
+     * @param query 用户问题（用于词法相似度）
+     * @param candidateFiles 候选文件
+     * @param anchorFiles 锚点文件（依赖距离为0，例如当前编辑/提及的文件）
+     * @param graph 依赖图（可选，用于计算依赖距离）
+     * @return 打包结果
+     */
+    PackedContext packFiles(
+        const std::string& query,
+        const std::vector<std::string>& candidateFiles,
+        const std::vector<std::string>& anchorFiles = {},
+        const ProjectDependencyGraph* graph = nullptr
+    ) const;
+
+    /**
+     * @brief 从已加载的文档中打包相关片段
+     * @param query 用户问题
+     * @param documents 文档列表（评分由调用方提供）
+     * @return 打包结果
+     */
+    PackedContext pack(const std::string& query, const std::vector<Document>& documents) const;
+
+    /**
+     * @brief 将文件内容切分为函数/类级片段
+     * @param filePath 文件路径（用于判断语言）
+     * @param content 文件内容
+     * @param maxSnippetLines 单个片段最大行数
+     * @return 片段列表（未评分）
+     */
+    static std::vector<ContextSnippet> extractSlices(
+        const std::string& filePath,
+        const std::string& content,
+        size_t maxSnippetLines
+    );
+
+    /**
+     * @brief 提取文本中的标识符词项（小写，拆分驼峰/下划线，去除常见关键字）
+     */
+    static std::vector<std::string> tokenizeTerms(const std::string& text);
+
+    /**
+     * @brief 找出用户问题中提到的文件（按文件名或文件主干名匹配）
+     */
+    static std::vector<std::string> findMentionedFiles(
+        const std::string& query,
+        const std::vector<std::string>& candidateFiles
+    );
+
+    const ContextPackerConfig& getConfig() const { return m_config; }
+
+private:
+    const utils::TokenEstimator& m_estimator;
+    std::string m_modelId;
+    ContextPackerConfig m_config;
+    std::shared_ptr<FileContentCache> m_fileCache;
+
+    double recencyScore(const std::string& filePath) const;
+    static std::string renderSnippet(const ContextSnippet& snippet);
+};
+
+} // namespace naw::desktop_pet::service
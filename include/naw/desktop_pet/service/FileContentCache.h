@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 按字节预算的文件内容缓存（LRU）
+ *
+ * 以 路径 + 修改时间 + 文件大小 作为有效性判断，总字节数超过预算时按 LRU 淘汰。
+ * 文件读取在锁外进行；多个线程同时请求同一文件时只读取一次，其余线程等待该结果。
+ * 内容以 std::shared_ptr<const std::string> 返回，调用方与缓存共享同一块缓冲区，
+ * 被淘汰的条目在最后一个持有者释放后才真正释放。
+ *
+ * 可以通过 shared() 获取进程内共享实例，供 ProjectContextCollector 和代码工具共用。
+ * 写入文件的一方通过 notifyFileChanged() 通知变更，其他持有派生数据（如依赖图）的组件
+ * 可以用 addChangeListener() 订阅。
+ */
+class FileContentCache {
+public:
+    using Content = std::shared_ptr<const std::string>;
+    using ChangeListener = std::function<void(const std::string& filePath)>;
+
+    /**
+     * @brief 缓存统计信息
+     */
+    struct Stats {
+        size_t entryCount{0};   // 条目数
+        size_t totalBytes{0};   // 当前占用字节数
+        size_t maxBytes{0};     // 字节预算
+        uint64_t hits{0};       // 命中次数
+        uint64_t misses{0};     // 未命中（实际读取）次数
+        uint64_t evictions{0};  // 淘汰次数
+    };
+
+    static constexpr size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024; // 默认 64MB
+
+    /**
+     * @brief 构造函数
+     * @param maxBytes 字节预算（超过预算的单个文件不缓存，但仍会返回内容）
+     */
+    explicit FileContentCache(size_t maxBytes = DEFAULT_MAX_BYTES);
+    ~FileContentCache() = default;
+
+    // 禁止拷贝/移动（因为包含mutex）
+    FileContentCache(const FileContentCache&) = delete;
+    FileContentCache& operator=(const FileContentCache&) = delete;
+    FileContentCache(FileContentCache&&) = delete;
+    FileContentCache& operator=(FileContentCache&&) = delete;
+
+    /**
+     * @brief 获取文件内容（带缓存）
+     * @param filePath 文件路径
+     * @return 文件内容（原始字节）；文件不存在或读取失败返回 nullptr
+     */
+    Content get(const std::string& filePath);
+
+    /**
+     * @brief 获取已缓存条目记录的修改时间（不访问文件系统）
+     * @return 未缓存时返回 std::nullopt
+     */
+    std::optional<std::filesystem::file_time_type> cachedModifyTime(const std::string& filePath) const;
+
+    /**
+     * @brief 使指定文件的缓存失效
+     */
+    void invalidate(const std::string& filePath);
+
+    /**
+     * @brief 使目录下所有文件的缓存失效（按路径前缀匹配，共享实例上只清理调用方关心的部分）
+     */
+    void invalidateUnder(const std::string& directory);
+
+    /**
+     * @brief 通知文件已被修改/创建/删除：使缓存失效并回调所有监听者
+     *
+     * 监听者在本函数内同步调用（持有监听者锁），因此回调中不能再注册/注销监听者。
+     */
+    void notifyFileChanged(const std::string& filePath);
+
+    /**
+     * @brief 注册文件变更监听者
+     * @return 监听者ID（用于注销）
+     */
+    size_t addChangeListener(ChangeListener listener);
+
+    /**
+     * @brief 注销文件变更监听者（返回后不会再被回调）
+     */
+    void removeChangeListener(size_t listenerId);
+
+    /**
+     * @brief 清空缓存（统计计数保留）
+     */
+    void clear();
+
+    /**
+     * @brief 设置字节预算（立即按 LRU 淘汰到预算以内）
+     */
+    void setMaxBytes(size_t maxBytes);
+
+    /**
+     * @brief 设置字节预算（MB）
+     */
+    void setMaxMegabytes(size_t maxMegabytes) { setMaxBytes(maxMegabytes * 1024 * 1024); }
+
+    /**
+     * @brief 获取字节预算
+     */
+    size_t getMaxBytes() const;
+
+    /**
+     * @brief 获取统计信息
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief 获取进程内共享实例
+     */
+    static std::shared_ptr<FileContentCache> shared();
+
+private:
+    struct Entry {
+        Content content;
+        std::filesystem::file_time_type modifyTime{};
+        uintmax_t fileSize{0};
+        std::list<std::string>::iterator lruIt;
+    };
+
+    // 正在读取中的文件（用于合并并发请求）
+    struct InFlight {
+        std::filesystem::file_time_type modifyTime{};
+        uintmax_t fileSize{0};
+        std::shared_future<Content> future;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::unordered_map<std::string, InFlight> m_inFlight;
+    std::list<std::string> m_lru;  // 前端为最近使用
+    size_t m_totalBytes{0};
+    size_t m_maxBytes;
+    uint64_t m_hits{0};
+    uint64_t m_misses{0};
+    uint64_t m_evictions{0};
+
+    std::mutex m_listenerMutex;
+    std::map<size_t, ChangeListener> m_listeners;
+    size_t m_nextListenerId{1};
+
+    static Content readFile(const std::string& filePath);
+
+    void insertLocked(const std::string& key, Content content,
+                      std::filesystem::file_time_type modifyTime, uintmax_t fileSize);
+    void eraseLocked(const std::string& key);
+    void evictLocked();
+};
+
+} // namespace naw::desktop_pet::service
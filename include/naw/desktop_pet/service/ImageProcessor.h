@@ -2,12 +2,15 @@
 
 #include "naw/desktop_pet/service/types/ImageData.h"
 
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <vector>
 
 namespace naw::desktop_pet::service {
 
+struct VisionLayer0Result;
+
 /**
  * @brief 图像处理工具类
  * 
@@ -37,6 +40,109 @@ public:
         bool adaptive{false};                  // 是否启用自适应分辨率
     };
 
+    /**
+     * @brief 信箱缩放结果（保持宽高比缩放后居中放入固定尺寸画布）
+     */
+    struct LetterboxResult {
+        types::ImageData image;  // 画布（targetWidth x targetHeight）
+        double scale{1.0};       // 源图像到画布的缩放比例
+        uint32_t padX{0};        // 缩放图像在画布中的左边距
+        uint32_t padY{0};        // 缩放图像在画布中的上边距
+    };
+
+    /**
+     * @brief 活动区域裁剪配置
+     */
+    struct RegionCropConfig {
+        double marginRatio{0.15};        // 区域向外扩展的比例（保留周围的上下文）
+        uint32_t minMargin{24};          // 最小扩展像素
+        uint32_t minCropSize{128};       // 裁剪区域最小边长（过小的区域向外扩展）
+        uint32_t maxCrops{4};            // 最多输出的裁剪数（超出时合并代价最小的两块）
+        double fullFrameRatio{0.6};      // 裁剪总面积超过该比例时改为整帧
+        ResolutionConfig resolution;     // 每块裁剪的分辨率控制（未设置时保持原尺寸）
+    };
+
+    /**
+     * @brief 单块裁剪
+     */
+    struct RegionCrop {
+        types::Rect region;              // 在源图像中的区域
+        types::ImageData image;          // 裁剪（并按分辨率控制缩放）后的图像
+        size_t estimatedTokens{0};       // 估计的视觉输入 token 数
+    };
+
+    /**
+     * @brief 活动区域裁剪结果
+     */
+    struct RegionCropResult {
+        std::vector<RegionCrop> crops;   // 裁剪列表（按从上到下、从左到右排列）
+        size_t totalTokens{0};           // 各块 token 估计之和
+        size_t fullFrameTokens{0};       // 发送整帧时的 token 估计（用于比较）
+        bool fullFrame{false};           // 是否退化为整帧
+    };
+
+    /**
+     * @brief 编码格式
+     */
+    enum class EncodeFormat {
+        JPEG,
+        PNG,
+        WebP
+    };
+
+    /**
+     * @brief 编码选项
+     */
+    struct EncodeOptions {
+        EncodeFormat format{EncodeFormat::JPEG};
+        int quality{85};       // JPEG/WebP 质量（1-100）；PNG 为压缩级别（0-9）
+        size_t maxBytes{0};    // 字节预算（0表示不限制；PNG 为无损编码，忽略预算）
+        int minQuality{20};    // 按预算降低质量时的下限
+    };
+
+    /**
+     * @brief 编码结果
+     */
+    struct EncodeResult {
+        size_t bytes{0};          // 编码后的字节数
+        int quality{0};           // 实际使用的质量
+        int attempts{0};          // 编码次数（按预算搜索质量时大于1）
+        bool withinBudget{true};  // 是否满足字节预算（最低质量仍超出时为 false，结果为最低质量的编码）
+    };
+
+    /**
+     * @brief 编码到调用方提供的缓冲（复用其容量，连续截图时不再每帧分配）
+     *
+     * 设置了字节预算且按请求质量编码超出时，在 [minQuality, quality) 内二分查找
+     * 满足预算的最高质量。
+     * @param image 输入图像视图
+     * @param options 编码选项
+     * @param out 输出缓冲（内容被替换）
+     * @return 编码结果，失败返回 std::nullopt
+     */
+    static std::optional<EncodeResult> encode(
+        const types::ImageView& image,
+        const EncodeOptions& options,
+        std::vector<uint8_t>& out
+    );
+
+    /**
+     * @brief 编码为 data URL（data:image/<fmt>;base64,...），Base64 直接写入 out
+     *
+     * 编码字节放在线程内复用的缓冲中，不产生中间的字节数组和 Base64 字符串，
+     * out 的容量在多次调用间复用。
+     */
+    static std::optional<EncodeResult> encodeToDataUrl(
+        const types::ImageView& image,
+        const EncodeOptions& options,
+        std::string& out
+    );
+
+    /**
+     * @brief 编码格式对应的 MIME 类型（如 image/jpeg）
+     */
+    static const char* mimeType(EncodeFormat format);
+
     /**
      * @brief 压缩为 JPEG 格式
      * @param image 输入图像数据
@@ -48,6 +154,14 @@ public:
         int quality = 85
     );
 
+    /**
+     * @brief 压缩为 JPEG 格式（零拷贝视图输入，支持带padding的行步长）
+     */
+    static std::optional<std::vector<uint8_t>> compressToJPEG(
+        const types::ImageView& image,
+        int quality = 85
+    );
+
     /**
      * @brief 压缩为 PNG 格式
      * @param image 输入图像数据
@@ -59,6 +173,25 @@ public:
         int compressionLevel = 3
     );
 
+    /**
+     * @brief 压缩为 PNG 格式（零拷贝视图输入）
+     */
+    static std::optional<std::vector<uint8_t>> compressToPNG(
+        const types::ImageView& image,
+        int compressionLevel = 3
+    );
+
+    /**
+     * @brief 从文件读取图像（PNG/JPEG/BMP 等 OpenCV 支持的格式）
+     * @param path 文件路径
+     * @param format 目标图像格式（默认 BGR）
+     * @return 图像数据，失败返回 std::nullopt
+     */
+    static std::optional<types::ImageData> loadFromFile(
+        const std::string& path,
+        types::ImageFormat format = types::ImageFormat::BGR
+    );
+
     /**
      * @brief 缩放图像到指定分辨率
      * @param image 输入图像数据
@@ -74,6 +207,16 @@ public:
         InterpolationMethod method = InterpolationMethod::Linear
     );
 
+    /**
+     * @brief 缩放图像到指定分辨率（零拷贝视图输入，结果直接写入返回的 ImageData）
+     */
+    static std::optional<types::ImageData> resize(
+        const types::ImageView& image,
+        uint32_t targetWidth,
+        uint32_t targetHeight,
+        InterpolationMethod method = InterpolationMethod::Linear
+    );
+
     /**
      * @brief 保持宽高比缩放图像
      * @param image 输入图像数据
@@ -89,6 +232,36 @@ public:
         InterpolationMethod method = InterpolationMethod::Linear
     );
 
+    /**
+     * @brief 保持宽高比缩放图像（零拷贝视图输入，可直接传入 subView 裁剪的区域）
+     */
+    static std::optional<types::ImageData> resizeKeepAspectRatio(
+        const types::ImageView& image,
+        uint32_t targetWidth,
+        uint32_t targetHeight,
+        InterpolationMethod method = InterpolationMethod::Linear
+    );
+
+    /**
+     * @brief 信箱缩放（检测模型输入预处理）
+     *
+     * 按 resizeKeepAspectRatio 的规则缩放后居中放入 targetWidth x targetHeight 的画布，
+     * 空白处填充 padValue，并转换为指定格式。
+     * @param image 输入图像视图
+     * @param targetWidth 画布宽度
+     * @param targetHeight 画布高度
+     * @param format 画布像素格式（默认 BGR）
+     * @param padValue 填充值（默认114，与 YOLO 训练时一致）
+     * @return 画布与坐标映射参数，失败返回 std::nullopt
+     */
+    static std::optional<LetterboxResult> letterbox(
+        const types::ImageView& image,
+        uint32_t targetWidth,
+        uint32_t targetHeight,
+        types::ImageFormat format = types::ImageFormat::BGR,
+        uint8_t padValue = 114
+    );
+
     /**
      * @brief 缩放并裁剪到指定尺寸
      * @param image 输入图像数据
@@ -104,6 +277,65 @@ public:
         InterpolationMethod method = InterpolationMethod::Linear
     );
 
+    /**
+     * @brief 缩放并裁剪到指定尺寸（零拷贝视图输入）
+     */
+    static std::optional<types::ImageData> resizeAndCrop(
+        const types::ImageView& image,
+        uint32_t targetWidth,
+        uint32_t targetHeight,
+        InterpolationMethod method = InterpolationMethod::Linear
+    );
+
+    /**
+     * @brief 估计一张图像的视觉输入 token 数
+     *
+     * 采用 OpenAI 兼容接口的高细节计费规则：先缩放到 2048x2048 以内，再把短边缩放到
+     * 不超过 768，按 512x512 的图块计数，每块 170 token 另加 85 的基础开销。
+     */
+    static size_t estimateImageTokens(uint32_t width, uint32_t height);
+
+    /**
+     * @brief 规划活动区域的裁剪范围（不生成图像）
+     *
+     * 区域按比例向外扩展并保证最小尺寸；重叠的区域、以及合并后 token 不多于分开发送的区域
+     * 会被合并；超过 maxCrops 时合并 token 增量最小的两块。总面积或总 token 超过整帧时
+     * 返回整帧。
+     * @param regions 活动区域（源图像坐标）
+     * @param frameWidth 源图像宽度
+     * @param frameHeight 源图像高度
+     * @param config 裁剪配置
+     * @return 裁剪区域（源图像坐标）；没有有效区域时返回空
+     */
+    static std::vector<types::Rect> planRegionCrops(
+        const std::vector<types::Rect>& regions,
+        uint32_t frameWidth,
+        uint32_t frameHeight,
+        const RegionCropConfig& config
+    );
+
+    /**
+     * @brief 按活动区域裁剪图像（只把有变化的部分发给视觉模型，减少输入 token）
+     * @param image 源图像视图
+     * @param regions 活动区域（源图像坐标）
+     * @param config 裁剪配置
+     * @return 裁剪结果；没有有效区域时 crops 为空，由调用方决定是否发送整帧
+     */
+    static RegionCropResult cropActiveRegions(
+        const types::ImageView& image,
+        const std::vector<types::Rect>& regions,
+        const RegionCropConfig& config
+    );
+
+    /**
+     * @brief 按 Layer 0 的变化/运动区域裁剪图像（区域从处理分辨率映射回源图像坐标）
+     */
+    static RegionCropResult cropActiveRegions(
+        const types::ImageView& image,
+        const VisionLayer0Result& layer0,
+        const RegionCropConfig& config
+    );
+
     /**
      * @brief 根据配置计算最优分辨率
      * @param currentWidth 当前宽度
@@ -145,20 +377,23 @@ public:
 
 private:
     /**
-     * @brief 将 ImageData 转换为 OpenCV Mat
-     * @param image 输入图像数据
-     * @return OpenCV Mat 对象，失败返回空 Mat
+     * @brief 将图像视图包装为 OpenCV Mat（不复制数据，按视图的行步长访问）
+     * @param image 输入图像视图
+     * @param outMat 输出 Mat（通过指针传递），引用调用方缓冲，只能只读使用
+     * @param toOpenCVOrder 为 true 时把 RGB/RGBA 转换为 OpenCV 的 BGR/BGRA（此时会生成新缓冲）
      */
-    static void imageDataToMat(const types::ImageData& image, void* outMat);
+    static void imageDataToMat(const types::ImageView& image, void* outMat, bool toOpenCVOrder);
 
     /**
-     * @brief 将 OpenCV Mat 转换为 ImageData
-     * @param mat OpenCV Mat 对象（通过指针传递）
+     * @brief 将 OpenCV Mat 转换为 ImageData（通道转换直接写入结果缓冲，一次完成）
+     * @param mat OpenCV Mat 对象（通过指针传递，可以是非连续的 ROI）
+     * @param matFormat Mat 中像素的实际格式
      * @param format 目标图像格式
      * @return ImageData 对象，失败返回 std::nullopt
      */
     static std::optional<types::ImageData> matToImageData(
         const void* mat,
+        types::ImageFormat matFormat,
         types::ImageFormat format
     );
 
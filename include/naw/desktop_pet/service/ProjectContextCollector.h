@@ -2,12 +2,18 @@
 
 #include "naw/desktop_pet/service/ErrorTypes.h"
 #include "naw/desktop_pet/service/ContextManager.h"
+#include "naw/desktop_pet/service/FileContentCache.h"
+#include "naw/desktop_pet/service/ProjectDependencyGraph.h"
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <filesystem>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -29,6 +35,38 @@ struct ProjectInfo {
     std::vector<std::string> dependencies;           // 依赖列表
     std::optional<std::string> directoryStructure;  // 目录结构树（可选，字符串格式）
     std::unordered_map<std::string, std::string> fileContents;  // 文件内容缓存
+    std::shared_ptr<ProjectDependencyGraph> dependencyGraph;    // include 依赖图（可选，由 analyzeProject 构建）
+    bool partial{false};                             // 预热中途发布的部分结果：只有文件列表，尚无依赖图与目录结构
+};
+
+/**
+ * @brief 后台预热状态
+ */
+enum class WarmupState {
+    Idle,       // 未启动
+    Warming,    // 预热中（可能已有部分结果）
+    Ready,      // 预热完成
+    Failed,     // 预热失败
+    Cancelled   // 已取消
+};
+
+/**
+ * @brief 后台预热进度
+ */
+struct ProjectWarmupStatus {
+    WarmupState state{WarmupState::Idle};
+    std::string projectRoot;        // 预热的项目根路径（绝对路径）
+    std::string stage;              // 当前阶段：cmake_model / file_scan / project_structure / dependency_graph / content_index
+    bool partialAvailable{false};   // 是否已发布可用的部分结果（文件列表）
+    size_t filesTotal{0};           // 源文件+头文件总数
+    size_t filesIndexed{0};         // 已预读到内容缓存的文件数
+    double elapsedMs{0.0};          // 已耗时（毫秒）
+    std::string error;              // 失败原因
+
+    /**
+     * @brief 转换为JSON格式
+     */
+    nlohmann::json toJson() const;
 };
 
 /**
@@ -40,8 +78,18 @@ struct ProjectInfo {
  */
 class ProjectContextCollector {
 public:
-    ProjectContextCollector() = default;
-    ~ProjectContextCollector() = default;
+    /**
+     * @brief 构造函数（使用独立的文件内容缓存）
+     */
+    ProjectContextCollector();
+
+    /**
+     * @brief 构造函数
+     * @param fileCache 文件内容缓存（可传入 FileContentCache::shared() 与代码工具共享；为空时创建独立缓存）
+     */
+    explicit ProjectContextCollector(std::shared_ptr<FileContentCache> fileCache);
+
+    ~ProjectContextCollector();
 
     // 禁止拷贝/移动（因为包含mutex）
     ProjectContextCollector(const ProjectContextCollector&) = delete;
@@ -66,6 +114,37 @@ public:
      */
     ProjectInfo analyzeProject(const std::string& projectRoot, ErrorInfo* error = nullptr);
 
+    // ========== 后台预热 ==========
+
+    /**
+     * @brief 启动后台预热（低优先级线程）
+     *
+     * 依次构建 CMake 项目模型、文件列表、项目结构缓存、依赖图，并预读源文件到内容缓存。
+     * 预热期间 analyzeProject 对同一项目直接返回已发布的部分结果（ProjectInfo::partial 为 true），
+     * 不再重复全量扫描；预热完成后复用预热得到的文件列表与目录结构，直到出现新文件或结果过期。
+     *
+     * @param projectRoot 项目根路径
+     * @return 启动了新的预热返回 true；同一项目已在预热或已完成时返回 false
+     */
+    bool startWarmup(const std::string& projectRoot);
+
+    /**
+     * @brief 获取预热进度
+     */
+    ProjectWarmupStatus getWarmupStatus() const;
+
+    /**
+     * @brief 等待预热结束（完成、失败或取消）
+     * @param timeout 最长等待时间
+     * @return 在超时前结束返回 true
+     */
+    bool waitForWarmup(std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief 取消预热并等待后台线程退出
+     */
+    void cancelWarmup();
+
     /**
      * @brief 解析 CMakeLists.txt 文件
      * @param cmakePath CMakeLists.txt 文件路径
@@ -91,6 +170,9 @@ public:
 
     /**
      * @brief 从源码文件中提取 include 依赖
+     *
+     * 如果 projectInfo 带有依赖图且图中包含该文件，直接查图；否则回退为扫描文件。
+     *
      * @param filePath 源文件路径
      * @param projectInfo 项目信息（用于判断文件是否在项目内）
      * @return 包含文件列表（项目内的文件）
@@ -100,6 +182,23 @@ public:
         const ProjectInfo& projectInfo
     );
 
+    /**
+     * @brief 获取项目的依赖图
+     * @param projectRoot 项目根路径
+     * @return 依赖图（如果尚未分析该项目返回 nullptr）
+     */
+    std::shared_ptr<ProjectDependencyGraph> getDependencyGraph(const std::string& projectRoot) const;
+
+    /**
+     * @brief 通知文件已变更（写入/删除）
+     *
+     * 使该文件的内容缓存失效，并增量更新所有已构建依赖图中该文件的边。
+     * 通过文件内容缓存的 notifyFileChanged() 发出的通知（例如 write_file 工具）会自动转发到这里。
+     *
+     * @param filePath 文件路径
+     */
+    void notifyFileChanged(const std::string& filePath);
+
     // ========== 文件上下文收集 ==========
 
     /**
@@ -146,17 +245,34 @@ public:
      * @brief 收集项目上下文（适配 ContextManager::ProjectContext）
      * @param projectRoot 项目根路径
      * @param error 如果收集失败，输出错误信息（可选）
+     * @param projectInfo 输出分析得到的项目信息（可选，便于调用方继续使用依赖图等）
      * @return 项目上下文对象
      */
-    ProjectContext collectProjectContext(const std::string& projectRoot, ErrorInfo* error = nullptr);
+    ProjectContext collectProjectContext(
+        const std::string& projectRoot,
+        ErrorInfo* error = nullptr,
+        ProjectInfo* projectInfo = nullptr
+    );
 
     // ========== 缓存管理 ==========
 
     /**
      * @brief 清除文件内容缓存
+     *
+     * 独立缓存直接清空；与其他组件共享的缓存只清理本收集器分析过的项目目录下的条目。
      */
     void clearFileCache();
 
+    /**
+     * @brief 设置文件内容缓存的字节预算（MB）
+     */
+    void setFileCacheLimitMB(size_t maxMegabytes);
+
+    /**
+     * @brief 获取文件内容缓存
+     */
+    std::shared_ptr<FileContentCache> getFileCache() const { return m_fileCache; }
+
     /**
      * @brief 清除摘要缓存
      */
@@ -168,33 +284,74 @@ public:
     void clearAllCaches();
 
 private:
-    // 文件内容缓存：文件路径 -> 文件内容
-    std::unordered_map<std::string, std::string> m_fileCache;
-    // 文件修改时间缓存：文件路径 -> 修改时间
-    std::unordered_map<std::string, std::filesystem::file_time_type> m_fileModifyTime;
+    // 文件内容缓存（按字节预算 LRU，自带锁，读取在锁外进行）
+    std::shared_ptr<FileContentCache> m_fileCache;
+    // m_fileCache 是否由本收集器独占（构造时创建）
+    bool m_ownsFileCache{false};
+    // 在 m_fileCache 上注册的变更监听者ID
+    size_t m_changeListenerId{0};
     // 摘要缓存：项目根路径 -> 摘要内容
     std::unordered_map<std::string, std::string> m_summaryCache;
     // 摘要修改时间缓存：项目根路径 -> 最后修改时间
     std::unordered_map<std::string, std::filesystem::file_time_type> m_summaryModifyTime;
+    // 依赖图缓存：项目根路径 -> 依赖图（analyzeProject 时增量同步）
+    std::unordered_map<std::string, std::shared_ptr<ProjectDependencyGraph>> m_dependencyGraphs;
 
     // 线程安全保护
     mutable std::mutex m_mutex;
 
+    // 后台预热
+    std::thread m_warmupThread;
+    std::mutex m_warmupControlMutex;              // 串行化 startWarmup/cancelWarmup 对 m_warmupThread 的操作
+    mutable std::mutex m_warmupMutex;
+    mutable std::condition_variable m_warmupCv;
+    ProjectWarmupStatus m_warmupStatus;
+    std::optional<ProjectInfo> m_warmInfo;        // 预热发布的结果（预热中为部分结果，完成后为完整结果）
+    std::chrono::steady_clock::time_point m_warmInfoTime;  // m_warmInfo 的发布时间
+    std::atomic<bool> m_warmupCancel{false};
+    std::chrono::steady_clock::time_point m_warmupStart;
+
     // 内部辅助方法
 
     /**
      * @brief 读取文件内容（带缓存）
      * @param filePath 文件路径
-     * @return 文件内容（如果读取失败返回空字符串）
+     * @return 文件内容（如果读取失败返回 nullptr）
      */
-    std::string readFileWithCache(const std::string& filePath);
+    FileContentCache::Content readFileWithCache(const std::string& filePath);
 
     /**
-     * @brief 检查文件是否需要更新缓存
+     * @brief 增量更新包含该文件的依赖图（文件变更监听回调）
      * @param filePath 文件路径
-     * @return 如果需要更新返回 true
      */
-    bool needsCacheUpdate(const std::string& filePath);
+    void updateDependencyGraphs(const std::string& filePath);
+
+    /**
+     * @brief 填充项目名称、CMake配置、依赖和源文件/头文件列表
+     * @param cancel 取消标志（可选）：置位后停止扫描，文件列表不完整
+     * @return 项目根目录存在返回 true
+     */
+    static bool collectProjectFiles(ProjectInfo& info, ErrorInfo* error, const std::atomic<bool>* cancel = nullptr);
+
+    /**
+     * @brief 获取（必要时创建）项目的依赖图
+     */
+    std::shared_ptr<ProjectDependencyGraph> dependencyGraphFor(const std::string& rootPath);
+
+    /**
+     * @brief 预热线程主体
+     */
+    void runWarmup(const std::string& rootPath);
+
+    /**
+     * @brief 通知预热线程取消并等待其退出（调用方持有 m_warmupControlMutex）
+     */
+    void stopWarmupThread();
+
+    /**
+     * @brief 更新预热阶段/状态并通知等待者
+     */
+    void updateWarmupStatus(WarmupState state, const std::string& stage, const std::string& error = "");
 
     /**
      * @brief 构建目录结构树（字符串格式）
@@ -206,6 +363,9 @@ private:
 
     /**
      * @brief 查找包含指定文件的文件（反向依赖）
+     *
+     * 如果 projectInfo 带有依赖图且图中包含该文件，直接查反向边；否则回退为扫描全部文件。
+     *
      * @param targetFile 目标文件路径
      * @param projectInfo 项目信息
      * @return 包含该文件的文件列表
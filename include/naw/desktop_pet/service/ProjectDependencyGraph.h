@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 项目级 include/import 依赖图
+ *
+ * 一次性并行扫描项目内所有源文件和头文件的 #include / import 指令，
+ * 建立正向边（文件 -> 其包含的文件）和反向边（文件 -> 包含它的文件），
+ * 并维护 文件名 -> 路径 的哈希索引用于解析 include。
+ *
+ * 之后通过 sync()/updateFile() 增量更新：只重新扫描修改时间变化的文件，
+ * 使"谁包含了 X"这类查询变为图查找，而不必重新读取整个项目。
+ * 所有公开方法都是线程安全的。
+ */
+class ProjectDependencyGraph {
+public:
+    ProjectDependencyGraph() = default;
+    ~ProjectDependencyGraph() = default;
+
+    // 禁止拷贝/移动（因为包含mutex）
+    ProjectDependencyGraph(const ProjectDependencyGraph&) = delete;
+    ProjectDependencyGraph& operator=(const ProjectDependencyGraph&) = delete;
+    ProjectDependencyGraph(ProjectDependencyGraph&&) = delete;
+    ProjectDependencyGraph& operator=(ProjectDependencyGraph&&) = delete;
+
+    // ========== 构建与增量更新 ==========
+
+    /**
+     * @brief 与当前文件列表同步
+     *
+     * 新出现的文件加入图中，已消失的文件从图中移除，修改时间变化的文件重新扫描。
+     * 文件读取与解析在锁外并行进行，只有应用结果时才持有写锁。
+     * 首次调用即为完整构建。
+     *
+     * @param sourceFiles 源文件列表
+     * @param headerFiles 头文件列表
+     * @param cancel 取消标志（可选）：置位后尽快返回且不修改图
+     * @return 本次重新扫描（含新增）的文件数
+     */
+    size_t sync(const std::vector<std::string>& sourceFiles, const std::vector<std::string>& headerFiles,
+                const std::atomic<bool>* cancel = nullptr);
+
+    /**
+     * @brief 重新扫描单个文件并更新其边（文件变更通知入口）
+     * @param filePath 文件路径；若文件已不存在则等价于 removeFile()
+     * @param isHeader 新文件是否作为头文件加入（已在图中的文件保持原分类）
+     */
+    void updateFile(const std::string& filePath, bool isHeader = false);
+
+    /**
+     * @brief 从图中移除文件及其所有边
+     * @param filePath 文件路径
+     */
+    void removeFile(const std::string& filePath);
+
+    /**
+     * @brief 清空依赖图
+     */
+    void clear();
+
+    // ========== 查询 ==========
+
+    /**
+     * @brief 检查文件是否在图中
+     */
+    bool contains(const std::string& filePath) const;
+
+    /**
+     * @brief 获取文件直接包含的项目内文件（正向边）
+     */
+    std::vector<std::string> getIncludes(const std::string& filePath) const;
+
+    /**
+     * @brief 获取直接包含该文件的项目内文件（反向边）
+     */
+    std::vector<std::string> getIncludedBy(const std::string& filePath) const;
+
+    /**
+     * @brief 获取文件数
+     */
+    size_t fileCount() const;
+
+    /**
+     * @brief 获取已解析的边数
+     */
+    size_t edgeCount() const;
+
+    /**
+     * @brief 从源码内容中提取 include/import 指令（不解析到路径）
+     * @param content 文件内容
+     * @param isPython 是否按 Python import 语法提取
+     * @return 原始 include 路径或模块名列表
+     */
+    static std::vector<std::string> scanDirectives(const std::string& content, bool isPython);
+
+    /**
+     * @brief 规范化路径作为图中的键
+     */
+    static std::string normalizeKey(const std::string& filePath);
+
+private:
+    struct Node {
+        std::vector<std::string> rawIncludes;          // 原始 include 路径/模块名
+        std::vector<std::string> includes;             // 已解析的项目内文件
+        std::unordered_set<std::string> includedBy;    // 反向边
+        std::filesystem::file_time_type modifyTime{};  // 扫描时的修改时间
+        bool isHeader{false};
+        bool isPython{false};
+    };
+
+    // 单个文件的扫描结果（锁外生成）
+    struct ScanResult {
+        std::string key;
+        std::vector<std::string> rawIncludes;
+        std::filesystem::file_time_type modifyTime{};
+        bool isHeader{false};
+        bool isPython{false};
+        bool exists{false};
+    };
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, Node> m_nodes;
+    // 头文件名 -> 头文件路径（C++ include 解析）
+    std::unordered_map<std::string, std::vector<std::string>> m_headerNameIndex;
+    // 源文件主干名 -> 源文件路径（Python import 解析）
+    std::unordered_map<std::string, std::vector<std::string>> m_sourceStemIndex;
+    // 被引用的文件名/模块名 -> 引用它的文件（文件增删时据此重新解析）
+    std::unordered_map<std::string, std::unordered_set<std::string>> m_referrers;
+
+    static ScanResult scanFile(const std::string& key, bool isHeader);
+    static std::vector<ScanResult> scanFilesParallel(const std::vector<std::pair<std::string, bool>>& files,
+                                                     const std::atomic<bool>* cancel = nullptr);
+    static std::string referenceName(const std::string& rawInclude, bool isPython);
+
+    void applyScanLocked(ScanResult&& scan);
+    void removeLocked(const std::string& key);
+    void linkLocked(const std::string& key);
+    void unlinkLocked(const std::string& key);
+    void relinkReferrersLocked(const std::string& name);
+    std::string resolveLocked(const std::string& fromKey, const std::string& rawInclude, bool isPython) const;
+};
+
+} // namespace naw::desktop_pet::service
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "naw/desktop_pet/service/ScreenCapture.h"
+#include "naw/desktop_pet/service/types/ImageData.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 回放/合成屏幕采集源
+ *
+ * 每次全屏截图返回下一帧：按顺序回放预先准备的帧（内存或图像文件），或由生成函数
+ * 在复用的缓冲中逐帧合成画面。用于在没有真实显示器的环境（CI、Xvfb）中测试视觉流水线，
+ * 与真实后端一样提供零拷贝视图和变化区域（按块比较相邻两帧）。
+ */
+class ReplayScreenCapture : public ScreenCapture {
+public:
+    /**
+     * @brief 帧生成函数：把第 frameIndex 帧（从0开始）写入 frame
+     *
+     * frame 是预先分配好尺寸与格式的复用缓冲，内容为再上一帧的画面
+     */
+    using FrameGenerator = std::function<void(uint64_t frameIndex, types::ImageData& frame)>;
+
+    /**
+     * @brief 回放内存中的帧
+     * @param frames 帧序列
+     * @param loop 播放完后是否从头循环（否则之后的截图失败）
+     */
+    explicit ReplayScreenCapture(std::vector<types::ImageData> frames, bool loop = true);
+
+    /**
+     * @brief 由生成函数合成帧（无限序列）
+     */
+    ReplayScreenCapture(uint32_t width,
+                        uint32_t height,
+                        FrameGenerator generator,
+                        types::ImageFormat format = types::ImageFormat::BGRA);
+
+    /**
+     * @brief 回放图像文件序列
+     * @return 任一文件读取失败时返回nullptr
+     */
+    static std::unique_ptr<ReplayScreenCapture> fromFiles(const std::vector<std::string>& paths,
+                                                          bool loop = true);
+
+    std::optional<types::ImageData> captureFullScreen(
+        int32_t displayId = 0,
+        const CaptureOptions& options = {}
+    ) override;
+    std::optional<types::ImageData> captureWindow(
+        types::WindowHandle handle,
+        const CaptureOptions& options = {}
+    ) override;
+    std::optional<types::ImageData> captureRegion(
+        const types::Rect& region,
+        int32_t displayId = 0,
+        const CaptureOptions& options = {}
+    ) override;
+    std::optional<types::ImageView> captureFullScreenView(int32_t displayId = 0) override;
+    std::optional<std::vector<types::Rect>> getLastDamage() const override;
+    std::vector<types::DisplayInfo> getDisplays() override;
+    bool supportsWindowCapture() const override { return false; }
+    bool supportsRegionCapture() const override { return true; }
+    std::string getLastError() const override;
+
+    /**
+     * @brief 已输出的帧数
+     */
+    uint64_t getFrameCount() const;
+
+    /**
+     * @brief 回到第一帧
+     */
+    void rewind();
+
+    /**
+     * @brief 按块比较两帧，返回变化区域（同一行相邻的变化块合并为一个矩形）
+     *
+     * 尺寸或格式不同时整帧视为变化
+     */
+    static std::vector<types::Rect> computeDamage(const types::ImageView& previous,
+                                                  const types::ImageView& current,
+                                                  uint32_t tileSize = kDamageTileSize);
+
+    static constexpr uint32_t kDamageTileSize = 32;
+
+private:
+    /**
+     * @brief 前进到下一帧并计算变化区域（调用方持有m_mutex）
+     */
+    bool advanceLocked();
+
+    bool isValidDisplay(int32_t displayId);
+
+    void setLastError(const std::string& error);
+
+    // 回放模式
+    std::vector<types::ImageData> m_frames;
+    bool m_loop{true};
+    size_t m_nextIndex{0};
+
+    // 合成模式：双缓冲（当前帧与上一帧）
+    FrameGenerator m_generator;
+    std::array<types::ImageData, 2> m_buffers;
+    size_t m_currentBuffer{0};
+
+    mutable std::mutex m_mutex;
+    const types::ImageData* m_current{nullptr};
+    const types::ImageData* m_previous{nullptr};
+    uint64_t m_frameCount{0};
+    std::optional<std::vector<types::Rect>> m_lastDamage;
+
+    mutable std::mutex m_errorMutex;
+    std::string m_lastError;
+};
+
+} // namespace naw::desktop_pet::service
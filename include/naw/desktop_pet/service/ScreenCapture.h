@@ -72,6 +72,26 @@ public:
         const CaptureOptions& options = {}
     ) = 0;
     
+    /**
+     * @brief 零拷贝全屏截图：采集到后端内部复用的缓冲并返回其视图
+     * 
+     * 视图在下一次采集或对象销毁前有效；不支持的后端返回std::nullopt（使用captureFullScreen）
+     * @param displayId 显示器ID（0表示主显示器）
+     */
+    virtual std::optional<types::ImageView> captureFullScreenView(int32_t displayId = 0) {
+        (void)displayId;
+        return std::nullopt;
+    }
+    
+    /**
+     * @brief 上一次全屏截图相对于再上一次的变化区域（显示器坐标）
+     * 
+     * 返回空列表表示画面没有变化；后端无法跟踪变化时返回std::nullopt（按整帧变化处理）
+     */
+    virtual std::optional<std::vector<types::Rect>> getLastDamage() const {
+        return std::nullopt;
+    }
+    
     /**
      * @brief 获取显示器列表
      * @return 显示器信息列表
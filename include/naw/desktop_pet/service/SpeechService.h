@@ -279,6 +279,10 @@ private:
     std::optional<STTResult> executeSTT(const std::string& audioPath,
                                       const STTConfig& config);
     
+    // 以multipart上传一段WAV数据并解析结果（数据可由内存中的WAV头 + PCM分段组成）
+    std::optional<STTResult> executeSTTUpload(utils::HttpClient::MultipartFile filePart,
+                                              const STTConfig& config);
+    
     // 执行STT API调用（从PCM数据）
     std::optional<STTResult> executeSTTFromPCM(const std::vector<std::uint8_t>& pcmData,
                                                const utils::AudioStreamConfig& streamConfig,
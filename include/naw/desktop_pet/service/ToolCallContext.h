@@ -1,8 +1,10 @@
 #pragma once
 
+#include "naw/desktop_pet/service/BlobStore.h"
 #include "naw/desktop_pet/service/FunctionCallingHandler.h"
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -125,6 +127,8 @@ public:
 
     /**
      * @brief 获取缓存的工具调用结果
+     *
+     * 在锁外重建结果并按值返回，内容只复制一次；需要取值（如填入 FunctionCallResult）时使用。
      * @param toolName 工具名称
      * @param arguments 工具参数（用于生成缓存键）
      * @return 如果缓存命中返回结果，否则返回 std::nullopt
@@ -134,6 +138,19 @@ public:
         const nlohmann::json& arguments
     ) const;
 
+    /**
+     * @brief 获取缓存的工具调用结果（共享只读）
+     *
+     * 结果不含大字符串时只复制指针；含大字符串时会重建一份新的结果。
+     * @param toolName 工具名称
+     * @param arguments 工具参数（用于生成缓存键）
+     * @return 如果缓存命中返回结果，否则返回 nullptr
+     */
+    std::shared_ptr<const nlohmann::json> findCachedResult(
+        const std::string& toolName,
+        const nlohmann::json& arguments
+    ) const;
+
     /**
      * @brief 缓存工具调用结果
      * @param toolName 工具名称
@@ -168,9 +185,11 @@ private:
     std::vector<ToolCallHistory> m_history;                    // 工具调用历史记录
     std::unordered_map<std::string, CallChain> m_callChains;  // 调用链映射（对话ID -> 调用链）
 
-    // 结果缓存
+    // 结果缓存：每个字节只保存一份。大字符串（文件内容等）移入共享 BlobStore，与文件缓存按内容去重；
+    // 其余部分保存为只读的结果骨架，没有大字符串时命中只复制指针
     struct CacheEntry {
-        nlohmann::json result;                                  // 缓存的结果
+        std::shared_ptr<const nlohmann::json> skeleton;        // 结果骨架（大字符串位置为空串）
+        std::vector<std::pair<nlohmann::json::json_pointer, BlobStore::Blob>> largeStrings; // 移出的大字符串及其位置
         std::chrono::system_clock::time_point timestamp;       // 缓存时间戳
     };
     mutable std::unordered_map<std::string, CacheEntry> m_cache; // 缓存（键：工具名+参数哈希，mutable以支持const方法中的清理）
@@ -188,6 +207,19 @@ private:
         const nlohmann::json& arguments
     );
 
+    /**
+     * @brief 查找未过期的缓存项（只复制共享指针与 Blob 句柄）
+     */
+    std::optional<CacheEntry> findCacheEntry(
+        const std::string& toolName,
+        const nlohmann::json& arguments
+    ) const;
+
+    /**
+     * @brief 将骨架与大字符串重建为完整结果
+     */
+    static nlohmann::json materializeCacheEntry(const CacheEntry& entry);
+
     /**
      * @brief 检查缓存项是否过期
      * @param entry 缓存项
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "naw/desktop_pet/service/ErrorTypes.h"
+#include "naw/desktop_pet/service/ToolOutputGovernor.h"
 
 #include <chrono>
 #include <functional>
@@ -244,6 +245,27 @@ public:
                                                bool checkPermission = false,
                                                PermissionLevel requiredPermission = PermissionLevel::Public);
 
+    // ========== 输出预算 ==========
+
+    /**
+     * @brief 设置工具输出预算
+     *
+     * 超出 maxTokens 的结果会被截断（文本保留首尾，结果数组按相关性保留），
+     * 完整结果保存在句柄后，并自动注册 read_tool_result 工具供模型分页读取。
+     * maxTokens 为 0 时不限制。
+     */
+    void setOutputBudget(const ToolOutputBudget& budget);
+
+    /**
+     * @brief 获取当前工具输出预算
+     */
+    ToolOutputBudget getOutputBudget() const;
+
+    /**
+     * @brief 获取输出治理器（用于直接分页读取已保存的完整结果）
+     */
+    ToolOutputGovernor& getOutputGovernor() { return m_outputGovernor; }
+
     // ========== 参数验证 ==========
 
     /**
@@ -302,6 +324,12 @@ private:
     std::unordered_map<std::string, ToolUsageStats> m_stats;      // 工具统计信息映射
     mutable std::mutex m_statsMutex;                               // 保护统计信息的互斥锁
     ErrorHandler* m_errorHandler;                                   // 错误处理器（可选）
+    ToolOutputGovernor m_outputGovernor;                            // 工具输出预算治理器
+
+    /**
+     * @brief 首次截断结果时注册分页读取工具（同名工具已存在时不覆盖）
+     */
+    void ensurePagingToolRegistered();
 
     /**
      * @brief 更新工具统计信息
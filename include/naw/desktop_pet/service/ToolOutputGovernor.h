@@ -0,0 +1,95 @@
+#pragma once
+
+#include "naw/desktop_pet/service/BlobStore.h"
+#include "naw/desktop_pet/service/utils/TokenCounter.h"
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "nlohmann/json.hpp"
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 工具输出预算配置
+ */
+struct ToolOutputBudget {
+    size_t maxTokens{4000};                        // 单次工具调用返回的Token上限（0 表示不限制）
+    size_t maxStoredResults{32};                   // 最多保留的完整结果数（超出按先进先出淘汰）
+    size_t maxStoredBytes{32 * 1024 * 1024};       // 完整结果占用的总字节上限
+    std::string modelId{"default"};                // Token估算使用的模型规则
+};
+
+/**
+ * @brief 工具输出治理器
+ *
+ * 对超出Token预算的工具结果进行截断：长文本保留首尾行，结果数组按相关性保留部分条目；
+ * 完整结果保存在句柄后面，模型可通过分页工具（read_tool_result）继续读取。
+ * 所有操作都是线程安全的。
+ */
+class ToolOutputGovernor {
+public:
+    static constexpr const char* kPagingToolName = "read_tool_result";  // 分页读取工具名
+    static constexpr const char* kMetaKey = "tool_output";              // 截断说明字段名
+
+    explicit ToolOutputGovernor(ToolOutputBudget budget = {});
+
+    void setBudget(const ToolOutputBudget& budget);
+    ToolOutputBudget getBudget() const;
+
+    /**
+     * @brief 估算JSON结果序列化后的Token数
+     */
+    size_t estimateTokens(const nlohmann::json& value) const;
+
+    /**
+     * @brief 对工具结果执行预算检查
+     * @param toolName 工具名称（写入截断说明）
+     * @param result 原始结果
+     * @param spilled 输出：结果是否被截断并保存到句柄
+     * @return 未超预算时原样返回；否则返回截断视图，附带 tool_output 字段
+     *         {truncated, handle, total_tokens, returned_tokens, omitted[], hint}
+     */
+    nlohmann::json govern(const std::string& toolName, nlohmann::json result, bool* spilled = nullptr);
+
+    /**
+     * @brief 分页读取已保存的完整结果
+     * @param handle 结果句柄
+     * @param pointer JSON Pointer（如 "/matches"；为空表示整个结果）
+     * @param offset 起始位置（数组为元素下标，文本为行号，从0开始）
+     * @param pageTokens 本页Token上限（会被限制在预算内）
+     * @param error 失败时输出错误信息
+     */
+    std::optional<nlohmann::json> readPage(const std::string& handle,
+                                           const std::string& pointer,
+                                           size_t offset,
+                                           size_t pageTokens,
+                                           std::string* error = nullptr) const;
+
+    bool hasResult(const std::string& handle) const;
+    size_t storedCount() const;
+    void clear();
+
+private:
+    struct StoredResult {
+        std::string toolName;
+        BlobStore::Blob text;  // 完整结果的序列化文本（共享 BlobStore，分页时再解析）
+    };
+
+    mutable std::mutex m_mutex;
+    ToolOutputBudget m_budget;
+    utils::TokenEstimator m_estimator;
+    std::unordered_map<std::string, StoredResult> m_results;  // 句柄 -> 完整结果
+    std::deque<std::string> m_order;                           // 句柄按保存顺序排列
+    size_t m_storedBytes{0};
+    size_t m_nextHandle{1};
+
+    std::string storeResult(const std::string& toolName, std::string text);
+    void evictLocked();
+};
+
+} // namespace naw::desktop_pet::service
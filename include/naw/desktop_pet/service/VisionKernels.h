@@ -0,0 +1,178 @@
+#pragma once
+
+#include "naw/desktop_pet/service/types/ImageData.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 图块变化图
+ *
+ * 把处理分辨率下的图像划分为固定大小的图块，记录每个图块内变化像素的数量；
+ * 用于跳过没有变化的图块，只在脏区域上做后续的形态学和轮廓分析。
+ */
+struct TileChangeMap {
+    uint32_t tileSize{16};               // 图块边长（像素）
+    uint32_t tilesX{0};                  // 水平方向图块数
+    uint32_t tilesY{0};                  // 垂直方向图块数
+    uint32_t width{0};                   // 覆盖的图像宽度
+    uint32_t height{0};                  // 覆盖的图像高度
+    std::vector<uint32_t> changedPixels; // 每个图块的变化像素数（行优先）
+    uint64_t totalChanged{0};            // 变化像素总数
+
+    /**
+     * @brief 按图像尺寸重置（保留已分配的内存）
+     */
+    void reset(uint32_t imageWidth, uint32_t imageHeight, uint32_t tile);
+
+    bool anyChanged() const { return totalChanged > 0; }
+
+    /**
+     * @brief 有变化的图块数
+     */
+    uint32_t dirtyTileCount() const;
+
+    /**
+     * @brief 计算脏区域（像素坐标）
+     *
+     * 相连（8邻域）的脏图块合并为一个矩形，再向外扩展 marginTiles 个图块并合并重叠矩形，
+     * 保证后续在区域内做邻域运算时不会丢失边缘像素。
+     * @param marginTiles 向外扩展的图块数
+     * @param minChangedPixels 图块至少有多少变化像素才算脏
+     */
+    std::vector<types::Rect> dirtyRegions(uint32_t marginTiles = 1, uint32_t minChangedPixels = 1) const;
+};
+
+/**
+ * @brief 源图像图块哈希表
+ *
+ * 按固定大小的图块对源图像计算64位哈希，与前一帧比较即可在不做任何图像处理的情况下
+ * 找出内容发生变化的图块。
+ */
+struct TileHashGrid {
+    uint32_t tileSize{0};                            // 图块边长（源分辨率像素）
+    uint32_t tilesX{0};                              // 水平方向图块数
+    uint32_t tilesY{0};                              // 垂直方向图块数
+    uint32_t width{0};                               // 源图像宽度
+    uint32_t height{0};                              // 源图像高度
+    types::ImageFormat format{types::ImageFormat::BGR}; // 源图像格式
+    std::vector<uint64_t> hashes;                    // 每个图块的哈希（行优先）
+
+    /**
+     * @brief 两个哈希表是否可以逐图块比较（尺寸、格式与图块划分相同）
+     */
+    bool sameLayout(const TileHashGrid& other) const {
+        return !hashes.empty() && tileSize == other.tileSize && width == other.width &&
+               height == other.height && format == other.format && hashes.size() == other.hashes.size();
+    }
+};
+
+/**
+ * @brief 视觉处理的融合计算内核
+ *
+ * 将“缩放 + 灰度转换 + 帧差阈值化 + 图块统计”合并为对源图像的一次遍历：
+ * 每个输出行只读取对应的源行，结果在缓存中仍然热时立即与前一帧比较，避免多次整图读写。
+ * x86 平台在运行时检测 AVX2，ARM64 使用 NEON，其余情况使用标量实现，各实现结果逐字节一致。
+ */
+class VisionKernels {
+public:
+    /**
+     * @brief SIMD 实现级别
+     */
+    enum class SimdLevel {
+        Scalar,
+        AVX2,
+        NEON
+    };
+
+    /**
+     * @brief 融合内核参数
+     */
+    struct DownscaleDiffParams {
+        uint32_t dstWidth{0};       // 输出宽度
+        uint32_t dstHeight{0};      // 输出高度
+        uint8_t diffThreshold{25};  // 帧差阈值：|当前 - 前一帧| > 阈值 视为变化
+        uint32_t tileSize{16};      // 图块边长（会向上取整为8的倍数）
+    };
+
+    /**
+     * @brief 获取当前使用的 SIMD 级别（首次调用时检测CPU）
+     */
+    static SimdLevel simdLevel();
+
+    /**
+     * @brief 强制使用指定的 SIMD 级别（用于测试；不支持的级别会回退到标量实现）
+     */
+    static void setSimdLevel(SimdLevel level);
+
+    static const char* simdLevelName(SimdLevel level);
+
+    /**
+     * @brief 融合的缩放 + 灰度 + 帧差内核
+     *
+     * 每个输出像素取源图像对应位置 2x2 像素的平均值（尺寸相同时即原像素），
+     * 灰度按 BT.601 定点系数计算，与前一帧灰度图比较后写入二值掩码（0/255）并累计图块统计。
+     *
+     * @param src 源图像视图（任意支持的格式，按行步长访问）
+     * @param params 输出尺寸、阈值与图块大小
+     * @param gray 输出灰度图（dstWidth * dstHeight，连续存储）
+     * @param bgr 可选输出：缩放后的 BGR 彩色图（dstWidth * dstHeight * 3），为空则不输出
+     * @param previousGray 可选：前一帧灰度图（与 gray 同尺寸），为空则不计算帧差
+     * @param diffMask 帧差掩码输出（与 gray 同尺寸）；previousGray 为空时可为空
+     * @param tiles 图块变化图输出（previousGray 为空时所有图块计数为0）
+     * @return 参数无效时返回 false
+     */
+    static bool downscaleGrayDiff(const types::ImageView& src,
+                                  const DownscaleDiffParams& params,
+                                  uint8_t* gray,
+                                  uint8_t* bgr,
+                                  const uint8_t* previousGray,
+                                  uint8_t* diffMask,
+                                  TileChangeMap& tiles);
+
+    /**
+     * @brief 只处理指定输出区域的融合内核
+     *
+     * 区域外的 gray/bgr/diffMask 保持原值不变（调用方负责让它们与前一帧一致）。
+     * @param regions 输出坐标下互不相交的区域（可用 mapRegions 生成）
+     */
+    static bool downscaleGrayDiff(const types::ImageView& src,
+                                  const DownscaleDiffParams& params,
+                                  uint8_t* gray,
+                                  uint8_t* bgr,
+                                  const uint8_t* previousGray,
+                                  uint8_t* diffMask,
+                                  TileChangeMap& tiles,
+                                  const std::vector<types::Rect>& regions);
+
+    /**
+     * @brief 将源分辨率下的区域映射到输出分辨率
+     *
+     * 坐标向外取整并扩展 padding 个像素，重叠的区域会被合并，保证结果互不相交。
+     */
+    static std::vector<types::Rect> mapRegions(const std::vector<types::Rect>& regions,
+                                               uint32_t srcWidth, uint32_t srcHeight,
+                                               uint32_t dstWidth, uint32_t dstHeight,
+                                               uint32_t padding = 1);
+
+    /**
+     * @brief 计算源图像的图块哈希（AVX2 每次累加32字节，与标量实现结果一致）
+     * @param src 源图像视图（按行步长访问，padding 不参与哈希）
+     * @param tileSize 图块边长（最小为8）
+     * @param grid 输出哈希表（复用已分配的内存）
+     */
+    static void hashTiles(const types::ImageView& src, uint32_t tileSize, TileHashGrid& grid);
+
+    /**
+     * @brief 比较两帧的图块哈希
+     * @param dirty 输出：变化图块按图块面积计入 changedPixels（图块划分与哈希表相同）
+     * @return 变化的图块数；布局不同时返回0且 dirty 为空
+     */
+    static uint32_t compareTileHashes(const TileHashGrid& current,
+                                      const TileHashGrid& previous,
+                                      TileChangeMap& dirty);
+};
+
+} // namespace naw::desktop_pet::service
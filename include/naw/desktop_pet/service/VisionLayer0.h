@@ -26,6 +26,10 @@ struct VisionLayer0Result {
     // 综合评分
     double overallChangeScore{0.0};         // 综合变化评分（0-1）
     bool shouldTriggerLayer1{false};        // 是否应该触发Layer 1
+    
+    // 区域坐标系（changedRegions/motionRegions 位于处理分辨率下）
+    uint32_t processingWidth{0};            // 处理宽度
+    uint32_t processingHeight{0};           // 处理高度
 };
 
 /**
@@ -35,6 +39,10 @@ struct VisionLayer0Config {
     // 帧差检测参数
     double frameDiffThreshold{0.1};        // 帧差阈值
     int morphKernelSize{3};                // 形态学核大小
+    uint32_t changeTileSize{16};           // 变化图块大小（无变化的图块跳过轮廓分析）
+    bool enableTileHash{true};             // 先比较源图像图块哈希，画面不变时跳过全部处理
+    uint32_t hashTileSize{64};             // 哈希图块大小（源分辨率像素）
+    double partialUpdateMaxRatio{0.5};     // 脏图块占比不超过该值时只处理脏区域
     
     // 色彩分析参数
     int histogramBins{32};                 // 直方图bins数量
@@ -58,6 +66,14 @@ struct VisionLayer0Config {
     bool enableAdaptiveThreshold{true};    // 是否启用自适应阈值
 };
 
+/**
+ * @brief 单帧处理选项（由调度器按帧决定，用于降低昂贵子阶段的频率）
+ */
+struct VisionLayer0FrameOptions {
+    bool runMotionDetection{true};         // 本帧是否做光流（否则沿用上次的运动结果）
+    bool runDominantColor{true};           // 本帧是否允许提取主色调（否则沿用上次的主色调）
+};
+
 /**
  * @brief Layer 0: CV实时处理层
  * 
@@ -89,6 +105,21 @@ public:
      * @return 处理结果
      */
     VisionLayer0Result processFrame(const types::ImageData& frame);
+
+    /**
+     * @brief 处理单帧图像（零拷贝视图，支持带padding的行步长）
+     * @param frame 输入图像视图，仅在调用期间被读取
+     * @return 处理结果
+     */
+    VisionLayer0Result processFrame(const types::ImageView& frame);
+
+    /**
+     * @brief 按指定选项处理单帧图像（见 VisionScheduler）
+     * @param frame 输入图像视图，仅在调用期间被读取
+     * @param options 本帧是否执行光流与主色调提取
+     * @return 处理结果
+     */
+    VisionLayer0Result processFrame(const types::ImageView& frame, const VisionLayer0FrameOptions& options);
     
     /**
      * @brief 重置状态（清除前一帧缓存）
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "naw/desktop_pet/service/VisionLayer0.h"
+#include "naw/desktop_pet/service/types/ImageData.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 单个检测结果
+ */
+struct Detection {
+    float x1{0.0f};      // 左上角X（像素）
+    float y1{0.0f};      // 左上角Y
+    float x2{0.0f};      // 右下角X
+    float y2{0.0f};      // 右下角Y
+    float score{0.0f};   // 置信度（0-1）
+    int classId{-1};     // 类别ID
+    std::string label;   // 类别名称（配置了类别表时填写）
+
+    types::Rect toRect() const;
+};
+
+/**
+ * @brief Layer 1 配置参数
+ */
+struct VisionLayer1Config {
+    // 模型参数
+    std::string modelPath;                 // ONNX 模型路径（YOLOv8 输出格式：[N, 4+类别数, 锚点数]）
+    uint32_t inputWidth{640};              // 模型输入宽度
+    uint32_t inputHeight{640};             // 模型输入高度
+    std::vector<std::string> classNames;   // 类别名称（可选，下标为类别ID）
+    int numThreads{0};                     // 推理线程数提示（0 表示由后端决定；仅对有实例级线程池的后端生效，OpenCV DNN 后端忽略）
+
+    // 后处理参数
+    float confidenceThreshold{0.25f};      // 置信度阈值
+    float nmsThreshold{0.45f};             // NMS IoU 阈值
+    size_t maxDetections{100};             // 每帧最多保留的检测数
+
+    // 区域参数
+    uint32_t maxBatchSize{4};              // 每批推理的最大区域数
+    uint32_t maxRegions{8};                // 区域数超过该值时改为整帧检测
+    uint32_t minRegionSize{96};            // 区域最小边长（源图像像素，过小的区域向外扩展）
+    double regionPadding{0.15};            // 区域向外扩展的比例（保留目标周围的上下文）
+    double fullFrameRatio{0.6};            // 区域总面积超过该比例时改为整帧检测
+};
+
+/**
+ * @brief Layer 1 处理结果
+ */
+struct VisionLayer1Result {
+    bool ran{false};                           // 本帧是否执行了检测
+    std::vector<Detection> detections;         // 检测结果（源图像坐标，已做 NMS）
+    std::vector<types::Rect> analyzedRegions;  // 实际送入模型的区域（源图像坐标）
+    uint32_t batches{0};                       // 推理批次数
+    double preprocessMs{0.0};                  // 预处理耗时
+    double inferenceMs{0.0};                   // 推理耗时
+    double postprocessMs{0.0};                 // 后处理耗时
+};
+
+/**
+ * @brief 检测后端接口
+ *
+ * 输入为已经信箱缩放到模型尺寸的 BGR 图像批次，输出每张图在模型输入坐标下、
+ * 已按置信度过滤但尚未做 NMS 的候选框。新的推理引擎实现该接口即可接入 VisionLayer1。
+ */
+class DetectionBackend {
+public:
+    virtual ~DetectionBackend() = default;
+
+    /**
+     * @brief 加载模型
+     * @return 失败返回 false（错误信息见 getLastError）
+     */
+    virtual bool load(const VisionLayer1Config& config) = 0;
+
+    virtual bool isLoaded() const = 0;
+
+    /**
+     * @brief 批量推理
+     * @param batch 模型尺寸的 BGR 图像
+     * @param candidates 输出：每张图的候选框（模型输入坐标）
+     */
+    virtual bool infer(const std::vector<types::ImageData>& batch,
+                       std::vector<std::vector<Detection>>& candidates) = 0;
+
+    virtual std::string name() const = 0;
+    virtual std::string getLastError() const = 0;
+
+    /**
+     * @brief 创建 CPU 后端（OpenCV DNN，读取 ONNX 模型）
+     */
+    static std::unique_ptr<DetectionBackend> createCpu();
+};
+
+/**
+ * @brief Layer 1: 物体检测层
+ *
+ * 只在 Layer 0 触发时运行，并且只检测 Layer 0 报告的变化/运动区域：区域按比例向外扩展、
+ * 合并重叠后裁剪（零拷贝视图）并信箱缩放到模型尺寸，按批次送入后端推理；
+ * 各区域的结果映射回源图像坐标后统一做按类别的 NMS。
+ * 区域过多或覆盖面积过大时退化为整帧检测。
+ */
+class VisionLayer1 {
+public:
+    /**
+     * @param config 配置参数
+     * @param backend 检测后端（为空时使用 CPU 后端）
+     */
+    explicit VisionLayer1(VisionLayer1Config config = {},
+                          std::unique_ptr<DetectionBackend> backend = nullptr);
+    ~VisionLayer1();
+
+    VisionLayer1(const VisionLayer1&) = delete;
+    VisionLayer1& operator=(const VisionLayer1&) = delete;
+
+    /**
+     * @brief 加载模型
+     */
+    bool initialize();
+
+    bool isInitialized() const;
+
+    /**
+     * @brief 按 Layer 0 结果处理一帧（未触发或没有区域时不运行）
+     * @param frame 源图像（与送入 Layer 0 的是同一帧）
+     * @param layer0 Layer 0 结果（区域位于处理分辨率坐标系）
+     */
+    VisionLayer1Result process(const types::ImageView& frame, const VisionLayer0Result& layer0);
+
+    /**
+     * @brief 在指定区域上检测（区域为源图像坐标；为空时检测整帧）
+     */
+    VisionLayer1Result detect(const types::ImageView& frame, const std::vector<types::Rect>& regions);
+
+    /**
+     * @brief 规划检测区域：扩展、合并重叠区域，必要时改为整帧
+     */
+    std::vector<types::Rect> planRegions(const std::vector<types::Rect>& regions,
+                                         uint32_t frameWidth, uint32_t frameHeight) const;
+
+    /**
+     * @brief 按类别做非极大值抑制（结果按置信度降序）
+     * @param detections 输入/输出检测框
+     * @param iouThreshold IoU 阈值
+     * @param maxDetections 最多保留数量（0 表示不限制）
+     */
+    static void nonMaxSuppression(std::vector<Detection>& detections,
+                                  float iouThreshold,
+                                  size_t maxDetections = 0);
+
+    const VisionLayer1Config& getConfig() const { return m_config; }
+    std::string getLastError() const;
+
+private:
+    VisionLayer1Config m_config;
+    std::unique_ptr<DetectionBackend> m_backend;
+    std::string m_lastError;
+    std::vector<types::ImageData> m_batch;                 // 当前批次（信箱缩放后的区域）
+    std::vector<std::vector<Detection>> m_candidates;
+};
+
+} // namespace naw::desktop_pet::service
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "naw/desktop_pet/service/ImageProcessor.h"
+#include "naw/desktop_pet/service/ScreenCapture.h"
+#include "naw/desktop_pet/service/VisionLayer0.h"
+#include "naw/desktop_pet/service/VisionScheduler.h"
+#include "naw/desktop_pet/service/types/ImageData.h"
+#include "naw/desktop_pet/service/utils/SpscQueue.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 流水线阶段
+ */
+enum class VisionStage {
+    Capture = 0,     // 屏幕采集
+    Preprocess = 1,  // 分辨率控制
+    Analyze = 2,     // Layer 0 分析
+    Encode = 3,      // JPEG 编码（可选）
+};
+
+constexpr size_t kVisionStageCount = 4;
+
+/**
+ * @brief 下游阶段处理不过来时的丢帧策略
+ */
+enum class FrameDropPolicy {
+    DropNewest,  // 队列满时丢弃新帧，已入队的帧按顺序处理
+    KeepLatest,  // 队列满时丢弃新帧；消费者每次只处理队列中最新的一帧，跳过积压的旧帧
+};
+
+/**
+ * @brief 在流水线中流动的一帧
+ */
+struct VisionFrame {
+    uint64_t sequence{0};                               // 采集序号（从1开始）
+    std::chrono::steady_clock::time_point capturedAt{}; // 采集完成时间
+    types::ImageData image;                             // 采集到的原始图像
+    types::ImageData processed;                         // 分辨率控制后的图像（为空表示与 image 相同）
+    VisionLayer0FrameOptions options;                   // 调度器为本帧选择的处理选项
+    std::optional<VisionLayer0Result> layer0;           // Layer 0 结果
+    std::optional<std::vector<uint8_t>> encoded;        // JPEG 数据（仅在编码阶段执行时存在）
+    std::array<std::chrono::steady_clock::duration, kVisionStageCount> stageLatency{}; // 各阶段耗时
+
+    /**
+     * @brief 后续阶段使用的图像（优先使用分辨率控制后的图像）
+     */
+    const types::ImageData& workingImage() const {
+        return processed.isValid() ? processed : image;
+    }
+};
+
+/**
+ * @brief 各阶段的处理函数（为空的阶段使用默认实现）
+ */
+struct VisionPipelineStages {
+    std::function<std::optional<types::ImageData>()> capture;  // 必需：采集一帧
+    std::function<bool(VisionFrame&)> preprocess;               // 默认：ImageProcessor::applyResolutionControl
+    std::function<bool(VisionFrame&)> analyze;                  // 默认：VisionLayer0::processFrame
+    std::function<bool(VisionFrame&)> encode;                   // 默认：ImageProcessor::encode（JPEG）
+};
+
+/**
+ * @brief 视觉流水线配置
+ */
+struct VisionPipelineConfig {
+    size_t queueCapacity{4};                                 // 阶段间队列容量
+    FrameDropPolicy dropPolicy{FrameDropPolicy::KeepLatest}; // 丢帧策略
+    ImageProcessor::ResolutionConfig resolution;             // 预处理分辨率控制（未设置时不缩放）
+    VisionLayer0Config layer0;                               // Layer 0 配置
+    VisionSchedulerConfig scheduler;                         // 采集节奏（按变化评分自适应）
+    bool enableEncode{true};                                 // 是否启用编码阶段
+    bool encodeOnlyOnTrigger{true};                          // 只对触发 Layer 1 的帧编码
+    int jpegQuality{80};                                     // JPEG 质量
+    size_t maxEncodedBytes{0};                               // 编码字节预算（超出时降低质量，0表示不限制）
+};
+
+/**
+ * @brief 多阶段并行视觉流水线
+ *
+ * 采集 → 预处理 → Layer 0 分析 → 编码，每个阶段运行在独立线程上，阶段之间通过有界的
+ * 无锁 SPSC 队列传递帧。采集线程只按调度器的节奏采集，从不等待下游：下游处理不过来时按
+ * 丢帧策略丢帧，保证采集间隔不受分析耗时影响。最后一个阶段把完成的帧交给帧回调，
+ * 并把整帧耗时反馈给调度器（CPU 预算）。
+ */
+class VisionPipeline {
+public:
+    using FrameCallback = std::function<void(VisionFrame&&)>;
+
+    /**
+     * @brief 单个阶段的统计
+     */
+    struct StageMetrics {
+        uint64_t processed{0};   // 处理的帧数
+        uint64_t dropped{0};     // 在该阶段入口被丢弃的帧数
+        uint64_t failed{0};      // 处理失败的帧数
+        double lastMs{0.0};      // 最近一帧耗时
+        double averageMs{0.0};   // 平均耗时（滑动平均）
+        double maxMs{0.0};       // 最大耗时
+        size_t queueDepth{0};    // 入口队列当前深度
+    };
+
+    /**
+     * @brief 流水线统计
+     */
+    struct Metrics {
+        std::array<StageMetrics, kVisionStageCount> stages{};
+        uint64_t completedFrames{0};  // 走完整条流水线的帧数
+        double endToEndMs{0.0};       // 采集完成到回调的平均延迟
+        VisionScheduler::Stats scheduler;
+    };
+
+    VisionPipeline(VisionPipelineConfig config, VisionPipelineStages stages);
+
+    /**
+     * @brief 使用屏幕采集器创建流水线（采集函数调用 captureFullScreen）
+     * @param capture 屏幕采集器（需在流水线停止前保持有效）
+     */
+    static std::unique_ptr<VisionPipeline> createForScreen(ScreenCapture& capture,
+                                                           VisionPipelineConfig config = {},
+                                                           int32_t displayId = 0);
+
+    ~VisionPipeline();
+
+    VisionPipeline(const VisionPipeline&) = delete;
+    VisionPipeline& operator=(const VisionPipeline&) = delete;
+
+    /**
+     * @brief 设置帧回调（在最后一个阶段的线程上调用，需在 start 之前设置）
+     */
+    void setFrameCallback(FrameCallback callback);
+
+    /**
+     * @brief 启动各阶段线程
+     * @return 没有采集函数或已在运行时返回 false
+     */
+    bool start();
+
+    /**
+     * @brief 停止并等待所有阶段线程退出（队列中未处理的帧被丢弃）
+     */
+    void stop();
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    Metrics getMetrics() const;
+
+    static const char* stageName(VisionStage stage);
+
+private:
+    using FrameQueue = utils::SpscQueue<VisionFrame>;
+
+    /**
+     * @brief 阶段统计（只由阶段自己的线程写入）
+     */
+    struct StageState {
+        std::atomic<uint64_t> processed{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> failed{0};
+        std::atomic<double> lastMs{0.0};
+        std::atomic<double> averageMs{0.0};
+        std::atomic<double> maxMs{0.0};
+
+        void record(std::chrono::steady_clock::duration elapsed);
+    };
+
+    /**
+     * @brief 阶段入口：队列 + 唤醒信号
+     */
+    struct StageInbox {
+        explicit StageInbox(size_t capacity) : queue(capacity) {}
+        FrameQueue queue;
+        std::atomic<uint32_t> signal{0};
+    };
+
+    VisionPipelineConfig m_config;
+    VisionPipelineStages m_stages;
+    FrameCallback m_callback;
+    VisionLayer0 m_layer0;
+    VisionScheduler m_scheduler;
+
+    // m_inboxes[i] 是阶段 i+1 的入口队列（采集阶段没有入口）
+    std::array<std::unique_ptr<StageInbox>, kVisionStageCount - 1> m_inboxes;
+    std::array<StageState, kVisionStageCount> m_stageStates;
+    std::atomic<uint64_t> m_completedFrames{0};
+    std::vector<uint8_t> m_encodeBuffer;          // 编码阶段的常驻缓冲（只由编码线程访问）
+    std::atomic<double> m_endToEndMs{0.0};
+
+    std::atomic<bool> m_running{false};
+    std::mutex m_stopMutex;
+    std::condition_variable m_stopCv;
+    std::vector<std::thread> m_threads;
+
+    void captureLoop();
+    void stageLoop(VisionStage stage);
+    bool runStage(VisionStage stage, VisionFrame& frame);
+    bool popFrame(StageInbox& inbox, StageState& state, VisionFrame& frame);
+    void forward(VisionStage from, VisionFrame&& frame);
+    void finishFrame(VisionFrame&& frame);
+};
+
+} // namespace naw::desktop_pet::service
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "naw/desktop_pet/service/VisionLayer0.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace naw::desktop_pet::service {
+
+/**
+ * @brief 视觉帧调度配置
+ */
+struct VisionSchedulerConfig {
+    double idleFps{1.0};                    // 画面静止时的帧率
+    double activeFps{30.0};                 // 画面活跃时的帧率
+    double idleScore{0.02};                 // 平滑评分不高于该值时使用空闲帧率
+    double activeScore{0.2};                // 平滑评分不低于该值时使用活跃帧率
+    double scoreDecay{0.2};                 // 评分下降时的平滑系数（上升时立即跟随）
+    double minFps{0.2};                     // CPU预算限制下的最低帧率
+    double cpuBudgetMsPerSecond{100.0};     // 每秒允许的处理耗时（毫秒，0 表示不限制）
+    uint32_t motionInterval{2};             // 活跃时每 N 个处理帧做一次光流（1 表示每帧）
+    uint32_t dominantColorInterval{15};     // 每 N 个处理帧最多提取一次主色调
+};
+
+/**
+ * @brief 视觉帧调度器
+ *
+ * 根据最近的 overallChangeScore 在空闲帧率与活跃帧率之间调整采集/分析频率：
+ * 画面有变化时立即升到高帧率，静止后逐渐回落；同时按滑动平均的单帧耗时限制帧率，
+ * 保证每秒处理耗时不超过 CPU 预算。昂贵的子阶段（光流、主色调）按间隔抽帧执行。
+ *
+ * 用法：采集线程在 nextFrameTime() 到达后调用 planFrame() 获取本帧选项，
+ * 处理完成后调用 recordFrame() 反馈结果与耗时。所有方法都是线程安全的。
+ */
+class VisionScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 调度统计
+     */
+    struct Stats {
+        uint64_t processedFrames{0};    // 已处理帧数
+        uint64_t motionFrames{0};       // 执行光流的帧数
+        uint64_t dominantColorFrames{0};// 执行主色调提取的帧数
+        double targetFps{0.0};          // 当前目标帧率
+        double smoothedScore{0.0};      // 平滑后的变化评分
+        double averageFrameMs{0.0};     // 单帧处理耗时（滑动平均）
+        double cpuMsPerSecond{0.0};     // 最近一秒的处理耗时
+        bool budgetLimited{false};      // 帧率是否被 CPU 预算限制
+    };
+
+    explicit VisionScheduler(VisionSchedulerConfig config = {});
+
+    void setConfig(const VisionSchedulerConfig& config);
+    VisionSchedulerConfig getConfig() const;
+
+    /**
+     * @brief 下一帧应该采集的时间
+     */
+    Clock::time_point nextFrameTime() const;
+
+    /**
+     * @brief 当前时刻是否应该采集并处理一帧
+     */
+    bool shouldProcess(Clock::time_point now = Clock::now()) const;
+
+    /**
+     * @brief 获取本帧的处理选项（决定是否执行光流与主色调提取）
+     */
+    VisionLayer0FrameOptions planFrame() const;
+
+    /**
+     * @brief 反馈一帧的处理结果
+     * @param result Layer 0 结果
+     * @param processingTime 本帧的处理耗时（采集 + 分析）
+     * @param options 本帧使用的处理选项（planFrame 的返回值）
+     * @param now 处理完成的时间
+     */
+    void recordFrame(const VisionLayer0Result& result,
+                     Clock::duration processingTime,
+                     const VisionLayer0FrameOptions& options,
+                     Clock::time_point now = Clock::now());
+
+    /**
+     * @brief 当前目标帧率
+     */
+    double targetFps() const;
+
+    Stats getStats() const;
+
+    /**
+     * @brief 回到空闲状态（清除评分与耗时统计）
+     */
+    void reset();
+
+private:
+    struct FrameCost {
+        Clock::time_point finishedAt;
+        double ms{0.0};
+    };
+
+    mutable std::mutex m_mutex;
+    VisionSchedulerConfig m_config;
+    double m_smoothedScore{0.0};
+    double m_averageFrameMs{0.0};
+    double m_targetFps{0.0};
+    bool m_budgetLimited{false};
+    uint64_t m_processedFrames{0};
+    uint64_t m_motionFrames{0};
+    uint64_t m_dominantColorFrames{0};
+    uint64_t m_framesSinceMotion{0};
+    uint64_t m_framesSinceDominantColor{0};
+    bool m_hasFrame{false};
+    Clock::time_point m_nextFrameTime{};
+    std::deque<FrameCost> m_recentCosts;  // 最近一秒内各帧的耗时
+
+    void updateTargetFpsLocked();
+};
+
+} // namespace naw::desktop_pet::service
@@ -4,6 +4,7 @@
 
 #ifdef __linux__
 
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -12,116 +13,131 @@
 namespace naw::desktop_pet::service::platform {
 
 /**
- * @brief Linux平台屏幕采集实现
- * 
- * 支持X11和Wayland两种显示服务器：
- * - X11: 使用XGetImage或XShmGetImage（共享内存，性能更好）
- * - Wayland: 使用D-Bus Portal API（org.freedesktop.portal.Screenshot）
- * 
- * 自动检测当前显示服务器类型并选择相应实现
+ * @brief Linux平台屏幕采集实现（X11）
+ *
+ * - 使用MIT-SHM（XShmGetImage）采集到与X服务器共享的内存段，缓冲在分辨率不变时跨帧复用，
+ *   采集过程不分配内存；captureFullScreenView直接返回共享内存的视图（零拷贝）
+ * - 服务器支持DAMAGE扩展时跟踪屏幕变化区域：画面没有变化时跳过采集，
+ *   变化区域通过getLastDamage提供给下游（Layer 0 可只处理变化的部分）；
+ *   复用的帧超过最大帧龄后强制整帧采集，防止DAMAGE事件丢失（如合成窗口管理器经overlay窗口绘制）时画面冻结
+ * - 不支持MIT-SHM时（如远程X连接）回退到XGetImage
+ * - 多显示器通过RandR枚举（不可用时整个根窗口作为一个显示器）
+ *
+ * Wayland会话只能通过XWayland采集X客户端的内容
  */
 class ScreenCaptureLinux : public ScreenCapture {
 public:
-    ScreenCaptureLinux();
+    /**
+     * @param displayName X显示名（为空时使用DISPLAY环境变量）
+     */
+    explicit ScreenCaptureLinux(const std::string& displayName = {});
     ~ScreenCaptureLinux() override;
-    
+
     // 禁止拷贝
     ScreenCaptureLinux(const ScreenCaptureLinux&) = delete;
     ScreenCaptureLinux& operator=(const ScreenCaptureLinux&) = delete;
-    
-    // 移动构造
-    ScreenCaptureLinux(ScreenCaptureLinux&&) noexcept = default;
-    ScreenCaptureLinux& operator=(ScreenCaptureLinux&&) noexcept = default;
-    
-    std::optional<types::ImageData> captureFullScreen(int32_t displayId = 0) override;
-    std::optional<types::ImageData> captureWindow(types::WindowHandle handle) override;
+
+    std::optional<types::ImageData> captureFullScreen(
+        int32_t displayId = 0,
+        const CaptureOptions& options = {}
+    ) override;
+    std::optional<types::ImageData> captureWindow(
+        types::WindowHandle handle,
+        const CaptureOptions& options = {}
+    ) override;
     std::optional<types::ImageData> captureRegion(
-        const types::Rect& region, 
-        int32_t displayId = 0
+        const types::Rect& region,
+        int32_t displayId = 0,
+        const CaptureOptions& options = {}
     ) override;
+    std::optional<types::ImageView> captureFullScreenView(int32_t displayId = 0) override;
+    std::optional<std::vector<types::Rect>> getLastDamage() const override;
     std::vector<types::DisplayInfo> getDisplays() override;
-    bool supportsWindowCapture() const override;
-    bool supportsRegionCapture() const override;
-    std::string getLastError() const override { return lastError_; }
-    
-private:
+    bool supportsWindowCapture() const override { return true; }
+    bool supportsRegionCapture() const override { return true; }
+    std::string getLastError() const override;
+
     /**
-     * @brief 显示服务器类型
+     * @brief 是否已连接到X服务器
      */
-    enum class DisplayServer {
-        Unknown,
-        X11,
-        Wayland
-    };
-    
+    bool isConnected() const;
+
     /**
-     * @brief 检测显示服务器类型
+     * @brief 当前采集方式："XShm" 或 "XGetImage"
      */
-    DisplayServer detectDisplayServer();
-    
+    std::string getCaptureMethod() const;
+
     /**
-     * @brief 初始化X11
+     * @brief 是否使用DAMAGE扩展跟踪变化区域
      */
-    bool initializeX11();
-    
+    bool isDamageTrackingEnabled() const;
+
     /**
-     * @brief 清理X11资源
+     * @brief 设置没有DAMAGE报告时复用缓冲帧的最长时间（默认1秒）
+     *
+     * 超过后强制重新采集，并把该帧整体报告为变化区域；0表示每次都重新采集
      */
-    void cleanupX11();
-    
+    void setMaxFrameAge(std::chrono::milliseconds maxAge);
+
+private:
     /**
-     * @brief 使用X11捕获全屏
+     * @brief 连接X服务器并查询扩展
      */
-    std::optional<types::ImageData> captureFullScreenX11(int32_t displayId);
-    
+    bool initializeX11(const std::string& displayName);
+
     /**
-     * @brief 使用X11捕获窗口
+     * @brief 清理X11资源
      */
-    std::optional<types::ImageData> captureWindowX11(types::WindowHandle handle);
-    
+    void cleanupX11();
+
     /**
-     * @brief 使用X11捕获区域
+     * @brief 为指定尺寸创建（或复用）共享内存图像
      */
-    std::optional<types::ImageData> captureRegionX11(const types::Rect& region);
-    
+    bool ensureShmImage(uint32_t width, uint32_t height);
+
     /**
-     * @brief 初始化Wayland（D-Bus Portal）
+     * @brief 释放共享内存图像
      */
-    bool initializeWayland();
-    
+    void releaseShmImage();
+
     /**
-     * @brief 使用Wayland Portal捕获全屏
+     * @brief 取出DAMAGE累积的变化区域（根窗口坐标）
+     * @return 没有启用DAMAGE时返回false
      */
-    std::optional<types::ImageData> captureFullScreenWayland(int32_t displayId);
-    
+    bool collectDamage(std::vector<types::Rect>& rects);
+
     /**
-     * @brief 枚举X11显示器
+     * @brief 采集根窗口的指定区域到内部缓冲（调用方持有captureMutex_）
      */
-    void enumerateDisplaysX11();
-    
+    std::optional<types::ImageView> captureRootLocked(const types::Rect& bounds);
+
     /**
-     * @brief 枚举Wayland显示器
+     * @brief 枚举显示器
      */
-    void enumerateDisplaysWayland();
-    
-    // 显示服务器类型
-    DisplayServer displayServer_{DisplayServer::Unknown};
-    
+    void enumerateDisplays();
+
+    /**
+     * @brief 查找显示器边界（-1表示整个根窗口）
+     */
+    std::optional<types::Rect> displayBounds(int32_t displayId) const;
+
     // X11相关（前向声明，避免包含X11头文件）
     struct X11Context;
     std::unique_ptr<X11Context> x11Context_;
-    
-    // Wayland相关（D-Bus连接）
-    void* dbusConnection_{nullptr}; // DBusConnection*
-    
+
     // 显示器信息
     std::vector<types::DisplayInfo> displays_;
-    
+
+    // 采集状态
+    mutable std::mutex captureMutex_;
+    std::optional<std::vector<types::Rect>> lastDamage_;
+    std::chrono::milliseconds maxFrameAge_{1000};
+
     // 错误信息
     mutable std::mutex errorMutex_;
     std::string lastError_;
-    
-    void setLastError(const std::string& error) const {
+
+    void setLastError(const std::string& error) {
         std::lock_guard<std::mutex> lock(errorMutex_);
         lastError_ = error;
     }
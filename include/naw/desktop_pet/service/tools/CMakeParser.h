@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <filesystem>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -10,6 +13,29 @@ namespace fs = std::filesystem;
 
 namespace naw::desktop_pet::service::tools {
 
+/**
+ * @brief CMake命令调用（词法分析结果）
+ */
+struct CMakeCommand {
+    std::string name;                     // 命令名（小写）
+    std::vector<std::string> arguments;   // 参数（已去除引号与注释）
+    size_t line{0};                       // 命令所在行号（从1开始）
+};
+
+/**
+ * @brief CMake目标信息
+ */
+struct CMakeTarget {
+    std::string name;
+    std::string kind;                             // executable / library / interface / imported / alias（为空表示仅被引用）
+    std::string definedIn;                        // 定义该目标的CMakeLists.txt（相对项目根目录）
+    std::vector<std::string> sources;             // 源文件（相对项目根目录）
+    std::vector<std::string> includeDirs;         // 包含目录（相对项目根目录）
+    std::vector<std::string> linkLibraries;       // 链接的库（原始名称）
+    std::vector<std::string> compileOptions;      // 编译选项
+    std::vector<std::string> compileDefinitions;  // 编译定义
+};
+
 /**
  * @brief CMake项目信息结构
  */
@@ -21,20 +47,58 @@ struct CMakeProjectInfo {
     std::vector<std::string> targets;
     std::vector<std::string> dependencies;
     
+    // 本文件中对各目标的定义/修改（target_*命令可能作用于其他文件定义的目标）
+    std::vector<CMakeTarget> targetDetails;
+    
     // 配置文件哈希（用于缓存失效检测）
     std::string configHash;
 };
 
+/**
+ * @brief 解析后的CMake项目模型（跨文件合并的目标图）
+ */
+struct CMakeProjectModel {
+    std::string projectName;                                  // 根CMakeLists.txt中的项目名
+    std::unordered_map<std::string, CMakeProjectInfo> files;  // 各CMakeLists.txt的解析结果（按路径索引）
+    std::map<std::string, CMakeTarget> targets;               // 合并后的目标（按名称排序）
+    std::vector<std::string> dependencies;                    // find_package 引入的外部依赖（去重）
+    std::string combinedHash;                                 // 所有CMakeLists.txt哈希的组合
+    
+    /**
+     * @brief 查找目标
+     * @return 目标指针，不存在返回nullptr
+     */
+    const CMakeTarget* findTarget(const std::string& name) const;
+    
+    /**
+     * @brief 目标直接依赖的项目内目标
+     */
+    std::vector<std::string> internalDependencies(const std::string& name) const;
+    
+    /**
+     * @brief 目标直接依赖的外部库（不是项目内目标的链接项）
+     */
+    std::vector<std::string> externalDependencies(const std::string& name) const;
+    
+    /**
+     * @brief 所有目标的链接依赖中出现过的外部库（去重，保持顺序）
+     */
+    std::vector<std::string> allLinkedLibraries() const;
+};
+
 /**
  * @brief CMakeLists.txt解析器
  * 
- * 增强的CMake解析器，能够提取：
+ * 基于词法分析的CMake解析器（支持多行参数、引号/括号参数、行注释与块注释），能够提取：
  * - 项目名称
- * - 源文件列表（从add_executable/add_library）
- * - 包含目录（从include_directories）
+ * - 源文件列表（从add_executable/add_library/target_sources）
+ * - 包含目录（从include_directories/target_include_directories）
  * - 子目录（从add_subdirectory）
- * - 目标名称
+ * - 目标及其链接库、编译选项
  * - 依赖关系
+ * 
+ * 解析结果按文件内容哈希缓存（进程内共享），内容未变化的文件不会重复解析；
+ * 同一层级的子目录CMakeLists.txt并行解析。
  */
 class CMakeParser {
 public:
@@ -53,45 +117,65 @@ public:
      */
     static std::unordered_map<std::string, CMakeProjectInfo> parseAllCMakeLists(const fs::path& projectRoot);
     
+    /**
+     * @brief 加载项目模型（解析所有CMakeLists.txt并合并目标图）
+     * 
+     * 模型按项目根目录缓存，所有CMakeLists.txt内容均未变化时直接返回同一份模型。
+     * @param projectRoot 项目根目录
+     * @return 项目模型（不存在CMakeLists.txt时返回空模型）
+     */
+    static std::shared_ptr<const CMakeProjectModel> loadProjectModel(const fs::path& projectRoot);
+    
+    /**
+     * @brief 将CMake源码切分为命令调用
+     * @param content CMake源码
+     * @return 命令列表（按出现顺序）
+     */
+    static std::vector<CMakeCommand> tokenize(const std::string& content);
+    
     /**
      * @brief 计算文件哈希（用于缓存失效检测）
      * @param filePath 文件路径
      * @return 文件内容的哈希值（十六进制字符串）
      */
     static std::string computeFileHash(const fs::path& filePath);
+    
+    /**
+     * @brief 清空解析缓存与模型缓存
+     */
+    static void clearCache();
 
 private:
     /**
-     * @brief 解析单行CMake命令
-     * @param line 命令行
-     * @param info 解析结果（输出）
+     * @brief 解析已读取的CMake源码（不检查源文件是否存在）
+     * @param content CMake源码
+     * @param cmakeDir CMakeLists.txt所在目录（用于解析相对路径）
      * @param projectRoot 项目根目录
+     * @return 解析结果
      */
-    static void parseLine(const std::string& line, CMakeProjectInfo& info, const fs::path& projectRoot);
+    static CMakeProjectInfo parseContent(
+        const std::string& content,
+        const fs::path& cmakeDir,
+        const fs::path& projectRoot
+    );
     
     /**
-     * @brief 提取函数参数（支持多行）
-     * @param file 文件流
-     * @param line 当前行（输入输出）
-     * @return 参数列表
+     * @brief 读取并解析文件（命中哈希缓存时不重新解析）
      */
-    static std::vector<std::string> extractArguments(std::ifstream& file, std::string& line);
+    static std::shared_ptr<const CMakeProjectInfo> parseFileCached(
+        const fs::path& cmakePath,
+        const fs::path& projectRoot
+    );
     
     /**
      * @brief 规范化路径（处理相对路径和变量引用）
      * @param path 原始路径
+     * @param cmakeDir CMakeLists.txt所在目录
      * @param projectRoot 项目根目录
-     * @return 规范化后的路径
+     * @return 相对项目根目录的路径（无法解析时返回空）
      */
-    static std::string normalizePath(const std::string& path, const fs::path& projectRoot);
-    
-    /**
-     * @brief 移除CMake变量引用（简单处理，不展开变量）
-     * @param str 包含变量的字符串
-     * @return 移除变量后的字符串（保留路径部分）
-     */
-    static std::string removeVariableRefs(const std::string& str);
+    static std::string normalizePath(const std::string& path, const fs::path& cmakeDir, const fs::path& projectRoot);
+
 };
 
 } // namespace naw::desktop_pet::service::tools
-
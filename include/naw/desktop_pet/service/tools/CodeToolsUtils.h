@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 
@@ -56,6 +57,11 @@ bool matchesPattern(const std::string& filename, const std::string& pattern);
  */
 std::vector<std::string> readFileLines(const fs::path& path, int startLine = 0, int endLine = -1);
 
+/**
+ * @brief 将已读取的文件原始字节按编码转换为UTF-8并按行分割（与 readFileLines 行为一致）
+ */
+std::vector<std::string> splitFileContentLines(const std::string& rawContent, int startLine = 0, int endLine = -1);
+
 /**
  * @brief 统计文件总行数
  */
@@ -129,5 +135,18 @@ size_t utf8ColumnToByteOffset(const std::string& str, int column);
  */
 std::pair<size_t, size_t> getUtf8CharRange(const std::string& str, size_t startChar, size_t endChar);
 
+/**
+ * @brief 原子写入文件：先写入同目录临时文件并刷盘，再重命名替换目标文件
+ *
+ * 读取方要么看到旧内容，要么看到完整的新内容，不会看到写了一半的文件。
+ * 覆盖已有文件时保留原有权限；目标是符号链接时写入链接指向的文件，链接本身保留。
+ * @param path 目标文件路径
+ * @param content 文件内容（原样写入）
+ * @param error 失败时的错误描述
+ * @param createOnly 为 true 时仅在目标不存在时创建（存在性检查与发布为同一原子操作）
+ * @return 是否成功（失败时目标文件保持不变）
+ */
+bool writeFileAtomically(const fs::path& path, std::string_view content, std::string& error, bool createOnly = false);
+
 } // namespace naw::desktop_pet::service::tools
 
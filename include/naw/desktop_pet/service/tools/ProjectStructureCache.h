@@ -2,12 +2,15 @@
 
 #include "naw/desktop_pet/service/tools/ProjectWhitelist.h"
 
+#include <atomic>
 #include <chrono>
 #include <filesystem>
+#include <memory>
 #include <mutex>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 namespace fs = std::filesystem;
@@ -29,8 +32,14 @@ struct FileSnapshot {
         try {
             if (fs::exists(filePath) && fs::is_regular_file(filePath)) {
                 auto ftime = fs::last_write_time(filePath);
-                mtime = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                    ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
+                // 两个时钟的差值只取一次：每次都用 now() 换算会让同一文件得到不同的快照
+                static const auto clockOffset =
+                    std::chrono::system_clock::now().time_since_epoch() -
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        fs::file_time_type::clock::now().time_since_epoch());
+                mtime = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(ftime.time_since_epoch()) +
+                    clockOffset);
                 size = fs::file_size(filePath);
             } else {
                 mtime = std::chrono::system_clock::time_point::min();
@@ -99,6 +108,14 @@ public:
      */
     explicit ProjectStructureCache(const fs::path& cacheDir = fs::temp_directory_path() / "naw_project_cache");
     
+    /**
+     * @brief 析构函数：请求停止后台检查并等待其退出
+     */
+    ~ProjectStructureCache();
+    
+    ProjectStructureCache(const ProjectStructureCache&) = delete;
+    ProjectStructureCache& operator=(const ProjectStructureCache&) = delete;
+    
     /**
      * @brief 生成缓存键
      * @param projectRoot 项目根目录
@@ -113,10 +130,12 @@ public:
     
     /**
      * @brief 获取缓存
+     *
+     * 内存中的条目写入后不再修改，命中时共享同一份只读条目（数据与白名单都不复制）。
      * @param key 缓存键
-     * @return 缓存条目，如果未命中或已过期则返回nullopt
+     * @return 缓存条目，如果未命中或已过期则返回nullptr
      */
-    std::optional<CacheEntry> get(const std::string& key);
+    std::shared_ptr<const CacheEntry> get(const std::string& key);
     
     /**
      * @brief 存储缓存
@@ -138,13 +157,33 @@ public:
      * @param key 缓存键
      * @param projectRoot 项目根目录
      * @param whitelist 当前白名单（用于比较哈希）
-     * @return 更新后的缓存条目，如果无法更新则返回nullopt
+     * @return 仍然有效的缓存条目，如果已失效则返回nullptr
      */
-    std::optional<CacheEntry> checkAndUpdate(
+    std::shared_ptr<const CacheEntry> checkAndUpdate(
         const std::string& key,
         const fs::path& projectRoot,
         const ProjectFileWhitelist& whitelist);
     
+    /**
+     * @brief 在后台线程中执行 checkAndUpdate
+     *
+     * 同一时刻最多运行一个后台检查，已有检查在运行时直接返回 false。
+     * 后台线程由缓存自身持有，析构时停止并 join。
+     * @param key 缓存键
+     * @param projectRoot 项目根目录
+     * @param whitelist 当前白名单（将被移动到后台线程）
+     * @return 是否启动了新的后台检查
+     */
+    bool scheduleCheckAndUpdate(
+        const std::string& key,
+        const fs::path& projectRoot,
+        ProjectFileWhitelist&& whitelist);
+    
+    /**
+     * @brief 等待当前后台检查结束（没有运行中的检查时立即返回）
+     */
+    void waitForRefresh();
+    
     /**
      * @brief 使缓存失效
      * @param key 缓存键（如果为空则清除所有缓存）
@@ -197,8 +236,13 @@ private:
 private:
     fs::path cacheDir_;
     mutable std::mutex mutex_;
-    std::unordered_map<std::string, CacheEntry> memoryCache_;  // 内存缓存
+    std::unordered_map<std::string, std::shared_ptr<const CacheEntry>> memoryCache_;  // 内存缓存（只读条目，命中时共享）
     Statistics stats_;
+    
+    std::mutex refreshMutex_;                 // 保护 refreshThread_ 的启动与 join
+    std::thread refreshThread_;               // 后台检查线程
+    std::atomic<bool> refreshRunning_{false}; // 后台检查是否正在运行
+    std::atomic<bool> stopRequested_{false};  // 析构时请求后台检查提前退出
 };
 
 } // namespace naw::desktop_pet::service::tools
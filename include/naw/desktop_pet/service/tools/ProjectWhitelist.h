@@ -3,9 +3,13 @@
 #include "naw/desktop_pet/service/tools/CMakeParser.h"
 #include "naw/desktop_pet/service/tools/GitIgnoreParser.h"
 
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -14,10 +18,80 @@ namespace fs = std::filesystem;
 
 namespace naw::desktop_pet::service::tools {
 
+/**
+ * @brief 文件扩展名类别（位标志；一个扩展名可属于多个类别，如 .py 同时是源文件和资源文件）
+ */
+struct ExtensionFlags {
+    static constexpr uint8_t None = 0;
+    static constexpr uint8_t Source = 1 << 0;
+    static constexpr uint8_t Header = 1 << 1;
+    static constexpr uint8_t Document = 1 << 2;
+    static constexpr uint8_t Resource = 1 << 3;
+};
+
+/**
+ * @brief 目录判定前缀树（按路径分量索引）
+ * 
+ * 白名单中的各类目录（扫描根目录、包含目录、资源目录、文档目录）编译为一棵树，
+ * 目录标志沿路径向下继承，查询一个路径只需按分量逐级查找。
+ */
+class WhitelistDirectoryTrie {
+public:
+    static constexpr uint8_t ScanRoot = 1 << 0;         // 扫描根目录（子树）
+    static constexpr uint8_t IncludeDir = 1 << 1;       // 包含目录（子树）
+    static constexpr uint8_t ResourceDir = 1 << 2;      // 资源目录（子树）
+    static constexpr uint8_t DocumentDir = 1 << 3;      // 文档目录（子树）
+    static constexpr uint8_t IncludeAncestor = 1 << 4;  // 包含目录的祖先（仅该目录本身，不继承）
+    
+    WhitelistDirectoryTrie();
+    
+    /**
+     * @brief 标记目录
+     * @param relPath 相对项目根目录的路径（'/'分隔，空字符串或"."表示根目录）
+     * @param flag 目录标志
+     */
+    void insert(std::string_view relPath, uint8_t flag);
+    
+    /**
+     * @brief 查询目录标志（包含从祖先继承的标志）
+     * @param relPath 相对项目根目录的目录路径（'/'分隔）
+     */
+    uint8_t lookup(std::string_view relPath) const;
+    
+    void clear();
+    size_t nodeCount() const { return m_nodes.size(); }
+
+private:
+    struct ComponentHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+    
+    struct Node {
+        uint8_t flags{0};
+        std::unordered_map<std::string, uint32_t, ComponentHash, std::equal_to<>> children;
+    };
+    
+    std::vector<Node> m_nodes;  // m_nodes[0] 为根目录
+};
+
+/**
+ * @brief 单个文件的白名单判定结果
+ */
+struct FileDecision {
+    bool whitelisted{false};
+    uint8_t extensionFlags{ExtensionFlags::None};
+    bool isConfig{false};    // 在配置文件集合中
+    bool isDocument{false};  // 文档扩展名、文档文件集合或文档目录下的文档
+    bool isResource{false};  // 资源扩展名或位于资源目录下
+};
+
 /**
  * @brief 项目文件白名单
  * 
- * 基于CMake配置和.gitignore规则构建，确定需要扫描的文件和目录
+ * 基于CMake配置和.gitignore规则构建，确定需要扫描的文件和目录。
+ * buildProjectWhitelist() 会调用 compile() 把目录集合编译为前缀树，
+ * 遍历时每个条目的判定只需一次扩展名查表和一次按路径分量的树查找。
  */
 struct ProjectFileWhitelist {
     std::unordered_set<std::string> sourceFiles;      // 源文件路径集合（相对路径）
@@ -25,6 +99,7 @@ struct ProjectFileWhitelist {
     std::unordered_set<std::string> configFiles;     // 配置文件集合（相对路径）
     std::unordered_set<std::string> docFiles;         // 文档文件集合（相对路径）
     std::unordered_set<std::string> resourceDirs;     // 资源目录集合（相对路径）
+    std::unordered_set<std::string> docDirs;          // 文档目录集合（相对路径）
     std::vector<fs::path> scanRoots;                  // 需要扫描的根目录列表（绝对路径）
     
     // 配置文件哈希（用于缓存失效检测）
@@ -38,6 +113,20 @@ struct ProjectFileWhitelist {
     // GitIgnore解析器
     std::unique_ptr<GitIgnoreParser> gitIgnoreParser;
     
+    // 编译后的目录判定（compile() 生成）
+    WhitelistDirectoryTrie directoryTrie;
+    fs::path compiledRoot;
+    
+    /**
+     * @brief 以其他根目录查询旧接口时的前缀树缓存（根目录 -> 前缀树，compile() 时清空）
+     */
+    struct RootTrieCache {
+        static constexpr size_t MAX_ROOTS = 8;
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<const WhitelistDirectoryTrie>> tries;
+    };
+    std::unique_ptr<RootTrieCache> rootTrieCache = std::make_unique<RootTrieCache>();
+    
     // 默认构造函数
     ProjectFileWhitelist() = default;
     
@@ -67,6 +156,41 @@ struct ProjectFileWhitelist {
      */
     bool shouldScanDirectory(const fs::path& dirPath, const fs::path& projectRoot) const;
     
+    /**
+     * @brief 将目录集合编译为前缀树（修改集合后需要重新调用）
+     * @param projectRoot 项目根目录
+     */
+    void compile(const fs::path& projectRoot);
+    
+    /**
+     * @brief 判定文件（遍历时使用，需先 compile()）
+     * @param relPath 相对项目根目录的路径（'/'分隔）
+     * @return 判定结果
+     */
+    FileDecision classifyFile(const std::string& relPath) const;
+    
+    /**
+     * @brief 检查目录是否应该被扫描（遍历时使用，需先 compile()）
+     * @param relPath 相对项目根目录的路径（'/'分隔）
+     * @param dirPath 目录路径（用于.gitignore判断）
+     * @param projectRoot 项目根目录
+     * @return true如果目录应该被扫描
+     */
+    bool shouldScanRelativeDirectory(const std::string& relPath, const fs::path& dirPath, const fs::path& projectRoot) const;
+    
+    /**
+     * @brief 计算相对项目根目录的路径（纯词法运算，不访问文件系统）
+     * @return '/'分隔的相对路径；路径等于根目录或不在根目录下时返回空字符串
+     */
+    static std::string relativeKey(const fs::path& path, const fs::path& projectRoot);
+    
+    /**
+     * @brief 查询扩展名类别（完美哈希表，大小写不敏感）
+     * @param ext 文件扩展名（包含点，如".cpp"）
+     * @return ExtensionFlags 位标志
+     */
+    static uint8_t extensionFlags(std::string_view ext);
+    
     /**
      * @brief 检查文件扩展名是否为源文件
      * @param ext 文件扩展名（包含点，如".cpp"）
@@ -94,6 +218,21 @@ struct ProjectFileWhitelist {
      * @return true如果是资源文件扩展名
      */
     static bool isResourceFileExtension(const std::string& ext);
+
+private:
+    /**
+     * @brief 按给定根目录把目录集合编译为前缀树
+     */
+    void buildTrie(const fs::path& absRoot, WhitelistDirectoryTrie& trie) const;
+    
+    /**
+     * @brief 获取非编译根目录的前缀树（查缓存，未命中时编译并缓存）
+     */
+    std::shared_ptr<const WhitelistDirectoryTrie> trieForRoot(const fs::path& absRoot) const;
+    
+    FileDecision classifyWithTrie(const std::string& relPath, const WhitelistDirectoryTrie& trie) const;
+    bool shouldScanWithTrie(const std::string& relPath, const fs::path& dirPath, const fs::path& projectRoot,
+                            const WhitelistDirectoryTrie& trie) const;
 };
 
 /**
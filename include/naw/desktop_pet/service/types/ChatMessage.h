@@ -170,18 +170,19 @@ struct ChatMessage {
             return false;
         }
 
-        std::string payload(u.substr(commaPos + std::string_view(";base64,").size()));
-        auto decoded = naw::desktop_pet::service::utils::decodeBase64(payload);
-        if (!decoded.has_value()) {
+        // Validate characters and compute the decoded size without materializing the bytes.
+        const auto decodedSize = naw::desktop_pet::service::utils::base64DecodedSize(
+            u.substr(commaPos + std::string_view(";base64,").size()));
+        if (!decodedSize.has_value()) {
             if (reason) *reason = "base64 decode failed";
             return false;
         }
-        if (decoded->empty()) {
+        if (*decodedSize == 0) {
             if (reason) *reason = "decoded image bytes are empty";
             return false;
         }
         constexpr std::size_t kMaxBytes = 5 * 1024 * 1024;
-        if (decoded->size() > kMaxBytes) {
+        if (*decodedSize > kMaxBytes) {
             if (reason) *reason = "image bytes exceed limit";
             return false;
         }
@@ -320,9 +321,10 @@ struct ChatMessage {
             if (url.rfind("http://", 0) == 0 || url.rfind("https://", 0) == 0) return kBase;
             const auto pos = url.find(";base64,");
             if (pos == std::string::npos) return kBase;
-            auto decoded = naw::desktop_pet::service::utils::decodeBase64(url.substr(pos + 8));
-            if (!decoded.has_value()) return kBase;
-            const std::size_t bytes = decoded->size();
+            const auto decodedSize =
+                naw::desktop_pet::service::utils::base64DecodedSize(std::string_view(url).substr(pos + 8));
+            if (!decodedSize.has_value()) return kBase;
+            const std::size_t bytes = *decodedSize;
             const std::size_t extra = std::min(kMaxExtra, (bytes / 2048) * 50);
             return kBase + extra;
         };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -19,6 +20,24 @@ enum class ImageFormat {
     Grayscale // 灰度图 (每像素1字节)
 };
 
+/**
+ * @brief 计算指定格式的每像素字节数
+ */
+inline uint32_t bytesPerPixelOf(ImageFormat format) {
+    switch (format) {
+        case ImageFormat::RGB:
+        case ImageFormat::BGR:
+            return 3;
+        case ImageFormat::RGBA:
+        case ImageFormat::BGRA:
+            return 4;
+        case ImageFormat::Grayscale:
+            return 1;
+        default:
+            return 3;
+    }
+}
+
 /**
  * @brief 图像数据结构
  * 
@@ -35,18 +54,7 @@ struct ImageData {
      * @brief 计算每像素字节数
      */
     uint32_t bytesPerPixel() const {
-        switch (format) {
-            case ImageFormat::RGB:
-            case ImageFormat::BGR:
-                return 3;
-            case ImageFormat::RGBA:
-            case ImageFormat::BGRA:
-                return 4;
-            case ImageFormat::Grayscale:
-                return 1;
-            default:
-                return 3;
-        }
+        return bytesPerPixelOf(format);
     }
     
     /**
@@ -94,6 +102,65 @@ struct ImageData {
     }
 };
 
+/**
+ * @brief 非拥有的图像视图
+ *
+ * 只引用外部像素缓冲（ImageData、平台截图缓冲等），不复制数据；调用方需保证缓冲在视图使用期间有效。
+ * stride 始终为实际行字节数（可能包含padding），处理模块按行访问即可兼容带padding的缓冲。
+ */
+struct ImageView {
+    const uint8_t* data{nullptr};         // 首行首像素地址
+    uint32_t width{0};                    // 图像宽度（像素）
+    uint32_t height{0};                   // 图像高度（像素）
+    ImageFormat format{ImageFormat::BGR}; // 图像格式
+    uint32_t stride{0};                   // 每行字节数（>= width * bytesPerPixel）
+
+    ImageView() = default;
+
+    ImageView(const uint8_t* d, uint32_t w, uint32_t h, ImageFormat f, uint32_t s = 0)
+        : data(d), width(w), height(h), format(f), stride(s > 0 ? s : w * bytesPerPixelOf(f)) {}
+
+    /**
+     * @brief 从 ImageData 创建视图（无效图像返回空视图）
+     */
+    static ImageView fromImageData(const ImageData& image) {
+        if (!image.isValid()) {
+            return ImageView();
+        }
+        return ImageView(image.data.data(), image.width, image.height, image.format, image.stride);
+    }
+
+    uint32_t bytesPerPixel() const { return bytesPerPixelOf(format); }
+
+    /**
+     * @brief 每行有效像素字节数（不含padding）
+     */
+    uint32_t rowBytes() const { return width * bytesPerPixel(); }
+
+    /**
+     * @brief 行之间是否没有padding
+     */
+    bool isContinuous() const { return stride == rowBytes(); }
+
+    const uint8_t* row(uint32_t y) const { return data + static_cast<size_t>(y) * stride; }
+
+    bool isValid() const {
+        return data != nullptr && width > 0 && height > 0 && stride >= rowBytes();
+    }
+
+    /**
+     * @brief 取子区域视图（区域会被裁剪到图像范围内，仍然不复制数据）
+     */
+    ImageView subView(uint32_t x, uint32_t y, uint32_t w, uint32_t h) const {
+        if (!isValid() || x >= width || y >= height) {
+            return ImageView();
+        }
+        w = std::min(w, width - x);
+        h = std::min(h, height - y);
+        return ImageView(row(y) + static_cast<size_t>(x) * bytesPerPixel(), w, h, format, stride);
+    }
+};
+
 /**
  * @brief 矩形区域定义
  */
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace naw::desktop_pet::service::utils {
+
+enum class AudioFormat; // 定义见 AudioProcessor.h
+
+/**
+ * @brief PCM 电平统计（样本按格式归一化到 [-1,1]）
+ */
+struct PcmLevel {
+    float peak{0.0f};        // 绝对峰值
+    double sumSquares{0.0};  // 平方和
+    std::size_t clipped{0};  // |x| >= clipThreshold 的样本数
+};
+
+/**
+ * @brief 音频 PCM 信号处理内核
+ *
+ * 每种采样格式对应一张函数表，调用方在流格式确定时取一次表，之后的逐块处理不再按样本判断格式。
+ * x86 平台运行时检测 AVX2，否则使用标量实现（按格式特化的简单循环，可由编译器自动向量化）。
+ * 峰值、剪裁计数、格式转换、增益与阈值查找在各实现间逐位一致；平方和按块在单精度下累加、
+ * 块间以双精度合并，与标量实现只有舍入误差级别的差异。
+ */
+class AudioKernels {
+public:
+    /**
+     * @brief SIMD 实现级别
+     */
+    enum class SimdLevel {
+        Scalar,
+        AVX2
+    };
+
+    /**
+     * @brief 某一采样格式的内核函数表
+     */
+    struct PcmKernels {
+        /**
+         * @brief 单次遍历统计峰值、平方和与剪裁样本数（结果累加到 level）
+         */
+        void (*measure)(const void* pcm, std::size_t samples, float clipThreshold, PcmLevel& level);
+        /**
+         * @brief 转换为 float：取每 stride 个样本中的第一个（stride 为声道数时即提取第一声道，为1时整体转换）
+         */
+        void (*toFloat)(const void* pcm, std::size_t count, std::uint32_t stride, float* out);
+        /**
+         * @brief 由 float 转换为本格式（S16 饱和并就近取整）
+         */
+        void (*fromFloat)(const float* in, std::size_t samples, void* out);
+        /**
+         * @brief 原地乘以线性增益（S16 饱和并就近取整；F32 非有限值置0）
+         */
+        void (*applyGain)(void* pcm, std::size_t samples, float gain);
+        /**
+         * @brief 第一个 |x| >= threshold 的样本下标，没有时返回 samples
+         */
+        std::size_t (*firstAbove)(const void* pcm, std::size_t samples, float threshold);
+        /**
+         * @brief 最后一个 |x| >= threshold 的样本下标，没有时返回 samples
+         */
+        std::size_t (*lastAbove)(const void* pcm, std::size_t samples, float threshold);
+    };
+
+    /**
+     * @brief 获取当前使用的 SIMD 级别（首次调用时检测CPU）
+     */
+    static SimdLevel simdLevel();
+
+    /**
+     * @brief 强制使用指定的 SIMD 级别（用于测试；不支持的级别会回退到标量实现）
+     * @note 已取得的函数表不受影响
+     */
+    static void setSimdLevel(SimdLevel level);
+
+    static const char* simdLevelName(SimdLevel level);
+
+    /**
+     * @brief 按当前 SIMD 级别取指定格式的函数表（返回的引用长期有效）
+     */
+    static const PcmKernels& kernels(AudioFormat format);
+};
+
+} // namespace naw::desktop_pet::service::utils
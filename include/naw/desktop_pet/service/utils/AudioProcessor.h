@@ -8,12 +8,18 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include <cstring>
 
 #include <miniaudio.h>
 
+#include "naw/desktop_pet/service/utils/AudioKernels.h"
+#include "naw/desktop_pet/service/utils/EchoCanceller.h"
+#include "naw/desktop_pet/service/utils/SpscQueue.h"
+#include "naw/desktop_pet/service/utils/VoiceActivityDetector.h"
+
 namespace naw::desktop_pet::service::utils {
 
 enum class AudioFormat {
@@ -79,27 +85,62 @@ struct CaptureOptions {
     bool useDeviceDefault{true}; // 若为 true，则忽略 stream 中的 rate/通道/format，直接用设备默认
     bool storeInMemory{true};
     std::size_t maxFramesInBuffer{48000 * 10}; // 默认最多缓存10秒的PCM
+    // 数据回调：在录音消费线程上调用（不在设备回调线程），可做较重的处理，但耗时过长会导致环形缓冲溢出丢帧
     std::function<void(const void* pcm, std::size_t bytes, std::uint32_t frames)> onData;
     std::function<void(const AudioError& err)> onError; // 可选：错误回调（不会抛异常）
 };
 
+/**
+ * @brief 录音实时路径统计（设备回调线程以原子量更新，可在任意线程读取）
+ */
+struct CaptureRealtimeStats {
+    std::uint64_t framesCaptured{0}; // 设备回调交付的总帧数
+    std::uint64_t framesDropped{0};  // 环形缓冲已满而丢弃的帧数
+    std::uint64_t overruns{0};       // 发生丢弃的回调次数
+    float levelDb{-90.0f};           // 最近一次回调的 RMS 电平（dBFS）
+    float peak{0.0f};                // 最近一次回调的归一化峰值 [0,1]
+};
+
 struct CapturedBuffer {
     AudioStreamConfig stream{};
     std::vector<std::uint8_t> data;
 };
 
 struct VADConfig {
-    float startThresholdDb{-35.0f}; // 触发开始的能量阈值
-    float stopThresholdDb{-40.0f};  // 结束的能量阈值（应低于 start）
-    std::uint32_t startHoldMs{200}; // 超过阈值需持续多久才触发
-    std::uint32_t stopHoldMs{600};  // 低于阈值需持续多久才结束
+    float startThresholdDb{-35.0f}; // 触发开始的能量阈值（仅 spectral.enabled=false 时使用）
+    float stopThresholdDb{-40.0f};  // 结束的能量阈值（应低于 start），也用于裁剪首尾静音
+    std::uint32_t startHoldMs{200}; // 判为语音需持续多久才触发
+    std::uint32_t stopHoldMs{600};  // 判为静音需持续多久才结束
     float maxBufferSeconds{10.0f};  // 环形缓冲秒数上限
+    std::uint32_t minSpeechMs{250}; // 片段内有效语音累计不足则丢弃（计为误触发），0 表示不检查
     std::string outputWavPath{"vad_capture.wav"}; // 默认输出文件
+    SpectralVadConfig spectral{};                 // 频谱 VAD（自适应噪声底）；关闭时使用固定 dB 阈值
+    EchoCancellerConfig echoCanceller{};          // 播放期间从麦克风信号中消除自身播放的声音
+};
+
+/**
+ * @brief 静默监听的 VAD 统计
+ */
+struct VADStats {
+    std::uint64_t triggers{0};      // 开始收集的次数
+    std::uint64_t segments{0};      // 写出文件并回调 onComplete 的片段数
+    std::uint64_t falseTriggers{0}; // 触发后被丢弃（静音/有效语音不足）或由上层报告无效的次数
+    std::uint64_t bargeIns{0};      // 播放期间触发并淡出播放的次数
+    float levelDb{-90.0f};          // 最近一帧语音频带电平（频谱 VAD）
+    float noiseFloorDb{-90.0f};     // 语音频带噪声底（频谱 VAD）
+    float snrDb{0.0f};              // 最近一帧的平均频带信噪比（频谱 VAD）
+    float flatness{1.0f};           // 最近一帧白化后的频谱平坦度（频谱 VAD）
+
+    float falseTriggerRate() const {
+        return triggers == 0 ? 0.0f : static_cast<float>(falseTriggers) / static_cast<float>(triggers);
+    }
 };
 
 struct VADCallbacks {
     std::function<void()> onTrigger;                             // 触发开始收集时
     std::function<void(const std::string& wavPath)> onComplete;  // 收集完成并写文件后
+    // 可选：设置后片段直接以内存 PCM 交付（在独立线程上调用），不写文件、不调用 onComplete
+    std::function<void(const CapturedBuffer& clip)> onSegment;
 };
 
 /**
@@ -163,7 +204,11 @@ public:
     // ---- 录音 ----
     bool startCapture(const CaptureOptions& opts);
     void stopCapture();
-    bool isCapturing() const { return capturing_; }
+    bool isCapturing() const { return capturing_.load(std::memory_order_acquire); }
+    /**
+     * @brief 获取录音实时路径统计（电平计量与溢出计数），线程安全
+     */
+    CaptureRealtimeStats captureStats() const;
     CapturedBuffer capturedBuffer() const;
     bool saveCapturedWav(const std::string& path) const;
 
@@ -193,6 +238,11 @@ public:
     bool writePcmToWav(const std::string& path,
                        const AudioStreamConfig& stream,
                        const std::vector<std::uint8_t>& pcm) const;
+    /**
+     * @brief 生成 44 字节的 WAV(RIFF) 头，后接 dataBytes 字节 PCM 即为完整文件（S16 为 PCM，F32 为 IEEE float）
+     * @return 格式无效时返回空串
+     */
+    static std::string wavHeader(const AudioStreamConfig& stream, std::size_t dataBytes);
 
     // ---- 静默监听/VAD ----
     bool startPassiveListening(const VADConfig& vadCfg,
@@ -200,16 +250,28 @@ public:
                                const VADCallbacks& cbs = {});
     void stopPassiveListening();
     bool isPassiveListening() const { return passiveListening_; }
+    /**
+     * @brief 静默监听中回声消除器的最新统计（延迟估计、ERLE、双讲等）
+     */
+    EchoCancellerStats echoCancellerStats() const;
+    /**
+     * @brief 静默监听的触发/误触发统计与最近一帧的频谱特征
+     */
+    VADStats vadStats() const;
+    /**
+     * @brief 上层确认某个已交付片段无效（如 STT 结果为空）时调用，计入误触发统计
+     */
+    void reportFalseTrigger();
     /**
      * @brief 删除指定的 VAD 录音文件（会等待写入完成）
      * @return 删除是否成功或文件不存在
      */
     bool removeVadFile(const std::string& path);
 
-    // *** 回声抑制函数 - 公开接口（供内部回调使用）***
+    // *** 回声消除 - 公开接口（供内部回调使用）***
     /**
-     * @brief 记录输出音频到缓冲区（用于回声检测）
-     * @note 此函数为 public，供匿名命名空间的 streamRead 回调使用
+     * @brief 将播放的 PCM 作为回声消除的远端参考（播放线程调用，实时安全）
+     * @note 此函数为 public，供匿名命名空间的 streamRead 回调使用；未在静默监听时直接返回
      */
     void recordOutputAudio(const void* pcm, std::size_t bytes, const AudioStreamConfig& config);
 
@@ -236,12 +298,26 @@ private:
     bool initialized_{false};
 
     // 录音上下文
+    std::mutex captureControlMutex_; // 串行化录音启动/停止（设备、消费线程与上下文的生命周期）
     void* captureContext_{nullptr}; // 实际类型为 ma_context*
     void* captureDevice_{nullptr}; // 实际类型为 ma_device*
     CaptureOptions captureOptions_{};
     mutable std::mutex captureMutex_;
     std::vector<std::uint8_t> captureBuffer_;
-    bool capturing_{false};
+    std::atomic<bool> capturing_{false};
+
+    // 录音实时路径：设备回调只写无锁环形缓冲并更新电平，其余处理交给消费线程
+    SpscByteRing captureRing_;
+    std::size_t captureBytesPerFrame_{0};
+    const AudioKernels::PcmKernels* captureKernels_{nullptr}; // 按录音格式选定的 DSP 内核
+    std::thread captureWorker_;
+    std::atomic<bool> captureWorkerRunning_{false};
+    std::atomic<std::uint32_t> captureSignal_{0}; // 每次写入后递增，消费线程在其上 wait
+    std::atomic<std::uint64_t> captureFramesTotal_{0};
+    std::atomic<std::uint64_t> captureFramesDropped_{0};
+    std::atomic<std::uint64_t> captureOverruns_{0};
+    std::atomic<float> captureLevelDb_{-90.0f};
+    std::atomic<float> capturePeak_{0.0f};
 
     // VAD/环形缓冲
     struct RingBuffer {
@@ -268,6 +344,13 @@ private:
     std::uint64_t currentAboveFrames_{0};
     std::uint64_t currentBelowFrames_{0};
     float lastDb_{-90.0f};
+    VoiceActivityDetector vadDetector_;        // 频谱 VAD（仅消费线程）
+    std::uint64_t lastVoicedFrames_{0};        // 上一批结束时检测器的累计语音帧数
+    std::uint64_t pendingVoicedFrames_{0};     // 触发前连续判为语音期间的有效语音帧
+    std::uint64_t segmentVoicedFrames_{0};     // 当前片段的有效语音帧
+    std::uint64_t minSpeechFrames_{0};
+    mutable std::mutex vadStatsMutex_;
+    VADStats vadStats_{};
 
     // *** VAD 文件管理 - 新增 ***
     struct VADFileRecord {
@@ -278,19 +361,16 @@ private:
     std::vector<VADFileRecord> vadCapturedFiles_;          // 记录所有生成的 VAD 文件及写入状态
     std::mutex vadFilesMutex_;                             // 保护 vadCapturedFiles_
 
-    // *** 回声抑制 - 新增 ***
-    struct OutputAudioBuffer {
-        std::vector<std::uint8_t> data;      // 环形缓冲区数据
-        std::size_t writePos{0};              // 写入位置
-        std::size_t sizeBytes{0};             // 当前数据大小
-        std::size_t capacityBytes{0};         // 容量
-        mutable std::mutex mutex;             // 保护缓冲区（mutable 以支持 const 方法）
-        AudioStreamConfig config{};           // 输出音频配置
-    };
-    OutputAudioBuffer outputBuffer_;          // 输出音频缓冲区
-    std::atomic<bool> isPlaying_{false};      // 是否有音频正在播放
-    float correlationThreshold_{0.7f};        // 相关性阈值（可配置）
-    std::uint32_t echoDelayMs_{100};          // 回声延迟估计（毫秒）
+    // *** 回声消除 ***
+    EchoCanceller echoCanceller_;              // 近端仅在录音消费线程处理，远端由播放线程写入
+    std::atomic<bool> farEndEnabled_{false};   // 是否向回声消除器写入远端参考
+    std::atomic<int> farEndWriters_{0};        // 正在写入远端参考的播放回调数
+    std::vector<float> monoScratch_;           // 近端第一声道 float，回声消除后为残差（消费线程）
+    std::vector<float> echoInterleaved_;       // 残差复制到各声道（消费线程）
+    std::vector<std::uint8_t> residualPcm_;    // 残差转回录音格式（消费线程）
+    mutable std::mutex echoStatsMutex_;
+    EchoCancellerStats echoStats_{};
+    std::atomic<bool> isPlaying_{false};       // 是否有音频正在播放
 
     // 内部工具
     ma_format toMiniaudioFormat(AudioFormat fmt) const;
@@ -308,16 +388,16 @@ private:
                      float thresholdDb) const;
     void resetRingAfterCapture(std::size_t bytesPerFrame, double prerollSeconds);
 
-    // *** 回声抑制函数 - 新增 ***
+    // *** 回声消除函数 ***
     /**
-     * @brief 计算输入音频与输出音频的相关性
-     * @return 相关性系数 [-1, 1]，接近1表示高度相似（可能是回声）
+     * @brief 对 monoScratch_ 中的一批录音做回声消除，残差按录音格式写回各声道
+     * @return 残差 PCM（内部缓冲，下次调用前有效）
      */
-    float computeCorrelation(const void* inputPcm, std::uint32_t inputFrames) const;
+    const void* cancelEcho(std::uint32_t frameCount);
     /**
-     * @brief 初始化输出音频缓冲区
+     * @brief 停止写入远端参考，并等待进行中的写入结束（之后可安全重配回声消除器）
      */
-    void ensureOutputBufferCapacity(const AudioStreamConfig& config);
+    void disableFarEnd();
     /**
      * @brief 淡出并停止所有播放
      */
@@ -341,6 +421,22 @@ private:
                                     const void* pInput,
                                     std::uint32_t frameCount);
     void onCaptureFrames(const void* pInput, std::uint32_t frameCount);
+    /**
+     * @brief 录音消费线程主循环：从环形缓冲取出数据交给 processCaptureFrames
+     */
+    void captureWorkerLoop();
+    /**
+     * @brief 处理一块录音数据（VAD、回声消除、内存缓存与 onData 回调），仅在消费线程调用
+     */
+    void processCaptureFrames(const void* pInput, std::uint32_t frameCount);
+    /**
+     * @brief 通知消费线程退出并等待其处理完剩余数据（不可在消费线程调用）
+     */
+    void stopCaptureWorker();
+    /**
+     * @brief 停止并释放录音设备、消费线程与上下文（需持有 captureControlMutex_，不可在消费线程调用）
+     */
+    void releaseCaptureLocked();
 };
 
 } // namespace naw::desktop_pet::service::utils
\ No newline at end of file
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "naw/desktop_pet/service/utils/Fft.h"
+#include "naw/desktop_pet/service/utils/SpscQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naw::desktop_pet::service::utils {
+
+/**
+ * @brief 回声消除参数
+ */
+struct EchoCancellerConfig {
+    bool enabled{true};                // 关闭时近端信号原样通过
+    std::uint32_t blockSize{256};      // 处理块帧数（向上取整为2的幂），FFT 长度为其2倍，也是固定处理延迟
+    std::uint32_t tailMs{128};         // 自适应滤波器覆盖的回声尾长（扬声器到麦克风的混响）
+    std::uint32_t maxDelayMs{500};     // 延迟搜索范围（播放缓冲 + 设备延迟）
+    std::uint32_t initialDelayMs{100}; // 尚未估计出延迟时使用的初始值
+    std::uint32_t delayUpdateMs{500};  // GCC-PHAT 延迟估计的更新间隔
+    float stepSize{0.5f};              // NLMS 归一化步长 μ (0,1]
+};
+
+/**
+ * @brief 回声消除运行统计
+ */
+struct EchoCancellerStats {
+    float delayMs{0.0f};         // 最近采用的远端到近端延迟估计
+    float delayConfidence{0.0f}; // 最近一次 GCC-PHAT 峰值与均值之比
+    float erleDb{0.0f};          // 回声回损增强（平滑后的近端/残差能量比）
+    bool farEndActive{false};    // 滤波器覆盖范围内是否有远端信号
+    bool doubleTalk{false};      // 最近一块是否判定为双讲（冻结自适应）
+    std::uint64_t farEndGaps{0};      // 远端参考中断后重新对齐到近端时间轴的次数
+    std::uint64_t farEndDropped{0};   // 因缓冲已满或领先过多而丢弃的远端帧数
+};
+
+/**
+ * @brief 自适应回声消除器（频域分块 NLMS + GCC-PHAT 延迟估计）
+ *
+ * - 远端参考（播放的 TTS PCM）由播放线程通过 pushFarEnd 写入无锁环形缓冲，不加锁、不分配内存；
+ * - 近端（麦克风）在录音消费线程调用 process；远端样本取出时按近端已处理的帧数编号，
+ *   中断后重新对齐，两路共用同一时间轴，剩余的固定偏移由延迟估计吸收；
+ * - GCC-PHAT 定期估计远端到近端的整体延迟，滤波器只需覆盖 tailMs 的回声尾；
+ * - 分块频域自适应滤波器（重叠保留，轮流对一个分块施加梯度约束）估计回声并从近端减去；
+ * - 残差相对回声估计明显偏大（滤波器已收敛时）视为双讲，暂停自适应，避免近端语音把滤波器带偏。
+ * 输出相对输入有固定 blockSize 帧的延迟。
+ */
+class EchoCanceller {
+public:
+    EchoCanceller() = default;
+    EchoCanceller(const EchoCanceller&) = delete;
+    EchoCanceller& operator=(const EchoCanceller&) = delete;
+
+    /**
+     * @brief 按近端采样率分配内部状态并清空（非线程安全，需在无并发调用时进行）
+     */
+    void configure(std::uint32_t sampleRate, const EchoCancellerConfig& config);
+
+    /**
+     * @brief 清空滤波器与缓冲（非线程安全）
+     */
+    void reset();
+
+    bool isConfigured() const { return m_sampleRate != 0; }
+    const EchoCancellerConfig& config() const { return m_config; }
+
+    /**
+     * @brief 写入远端参考（单声道 float，仅播放线程调用，实时安全）
+     * @param sampleRate 远端采样率，与近端不同时在消费侧线性重采样
+     * @return 参考缓冲已满或未配置时返回 false（本段被丢弃；缓冲已满时计入 farEndDropped）
+     */
+    bool pushFarEnd(const float* mono, std::size_t frames, std::uint32_t sampleRate);
+
+    /**
+     * @brief 原地处理近端单声道信号（仅录音消费线程调用）
+     * @return 本次是否实际进行了回声消除（远端静默时为直通）
+     */
+    bool process(float* mic, std::size_t frames);
+
+    /**
+     * @brief 获取统计（仅录音消费线程调用，或在 process 不会并发时调用）
+     */
+    EchoCancellerStats stats() const {
+        EchoCancellerStats stats = m_stats;
+        stats.farEndDropped += m_farRingDropped.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    using Complex = Fft::Complex;
+
+    void drainFarEnd();
+    void appendFarSample(float sample);
+    void processBlock(const float* mic, float* out);
+    void estimateDelay();
+    void applyDelay(std::size_t delaySamples);
+    void resetFilter();
+    float farHistoryAt(std::uint64_t index) const {
+        return index < m_farWritePos ? m_farHistory[index & m_historyMask] : 0.0f;
+    }
+
+    EchoCancellerConfig m_config{};
+    std::uint32_t m_sampleRate{0};
+    std::size_t m_block{0};      // N
+    std::size_t m_partitions{0}; // P
+
+    // 远端参考：播放线程 -> 消费线程
+    SpscByteRing m_farRing;
+    std::atomic<std::uint32_t> m_farRate{0};
+    std::atomic<std::uint64_t> m_farRingDropped{0}; // 环形缓冲已满时 pushFarEnd 丢弃的帧数（播放线程累加）
+    std::vector<float> m_farRaw;     // 从环形缓冲取出的原始远端样本
+    double m_resamplePos{0.0};       // 重采样的小数读位置（相对 m_farRaw）
+    float m_resamplePrev{0.0f};      // 上一批最后一个原始样本，用于跨批插值
+    std::uint64_t m_farWritePos{0};  // 下一个远端样本在历史中的帧序号（与近端同一时间轴）
+    std::size_t m_maxFarAhead{0};    // 远端最多领先近端的帧数
+    std::size_t m_farJitter{0};      // 远端落后近端多少帧以内视为抖动（最大录音批次 + 1 块）
+
+    // 输入/输出块缓冲（固定 N 帧延迟）
+    std::vector<float> m_inFifo;
+    std::vector<float> m_outFifo;
+    std::size_t m_outHead{0};
+
+    // 历史：近端与远端按同一帧序号存放
+    std::vector<float> m_farHistory;
+    std::vector<float> m_micHistory;
+    std::uint64_t m_historyMask{0};
+    std::uint64_t m_frames{0};       // 已处理的帧总数
+    std::size_t m_bulkDelay{0};      // 送入滤波器的远端整体延迟（帧）
+    std::size_t m_headroom{0};       // 延迟估计向前留出的余量，由滤波器因果部分吸收
+    std::uint64_t m_lastFarActive{0};
+    bool m_hasFarActivity{false};
+
+    // 频域自适应滤波器
+    Fft m_fft;
+    std::vector<Complex> m_weights;  // P 个分块 × bins
+    std::vector<Complex> m_farSpectra; // 最近 P 个远端块的频谱（环形，按分块）
+    std::size_t m_spectraHead{0};
+    std::vector<float> m_power;      // 每个频点的平滑远端功率
+    std::size_t m_constrainIndex{0};
+    std::vector<float> m_timeBuf;
+    std::vector<Complex> m_specBuf;
+    std::vector<Complex> m_errSpec;
+
+    // 收敛/双讲判定
+    double m_micPowerSmoothed{0.0};
+    double m_errPowerSmoothed{0.0};
+    std::uint32_t m_doubleTalkHold{0};
+    std::uint32_t m_divergeCount{0};
+
+    // GCC-PHAT
+    Fft m_delayFft;
+    std::size_t m_delayWindow{0};
+    std::uint64_t m_nextDelayUpdate{0};
+    std::size_t m_pendingDelay{0};
+    std::uint32_t m_pendingVotes{0};
+    std::vector<float> m_delayMic;
+    std::vector<float> m_delayFar;
+    std::vector<Complex> m_delayMicSpec;
+    std::vector<Complex> m_delayFarSpec;
+    std::vector<float> m_delayCorr;
+
+    EchoCancellerStats m_stats{};
+};
+
+} // namespace naw::desktop_pet::service::utils
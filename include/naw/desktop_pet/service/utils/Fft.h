@@ -0,0 +1,56 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace naw::desktop_pet::service::utils {
+
+/**
+ * @brief 定长实数 FFT（基2，长度为2的幂）
+ *
+ * 长度为 n 的实数序列通过一次 n/2 点复数 FFT 计算（偶/奇样本打包为实部/虚部），
+ * 旋转因子与位反转表在构造时预计算，变换过程不分配内存。
+ * 正变换不做归一化，逆变换乘以 1/n，使 inverse(forward(x)) == x。
+ */
+class Fft {
+public:
+    using Complex = std::complex<float>;
+
+    Fft() = default;
+    /**
+     * @param size 变换长度（至少为4，会向上取整为2的幂）
+     */
+    explicit Fft(std::size_t size);
+
+    std::size_t size() const { return m_size; }
+    /**
+     * @brief 频点数（size/2 + 1，包含直流与奈奎斯特频点）
+     */
+    std::size_t bins() const { return m_size / 2 + 1; }
+
+    /**
+     * @brief 实数正变换
+     * @param in size 个样本
+     * @param out bins() 个频点
+     */
+    void forward(const float* in, Complex* out);
+
+    /**
+     * @brief 实数逆变换（输入视为共轭对称谱的前半部分）
+     * @param in bins() 个频点（不会被修改）
+     * @param out size 个样本
+     */
+    void inverse(const Complex* in, float* out);
+
+private:
+    void transform(Complex* data, bool inverse) const;
+
+    std::size_t m_size{0};
+    std::vector<Complex> m_twiddles;      // n/2 点复数 FFT 的旋转因子 e^{-2πik/(n/2)}
+    std::vector<Complex> m_realTwiddles;  // 打包拆分用的 e^{-2πik/n}
+    std::vector<std::size_t> m_bitReverse;
+    std::vector<Complex> m_work;
+};
+
+} // namespace naw::desktop_pet::service::utils
@@ -8,6 +8,7 @@
 #include <mutex>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <chrono>
 
@@ -117,7 +118,7 @@ public:
      * @brief POST请求
      */
     HttpResponse post(const std::string& path,
-                     const std::string& body = "",
+                     std::string body = "",
                      const std::string& contentType = "application/json",
                      const std::map<std::string, std::string>& headers = {});
     
@@ -163,7 +164,10 @@ public:
     struct MultipartFile {
         std::string filename;
         std::string contentType;
-        std::string data; // 简化：内存数据
+        std::string data; // 内存数据
+        // 依次接在 data 之后的非拥有数据段（调用期间需保持有效），
+        // 如 data 放 WAV 头、chunks 直接引用 PCM 缓冲，避免先拼出一份完整文件
+        std::vector<std::string_view> chunks;
     };
 
     /**
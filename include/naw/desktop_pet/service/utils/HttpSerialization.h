@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <optional>
@@ -27,8 +29,42 @@ std::string toJsonBody(const nlohmann::json& j, bool pretty = false);
 std::optional<nlohmann::json> parseJsonSafe(const std::string& text, std::string* error = nullptr);
 
 // Base64 编码/解码（标准字符表，无换行）
+// 解码遇到第一个 '=' 即结束（之后的内容忽略），其他非字母表字符视为失败
 std::string encodeBase64(const std::vector<uint8_t>& data);
 std::string encodeBase64(const std::string& data);
-std::optional<std::vector<uint8_t>> decodeBase64(const std::string& text);
+std::optional<std::vector<uint8_t>> decodeBase64(std::string_view text);
+
+// Base64 编码后的长度（含填充）
+constexpr size_t base64EncodedSize(size_t size) { return (size + 2) / 3 * 4; }
+
+// Base64 编码并追加到 out 末尾（直接写入调用方的缓冲，可复用其容量，不产生中间字符串）
+void appendBase64(const uint8_t* data, size_t size, std::string& out);
+
+// 只校验不解码：返回与 decodeBase64(text)->size() 相同的长度，非法输入返回 std::nullopt
+std::optional<size_t> base64DecodedSize(std::string_view text);
+
+// 分块 Base64 编码：数据可按任意长度分块送入，输出与一次性编码相同
+class Base64Encoder {
+public:
+    // 编码本块（不足3字节的尾部留到下一块），结果追加到 out
+    void update(const uint8_t* data, size_t size, std::string& out);
+    // 输出剩余字节与填充，之后可以开始新的编码
+    void finish(std::string& out);
+
+private:
+    uint8_t m_pending[2]{};
+    size_t m_pendingSize{0};
+};
+
+// Base64 的 SIMD 实现级别（首次使用时检测CPU）
+enum class Base64SimdLevel {
+    Scalar,
+    SSSE3,
+    AVX2
+};
+
+Base64SimdLevel base64SimdLevel();
+// 强制使用指定级别（用于测试；不支持的级别回退到标量实现）
+void setBase64SimdLevel(Base64SimdLevel level);
 
 } // namespace naw::desktop_pet::service::utils
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace naw::desktop_pet::service::utils {
+
+/**
+ * @brief 有界单生产者单消费者无锁队列
+ *
+ * 容量向上取整为2的幂；生产者只写 tail、消费者只写 head，各自位于独立的缓存行，
+ * 入队/出队都不加锁、不分配内存。只允许一个线程调用 tryPush、一个线程调用 tryPop。
+ * T 需要可默认构造与移动赋值（槽位预先构造，出队后保留被移走的对象）。
+ */
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief 入队（仅生产者线程）
+     * @return 队列已满时返回 false，value 保持不变
+     */
+    bool tryPush(T&& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask) {
+            // 缓存的 head 过期时才读取消费者的原子变量，减少缓存行争用
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask) {
+                return false;
+            }
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 出队（仅消费者线程）
+     * @return 队列为空时返回 false
+     */
+    bool tryPop(T& out) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return false;
+            }
+        }
+        out = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 当前元素数（其他线程同时操作时只是近似值）
+     */
+    size_t size() const {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return m_mask + 1; }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    std::vector<T> m_slots;
+    size_t m_mask{0};
+    alignas(kCacheLine) std::atomic<size_t> m_head{0};  // 消费者写
+    size_t m_cachedTail{0};                             // 消费者缓存的 tail
+    alignas(kCacheLine) std::atomic<size_t> m_tail{0};  // 生产者写
+    size_t m_cachedHead{0};                             // 生产者缓存的 head
+};
+
+/**
+ * @brief 有界单生产者单消费者无锁字节环形缓冲
+ *
+ * 面向音频回调等实时线程：write 只做 memcpy 与一次原子发布，不加锁、不分配内存、不阻塞，
+ * 空间不足时整块拒绝（由调用方计入丢帧），保证消费者读到的永远是完整写入的数据。
+ * 读写跨越环尾时拆成两段拷贝。reset 需在无并发读写时调用。
+ */
+class SpscByteRing {
+public:
+    SpscByteRing() = default;
+    explicit SpscByteRing(size_t capacity) { reset(capacity); }
+
+    SpscByteRing(const SpscByteRing&) = delete;
+    SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+    /**
+     * @brief 重新分配容量（向上取整为2的幂）并清空（非线程安全）
+     */
+    void reset(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_data.assign(size, 0);
+        m_mask = size - 1;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_cachedHead = 0;
+        m_cachedTail = 0;
+    }
+
+    /**
+     * @brief 写入整块数据（仅生产者线程）
+     * @return 剩余空间不足 bytes 时返回 false，且不写入任何字节
+     */
+    bool write(const void* data, size_t bytes) {
+        if (bytes == 0) {
+            return true;
+        }
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (bytes > capacity() - (tail - m_cachedHead)) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (bytes > capacity() - (tail - m_cachedHead)) {
+                return false;
+            }
+        }
+        const size_t offset = tail & m_mask;
+        const size_t first = std::min(bytes, capacity() - offset);
+        const auto* src = static_cast<const uint8_t*>(data);
+        std::memcpy(m_data.data() + offset, src, first);
+        if (first < bytes) {
+            std::memcpy(m_data.data(), src + first, bytes - first);
+        }
+        m_tail.store(tail + bytes, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 读出至多 maxBytes 字节（仅消费者线程）
+     * @return 实际读出的字节数，为空时返回 0
+     */
+    size_t read(void* out, size_t maxBytes) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_cachedTail - head < maxBytes) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+        const size_t bytes = std::min(maxBytes, m_cachedTail - head);
+        if (bytes == 0) {
+            return 0;
+        }
+        const size_t offset = head & m_mask;
+        const size_t first = std::min(bytes, capacity() - offset);
+        auto* dst = static_cast<uint8_t*>(out);
+        std::memcpy(dst, m_data.data() + offset, first);
+        if (first < bytes) {
+            std::memcpy(dst + first, m_data.data(), bytes - first);
+        }
+        m_head.store(head + bytes, std::memory_order_release);
+        return bytes;
+    }
+
+    /**
+     * @brief 可读字节数（其他线程同时操作时只是近似值）
+     */
+    size_t size() const {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return m_data.size(); }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    std::vector<uint8_t> m_data;
+    size_t m_mask{0};
+    alignas(kCacheLine) std::atomic<size_t> m_head{0};  // 消费者写
+    size_t m_cachedTail{0};                             // 消费者缓存的 tail
+    alignas(kCacheLine) std::atomic<size_t> m_tail{0};  // 生产者写
+    size_t m_cachedHead{0};                             // 生产者缓存的 head
+};
+
+} // namespace naw::desktop_pet::service::utils
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "naw/desktop_pet/service/utils/Fft.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace naw::desktop_pet::service::utils {
+
+/**
+ * @brief 频谱 VAD 参数
+ */
+struct SpectralVadConfig {
+    bool enabled{true};             // 关闭时退回 VADConfig 的固定 dB 阈值
+    float minLevelDb{-60.0f};       // 语音频带电平下限（dBFS），低于此值一律视为静音
+    float startSnrDb{8.0f};         // 进入语音：各频带相对噪声底的平均信噪比
+    float stopSnrDb{4.0f};          // 保持语音的信噪比（迟滞，应低于 start）
+    float maxFlatness{0.35f};       // 白化后频谱平坦度上限：语音有谐波结构，风扇/敲击声接近1
+    std::uint32_t hangoverMs{240};  // 最后一个语音帧之后仍判为语音的时长，避免词间停顿截断
+    float noiseRiseDbPerSec{3.0f};  // 噪声底上升速度（下降时快速跟随）
+    std::uint32_t calibrationMs{250}; // 启动后用于估计初始噪声底的时长（期间不判为语音）
+};
+
+/**
+ * @brief 最近一帧的分析结果
+ */
+struct SpectralVadFrame {
+    float levelDb{-90.0f};      // 语音频带电平
+    float noiseFloorDb{-90.0f}; // 语音频带噪声底
+    float snrDb{0.0f};          // 各频带信噪比（dB，负值记为0）的平均
+    float flatness{1.0f};       // 按噪声底白化后的频谱平坦度 [0,1]
+    bool voiced{false};         // 本帧是否满足语音条件（不含拖尾）
+};
+
+/**
+ * @brief 基于频带能量与频谱平坦度的语音活动检测
+ *
+ * - 约 20ms 的 Hann 窗帧、50% 重叠，在 250–4000Hz 内按对数间隔划分频带；
+ * - 每个频带跟踪噪声底：低于噪声底时快速下降，否则按 noiseRiseDbPerSec 缓慢上升
+ *   （语音帧上升更慢），风扇等平稳噪声会被吸收进噪声底；
+ * - 语音帧需同时满足：电平高于下限、平均频带信噪比高于阈值、白化频谱不平坦；
+ * - 语音状态带拖尾（hangover）。
+ * 仅在单一线程（录音消费线程）调用，处理过程不分配内存。
+ */
+class VoiceActivityDetector {
+public:
+    VoiceActivityDetector() = default;
+
+    void configure(std::uint32_t sampleRate, const SpectralVadConfig& config);
+    void reset();
+
+    /**
+     * @brief 送入单声道 float 样本
+     * @return 处理完本批后的语音状态（含拖尾）
+     */
+    bool process(const float* mono, std::size_t frames);
+
+    bool isSpeech() const { return m_speech; }
+    /**
+     * @brief 累计满足语音条件的帧数（按帧移计，不含拖尾），用于统计一段录音的有效语音长度
+     */
+    std::uint64_t voicedFrames() const { return m_voicedFrames; }
+    const SpectralVadFrame& lastFrame() const { return m_last; }
+
+private:
+    void analyze(const float* frame);
+    float bandPowerToDb(double power) const;
+
+    SpectralVadConfig m_config{};
+    std::uint32_t m_sampleRate{0};
+    std::size_t m_frameSize{0};
+    std::size_t m_hop{0};
+    Fft m_fft;
+    std::vector<float> m_window;
+    double m_windowPower{1.0};
+    std::vector<std::size_t> m_bandEdges; // 频带边界（频点下标，左闭右开）
+    std::vector<double> m_bandEnergy;
+    std::vector<double> m_noise;          // 各频带噪声底
+    double m_riseFactor{1.0};
+    double m_speechRiseFactor{1.0};
+    std::uint32_t m_hangoverFrames{0};
+    std::uint32_t m_calibrationFrames{0};
+
+    std::vector<float> m_pending;
+    std::size_t m_pendingHead{0};
+    std::vector<float> m_timeBuf;
+    std::vector<Fft::Complex> m_spec;
+
+    std::uint64_t m_framesSeen{0};
+    std::uint32_t m_hangover{0};
+    bool m_speech{false};
+    std::uint64_t m_voicedFrames{0};
+    SpectralVadFrame m_last{};
+};
+
+} // namespace naw::desktop_pet::service::utils
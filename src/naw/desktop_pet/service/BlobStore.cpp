@@ -0,0 +1,176 @@
+#include "naw/desktop_pet/service/BlobStore.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace naw::desktop_pet::service {
+
+namespace {
+
+// 累计释放这么多缓冲后清扫一次过期的弱引用
+constexpr size_t kSweepThreshold = 1024;
+
+size_t hashContent(std::string_view content) {
+    return std::hash<std::string_view>{}(content);
+}
+
+} // namespace
+
+nlohmann::json BlobStore::Stats::toJson() const {
+    nlohmann::json j;
+    j["unique_blobs"] = uniqueBlobs;
+    j["unique_bytes"] = uniqueBytes;
+    j["referenced_bytes"] = referencedBytes;
+    j["saved_bytes"] = savedBytes();
+    j["dedup_hits"] = dedupHits;
+    nlohmann::json subs = nlohmann::json::object();
+    for (const auto& [name, s] : subsystems) {
+        subs[name] = {{"live_refs", s.liveRefs}, {"referenced_bytes", s.referencedBytes}};
+    }
+    j["subsystems"] = std::move(subs);
+    return j;
+}
+
+BlobStore::BlobStore() : m_impl(std::make_shared<Impl>()) {}
+
+BlobStore& BlobStore::shared() {
+    // 不析构：静态对象销毁后仍可能有句柄被释放
+    static BlobStore* instance = new BlobStore();
+    return *instance;
+}
+
+BlobStore::Blob BlobStore::intern(std::string content, std::string_view subsystem) {
+    const size_t hash = hashContent(content);
+    Blob master;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        master = lookupLocked(hash, content);
+        if (master) {
+            m_impl->dedupHits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            master = insertLocked(hash, std::move(content));
+        }
+    }
+    return makeLease(std::move(master), subsystem);
+}
+
+BlobStore::Blob BlobStore::internView(std::string_view content, std::string_view subsystem) {
+    const size_t hash = hashContent(content);
+    Blob master;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        master = lookupLocked(hash, content);
+        if (master) {
+            m_impl->dedupHits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            master = insertLocked(hash, std::string(content));
+        }
+    }
+    return makeLease(std::move(master), subsystem);
+}
+
+BlobStore::Stats BlobStore::getStats() const {
+    Stats stats;
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    stats.uniqueBlobs = m_impl->uniqueBlobs.load();
+    stats.uniqueBytes = m_impl->uniqueBytes.load();
+    stats.dedupHits = m_impl->dedupHits.load();
+    for (const auto& [name, counters] : m_impl->subsystems) {
+        SubsystemStats s;
+        s.liveRefs = counters.liveRefs.load();
+        s.referencedBytes = counters.referencedBytes.load();
+        stats.referencedBytes += s.referencedBytes;
+        stats.subsystems.emplace(name, s);
+    }
+    return stats;
+}
+
+// ========== 内部辅助方法 ==========
+
+BlobStore::Blob BlobStore::lookupLocked(size_t hash, std::string_view content) const {
+    auto it = m_impl->buckets.find(hash);
+    if (it == m_impl->buckets.end()) {
+        return nullptr;
+    }
+    for (const auto& weak : it->second) {
+        // 释放回调只更新原子计数、不加锁，因此在锁内释放临时引用是安全的
+        if (Blob blob = weak.lock()) {
+            if (*blob == content) {
+                return blob;
+            }
+        }
+    }
+    return nullptr;
+}
+
+BlobStore::Blob BlobStore::insertLocked(size_t hash, std::string content) {
+    const size_t size = content.size();
+    std::weak_ptr<Impl> weakImpl = m_impl;
+    Blob master(new std::string(std::move(content)), [weakImpl, size](const std::string* p) {
+        if (auto impl = weakImpl.lock()) {
+            impl->uniqueBlobs.fetch_sub(1, std::memory_order_relaxed);
+            impl->uniqueBytes.fetch_sub(size, std::memory_order_relaxed);
+            impl->releasedSinceSweep.fetch_add(1, std::memory_order_relaxed);
+        }
+        delete p;
+    });
+
+    auto& bucket = m_impl->buckets[hash];
+    bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+                                [](const std::weak_ptr<const std::string>& w) { return w.expired(); }),
+                 bucket.end());
+    bucket.push_back(master);
+    m_impl->uniqueBlobs.fetch_add(1, std::memory_order_relaxed);
+    m_impl->uniqueBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (m_impl->releasedSinceSweep.load(std::memory_order_relaxed) >= kSweepThreshold) {
+        sweepLocked();
+    }
+    return master;
+}
+
+BlobStore::Blob BlobStore::makeLease(Blob master, std::string_view subsystem) {
+    Counters* counters = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        auto it = m_impl->subsystems.find(subsystem);
+        if (it == m_impl->subsystems.end()) {
+            it = m_impl->subsystems.try_emplace(std::string(subsystem)).first;
+        }
+        counters = &it->second;
+    }
+
+    // 每个句柄单独计入子系统；句柄持有主缓冲与 Impl，保证计数器在句柄存活期间有效
+    struct Lease {
+        Blob master;
+        std::shared_ptr<Impl> impl;
+        Counters* counters;
+        Lease(Blob m, std::shared_ptr<Impl> i, Counters* c)
+            : master(std::move(m)), impl(std::move(i)), counters(c) {
+            counters->liveRefs.fetch_add(1, std::memory_order_relaxed);
+            counters->referencedBytes.fetch_add(master->size(), std::memory_order_relaxed);
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() {
+            counters->liveRefs.fetch_sub(1, std::memory_order_relaxed);
+            counters->referencedBytes.fetch_sub(master->size(), std::memory_order_relaxed);
+        }
+    };
+    const std::string* raw = master.get();
+    auto lease = std::make_shared<Lease>(std::move(master), m_impl, counters);
+    return Blob(std::move(lease), raw);
+}
+
+void BlobStore::sweepLocked() {
+    for (auto it = m_impl->buckets.begin(); it != m_impl->buckets.end();) {
+        auto& bucket = it->second;
+        bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+                                    [](const std::weak_ptr<const std::string>& w) { return w.expired(); }),
+                     bucket.end());
+        it = bucket.empty() ? m_impl->buckets.erase(it) : std::next(it);
+    }
+    m_impl->releasedSinceSweep.store(0, std::memory_order_relaxed);
+}
+
+} // namespace naw::desktop_pet::service
@@ -1,5 +1,6 @@
 #include "naw/desktop_pet/service/ContextManager.h"
 
+#include "naw/desktop_pet/service/ContextPacker.h"
 #include "naw/desktop_pet/service/ErrorHandler.h"
 #include "naw/desktop_pet/service/ProjectContextCollector.h"
 #include "naw/desktop_pet/service/ToolManager.h"
@@ -105,10 +106,14 @@ void ConversationHistory::trimHistoryByTokens(
 // ========== ContextManager 实现 ==========
 
 ContextManager::ContextManager(ConfigManager& configManager, APIClient* apiClient)
-    : m_configManager(configManager) {
+    : m_configManager(configManager)
+    , m_projectCollector(std::make_unique<ProjectContextCollector>(FileContentCache::shared())) {
     // 加载默认配置
     loadConfigFromFile();
     
+    // 配置了项目路径时在后台预热项目分析，缩短首个代码问题的等待时间
+    startProjectWarmup();
+    
     // ContextRefiner 已移除，不再创建
     (void)apiClient; // 保留参数以保持接口兼容性
 }
@@ -200,6 +205,10 @@ types::ChatMessage ContextManager::buildProjectContext(
             oss << "  - " << file << "\n";
         }
     }
+    if (!projectContext.relevantCode.empty()) {
+        oss << "- Relevant Code:\n";
+        oss << projectContext.relevantCode;
+    }
 
     msg.setText(oss.str());
     return msg;
@@ -233,6 +242,47 @@ types::ChatMessage ContextManager::buildCodeContext(const CodeContext& codeConte
     return msg;
 }
 
+types::ChatMessage ContextManager::buildCodeContext(
+    const CodeContext& codeContext,
+    const std::string& query,
+    const std::string& modelId,
+    size_t tokenBudget
+) const {
+    if (tokenBudget == 0) {
+        return buildCodeContext(codeContext);
+    }
+
+    ContextPackerConfig packerConfig;
+    packerConfig.tokenBudget = tokenBudget;
+    ContextPacker packer(m_tokenEstimator, modelId, packerConfig);
+
+    // 焦点区域（函数名、类名等）参与相关性排序
+    std::string rankingQuery = query;
+    if (codeContext.focusArea.has_value()) {
+        rankingQuery += "\n" + *codeContext.focusArea;
+    }
+
+    PackedContext packed;
+    if (codeContext.fileContent.has_value()) {
+        // 已给出文件内容：只对该内容切片
+        ContextPacker::Document doc;
+        doc.path = codeContext.filePaths.empty() ? std::string("<content>") : codeContext.filePaths.front();
+        doc.content = std::make_shared<const std::string>(*codeContext.fileContent);
+        doc.dependencyScore = 1.0;
+        packed = packer.pack(rankingQuery, {doc});
+    } else {
+        packed = packer.packFiles(rankingQuery, codeContext.filePaths, codeContext.filePaths);
+    }
+
+    CodeContext packedContext;
+    packedContext.filePaths = codeContext.filePaths;
+    packedContext.focusArea = codeContext.focusArea;
+    if (!packed.empty()) {
+        packedContext.fileContent = packed.render();
+    }
+    return buildCodeContext(packedContext);
+}
+
 types::ChatMessage ContextManager::buildMemoryContext(
     const std::vector<MemoryEvent>& events,
     types::TaskType /* taskType */
@@ -276,7 +326,6 @@ std::vector<types::ChatMessage> ContextManager::buildContext(
     // 3. 项目上下文（如果启用）
     if (config.includeProjectContext) {
         try {
-            ProjectContextCollector collector;
             ErrorInfo error;
             
             // 确定项目路径
@@ -291,10 +340,32 @@ std::vector<types::ChatMessage> ContextManager::buildContext(
             }
             
             // 收集项目上下文
-            ProjectContext projectContext = collector.collectProjectContext(projectRoot, &error);
+            ProjectInfo projectInfo;
+            ProjectContext projectContext =
+                m_projectCollector->collectProjectContext(projectRoot, &error, &projectInfo);
             
             // 如果收集成功，添加到消息列表
             if (error.message.empty() && !projectContext.projectRoot.empty()) {
+                // 按Token预算打包与用户问题相关的代码片段
+                if (config.contextSnippetTokens > 0) {
+                    ContextPackerConfig packerConfig;
+                    packerConfig.tokenBudget = config.contextSnippetTokens;
+                    ContextPacker packer(m_tokenEstimator, modelId, packerConfig,
+                                         m_projectCollector->getFileCache());
+                    
+                    std::vector<std::string> candidates = projectInfo.sourceFiles;
+                    candidates.insert(candidates.end(),
+                                      projectInfo.headerFiles.begin(), projectInfo.headerFiles.end());
+                    auto anchors = ContextPacker::findMentionedFiles(userMessage, candidates);
+                    
+                    PackedContext packed = packer.packFiles(
+                        userMessage, candidates, anchors, projectInfo.dependencyGraph.get());
+                    if (!packed.empty()) {
+                        projectContext.relevantFiles = packed.files();
+                        projectContext.relevantCode = packed.render();
+                    }
+                }
+
                 messages.push_back(buildProjectContext(projectContext, config.taskType));
             }
             // 如果收集失败，静默忽略（不中断流程）
@@ -521,9 +592,39 @@ bool ContextManager::loadConfigFromFile(ErrorInfo* /* err */) {
         m_config.includeProjectContext = includeProjectContext->get<bool>();
     }
 
+    auto projectPath = m_configManager.get("context.project_path");
+    if (projectPath.has_value() && projectPath->is_string() && !projectPath->get<std::string>().empty()) {
+        m_config.projectPath = projectPath->get<std::string>();
+    }
+
+    auto warmStart = m_configManager.get("context.warm_start");
+    if (warmStart.has_value() && warmStart->is_boolean()) {
+        m_config.warmStartProject = warmStart->get<bool>();
+    }
+
     return true;
 }
 
+bool ContextManager::startProjectWarmup() {
+    std::optional<std::string> projectPath;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_config.warmStartProject) {
+            return false;
+        }
+        projectPath = m_config.projectPath;
+    }
+    std::error_code ec;
+    if (!projectPath.has_value() || projectPath->empty() || !std::filesystem::is_directory(*projectPath, ec)) {
+        return false;
+    }
+    return m_projectCollector->startWarmup(*projectPath);
+}
+
+nlohmann::json ContextManager::getProjectWarmupStatus() const {
+    return m_projectCollector->getWarmupStatus().toJson();
+}
+
 void ContextManager::updateConfig(const ContextConfig& config) {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_config = config;
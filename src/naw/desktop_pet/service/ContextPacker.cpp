@@ -0,0 +1,716 @@
+#include "naw/desktop_pet/service/ContextPacker.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <filesystem>
+#include <regex>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace naw::desktop_pet::service {
+
+namespace {
+
+// 词法相似度中忽略的常见关键字/虚词
+const std::unordered_set<std::string>& stopTerms() {
+    static const std::unordered_set<std::string> terms = {
+        "the", "and", "for", "with", "this", "that", "from", "what", "how", "why", "are", "can",
+        "int", "void", "const", "return", "auto", "bool", "char", "std", "string", "include",
+        "if", "else", "while", "static", "public", "private", "protected", "class", "struct",
+        "namespace", "using", "template", "typename", "true", "false", "nullptr", "def", "self",
+        "import", "none", "not"
+    };
+    return terms;
+}
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+bool isIdentChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isBlank(const std::string& line) {
+    return std::all_of(line.begin(), line.end(),
+                       [](unsigned char c) { return std::isspace(c); });
+}
+
+std::string trimLeft(const std::string& line) {
+    size_t pos = 0;
+    while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos]))) {
+        ++pos;
+    }
+    return line.substr(pos);
+}
+
+std::vector<std::string> splitLines(const std::string& content) {
+    std::vector<std::string> lines;
+    std::istringstream iss(content);
+    std::string line;
+    while (std::getline(iss, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+std::string joinLines(const std::vector<std::string>& lines, size_t begin, size_t end) {
+    std::string text;
+    for (size_t i = begin; i < end; ++i) {
+        text += lines[i];
+        text += '\n';
+    }
+    return text;
+}
+
+std::string languageOf(const std::string& filePath) {
+    std::string ext = toLower(fs::path(filePath).extension().string());
+    if (ext == ".py") {
+        return "python";
+    }
+    if (ext == ".cpp" || ext == ".cc" || ext == ".cxx" || ext == ".c" ||
+        ext == ".h" || ext == ".hpp" || ext == ".hxx" || ext == ".hh") {
+        return "cpp";
+    }
+    return "other";
+}
+
+// 从片段头部（第一个 '{' 之前）提取符号名
+std::string extractCppSymbol(const std::string& header) {
+    static const std::regex typeRegex(R"(\b(?:class|struct|union|enum(?:\s+class)?)\s+(\w+))");
+    static const std::regex funcRegex(R"((~?[A-Za-z_][\w:]*)\s*\()");
+
+    std::smatch match;
+    if (std::regex_search(header, match, typeRegex)) {
+        return match[1].str();
+    }
+    std::string name;
+    auto begin = std::sregex_iterator(header.begin(), header.end(), funcRegex);
+    for (auto it = begin; it != std::sregex_iterator(); ++it) {
+        std::string candidate = (*it)[1].str();
+        if (candidate != "if" && candidate != "for" && candidate != "while" &&
+            candidate != "switch" && candidate != "return" && candidate != "sizeof") {
+            name = candidate;
+            break;
+        }
+    }
+    return name;
+}
+
+// 超过最大行数的片段按窗口拆分
+void appendSlice(
+    std::vector<ContextSnippet>& slices,
+    const std::string& filePath,
+    const std::vector<std::string>& lines,
+    size_t begin,
+    size_t end,
+    const std::string& symbol,
+    size_t maxSnippetLines
+) {
+    // 去除首尾空行
+    while (begin < end && isBlank(lines[begin])) {
+        ++begin;
+    }
+    while (end > begin && isBlank(lines[end - 1])) {
+        --end;
+    }
+    if (begin >= end) {
+        return;
+    }
+
+    size_t window = std::max<size_t>(1, maxSnippetLines);
+    size_t part = 0;
+    for (size_t start = begin; start < end; start += window) {
+        size_t stop = std::min(end, start + window);
+        ContextSnippet slice;
+        slice.filePath = filePath;
+        slice.startLine = start + 1;
+        slice.endLine = stop;
+        slice.symbol = symbol;
+        if (end - begin > window) {
+            slice.symbol += (symbol.empty() ? "" : " ") + std::string("(part ") + std::to_string(++part) + ")";
+        }
+        slice.text = joinLines(lines, start, stop);
+        slices.push_back(std::move(slice));
+    }
+}
+
+std::vector<ContextSnippet> sliceCpp(
+    const std::string& filePath,
+    const std::vector<std::string>& lines,
+    size_t maxSnippetLines
+) {
+    std::vector<ContextSnippet> slices;
+
+    int depth = 0;                // 非命名空间块的嵌套深度
+    std::vector<bool> braceKinds; // 每个未闭合 '{' 是否为透明块（namespace / extern "C"）
+    bool inBlockComment = false;
+    size_t sliceStart = 0;
+    bool sliceHasBlock = false;
+    std::string sliceHeader;      // 片段中第一个 '{' 之前的内容
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const std::string& line = lines[i];
+        std::string trimmed = trimLeft(line);
+        bool transparentLine = depth == 0 &&
+            (trimmed.rfind("namespace", 0) == 0 || trimmed.rfind("extern \"C\"", 0) == 0);
+
+        bool inString = false;
+        char quote = 0;
+        for (size_t c = 0; c < line.size(); ++c) {
+            char ch = line[c];
+            char next = c + 1 < line.size() ? line[c + 1] : '\0';
+            if (inBlockComment) {
+                if (ch == '*' && next == '/') {
+                    inBlockComment = false;
+                    ++c;
+                }
+                continue;
+            }
+            if (inString) {
+                if (ch == '\\') {
+                    ++c;
+                } else if (ch == quote) {
+                    inString = false;
+                }
+                continue;
+            }
+            if (ch == '/' && next == '/') {
+                break;
+            }
+            if (ch == '/' && next == '*') {
+                inBlockComment = true;
+                ++c;
+                continue;
+            }
+            if (ch == '"' || ch == '\'') {
+                inString = true;
+                quote = ch;
+                continue;
+            }
+            if (ch == '{') {
+                if (depth == 0 && transparentLine) {
+                    braceKinds.push_back(true);
+                    // 命名空间行本身不属于任何片段
+                    sliceStart = i + 1;
+                    sliceHasBlock = false;
+                    sliceHeader.clear();
+                } else {
+                    if (depth == 0 && !sliceHasBlock) {
+                        sliceHasBlock = true;
+                        sliceHeader += line.substr(0, c);
+                    }
+                    braceKinds.push_back(false);
+                    ++depth;
+                }
+            } else if (ch == '}') {
+                if (!braceKinds.empty()) {
+                    bool transparent = braceKinds.back();
+                    braceKinds.pop_back();
+                    if (transparent) {
+                        // 命名空间结束：之前累积的声明作为一个片段
+                        appendSlice(slices, filePath, lines, sliceStart, i, "", maxSnippetLines);
+                        sliceStart = i + 1;
+                        sliceHasBlock = false;
+                        sliceHeader.clear();
+                    } else {
+                        --depth;
+                    }
+                }
+            }
+        }
+
+        if (depth != 0 || i < sliceStart) {
+            continue;
+        }
+
+        if (sliceHasBlock) {
+            // 顶层块结束：函数/类定义作为一个片段
+            appendSlice(slices, filePath, lines, sliceStart, i + 1,
+                        extractCppSymbol(sliceHeader), maxSnippetLines);
+            sliceStart = i + 1;
+            sliceHasBlock = false;
+            sliceHeader.clear();
+        } else if (isBlank(line)) {
+            // 空行分隔顶层声明
+            appendSlice(slices, filePath, lines, sliceStart, i, "", maxSnippetLines);
+            sliceStart = i + 1;
+            sliceHeader.clear();
+        } else {
+            sliceHeader += line + "\n";
+        }
+    }
+
+    appendSlice(slices, filePath, lines, sliceStart, lines.size(),
+                sliceHasBlock ? extractCppSymbol(sliceHeader) : "", maxSnippetLines);
+    return slices;
+}
+
+std::vector<ContextSnippet> slicePython(
+    const std::string& filePath,
+    const std::vector<std::string>& lines,
+    size_t maxSnippetLines
+) {
+    static const std::regex defRegex(R"(^(?:async\s+)?(?:def|class)\s+(\w+))");
+
+    std::vector<ContextSnippet> slices;
+    size_t sliceStart = 0;
+    std::string symbol;
+    bool afterDecorator = false;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const std::string& line = lines[i];
+        if (line.empty() || std::isspace(static_cast<unsigned char>(line[0])) || line[0] == '#') {
+            continue;
+        }
+        // 顶层语句：def/class/装饰器开始新片段（紧跟装饰器的 def 除外），
+        // 其它顶层语句只在当前片段是 def/class 时开始新片段
+        std::smatch match;
+        bool isDef = std::regex_search(line, match, defRegex);
+        bool isDecorator = line[0] == '@';
+        bool startNew = ((isDef || isDecorator) && !afterDecorator) ||
+                        (!isDef && !isDecorator && !symbol.empty());
+        if (startNew && i > sliceStart) {
+            appendSlice(slices, filePath, lines, sliceStart, i, symbol, maxSnippetLines);
+            sliceStart = i;
+        }
+        if (startNew || isDef) {
+            symbol = isDef ? match[1].str() : "";
+        }
+        afterDecorator = isDecorator;
+    }
+    appendSlice(slices, filePath, lines, sliceStart, lines.size(), symbol, maxSnippetLines);
+    return slices;
+}
+
+void renderSnippetTo(std::ostringstream& oss, const ContextSnippet& snippet) {
+    oss << "=== " << snippet.filePath << ":" << snippet.startLine << "-" << snippet.endLine;
+    if (!snippet.symbol.empty()) {
+        oss << " (" << snippet.symbol << ")";
+    }
+    oss << " ===\n" << snippet.text;
+    if (!snippet.text.empty() && snippet.text.back() != '\n') {
+        oss << "\n";
+    }
+}
+
+} // namespace
+
+// ========== PackedContext ==========
+
+std::string PackedContext::render() const {
+    std::ostringstream oss;
+    for (const auto& snippet : snippets) {
+        renderSnippetTo(oss, snippet);
+    }
+    return oss.str();
+}
+
+std::vector<std::string> PackedContext::files() const {
+    std::vector<std::string> result;
+    std::unordered_set<std::string> seen;
+    for (const auto& snippet : snippets) {
+        if (seen.insert(snippet.filePath).second) {
+            result.push_back(snippet.filePath);
+        }
+    }
+    return result;
+}
+
+// ========== ContextPacker ==========
+
+ContextPacker::ContextPacker(
+    const utils::TokenEstimator& estimator,
+    std::string modelId,
+    ContextPackerConfig config,
+    std::shared_ptr<FileContentCache> fileCache
+)
+    : m_estimator(estimator)
+    , m_modelId(std::move(modelId))
+    , m_config(config)
+    , m_fileCache(fileCache ? std::move(fileCache) : FileContentCache::shared()) {}
+
+std::vector<std::string> ContextPacker::tokenizeTerms(const std::string& text) {
+    std::vector<std::string> terms;
+    std::unordered_set<std::string> seen;
+
+    auto addTerm = [&](std::string term) {
+        term = toLower(std::move(term));
+        if (term.size() < 3 || stopTerms().count(term) > 0) {
+            return;
+        }
+        if (std::all_of(term.begin(), term.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            return;
+        }
+        if (seen.insert(term).second) {
+            terms.push_back(std::move(term));
+        }
+    };
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        if (!isIdentChar(text[pos])) {
+            ++pos;
+            continue;
+        }
+        size_t end = pos;
+        while (end < text.size() && isIdentChar(text[end])) {
+            ++end;
+        }
+        std::string word = text.substr(pos, end - pos);
+        pos = end;
+
+        addTerm(word);
+
+        // 拆分 snake_case 和 camelCase
+        std::string part;
+        for (size_t i = 0; i < word.size(); ++i) {
+            char ch = word[i];
+            bool boundary = ch == '_' ||
+                (i > 0 && std::isupper(static_cast<unsigned char>(ch)) &&
+                 (std::islower(static_cast<unsigned char>(word[i - 1])) ||
+                  (i + 1 < word.size() && std::islower(static_cast<unsigned char>(word[i + 1])))));
+            if (boundary && !part.empty() && part != word) {
+                addTerm(part);
+                part.clear();
+            }
+            if (ch != '_') {
+                part += ch;
+            }
+        }
+        if (!part.empty() && part != word) {
+            addTerm(part);
+        }
+    }
+
+    return terms;
+}
+
+std::vector<std::string> ContextPacker::findMentionedFiles(
+    const std::string& query,
+    const std::vector<std::string>& candidateFiles
+) {
+    std::string lowerQuery = toLower(query);
+    std::unordered_set<std::string> identifiers;
+    for (size_t pos = 0; pos < lowerQuery.size();) {
+        if (!isIdentChar(lowerQuery[pos])) {
+            ++pos;
+            continue;
+        }
+        size_t end = pos;
+        while (end < lowerQuery.size() && isIdentChar(lowerQuery[end])) {
+            ++end;
+        }
+        identifiers.insert(lowerQuery.substr(pos, end - pos));
+        pos = end;
+    }
+
+    std::vector<std::string> mentioned;
+    for (const auto& file : candidateFiles) {
+        fs::path path(file);
+        std::string filename = toLower(path.filename().string());
+        std::string stem = toLower(path.stem().string());
+        if ((!filename.empty() && lowerQuery.find(filename) != std::string::npos) ||
+            (stem.size() >= 4 && identifiers.count(stem) > 0)) {
+            mentioned.push_back(file);
+        }
+    }
+    return mentioned;
+}
+
+std::vector<ContextSnippet> ContextPacker::extractSlices(
+    const std::string& filePath,
+    const std::string& content,
+    size_t maxSnippetLines
+) {
+    std::vector<std::string> lines = splitLines(content);
+    std::string language = languageOf(filePath);
+    if (language == "cpp") {
+        return sliceCpp(filePath, lines, maxSnippetLines);
+    }
+    if (language == "python") {
+        return slicePython(filePath, lines, maxSnippetLines);
+    }
+
+    std::vector<ContextSnippet> slices;
+    appendSlice(slices, filePath, lines, 0, lines.size(), "", maxSnippetLines);
+    return slices;
+}
+
+double ContextPacker::recencyScore(const std::string& filePath) const {
+    // 优先使用内容缓存记录的修改时间（缓存按修改时间校验、写入时收到变更通知），
+    // 只有尚未缓存的文件才访问文件系统；这些文件在第二轮读取内容后即进入缓存
+    fs::file_time_type modifyTime;
+    if (auto cached = m_fileCache->cachedModifyTime(filePath)) {
+        modifyTime = *cached;
+    } else {
+        std::error_code ec;
+        modifyTime = fs::last_write_time(filePath, ec);
+        if (ec) {
+            return 0.0;
+        }
+    }
+    auto age = fs::file_time_type::clock::now() - modifyTime;
+    double ageHours = std::max(0.0, std::chrono::duration<double, std::ratio<3600>>(age).count());
+    double halfLife = m_config.recencyHalfLifeHours > 0.0 ? m_config.recencyHalfLifeHours : 24.0;
+    return std::pow(0.5, ageHours / halfLife);
+}
+
+PackedContext ContextPacker::packFiles(
+    const std::string& query,
+    const std::vector<std::string>& candidateFiles,
+    const std::vector<std::string>& anchorFiles,
+    const ProjectDependencyGraph* graph
+) const {
+    // 依赖距离：从锚点文件出发沿正/反向边做 BFS
+    std::unordered_map<std::string, int> distance;
+    std::deque<std::string> queue;
+    for (const auto& anchor : anchorFiles) {
+        std::string key = ProjectDependencyGraph::normalizeKey(anchor);
+        if (distance.emplace(key, 0).second) {
+            queue.push_back(key);
+        }
+    }
+    if (graph) {
+        while (!queue.empty()) {
+            std::string current = queue.front();
+            queue.pop_front();
+            int d = distance[current];
+            if (d >= m_config.maxDependencyDepth) {
+                continue;
+            }
+            auto neighbors = graph->getIncludes(current);
+            auto includedBy = graph->getIncludedBy(current);
+            neighbors.insert(neighbors.end(), includedBy.begin(), includedBy.end());
+            for (const auto& next : neighbors) {
+                if (distance.emplace(next, d + 1).second) {
+                    queue.push_back(next);
+                }
+            }
+        }
+    }
+
+    // 候选文件初筛：词法评分在截断之前计算，未被锚点覆盖、也非最近编辑的相关文件同样有机会入选
+    struct Candidate {
+        std::string path;
+        double dependencyScore;
+        double recencyScore;
+        double lexicalScore;
+        std::shared_ptr<const std::string> content;
+    };
+    const std::vector<std::string> queryTerms = tokenizeTerms(query);
+    auto pathCoverage = [&queryTerms](const std::string& path) {
+        if (queryTerms.empty()) {
+            return 0.0;
+        }
+        std::vector<std::string> pathTerms = tokenizeTerms(path);
+        std::unordered_set<std::string> termSet(pathTerms.begin(), pathTerms.end());
+        size_t hits = 0;
+        for (const auto& term : queryTerms) {
+            hits += termSet.count(term);
+        }
+        return static_cast<double>(hits) / static_cast<double>(queryTerms.size());
+    };
+    auto contentCoverage = [&queryTerms](const std::string& content) {
+        if (queryTerms.empty()) {
+            return 0.0;
+        }
+        size_t hits = 0;
+        for (const auto& term : queryTerms) {
+            // 词项已小写：按不区分大小写的子串查找，不复制内容
+            auto it = std::search(content.begin(), content.end(), term.begin(), term.end(),
+                [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+            if (it != content.end()) {
+                ++hits;
+            }
+        }
+        return static_cast<double>(hits) / static_cast<double>(queryTerms.size());
+    };
+    auto combinedScore = [this](const Candidate& c) {
+        return m_config.dependencyWeight * c.dependencyScore +
+               m_config.recencyWeight * c.recencyScore +
+               m_config.lexicalWeight * c.lexicalScore;
+    };
+    auto byScore = [&combinedScore](const Candidate& a, const Candidate& b) {
+        return combinedScore(a) > combinedScore(b);
+    };
+
+    std::vector<Candidate> candidates;
+    std::unordered_set<std::string> seen;
+    auto addCandidate = [&](const std::string& path) {
+        std::string key = ProjectDependencyGraph::normalizeKey(path);
+        if (!seen.insert(key).second) {
+            return;
+        }
+        auto it = distance.find(key);
+        double dependencyScore = it != distance.end() ? 1.0 / (1.0 + it->second) : 0.0;
+        candidates.push_back({path, dependencyScore, recencyScore(path), pathCoverage(path), nullptr});
+    };
+    for (const auto& anchor : anchorFiles) {
+        addCandidate(anchor);
+    }
+    for (const auto& file : candidateFiles) {
+        addCandidate(file);
+    }
+
+    // 第一轮：路径词项（不读内容）+ 依赖距离 + 最近编辑，截取需要读取内容的文件
+    std::stable_sort(candidates.begin(), candidates.end(), byScore);
+    const size_t scanLimit = std::max(m_config.maxScannedFiles, m_config.maxCandidateFiles);
+    if (candidates.size() > scanLimit) {
+        candidates.resize(scanLimit);
+    }
+
+    // 第二轮：文件内容中的词项覆盖（函数/类名等符号），再截取参与切片评分的文件
+    for (auto& candidate : candidates) {
+        candidate.content = m_fileCache->get(candidate.path);
+        if (candidate.content) {
+            candidate.lexicalScore = std::max(candidate.lexicalScore, contentCoverage(*candidate.content));
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), byScore);
+    if (candidates.size() > m_config.maxCandidateFiles) {
+        candidates.resize(m_config.maxCandidateFiles);
+    }
+
+    std::vector<Document> documents;
+    documents.reserve(candidates.size());
+    for (auto& candidate : candidates) {
+        if (!candidate.content || candidate.content->empty()) {
+            continue;
+        }
+        documents.push_back({candidate.path, std::move(candidate.content), candidate.dependencyScore, candidate.recencyScore});
+    }
+
+    return pack(query, documents);
+}
+
+PackedContext ContextPacker::pack(const std::string& query, const std::vector<Document>& documents) const {
+    PackedContext result;
+    if (m_config.tokenBudget == 0) {
+        return result;
+    }
+
+    // 切片
+    std::vector<ContextSnippet> snippets;
+    std::vector<const Document*> owners;
+    for (const auto& doc : documents) {
+        if (!doc.content) {
+            continue;
+        }
+        auto slices = extractSlices(doc.path, *doc.content, m_config.maxSnippetLines);
+        for (auto& slice : slices) {
+            snippets.push_back(std::move(slice));
+            owners.push_back(&doc);
+        }
+    }
+    result.candidateSnippets = snippets.size();
+    if (snippets.empty()) {
+        return result;
+    }
+
+    // 词法相似度（按 IDF 加权的词项覆盖率）
+    std::vector<std::string> queryTerms = tokenizeTerms(query);
+    std::vector<std::unordered_set<std::string>> snippetTerms(snippets.size());
+    std::unordered_map<std::string, size_t> documentFrequency;
+    for (size_t i = 0; i < snippets.size(); ++i) {
+        for (auto& term : tokenizeTerms(snippets[i].symbol + "\n" + snippets[i].text)) {
+            snippetTerms[i].insert(std::move(term));
+        }
+        for (const auto& term : queryTerms) {
+            if (snippetTerms[i].count(term) > 0) {
+                ++documentFrequency[term];
+            }
+        }
+    }
+    std::unordered_map<std::string, double> idf;
+    double totalIdf = 0.0;
+    const double n = static_cast<double>(snippets.size());
+    for (const auto& term : queryTerms) {
+        double value = std::log(1.0 + n / (1.0 + static_cast<double>(documentFrequency[term])));
+        idf[term] = value;
+        totalIdf += value;
+    }
+    std::unordered_set<std::string> queryTermSet(queryTerms.begin(), queryTerms.end());
+
+    for (size_t i = 0; i < snippets.size(); ++i) {
+        double lexical = 0.0;
+        if (totalIdf > 0.0) {
+            for (const auto& term : queryTerms) {
+                if (snippetTerms[i].count(term) > 0) {
+                    lexical += idf[term];
+                }
+            }
+            lexical /= totalIdf;
+        }
+        // 问题中直接提到片段符号名时视为完全匹配
+        std::string symbol = snippets[i].symbol.substr(0, snippets[i].symbol.find(' '));
+        if (!symbol.empty() && queryTermSet.count(toLower(symbol)) > 0) {
+            lexical = 1.0;
+        }
+
+        // 最近编辑只作为加成：问题有可用词项时，与问题和锚点都无关的片段不入选
+        bool relevant = owners[i]->dependencyScore > 0.0 || lexical > 0.0 || queryTerms.empty();
+        snippets[i].score = relevant
+            ? m_config.dependencyWeight * owners[i]->dependencyScore +
+              m_config.recencyWeight * owners[i]->recencyScore +
+              m_config.lexicalWeight * lexical
+            : 0.0;
+        snippets[i].tokens = m_estimator.estimateTokens(m_modelId, renderSnippet(snippets[i]));
+    }
+
+    // 按评分贪心填充预算（同分时优先短片段）
+    std::vector<size_t> order(snippets.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&snippets](size_t a, size_t b) {
+        if (snippets[a].score != snippets[b].score) {
+            return snippets[a].score > snippets[b].score;
+        }
+        return snippets[a].tokens < snippets[b].tokens;
+    });
+
+    std::vector<size_t> selected;
+    for (size_t index : order) {
+        if (snippets[index].score <= 0.0) {
+            break;
+        }
+        if (result.totalTokens + snippets[index].tokens > m_config.tokenBudget) {
+            continue;
+        }
+        result.totalTokens += snippets[index].tokens;
+        selected.push_back(index);
+    }
+
+    // 输出按文件、行号排序，便于阅读
+    std::sort(selected.begin(), selected.end(), [&snippets](size_t a, size_t b) {
+        if (snippets[a].filePath != snippets[b].filePath) {
+            return snippets[a].filePath < snippets[b].filePath;
+        }
+        return snippets[a].startLine < snippets[b].startLine;
+    });
+    result.snippets.reserve(selected.size());
+    for (size_t index : selected) {
+        result.snippets.push_back(std::move(snippets[index]));
+    }
+
+    return result;
+}
+
+std::string ContextPacker::renderSnippet(const ContextSnippet& snippet) {
+    std::ostringstream oss;
+    renderSnippetTo(oss, snippet);
+    return oss.str();
+}
+
+} // namespace naw::desktop_pet::service
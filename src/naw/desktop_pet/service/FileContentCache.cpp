@@ -0,0 +1,274 @@
+#include "naw/desktop_pet/service/FileContentCache.h"
+#include "naw/desktop_pet/service/BlobStore.h"
+
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace naw::desktop_pet::service {
+
+FileContentCache::FileContentCache(size_t maxBytes)
+    : m_maxBytes(maxBytes) {}
+
+std::shared_ptr<FileContentCache> FileContentCache::shared() {
+    static std::shared_ptr<FileContentCache> instance = std::make_shared<FileContentCache>();
+    return instance;
+}
+
+FileContentCache::Content FileContentCache::get(const std::string& filePath) {
+    // 获取文件状态（锁外）
+    std::error_code ec;
+    if (!fs::is_regular_file(filePath, ec)) {
+        invalidate(filePath);
+        return nullptr;
+    }
+    auto modifyTime = fs::last_write_time(filePath, ec);
+    if (ec) {
+        invalidate(filePath);
+        return nullptr;
+    }
+    auto fileSize = fs::file_size(filePath, ec);
+    if (ec) {
+        invalidate(filePath);
+        return nullptr;
+    }
+
+    std::promise<Content> promise;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        // 检查缓存
+        auto it = m_entries.find(filePath);
+        if (it != m_entries.end()) {
+            if (it->second.modifyTime == modifyTime && it->second.fileSize == fileSize) {
+                m_lru.splice(m_lru.begin(), m_lru, it->second.lruIt);
+                ++m_hits;
+                return it->second.content;
+            }
+            eraseLocked(filePath);
+        }
+
+        // 同一版本的文件正在被其他线程读取，等待其结果
+        auto flightIt = m_inFlight.find(filePath);
+        if (flightIt != m_inFlight.end() &&
+            flightIt->second.modifyTime == modifyTime &&
+            flightIt->second.fileSize == fileSize) {
+            auto future = flightIt->second.future;
+            lock.unlock();
+            return future.get();
+        }
+
+        ++m_misses;
+        m_inFlight[filePath] = InFlight{modifyTime, fileSize, promise.get_future().share()};
+    }
+
+    // 只有仍是本线程登记的读取才处理登记项（期间可能被 invalidate 或更新版本替换）
+    auto isOwnFlight = [&](auto flightIt) {
+        return flightIt != m_inFlight.end() &&
+               flightIt->second.modifyTime == modifyTime &&
+               flightIt->second.fileSize == fileSize;
+    };
+
+    Content content;
+    try {
+        // 读取文件（锁外）
+        content = readFile(filePath);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto flightIt = m_inFlight.find(filePath);
+        if (isOwnFlight(flightIt)) {
+            m_inFlight.erase(flightIt);
+            if (content && content->size() == fileSize) {
+                insertLocked(filePath, content, modifyTime, fileSize);
+            }
+        }
+    } catch (...) {
+        // 读取或写入缓存失败：撤销登记，并把异常交给等待者，避免其永远阻塞
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto flightIt = m_inFlight.find(filePath);
+            if (isOwnFlight(flightIt)) {
+                m_inFlight.erase(flightIt);
+            }
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    promise.set_value(content);
+    return content;
+}
+
+std::optional<fs::file_time_type> FileContentCache::cachedModifyTime(const std::string& filePath) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(filePath);
+    if (it == m_entries.end()) {
+        return std::nullopt;
+    }
+    return it->second.modifyTime;
+}
+
+void FileContentCache::invalidate(const std::string& filePath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    eraseLocked(filePath);
+    // 正在进行的读取完成后不再写入缓存；等待者仍会拿到结果
+    m_inFlight.erase(filePath);
+}
+
+void FileContentCache::invalidateUnder(const std::string& directory) {
+    std::string prefix = directory;
+    while (!prefix.empty() && (prefix.back() == '/' || prefix.back() == '\\')) {
+        prefix.pop_back();
+    }
+    auto isUnder = [&prefix](const std::string& path) {
+        return path.size() > prefix.size() && path.compare(0, prefix.size(), prefix) == 0 &&
+               (path[prefix.size()] == '/' || path[prefix.size()] == '\\');
+    };
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> keys;
+    for (const auto& [key, entry] : m_entries) {
+        if (isUnder(key)) {
+            keys.push_back(key);
+        }
+    }
+    for (const auto& key : keys) {
+        eraseLocked(key);
+    }
+    for (auto it = m_inFlight.begin(); it != m_inFlight.end();) {
+        it = isUnder(it->first) ? m_inFlight.erase(it) : std::next(it);
+    }
+}
+
+void FileContentCache::notifyFileChanged(const std::string& filePath) {
+    invalidate(filePath);
+
+    std::error_code ec;
+    fs::path absolutePath = fs::absolute(filePath, ec);
+    if (!ec && absolutePath.string() != filePath) {
+        invalidate(absolutePath.string());
+    }
+
+    // 持有监听者锁回调，保证 removeChangeListener 返回后不会再被调用
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    for (const auto& [id, listener] : m_listeners) {
+        try {
+            listener(filePath);
+        } catch (...) {
+            // 监听者的异常不影响其他监听者
+        }
+    }
+}
+
+size_t FileContentCache::addChangeListener(ChangeListener listener) {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    size_t id = m_nextListenerId++;
+    m_listeners.emplace(id, std::move(listener));
+    return id;
+}
+
+void FileContentCache::removeChangeListener(size_t listenerId) {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    m_listeners.erase(listenerId);
+}
+
+void FileContentCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_lru.clear();
+    m_inFlight.clear();
+    m_totalBytes = 0;
+}
+
+void FileContentCache::setMaxBytes(size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxBytes = maxBytes;
+    evictLocked();
+}
+
+size_t FileContentCache::getMaxBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxBytes;
+}
+
+FileContentCache::Stats FileContentCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.entryCount = m_entries.size();
+    stats.totalBytes = m_totalBytes;
+    stats.maxBytes = m_maxBytes;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    return stats;
+}
+
+// ========== 内部辅助方法 ==========
+
+FileContentCache::Content FileContentCache::readFile(const std::string& filePath) {
+    try {
+        std::ifstream file(filePath, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return nullptr;
+        }
+
+        file.seekg(0, std::ios::end);
+        std::streamoff size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        if (size < 0) {
+            return nullptr;
+        }
+
+        std::string content(static_cast<size_t>(size), '\0');
+        if (size > 0) {
+            file.read(content.data(), size);
+            content.resize(static_cast<size_t>(file.gcount()));
+        }
+        // 同一文件版本在各子系统间共享一份缓冲
+        return BlobStore::shared().intern(std::move(content), "file_cache");
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void FileContentCache::insertLocked(
+    const std::string& key,
+    Content content,
+    fs::file_time_type modifyTime,
+    uintmax_t fileSize
+) {
+    eraseLocked(key);
+
+    // 单个文件超过预算时不缓存
+    if (content->size() > m_maxBytes) {
+        return;
+    }
+
+    m_lru.push_front(key);
+    m_totalBytes += content->size();
+    m_entries[key] = Entry{std::move(content), modifyTime, fileSize, m_lru.begin()};
+    evictLocked();
+}
+
+void FileContentCache::eraseLocked(const std::string& key) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+    m_totalBytes -= it->second.content->size();
+    m_lru.erase(it->second.lruIt);
+    m_entries.erase(it);
+}
+
+void FileContentCache::evictLocked() {
+    while (m_totalBytes > m_maxBytes && !m_lru.empty()) {
+        std::string victim = m_lru.back();
+        eraseLocked(victim);
+        ++m_evictions;
+    }
+}
+
+} // namespace naw::desktop_pet::service
@@ -260,7 +260,7 @@ namespace {
                     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
                     result.executionTimeMs = static_cast<double>(duration.count());
                     result.success = true;
-                    result.result = cachedResult.value();
+                    result.result = std::move(cachedResult);
                     // 记录缓存命中的调用（虽然是从缓存获取的）
                     if (context) {
                         context->recordToolCall(result, arguments.value());
@@ -1,4 +1,7 @@
 #include "naw/desktop_pet/service/ImageProcessor.h"
+#include "naw/desktop_pet/service/VisionKernels.h"
+#include "naw/desktop_pet/service/VisionLayer0.h"
+#include "naw/desktop_pet/service/utils/HttpSerialization.h"
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
@@ -6,8 +9,9 @@
 
 #include <algorithm>
 #include <cmath>
-#include <cstring>
+#include <cstdint>
 #include <stdexcept>
+#include <string_view>
 
 namespace naw::desktop_pet::service {
 
@@ -28,19 +32,68 @@ namespace {
         }
     }
 
-    // 检查是否需要颜色通道转换
-    bool needsColorConversion(types::ImageFormat srcFormat, types::ImageFormat dstFormat) {
-        if (srcFormat == dstFormat) {
-            return false;
+    // 获取像素格式之间的 OpenCV 颜色转换码（格式相同返回 -1，表示直接复制）
+    int colorConversionCode(types::ImageFormat src, types::ImageFormat dst) {
+        using F = types::ImageFormat;
+        if (src == dst) {
+            return -1;
         }
-        // BGR <-> RGB 需要转换
-        if ((srcFormat == types::ImageFormat::BGR && dstFormat == types::ImageFormat::RGB) ||
-            (srcFormat == types::ImageFormat::RGB && dstFormat == types::ImageFormat::BGR) ||
-            (srcFormat == types::ImageFormat::BGRA && dstFormat == types::ImageFormat::RGBA) ||
-            (srcFormat == types::ImageFormat::RGBA && dstFormat == types::ImageFormat::BGRA)) {
-            return true;
+        switch (src) {
+            case F::Grayscale:
+                return (dst == F::BGRA || dst == F::RGBA) ? cv::COLOR_GRAY2BGRA : cv::COLOR_GRAY2BGR;
+            case F::BGR:
+                switch (dst) {
+                    case F::RGB: return cv::COLOR_BGR2RGB;
+                    case F::BGRA: return cv::COLOR_BGR2BGRA;
+                    case F::RGBA: return cv::COLOR_BGR2RGBA;
+                    default: return cv::COLOR_BGR2GRAY;
+                }
+            case F::RGB:
+                switch (dst) {
+                    case F::BGR: return cv::COLOR_RGB2BGR;
+                    case F::RGBA: return cv::COLOR_RGB2RGBA;
+                    case F::BGRA: return cv::COLOR_RGB2BGRA;
+                    default: return cv::COLOR_RGB2GRAY;
+                }
+            case F::BGRA:
+                switch (dst) {
+                    case F::BGR: return cv::COLOR_BGRA2BGR;
+                    case F::RGB: return cv::COLOR_BGRA2RGB;
+                    case F::RGBA: return cv::COLOR_BGRA2RGBA;
+                    default: return cv::COLOR_BGRA2GRAY;
+                }
+            case F::RGBA:
+                switch (dst) {
+                    case F::RGB: return cv::COLOR_RGBA2RGB;
+                    case F::BGR: return cv::COLOR_RGBA2BGR;
+                    case F::BGRA: return cv::COLOR_RGBA2BGRA;
+                    default: return cv::COLOR_RGBA2GRAY;
+                }
         }
-        return false;
+        return -1;
+    }
+
+    // 按格式与质量编码到 out（imencode 按需调整 out 的大小，已有容量可复用）
+    bool encodeMat(const cv::Mat& mat, ImageProcessor::EncodeFormat format, int quality,
+                   std::vector<uint8_t>& out) {
+        using Format = ImageProcessor::EncodeFormat;
+        switch (format) {
+            case Format::PNG:
+                return cv::imencode(".png", mat, out, {cv::IMWRITE_PNG_COMPRESSION, quality});
+            case Format::WebP:
+                return cv::imencode(".webp", mat, out, {cv::IMWRITE_WEBP_QUALITY, quality});
+            case Format::JPEG:
+            default:
+                return cv::imencode(".jpg", mat, out, {cv::IMWRITE_JPEG_QUALITY, quality});
+        }
+    }
+
+    // 为 ImageData 分配连续存储，并返回引用该存储的 Mat（OpenCV 写入该 Mat 即写入 ImageData）
+    cv::Mat allocateImageData(types::ImageData& image, uint32_t width, uint32_t height,
+                              types::ImageFormat format) {
+        image.allocate(width, height, format);
+        return cv::Mat(static_cast<int>(height), static_cast<int>(width),
+                       imageFormatToCVType(format), image.data.data());
     }
 }
 
@@ -48,35 +101,146 @@ std::optional<std::vector<uint8_t>> ImageProcessor::compressToJPEG(
     const types::ImageData& image,
     int quality
 ) {
-    if (!image.isValid()) {
-        return std::nullopt;
-    }
+    return compressToJPEG(types::ImageView::fromImageData(image), quality);
+}
+
+std::optional<std::vector<uint8_t>> ImageProcessor::compressToPNG(
+    const types::ImageData& image,
+    int compressionLevel
+) {
+    return compressToPNG(types::ImageView::fromImageData(image), compressionLevel);
+}
+
+std::optional<types::ImageData> ImageProcessor::resize(
+    const types::ImageData& image,
+    uint32_t targetWidth,
+    uint32_t targetHeight,
+    InterpolationMethod method
+) {
+    return resize(types::ImageView::fromImageData(image), targetWidth, targetHeight, method);
+}
+
+std::optional<types::ImageData> ImageProcessor::resizeAndCrop(
+    const types::ImageData& image,
+    uint32_t targetWidth,
+    uint32_t targetHeight,
+    InterpolationMethod method
+) {
+    return resizeAndCrop(types::ImageView::fromImageData(image), targetWidth, targetHeight, method);
+}
 
+std::optional<std::vector<uint8_t>> ImageProcessor::compressToJPEG(
+    const types::ImageView& image,
+    int quality
+) {
     if (quality < 0 || quality > 100) {
         quality = 85; // 默认质量
     }
 
+    EncodeOptions options;
+    options.format = EncodeFormat::JPEG;
+    options.quality = quality;
+    std::vector<uint8_t> buffer;
+    if (!encode(image, options, buffer)) {
+        return std::nullopt;
+    }
+    return buffer;
+}
+
+std::optional<std::vector<uint8_t>> ImageProcessor::compressToPNG(
+    const types::ImageView& image,
+    int compressionLevel
+) {
+    if (compressionLevel < 0 || compressionLevel > 9) {
+        compressionLevel = 3; // 默认压缩级别
+    }
+
+    EncodeOptions options;
+    options.format = EncodeFormat::PNG;
+    options.quality = compressionLevel;
+    std::vector<uint8_t> buffer;
+    if (!encode(image, options, buffer)) {
+        return std::nullopt;
+    }
+    return buffer;
+}
+
+std::optional<ImageProcessor::EncodeResult> ImageProcessor::encode(
+    const types::ImageView& image,
+    const EncodeOptions& options,
+    std::vector<uint8_t>& out
+) {
+    if (!image.isValid()) {
+        return std::nullopt;
+    }
+
     try {
-        // 转换为 OpenCV Mat
+        // 包装为 OpenCV Mat（BGR/BGRA/灰度图不复制；编码器要求 OpenCV 通道顺序）
         cv::Mat mat;
-        imageDataToMat(image, &mat);
-        
+        imageDataToMat(image, &mat, true);
+
         if (mat.empty()) {
             return std::nullopt;
         }
 
-        // 压缩参数
-        std::vector<int> compressionParams;
-        compressionParams.push_back(cv::IMWRITE_JPEG_QUALITY);
-        compressionParams.push_back(quality);
+        EncodeResult result;
+        if (options.format == EncodeFormat::PNG) {
+            // 无损编码，体积与质量无关，不做预算搜索
+            result.quality = std::clamp(options.quality, 0, 9);
+            result.attempts = 1;
+            if (!encodeMat(mat, options.format, result.quality, out)) {
+                return std::nullopt;
+            }
+            result.bytes = out.size();
+            result.withinBudget = options.maxBytes == 0 || out.size() <= options.maxBytes;
+            return result;
+        }
 
-        // 压缩为 JPEG
-        std::vector<uint8_t> buffer;
-        if (!cv::imencode(".jpg", mat, buffer, compressionParams)) {
+        const int quality = std::clamp(options.quality, 1, 100);
+        result.quality = quality;
+        result.attempts = 1;
+        if (!encodeMat(mat, options.format, quality, out)) {
             return std::nullopt;
         }
+        if (options.maxBytes == 0 || out.size() <= options.maxBytes) {
+            result.bytes = out.size();
+            return result;
+        }
 
-        return buffer;
+        // 超出预算：二分查找满足预算的最高质量。候选结果写入线程内复用的缓冲，
+        // 满足预算时与 out 交换，两块缓冲的容量都在多次调用间保留
+        thread_local std::vector<uint8_t> scratch;
+        const int minQuality = std::clamp(options.minQuality, 1, quality);
+        int low = minQuality;
+        int high = quality - 1;
+        bool found = false;
+        while (low <= high) {
+            const int mid = low + (high - low) / 2;
+            ++result.attempts;
+            if (!encodeMat(mat, options.format, mid, scratch)) {
+                return std::nullopt;
+            }
+            if (scratch.size() <= options.maxBytes) {
+                out.swap(scratch);
+                result.quality = mid;
+                found = true;
+                low = mid + 1;
+            } else {
+                high = mid - 1;
+            }
+        }
+
+        if (!found) {
+            // 最低质量仍超出预算：返回最低质量的结果，由调用方决定是否缩小分辨率后重试。
+            // 搜索的下界不变，最后一次尝试就是最低质量，结果在 scratch 中
+            if (result.attempts > 1) {
+                out.swap(scratch);
+                result.quality = minQuality;
+            }
+            result.withinBudget = false;
+        }
+        result.bytes = out.size();
+        return result;
     } catch (const cv::Exception& e) {
         return std::nullopt;
     } catch (...) {
@@ -84,39 +248,51 @@ std::optional<std::vector<uint8_t>> ImageProcessor::compressToJPEG(
     }
 }
 
-std::optional<std::vector<uint8_t>> ImageProcessor::compressToPNG(
-    const types::ImageData& image,
-    int compressionLevel
+std::optional<ImageProcessor::EncodeResult> ImageProcessor::encodeToDataUrl(
+    const types::ImageView& image,
+    const EncodeOptions& options,
+    std::string& out
 ) {
-    if (!image.isValid()) {
+    thread_local std::vector<uint8_t> encoded;
+    auto result = encode(image, options, encoded);
+    if (!result) {
         return std::nullopt;
     }
 
-    if (compressionLevel < 0 || compressionLevel > 9) {
-        compressionLevel = 3; // 默认压缩级别
+    const std::string_view mime = mimeType(options.format);
+    out.clear();
+    out.reserve(5 + mime.size() + 8 + utils::base64EncodedSize(encoded.size()));
+    out.append("data:");
+    out.append(mime);
+    out.append(";base64,");
+    utils::appendBase64(encoded.data(), encoded.size(), out);
+    return result;
+}
+
+const char* ImageProcessor::mimeType(EncodeFormat format) {
+    switch (format) {
+        case EncodeFormat::PNG:
+            return "image/png";
+        case EncodeFormat::WebP:
+            return "image/webp";
+        case EncodeFormat::JPEG:
+        default:
+            return "image/jpeg";
     }
+}
 
+std::optional<types::ImageData> ImageProcessor::loadFromFile(
+    const std::string& path,
+    types::ImageFormat format
+) {
     try {
-        // 转换为 OpenCV Mat
-        cv::Mat mat;
-        imageDataToMat(image, &mat);
-        
+        const cv::Mat mat = cv::imread(path, format == types::ImageFormat::Grayscale
+                                                 ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
         if (mat.empty()) {
             return std::nullopt;
         }
-
-        // 压缩参数
-        std::vector<int> compressionParams;
-        compressionParams.push_back(cv::IMWRITE_PNG_COMPRESSION);
-        compressionParams.push_back(compressionLevel);
-
-        // 压缩为 PNG
-        std::vector<uint8_t> buffer;
-        if (!cv::imencode(".png", mat, buffer, compressionParams)) {
-            return std::nullopt;
-        }
-
-        return buffer;
+        const auto matFormat = mat.channels() == 1 ? types::ImageFormat::Grayscale : types::ImageFormat::BGR;
+        return matToImageData(&mat, matFormat, format);
     } catch (const cv::Exception& e) {
         return std::nullopt;
     } catch (...) {
@@ -125,7 +301,7 @@ std::optional<std::vector<uint8_t>> ImageProcessor::compressToPNG(
 }
 
 std::optional<types::ImageData> ImageProcessor::resize(
-    const types::ImageData& image,
+    const types::ImageView& image,
     uint32_t targetWidth,
     uint32_t targetHeight,
     InterpolationMethod method
@@ -135,21 +311,20 @@ std::optional<types::ImageData> ImageProcessor::resize(
     }
 
     try {
-        // 转换为 OpenCV Mat
+        // 包装为 OpenCV Mat（缩放与通道顺序无关，保持原始格式，不复制）
         cv::Mat srcMat;
-        imageDataToMat(image, &srcMat);
+        imageDataToMat(image, &srcMat, false);
         
         if (srcMat.empty()) {
             return std::nullopt;
         }
 
-        // 缩放
-        cv::Mat dstMat;
-        cv::resize(srcMat, dstMat, cv::Size(static_cast<int>(targetWidth), static_cast<int>(targetHeight)),
-                   0.0, 0.0, getOpenCVInterpolation(method));
+        // 缩放结果直接写入输出 ImageData 的缓冲
+        types::ImageData result;
+        cv::Mat dstMat = allocateImageData(result, targetWidth, targetHeight, image.format);
+        cv::resize(srcMat, dstMat, dstMat.size(), 0.0, 0.0, getOpenCVInterpolation(method));
 
-        // 转换回 ImageData（保持原始格式）
-        return matToImageData(&dstMat, image.format);
+        return result;
     } catch (const cv::Exception& e) {
         return std::nullopt;
     } catch (...) {
@@ -162,6 +337,15 @@ std::optional<types::ImageData> ImageProcessor::resizeKeepAspectRatio(
     uint32_t targetWidth,
     uint32_t targetHeight,
     InterpolationMethod method
+) {
+    return resizeKeepAspectRatio(types::ImageView::fromImageData(image), targetWidth, targetHeight, method);
+}
+
+std::optional<types::ImageData> ImageProcessor::resizeKeepAspectRatio(
+    const types::ImageView& image,
+    uint32_t targetWidth,
+    uint32_t targetHeight,
+    InterpolationMethod method
 ) {
     if (!image.isValid()) {
         return std::nullopt;
@@ -193,8 +377,63 @@ std::optional<types::ImageData> ImageProcessor::resizeKeepAspectRatio(
     return resize(image, targetWidth, targetHeight, method);
 }
 
+std::optional<ImageProcessor::LetterboxResult> ImageProcessor::letterbox(
+    const types::ImageView& image,
+    uint32_t targetWidth,
+    uint32_t targetHeight,
+    types::ImageFormat format,
+    uint8_t padValue
+) {
+    if (!image.isValid() || targetWidth == 0 || targetHeight == 0) {
+        return std::nullopt;
+    }
+
+    try {
+        // 与 resizeKeepAspectRatio 相同的缩放规则
+        LetterboxResult result;
+        result.scale = std::min(static_cast<double>(targetWidth) / static_cast<double>(image.width),
+                                static_cast<double>(targetHeight) / static_cast<double>(image.height));
+        const uint32_t scaledWidth = std::clamp<uint32_t>(
+            static_cast<uint32_t>(std::round(image.width * result.scale)), 1u, targetWidth);
+        const uint32_t scaledHeight = std::clamp<uint32_t>(
+            static_cast<uint32_t>(std::round(image.height * result.scale)), 1u, targetHeight);
+        result.padX = (targetWidth - scaledWidth) / 2;
+        result.padY = (targetHeight - scaledHeight) / 2;
+
+        cv::Mat canvas = allocateImageData(result.image, targetWidth, targetHeight, format);
+        canvas.setTo(cv::Scalar::all(padValue));
+        cv::Mat roi = canvas(cv::Rect(static_cast<int>(result.padX), static_cast<int>(result.padY),
+                                      static_cast<int>(scaledWidth), static_cast<int>(scaledHeight)));
+
+        cv::Mat srcMat;
+        imageDataToMat(image, &srcMat, false);
+        if (srcMat.empty()) {
+            return std::nullopt;
+        }
+
+        // 通道数相同：直接缩放进画布 ROI（必要时在 ROI 上原地换通道顺序）；
+        // 通道数不同：缩放到小尺寸临时图后转换进 ROI（转换总在缩放后的尺寸上进行）
+        const int code = colorConversionCode(image.format, format);
+        if (types::bytesPerPixelOf(image.format) == types::bytesPerPixelOf(format)) {
+            cv::resize(srcMat, roi, roi.size(), 0.0, 0.0, cv::INTER_LINEAR);
+            if (code >= 0) {
+                cv::cvtColor(roi, roi, code);
+            }
+        } else {
+            cv::Mat scaled;
+            cv::resize(srcMat, scaled, roi.size(), 0.0, 0.0, cv::INTER_LINEAR);
+            cv::cvtColor(scaled, roi, code);
+        }
+        return result;
+    } catch (const cv::Exception& e) {
+        return std::nullopt;
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
 std::optional<types::ImageData> ImageProcessor::resizeAndCrop(
-    const types::ImageData& image,
+    const types::ImageView& image,
     uint32_t targetWidth,
     uint32_t targetHeight,
     InterpolationMethod method
@@ -204,9 +443,9 @@ std::optional<types::ImageData> ImageProcessor::resizeAndCrop(
     }
 
     try {
-        // 转换为 OpenCV Mat
+        // 包装为 OpenCV Mat（保持原始格式，不复制）
         cv::Mat srcMat;
-        imageDataToMat(image, &srcMat);
+        imageDataToMat(image, &srcMat, false);
         
         if (srcMat.empty()) {
             return std::nullopt;
@@ -230,11 +469,11 @@ std::optional<types::ImageData> ImageProcessor::resizeAndCrop(
         int cropY = (scaledHeight - targetHeight) / 2;
         cv::Rect cropRect(cropX, cropY, static_cast<int>(targetWidth), static_cast<int>(targetHeight));
 
-        // 裁剪
+        // 裁剪（ROI 不复制，由 matToImageData 逐行写入结果）
         cv::Mat dstMat = scaledMat(cropRect);
 
         // 转换回 ImageData
-        return matToImageData(&dstMat, image.format);
+        return matToImageData(&dstMat, image.format, image.format);
     } catch (const cv::Exception& e) {
         return std::nullopt;
     } catch (...) {
@@ -370,7 +609,223 @@ std::optional<types::ImageData> ImageProcessor::applyResolutionControl(
     }
 }
 
-void ImageProcessor::imageDataToMat(const types::ImageData& image, void* outMat) {
+size_t ImageProcessor::estimateImageTokens(uint32_t width, uint32_t height) {
+    if (width == 0 || height == 0) {
+        return 0;
+    }
+    double w = width;
+    double h = height;
+    // 先缩放到 2048x2048 以内，再把短边缩放到 768 以内（只缩小不放大）
+    const double fit = 2048.0 / std::max(w, h);
+    if (fit < 1.0) {
+        w *= fit;
+        h *= fit;
+    }
+    const double shortSide = 768.0 / std::min(w, h);
+    if (shortSide < 1.0) {
+        w *= shortSide;
+        h *= shortSide;
+    }
+    const auto tilesX = static_cast<size_t>(std::ceil(w / 512.0));
+    const auto tilesY = static_cast<size_t>(std::ceil(h / 512.0));
+    return 85 + 170 * tilesX * tilesY;
+}
+
+std::vector<types::Rect> ImageProcessor::planRegionCrops(
+    const std::vector<types::Rect>& regions,
+    uint32_t frameWidth,
+    uint32_t frameHeight,
+    const RegionCropConfig& config
+) {
+    struct Box {
+        int64_t x0, y0, x1, y1;
+    };
+    std::vector<Box> boxes;
+    if (frameWidth == 0 || frameHeight == 0) {
+        return {};
+    }
+    const int64_t frameW = frameWidth;
+    const int64_t frameH = frameHeight;
+
+    // 扩展到 [lo, hi) 至少 minSize 长，并平移/裁剪到 [0, limit)
+    auto expand = [&config](int64_t& lo, int64_t& hi, int64_t limit) {
+        const int64_t margin = std::max<int64_t>(
+            config.minMargin, static_cast<int64_t>(std::lround((hi - lo) * config.marginRatio)));
+        lo -= margin;
+        hi += margin;
+        const int64_t minSize = std::min<int64_t>(config.minCropSize, limit);
+        if (hi - lo < minSize) {
+            const int64_t grow = minSize - (hi - lo);
+            lo -= grow / 2;
+            hi += grow - grow / 2;
+        }
+        if (lo < 0) {
+            hi -= lo;
+            lo = 0;
+        }
+        if (hi > limit) {
+            lo -= hi - limit;
+            hi = limit;
+        }
+        lo = std::max<int64_t>(lo, 0);
+    };
+
+    for (const auto& region : regions) {
+        if (!region.isValid()) {
+            continue;
+        }
+        Box box{std::max<int64_t>(0, region.x), std::max<int64_t>(0, region.y),
+                std::min<int64_t>(frameW, static_cast<int64_t>(region.x) + region.width),
+                std::min<int64_t>(frameH, static_cast<int64_t>(region.y) + region.height)};
+        if (box.x0 >= box.x1 || box.y0 >= box.y1) {
+            continue;
+        }
+        expand(box.x0, box.x1, frameW);
+        expand(box.y0, box.y1, frameH);
+        boxes.push_back(box);
+    }
+    if (boxes.empty()) {
+        return {};
+    }
+
+    // 按分辨率控制后的尺寸估计 token
+    auto cost = [&config](const Box& box) {
+        auto [width, height] = getOptimalResolution(static_cast<uint32_t>(box.x1 - box.x0),
+                                                    static_cast<uint32_t>(box.y1 - box.y0), config.resolution);
+        return estimateImageTokens(width, height);
+    };
+    auto unite = [](const Box& a, const Box& b) {
+        return Box{std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+    };
+    auto overlaps = [](const Box& a, const Box& b) {
+        return a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+    };
+
+    // 合并重叠的区域，以及合并后 token 不多于分开发送的区域（相邻的小区域通常可以共用图块）
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < boxes.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < boxes.size(); ++j) {
+                const Box united = unite(boxes[i], boxes[j]);
+                if (overlaps(boxes[i], boxes[j]) || cost(united) <= cost(boxes[i]) + cost(boxes[j])) {
+                    boxes[i] = united;
+                    boxes.erase(boxes.begin() + static_cast<std::ptrdiff_t>(j));
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // 数量超限时反复合并 token 增量最小的两块（合并后可能与其他区域重叠，一并吸收）
+    const size_t maxCrops = std::max<uint32_t>(config.maxCrops, 1);
+    while (boxes.size() > maxCrops) {
+        size_t bestI = 0;
+        size_t bestJ = 1;
+        int64_t bestDelta = INT64_MAX;
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            for (size_t j = i + 1; j < boxes.size(); ++j) {
+                const int64_t delta = static_cast<int64_t>(cost(unite(boxes[i], boxes[j]))) -
+                                      static_cast<int64_t>(cost(boxes[i]) + cost(boxes[j]));
+                if (delta < bestDelta) {
+                    bestDelta = delta;
+                    bestI = i;
+                    bestJ = j;
+                }
+            }
+        }
+        boxes[bestI] = unite(boxes[bestI], boxes[bestJ]);
+        boxes.erase(boxes.begin() + static_cast<std::ptrdiff_t>(bestJ));
+        for (size_t j = 0; j < boxes.size();) {
+            if (j != bestI && overlaps(boxes[bestI], boxes[j])) {
+                boxes[bestI] = unite(boxes[bestI], boxes[j]);
+                boxes.erase(boxes.begin() + static_cast<std::ptrdiff_t>(j));
+                if (j < bestI) {
+                    --bestI;
+                }
+            } else {
+                ++j;
+            }
+        }
+    }
+
+    // 覆盖面积或 token 不比整帧少时直接发送整帧
+    int64_t area = 0;
+    size_t tokens = 0;
+    for (const auto& box : boxes) {
+        area += (box.x1 - box.x0) * (box.y1 - box.y0);
+        tokens += cost(box);
+    }
+    const Box full{0, 0, frameW, frameH};
+    if (static_cast<double>(area) >= config.fullFrameRatio * static_cast<double>(frameW * frameH) ||
+        tokens >= cost(full)) {
+        boxes.assign(1, full);
+    }
+
+    std::sort(boxes.begin(), boxes.end(), [](const Box& a, const Box& b) {
+        return a.y0 != b.y0 ? a.y0 < b.y0 : a.x0 < b.x0;
+    });
+    std::vector<types::Rect> crops;
+    crops.reserve(boxes.size());
+    for (const auto& box : boxes) {
+        crops.push_back(types::Rect{static_cast<int32_t>(box.x0), static_cast<int32_t>(box.y0),
+                                    static_cast<uint32_t>(box.x1 - box.x0), static_cast<uint32_t>(box.y1 - box.y0)});
+    }
+    return crops;
+}
+
+ImageProcessor::RegionCropResult ImageProcessor::cropActiveRegions(
+    const types::ImageView& image,
+    const std::vector<types::Rect>& regions,
+    const RegionCropConfig& config
+) {
+    RegionCropResult result;
+    if (!image.isValid()) {
+        return result;
+    }
+
+    auto [frameWidth, frameHeight] = getOptimalResolution(image.width, image.height, config.resolution);
+    result.fullFrameTokens = estimateImageTokens(frameWidth, frameHeight);
+
+    const auto planned = planRegionCrops(regions, image.width, image.height, config);
+    result.fullFrame = planned.size() == 1 && planned[0].width == image.width && planned[0].height == image.height;
+    result.crops.reserve(planned.size());
+    for (const auto& region : planned) {
+        // 裁剪为零拷贝视图，缩放（或尺寸不变时的复制）一次写入结果
+        const auto view = image.subView(static_cast<uint32_t>(region.x), static_cast<uint32_t>(region.y),
+                                        region.width, region.height);
+        auto [width, height] = getOptimalResolution(region.width, region.height, config.resolution);
+        auto cropped = config.resolution.keepAspectRatio ? resizeKeepAspectRatio(view, width, height)
+                                                         : resize(view, width, height);
+        if (!cropped) {
+            continue;
+        }
+        RegionCrop crop;
+        crop.region = region;
+        crop.estimatedTokens = estimateImageTokens(cropped->width, cropped->height);
+        crop.image = std::move(*cropped);
+        result.totalTokens += crop.estimatedTokens;
+        result.crops.push_back(std::move(crop));
+    }
+    return result;
+}
+
+ImageProcessor::RegionCropResult ImageProcessor::cropActiveRegions(
+    const types::ImageView& image,
+    const VisionLayer0Result& layer0,
+    const RegionCropConfig& config
+) {
+    std::vector<types::Rect> regions = layer0.changedRegions;
+    regions.insert(regions.end(), layer0.motionRegions.begin(), layer0.motionRegions.end());
+    if (layer0.processingWidth > 0 && layer0.processingHeight > 0) {
+        regions = VisionKernels::mapRegions(regions, layer0.processingWidth, layer0.processingHeight,
+                                            image.width, image.height, 0);
+    }
+    return cropActiveRegions(image, regions, config);
+}
+
+void ImageProcessor::imageDataToMat(const types::ImageView& image, void* outMat, bool toOpenCVOrder) {
     cv::Mat* mat = static_cast<cv::Mat*>(outMat);
     
     if (!image.isValid()) {
@@ -378,46 +833,30 @@ void ImageProcessor::imageDataToMat(const types::ImageData& image, void* outMat)
         return;
     }
 
-    int cvType = imageFormatToCVType(image.format);
-    
-    // 计算实际步长
-    uint32_t stride = image.stride > 0 ? image.stride : (image.width * image.bytesPerPixel());
-    
-    // 创建 Mat（复制数据以确保安全，因为 OpenCV 可能会修改数据）
-    *mat = cv::Mat(
+    // 直接引用调用方缓冲并保留行步长（有 padding 时也无需逐行复制）
+    // 该 Mat 只作为只读输入使用，去掉 const 仅为构造 Mat 头
+    cv::Mat wrapped(
         static_cast<int>(image.height),
         static_cast<int>(image.width),
-        cvType
+        imageFormatToCVType(image.format),
+        const_cast<uint8_t*>(image.data),
+        static_cast<size_t>(image.stride)
     );
 
-    // 复制数据
-    if (image.stride > 0 && image.stride != image.width * image.bytesPerPixel()) {
-        // 有 padding，需要逐行复制
-        for (uint32_t y = 0; y < image.height; ++y) {
-            const uint8_t* srcRow = image.data.data() + y * image.stride;
-            uint8_t* dstRow = mat->ptr<uint8_t>(static_cast<int>(y));
-            std::memcpy(dstRow, srcRow, image.width * image.bytesPerPixel());
-        }
+    // 需要 OpenCV 通道顺序时才转换（转换本身就会生成新缓冲，不再额外复制）
+    if (toOpenCVOrder && image.format == types::ImageFormat::RGB) {
+        cv::cvtColor(wrapped, *mat, cv::COLOR_RGB2BGR);
+    } else if (toOpenCVOrder && image.format == types::ImageFormat::RGBA) {
+        cv::cvtColor(wrapped, *mat, cv::COLOR_RGBA2BGRA);
     } else {
-        // 连续存储，直接复制
-        std::memcpy(mat->data, image.data.data(), image.data.size());
+        // BGR 和 BGRA 已经是 OpenCV 默认格式，不需要转换
+        *mat = wrapped;
     }
-
-    // 如果需要颜色空间转换
-    if (image.format == types::ImageFormat::RGB) {
-        cv::Mat temp;
-        cv::cvtColor(*mat, temp, cv::COLOR_RGB2BGR);
-        *mat = temp;
-    } else if (image.format == types::ImageFormat::RGBA) {
-        cv::Mat temp;
-        cv::cvtColor(*mat, temp, cv::COLOR_RGBA2BGRA);
-        *mat = temp;
-    }
-    // BGR 和 BGRA 已经是 OpenCV 默认格式，不需要转换
 }
 
 std::optional<types::ImageData> ImageProcessor::matToImageData(
     const void* mat,
+    types::ImageFormat matFormat,
     types::ImageFormat format
 ) {
     const cv::Mat* srcMat = static_cast<const cv::Mat*>(mat);
@@ -426,62 +865,25 @@ std::optional<types::ImageData> ImageProcessor::matToImageData(
         return std::nullopt;
     }
 
+    // 输出缓冲连续存储，转换/复制直接写入其中（源 Mat 可以是非连续的 ROI）
     types::ImageData result;
-    result.width = static_cast<uint32_t>(srcMat->cols);
-    result.height = static_cast<uint32_t>(srcMat->rows);
-    result.format = format;
-    result.stride = 0; // 连续存储
-
-    // 确定目标格式的通道数
-    int targetChannels = 0;
-    switch (format) {
-        case types::ImageFormat::Grayscale:
-            targetChannels = 1;
-            break;
-        case types::ImageFormat::RGB:
-        case types::ImageFormat::BGR:
-            targetChannels = 3;
-            break;
-        case types::ImageFormat::RGBA:
-        case types::ImageFormat::BGRA:
-            targetChannels = 4;
-            break;
-    }
-
-    cv::Mat processedMat;
-    
-    // 根据源 Mat 和目标格式进行转换
-    if (srcMat->channels() == 1 && targetChannels > 1) {
-        // 灰度转彩色
-        cv::cvtColor(*srcMat, processedMat, cv::COLOR_GRAY2BGR);
-        if (targetChannels == 4) {
-            cv::cvtColor(processedMat, processedMat, cv::COLOR_BGR2BGRA);
-        }
-    } else if (srcMat->channels() == 3 && targetChannels == 4) {
-        // BGR 转 BGRA
-        cv::cvtColor(*srcMat, processedMat, cv::COLOR_BGR2BGRA);
-    } else if (srcMat->channels() == 4 && targetChannels == 3) {
-        // BGRA 转 BGR
-        cv::cvtColor(*srcMat, processedMat, cv::COLOR_BGRA2BGR);
-    } else if (srcMat->channels() > 1 && targetChannels == 1) {
-        // 彩色转灰度
-        cv::cvtColor(*srcMat, processedMat, cv::COLOR_BGR2GRAY);
+    cv::Mat dstMat = allocateImageData(result,
+                                       static_cast<uint32_t>(srcMat->cols),
+                                       static_cast<uint32_t>(srcMat->rows),
+                                       format);
+
+    const int code = colorConversionCode(matFormat, format);
+    if (code < 0) {
+        srcMat->copyTo(dstMat);
     } else {
-        processedMat = *srcMat;
+        cv::cvtColor(*srcMat, dstMat, code);
     }
 
-    // 颜色空间转换（如果需要）
-    if (format == types::ImageFormat::RGB && processedMat.channels() == 3) {
-        cv::cvtColor(processedMat, processedMat, cv::COLOR_BGR2RGB);
-    } else if (format == types::ImageFormat::RGBA && processedMat.channels() == 4) {
-        cv::cvtColor(processedMat, processedMat, cv::COLOR_BGRA2RGBA);
+    // 目标缓冲被 OpenCV 重新分配说明格式不匹配
+    if (dstMat.data != result.data.data()) {
+        return std::nullopt;
     }
 
-    // 复制数据到 ImageData
-    size_t dataSize = processedMat.total() * processedMat.elemSize();
-    result.data.resize(dataSize);
-    std::memcpy(result.data.data(), processedMat.data, dataSize);
-
     return result;
 }
 
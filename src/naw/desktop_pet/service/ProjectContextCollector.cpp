@@ -1,15 +1,66 @@
 #include "naw/desktop_pet/service/ProjectContextCollector.h"
+#include "naw/desktop_pet/service/CodeTools.h"
+#include "naw/desktop_pet/service/tools/CMakeParser.h"
 
 #include <algorithm>
 #include <fstream>
+#include <map>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace fs = std::filesystem;
 
 namespace naw::desktop_pet::service {
 
+namespace {
+
+// 预热时单个文件的预读上限，超大文件留给按需读取
+constexpr std::uintmax_t kWarmupMaxFileBytes = 1024 * 1024;
+
+// 预热完成后复用其文件列表的最长时间（兜底外部新增的文件）
+constexpr std::chrono::minutes kWarmInfoMaxAge{2};
+
+// 降低当前线程的调度优先级，避免预热与前台请求争抢CPU
+void lowerCurrentThreadPriority() {
+#if defined(_WIN32)
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+    // Linux 下 nice 值按线程生效，预热线程派生的扫描线程也会继承
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+}
+
+} // namespace
+
+ProjectContextCollector::ProjectContextCollector()
+    : ProjectContextCollector(nullptr) {}
+
+ProjectContextCollector::ProjectContextCollector(std::shared_ptr<FileContentCache> fileCache)
+    : m_fileCache(fileCache ? fileCache : std::make_shared<FileContentCache>())
+    , m_ownsFileCache(!fileCache) {
+    // 订阅文件变更通知（对象不可移动，捕获 this 安全；析构时注销）
+    m_changeListenerId = m_fileCache->addChangeListener(
+        [this](const std::string& filePath) { updateDependencyGraphs(filePath); });
+}
+
+ProjectContextCollector::~ProjectContextCollector() {
+    cancelWarmup();
+    m_fileCache->removeChangeListener(m_changeListenerId);
+}
+
 // ========== 项目结构分析 ==========
 
 std::string ProjectContextCollector::detectProjectRoot(const std::string& startPath) {
@@ -63,112 +114,53 @@ nlohmann::json ProjectContextCollector::parseCMakeLists(const std::string& cmake
     result["dependencies"] = nlohmann::json::array();
     result["compile_options"] = nlohmann::json::array();
     result["include_directories"] = nlohmann::json::array();
+    result["target_graph"] = nlohmann::json::object();
     
     fs::path path(cmakePath);
     if (!fs::exists(path) || !fs::is_regular_file(path)) {
         return result;
     }
     
-    try {
-        std::ifstream file(path, std::ios::in);
-        if (!file.is_open()) {
-            return result;
-        }
-        
-        std::string line;
-        std::regex projectRegex(R"(project\s*\(\s*(\w+))");
-        std::regex addExecutableRegex(R"(add_executable\s*\(\s*(\w+))");
-        std::regex addLibraryRegex(R"(add_library\s*\(\s*(\w+))");
-        std::regex targetLinkLibrariesRegex(R"(target_link_libraries\s*\(\s*(\w+)\s+(.+)\))");
-        std::regex findPackageRegex(R"(find_package\s*\(\s*(\w+))");
-        std::regex targetCompileOptionsRegex(R"(target_compile_options\s*\(\s*(\w+)\s+(.+)\))");
-        std::regex targetCompileDefinitionsRegex(R"(target_compile_definitions\s*\(\s*(\w+)\s+(.+)\))");
-        std::regex targetIncludeDirectoriesRegex(R"(target_include_directories\s*\(\s*(\w+)\s+(.+)\))");
-        
-        while (std::getline(file, line)) {
-            // 移除注释
-            size_t commentPos = line.find('#');
-            if (commentPos != std::string::npos) {
-                line = line.substr(0, commentPos);
-            }
-            
-            std::smatch match;
-            
-            // 解析 project()
-            if (std::regex_search(line, match, projectRegex)) {
-                result["project_name"] = match[1].str();
-            }
-            
-            // 解析 add_executable()
-            if (std::regex_search(line, match, addExecutableRegex)) {
-                result["targets"].push_back(match[1].str());
-            }
-            
-            // 解析 add_library()
-            if (std::regex_search(line, match, addLibraryRegex)) {
-                result["targets"].push_back(match[1].str());
-            }
-            
-            // 解析 target_link_libraries()
-            if (std::regex_search(line, match, targetLinkLibrariesRegex)) {
-                std::string deps = match[2].str();
-                // 简单分割依赖（实际应该更复杂）
-                std::istringstream iss(deps);
-                std::string dep;
-                while (iss >> dep) {
-                    if (!dep.empty()) {
-                        result["dependencies"].push_back(dep);
-                    }
-                }
-            }
-            
-            // 解析 find_package()
-            if (std::regex_search(line, match, findPackageRegex)) {
-                result["dependencies"].push_back(match[1].str());
-            }
-            
-            // 解析 target_compile_options()
-            if (std::regex_search(line, match, targetCompileOptionsRegex)) {
-                std::string options = match[2].str();
-                std::istringstream iss(options);
-                std::string opt;
-                while (iss >> opt) {
-                    if (!opt.empty()) {
-                        result["compile_options"].push_back(opt);
-                    }
-                }
-            }
-            
-            // 解析 target_compile_definitions()
-            if (std::regex_search(line, match, targetCompileDefinitionsRegex)) {
-                std::string defs = match[2].str();
-                std::istringstream iss(defs);
-                std::string def;
-                while (iss >> def) {
-                    if (!def.empty()) {
-                        result["compile_options"].push_back(def);
-                    }
-                }
-            }
-            
-            // 解析 target_include_directories()
-            if (std::regex_search(line, match, targetIncludeDirectoriesRegex)) {
-                std::string dirs = match[2].str();
-                std::istringstream iss(dirs);
-                std::string dir;
-                while (iss >> dir) {
-                    if (!dir.empty()) {
-                        result["include_directories"].push_back(dir);
-                    }
-                }
+    // 使用共享的项目模型（包含子目录中的CMakeLists.txt，按内容哈希缓存）
+    auto model = tools::CMakeParser::loadProjectModel(path.parent_path());
+    result["project_name"] = model->projectName;
+    
+    std::vector<std::string> dependencies = model->dependencies;
+    std::vector<std::string> compileOptions;
+    std::vector<std::string> includeDirs;
+    auto appendUnique = [](std::vector<std::string>& out, const std::vector<std::string>& values) {
+        for (const auto& value : values) {
+            if (std::find(out.begin(), out.end(), value) == out.end()) {
+                out.push_back(value);
             }
         }
+    };
+    
+    for (const auto& [name, target] : model->targets) {
+        if (target.kind.empty()) {
+            continue;  // 仅被 target_* 命令引用、未在项目中定义的目标
+        }
+        result["targets"].push_back(name);
+        appendUnique(dependencies, model->externalDependencies(name));
+        appendUnique(compileOptions, target.compileOptions);
+        appendUnique(compileOptions, target.compileDefinitions);
+        appendUnique(includeDirs, target.includeDirs);
         
-        file.close();
-    } catch (...) {
-        // 解析失败，返回空结果
+        nlohmann::json node;
+        node["type"] = target.kind;
+        node["defined_in"] = target.definedIn;
+        node["sources"] = target.sources.size();
+        node["links"] = model->internalDependencies(name);
+        result["target_graph"][name] = node;
+    }
+    std::map<std::string, tools::CMakeProjectInfo> orderedFiles(model->files.begin(), model->files.end());
+    for (const auto& [file, info] : orderedFiles) {
+        appendUnique(includeDirs, info.includeDirs);
     }
     
+    result["dependencies"] = dependencies;
+    result["compile_options"] = compileOptions;
+    result["include_directories"] = includeDirs;
     return result;
 }
 
@@ -206,69 +198,39 @@ std::string ProjectContextCollector::identifyFileType(const std::string& filePat
 ProjectInfo ProjectContextCollector::analyzeProject(const std::string& projectRoot, ErrorInfo* error) {
     ProjectInfo info;
     info.rootPath = fs::absolute(projectRoot).string();
+
+    // 预热进行中：直接返回已发布的（部分）结果，避免与预热线程重复全量扫描；
+    // 预热完成：复用其文件列表与目录结构，只做依赖图的增量同步
+    bool reuseWarmInfo = false;
+    {
+        std::lock_guard<std::mutex> lock(m_warmupMutex);
+        if (m_warmupStatus.projectRoot == info.rootPath && m_warmInfo.has_value()) {
+            if (m_warmupStatus.state == WarmupState::Warming) {
+                return *m_warmInfo;
+            }
+            if (m_warmupStatus.state == WarmupState::Ready &&
+                std::chrono::steady_clock::now() - m_warmInfoTime < kWarmInfoMaxAge) {
+                info = *m_warmInfo;
+                reuseWarmInfo = true;
+            } else {
+                m_warmInfo.reset();
+            }
+        }
+    }
     
     try {
-        fs::path rootPath(info.rootPath);
-        if (!fs::exists(rootPath)) {
-            if (error) {
-                error->errorType = ErrorType::InvalidRequest;
-                error->message = "项目根目录不存在: " + info.rootPath;
-            }
+        if (reuseWarmInfo) {
+            info.dependencyGraph->sync(info.sourceFiles, info.headerFiles);
             return info;
         }
-        
-        // 解析 CMakeLists.txt
-        fs::path cmakePath = rootPath / "CMakeLists.txt";
-        info.cmakeConfig = parseCMakeLists(cmakePath.string());
-        if (info.cmakeConfig.contains("project_name") && 
-            !info.cmakeConfig["project_name"].empty()) {
-            info.name = info.cmakeConfig["project_name"].get<std::string>();
-        } else {
-            info.name = rootPath.filename().string();
-        }
-        
-        // 提取依赖
-        info.dependencies = extractDependenciesFromCMake(info.cmakeConfig);
-        
-        // 扫描目录结构
-        std::vector<std::string> sourceFiles;
-        std::vector<std::string> headerFiles;
-        
-        try {
-            fs::recursive_directory_iterator dirIter(rootPath, 
-                fs::directory_options::skip_permission_denied);
-            for (const auto& entry : dirIter) {
-                try {
-                    // 跳过符号链接，避免无限循环
-                    if (fs::is_symlink(entry)) {
-                        dirIter.disable_recursion_pending();
-                        continue;
-                    }
-                    
-                    if (fs::is_regular_file(entry)) {
-                        std::string filePath = entry.path().string();
-                        std::string fileType = identifyFileType(filePath);
-                        
-                        if (fileType == "cpp") {
-                            sourceFiles.push_back(filePath);
-                        } else if (fileType == "header") {
-                            headerFiles.push_back(filePath);
-                        }
-                    }
-                } catch (const fs::filesystem_error&) {
-                    // 跳过权限错误等文件系统错误
-                    dirIter.disable_recursion_pending();
-                    continue;
-                } catch (...) {
-                    continue;
-                }
-            }
-        } catch (...) {
-            // 忽略遍历错误
+        if (!collectProjectFiles(info, error)) {
+            return info;
         }
         
-        info.sourceFiles = std::move(sourceFiles);
-        info.headerFiles = std::move(headerFiles);
+        // 构建/增量同步依赖图（同一项目复用已有图，只重新扫描变化的文件）
+        auto graph = dependencyGraphFor(info.rootPath);
+        graph->sync(info.sourceFiles, info.headerFiles);
+        info.dependencyGraph = graph;
         
         // 构建目录结构
         info.directoryStructure = buildDirectoryStructure(info.rootPath);
@@ -288,6 +250,288 @@ ProjectInfo ProjectContextCollector::analyzeProject(const std::string& projectRo
     return info;
 }
 
+bool ProjectContextCollector::collectProjectFiles(ProjectInfo& info, ErrorInfo* error, const std::atomic<bool>* cancel) {
+    fs::path rootPath(info.rootPath);
+    if (!fs::exists(rootPath)) {
+        if (error) {
+            error->errorType = ErrorType::InvalidRequest;
+            error->message = "项目根目录不存在: " + info.rootPath;
+        }
+        return false;
+    }
+    
+    // 解析 CMakeLists.txt
+    fs::path cmakePath = rootPath / "CMakeLists.txt";
+    info.cmakeConfig = parseCMakeLists(cmakePath.string());
+    if (info.cmakeConfig.contains("project_name") && 
+        !info.cmakeConfig["project_name"].empty()) {
+        info.name = info.cmakeConfig["project_name"].get<std::string>();
+    } else {
+        info.name = rootPath.filename().string();
+    }
+    
+    // 提取依赖
+    info.dependencies = extractDependenciesFromCMake(info.cmakeConfig);
+    
+    // 扫描目录结构
+    std::vector<std::string> sourceFiles;
+    std::vector<std::string> headerFiles;
+    
+    try {
+        fs::recursive_directory_iterator dirIter(rootPath, 
+            fs::directory_options::skip_permission_denied);
+        for (const auto& entry : dirIter) {
+            if (cancel && cancel->load(std::memory_order_relaxed)) {
+                break;
+            }
+            try {
+                // 跳过符号链接，避免无限循环
+                if (fs::is_symlink(entry)) {
+                    dirIter.disable_recursion_pending();
+                    continue;
+                }
+                
+                if (fs::is_regular_file(entry)) {
+                    std::string filePath = entry.path().string();
+                    std::string fileType = identifyFileType(filePath);
+                    
+                    if (fileType == "cpp") {
+                        sourceFiles.push_back(filePath);
+                    } else if (fileType == "header") {
+                        headerFiles.push_back(filePath);
+                    }
+                }
+            } catch (const fs::filesystem_error&) {
+                // 跳过权限错误等文件系统错误
+                dirIter.disable_recursion_pending();
+                continue;
+            } catch (...) {
+                continue;
+            }
+        }
+    } catch (...) {
+        // 忽略遍历错误
+    }
+    
+    info.sourceFiles = std::move(sourceFiles);
+    info.headerFiles = std::move(headerFiles);
+    return true;
+}
+
+std::shared_ptr<ProjectDependencyGraph> ProjectContextCollector::dependencyGraphFor(const std::string& rootPath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& slot = m_dependencyGraphs[rootPath];
+    if (!slot) {
+        slot = std::make_shared<ProjectDependencyGraph>();
+    }
+    return slot;
+}
+
+// ========== 后台预热 ==========
+
+nlohmann::json ProjectWarmupStatus::toJson() const {
+    const char* stateStr = "idle";
+    switch (state) {
+        case WarmupState::Idle: stateStr = "idle"; break;
+        case WarmupState::Warming: stateStr = "warming"; break;
+        case WarmupState::Ready: stateStr = "ready"; break;
+        case WarmupState::Failed: stateStr = "failed"; break;
+        case WarmupState::Cancelled: stateStr = "cancelled"; break;
+    }
+    nlohmann::json j;
+    j["state"] = stateStr;
+    j["project_root"] = projectRoot;
+    j["stage"] = stage;
+    j["partial_available"] = partialAvailable;
+    j["files_total"] = filesTotal;
+    j["files_indexed"] = filesIndexed;
+    j["elapsed_ms"] = elapsedMs;
+    if (!error.empty()) {
+        j["error"] = error;
+    }
+    return j;
+}
+
+bool ProjectContextCollector::startWarmup(const std::string& projectRoot) {
+    const std::string rootPath = fs::absolute(projectRoot).string();
+    // 检查、停止旧线程、重置状态与创建新线程整体串行，避免并发调用重复赋值仍可 join 的线程
+    std::lock_guard<std::mutex> control(m_warmupControlMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_warmupMutex);
+        if (m_warmupStatus.projectRoot == rootPath &&
+            (m_warmupStatus.state == WarmupState::Warming || m_warmupStatus.state == WarmupState::Ready)) {
+            return false;
+        }
+    }
+
+    // 切换项目时先停止旧的预热
+    stopWarmupThread();
+
+    {
+        std::lock_guard<std::mutex> lock(m_warmupMutex);
+        m_warmupStatus = ProjectWarmupStatus{};
+        m_warmupStatus.state = WarmupState::Warming;
+        m_warmupStatus.projectRoot = rootPath;
+        m_warmInfo.reset();
+        m_warmupStart = std::chrono::steady_clock::now();
+    }
+    m_warmupCancel = false;
+    m_warmupThread = std::thread([this, rootPath]() { runWarmup(rootPath); });
+    return true;
+}
+
+ProjectWarmupStatus ProjectContextCollector::getWarmupStatus() const {
+    std::lock_guard<std::mutex> lock(m_warmupMutex);
+    ProjectWarmupStatus status = m_warmupStatus;
+    if (status.state == WarmupState::Warming) {
+        status.elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - m_warmupStart).count();
+    }
+    return status;
+}
+
+bool ProjectContextCollector::waitForWarmup(std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(m_warmupMutex);
+    return m_warmupCv.wait_for(lock, timeout, [this]() {
+        return m_warmupStatus.state != WarmupState::Warming;
+    });
+}
+
+void ProjectContextCollector::cancelWarmup() {
+    std::lock_guard<std::mutex> control(m_warmupControlMutex);
+    stopWarmupThread();
+}
+
+void ProjectContextCollector::stopWarmupThread() {
+    m_warmupCancel = true;
+    if (m_warmupThread.joinable()) {
+        m_warmupThread.join();
+    }
+}
+
+void ProjectContextCollector::updateWarmupStatus(WarmupState state, const std::string& stage, const std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(m_warmupMutex);
+        m_warmupStatus.state = state;
+        m_warmupStatus.stage = stage;
+        m_warmupStatus.error = error;
+        if (state != WarmupState::Warming) {
+            m_warmupStatus.elapsedMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - m_warmupStart).count();
+            // 完成时保留完整结果供 analyzeProject 复用；失败或取消时结果可能不完整，丢弃
+            if (state != WarmupState::Ready) {
+                m_warmInfo.reset();
+            }
+        }
+    }
+    m_warmupCv.notify_all();
+}
+
+void ProjectContextCollector::runWarmup(const std::string& rootPath) {
+    lowerCurrentThreadPriority();
+
+    auto cancelled = [this]() {
+        if (m_warmupCancel.load()) {
+            updateWarmupStatus(WarmupState::Cancelled, getWarmupStatus().stage);
+            return true;
+        }
+        return false;
+    };
+
+    try {
+        // 1. CMake 项目模型（共享缓存，后续工具调用直接命中）
+        updateWarmupStatus(WarmupState::Warming, "cmake_model");
+        if (fs::exists(fs::path(rootPath) / "CMakeLists.txt")) {
+            tools::CMakeParser::loadProjectModel(rootPath);
+        }
+        if (cancelled()) {
+            return;
+        }
+
+        // 2. 文件列表：完成后即发布部分结果
+        updateWarmupStatus(WarmupState::Warming, "file_scan");
+        ProjectInfo info;
+        info.rootPath = rootPath;
+        ErrorInfo error;
+        const bool collected = collectProjectFiles(info, &error, &m_warmupCancel);
+        if (cancelled()) {
+            return;
+        }
+        if (!collected) {
+            updateWarmupStatus(WarmupState::Failed, "file_scan", error.message);
+            return;
+        }
+        info.partial = true;
+        {
+            std::lock_guard<std::mutex> lock(m_warmupMutex);
+            m_warmInfo = info;
+            m_warmInfoTime = std::chrono::steady_clock::now();
+            m_warmupStatus.partialAvailable = true;
+            m_warmupStatus.filesTotal = info.sourceFiles.size() + info.headerFiles.size();
+        }
+
+        // 3. 白名单与项目结构缓存（get_project_structure 默认参数）
+        updateWarmupStatus(WarmupState::Warming, "project_structure");
+        CodeTools::prewarmProjectStructure(rootPath, &m_warmupCancel);
+        if (cancelled()) {
+            return;
+        }
+
+        // 4. 依赖图
+        updateWarmupStatus(WarmupState::Warming, "dependency_graph");
+        auto graph = dependencyGraphFor(rootPath);
+        graph->sync(info.sourceFiles, info.headerFiles, &m_warmupCancel);
+        if (cancelled()) {
+            return;
+        }
+        info.dependencyGraph = graph;
+        info.directoryStructure = buildDirectoryStructure(rootPath);
+        info.partial = false;
+        {
+            std::lock_guard<std::mutex> lock(m_warmupMutex);
+            m_warmInfo = info;
+            m_warmInfoTime = std::chrono::steady_clock::now();
+        }
+
+        // 5. 预读源文件到内容缓存（最多占用缓存预算的一半，供检索/打包上下文使用）
+        updateWarmupStatus(WarmupState::Warming, "content_index");
+        const size_t byteBudget = m_fileCache->getMaxBytes() / 2;
+        size_t bytesLoaded = 0;
+        std::vector<const std::string*> files;
+        files.reserve(info.headerFiles.size() + info.sourceFiles.size());
+        for (const auto& file : info.headerFiles) {
+            files.push_back(&file);
+        }
+        for (const auto& file : info.sourceFiles) {
+            files.push_back(&file);
+        }
+        for (const std::string* file : files) {
+            if (m_warmupCancel.load()) {
+                break;
+            }
+            std::error_code ec;
+            const auto size = fs::file_size(*file, ec);
+            if (ec || size > kWarmupMaxFileBytes || bytesLoaded + size > byteBudget) {
+                continue;
+            }
+            if (m_fileCache->get(*file)) {
+                bytesLoaded += static_cast<size_t>(size);
+                std::lock_guard<std::mutex> lock(m_warmupMutex);
+                ++m_warmupStatus.filesIndexed;
+            }
+        }
+        if (cancelled()) {
+            return;
+        }
+
+        updateWarmupStatus(WarmupState::Ready, "content_index");
+    } catch (const std::exception& e) {
+        updateWarmupStatus(WarmupState::Failed, getWarmupStatus().stage, e.what());
+    } catch (...) {
+        updateWarmupStatus(WarmupState::Failed, getWarmupStatus().stage, "预热时发生未知错误");
+    }
+}
+
 std::string ProjectContextCollector::buildDirectoryStructure(const std::string& projectRoot, int maxDepth) {
     std::ostringstream structure;
     try {
@@ -400,6 +644,10 @@ std::vector<std::string> ProjectContextCollector::extractIncludesFromSource(
     const std::string& filePath,
     const ProjectInfo& projectInfo
 ) {
+    if (projectInfo.dependencyGraph && projectInfo.dependencyGraph->contains(filePath)) {
+        return projectInfo.dependencyGraph->getIncludes(filePath);
+    }
+    
     std::vector<std::string> includes;
     
     try {
@@ -460,12 +708,67 @@ std::vector<std::string> ProjectContextCollector::extractIncludesFromSource(
     return includes;
 }
 
+std::shared_ptr<ProjectDependencyGraph> ProjectContextCollector::getDependencyGraph(
+    const std::string& projectRoot
+) const {
+    std::string rootPath = fs::absolute(projectRoot).string();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_dependencyGraphs.find(rootPath);
+    return it != m_dependencyGraphs.end() ? it->second : nullptr;
+}
+
+void ProjectContextCollector::notifyFileChanged(const std::string& filePath) {
+    // 使内容缓存失效，并回调所有监听者（包括本对象的 updateDependencyGraphs）
+    m_fileCache->notifyFileChanged(filePath);
+}
+
+void ProjectContextCollector::updateDependencyGraphs(const std::string& filePath) {
+    std::string absolutePath = fs::absolute(filePath).lexically_normal().string();
+    std::string fileType = identifyFileType(absolutePath);
+    
+    std::vector<std::shared_ptr<ProjectDependencyGraph>> graphs;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [root, graph] : m_dependencyGraphs) {
+            // 只更新该文件所属项目的依赖图
+            fs::path relative = fs::path(absolutePath).lexically_relative(root);
+            if (!relative.empty() && *relative.begin() != "..") {
+                graphs.push_back(graph);
+            }
+        }
+    }
+    
+    // 预热得到的文件列表不包含新出现的源文件/头文件，丢弃后由 analyzeProject 重新扫描
+    if (fileType == "cpp" || fileType == "header") {
+        std::lock_guard<std::mutex> lock(m_warmupMutex);
+        if (m_warmInfo.has_value() && m_warmupStatus.state == WarmupState::Ready) {
+            const auto& files = fileType == "cpp" ? m_warmInfo->sourceFiles : m_warmInfo->headerFiles;
+            fs::path relative = fs::path(absolutePath).lexically_relative(m_warmInfo->rootPath);
+            if (!relative.empty() && *relative.begin() != ".." &&
+                std::find(files.begin(), files.end(), absolutePath) == files.end()) {
+                m_warmInfo.reset();
+            }
+        }
+    }
+    
+    // 图更新会读取文件，放在 m_mutex 之外进行
+    for (const auto& graph : graphs) {
+        if (graph->contains(absolutePath) || fileType == "cpp" || fileType == "header") {
+            graph->updateFile(absolutePath, fileType == "header");
+        }
+    }
+}
+
 // ========== 文件上下文收集 ==========
 
 std::vector<std::string> ProjectContextCollector::findFilesIncluding(
     const std::string& targetFile,
     const ProjectInfo& projectInfo
 ) {
+    if (projectInfo.dependencyGraph && projectInfo.dependencyGraph->contains(targetFile)) {
+        return projectInfo.dependencyGraph->getIncludedBy(targetFile);
+    }
+    
     std::vector<std::string> includingFiles;
     
     fs::path targetPath(targetFile);
@@ -528,72 +831,9 @@ std::vector<std::string> ProjectContextCollector::findRelatedFiles(
     return relatedFiles;
 }
 
-bool ProjectContextCollector::needsCacheUpdate(const std::string& filePath) {
-    try {
-        if (!fs::exists(filePath)) {
-            // 文件不存在，清除缓存
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_fileCache.erase(filePath);
-            m_fileModifyTime.erase(filePath);
-            return true;
-        }
-        
-        auto currentModifyTime = fs::last_write_time(filePath);
-        
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            auto it = m_fileModifyTime.find(filePath);
-            if (it == m_fileModifyTime.end()) {
-                return true; // 缓存中没有，需要更新
-            }
-            
-            return currentModifyTime != it->second; // 修改时间不同，需要更新
-        }
-    } catch (...) {
-        return true; // 出错时，假设需要更新
-    }
-}
-
-std::string ProjectContextCollector::readFileWithCache(const std::string& filePath) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    // 检查缓存
-    if (!needsCacheUpdate(filePath)) {
-        auto it = m_fileCache.find(filePath);
-        if (it != m_fileCache.end()) {
-            return it->second;
-        }
-    }
-    
-    // 读取文件
-    std::string content;
-    try {
-        std::ifstream file(filePath, std::ios::in | std::ios::binary);
-        if (!file.is_open()) {
-            return "";
-        }
-        
-        // 读取整个文件
-        file.seekg(0, std::ios::end);
-        size_t size = file.tellg();
-        file.seekg(0, std::ios::beg);
-        
-        content.resize(size);
-        file.read(&content[0], size);
-        file.close();
-        
-        // 更新缓存
-        m_fileCache[filePath] = content;
-        try {
-            m_fileModifyTime[filePath] = fs::last_write_time(filePath);
-        } catch (...) {
-            // 忽略时间获取错误
-        }
-    } catch (...) {
-        return "";
-    }
-    
-    return content;
+FileContentCache::Content ProjectContextCollector::readFileWithCache(const std::string& filePath) {
+    // FileContentCache 自带锁，且在锁外读取文件，这里不持有 m_mutex
+    return m_fileCache->get(filePath);
 }
 
 std::string ProjectContextCollector::getFileContext(
@@ -606,10 +846,10 @@ std::string ProjectContextCollector::getFileContext(
     std::ostringstream context;
     
     // 读取主文件内容
-    std::string mainContent = readFileWithCache(filePath);
-    if (!mainContent.empty()) {
+    auto mainContent = readFileWithCache(filePath);
+    if (mainContent && !mainContent->empty()) {
         context << "=== " << filePath << " ===\n";
-        context << mainContent << "\n\n";
+        context << *mainContent << "\n\n";
     }
     
     // 查找相关文件
@@ -623,19 +863,18 @@ std::string ProjectContextCollector::getFileContext(
     // 读取相关文件内容
     size_t currentTokens = 0; // 简单估算：字符数 / 4
     for (const auto& relatedFile : relatedFiles) {
+        auto content = readFileWithCache(relatedFile);
         if (maxTokens > 0) {
-            std::string content = readFileWithCache(relatedFile);
-            size_t estimatedTokens = content.length() / 4;
+            size_t estimatedTokens = content ? content->length() / 4 : 0;
             if (currentTokens + estimatedTokens > maxTokens) {
                 break; // 超过Token限制
             }
             currentTokens += estimatedTokens;
         }
         
-        std::string content = readFileWithCache(relatedFile);
-        if (!content.empty()) {
+        if (content && !content->empty()) {
             context << "=== " << relatedFile << " ===\n";
-            context << content << "\n\n";
+            context << *content << "\n\n";
         }
     }
     
@@ -720,6 +959,11 @@ std::string ProjectContextCollector::getProjectSummary(const ProjectInfo& projec
         summaryStr = summaryStr.substr(0, maxLength) + "\n...(truncated)";
     }
     
+    // 预热中途的部分结果（尚无目录结构与依赖图）不缓存，避免完整结果就绪后仍返回不完整的摘要
+    if (projectInfo.partial) {
+        return summaryStr;
+    }
+    
     // 更新缓存
     m_summaryCache[projectInfo.rootPath] = summaryStr;
     try {
@@ -738,7 +982,8 @@ std::string ProjectContextCollector::getProjectSummary(const ProjectInfo& projec
 
 ProjectContext ProjectContextCollector::collectProjectContext(
     const std::string& projectRoot,
-    ErrorInfo* error
+    ErrorInfo* error,
+    ProjectInfo* projectInfo
 ) {
     ProjectContext context;
     
@@ -776,15 +1021,45 @@ ProjectContext ProjectContextCollector::collectProjectContext(
         );
     }
     
+    if (projectInfo) {
+        *projectInfo = std::move(info);
+    }
+    
     return context;
 }
 
 // ========== 缓存管理 ==========
 
 void ProjectContextCollector::clearFileCache() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_fileCache.clear();
-    m_fileModifyTime.clear();
+    if (m_ownsFileCache) {
+        m_fileCache->clear();
+        return;
+    }
+
+    // 共享缓存还有其他使用方：只清理本收集器分析过的项目目录下的条目
+    std::set<std::string> roots;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [root, graph] : m_dependencyGraphs) {
+            roots.insert(root);
+        }
+        for (const auto& [root, summary] : m_summaryCache) {
+            roots.insert(root);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_warmupMutex);
+        if (!m_warmupStatus.projectRoot.empty()) {
+            roots.insert(m_warmupStatus.projectRoot);
+        }
+    }
+    for (const auto& root : roots) {
+        m_fileCache->invalidateUnder(root);
+    }
+}
+
+void ProjectContextCollector::setFileCacheLimitMB(size_t maxMegabytes) {
+    m_fileCache->setMaxMegabytes(maxMegabytes);
 }
 
 void ProjectContextCollector::clearSummaryCache() {
@@ -796,6 +1071,14 @@ void ProjectContextCollector::clearSummaryCache() {
 void ProjectContextCollector::clearAllCaches() {
     clearFileCache();
     clearSummaryCache();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dependencyGraphs.clear();
+    }
+    // 预热结果引用的依赖图已不再接收变更通知
+    std::lock_guard<std::mutex> lock(m_warmupMutex);
+    m_warmInfo.reset();
 }
 
 } // namespace naw::desktop_pet::service
@@ -0,0 +1,500 @@
+#include "naw/desktop_pet/service/ProjectDependencyGraph.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace naw::desktop_pet::service {
+
+namespace {
+
+bool isPythonFile(const std::string& filePath) {
+    std::string ext = fs::path(filePath).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".py";
+}
+
+size_t skipSpaces(const std::string& line, size_t pos) {
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) {
+        ++pos;
+    }
+    return pos;
+}
+
+bool isIdentChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+} // namespace
+
+// ========== 指令提取 ==========
+
+std::vector<std::string> ProjectDependencyGraph::scanDirectives(const std::string& content, bool isPython) {
+    std::vector<std::string> directives;
+
+    size_t lineStart = 0;
+    while (lineStart < content.size()) {
+        size_t lineEnd = content.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = content.size();
+        }
+        std::string line = content.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        if (isPython) {
+            // import module（仅行首）
+            if (line.compare(0, 6, "import") != 0 || line.size() <= 6 ||
+                (line[6] != ' ' && line[6] != '\t')) {
+                continue;
+            }
+            size_t pos = skipSpaces(line, 6);
+            size_t end = pos;
+            while (end < line.size() && isIdentChar(line[end])) {
+                ++end;
+            }
+            if (end > pos) {
+                directives.push_back(line.substr(pos, end - pos));
+            }
+            continue;
+        }
+
+        // #include "path" / #include <path>
+        size_t pos = skipSpaces(line, 0);
+        if (pos >= line.size() || line[pos] != '#') {
+            continue;
+        }
+        pos = skipSpaces(line, pos + 1);
+        if (line.compare(pos, 7, "include") != 0) {
+            continue;
+        }
+        pos = skipSpaces(line, pos + 7);
+        if (pos >= line.size() || (line[pos] != '"' && line[pos] != '<')) {
+            continue;
+        }
+        const char closing = line[pos] == '"' ? '"' : '>';
+        size_t end = line.find(closing, pos + 1);
+        if (end != std::string::npos && end > pos + 1) {
+            directives.push_back(line.substr(pos + 1, end - pos - 1));
+        }
+    }
+
+    return directives;
+}
+
+std::string ProjectDependencyGraph::normalizeKey(const std::string& filePath) {
+    try {
+        return fs::path(filePath).lexically_normal().string();
+    } catch (...) {
+        return filePath;
+    }
+}
+
+std::string ProjectDependencyGraph::referenceName(const std::string& rawInclude, bool isPython) {
+    if (isPython) {
+        return rawInclude;
+    }
+    return fs::path(rawInclude).filename().string();
+}
+
+// ========== 扫描（锁外执行） ==========
+
+ProjectDependencyGraph::ScanResult ProjectDependencyGraph::scanFile(const std::string& key, bool isHeader) {
+    ScanResult scan;
+    scan.key = key;
+    scan.isHeader = isHeader;
+    scan.isPython = isPythonFile(key);
+
+    std::error_code ec;
+    if (!fs::is_regular_file(key, ec)) {
+        return scan;
+    }
+    scan.modifyTime = fs::last_write_time(key, ec);
+
+    std::ifstream file(key, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return scan;
+    }
+    std::ostringstream oss;
+    oss << file.rdbuf();
+
+    scan.exists = true;
+    scan.rawIncludes = scanDirectives(oss.str(), scan.isPython);
+    return scan;
+}
+
+std::vector<ProjectDependencyGraph::ScanResult> ProjectDependencyGraph::scanFilesParallel(
+    const std::vector<std::pair<std::string, bool>>& files,
+    const std::atomic<bool>* cancel
+) {
+    std::vector<ScanResult> results(files.size());
+    if (files.empty()) {
+        return results;
+    }
+
+    unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    // 对于少量文件，不使用多线程
+    if (files.size() < 10) {
+        numThreads = 1;
+    }
+
+    size_t filesPerThread = (files.size() + numThreads - 1) / numThreads;
+    std::vector<std::thread> threads;
+
+    // 每个线程写入自己负责的下标区间，无需加锁
+    for (unsigned int t = 0; t < numThreads; ++t) {
+        size_t startIdx = t * filesPerThread;
+        size_t endIdx = std::min(startIdx + filesPerThread, files.size());
+        if (startIdx >= files.size()) {
+            break;
+        }
+
+        threads.emplace_back([&files, &results, cancel, startIdx, endIdx]() {
+            for (size_t i = startIdx; i < endIdx; ++i) {
+                if (cancel && cancel->load(std::memory_order_relaxed)) {
+                    break;
+                }
+                try {
+                    results[i] = scanFile(files[i].first, files[i].second);
+                } catch (...) {
+                    results[i].key = files[i].first;
+                    results[i].exists = false;
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    return results;
+}
+
+// ========== 构建与增量更新 ==========
+
+size_t ProjectDependencyGraph::sync(
+    const std::vector<std::string>& sourceFiles,
+    const std::vector<std::string>& headerFiles,
+    const std::atomic<bool>* cancel
+) {
+    auto cancelled = [cancel]() { return cancel && cancel->load(std::memory_order_relaxed); };
+
+    // 规范化并去重
+    std::vector<std::pair<std::string, bool>> wanted;
+    std::unordered_set<std::string> wantedKeys;
+    wanted.reserve(sourceFiles.size() + headerFiles.size());
+    for (const auto& file : sourceFiles) {
+        std::string key = normalizeKey(file);
+        if (wantedKeys.insert(key).second) {
+            wanted.emplace_back(std::move(key), false);
+        }
+    }
+    for (const auto& file : headerFiles) {
+        std::string key = normalizeKey(file);
+        if (wantedKeys.insert(key).second) {
+            wanted.emplace_back(std::move(key), true);
+        }
+    }
+
+    // 获取当前修改时间（锁外）
+    std::vector<fs::file_time_type> currentTimes(wanted.size());
+    for (size_t i = 0; i < wanted.size(); ++i) {
+        if (cancelled()) {
+            return 0;
+        }
+        std::error_code ec;
+        currentTimes[i] = fs::last_write_time(wanted[i].first, ec);
+    }
+
+    // 找出需要重新扫描和需要移除的文件
+    std::vector<std::pair<std::string, bool>> toScan;
+    std::vector<std::string> toRemove;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        for (size_t i = 0; i < wanted.size(); ++i) {
+            auto it = m_nodes.find(wanted[i].first);
+            if (it == m_nodes.end() || it->second.modifyTime != currentTimes[i]) {
+                toScan.push_back(wanted[i]);
+            }
+        }
+        for (const auto& [key, node] : m_nodes) {
+            if (wantedKeys.find(key) == wantedKeys.end()) {
+                toRemove.push_back(key);
+            }
+        }
+    }
+
+    if (toScan.empty() && toRemove.empty()) {
+        return 0;
+    }
+
+    // 并行读取与解析（锁外）
+    std::vector<ScanResult> scans = scanFilesParallel(toScan, cancel);
+    // 扫描被取消时结果不完整，整体丢弃，图保持原样（下次同步重新扫描）
+    if (cancelled()) {
+        return 0;
+    }
+
+    // 应用结果（按输入顺序，保证解析结果稳定）
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (const auto& key : toRemove) {
+        removeLocked(key);
+    }
+    for (auto& scan : scans) {
+        applyScanLocked(std::move(scan));
+    }
+
+    return toScan.size();
+}
+
+void ProjectDependencyGraph::updateFile(const std::string& filePath, bool isHeader) {
+    std::string key = normalizeKey(filePath);
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_nodes.find(key);
+        if (it != m_nodes.end()) {
+            isHeader = it->second.isHeader;
+        }
+    }
+
+    ScanResult scan = scanFile(key, isHeader);
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    applyScanLocked(std::move(scan));
+}
+
+void ProjectDependencyGraph::removeFile(const std::string& filePath) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    removeLocked(normalizeKey(filePath));
+}
+
+void ProjectDependencyGraph::clear() {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_nodes.clear();
+    m_headerNameIndex.clear();
+    m_sourceStemIndex.clear();
+    m_referrers.clear();
+}
+
+// ========== 查询 ==========
+
+bool ProjectDependencyGraph::contains(const std::string& filePath) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_nodes.find(normalizeKey(filePath)) != m_nodes.end();
+}
+
+std::vector<std::string> ProjectDependencyGraph::getIncludes(const std::string& filePath) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_nodes.find(normalizeKey(filePath));
+    if (it == m_nodes.end()) {
+        return {};
+    }
+    return it->second.includes;
+}
+
+std::vector<std::string> ProjectDependencyGraph::getIncludedBy(const std::string& filePath) const {
+    std::vector<std::string> result;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_nodes.find(normalizeKey(filePath));
+        if (it == m_nodes.end()) {
+            return result;
+        }
+        result.assign(it->second.includedBy.begin(), it->second.includedBy.end());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+size_t ProjectDependencyGraph::fileCount() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_nodes.size();
+}
+
+size_t ProjectDependencyGraph::edgeCount() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    size_t count = 0;
+    for (const auto& [key, node] : m_nodes) {
+        count += node.includes.size();
+    }
+    return count;
+}
+
+// ========== 内部辅助方法（调用方持有写锁） ==========
+
+void ProjectDependencyGraph::applyScanLocked(ScanResult&& scan) {
+    if (!scan.exists) {
+        removeLocked(scan.key);
+        return;
+    }
+
+    auto it = m_nodes.find(scan.key);
+    const bool isNew = (it == m_nodes.end());
+    if (!isNew) {
+        unlinkLocked(scan.key);
+    }
+
+    Node& node = m_nodes[scan.key];
+    node.rawIncludes = std::move(scan.rawIncludes);
+    node.modifyTime = scan.modifyTime;
+    node.isPython = scan.isPython;
+
+    if (!isNew) {
+        linkLocked(scan.key);
+        return;
+    }
+
+    node.isHeader = scan.isHeader;
+    fs::path path(scan.key);
+    std::string name;
+    if (node.isHeader) {
+        name = path.filename().string();
+        m_headerNameIndex[name].push_back(scan.key);
+    } else {
+        name = path.stem().string();
+        m_sourceStemIndex[name].push_back(scan.key);
+    }
+
+    linkLocked(scan.key);
+    // 新文件可能成为其他文件中未解析 include 的目标
+    relinkReferrersLocked(name);
+}
+
+void ProjectDependencyGraph::removeLocked(const std::string& key) {
+    auto it = m_nodes.find(key);
+    if (it == m_nodes.end()) {
+        return;
+    }
+
+    unlinkLocked(key);
+
+    fs::path path(key);
+    std::string name = it->second.isHeader ? path.filename().string() : path.stem().string();
+    auto& index = it->second.isHeader ? m_headerNameIndex : m_sourceStemIndex;
+    auto indexIt = index.find(name);
+    if (indexIt != index.end()) {
+        auto& paths = indexIt->second;
+        paths.erase(std::remove(paths.begin(), paths.end(), key), paths.end());
+        if (paths.empty()) {
+            index.erase(indexIt);
+        }
+    }
+
+    m_nodes.erase(it);
+    // 原先指向该文件的 include 需要重新解析（可能解析到同名的其他文件）
+    relinkReferrersLocked(name);
+}
+
+void ProjectDependencyGraph::linkLocked(const std::string& key) {
+    auto it = m_nodes.find(key);
+    if (it == m_nodes.end()) {
+        return;
+    }
+    Node& node = it->second;
+
+    for (const auto& raw : node.rawIncludes) {
+        m_referrers[referenceName(raw, node.isPython)].insert(key);
+
+        std::string target = resolveLocked(key, raw, node.isPython);
+        if (target.empty() || target == key) {
+            continue;
+        }
+        if (std::find(node.includes.begin(), node.includes.end(), target) != node.includes.end()) {
+            continue;
+        }
+        node.includes.push_back(target);
+        m_nodes[target].includedBy.insert(key);
+    }
+}
+
+void ProjectDependencyGraph::unlinkLocked(const std::string& key) {
+    auto it = m_nodes.find(key);
+    if (it == m_nodes.end()) {
+        return;
+    }
+    Node& node = it->second;
+
+    for (const auto& target : node.includes) {
+        auto targetIt = m_nodes.find(target);
+        if (targetIt != m_nodes.end()) {
+            targetIt->second.includedBy.erase(key);
+        }
+    }
+    node.includes.clear();
+
+    for (const auto& raw : node.rawIncludes) {
+        auto refIt = m_referrers.find(referenceName(raw, node.isPython));
+        if (refIt != m_referrers.end()) {
+            refIt->second.erase(key);
+            if (refIt->second.empty()) {
+                m_referrers.erase(refIt);
+            }
+        }
+    }
+}
+
+void ProjectDependencyGraph::relinkReferrersLocked(const std::string& name) {
+    auto refIt = m_referrers.find(name);
+    if (refIt == m_referrers.end()) {
+        return;
+    }
+
+    // 复制一份，relink 过程中会修改 m_referrers
+    std::vector<std::string> referrers(refIt->second.begin(), refIt->second.end());
+    for (const auto& referrer : referrers) {
+        unlinkLocked(referrer);
+        linkLocked(referrer);
+    }
+}
+
+std::string ProjectDependencyGraph::resolveLocked(
+    const std::string& fromKey,
+    const std::string& rawInclude,
+    bool isPython
+) const {
+    if (isPython) {
+        auto it = m_sourceStemIndex.find(rawInclude);
+        if (it == m_sourceStemIndex.end() || it->second.empty()) {
+            return "";
+        }
+        return it->second.front();
+    }
+
+    auto it = m_headerNameIndex.find(referenceName(rawInclude, false));
+    if (it == m_headerNameIndex.end() || it->second.empty()) {
+        return "";
+    }
+    const auto& candidates = it->second;
+    if (candidates.size() == 1) {
+        return candidates.front();
+    }
+
+    // 同名头文件有多个时：优先相对于包含文件所在目录，其次按路径后缀匹配
+    std::string relative = normalizeKey((fs::path(fromKey).parent_path() / rawInclude).string());
+    if (std::find(candidates.begin(), candidates.end(), relative) != candidates.end()) {
+        return relative;
+    }
+
+    std::string suffix = fs::path(rawInclude).lexically_normal().generic_string();
+    for (const auto& candidate : candidates) {
+        std::string generic = fs::path(candidate).generic_string();
+        if (generic.size() > suffix.size() &&
+            generic.compare(generic.size() - suffix.size(), suffix.size(), suffix) == 0 &&
+            generic[generic.size() - suffix.size() - 1] == '/') {
+            return candidate;
+        }
+    }
+
+    return candidates.front();
+}
+
+} // namespace naw::desktop_pet::service
@@ -0,0 +1,296 @@
+#include "naw/desktop_pet/service/ReplayScreenCapture.h"
+#include "naw/desktop_pet/service/ImageProcessor.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace naw::desktop_pet::service {
+
+namespace {
+
+types::ImageData copyToImageData(const types::ImageView& view) {
+    types::ImageData image;
+    image.allocate(view.width, view.height, view.format);
+    const size_t rowBytes = view.rowBytes();
+    for (uint32_t y = 0; y < view.height; ++y) {
+        std::memcpy(image.data.data() + y * rowBytes, view.row(y), rowBytes);
+    }
+    return image;
+}
+
+// 与平台实现一致：截图选项只做分辨率控制
+std::optional<types::ImageData> applyResolution(types::ImageData image, const CaptureOptions& options) {
+    ImageProcessor::ResolutionConfig config;
+    config.maxWidth = options.maxWidth;
+    config.maxHeight = options.maxHeight;
+    config.targetWidth = options.targetWidth;
+    config.targetHeight = options.targetHeight;
+    config.keepAspectRatio = options.keepAspectRatio;
+    config.adaptive = options.adaptiveResolution;
+    if (options.adaptiveResolution) {
+        auto [width, height] = ImageProcessor::calculateAdaptiveResolution(
+            image.width, image.height, options.layerType);
+        config.targetWidth = width;
+        config.targetHeight = height;
+    }
+    if (!config.maxWidth && !config.maxHeight && !config.targetWidth && !config.targetHeight) {
+        return image;
+    }
+    auto processed = ImageProcessor::applyResolutionControl(image, config);
+    return processed ? processed : std::optional<types::ImageData>(std::move(image));
+}
+
+} // namespace
+
+ReplayScreenCapture::ReplayScreenCapture(std::vector<types::ImageData> frames, bool loop)
+    : m_frames(std::move(frames))
+    , m_loop(loop)
+{
+}
+
+ReplayScreenCapture::ReplayScreenCapture(uint32_t width,
+                                         uint32_t height,
+                                         FrameGenerator generator,
+                                         types::ImageFormat format)
+    : m_generator(std::move(generator))
+{
+    for (auto& buffer : m_buffers) {
+        buffer.allocate(width, height, format);
+    }
+}
+
+std::unique_ptr<ReplayScreenCapture> ReplayScreenCapture::fromFiles(const std::vector<std::string>& paths,
+                                                                    bool loop) {
+    std::vector<types::ImageData> frames;
+    frames.reserve(paths.size());
+    for (const auto& path : paths) {
+        auto image = ImageProcessor::loadFromFile(path, types::ImageFormat::BGRA);
+        if (!image) {
+            return nullptr;
+        }
+        frames.push_back(std::move(*image));
+    }
+    return std::make_unique<ReplayScreenCapture>(std::move(frames), loop);
+}
+
+// ========== 截图接口 ==========
+
+std::optional<types::ImageData> ReplayScreenCapture::captureFullScreen(
+    int32_t displayId,
+    const CaptureOptions& options
+) {
+    std::optional<types::ImageData> image;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!isValidDisplay(displayId) || !advanceLocked()) {
+            return std::nullopt;
+        }
+        image = copyToImageData(types::ImageView::fromImageData(*m_current));
+    }
+    return applyResolution(std::move(*image), options);
+}
+
+std::optional<types::ImageView> ReplayScreenCapture::captureFullScreenView(int32_t displayId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!isValidDisplay(displayId) || !advanceLocked()) {
+        return std::nullopt;
+    }
+    return types::ImageView::fromImageData(*m_current);
+}
+
+std::optional<types::ImageData> ReplayScreenCapture::captureWindow(
+    types::WindowHandle handle,
+    const CaptureOptions& options
+) {
+    (void)handle;
+    (void)options;
+    setLastError("Window capture is not supported by the replay source");
+    return std::nullopt;
+}
+
+std::optional<types::ImageData> ReplayScreenCapture::captureRegion(
+    const types::Rect& region,
+    int32_t displayId,
+    const CaptureOptions& options
+) {
+    if (!region.isValid() || region.x < 0 || region.y < 0) {
+        setLastError("Invalid region");
+        return std::nullopt;
+    }
+
+    std::optional<types::ImageData> image;
+    {
+        // 区域截图取当前帧（不前进）；还没有帧时先取第一帧
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!isValidDisplay(displayId) || (!m_current && !advanceLocked())) {
+            return std::nullopt;
+        }
+        auto view = types::ImageView::fromImageData(*m_current).subView(
+            static_cast<uint32_t>(region.x), static_cast<uint32_t>(region.y), region.width, region.height);
+        if (!view.isValid()) {
+            setLastError("Region is outside of the frame");
+            return std::nullopt;
+        }
+        image = copyToImageData(view);
+    }
+    return applyResolution(std::move(*image), options);
+}
+
+std::optional<std::vector<types::Rect>> ReplayScreenCapture::getLastDamage() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastDamage;
+}
+
+std::vector<types::DisplayInfo> ReplayScreenCapture::getDisplays() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    types::DisplayInfo info;
+    info.name = m_generator ? "synthetic" : "replay";
+    info.isPrimary = true;
+    if (m_current) {
+        info.bounds.width = m_current->width;
+        info.bounds.height = m_current->height;
+    } else if (m_generator) {
+        info.bounds.width = m_buffers[0].width;
+        info.bounds.height = m_buffers[0].height;
+    } else if (!m_frames.empty()) {
+        info.bounds.width = m_frames.front().width;
+        info.bounds.height = m_frames.front().height;
+    }
+    return {info};
+}
+
+std::string ReplayScreenCapture::getLastError() const {
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    return m_lastError;
+}
+
+uint64_t ReplayScreenCapture::getFrameCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frameCount;
+}
+
+void ReplayScreenCapture::rewind() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_nextIndex = 0;
+    m_frameCount = 0;
+    m_current = nullptr;
+    m_previous = nullptr;
+    m_lastDamage.reset();
+}
+
+// ========== 变化区域 ==========
+
+std::vector<types::Rect> ReplayScreenCapture::computeDamage(const types::ImageView& previous,
+                                                            const types::ImageView& current,
+                                                            uint32_t tileSize) {
+    std::vector<types::Rect> damage;
+    if (!current.isValid()) {
+        return damage;
+    }
+    if (!previous.isValid() || previous.width != current.width || previous.height != current.height ||
+        previous.format != current.format) {
+        damage.push_back(types::Rect{0, 0, current.width, current.height});
+        return damage;
+    }
+
+    tileSize = std::max<uint32_t>(tileSize, 1);
+    const uint32_t bpp = current.bytesPerPixel();
+    const uint32_t tilesX = (current.width + tileSize - 1) / tileSize;
+    std::vector<uint8_t> dirty(tilesX);
+
+    for (uint32_t bandY = 0; bandY < current.height; bandY += tileSize) {
+        const uint32_t bandHeight = std::min(tileSize, current.height - bandY);
+        std::fill(dirty.begin(), dirty.end(), 0);
+        uint32_t dirtyCount = 0;
+        for (uint32_t y = bandY; y < bandY + bandHeight && dirtyCount < tilesX; ++y) {
+            const uint8_t* a = previous.row(y);
+            const uint8_t* b = current.row(y);
+            // 整行相同时跳过逐块比较（静止画面的常见情况）
+            if (std::memcmp(a, b, current.rowBytes()) == 0) {
+                continue;
+            }
+            for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                if (dirty[tx]) {
+                    continue;
+                }
+                const size_t offset = static_cast<size_t>(tx) * tileSize * bpp;
+                const size_t bytes = static_cast<size_t>(std::min(tileSize, current.width - tx * tileSize)) * bpp;
+                if (std::memcmp(a + offset, b + offset, bytes) != 0) {
+                    dirty[tx] = 1;
+                    ++dirtyCount;
+                }
+            }
+        }
+
+        // 同一行相邻的变化块合并为一个矩形
+        for (uint32_t tx = 0; tx < tilesX;) {
+            if (!dirty[tx]) {
+                ++tx;
+                continue;
+            }
+            const uint32_t begin = tx;
+            while (tx < tilesX && dirty[tx]) {
+                ++tx;
+            }
+            const uint32_t x0 = begin * tileSize;
+            const uint32_t x1 = std::min(tx * tileSize, current.width);
+            damage.push_back(types::Rect{static_cast<int32_t>(x0), static_cast<int32_t>(bandY),
+                                         x1 - x0, bandHeight});
+        }
+    }
+    return damage;
+}
+
+// ========== 内部实现 ==========
+
+bool ReplayScreenCapture::advanceLocked() {
+    const types::ImageData* next = nullptr;
+    if (m_generator) {
+        // 写入较旧的缓冲，另一个缓冲保留上一帧用于比较
+        const size_t target = m_current ? 1 - m_currentBuffer : m_currentBuffer;
+        m_generator(m_frameCount, m_buffers[target]);
+        m_currentBuffer = target;
+        next = &m_buffers[target];
+    } else {
+        if (m_nextIndex >= m_frames.size()) {
+            if (!m_loop || m_frames.empty()) {
+                setLastError(m_frames.empty() ? "No frames to replay" : "Replay finished");
+                return false;
+            }
+            m_nextIndex = 0;
+        }
+        next = &m_frames[m_nextIndex++];
+    }
+
+    if (!next->isValid()) {
+        setLastError("Invalid replay frame");
+        return false;
+    }
+
+    m_previous = m_current;
+    m_current = next;
+    ++m_frameCount;
+    if (m_previous == m_current) {
+        m_lastDamage = std::vector<types::Rect>{};
+    } else {
+        m_lastDamage = computeDamage(m_previous ? types::ImageView::fromImageData(*m_previous) : types::ImageView(),
+                                     types::ImageView::fromImageData(*m_current));
+    }
+    return true;
+}
+
+bool ReplayScreenCapture::isValidDisplay(int32_t displayId) {
+    // 回放源只有一个显示器
+    if (displayId != 0 && displayId != -1) {
+        setLastError("Invalid display id: " + std::to_string(displayId));
+        return false;
+    }
+    return true;
+}
+
+void ReplayScreenCapture::setLastError(const std::string& error) {
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    m_lastError = error;
+}
+
+} // namespace naw::desktop_pet::service
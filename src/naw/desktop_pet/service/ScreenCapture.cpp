@@ -1,21 +1,13 @@
 #include "naw/desktop_pet/service/ScreenCapture.h"
 
+#include <cstdlib>
+
 #ifdef _WIN32
 #include "naw/desktop_pet/service/platform/ScreenCaptureWindows.h"
 using PlatformImpl = naw::desktop_pet::service::platform::ScreenCaptureWindows;
-#else
-// 其他平台暂未实现
-class PlatformImplStub : public naw::desktop_pet::service::ScreenCapture {
-public:
-    std::optional<types::ImageData> captureFullScreen(int32_t, const CaptureOptions&) override { return std::nullopt; }
-    std::optional<types::ImageData> captureWindow(types::WindowHandle, const CaptureOptions&) override { return std::nullopt; }
-    std::optional<types::ImageData> captureRegion(const types::Rect&, int32_t, const CaptureOptions&) override { return std::nullopt; }
-    std::vector<types::DisplayInfo> getDisplays() override { return {}; }
-    bool supportsWindowCapture() const override { return false; }
-    bool supportsRegionCapture() const override { return false; }
-    std::string getLastError() const override { return "Platform not supported"; }
-};
-using PlatformImpl = PlatformImplStub;
+#elif defined(__linux__) && defined(NAW_HAS_X11_CAPTURE)
+#include "naw/desktop_pet/service/platform/ScreenCaptureLinux.h"
+using PlatformImpl = naw::desktop_pet::service::platform::ScreenCaptureLinux;
 #endif
 
 namespace naw::desktop_pet::service {
@@ -28,6 +20,13 @@ std::unique_ptr<ScreenCapture> ScreenCapture::create() {
         // 创建失败，返回nullptr
         return nullptr;
     }
+#elif defined(__linux__) && defined(NAW_HAS_X11_CAPTURE)
+    // 连接不到X服务器（无DISPLAY、纯Wayland会话）时返回nullptr
+    auto capture = std::make_unique<PlatformImpl>();
+    if (!capture->isConnected()) {
+        return nullptr;
+    }
+    return capture;
 #else
     // 其他平台暂未实现
     return nullptr;
@@ -39,6 +38,10 @@ bool ScreenCapture::isSupported() {
     // Windows 8+ 支持DXGI Desktop Duplication
     // 简化检查：只要编译通过就认为支持
     return true;
+#elif defined(__linux__) && defined(NAW_HAS_X11_CAPTURE)
+    // 需要X服务器（含XWayland、Xvfb）
+    const char* display = std::getenv("DISPLAY");
+    return display != nullptr && display[0] != '\0';
 #else
     // 其他平台暂未实现
     return false;
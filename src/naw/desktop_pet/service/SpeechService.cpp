@@ -1,6 +1,7 @@
 #include "naw/desktop_pet/service/SpeechService.h"
 
 #include "naw/desktop_pet/service/utils/HttpTypes.h"
+#include "naw/desktop_pet/service/utils/SpscQueue.h"
 
 #include <algorithm>
 #include <cctype>
@@ -553,65 +554,55 @@ std::optional<SpeechService::STTResult> SpeechService::executeSTT(
         return std::nullopt;
     }
     
-    // 如果文件不是WAV格式，先转换为WAV
-    std::string wavPath = audioPath;
-    std::string tempWavPath;
+    utils::HttpClient::MultipartFile filePart;
+    filePart.filename = std::filesystem::path(audioPath).filename().string();
+    filePart.contentType = "audio/wav";
     
-    // 检查文件扩展名，如果不是.wav，需要转换
+    // 检查文件扩展名，如果不是.wav，解码为S16 PCM后在内存中加WAV头上传（不写临时文件）
     std::string ext = std::filesystem::path(audioPath).extension().string();
     std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
     
     if (ext != ".wav") {
-        // 解码为PCM，然后转换为WAV
-        auto pcmBuffer = audioProcessor_.decodeFileToPCM(audioPath);
-        if (!pcmBuffer.has_value()) {
+        utils::AudioStreamConfig target{};
+        target.format = utils::AudioFormat::S16;
+        auto pcmBuffer = audioProcessor_.decodeFileToPCM(audioPath, target);
+        if (!pcmBuffer.has_value() || pcmBuffer->data.empty()) {
             return std::nullopt;
         }
-        
-        // 创建临时WAV文件
-        tempWavPath = (std::filesystem::temp_directory_path() / ("stt_convert_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".wav")).string();
-        
-        if (!audioProcessor_.writePcmToWav(tempWavPath, pcmBuffer->stream, pcmBuffer->data)) {
+        filePart.filename = std::filesystem::path(audioPath).stem().string() + ".wav";
+        filePart.data = utils::AudioProcessor::wavHeader(pcmBuffer->stream, pcmBuffer->data.size());
+        if (filePart.data.empty()) {
             return std::nullopt;
         }
-        
-        wavPath = tempWavPath;
+        filePart.chunks.emplace_back(reinterpret_cast<const char*>(pcmBuffer->data.data()), pcmBuffer->data.size());
+        return executeSTTUpload(std::move(filePart), config);
     }
     
     // 读取WAV文件
-    std::ifstream file(wavPath, std::ios::binary);
+    std::ifstream file(audioPath, std::ios::binary);
     if (!file) {
-        if (!tempWavPath.empty()) {
-            try {
-                std::filesystem::remove(tempWavPath);
-            } catch (...) {}
-        }
         return std::nullopt;
     }
     
     file.seekg(0, std::ios::end);
     const std::streamoff size = file.tellg();
     if (size < 0) {
-        if (!tempWavPath.empty()) {
-            try {
-                std::filesystem::remove(tempWavPath);
-            } catch (...) {}
-        }
         return std::nullopt;
     }
     
-    std::string audioData;
-    audioData.resize(static_cast<std::size_t>(size));
+    filePart.data.resize(static_cast<std::size_t>(size));
     file.seekg(0, std::ios::beg);
-    if (!file.read(audioData.data(), static_cast<std::streamsize>(audioData.size()))) {
-        if (!tempWavPath.empty()) {
-            try {
-                std::filesystem::remove(tempWavPath);
-            } catch (...) {}
-        }
+    if (!file.read(filePart.data.data(), static_cast<std::streamsize>(filePart.data.size()))) {
         return std::nullopt;
     }
     
+    return executeSTTUpload(std::move(filePart), config);
+}
+
+std::optional<SpeechService::STTResult> SpeechService::executeSTTUpload(
+    utils::HttpClient::MultipartFile filePart,
+    const STTConfig& config) {
+    
     // 使用multipart/form-data上传
     utils::HttpClient client(config.baseUrl);
     // 设置超时时间，确保不会无限等待
@@ -636,25 +627,11 @@ std::optional<SpeechService::STTResult> SpeechService::executeSTT(
         fields["language"] = *config.language;
     }
     
-    utils::HttpClient::MultipartFile filePart;
-    filePart.filename = std::filesystem::path(audioPath).filename().string();
-    filePart.contentType = "audio/wav";
-    filePart.data = std::move(audioData);
-    
     std::map<std::string, utils::HttpClient::MultipartFile> files;
     files["file"] = std::move(filePart);
     
     auto resp = client.postMultipart("/audio/transcriptions", fields, files, headers);
     
-    // 清理临时文件
-    if (!tempWavPath.empty()) {
-        try {
-            std::filesystem::remove(tempWavPath);
-        } catch (...) {
-            // 忽略删除失败
-        }
-    }
-    
     if (!resp.isSuccess()) {
         // 错误处理：根据HTTP状态码判断错误类型
         // 可以在这里添加重试逻辑或错误日志
@@ -693,24 +670,28 @@ std::optional<SpeechService::STTResult> SpeechService::executeSTTFromPCM(
     // 可选：裁剪静音（如果配置了）
     // utils::AudioProcessor::trimSilenceInPlace(streamConfig, processedPcm, -40.0f, 50);
     
-    // 将PCM数据转换为WAV格式
-    std::string tempWavPath = (std::filesystem::temp_directory_path() / "stt_temp.wav").string();
-    
-    if (!audioProcessor_.writePcmToWav(tempWavPath, streamConfig, processedPcm)) {
-        return std::nullopt;
+    // F32 转为 S16 上传，体积减半（识别精度不受影响）
+    utils::AudioStreamConfig uploadStream = streamConfig;
+    if (streamConfig.format == utils::AudioFormat::F32) {
+        const std::size_t samples = processedPcm.size() / sizeof(float);
+        std::vector<std::uint8_t> s16(samples * sizeof(std::int16_t));
+        utils::AudioKernels::kernels(utils::AudioFormat::S16)
+            .fromFloat(reinterpret_cast<const float*>(processedPcm.data()), samples, s16.data());
+        processedPcm = std::move(s16);
+        uploadStream.format = utils::AudioFormat::S16;
     }
     
-    // 使用WAV文件进行STT
-    auto result = executeSTT(tempWavPath, config);
-    
-    // 清理临时文件
-    try {
-        std::filesystem::remove(tempWavPath);
-    } catch (...) {
-        // 忽略删除失败
+    // WAV 头在内存中生成，PCM 作为非拥有数据段直接接入 multipart 正文（不写临时文件）
+    utils::HttpClient::MultipartFile filePart;
+    filePart.filename = "audio.wav";
+    filePart.contentType = "audio/wav";
+    filePart.data = utils::AudioProcessor::wavHeader(uploadStream, processedPcm.size());
+    if (filePart.data.empty()) {
+        return std::nullopt;
     }
+    filePart.chunks.emplace_back(reinterpret_cast<const char*>(processedPcm.data()), processedPcm.size());
     
-    return result;
+    return executeSTTUpload(std::move(filePart), config);
 }
 
 std::optional<SpeechService::TTSResult> SpeechService::executeTTS(
@@ -838,11 +819,19 @@ void SpeechService::sttStreamWorker() {
     const std::size_t bytesPerFrame = 2; // S16 = 2 bytes per sample
     const std::size_t chunkBytes = chunkFrames * bytesPerFrame;
     
+    utils::AudioStreamConfig streamConfig;
+    streamConfig.format = utils::AudioFormat::S16;
+    streamConfig.sampleRate = 16000;
+    streamConfig.channels = 1;
+
+    // onData 运行在录音消费线程，只负责攒满 1 秒后交给本线程；HTTP 上传在本线程进行，
+    // 避免慢请求阻塞录音路径导致丢帧。currentChunk 只由 onData 访问，停止录音后才由本线程接管。
     std::vector<std::uint8_t> currentChunk;
     currentChunk.reserve(chunkBytes);
-    
-    captureOptions.onData = [this, &currentChunk, chunkBytes, bytesPerFrame, chunkFrames](
-        const void* pcm, std::size_t bytes, std::uint32_t frames) {
+    utils::SpscQueue<std::vector<std::uint8_t>> readyChunks(8);
+
+    captureOptions.onData = [this, &currentChunk, &readyChunks, chunkBytes](
+        const void* pcm, std::size_t bytes, std::uint32_t /*frames*/) {
         
         if (sttStreamStop_.load()) {
             return;
@@ -851,18 +840,13 @@ void SpeechService::sttStreamWorker() {
         const std::uint8_t* data = static_cast<const std::uint8_t*>(pcm);
         currentChunk.insert(currentChunk.end(), data, data + bytes);
         
-        // 当累积到1秒的数据时，处理一次
+        // 当累积到1秒的数据时，交给 STT 线程处理
         if (currentChunk.size() >= chunkBytes) {
             std::vector<std::uint8_t> chunkToProcess;
             chunkToProcess.swap(currentChunk);
-            currentChunk.clear();
-            
-            utils::AudioStreamConfig streamConfig;
-            streamConfig.format = utils::AudioFormat::S16;
-            streamConfig.sampleRate = 16000;
-            streamConfig.channels = 1;
-            
-            processSTTChunk(chunkToProcess, streamConfig);
+            currentChunk.reserve(chunkBytes);
+            // 上传积压过多（队列满）时丢弃本段，保持实时性
+            (void)readyChunks.tryPush(std::move(chunkToProcess));
         }
     };
     
@@ -878,43 +862,28 @@ void SpeechService::sttStreamWorker() {
         return;
     }
     
-    // 等待停止信号
+    // 处理已攒满的音频段，直到停止信号
+    std::vector<std::uint8_t> chunkToProcess;
     while (!sttStreamStop_.load() && sttStreaming_.load()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        // 检查是否有未处理的音频数据（超时处理）
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - sttLastChunkTime_).count();
-        
-        // 如果超过1.5秒没有处理数据，且当前有累积的数据，处理它
-        // 注意：这个时间应该小于API调用的超时时间（1秒），确保不会堆积太多数据
-        if (elapsed > 1500 && !currentChunk.empty()) {
-            // 超过1.5秒没有新数据，处理当前累积的数据
-            std::vector<std::uint8_t> chunkToProcess;
-            chunkToProcess.swap(currentChunk);
-            currentChunk.clear();
-            
-            utils::AudioStreamConfig streamConfig;
-            streamConfig.format = utils::AudioFormat::S16;
-            streamConfig.sampleRate = 16000;
-            streamConfig.channels = 1;
-            
+        if (readyChunks.tryPop(chunkToProcess)) {
             processSTTChunk(chunkToProcess, streamConfig);
-            // processSTTChunk 内部会更新 sttLastChunkTime_，这里不需要再次更新
+            continue;
         }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
     
+    // 先停止录音：非消费线程上的 stopCapture 会串行等待（包括 stopSpeechToTextStream 并发发起的停止）
+    // 直到消费线程被 join 后才返回，之后 currentChunk 不再被 onData 访问
+    audioProcessor_.stopCapture();
+
     // 处理剩余的音频数据
+    while (readyChunks.tryPop(chunkToProcess)) {
+        processSTTChunk(chunkToProcess, streamConfig);
+    }
     if (!currentChunk.empty()) {
-        utils::AudioStreamConfig streamConfig;
-        streamConfig.format = utils::AudioFormat::S16;
-        streamConfig.sampleRate = 16000;
-        streamConfig.channels = 1;
-        
         processSTTChunk(currentChunk, streamConfig);
     }
     
-    audioProcessor_.stopCapture();
     sttStreaming_.store(false);
 }
 
@@ -4,6 +4,33 @@
 
 namespace naw::desktop_pet::service {
 
+namespace {
+
+// 结果中不短于该长度的字符串移入 BlobStore（读取到的文件内容与文件缓存共享同一份缓冲）
+constexpr size_t kInternStringMinBytes = 1024;
+
+using LargeStrings = std::vector<std::pair<nlohmann::json::json_pointer, BlobStore::Blob>>;
+
+void liftLargeStrings(nlohmann::json& node, const nlohmann::json::json_pointer& path, LargeStrings& out) {
+    if (node.is_string()) {
+        auto& text = node.get_ref<std::string&>();
+        if (text.size() >= kInternStringMinBytes) {
+            out.emplace_back(path, BlobStore::shared().intern(std::move(text), "tool_result_cache"));
+            node = std::string();
+        }
+    } else if (node.is_object()) {
+        for (auto it = node.begin(); it != node.end(); ++it) {
+            liftLargeStrings(it.value(), path / it.key(), out);
+        }
+    } else if (node.is_array()) {
+        for (size_t i = 0; i < node.size(); ++i) {
+            liftLargeStrings(node[i], path / i, out);
+        }
+    }
+}
+
+} // namespace
+
 // ========== ToolCallHistory ==========
 
 nlohmann::json ToolCallHistory::toJson() const {
@@ -149,11 +176,36 @@ std::optional<nlohmann::json> ToolCallContext::getCachedResult(
     const std::string& toolName,
     const nlohmann::json& arguments
 ) const {
-    if (!m_cacheEnabled) {
+    auto entry = findCacheEntry(toolName, arguments);
+    if (!entry) {
         return std::nullopt;
     }
+    return materializeCacheEntry(*entry);
+}
+
+std::shared_ptr<const nlohmann::json> ToolCallContext::findCachedResult(
+    const std::string& toolName,
+    const nlohmann::json& arguments
+) const {
+    auto entry = findCacheEntry(toolName, arguments);
+    if (!entry) {
+        return nullptr;
+    }
+    if (entry->largeStrings.empty()) {
+        return entry->skeleton;
+    }
+    // 含大字符串时需要重建；只需要值的调用方应使用 getCachedResult，避免再复制一次
+    return std::make_shared<const nlohmann::json>(materializeCacheEntry(*entry));
+}
 
+std::optional<ToolCallContext::CacheEntry> ToolCallContext::findCacheEntry(
+    const std::string& toolName,
+    const nlohmann::json& arguments
+) const {
     std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_cacheEnabled) {
+        return std::nullopt;
+    }
 
     // 清理过期缓存（在const方法中，因为m_cache是mutable的）
     cleanupExpiredCacheUnlocked();
@@ -163,7 +215,8 @@ std::optional<nlohmann::json> ToolCallContext::getCachedResult(
     if (it != m_cache.end()) {
         // 检查是否过期
         if (!isCacheEntryExpired(it->second)) {
-            return std::make_optional(it->second.result);
+            // 只复制共享指针与 Blob 句柄，不复制内容
+            return it->second;
         } else {
             // 移除过期项
             m_cache.erase(it);
@@ -173,6 +226,15 @@ std::optional<nlohmann::json> ToolCallContext::getCachedResult(
     return std::nullopt;
 }
 
+nlohmann::json ToolCallContext::materializeCacheEntry(const CacheEntry& entry) {
+    // 骨架只复制一次，大字符串直接填入返回值
+    nlohmann::json full = *entry.skeleton;
+    for (const auto& [pointer, blob] : entry.largeStrings) {
+        full[pointer] = *blob;
+    }
+    return full;
+}
+
 void ToolCallContext::cacheResult(
     const std::string& toolName,
     const nlohmann::json& arguments,
@@ -193,9 +255,11 @@ void ToolCallContext::cacheResultUnlocked(
 ) {
     std::string cacheKey = generateCacheKey(toolName, arguments);
     CacheEntry entry;
-    entry.result = result;
+    nlohmann::json skeleton = result;
+    liftLargeStrings(skeleton, nlohmann::json::json_pointer(), entry.largeStrings);
+    entry.skeleton = std::make_shared<const nlohmann::json>(std::move(skeleton));
     entry.timestamp = std::chrono::system_clock::now();
-    m_cache[cacheKey] = entry;
+    m_cache[cacheKey] = std::move(entry);
 }
 
 void ToolCallContext::clearCache() {
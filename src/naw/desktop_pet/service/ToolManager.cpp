@@ -360,6 +360,20 @@ std::optional<nlohmann::json> ToolManager::executeTool(const std::string& toolNa
     try {
         nlohmann::json result = tool.handler(arguments);
         executionSuccess = true;
+
+        // 输出预算：超出时截断并将完整结果保存到句柄（分页工具自身不再治理）
+        if (toolName != ToolOutputGovernor::kPagingToolName) {
+            bool spilled = false;
+            result = m_outputGovernor.govern(toolName, std::move(result), &spilled);
+            if (spilled) {
+                ensurePagingToolRegistered();
+                if (m_errorHandler) {
+                    m_errorHandler->log(ErrorHandler::LogLevel::Info,
+                                       "Tool output exceeded budget, spilled to handle: " +
+                                           result[ToolOutputGovernor::kMetaKey]["handle"].get<std::string>());
+                }
+            }
+        }
         
         // 更新统计（成功）
         auto endTime = std::chrono::high_resolution_clock::now();
@@ -813,6 +827,66 @@ void ToolManager::setErrorHandler(ErrorHandler* errorHandler) {
     m_errorHandler = errorHandler;
 }
 
+// ========== 输出预算 ==========
+
+void ToolManager::setOutputBudget(const ToolOutputBudget& budget) {
+    m_outputGovernor.setBudget(budget);
+}
+
+ToolOutputBudget ToolManager::getOutputBudget() const {
+    return m_outputGovernor.getBudget();
+}
+
+void ToolManager::ensurePagingToolRegistered() {
+    if (hasTool(ToolOutputGovernor::kPagingToolName)) {
+        return;
+    }
+
+    ToolDefinition tool;
+    tool.name = ToolOutputGovernor::kPagingToolName;
+    tool.description = "分页读取被截断的工具结果。传入截断结果中 tool_output.handle，"
+                       "可用 pointer 指定字段（如 /matches），offset 为起始元素下标或行号。";
+    tool.parametersSchema = {
+        {"type", "object"},
+        {"properties", {
+            {"handle", {
+                {"type", "string"},
+                {"description", "结果句柄（tool_output.handle）"}
+            }},
+            {"pointer", {
+                {"type", "string"},
+                {"description", "JSON Pointer，指定要分页的字段，默认整个结果"}
+            }},
+            {"offset", {
+                {"type", "integer"},
+                {"minimum", 0},
+                {"description", "起始位置：数组为元素下标，文本为行号（从0开始）"}
+            }},
+            {"page_tokens", {
+                {"type", "integer"},
+                {"minimum", 100},
+                {"description", "本页Token上限，默认1000"}
+            }}
+        }},
+        {"required", {"handle"}}
+    };
+    tool.handler = [this](const nlohmann::json& args) -> nlohmann::json {
+        const std::string handle = args.value("handle", "");
+        const std::string pointer = args.value("pointer", "");
+        const size_t offset = args.value("offset", static_cast<size_t>(0));
+        const size_t pageTokens = args.value("page_tokens", static_cast<size_t>(1000));
+
+        std::string errorMsg;
+        auto page = m_outputGovernor.readPage(handle, pointer, offset, pageTokens, &errorMsg);
+        if (!page.has_value()) {
+            return nlohmann::json{{"error", errorMsg}};
+        }
+        return *page;
+    };
+
+    registerTool(tool, false);
+}
+
 // ========== 工具与LLM集成 ==========
 
 bool ToolManager::populateToolsToRequest(
@@ -0,0 +1,490 @@
+#include "naw/desktop_pet/service/ToolOutputGovernor.h"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <vector>
+
+namespace naw::desktop_pet::service {
+
+namespace {
+
+using JsonPointer = nlohmann::json::json_pointer;
+
+constexpr size_t kMinShrinkChars = 200;  // 短于该长度的文本不再截断
+constexpr int kMaxShrinkRounds = 24;     // 截断迭代轮数上限
+constexpr int kMaxCandidateDepth = 2;    // 只在前两层对象中寻找可截断字段
+constexpr size_t kMetaReserveTokens = 200;
+
+std::string dumpCompact(const nlohmann::json& value) {
+    return value.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+// 向前调整到UTF-8字符边界
+size_t utf8Floor(const std::string& s, size_t pos) {
+    if (pos >= s.size()) {
+        return s.size();
+    }
+    while (pos > 0 && (static_cast<unsigned char>(s[pos]) & 0xC0) == 0x80) {
+        --pos;
+    }
+    return pos;
+}
+
+std::vector<std::string_view> splitLines(const std::string& text) {
+    std::vector<std::string_view> lines;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            lines.emplace_back(text.data() + start, text.size() - start);
+            break;
+        }
+        lines.emplace_back(text.data() + start, end - start);
+        start = end + 1;
+    }
+    return lines;
+}
+
+/**
+ * @brief 截断记录（相对于完整结果的位置）
+ */
+struct Omission {
+    std::string unit;  // lines / chars / items
+    size_t total{0};
+    size_t kept{0};
+};
+
+/**
+ * @brief 长文本保留首尾：优先按行截断，单行过长时按字符截断
+ */
+std::string shrinkText(const std::string& text, double keepRatio, Omission& omission) {
+    const size_t keepBytes = static_cast<size_t>(static_cast<double>(text.size()) * keepRatio);
+    const size_t headBudget = keepBytes * 7 / 10;
+    const size_t tailBudget = keepBytes - headBudget;
+
+    const auto lines = splitLines(text);
+    if (lines.size() >= 4) {
+        size_t head = 0;
+        size_t headBytes = 0;
+        while (head < lines.size() && headBytes + lines[head].size() + 1 <= headBudget) {
+            headBytes += lines[head].size() + 1;
+            ++head;
+        }
+        size_t tail = 0;
+        size_t tailBytes = 0;
+        while (head + tail < lines.size() &&
+               tailBytes + lines[lines.size() - 1 - tail].size() + 1 <= tailBudget) {
+            tailBytes += lines[lines.size() - 1 - tail].size() + 1;
+            ++tail;
+        }
+        if (head + tail > 0) {
+            const size_t omitted = lines.size() - head - tail;
+            std::string out;
+            out.reserve(headBytes + tailBytes + 48);
+            for (size_t i = 0; i < head; ++i) {
+                out.append(lines[i]);
+                out.push_back('\n');
+            }
+            out += "... [省略 " + std::to_string(omitted) + " 行] ...";
+            for (size_t i = lines.size() - tail; i < lines.size(); ++i) {
+                out.push_back('\n');
+                out.append(lines[i]);
+            }
+            omission = {"lines", lines.size(), head + tail};
+            return out;
+        }
+    }
+
+    const size_t headEnd = utf8Floor(text, headBudget);
+    size_t tailStart = text.size() - std::min(tailBudget, text.size() - headEnd);
+    while (tailStart < text.size() && (static_cast<unsigned char>(text[tailStart]) & 0xC0) == 0x80) {
+        ++tailStart;
+    }
+    const size_t omitted = tailStart - headEnd;
+    omission = {"chars", text.size(), text.size() - omitted};
+    return text.substr(0, headEnd) + "... [省略 " + std::to_string(omitted) + " 字符] ..." +
+           text.substr(tailStart);
+}
+
+const char* findStringKey(const nlohmann::json& item, std::initializer_list<const char*> keys) {
+    if (!item.is_object()) {
+        return nullptr;
+    }
+    for (const char* key : keys) {
+        auto it = item.find(key);
+        if (it != item.end() && it->is_string()) {
+            return key;
+        }
+    }
+    return nullptr;
+}
+
+const char* findNumberKey(const nlohmann::json& item, std::initializer_list<const char*> keys) {
+    if (!item.is_object()) {
+        return nullptr;
+    }
+    for (const char* key : keys) {
+        auto it = item.find(key);
+        if (it != item.end() && it->is_number()) {
+            return key;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 从结果数组中挑选最相关的 keep 个条目（保持原有顺序）
+ *
+ * - 条目带 score/relevance：按分数取前 keep 个
+ * - 条目带 file/path：按文件轮询挑选，避免单个文件的大量匹配挤掉其他文件
+ * - 其他：保留头部
+ */
+nlohmann::json selectItems(const nlohmann::json& items, size_t keep) {
+    const size_t n = items.size();
+    if (keep >= n) {
+        return items;
+    }
+
+    std::vector<size_t> picked;
+    picked.reserve(keep);
+    const nlohmann::json& first = items.front();
+
+    if (const char* scoreKey = findNumberKey(first, {"score", "relevance"})) {
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        auto scoreOf = [&](size_t i) {
+            auto it = items[i].find(scoreKey);
+            return (it != items[i].end() && it->is_number()) ? it->get<double>() : 0.0;
+        };
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return scoreOf(a) > scoreOf(b); });
+        picked.assign(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(keep));
+    } else if (const char* fileKey = findStringKey(first, {"file", "path"})) {
+        std::vector<std::vector<size_t>> groups;
+        std::unordered_map<std::string, size_t> groupIndex;
+        for (size_t i = 0; i < n; ++i) {
+            std::string key;
+            auto it = items[i].is_object() ? items[i].find(fileKey) : items[i].end();
+            if (items[i].is_object() && it != items[i].end() && it->is_string()) {
+                key = it->get<std::string>();
+            }
+            auto [pos, inserted] = groupIndex.try_emplace(key, groups.size());
+            if (inserted) {
+                groups.emplace_back();
+            }
+            groups[pos->second].push_back(i);
+        }
+        for (size_t round = 0; picked.size() < keep; ++round) {
+            for (const auto& group : groups) {
+                if (round < group.size() && picked.size() < keep) {
+                    picked.push_back(group[round]);
+                }
+            }
+        }
+    } else {
+        picked.resize(keep);
+        std::iota(picked.begin(), picked.end(), 0);
+    }
+
+    std::sort(picked.begin(), picked.end());
+    nlohmann::json out = nlohmann::json::array();
+    for (size_t i : picked) {
+        out.push_back(items[i]);
+    }
+    return out;
+}
+
+struct Candidate {
+    JsonPointer pointer;
+    size_t bytes{0};
+};
+
+void collectCandidates(const nlohmann::json& node, const JsonPointer& pointer, int depth,
+                       std::vector<Candidate>& out) {
+    if (node.is_string()) {
+        // 按序列化后的长度计算（转义字符会放大体积），与整体估算保持一致
+        if (node.get_ref<const std::string&>().size() > kMinShrinkChars) {
+            out.push_back({pointer, dumpCompact(node).size()});
+        }
+    } else if (node.is_array()) {
+        if (node.size() > 1) {
+            out.push_back({pointer, dumpCompact(node).size()});
+        }
+    } else if (node.is_object() && depth < kMaxCandidateDepth) {
+        for (auto it = node.begin(); it != node.end(); ++it) {
+            collectCandidates(it.value(), pointer / it.key(), depth + 1, out);
+        }
+    }
+}
+
+} // namespace
+
+ToolOutputGovernor::ToolOutputGovernor(ToolOutputBudget budget) : m_budget(std::move(budget)) {}
+
+void ToolOutputGovernor::setBudget(const ToolOutputBudget& budget) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budget;
+    evictLocked();
+}
+
+ToolOutputBudget ToolOutputGovernor::getBudget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+}
+
+size_t ToolOutputGovernor::estimateTokens(const nlohmann::json& value) const {
+    const std::string model = getBudget().modelId;
+    return m_estimator.estimateTokens(model, dumpCompact(value));
+}
+
+nlohmann::json ToolOutputGovernor::govern(const std::string& toolName, nlohmann::json result, bool* spilled) {
+    if (spilled) {
+        *spilled = false;
+    }
+    const ToolOutputBudget budget = getBudget();
+    if (budget.maxTokens == 0) {
+        return result;
+    }
+
+    std::string fullText = dumpCompact(result);
+    const size_t totalTokens = m_estimator.estimateTokens(budget.modelId, fullText);
+    if (totalTokens <= budget.maxTokens) {
+        return result;
+    }
+
+    // 非对象结果包装后再截断，便于附加说明字段
+    const bool wrapped = !result.is_object();
+    if (wrapped) {
+        result = nlohmann::json{{"result", std::move(result)}};
+    }
+    const size_t targetTokens = budget.maxTokens > 2 * kMetaReserveTokens
+                                    ? budget.maxTokens - kMetaReserveTokens
+                                    : budget.maxTokens / 2;
+
+    nlohmann::json view = result;
+    std::map<std::string, double> ratios;       // 指针 -> 相对完整结果的保留比例
+    std::map<std::string, Omission> omissions;  // 指针 -> 截断记录
+    bool fits = false;
+
+    for (int round = 0; round < kMaxShrinkRounds; ++round) {
+        const std::string viewText = dumpCompact(view);
+        const size_t viewBytes = viewText.size();
+        const size_t viewTokens = m_estimator.estimateTokens(budget.modelId, viewText);
+        if (viewTokens <= targetTokens) {
+            fits = true;
+            break;
+        }
+
+        std::vector<Candidate> candidates;
+        collectCandidates(view, JsonPointer{}, 0, candidates);
+        if (candidates.empty()) {
+            break;
+        }
+        const auto largest = std::max_element(candidates.begin(), candidates.end(),
+                                              [](const Candidate& a, const Candidate& b) { return a.bytes < b.bytes; });
+
+        // Token估算与字节数近似线性，按比例换算需要删掉的字节数
+        const size_t targetBytes = static_cast<size_t>(static_cast<double>(viewBytes) * targetTokens / viewTokens);
+        const size_t excess = viewBytes - std::min(viewBytes, targetBytes);
+        double keepRatio = largest->bytes > excess
+                               ? static_cast<double>(largest->bytes - excess) / static_cast<double>(largest->bytes)
+                               : 0.0;
+        keepRatio = std::clamp(keepRatio * 0.95, 0.0, 0.9);
+
+        const std::string key = largest->pointer.to_string();
+        double& ratio = ratios.try_emplace(key, 1.0).first->second;
+        ratio *= keepRatio;
+
+        // 始终从完整结果重新截断，保证截断记录准确
+        const nlohmann::json& original = result.at(largest->pointer);
+        Omission omission;
+        if (original.is_string()) {
+            view[largest->pointer] = shrinkText(original.get_ref<const std::string&>(), ratio, omission);
+        } else {
+            const size_t keep = static_cast<size_t>(static_cast<double>(original.size()) * ratio);
+            nlohmann::json kept = selectItems(original, keep);
+            omission = {"items", original.size(), kept.size()};
+            view[largest->pointer] = std::move(kept);
+        }
+        omissions[key] = omission;
+    }
+
+    if (wrapped) {
+        fullText = dumpCompact(result);
+    }
+
+    if (!fits) {
+        // 结构无法继续截断（大量小字段），退化为整体文本预览；
+        // 预览取自紧凑文本，保留比例按同一文本的 Token 数计算
+        Omission omission;
+        const size_t fullTokens = wrapped ? m_estimator.estimateTokens(budget.modelId, fullText) : totalTokens;
+        const std::string preview = shrinkText(fullText,
+                                               static_cast<double>(targetTokens) / static_cast<double>(fullTokens) * 0.9,
+                                               omission);
+        view = nlohmann::json{{"preview", preview}};
+        omissions.clear();
+        omissions[""] = omission;
+    }
+
+    const std::string handle = storeResult(toolName, std::move(fullText));
+
+    nlohmann::json omitted = nlohmann::json::array();
+    for (const auto& [pointer, omission] : omissions) {
+        omitted.push_back({
+            {"pointer", pointer},
+            {"unit", omission.unit},
+            {"total", omission.total},
+            {"kept", omission.kept}
+        });
+    }
+    nlohmann::json meta = {
+        {"truncated", true},
+        {"tool", toolName},
+        {"handle", handle},
+        {"total_tokens", totalTokens},
+        {"omitted", std::move(omitted)},
+        {"hint", std::string("结果超出Token预算已截断；调用 ") + kPagingToolName +
+                     " 并传入 handle（可选 pointer、offset）分页读取完整内容"}
+    };
+    view[kMetaKey] = std::move(meta);
+    view[kMetaKey]["returned_tokens"] = estimateTokens(view);
+
+    if (spilled) {
+        *spilled = true;
+    }
+    return view;
+}
+
+std::optional<nlohmann::json> ToolOutputGovernor::readPage(const std::string& handle,
+                                                           const std::string& pointer,
+                                                           size_t offset,
+                                                           size_t pageTokens,
+                                                           std::string* error) const {
+    auto fail = [&](std::string message) -> std::optional<nlohmann::json> {
+        if (error) {
+            *error = std::move(message);
+        }
+        return std::nullopt;
+    };
+
+    BlobStore::Blob stored;
+    ToolOutputBudget budget;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_results.find(handle);
+        if (it == m_results.end()) {
+            return fail("结果句柄不存在或已过期: " + handle);
+        }
+        stored = it->second.text;
+        budget = m_budget;
+    }
+
+    const nlohmann::json value = nlohmann::json::parse(*stored, nullptr, false);
+    const nlohmann::json* node = &value;
+    if (!pointer.empty()) {
+        try {
+            node = &value.at(JsonPointer(pointer));
+        } catch (const std::exception&) {
+            return fail("无效的 pointer: " + pointer);
+        }
+    }
+
+    if (budget.maxTokens > 0) {
+        pageTokens = std::min(pageTokens, budget.maxTokens);
+    }
+    const double tokensPerChar = m_estimator.getModelRule(budget.modelId).tokensPerChar;
+    const size_t pageBytes = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(pageTokens) / tokensPerChar));
+
+    nlohmann::json page = {{"handle", handle}, {"pointer", pointer}, {"offset", offset}};
+
+    if (node->is_array()) {
+        const size_t total = node->size();
+        nlohmann::json items = nlohmann::json::array();
+        size_t bytes = 0;
+        size_t index = std::min(offset, total);
+        for (; index < total; ++index) {
+            const size_t itemBytes = dumpCompact((*node)[index]).size() + 1;
+            if (!items.empty() && bytes + itemBytes > pageBytes) {
+                break;
+            }
+            bytes += itemBytes;
+            items.push_back((*node)[index]);
+        }
+        page["items"] = std::move(items);
+        page["total_items"] = total;
+        page["next_offset"] = index;
+        page["has_more"] = index < total;
+        return page;
+    }
+
+    // 文本按行分页；其他结构先格式化为多行文本
+    const std::string text = node->is_string() ? node->get<std::string>()
+                                               : node->dump(2, ' ', false, nlohmann::json::error_handler_t::replace);
+    const auto lines = splitLines(text);
+    std::string content;
+    size_t index = std::min(offset, lines.size());
+    for (; index < lines.size(); ++index) {
+        const size_t lineBytes = lines[index].size() + 1;
+        if (!content.empty() && content.size() + lineBytes > pageBytes) {
+            break;
+        }
+        if (content.empty() && lineBytes > pageBytes) {
+            // 单行超出整页时只返回前半部分，避免一页撑爆预算
+            const std::string line(lines[index]);
+            content = line.substr(0, utf8Floor(line, pageBytes)) + "... [行过长已截断]";
+            ++index;
+            break;
+        }
+        content.append(lines[index]);
+        content.push_back('\n');
+    }
+    page["content"] = std::move(content);
+    page["total_lines"] = lines.size();
+    page["next_offset"] = index;
+    page["has_more"] = index < lines.size();
+    return page;
+}
+
+bool ToolOutputGovernor::hasResult(const std::string& handle) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_results.count(handle) > 0;
+}
+
+size_t ToolOutputGovernor::storedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_results.size();
+}
+
+void ToolOutputGovernor::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_results.clear();
+    m_order.clear();
+    m_storedBytes = 0;
+}
+
+std::string ToolOutputGovernor::storeResult(const std::string& toolName, std::string text) {
+    BlobStore::Blob blob = BlobStore::shared().intern(std::move(text), "tool_output");
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string handle = "tool_result_" + std::to_string(m_nextHandle++);
+    m_storedBytes += blob->size();
+    m_results[handle] = StoredResult{toolName, std::move(blob)};
+    m_order.push_back(handle);
+    evictLocked();
+    return handle;
+}
+
+void ToolOutputGovernor::evictLocked() {
+    // 至少保留最新的一条，保证刚返回的句柄可用
+    while (m_order.size() > 1 &&
+           (m_order.size() > m_budget.maxStoredResults || m_storedBytes > m_budget.maxStoredBytes)) {
+        auto it = m_results.find(m_order.front());
+        if (it != m_results.end()) {
+            m_storedBytes -= it->second.text->size();
+            m_results.erase(it);
+        }
+        m_order.pop_front();
+    }
+}
+
+} // namespace naw::desktop_pet::service
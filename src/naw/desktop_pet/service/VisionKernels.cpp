@@ -0,0 +1,789 @@
+#include "naw/desktop_pet/service/VisionKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NAW_VISION_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NAW_TARGET_AVX2
+#else
+#define NAW_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define NAW_VISION_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace naw::desktop_pet::service {
+
+namespace {
+
+// BT.601 定点系数（和为256），作用于 2x2 像素之和，因此最终右移10位
+constexpr uint32_t kLumaB = 29;
+constexpr uint32_t kLumaG = 150;
+constexpr uint32_t kLumaR = 77;
+
+// 像素布局（各通道在像素内的字节偏移）
+struct PixelLayout {
+    uint32_t bpp;
+    uint32_t b, g, r;
+    bool gray;
+};
+
+PixelLayout layoutOf(types::ImageFormat format) {
+    switch (format) {
+        case types::ImageFormat::BGR: return {3, 0, 1, 2, false};
+        case types::ImageFormat::RGB: return {3, 2, 1, 0, false};
+        case types::ImageFormat::BGRA: return {4, 0, 1, 2, false};
+        case types::ImageFormat::RGBA: return {4, 2, 1, 0, false};
+        case types::ImageFormat::Grayscale: return {1, 0, 0, 0, true};
+    }
+    return {3, 0, 1, 2, false};
+}
+
+// 采样表：每个输出坐标对应的两个源坐标（尺寸相同时两者相同，即恒等映射）
+void buildSampleTable(uint32_t srcSize, uint32_t dstSize, uint32_t scale,
+                      std::vector<uint32_t>& first, std::vector<uint32_t>& second) {
+    first.resize(dstSize);
+    second.resize(dstSize);
+    for (uint32_t d = 0; d < dstSize; ++d) {
+        uint32_t i0 = 0;
+        uint32_t i1 = 0;
+        if (srcSize == dstSize) {
+            i0 = i1 = d;
+        } else {
+            // 像素中心对齐：center = (d + 0.5) * src / dst - 0.5
+            const int64_t num = static_cast<int64_t>(2 * d + 1) * srcSize - dstSize;
+            const int64_t c = num < 0 ? 0 : num / (2 * static_cast<int64_t>(dstSize));
+            i0 = static_cast<uint32_t>(std::min<int64_t>(c, srcSize - 1));
+            i1 = std::min(i0 + 1, srcSize - 1);
+        }
+        first[d] = i0 * scale;
+        second[d] = i1 * scale;
+    }
+}
+
+struct SampleTables {
+    uint32_t srcWidth{0}, srcHeight{0}, dstWidth{0}, dstHeight{0}, bpp{0};
+    std::vector<uint32_t> x0, x1, y0, y1;
+};
+
+// 每个线程缓存最近一次的采样表，连续帧尺寸不变时无需重建
+SampleTables& sampleTablesFor(const types::ImageView& src, uint32_t dstWidth, uint32_t dstHeight, uint32_t bpp) {
+    thread_local SampleTables tables;
+    if (tables.srcWidth != src.width || tables.srcHeight != src.height ||
+        tables.dstWidth != dstWidth || tables.dstHeight != dstHeight || tables.bpp != bpp) {
+        buildSampleTable(src.width, dstWidth, bpp, tables.x0, tables.x1);
+        buildSampleTable(src.height, dstHeight, 1, tables.y0, tables.y1);
+        tables.srcWidth = src.width;
+        tables.srcHeight = src.height;
+        tables.dstWidth = dstWidth;
+        tables.dstHeight = dstHeight;
+        tables.bpp = bpp;
+    }
+    return tables;
+}
+
+// ========== 图块哈希（标量） ==========
+
+// 累加器密钥（XXH3 风格的 32x32->64 乘法累加），每行、每个32字节块使用不同的密钥偏移，
+// 使内容在图块内换位时哈希也会变化
+constexpr uint64_t kHashKeys[4] = {0x9E3779B185EBCA87ULL, 0xC2B2AE3D27D4EB4FULL,
+                                   0x165667B19E3779F9ULL, 0x27D4EB2F165667C5ULL};
+constexpr uint64_t kHashRowStep = 0xFF51AFD7ED558CCDULL;
+constexpr uint64_t kHashBlockStep = 0xC4CEB9FE1A85EC53ULL;
+
+inline uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 对一个32字节块做累加（4个通道：acc[i] += lo(dk)*hi(dk)，acc[i^1] += data[i]）
+inline void hashBlockScalar(const uint8_t* data, uint64_t* acc, uint64_t keyOffset) {
+    uint64_t words[4];
+    std::memcpy(words, data, 32);
+    uint64_t next[4] = {acc[0], acc[1], acc[2], acc[3]};
+    for (int lane = 0; lane < 4; ++lane) {
+        const uint64_t dk = words[lane] ^ (kHashKeys[lane] + keyOffset);
+        next[lane] += (dk & 0xFFFFFFFFULL) * (dk >> 32);
+        next[lane ^ 1] += words[lane];
+    }
+    std::memcpy(acc, next, sizeof(next));
+}
+
+size_t hashSegmentScalar(const uint8_t* data, size_t size, uint64_t* acc, uint64_t keyOffset) {
+    size_t i = 0;
+    uint64_t block = 0;
+    for (; i + 32 <= size; i += 32, ++block) {
+        hashBlockScalar(data + i, acc, keyOffset + block * kHashBlockStep);
+    }
+    return i;
+}
+
+// 不足32字节的尾部补0后按一个块处理，并混入长度
+inline void hashTailScalar(const uint8_t* data, size_t size, uint64_t* acc, uint64_t keyOffset) {
+    if (size == 0) {
+        return;
+    }
+    uint8_t block[32] = {};
+    std::memcpy(block, data, size);
+    hashBlockScalar(block, acc, keyOffset ^ (static_cast<uint64_t>(size) << 56));
+}
+
+// ========== 缩放 + 灰度（标量） ==========
+
+void downscaleRowScalar(const PixelLayout& layout,
+                        const uint8_t* row0, const uint8_t* row1,
+                        const uint32_t* x0, const uint32_t* x1,
+                        uint32_t begin, uint32_t end,
+                        uint8_t* gray, uint8_t* bgr) {
+    for (uint32_t x = begin; x < end; ++x) {
+        const uint8_t* p00 = row0 + x0[x];
+        const uint8_t* p01 = row0 + x1[x];
+        const uint8_t* p10 = row1 + x0[x];
+        const uint8_t* p11 = row1 + x1[x];
+        if (layout.gray) {
+            const uint32_t sum = p00[0] + p01[0] + p10[0] + p11[0];
+            const uint8_t v = static_cast<uint8_t>((sum + 2) >> 2);
+            gray[x] = v;
+            if (bgr) {
+                bgr[x * 3 + 0] = v;
+                bgr[x * 3 + 1] = v;
+                bgr[x * 3 + 2] = v;
+            }
+            continue;
+        }
+        const uint32_t b = p00[layout.b] + p01[layout.b] + p10[layout.b] + p11[layout.b];
+        const uint32_t g = p00[layout.g] + p01[layout.g] + p10[layout.g] + p11[layout.g];
+        const uint32_t r = p00[layout.r] + p01[layout.r] + p10[layout.r] + p11[layout.r];
+        gray[x] = static_cast<uint8_t>((kLumaB * b + kLumaG * g + kLumaR * r + 512) >> 10);
+        if (bgr) {
+            bgr[x * 3 + 0] = static_cast<uint8_t>((b + 2) >> 2);
+            bgr[x * 3 + 1] = static_cast<uint8_t>((g + 2) >> 2);
+            bgr[x * 3 + 2] = static_cast<uint8_t>((r + 2) >> 2);
+        }
+    }
+}
+
+// ========== 帧差 + 阈值化（标量） ==========
+
+void diffRowScalar(const uint8_t* cur, const uint8_t* prev, uint8_t* mask,
+                   uint32_t begin, uint32_t end, uint8_t threshold) {
+    for (uint32_t x = begin; x < end; ++x) {
+        const int d = static_cast<int>(cur[x]) - static_cast<int>(prev[x]);
+        mask[x] = (d > threshold || -d > threshold) ? 255 : 0;
+    }
+}
+
+#if defined(NAW_VISION_X86)
+
+// ========== AVX2 实现 ==========
+
+NAW_TARGET_AVX2
+inline __m256i channelSum(__m256i a, __m256i b, __m256i c, __m256i d, int shift) {
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i sa = _mm256_and_si256(_mm256_srli_epi32(a, shift), byteMask);
+    const __m256i sb = _mm256_and_si256(_mm256_srli_epi32(b, shift), byteMask);
+    const __m256i sc = _mm256_and_si256(_mm256_srli_epi32(c, shift), byteMask);
+    const __m256i sd = _mm256_and_si256(_mm256_srli_epi32(d, shift), byteMask);
+    return _mm256_add_epi32(_mm256_add_epi32(sa, sb), _mm256_add_epi32(sc, sd));
+}
+
+NAW_TARGET_AVX2
+inline void storeBytes8(__m256i v32, uint8_t* dst) {
+    // 8 个 32 位值压缩为 8 字节（值已在 0-255 范围内）
+    const __m256i p16 = _mm256_packus_epi32(v32, v32);
+    const __m256i p8 = _mm256_packus_epi16(p16, p16);
+    const int lo = _mm_cvtsi128_si32(_mm256_castsi256_si128(p8));
+    const int hi = _mm_cvtsi128_si32(_mm256_extracti128_si256(p8, 1));
+    std::memcpy(dst, &lo, 4);
+    std::memcpy(dst + 4, &hi, 4);
+}
+
+// 每次处理8个输出像素：用 gather 读取 2x2 源像素（每次读4字节，调用方保证不越过行尾）
+NAW_TARGET_AVX2
+uint32_t downscaleRowAVX2(const PixelLayout& layout,
+                          const uint8_t* row0, const uint8_t* row1,
+                          const uint32_t* x0, const uint32_t* x1,
+                          uint32_t begin, uint32_t end,
+                          uint8_t* gray, uint8_t* bgr) {
+    const __m256i round2 = _mm256_set1_epi32(2);
+    const __m256i lumaB = _mm256_set1_epi32(static_cast<int>(kLumaB));
+    const __m256i lumaG = _mm256_set1_epi32(static_cast<int>(kLumaG));
+    const __m256i lumaR = _mm256_set1_epi32(static_cast<int>(kLumaR));
+    const __m256i round512 = _mm256_set1_epi32(512);
+    const int shiftB = static_cast<int>(layout.b * 8);
+    const int shiftG = static_cast<int>(layout.g * 8);
+    const int shiftR = static_cast<int>(layout.r * 8);
+
+    uint32_t x = begin;
+    for (; x + 8 <= end; x += 8) {
+        const __m256i i0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x0 + x));
+        const __m256i i1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x1 + x));
+        const __m256i p00 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(row0), i0, 1);
+        const __m256i p01 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(row0), i1, 1);
+        const __m256i p10 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(row1), i0, 1);
+        const __m256i p11 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(row1), i1, 1);
+
+        if (layout.gray) {
+            const __m256i v = _mm256_srli_epi32(
+                _mm256_add_epi32(channelSum(p00, p01, p10, p11, 0), round2), 2);
+            storeBytes8(v, gray + x);
+            if (bgr) {
+                alignas(32) uint32_t tmp[8];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(tmp), v);
+                for (int k = 0; k < 8; ++k) {
+                    const uint8_t g = static_cast<uint8_t>(tmp[k]);
+                    bgr[(x + k) * 3 + 0] = g;
+                    bgr[(x + k) * 3 + 1] = g;
+                    bgr[(x + k) * 3 + 2] = g;
+                }
+            }
+            continue;
+        }
+
+        const __m256i b = channelSum(p00, p01, p10, p11, shiftB);
+        const __m256i g = channelSum(p00, p01, p10, p11, shiftG);
+        const __m256i r = channelSum(p00, p01, p10, p11, shiftR);
+        __m256i y = _mm256_add_epi32(_mm256_mullo_epi32(b, lumaB), _mm256_mullo_epi32(g, lumaG));
+        y = _mm256_add_epi32(y, _mm256_mullo_epi32(r, lumaR));
+        y = _mm256_srli_epi32(_mm256_add_epi32(y, round512), 10);
+        storeBytes8(y, gray + x);
+
+        if (bgr) {
+            const __m256i ab = _mm256_srli_epi32(_mm256_add_epi32(b, round2), 2);
+            const __m256i ag = _mm256_srli_epi32(_mm256_add_epi32(g, round2), 2);
+            const __m256i ar = _mm256_srli_epi32(_mm256_add_epi32(r, round2), 2);
+            const __m256i packed = _mm256_or_si256(
+                ab, _mm256_or_si256(_mm256_slli_epi32(ag, 8), _mm256_slli_epi32(ar, 16)));
+            alignas(32) uint32_t tmp[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(tmp), packed);
+            for (int k = 0; k < 8; ++k) {
+                std::memcpy(bgr + (x + k) * 3, &tmp[k], 3);
+            }
+        }
+    }
+    return x;
+}
+
+NAW_TARGET_AVX2
+uint32_t diffRowAVX2(const uint8_t* cur, const uint8_t* prev, uint8_t* mask,
+                     uint32_t end, uint8_t threshold) {
+    const __m256i thr = _mm256_set1_epi8(static_cast<char>(threshold));
+    const __m256i zero = _mm256_setzero_si256();
+    uint32_t x = 0;
+    for (; x + 32 <= end; x += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + x));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + x));
+        const __m256i ad = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+        // ad > thr  <=>  饱和减法结果非0
+        const __m256i over = _mm256_subs_epu8(ad, thr);
+        const __m256i m = _mm256_xor_si256(_mm256_cmpeq_epi8(over, zero), _mm256_set1_epi8(-1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(mask + x), m);
+    }
+    return x;
+}
+
+// 图块哈希：一次累加32字节（4个64位通道），与标量实现逐位一致
+NAW_TARGET_AVX2
+size_t hashSegmentAVX2(const uint8_t* data, size_t size, uint64_t* acc, uint64_t keyOffset) {
+    __m256i accv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+    const __m256i baseKey = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kHashKeys));
+    size_t i = 0;
+    uint64_t block = 0;
+    for (; i + 32 <= size; i += 32, ++block) {
+        const __m256i key = _mm256_add_epi64(
+            baseKey, _mm256_set1_epi64x(static_cast<long long>(keyOffset + block * kHashBlockStep)));
+        const __m256i data32 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i dk = _mm256_xor_si256(data32, key);
+        const __m256i product = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+        const __m256i swapped = _mm256_shuffle_epi32(data32, _MM_SHUFFLE(1, 0, 3, 2));
+        accv = _mm256_add_epi64(accv, _mm256_add_epi64(product, swapped));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), accv);
+    return i;
+}
+
+bool cpuSupportsAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // NAW_VISION_X86
+
+#if defined(NAW_VISION_NEON)
+
+// ========== NEON 实现（帧差部分；缩放需要逐像素寻址，沿用标量实现） ==========
+
+uint32_t diffRowNEON(const uint8_t* cur, const uint8_t* prev, uint8_t* mask,
+                     uint32_t end, uint8_t threshold) {
+    const uint8x16_t thr = vdupq_n_u8(threshold);
+    uint32_t x = 0;
+    for (; x + 16 <= end; x += 16) {
+        const uint8x16_t ad = vabdq_u8(vld1q_u8(cur + x), vld1q_u8(prev + x));
+        vst1q_u8(mask + x, vcgtq_u8(ad, thr));
+    }
+    return x;
+}
+
+#endif // NAW_VISION_NEON
+
+// 统计掩码中非0字节数（每个非0字节都是255）
+uint32_t countMaskBytes(const uint8_t* mask, uint32_t n) {
+    uint32_t count = 0;
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, mask + i, 8);
+        count += static_cast<uint32_t>(std::popcount(word)) / 8;
+    }
+    for (; i < n; ++i) {
+        count += mask[i] != 0 ? 1u : 0u;
+    }
+    return count;
+}
+
+VisionKernels::SimdLevel detectSimdLevel() {
+#if defined(NAW_VISION_X86)
+    if (cpuSupportsAVX2()) {
+        return VisionKernels::SimdLevel::AVX2;
+    }
+#elif defined(NAW_VISION_NEON)
+    return VisionKernels::SimdLevel::NEON;
+#endif
+    return VisionKernels::SimdLevel::Scalar;
+}
+
+bool isSupported(VisionKernels::SimdLevel level) {
+    switch (level) {
+        case VisionKernels::SimdLevel::Scalar:
+            return true;
+        case VisionKernels::SimdLevel::AVX2:
+#if defined(NAW_VISION_X86)
+            return cpuSupportsAVX2();
+#else
+            return false;
+#endif
+        case VisionKernels::SimdLevel::NEON:
+#if defined(NAW_VISION_NEON)
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+// -1 表示尚未检测
+std::atomic<int> g_simdLevel{-1};
+
+} // namespace
+
+// ========== TileChangeMap ==========
+
+void TileChangeMap::reset(uint32_t imageWidth, uint32_t imageHeight, uint32_t tile) {
+    tileSize = std::max<uint32_t>(8, (tile + 7) / 8 * 8);
+    width = imageWidth;
+    height = imageHeight;
+    tilesX = (imageWidth + tileSize - 1) / tileSize;
+    tilesY = (imageHeight + tileSize - 1) / tileSize;
+    changedPixels.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+    totalChanged = 0;
+}
+
+uint32_t TileChangeMap::dirtyTileCount() const {
+    return static_cast<uint32_t>(std::count_if(changedPixels.begin(), changedPixels.end(),
+                                               [](uint32_t c) { return c > 0; }));
+}
+
+std::vector<types::Rect> TileChangeMap::dirtyRegions(uint32_t marginTiles, uint32_t minChangedPixels) const {
+    struct TileBox {
+        uint32_t x0, y0, x1, y1;  // 闭区间，图块坐标
+    };
+    std::vector<TileBox> boxes;
+    if (totalChanged == 0 || tilesX == 0 || tilesY == 0) {
+        return {};
+    }
+    minChangedPixels = std::max<uint32_t>(1, minChangedPixels);
+
+    // 8邻域连通的脏图块归为一组
+    std::vector<uint8_t> visited(changedPixels.size(), 0);
+    std::vector<uint32_t> stack;
+    for (uint32_t start = 0; start < changedPixels.size(); ++start) {
+        if (visited[start] || changedPixels[start] < minChangedPixels) {
+            continue;
+        }
+        TileBox box{start % tilesX, start / tilesX, start % tilesX, start / tilesX};
+        stack.push_back(start);
+        visited[start] = 1;
+        while (!stack.empty()) {
+            const uint32_t idx = stack.back();
+            stack.pop_back();
+            const uint32_t tx = idx % tilesX;
+            const uint32_t ty = idx / tilesX;
+            box.x0 = std::min(box.x0, tx);
+            box.y0 = std::min(box.y0, ty);
+            box.x1 = std::max(box.x1, tx);
+            box.y1 = std::max(box.y1, ty);
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int nx = static_cast<int>(tx) + dx;
+                    const int ny = static_cast<int>(ty) + dy;
+                    if (nx < 0 || ny < 0 || nx >= static_cast<int>(tilesX) || ny >= static_cast<int>(tilesY)) {
+                        continue;
+                    }
+                    const uint32_t n = static_cast<uint32_t>(ny) * tilesX + static_cast<uint32_t>(nx);
+                    if (!visited[n] && changedPixels[n] >= minChangedPixels) {
+                        visited[n] = 1;
+                        stack.push_back(n);
+                    }
+                }
+            }
+        }
+        // 向外扩展
+        box.x0 = box.x0 > marginTiles ? box.x0 - marginTiles : 0;
+        box.y0 = box.y0 > marginTiles ? box.y0 - marginTiles : 0;
+        box.x1 = std::min(box.x1 + marginTiles, tilesX - 1);
+        box.y1 = std::min(box.y1 + marginTiles, tilesY - 1);
+        boxes.push_back(box);
+    }
+
+    // 合并重叠的矩形，直到没有重叠
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < boxes.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < boxes.size(); ++j) {
+                const TileBox& a = boxes[i];
+                const TileBox& b = boxes[j];
+                if (a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1) {
+                    boxes[i] = {std::min(a.x0, b.x0), std::min(a.y0, b.y0),
+                                std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+                    boxes.erase(boxes.begin() + static_cast<std::ptrdiff_t>(j));
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<types::Rect> regions;
+    regions.reserve(boxes.size());
+    for (const auto& box : boxes) {
+        types::Rect rect;
+        rect.x = static_cast<int32_t>(box.x0 * tileSize);
+        rect.y = static_cast<int32_t>(box.y0 * tileSize);
+        rect.width = std::min((box.x1 + 1) * tileSize, width) - box.x0 * tileSize;
+        rect.height = std::min((box.y1 + 1) * tileSize, height) - box.y0 * tileSize;
+        regions.push_back(rect);
+    }
+    return regions;
+}
+
+// ========== VisionKernels ==========
+
+VisionKernels::SimdLevel VisionKernels::simdLevel() {
+    int level = g_simdLevel.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = static_cast<int>(detectSimdLevel());
+        g_simdLevel.store(level, std::memory_order_relaxed);
+    }
+    return static_cast<SimdLevel>(level);
+}
+
+void VisionKernels::setSimdLevel(SimdLevel level) {
+    g_simdLevel.store(static_cast<int>(isSupported(level) ? level : SimdLevel::Scalar),
+                      std::memory_order_relaxed);
+}
+
+const char* VisionKernels::simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+bool VisionKernels::downscaleGrayDiff(const types::ImageView& src,
+                                      const DownscaleDiffParams& params,
+                                      uint8_t* gray,
+                                      uint8_t* bgr,
+                                      const uint8_t* previousGray,
+                                      uint8_t* diffMask,
+                                      TileChangeMap& tiles) {
+    types::Rect full;
+    full.width = params.dstWidth;
+    full.height = params.dstHeight;
+    return downscaleGrayDiff(src, params, gray, bgr, previousGray, diffMask, tiles, {full});
+}
+
+bool VisionKernels::downscaleGrayDiff(const types::ImageView& src,
+                                      const DownscaleDiffParams& params,
+                                      uint8_t* gray,
+                                      uint8_t* bgr,
+                                      const uint8_t* previousGray,
+                                      uint8_t* diffMask,
+                                      TileChangeMap& tiles,
+                                      const std::vector<types::Rect>& regions) {
+    if (!src.isValid() || params.dstWidth == 0 || params.dstHeight == 0 || gray == nullptr ||
+        (previousGray != nullptr && diffMask == nullptr)) {
+        return false;
+    }
+
+    const uint32_t dstW = params.dstWidth;
+    const uint32_t dstH = params.dstHeight;
+    const PixelLayout layout = layoutOf(src.format);
+    const SampleTables& tables = sampleTablesFor(src, dstW, dstH, layout.bpp);
+    const SimdLevel level = simdLevel();
+    (void)level;  // 没有可用 SIMD 实现的平台上未使用
+    tiles.reset(dstW, dstH, params.tileSize);
+
+    // SIMD gather 每次读取4字节：只对读取不会越过行尾的输出像素使用
+    uint32_t simdEnd = 0;
+#if defined(NAW_VISION_X86)
+    if (level == SimdLevel::AVX2) {
+        const uint32_t rowBytes = src.rowBytes();
+        while (simdEnd < dstW && tables.x1[simdEnd] + 4 <= rowBytes) {
+            ++simdEnd;
+        }
+    }
+#endif
+
+    for (const auto& region : regions) {
+        // 区域裁剪到输出范围内
+        const uint32_t rx0 = static_cast<uint32_t>(std::max<int32_t>(0, region.x));
+        const uint32_t ry0 = static_cast<uint32_t>(std::max<int32_t>(0, region.y));
+        const uint32_t rx1 = static_cast<uint32_t>(
+            std::min<int64_t>(dstW, static_cast<int64_t>(region.x) + region.width));
+        const uint32_t ry1 = static_cast<uint32_t>(
+            std::min<int64_t>(dstH, static_cast<int64_t>(region.y) + region.height));
+        if (rx0 >= rx1 || ry0 >= ry1) {
+            continue;
+        }
+        const uint32_t rw = rx1 - rx0;
+
+        for (uint32_t y = ry0; y < ry1; ++y) {
+            const uint8_t* row0 = src.row(tables.y0[y]);
+            const uint8_t* row1 = src.row(tables.y1[y]);
+            uint8_t* grayRow = gray + static_cast<size_t>(y) * dstW;
+            uint8_t* bgrRow = bgr ? bgr + static_cast<size_t>(y) * dstW * 3 : nullptr;
+
+            // 1) 缩放 + 灰度（+ 彩色）
+            uint32_t done = rx0;
+#if defined(NAW_VISION_X86)
+            if (std::min(simdEnd, rx1) >= rx0 + 8) {
+                done = downscaleRowAVX2(layout, row0, row1, tables.x0.data(), tables.x1.data(),
+                                        rx0, std::min(simdEnd, rx1), grayRow, bgrRow);
+            }
+#endif
+            downscaleRowScalar(layout, row0, row1, tables.x0.data(), tables.x1.data(),
+                               done, rx1, grayRow, bgrRow);
+
+            if (previousGray == nullptr) {
+                continue;
+            }
+
+            // 2) 趁本行还在缓存中，立即与前一帧比较
+            const uint8_t* prevRow = previousGray + static_cast<size_t>(y) * dstW;
+            uint8_t* maskRow = diffMask + static_cast<size_t>(y) * dstW;
+            uint32_t diffDone = 0;
+#if defined(NAW_VISION_X86)
+            if (level == SimdLevel::AVX2) {
+                diffDone = diffRowAVX2(grayRow + rx0, prevRow + rx0, maskRow + rx0, rw, params.diffThreshold);
+            }
+#elif defined(NAW_VISION_NEON)
+            if (level == SimdLevel::NEON) {
+                diffDone = diffRowNEON(grayRow + rx0, prevRow + rx0, maskRow + rx0, rw, params.diffThreshold);
+            }
+#endif
+            diffRowScalar(grayRow, prevRow, maskRow, rx0 + diffDone, rx1, params.diffThreshold);
+
+            // 3) 累计图块统计（只统计区域覆盖的部分）
+            uint32_t* tileRow = tiles.changedPixels.data() + static_cast<size_t>(y / tiles.tileSize) * tiles.tilesX;
+            for (uint32_t tx = rx0 / tiles.tileSize; tx * tiles.tileSize < rx1; ++tx) {
+                const uint32_t x0 = std::max(rx0, tx * tiles.tileSize);
+                const uint32_t x1 = std::min(rx1, (tx + 1) * tiles.tileSize);
+                const uint32_t changed = countMaskBytes(maskRow + x0, x1 - x0);
+                tileRow[tx] += changed;
+                tiles.totalChanged += changed;
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<types::Rect> VisionKernels::mapRegions(const std::vector<types::Rect>& regions,
+                                                   uint32_t srcWidth, uint32_t srcHeight,
+                                                   uint32_t dstWidth, uint32_t dstHeight,
+                                                   uint32_t padding) {
+    std::vector<types::Rect> mapped;
+    if (srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0) {
+        return mapped;
+    }
+    mapped.reserve(regions.size());
+    for (const auto& region : regions) {
+        if (!region.isValid()) {
+            continue;
+        }
+        // 向外取整，再加上边距（覆盖 2x2 采样与邻域运算）
+        const int64_t x0 = static_cast<int64_t>(std::max<int32_t>(0, region.x)) * dstWidth / srcWidth;
+        const int64_t y0 = static_cast<int64_t>(std::max<int32_t>(0, region.y)) * dstHeight / srcHeight;
+        const int64_t x1 = ((static_cast<int64_t>(region.x) + region.width) * dstWidth + srcWidth - 1) / srcWidth;
+        const int64_t y1 = ((static_cast<int64_t>(region.y) + region.height) * dstHeight + srcHeight - 1) / srcHeight;
+        const int64_t px0 = std::max<int64_t>(0, x0 - padding);
+        const int64_t py0 = std::max<int64_t>(0, y0 - padding);
+        const int64_t px1 = std::min<int64_t>(dstWidth, x1 + padding);
+        const int64_t py1 = std::min<int64_t>(dstHeight, y1 + padding);
+        if (px0 >= px1 || py0 >= py1) {
+            continue;
+        }
+        types::Rect rect;
+        rect.x = static_cast<int32_t>(px0);
+        rect.y = static_cast<int32_t>(py0);
+        rect.width = static_cast<uint32_t>(px1 - px0);
+        rect.height = static_cast<uint32_t>(py1 - py0);
+        mapped.push_back(rect);
+    }
+
+    // 合并重叠的区域，保证各区域互不相交（内核对每个像素只处理一次）
+    auto overlaps = [](const types::Rect& a, const types::Rect& b) {
+        return a.x < b.x + static_cast<int32_t>(b.width) && b.x < a.x + static_cast<int32_t>(a.width) &&
+               a.y < b.y + static_cast<int32_t>(b.height) && b.y < a.y + static_cast<int32_t>(a.height);
+    };
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < mapped.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < mapped.size(); ++j) {
+                if (!overlaps(mapped[i], mapped[j])) {
+                    continue;
+                }
+                const types::Rect& a = mapped[i];
+                const types::Rect& b = mapped[j];
+                const int32_t x0 = std::min(a.x, b.x);
+                const int32_t y0 = std::min(a.y, b.y);
+                const int32_t x1 = std::max(a.x + static_cast<int32_t>(a.width), b.x + static_cast<int32_t>(b.width));
+                const int32_t y1 = std::max(a.y + static_cast<int32_t>(a.height), b.y + static_cast<int32_t>(b.height));
+                mapped[i] = {x0, y0, static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)};
+                mapped.erase(mapped.begin() + static_cast<std::ptrdiff_t>(j));
+                merged = true;
+                break;
+            }
+        }
+    }
+    return mapped;
+}
+
+void VisionKernels::hashTiles(const types::ImageView& src, uint32_t tileSize, TileHashGrid& grid) {
+    tileSize = std::max<uint32_t>(8, tileSize);
+    if (!src.isValid()) {
+        grid = TileHashGrid{};
+        return;
+    }
+    grid.tileSize = tileSize;
+    grid.width = src.width;
+    grid.height = src.height;
+    grid.format = src.format;
+    grid.tilesX = (src.width + tileSize - 1) / tileSize;
+    grid.tilesY = (src.height + tileSize - 1) / tileSize;
+    grid.hashes.resize(static_cast<size_t>(grid.tilesX) * grid.tilesY);
+
+    const SimdLevel level = simdLevel();
+    (void)level;
+    const uint32_t bpp = src.bytesPerPixel();
+    const size_t tileBytes = static_cast<size_t>(tileSize) * bpp;
+    thread_local std::vector<uint64_t> acc;
+    acc.resize(static_cast<size_t>(grid.tilesX) * 4);
+
+    // 按行顺序读取源图像（缓存友好），每个图块列各自维护4个累加器，图块行结束时输出哈希
+    for (uint32_t ty = 0; ty < grid.tilesY; ++ty) {
+        for (uint32_t tx = 0; tx < grid.tilesX; ++tx) {
+            std::memcpy(&acc[tx * 4], kHashKeys, sizeof(kHashKeys));
+        }
+        const uint32_t y0 = ty * tileSize;
+        const uint32_t y1 = std::min(src.height, y0 + tileSize);
+        for (uint32_t y = y0; y < y1; ++y) {
+            const uint8_t* row = src.row(y);
+            const uint64_t rowKey = static_cast<uint64_t>(y - y0) * kHashRowStep;
+            for (uint32_t tx = 0; tx < grid.tilesX; ++tx) {
+                const size_t offset = static_cast<size_t>(tx) * tileBytes;
+                const size_t size = std::min(tileBytes, static_cast<size_t>(src.rowBytes()) - offset);
+                uint64_t* tileAcc = &acc[tx * 4];
+                size_t done = 0;
+#if defined(NAW_VISION_X86)
+                if (level == SimdLevel::AVX2) {
+                    done = hashSegmentAVX2(row + offset, size, tileAcc, rowKey);
+                }
+#endif
+                if (done == 0) {
+                    done = hashSegmentScalar(row + offset, size, tileAcc, rowKey);
+                }
+                hashTailScalar(row + offset + done, size - done, tileAcc,
+                               rowKey + (done / 32) * kHashBlockStep);
+            }
+        }
+        for (uint32_t tx = 0; tx < grid.tilesX; ++tx) {
+            const uint64_t* a = &acc[tx * 4];
+            uint64_t h = a[0] * 0x9E3779B185EBCA87ULL + a[1] * 0xC2B2AE3D27D4EB4FULL +
+                         a[2] * 0x165667B19E3779F9ULL + a[3] * 0x27D4EB2F165667C5ULL;
+            grid.hashes[static_cast<size_t>(ty) * grid.tilesX + tx] = mix64(h ^ (y1 - y0));
+        }
+    }
+}
+
+uint32_t VisionKernels::compareTileHashes(const TileHashGrid& current,
+                                          const TileHashGrid& previous,
+                                          TileChangeMap& dirty) {
+    dirty.reset(current.width, current.height, current.tileSize);
+    if (!current.sameLayout(previous)) {
+        return 0;
+    }
+    // 哈希图块尺寸按原值使用（TileChangeMap::reset 会把图块大小取整到8的倍数）
+    dirty.tileSize = current.tileSize;
+    dirty.tilesX = current.tilesX;
+    dirty.tilesY = current.tilesY;
+    dirty.changedPixels.assign(current.hashes.size(), 0);
+
+    uint32_t count = 0;
+    for (size_t i = 0; i < current.hashes.size(); ++i) {
+        if (current.hashes[i] == previous.hashes[i]) {
+            continue;
+        }
+        // 哈希无法给出具体变化像素数，按整个图块（边缘图块按实际大小）计
+        const uint32_t tx = static_cast<uint32_t>(i % current.tilesX);
+        const uint32_t ty = static_cast<uint32_t>(i / current.tilesX);
+        const uint32_t w = std::min(current.tileSize, current.width - tx * current.tileSize);
+        const uint32_t h = std::min(current.tileSize, current.height - ty * current.tileSize);
+        dirty.changedPixels[i] = w * h;
+        dirty.totalChanged += static_cast<uint64_t>(w) * h;
+        ++count;
+    }
+    return count;
+}
+
+} // namespace naw::desktop_pet::service
@@ -1,4 +1,5 @@
 #include "naw/desktop_pet/service/VisionLayer0.h"
+#include "naw/desktop_pet/service/VisionKernels.h"
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
@@ -7,7 +8,6 @@
 
 #include <algorithm>
 #include <cmath>
-#include <cstring>
 #include <memory>
 
 namespace naw::desktop_pet::service {
@@ -21,57 +21,108 @@ public:
     {
     }
 
-    VisionLayer0Result processFrame(const types::ImageData& frame) {
+    VisionLayer0Result processFrame(const types::ImageView& frame, const VisionLayer0FrameOptions& options) {
         VisionLayer0Result result;
         
         if (!frame.isValid()) {
             return result;
         }
 
-        // 转换为 OpenCV Mat 并降低分辨率
-        cv::Mat currentMat = imageDataToMat(frame);
-        if (currentMat.empty()) {
+        const int width = static_cast<int>(config_.processingWidth);
+        const int height = static_cast<int>(config_.processingHeight);
+        if (width <= 0 || height <= 0) {
             return result;
         }
 
-        // 降低分辨率以提高性能
-        cv::Mat processedMat;
-        if (currentMat.cols != static_cast<int>(config_.processingWidth) ||
-            currentMat.rows != static_cast<int>(config_.processingHeight)) {
-            cv::resize(currentMat, processedMat,
-                      cv::Size(static_cast<int>(config_.processingWidth),
-                              static_cast<int>(config_.processingHeight)),
-                      0, 0, cv::INTER_LINEAR);
-        } else {
-            processedMat = currentMat;
+        // 当前帧写入后台缓冲（尺寸不变时 create 不会重新分配）
+        const int previous = current_ ^ 1;
+        cv::Mat& colorMat = colorFrames_[current_];
+        cv::Mat& grayMat = grayFrames_[current_];
+        grayMat.create(height, width, CV_8UC1);
+        colorMat.create(height, width, CV_8UC3);
+        const cv::Mat& previousGray = grayFrames_[previous];
+        const bool hasPrevious = hasPrevious_ && previousGray.size() == grayMat.size();
+        if (hasPrevious) {
+            diffBuffer_.create(height, width, CV_8UC1);
         }
 
-        // 转换为灰度图（用于帧差和运动检测）
-        cv::Mat grayMat;
-        if (processedMat.channels() == 3) {
-            cv::cvtColor(processedMat, grayMat, cv::COLOR_BGR2GRAY);
-        } else if (processedMat.channels() == 4) {
-            cv::cvtColor(processedMat, grayMat, cv::COLOR_BGRA2GRAY);
-        } else if (processedMat.channels() == 1) {
-            grayMat = processedMat;
+        // 第一遍：源图像图块哈希与前一帧比较，找出内容变化的源区域
+        bool partialUpdate = false;
+        dirtySourceRegions_.clear();
+        if (config_.enableTileHash) {
+            VisionKernels::hashTiles(frame, config_.hashTileSize, tileHashes_[current_]);
+            if (hasPrevious && tileHashes_[current_].sameLayout(tileHashes_[previous])) {
+                const uint32_t dirtyTiles = VisionKernels::compareTileHashes(
+                    tileHashes_[current_], tileHashes_[previous], hashChangeMap_);
+                if (dirtyTiles == 0) {
+                    // 画面完全没有变化：不做任何图像处理，前一帧保持为参考帧
+                    return unchangedResult();
+                }
+                const double dirtyRatio = static_cast<double>(dirtyTiles) /
+                                          static_cast<double>(tileHashes_[current_].hashes.size());
+                if (dirtyRatio <= config_.partialUpdateMaxRatio) {
+                    partialUpdate = true;
+                    dirtySourceRegions_ = hashChangeMap_.dirtyRegions(0);
+                }
+            }
         } else {
+            // 关闭期间不保留哈希，避免重新启用时与过期的哈希比较
+            tileHashes_[current_].hashes.clear();
+        }
+
+        // 一次遍历源图像完成缩放、灰度/BGR转换和帧差阈值化，同时统计每个图块的变化像素
+        VisionKernels::DownscaleDiffParams params;
+        params.dstWidth = config_.processingWidth;
+        params.dstHeight = config_.processingHeight;
+        params.diffThreshold = static_cast<uint8_t>(
+            std::clamp(config_.frameDiffThreshold * 255.0, 0.0, 255.0));
+        params.tileSize = config_.changeTileSize;
+        if (partialUpdate) {
+            // 只有少量图块变化：未变化部分沿用前一帧的结果，内核只处理脏区域
+            const auto regions = VisionKernels::mapRegions(
+                dirtySourceRegions_, frame.width, frame.height, params.dstWidth, params.dstHeight);
+            previousGray.copyTo(grayMat);
+            colorFrames_[previous].copyTo(colorMat);
+            diffBuffer_.setTo(0);
+            if (!VisionKernels::downscaleGrayDiff(frame, params, grayMat.data, colorMat.data,
+                                                  previousGray.data, diffBuffer_.data,
+                                                  tileMap_, regions)) {
+                return result;
+            }
+            buildMotionMask(regions);
+        } else if (!VisionKernels::downscaleGrayDiff(frame, params, grayMat.data, colorMat.data,
+                                                     hasPrevious ? previousGray.data : nullptr,
+                                                     hasPrevious ? diffBuffer_.data : nullptr,
+                                                     tileMap_)) {
             return result;
         }
 
+        // 直方图每帧只计算一次，上一帧的直方图保留在另一个缓冲中
+        computeColorHistogram(colorMat, histograms_[current_]);
+
         // 如果有前一帧，进行各种检测
-        if (!previousFrame_.empty() && previousFrame_.size() == grayMat.size()) {
-            // 帧差检测
-            result.frameDiffScore = detectFrameDifference(
-                grayMat, previousFrame_, result.changedRegions);
+        if (hasPrevious) {
+            // 帧差检测（掩码已由融合内核生成）
+            result.frameDiffScore = detectFrameDifference(result.changedRegions);
 
-            // 色彩分析（使用彩色图）
+            // 色彩分析（使用彩色图的直方图）
             result.colorChangeScore = analyzeColor(
-                processedMat, previousColorFrame_, result.dominantColors);
+                histograms_[current_], histograms_[previous], options.runDominantColor,
+                result.dominantColors);
 
-            // 运动检测
+            // 运动检测：没有变化像素时不可能有运动；被调度器跳过的帧沿用上次的结果；
+            // 部分更新时只在脏区域内找特征点
             if (config_.enableMotionDetection) {
-                result.motionScore = detectMotion(
-                    grayMat, previousFrame_, result.motionRegions);
+                if (!tileMap_.anyChanged()) {
+                    lastMotionScore_ = 0.0;
+                    lastMotionRegions_.clear();
+                } else if (options.runMotionDetection) {
+                    lastMotionScore_ = detectMotion(
+                        grayMat, previousGray, partialUpdate ? motionMask_ : cv::Mat(),
+                        lastMotionRegions_);
+                }
+                result.motionScore = lastMotionScore_;
+                result.motionRegions = lastMotionRegions_;
             }
         } else {
             // 第一帧，初始化
@@ -80,33 +131,22 @@ public:
             result.motionScore = 0.0;
         }
 
-        // 计算综合评分
-        result.overallChangeScore = 
-            config_.frameDiffWeight * result.frameDiffScore +
-            config_.colorChangeWeight * result.colorChangeScore +
-            config_.motionWeight * result.motionScore;
-
-        // 判断是否需要触发下一层
-        double threshold = config_.enableAdaptiveThreshold ? 
-                          adaptiveThreshold_ : config_.overallThreshold;
-        result.shouldTriggerLayer1 = result.overallChangeScore >= threshold;
-
-        // 更新自适应阈值
-        if (config_.enableAdaptiveThreshold) {
-            updateAdaptiveThreshold(result);
-        }
+        finalizeResult(result);
 
-        // 保存当前帧作为下一帧的前一帧
-        previousFrame_ = grayMat.clone();
-        previousColorFrame_ = processedMat.clone();
+        // 交换前后缓冲：当前帧成为下一帧的前一帧，旧缓冲留给下一帧复用
+        current_ = previous;
+        hasPrevious_ = true;
 
         return result;
     }
 
     void reset() {
-        previousFrame_.release();
-        previousColorFrame_.release();
+        // 只丢弃前一帧标记，保留已分配的缓冲区
+        hasPrevious_ = false;
         previousPoints_.clear();
+        lastDominantColors_.clear();
+        lastMotionScore_ = 0.0;
+        lastMotionRegions_.clear();
         adaptiveThreshold_ = config_.overallThreshold;
     }
 
@@ -122,112 +162,104 @@ public:
     }
 
 private:
-    // 将 ImageData 转换为 cv::Mat
-    cv::Mat imageDataToMat(const types::ImageData& image) {
-        if (!image.isValid()) {
-            return cv::Mat();
-        }
-
-        int cvType = 0;
-        switch (image.format) {
-            case types::ImageFormat::Grayscale:
-                cvType = CV_8UC1;
-                break;
-            case types::ImageFormat::RGB:
-            case types::ImageFormat::BGR:
-                cvType = CV_8UC3;
-                break;
-            case types::ImageFormat::RGBA:
-            case types::ImageFormat::BGRA:
-                cvType = CV_8UC4;
-                break;
-        }
+    // 计算综合评分、判断是否触发下一层并更新自适应阈值
+    void finalizeResult(VisionLayer0Result& result) {
+        result.processingWidth = config_.processingWidth;
+        result.processingHeight = config_.processingHeight;
 
-        uint32_t stride = image.stride > 0 ? image.stride : 
-                         (image.width * image.bytesPerPixel());
+        // 计算综合评分
+        result.overallChangeScore = 
+            config_.frameDiffWeight * result.frameDiffScore +
+            config_.colorChangeWeight * result.colorChangeScore +
+            config_.motionWeight * result.motionScore;
 
-        cv::Mat mat(static_cast<int>(image.height),
-                   static_cast<int>(image.width),
-                   cvType);
+        // 判断是否需要触发下一层
+        double threshold = config_.enableAdaptiveThreshold ? 
+                          adaptiveThreshold_ : config_.overallThreshold;
+        result.shouldTriggerLayer1 = result.overallChangeScore >= threshold;
 
-        // 复制数据
-        if (image.stride > 0 && image.stride != image.width * image.bytesPerPixel()) {
-            // 有 padding，逐行复制
-            for (uint32_t y = 0; y < image.height; ++y) {
-                const uint8_t* srcRow = image.data.data() + y * image.stride;
-                uint8_t* dstRow = mat.ptr<uint8_t>(static_cast<int>(y));
-                std::memcpy(dstRow, srcRow, image.width * image.bytesPerPixel());
-            }
-        } else {
-            // 连续存储，直接复制
-            std::memcpy(mat.data, image.data.data(), 
-                       std::min(image.data.size(), 
-                               static_cast<size_t>(mat.total() * mat.elemSize())));
+        // 更新自适应阈值
+        if (config_.enableAdaptiveThreshold) {
+            updateAdaptiveThreshold(result);
         }
+    }
 
-        // 颜色空间转换（RGB -> BGR）
-        if (image.format == types::ImageFormat::RGB) {
-            cv::Mat temp;
-            cv::cvtColor(mat, temp, cv::COLOR_RGB2BGR);
-            mat = temp;
-        } else if (image.format == types::ImageFormat::RGBA) {
-            cv::Mat temp;
-            cv::cvtColor(mat, temp, cv::COLOR_RGBA2BGRA);
-            mat = temp;
-        }
+    // 图块哈希全部相同时的结果：各项评分为0，不交换缓冲（参考帧保持不变）
+    VisionLayer0Result unchangedResult() {
+        VisionLayer0Result result;
+        result.dominantColors = lastDominantColors_;
+        lastMotionScore_ = 0.0;
+        lastMotionRegions_.clear();
+        finalizeResult(result);
+        return result;
+    }
 
-        return mat;
+    // 由脏区域（处理分辨率）生成特征点掩码
+    void buildMotionMask(const std::vector<types::Rect>& regions) {
+        motionMask_.create(static_cast<int>(config_.processingHeight),
+                           static_cast<int>(config_.processingWidth), CV_8UC1);
+        motionMask_.setTo(0);
+        for (const auto& region : regions) {
+            motionMask_(cv::Rect(region.x, region.y,
+                                 static_cast<int>(region.width),
+                                 static_cast<int>(region.height))).setTo(255);
+        }
     }
 
-    // 帧差检测
-    double detectFrameDifference(const cv::Mat& current, const cv::Mat& previous,
-                                 std::vector<types::Rect>& changedRegions) {
-        if (current.empty() || previous.empty() || 
-            current.size() != previous.size()) {
+    // 帧差检测（基于融合内核输出的二值掩码与图块变化图）
+    double detectFrameDifference(std::vector<types::Rect>& changedRegions) {
+        changedRegions.clear();
+
+        // 没有任何变化像素：跳过形态学与轮廓分析（静态桌面的常见情况）
+        if (diffBuffer_.empty() || !tileMap_.anyChanged()) {
             return 0.0;
         }
 
-        // 计算帧差
-        cv::Mat diff;
-        cv::absdiff(current, previous, diff);
-
-        // 二值化
-        cv::Mat binary;
-        cv::threshold(diff, binary, 
-                     static_cast<double>(config_.frameDiffThreshold * 255.0),
-                     255, cv::THRESH_BINARY);
-
-        // 形态学操作去除噪声
-        cv::Mat kernel = cv::getStructuringElement(
-            cv::MORPH_RECT,
-            cv::Size(config_.morphKernelSize, config_.morphKernelSize));
-        cv::Mat morphed;
-        cv::morphologyEx(binary, morphed, cv::MORPH_OPEN, kernel);
-        cv::morphologyEx(morphed, morphed, cv::MORPH_CLOSE, kernel);
-
-        // 连通域分析
-        std::vector<std::vector<cv::Point>> contours;
-        cv::findContours(morphed, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+        // 形态学核只在尺寸变化时重建
+        if (kernel_.empty() || kernel_.rows != config_.morphKernelSize) {
+            kernel_ = cv::getStructuringElement(
+                cv::MORPH_RECT,
+                cv::Size(config_.morphKernelSize, config_.morphKernelSize));
+        }
+        morphBuffer_.create(diffBuffer_.size(), CV_8UC1);
 
-        // 计算变化区域和评分
-        changedRegions.clear();
+        // 只在脏图块区域上做形态学和连通域分析；区域向外扩展的边距覆盖形态学核，
+        // 且按孤立 ROI 处理，不读取区域外（可能是旧帧）的数据
+        const uint32_t marginTiles =
+            1 + static_cast<uint32_t>(std::max(0, config_.morphKernelSize)) / tileMap_.tileSize;
+        const int borderType = cv::BORDER_CONSTANT | cv::BORDER_ISOLATED;
         int changedPixels = 0;
-        int totalPixels = morphed.rows * morphed.cols;
-
-        for (const auto& contour : contours) {
-            if (contour.size() < 3) continue;
-
-            cv::Rect boundingRect = cv::boundingRect(contour);
-            types::Rect rect;
-            rect.x = boundingRect.x;
-            rect.y = boundingRect.y;
-            rect.width = static_cast<uint32_t>(boundingRect.width);
-            rect.height = static_cast<uint32_t>(boundingRect.height);
-            changedRegions.push_back(rect);
-
-            // 计算该区域内的变化像素数
-            cv::Mat roi = morphed(boundingRect);
-            changedPixels += cv::countNonZero(roi);
+        int totalPixels = diffBuffer_.rows * diffBuffer_.cols;
+        std::vector<std::vector<cv::Point>> contours;
+
+        for (const auto& region : tileMap_.dirtyRegions(marginTiles)) {
+            const cv::Rect roi(region.x, region.y,
+                               static_cast<int>(region.width), static_cast<int>(region.height));
+            cv::Mat morphed = morphBuffer_(roi);
+            cv::morphologyEx(diffBuffer_(roi), morphed, cv::MORPH_OPEN, kernel_,
+                             cv::Point(-1, -1), 1, borderType);
+            cv::morphologyEx(morphed, morphed, cv::MORPH_CLOSE, kernel_,
+                             cv::Point(-1, -1), 1, borderType);
+
+            // 连通域分析（轮廓坐标偏移回整图坐标）
+            contours.clear();
+            cv::findContours(morphed, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE,
+                             cv::Point(roi.x, roi.y));
+
+            for (const auto& contour : contours) {
+                if (contour.size() < 3) continue;
+
+                cv::Rect boundingRect = cv::boundingRect(contour);
+                types::Rect rect;
+                rect.x = boundingRect.x;
+                rect.y = boundingRect.y;
+                rect.width = static_cast<uint32_t>(boundingRect.width);
+                rect.height = static_cast<uint32_t>(boundingRect.height);
+                changedRegions.push_back(rect);
+
+                // 计算该区域内的变化像素数
+                changedPixels += cv::countNonZero(morphBuffer_(boundingRect));
+            }
         }
 
         // 计算变化评分（0-1）
@@ -235,55 +267,49 @@ private:
         return std::min(1.0, score);
     }
 
-    // 色彩分析
-    double analyzeColor(const cv::Mat& current, const cv::Mat& previous,
-                       std::vector<float>& dominantColors) {
-        if (current.empty() || previous.empty() ||
-            current.size() != previous.size()) {
-            return 0.0;
-        }
-
+    // 计算色调直方图（降采样后转换到HSV，统计H通道并归一化）
+    void computeColorHistogram(const cv::Mat& bgr, cv::Mat& hist) {
         // 降采样以提高性能
-        cv::Mat currentSampled, previousSampled;
         int sampleFactor = 4; // 每4个像素采样一次
-        cv::resize(current, currentSampled,
-                  cv::Size(current.cols / sampleFactor, current.rows / sampleFactor),
-                  0, 0, cv::INTER_AREA);
-        cv::resize(previous, previousSampled,
-                  cv::Size(previous.cols / sampleFactor, previous.rows / sampleFactor),
+        cv::resize(bgr, sampledBuffer_,
+                  cv::Size(bgr.cols / sampleFactor, bgr.rows / sampleFactor),
                   0, 0, cv::INTER_AREA);
 
-        // 转换为HSV色彩空间
-        cv::Mat currentHSV, previousHSV;
-        cv::cvtColor(currentSampled, currentHSV, cv::COLOR_BGR2HSV);
-        cv::cvtColor(previousSampled, previousHSV, cv::COLOR_BGR2HSV);
+        // 转换为HSV色彩空间，只取H通道（避免 split 为每个通道分配内存）
+        cv::cvtColor(sampledBuffer_, hsvBuffer_, cv::COLOR_BGR2HSV);
+        cv::extractChannel(hsvBuffer_, hueBuffer_, 0);
 
         // 计算直方图
         int histSize = config_.histogramBins;
         float range[] = {0, 256};
         const float* histRange = {range};
-
-        std::vector<cv::Mat> currentChannels, previousChannels;
-        cv::split(currentHSV, currentChannels);
-        cv::split(previousHSV, previousChannels);
-
-        cv::Mat currentHist, previousHist;
-        cv::calcHist(&currentChannels[0], 1, nullptr, cv::Mat(), currentHist,
-                    1, &histSize, &histRange, true, false);
-        cv::calcHist(&previousChannels[0], 1, nullptr, cv::Mat(), previousHist,
+        cv::calcHist(&hueBuffer_, 1, nullptr, cv::Mat(), hist,
                     1, &histSize, &histRange, true, false);
 
         // 归一化直方图
-        cv::normalize(currentHist, currentHist, 0, 1, cv::NORM_MINMAX, -1, cv::Mat());
-        cv::normalize(previousHist, previousHist, 0, 1, cv::NORM_MINMAX, -1, cv::Mat());
+        cv::normalize(hist, hist, 0, 1, cv::NORM_MINMAX, -1, cv::Mat());
+    }
+
+    // 色彩分析（比较当前帧与前一帧的直方图）
+    double analyzeColor(const cv::Mat& currentHist, const cv::Mat& previousHist,
+                       bool allowDominantColor, std::vector<float>& dominantColors) {
+        if (currentHist.empty() || previousHist.empty() ||
+            currentHist.size() != previousHist.size()) {
+            return 0.0;
+        }
 
         // 计算直方图差异（使用相关性方法）
         double correlation = cv::compareHist(currentHist, previousHist, cv::HISTCMP_CORREL);
         double colorChangeScore = 1.0 - correlation; // 相关性越低，变化越大
 
-        // 可选：提取主色调（如果启用）
+        // 可选：提取主色调（如果启用；降采样缓冲中保存的是当前帧）。
+        // K-means 开销大：只在色彩变化超过阈值且本帧允许时重新计算，否则沿用上次的结果
         if (config_.enableDominantColor) {
-            extractDominantColors(currentSampled, dominantColors);
+            const bool colorChanged = colorChangeScore >= config_.colorChangeThreshold;
+            if (lastDominantColors_.empty() || (allowDominantColor && colorChanged)) {
+                extractDominantColors(sampledBuffer_, lastDominantColors_);
+            }
+            dominantColors = lastDominantColors_;
         } else {
             dominantColors.clear();
         }
@@ -299,8 +325,8 @@ private:
         }
 
         // 将图像重塑为样本点
-        cv::Mat samples = image.reshape(1, image.rows * image.cols);
-        samples.convertTo(samples, CV_32F);
+        image.reshape(1, image.rows * image.cols).convertTo(samplesBuffer_, CV_32F);
+        const cv::Mat& samples = samplesBuffer_;
 
         // K-means聚类（提取3种主色调）
         int K = 3;
@@ -322,26 +348,26 @@ private:
     }
 
     // 运动检测（使用稀疏光流）
-    double detectMotion(const cv::Mat& current, const cv::Mat& previous,
+    double detectMotion(const cv::Mat& current, const cv::Mat& previous, const cv::Mat& mask,
                        std::vector<types::Rect>& motionRegions) {
         if (current.empty() || previous.empty() ||
             current.size() != previous.size()) {
             return 0.0;
         }
 
-        // 检测特征点（使用Shi-Tomasi角点检测）
-        std::vector<cv::Point2f> currentPoints;
+        // 检测特征点（使用Shi-Tomasi角点检测；点集容器跨帧复用）
+        std::vector<cv::Point2f>& currentPoints = cornerPoints_;
         cv::goodFeaturesToTrack(previous, currentPoints, config_.opticalFlowPoints,
-                               0.01, 10, cv::Mat(), 3, false, 0.04);
+                               0.01, 10, mask, 3, false, 0.04);
 
         if (currentPoints.empty()) {
             return 0.0;
         }
 
         // 计算光流
-        std::vector<cv::Point2f> nextPoints;
-        std::vector<uchar> status;
-        std::vector<float> err;
+        std::vector<cv::Point2f>& nextPoints = nextPoints_;
+        std::vector<uchar>& status = flowStatus_;
+        std::vector<float>& err = flowError_;
         cv::calcOpticalFlowPyrLK(previous, current, currentPoints, nextPoints,
                                 status, err, cv::Size(15, 15), 2,
                                 cv::TermCriteria(cv::TermCriteria::COUNT + 
@@ -389,7 +415,7 @@ private:
         }
 
         // 保存当前点作为下一帧的前一点
-        previousPoints_ = currentPoints;
+        previousPoints_.assign(currentPoints.begin(), currentPoints.end());
 
         return motionScore;
     }
@@ -414,8 +440,32 @@ private:
     }
 
     VisionLayer0Config config_;
-    cv::Mat previousFrame_;          // 前一帧（灰度图）
-    cv::Mat previousColorFrame_;     // 前一帧（彩色图）
+    // 双缓冲帧存储：current_ 指向本帧写入的缓冲，另一个保存前一帧，处理完后交换下标
+    cv::Mat grayFrames_[2];          // 灰度图（处理分辨率）
+    cv::Mat colorFrames_[2];         // 彩色图（处理分辨率，BGR）
+    cv::Mat histograms_[2];          // 色调直方图
+    int current_{0};
+    bool hasPrevious_{false};
+    TileHashGrid tileHashes_[2];     // 源图像图块哈希（与帧缓冲同步交换）
+    // 跨帧复用的工作缓冲区
+    TileChangeMap tileMap_;          // 当前帧相对前一帧的图块变化图
+    TileChangeMap hashChangeMap_;    // 哈希不同的源图块
+    std::vector<types::Rect> dirtySourceRegions_; // 源分辨率下的脏区域
+    cv::Mat motionMask_;             // 部分更新时的特征点掩码
+    std::vector<float> lastDominantColors_;  // 最近一次提取的主色调
+    double lastMotionScore_{0.0};            // 最近一次光流的运动评分
+    std::vector<types::Rect> lastMotionRegions_;
+    cv::Mat diffBuffer_;
+    cv::Mat morphBuffer_;
+    cv::Mat kernel_;
+    cv::Mat sampledBuffer_;
+    cv::Mat hsvBuffer_;
+    cv::Mat hueBuffer_;
+    cv::Mat samplesBuffer_;
+    std::vector<cv::Point2f> cornerPoints_;
+    std::vector<cv::Point2f> nextPoints_;
+    std::vector<uchar> flowStatus_;
+    std::vector<float> flowError_;
     std::vector<cv::Point2f> previousPoints_; // 前一帧特征点（用于光流）
     double adaptiveThreshold_;       // 自适应阈值
 };
@@ -431,7 +481,16 @@ VisionLayer0::VisionLayer0(const VisionLayer0Config& config)
 VisionLayer0::~VisionLayer0() = default;
 
 VisionLayer0Result VisionLayer0::processFrame(const types::ImageData& frame) {
-    return pImpl_->processFrame(frame);
+    return pImpl_->processFrame(types::ImageView::fromImageData(frame), VisionLayer0FrameOptions{});
+}
+
+VisionLayer0Result VisionLayer0::processFrame(const types::ImageView& frame) {
+    return pImpl_->processFrame(frame, VisionLayer0FrameOptions{});
+}
+
+VisionLayer0Result VisionLayer0::processFrame(const types::ImageView& frame,
+                                              const VisionLayer0FrameOptions& options) {
+    return pImpl_->processFrame(frame, options);
 }
 
 void VisionLayer0::reset() {
@@ -0,0 +1,466 @@
+#include "naw/desktop_pet/service/VisionLayer1.h"
+#include "naw/desktop_pet/service/ImageProcessor.h"
+#include "naw/desktop_pet/service/VisionKernels.h"
+
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+namespace naw::desktop_pet::service {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief 解析 YOLOv8 输出（每个锚点：cx, cy, w, h, 各类别分数）
+ *
+ * channelsFirst 为 true 时数据布局为 [通道][锚点]：按类别逐行更新每个锚点的最高分，
+ * 内层循环是对连续内存的逐元素比较，编译器可以向量化。
+ */
+void decodeYoloOutput(const float* data, int channels, int anchors, bool channelsFirst,
+                      float confidenceThreshold, std::vector<Detection>& out) {
+    const int numClasses = channels - 4;
+    if (numClasses <= 0 || anchors <= 0) {
+        return;
+    }
+
+    thread_local std::vector<float> bestScore;
+    thread_local std::vector<int> bestClass;
+    bestScore.assign(static_cast<size_t>(anchors), 0.0f);
+    bestClass.assign(static_cast<size_t>(anchors), 0);
+    float* scores = bestScore.data();
+    int* classes = bestClass.data();
+
+    auto at = [&](int channel, int anchor) {
+        return channelsFirst ? data[static_cast<size_t>(channel) * anchors + anchor]
+                             : data[static_cast<size_t>(anchor) * channels + channel];
+    };
+
+    if (channelsFirst) {
+        for (int c = 0; c < numClasses; ++c) {
+            const float* row = data + static_cast<size_t>(c + 4) * anchors;
+            for (int a = 0; a < anchors; ++a) {
+                const bool better = row[a] > scores[a];
+                scores[a] = better ? row[a] : scores[a];
+                classes[a] = better ? c : classes[a];
+            }
+        }
+    } else {
+        for (int a = 0; a < anchors; ++a) {
+            const float* row = data + static_cast<size_t>(a) * channels + 4;
+            const float* best = std::max_element(row, row + numClasses);
+            scores[a] = *best;
+            classes[a] = static_cast<int>(best - row);
+        }
+    }
+
+    for (int a = 0; a < anchors; ++a) {
+        if (scores[a] < confidenceThreshold) {
+            continue;
+        }
+        const float cx = at(0, a);
+        const float cy = at(1, a);
+        const float w = at(2, a);
+        const float h = at(3, a);
+        Detection det;
+        det.x1 = cx - w * 0.5f;
+        det.y1 = cy - h * 0.5f;
+        det.x2 = cx + w * 0.5f;
+        det.y2 = cy + h * 0.5f;
+        det.score = scores[a];
+        det.classId = classes[a];
+        out.push_back(std::move(det));
+    }
+}
+
+/**
+ * @brief CPU 检测后端（OpenCV DNN）
+ */
+class OpenCVDnnBackend : public DetectionBackend {
+public:
+    bool load(const VisionLayer1Config& config) override {
+        try {
+            m_net = cv::dnn::readNetFromONNX(config.modelPath);
+            if (m_net.empty()) {
+                m_lastError = "Failed to load model: " + config.modelPath;
+                return false;
+            }
+            m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+            m_net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+            // OpenCV 的线程池是进程级的，不按实例修改；线程数由应用统一配置
+            m_inputSize = cv::Size(static_cast<int>(config.inputWidth), static_cast<int>(config.inputHeight));
+            m_confidenceThreshold = config.confidenceThreshold;
+            m_batchSupported = true;
+            m_loaded = true;
+            return true;
+        } catch (const cv::Exception& e) {
+            m_lastError = std::string("Failed to load model: ") + e.what();
+            m_loaded = false;
+            return false;
+        }
+    }
+
+    bool isLoaded() const override { return m_loaded; }
+
+    bool infer(const std::vector<types::ImageData>& batch,
+               std::vector<std::vector<Detection>>& candidates) override {
+        candidates.assign(batch.size(), {});
+        if (!m_loaded) {
+            m_lastError = "Model not loaded";
+            return false;
+        }
+        if (batch.empty()) {
+            return true;
+        }
+
+        try {
+            // 固定 batch=1 导出的模型不支持批量输入：首次失败后改为逐张推理
+            if (m_batchSupported && batch.size() > 1) {
+                try {
+                    runBatch(batch, 0, batch.size(), candidates);
+                    return true;
+                } catch (const cv::Exception&) {
+                    m_batchSupported = false;
+                }
+            }
+            for (size_t i = 0; i < batch.size(); ++i) {
+                runBatch(batch, i, 1, candidates);
+            }
+            return true;
+        } catch (const cv::Exception& e) {
+            m_lastError = std::string("Inference failed: ") + e.what();
+            return false;
+        }
+    }
+
+    std::string name() const override { return "opencv-dnn-cpu"; }
+    std::string getLastError() const override { return m_lastError; }
+
+private:
+    void runBatch(const std::vector<types::ImageData>& batch, size_t first, size_t count,
+                  std::vector<std::vector<Detection>>& candidates) {
+        m_inputs.clear();
+        for (size_t i = first; i < first + count; ++i) {
+            const auto& image = batch[i];
+            m_inputs.emplace_back(static_cast<int>(image.height), static_cast<int>(image.width), CV_8UC3,
+                                  const_cast<uint8_t*>(image.data.data()));
+        }
+
+        // 归一化到 [0,1]，BGR -> RGB
+        cv::dnn::blobFromImages(m_inputs, m_blob, 1.0 / 255.0, m_inputSize, cv::Scalar(), true, false);
+        m_net.setInput(m_blob);
+        cv::Mat output = m_net.forward();
+
+        // 输出为 [N, 通道, 锚点]（官方导出）或 [N, 锚点, 通道]（转置导出）
+        if (output.dims != 3 || output.size[0] != static_cast<int>(count)) {
+            CV_Error(cv::Error::StsUnmatchedSizes, "Unexpected detection output shape");
+        }
+        const int dim1 = output.size[1];
+        const int dim2 = output.size[2];
+        const bool channelsFirst = dim1 < dim2;
+        const int channels = channelsFirst ? dim1 : dim2;
+        const int anchors = channelsFirst ? dim2 : dim1;
+        const float* base = output.ptr<float>();
+        for (size_t i = 0; i < count; ++i) {
+            decodeYoloOutput(base + i * static_cast<size_t>(dim1) * dim2, channels, anchors,
+                             channelsFirst, m_confidenceThreshold, candidates[first + i]);
+        }
+    }
+
+    cv::dnn::Net m_net;
+    cv::Size m_inputSize{640, 640};
+    float m_confidenceThreshold{0.25f};
+    bool m_loaded{false};
+    bool m_batchSupported{true};
+    std::vector<cv::Mat> m_inputs;
+    cv::Mat m_blob;
+    std::string m_lastError;
+};
+
+} // namespace
+
+// ========== Detection ==========
+
+types::Rect Detection::toRect() const {
+    types::Rect rect;
+    rect.x = static_cast<int32_t>(std::floor(x1));
+    rect.y = static_cast<int32_t>(std::floor(y1));
+    rect.width = static_cast<uint32_t>(std::max(0.0f, std::ceil(x2) - std::floor(x1)));
+    rect.height = static_cast<uint32_t>(std::max(0.0f, std::ceil(y2) - std::floor(y1)));
+    return rect;
+}
+
+std::unique_ptr<DetectionBackend> DetectionBackend::createCpu() {
+    return std::make_unique<OpenCVDnnBackend>();
+}
+
+// ========== VisionLayer1 ==========
+
+VisionLayer1::VisionLayer1(VisionLayer1Config config, std::unique_ptr<DetectionBackend> backend)
+    : m_config(std::move(config))
+    , m_backend(backend ? std::move(backend) : DetectionBackend::createCpu())
+{
+}
+
+VisionLayer1::~VisionLayer1() = default;
+
+bool VisionLayer1::initialize() {
+    if (!m_backend->load(m_config)) {
+        m_lastError = m_backend->getLastError();
+        return false;
+    }
+    return true;
+}
+
+bool VisionLayer1::isInitialized() const {
+    return m_backend->isLoaded();
+}
+
+std::string VisionLayer1::getLastError() const {
+    return m_lastError;
+}
+
+VisionLayer1Result VisionLayer1::process(const types::ImageView& frame, const VisionLayer0Result& layer0) {
+    if (!layer0.shouldTriggerLayer1 || !frame.isValid()) {
+        return {};
+    }
+
+    // Layer 0 的区域位于处理分辨率下，换算到源图像坐标
+    const double sx = layer0.processingWidth > 0
+                          ? static_cast<double>(frame.width) / layer0.processingWidth : 1.0;
+    const double sy = layer0.processingHeight > 0
+                          ? static_cast<double>(frame.height) / layer0.processingHeight : 1.0;
+    std::vector<types::Rect> regions;
+    regions.reserve(layer0.changedRegions.size() + layer0.motionRegions.size());
+    for (const auto* list : {&layer0.changedRegions, &layer0.motionRegions}) {
+        for (const auto& r : *list) {
+            types::Rect scaled;
+            scaled.x = static_cast<int32_t>(std::floor(r.x * sx));
+            scaled.y = static_cast<int32_t>(std::floor(r.y * sy));
+            scaled.width = static_cast<uint32_t>(std::ceil(r.width * sx));
+            scaled.height = static_cast<uint32_t>(std::ceil(r.height * sy));
+            regions.push_back(scaled);
+        }
+    }
+
+    // 触发但没有区域（如整体色彩变化）：检测整帧
+    return detect(frame, regions);
+}
+
+std::vector<types::Rect> VisionLayer1::planRegions(const std::vector<types::Rect>& regions,
+                                                   uint32_t frameWidth, uint32_t frameHeight) const {
+    std::vector<types::Rect> expanded;
+    if (frameWidth == 0 || frameHeight == 0) {
+        return expanded;
+    }
+    types::Rect fullFrame;
+    fullFrame.width = frameWidth;
+    fullFrame.height = frameHeight;
+
+    expanded.reserve(regions.size());
+    for (const auto& r : regions) {
+        if (!r.isValid()) {
+            continue;
+        }
+        // 按比例向外扩展，并保证最小边长（以区域中心为基准）
+        const double pad = std::max(r.width, r.height) * m_config.regionPadding;
+        const double w = std::max<double>(r.width + 2.0 * pad, m_config.minRegionSize);
+        const double h = std::max<double>(r.height + 2.0 * pad, m_config.minRegionSize);
+        const double cx = r.x + r.width / 2.0;
+        const double cy = r.y + r.height / 2.0;
+        const int64_t x0 = std::clamp<int64_t>(static_cast<int64_t>(std::floor(cx - w / 2.0)), 0, frameWidth);
+        const int64_t y0 = std::clamp<int64_t>(static_cast<int64_t>(std::floor(cy - h / 2.0)), 0, frameHeight);
+        const int64_t x1 = std::clamp<int64_t>(static_cast<int64_t>(std::ceil(cx + w / 2.0)), 0, frameWidth);
+        const int64_t y1 = std::clamp<int64_t>(static_cast<int64_t>(std::ceil(cy + h / 2.0)), 0, frameHeight);
+        if (x1 <= x0 || y1 <= y0) {
+            continue;
+        }
+        types::Rect rect;
+        rect.x = static_cast<int32_t>(x0);
+        rect.y = static_cast<int32_t>(y0);
+        rect.width = static_cast<uint32_t>(x1 - x0);
+        rect.height = static_cast<uint32_t>(y1 - y0);
+        expanded.push_back(rect);
+    }
+
+    // 合并重叠区域（同尺寸映射只做合并）
+    auto merged = VisionKernels::mapRegions(expanded, frameWidth, frameHeight, frameWidth, frameHeight, 0);
+    if (merged.empty()) {
+        return merged;
+    }
+
+    uint64_t area = 0;
+    for (const auto& r : merged) {
+        area += static_cast<uint64_t>(r.width) * r.height;
+    }
+    const double frameArea = static_cast<double>(frameWidth) * frameHeight;
+    if (merged.size() > m_config.maxRegions || area > m_config.fullFrameRatio * frameArea) {
+        return {fullFrame};
+    }
+    return merged;
+}
+
+VisionLayer1Result VisionLayer1::detect(const types::ImageView& frame, const std::vector<types::Rect>& regions) {
+    VisionLayer1Result result;
+    if (!frame.isValid()) {
+        m_lastError = "Invalid frame";
+        return result;
+    }
+    if (!m_backend->isLoaded()) {
+        m_lastError = "Detection backend not initialized";
+        return result;
+    }
+
+    result.analyzedRegions = planRegions(regions, frame.width, frame.height);
+    if (result.analyzedRegions.empty()) {
+        types::Rect fullFrame;
+        fullFrame.width = frame.width;
+        fullFrame.height = frame.height;
+        result.analyzedRegions.push_back(fullFrame);
+    }
+
+    struct Mapping {
+        types::Rect roi;
+        double scale{1.0};
+        uint32_t padX{0};
+        uint32_t padY{0};
+    };
+    std::vector<Mapping> mappings;
+    const size_t batchSize = std::max<uint32_t>(1, m_config.maxBatchSize);
+
+    for (size_t begin = 0; begin < result.analyzedRegions.size(); begin += batchSize) {
+        const size_t end = std::min(result.analyzedRegions.size(), begin + batchSize);
+
+        // 预处理：裁剪（零拷贝视图）+ 信箱缩放到模型尺寸
+        auto start = Clock::now();
+        m_batch.clear();
+        mappings.clear();
+        for (size_t i = begin; i < end; ++i) {
+            const auto& roi = result.analyzedRegions[i];
+            auto boxed = ImageProcessor::letterbox(
+                frame.subView(roi.x, roi.y, roi.width, roi.height),
+                m_config.inputWidth, m_config.inputHeight);
+            if (!boxed) {
+                continue;
+            }
+            mappings.push_back({roi, boxed->scale, boxed->padX, boxed->padY});
+            m_batch.push_back(std::move(boxed->image));
+        }
+        result.preprocessMs += elapsedMs(start);
+        if (m_batch.empty()) {
+            continue;
+        }
+
+        // 推理
+        start = Clock::now();
+        if (!m_backend->infer(m_batch, m_candidates)) {
+            m_lastError = m_backend->getLastError();
+            result.inferenceMs += elapsedMs(start);
+            continue;
+        }
+        result.inferenceMs += elapsedMs(start);
+        ++result.batches;
+
+        // 模型坐标 -> 源图像坐标
+        start = Clock::now();
+        for (size_t i = 0; i < mappings.size() && i < m_candidates.size(); ++i) {
+            const Mapping& m = mappings[i];
+            const float inv = static_cast<float>(1.0 / m.scale);
+            const float maxX = static_cast<float>(m.roi.x + static_cast<int32_t>(m.roi.width));
+            const float maxY = static_cast<float>(m.roi.y + static_cast<int32_t>(m.roi.height));
+            for (auto& det : m_candidates[i]) {
+                det.x1 = std::clamp((det.x1 - m.padX) * inv + m.roi.x, static_cast<float>(m.roi.x), maxX);
+                det.y1 = std::clamp((det.y1 - m.padY) * inv + m.roi.y, static_cast<float>(m.roi.y), maxY);
+                det.x2 = std::clamp((det.x2 - m.padX) * inv + m.roi.x, static_cast<float>(m.roi.x), maxX);
+                det.y2 = std::clamp((det.y2 - m.padY) * inv + m.roi.y, static_cast<float>(m.roi.y), maxY);
+                if (det.x2 > det.x1 && det.y2 > det.y1) {
+                    result.detections.push_back(std::move(det));
+                }
+            }
+        }
+        result.postprocessMs += elapsedMs(start);
+    }
+
+    // 相邻区域的结果可能重复，统一做 NMS
+    const auto start = Clock::now();
+    nonMaxSuppression(result.detections, m_config.nmsThreshold, m_config.maxDetections);
+    for (auto& det : result.detections) {
+        if (det.classId >= 0 && static_cast<size_t>(det.classId) < m_config.classNames.size()) {
+            det.label = m_config.classNames[static_cast<size_t>(det.classId)];
+        }
+    }
+    result.postprocessMs += elapsedMs(start);
+    result.ran = result.batches > 0;
+    return result;
+}
+
+void VisionLayer1::nonMaxSuppression(std::vector<Detection>& detections,
+                                     float iouThreshold,
+                                     size_t maxDetections) {
+    const size_t n = detections.size();
+    if (n == 0) {
+        return;
+    }
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return detections[a].score > detections[b].score;
+    });
+
+    // 不同类别的框按类别平移到互不重叠的位置，一次遍历完成按类别的 NMS
+    float extent = 0.0f;
+    for (const auto& det : detections) {
+        extent = std::max({extent, std::abs(det.x1), std::abs(det.y1), std::abs(det.x2), std::abs(det.y2)});
+    }
+    const float classOffset = 2.0f * extent + 1.0f;
+
+    // 结构数组（SoA）：IoU 内层循环访问连续内存、无分支，编译器可以向量化
+    std::vector<float> x1(n), y1(n), x2(n), y2(n), area(n);
+    for (size_t k = 0; k < n; ++k) {
+        const Detection& det = detections[order[k]];
+        const float offset = static_cast<float>(std::max(det.classId, 0)) * classOffset;
+        x1[k] = det.x1 + offset;
+        y1[k] = det.y1 + offset;
+        x2[k] = det.x2 + offset;
+        y2[k] = det.y2 + offset;
+        area[k] = std::max(0.0f, det.x2 - det.x1) * std::max(0.0f, det.y2 - det.y1);
+    }
+
+    std::vector<uint8_t> suppressed(n, 0);
+    std::vector<Detection> kept;
+    kept.reserve(std::min(n, maxDetections > 0 ? maxDetections : n));
+    for (size_t i = 0; i < n; ++i) {
+        if (suppressed[i]) {
+            continue;
+        }
+        kept.push_back(std::move(detections[order[i]]));
+        if (maxDetections > 0 && kept.size() >= maxDetections) {
+            break;
+        }
+        const float bx1 = x1[i];
+        const float by1 = y1[i];
+        const float bx2 = x2[i];
+        const float by2 = y2[i];
+        const float barea = area[i];
+        for (size_t j = i + 1; j < n; ++j) {
+            const float w = std::max(0.0f, std::min(bx2, x2[j]) - std::max(bx1, x1[j]));
+            const float h = std::max(0.0f, std::min(by2, y2[j]) - std::max(by1, y1[j]));
+            const float inter = w * h;
+            // inter / union > threshold，改写为乘法避免除零
+            suppressed[j] |= static_cast<uint8_t>(inter > iouThreshold * (barea + area[j] - inter));
+        }
+    }
+    detections = std::move(kept);
+}
+
+} // namespace naw::desktop_pet::service
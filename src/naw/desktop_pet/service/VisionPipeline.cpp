@@ -0,0 +1,310 @@
+#include "naw/desktop_pet/service/VisionPipeline.h"
+
+#include <algorithm>
+
+namespace naw::desktop_pet::service {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr double kLatencySmoothing = 0.1;  // 耗时滑动平均系数
+
+double toMs(Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+void smooth(std::atomic<double>& average, double sample, bool first) {
+    const double current = average.load(std::memory_order_relaxed);
+    average.store(first ? sample : current + kLatencySmoothing * (sample - current),
+                  std::memory_order_relaxed);
+}
+
+bool hasResolutionControl(const ImageProcessor::ResolutionConfig& config) {
+    return config.maxWidth || config.maxHeight || config.targetWidth || config.targetHeight ||
+           config.adaptive;
+}
+
+} // namespace
+
+void VisionPipeline::StageState::record(Clock::duration elapsed) {
+    const double ms = toMs(elapsed);
+    const bool first = processed.fetch_add(1, std::memory_order_relaxed) == 0;
+    lastMs.store(ms, std::memory_order_relaxed);
+    smooth(averageMs, ms, first);
+    if (ms > maxMs.load(std::memory_order_relaxed)) {
+        maxMs.store(ms, std::memory_order_relaxed);
+    }
+}
+
+VisionPipeline::VisionPipeline(VisionPipelineConfig config, VisionPipelineStages stages)
+    : m_config(std::move(config))
+    , m_stages(std::move(stages))
+    , m_layer0(m_config.layer0)
+    , m_scheduler(m_config.scheduler)
+{
+    for (auto& inbox : m_inboxes) {
+        inbox = std::make_unique<StageInbox>(std::max<size_t>(1, m_config.queueCapacity));
+    }
+}
+
+std::unique_ptr<VisionPipeline> VisionPipeline::createForScreen(ScreenCapture& capture,
+                                                                VisionPipelineConfig config,
+                                                                int32_t displayId) {
+    VisionPipelineStages stages;
+    stages.capture = [&capture, displayId]() { return capture.captureFullScreen(displayId); };
+    return std::make_unique<VisionPipeline>(std::move(config), std::move(stages));
+}
+
+VisionPipeline::~VisionPipeline() {
+    stop();
+}
+
+void VisionPipeline::setFrameCallback(FrameCallback callback) {
+    m_callback = std::move(callback);
+}
+
+bool VisionPipeline::start() {
+    if (!m_stages.capture || m_running.exchange(true)) {
+        return false;
+    }
+    m_threads.emplace_back(&VisionPipeline::captureLoop, this);
+    m_threads.emplace_back(&VisionPipeline::stageLoop, this, VisionStage::Preprocess);
+    m_threads.emplace_back(&VisionPipeline::stageLoop, this, VisionStage::Analyze);
+    m_threads.emplace_back(&VisionPipeline::stageLoop, this, VisionStage::Encode);
+    return true;
+}
+
+void VisionPipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_stopMutex);
+        if (!m_running.exchange(false)) {
+            return;
+        }
+    }
+    m_stopCv.notify_all();
+    for (auto& inbox : m_inboxes) {
+        inbox->signal.fetch_add(1, std::memory_order_release);
+        inbox->signal.notify_all();
+    }
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    m_threads.clear();
+
+    // 丢弃未处理的帧（此时没有其他线程访问队列）
+    VisionFrame discarded;
+    for (auto& inbox : m_inboxes) {
+        while (inbox->queue.tryPop(discarded)) {
+        }
+    }
+}
+
+VisionPipeline::Metrics VisionPipeline::getMetrics() const {
+    Metrics metrics;
+    for (size_t i = 0; i < kVisionStageCount; ++i) {
+        const StageState& state = m_stageStates[i];
+        StageMetrics& out = metrics.stages[i];
+        out.processed = state.processed.load(std::memory_order_relaxed);
+        out.dropped = state.dropped.load(std::memory_order_relaxed);
+        out.failed = state.failed.load(std::memory_order_relaxed);
+        out.lastMs = state.lastMs.load(std::memory_order_relaxed);
+        out.averageMs = state.averageMs.load(std::memory_order_relaxed);
+        out.maxMs = state.maxMs.load(std::memory_order_relaxed);
+        out.queueDepth = i == 0 ? 0 : m_inboxes[i - 1]->queue.size();
+    }
+    metrics.completedFrames = m_completedFrames.load(std::memory_order_relaxed);
+    metrics.endToEndMs = m_endToEndMs.load(std::memory_order_relaxed);
+    metrics.scheduler = m_scheduler.getStats();
+    return metrics;
+}
+
+const char* VisionPipeline::stageName(VisionStage stage) {
+    switch (stage) {
+        case VisionStage::Capture: return "capture";
+        case VisionStage::Preprocess: return "preprocess";
+        case VisionStage::Analyze: return "analyze";
+        case VisionStage::Encode: return "encode";
+    }
+    return "unknown";
+}
+
+// ========== 阶段线程 ==========
+
+void VisionPipeline::captureLoop() {
+    StageState& state = m_stageStates[static_cast<size_t>(VisionStage::Capture)];
+    uint64_t sequence = 0;
+    Clock::time_point nextCapture = Clock::now();
+
+    while (m_running.load(std::memory_order_acquire)) {
+        {
+            std::unique_lock<std::mutex> lock(m_stopMutex);
+            m_stopCv.wait_until(lock, nextCapture, [this]() {
+                return !m_running.load(std::memory_order_acquire);
+            });
+        }
+        if (!m_running.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        // 下一次采集：按调度器的目标帧率计时；调度器因 CPU 预算推迟时以其时间为准
+        const Clock::time_point start = Clock::now();
+        const auto interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / std::max(m_scheduler.targetFps(), 1e-3)));
+        nextCapture = std::max(start + interval, m_scheduler.nextFrameTime());
+
+        VisionFrame frame;
+        frame.options = m_scheduler.planFrame();
+        auto image = m_stages.capture();
+        const Clock::time_point end = Clock::now();
+        if (!image || !image->isValid()) {
+            state.failed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        state.record(end - start);
+        frame.sequence = ++sequence;
+        frame.capturedAt = end;
+        frame.image = std::move(*image);
+        frame.stageLatency[static_cast<size_t>(VisionStage::Capture)] = end - start;
+        forward(VisionStage::Capture, std::move(frame));
+    }
+}
+
+void VisionPipeline::stageLoop(VisionStage stage) {
+    const size_t index = static_cast<size_t>(stage);
+    StageInbox& inbox = *m_inboxes[index - 1];
+    StageState& state = m_stageStates[index];
+    VisionFrame frame;
+
+    while (true) {
+        // 先读取信号再检查队列，避免入队与等待之间的唤醒丢失
+        const uint32_t signal = inbox.signal.load(std::memory_order_acquire);
+        if (!popFrame(inbox, state, frame)) {
+            if (!m_running.load(std::memory_order_acquire)) {
+                break;
+            }
+            inbox.signal.wait(signal, std::memory_order_acquire);
+            continue;
+        }
+
+        const Clock::time_point start = Clock::now();
+        const bool ok = runStage(stage, frame);
+        const Clock::time_point end = Clock::now();
+        frame.stageLatency[index] = end - start;
+        if (!ok) {
+            state.failed.fetch_add(1, std::memory_order_relaxed);
+            // 编码失败不影响分析结果，帧仍然交给回调；其他阶段失败则丢弃该帧
+            if (stage != VisionStage::Encode) {
+                continue;
+            }
+        } else {
+            state.record(end - start);
+        }
+
+        if (stage == VisionStage::Encode) {
+            finishFrame(std::move(frame));
+        } else {
+            forward(stage, std::move(frame));
+        }
+    }
+}
+
+bool VisionPipeline::popFrame(StageInbox& inbox, StageState& state, VisionFrame& frame) {
+    if (!inbox.queue.tryPop(frame)) {
+        return false;
+    }
+    if (m_config.dropPolicy == FrameDropPolicy::KeepLatest) {
+        // 跳过积压的旧帧，只处理最新的一帧
+        while (inbox.queue.tryPop(frame)) {
+            state.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+void VisionPipeline::forward(VisionStage from, VisionFrame&& frame) {
+    const size_t next = static_cast<size_t>(from) + 1;
+    StageInbox& inbox = *m_inboxes[next - 1];
+    if (!inbox.queue.tryPush(std::move(frame))) {
+        // 下游处理不过来：丢弃新帧，当前阶段从不阻塞
+        m_stageStates[next].dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    inbox.signal.fetch_add(1, std::memory_order_release);
+    inbox.signal.notify_one();
+}
+
+void VisionPipeline::finishFrame(VisionFrame&& frame) {
+    const Clock::time_point now = Clock::now();
+    const bool first = m_completedFrames.fetch_add(1, std::memory_order_relaxed) == 0;
+    smooth(m_endToEndMs, toMs(now - frame.capturedAt), first);
+
+    // 整帧耗时（各阶段之和）反馈给调度器，用于帧率与 CPU 预算控制
+    Clock::duration total{};
+    for (const auto& latency : frame.stageLatency) {
+        total += latency;
+    }
+    if (frame.layer0) {
+        m_scheduler.recordFrame(*frame.layer0, total, frame.options, now);
+    }
+    if (m_callback) {
+        m_callback(std::move(frame));
+    }
+}
+
+// ========== 阶段实现 ==========
+
+bool VisionPipeline::runStage(VisionStage stage, VisionFrame& frame) {
+    switch (stage) {
+        case VisionStage::Preprocess:
+            if (m_stages.preprocess) {
+                return m_stages.preprocess(frame);
+            }
+            if (hasResolutionControl(m_config.resolution)) {
+                auto processed = ImageProcessor::applyResolutionControl(frame.image, m_config.resolution);
+                if (!processed) {
+                    return false;
+                }
+                frame.processed = std::move(*processed);
+            }
+            return true;
+
+        case VisionStage::Analyze:
+            if (m_stages.analyze) {
+                return m_stages.analyze(frame);
+            }
+            frame.layer0 = m_layer0.processFrame(
+                types::ImageView::fromImageData(frame.workingImage()), frame.options);
+            return true;
+
+        case VisionStage::Encode: {
+            const bool triggered = frame.layer0 && frame.layer0->shouldTriggerLayer1;
+            if (!m_config.enableEncode || (m_config.encodeOnlyOnTrigger && !triggered)) {
+                return true;
+            }
+            if (m_stages.encode) {
+                return m_stages.encode(frame);
+            }
+            ImageProcessor::EncodeOptions options;
+            options.quality = m_config.jpegQuality;
+            options.maxBytes = m_config.maxEncodedBytes;
+            // 每帧都是新对象且编码结果随帧交给回调，帧上没有可复用的缓冲：
+            // 先编码到本阶段常驻的缓冲（容量跨帧保留，编码过程不再逐步扩容），再按实际大小复制给帧
+            if (!ImageProcessor::encode(types::ImageView::fromImageData(frame.workingImage()), options,
+                                        m_encodeBuffer)) {
+                frame.encoded.reset();
+                return false;
+            }
+            frame.encoded.emplace(m_encodeBuffer.begin(), m_encodeBuffer.end());
+            return true;
+        }
+
+        case VisionStage::Capture:
+            break;
+    }
+    return false;
+}
+
+} // namespace naw::desktop_pet::service
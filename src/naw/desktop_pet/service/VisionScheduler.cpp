@@ -0,0 +1,166 @@
+#include "naw/desktop_pet/service/VisionScheduler.h"
+
+#include <algorithm>
+
+namespace naw::desktop_pet::service {
+
+namespace {
+
+constexpr double kCostSmoothing = 0.2;        // 单帧耗时滑动平均系数
+constexpr auto kCostWindow = std::chrono::seconds(1);
+
+std::chrono::nanoseconds intervalFor(double fps) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(1e9 / std::max(fps, 1e-3)));
+}
+
+} // namespace
+
+VisionScheduler::VisionScheduler(VisionSchedulerConfig config) : m_config(config) {
+    updateTargetFpsLocked();
+}
+
+void VisionScheduler::setConfig(const VisionSchedulerConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    updateTargetFpsLocked();
+}
+
+VisionSchedulerConfig VisionScheduler::getConfig() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_config;
+}
+
+VisionScheduler::Clock::time_point VisionScheduler::nextFrameTime() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nextFrameTime;
+}
+
+bool VisionScheduler::shouldProcess(Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_hasFrame || now >= m_nextFrameTime;
+}
+
+VisionLayer0FrameOptions VisionScheduler::planFrame() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    VisionLayer0FrameOptions options;
+    // 低帧率时每帧都做光流（帧间隔长，抽帧会丢失运动）；高帧率时按间隔抽帧
+    const bool active = m_targetFps > (m_config.idleFps + m_config.activeFps) / 2.0;
+    const uint64_t motionInterval = active ? std::max<uint32_t>(1, m_config.motionInterval) : 1;
+    options.runMotionDetection = m_framesSinceMotion + 1 >= motionInterval;
+    options.runDominantColor =
+        !m_hasFrame || m_framesSinceDominantColor + 1 >= std::max<uint32_t>(1, m_config.dominantColorInterval);
+    return options;
+}
+
+void VisionScheduler::recordFrame(const VisionLayer0Result& result,
+                                  Clock::duration processingTime,
+                                  const VisionLayer0FrameOptions& options,
+                                  Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_processedFrames;
+
+    // 评分：上升时立即跟随（尽快提高帧率），下降时平滑回落
+    const double score = std::clamp(result.overallChangeScore, 0.0, 1.0);
+    if (score >= m_smoothedScore) {
+        m_smoothedScore = score;
+    } else {
+        m_smoothedScore += std::clamp(m_config.scoreDecay, 0.0, 1.0) * (score - m_smoothedScore);
+    }
+
+    // 耗时统计
+    const double ms = std::chrono::duration<double, std::milli>(processingTime).count();
+    m_averageFrameMs = m_hasFrame ? m_averageFrameMs + kCostSmoothing * (ms - m_averageFrameMs) : ms;
+    m_recentCosts.push_back({now, ms});
+    while (!m_recentCosts.empty() && now - m_recentCosts.front().finishedAt >= kCostWindow) {
+        m_recentCosts.pop_front();
+    }
+
+    if (options.runMotionDetection) {
+        ++m_motionFrames;
+        m_framesSinceMotion = 0;
+    } else {
+        ++m_framesSinceMotion;
+    }
+    if (options.runDominantColor) {
+        ++m_dominantColorFrames;
+        m_framesSinceDominantColor = 0;
+    } else {
+        ++m_framesSinceDominantColor;
+    }
+
+    m_hasFrame = true;
+    updateTargetFpsLocked();
+    m_nextFrameTime = now + std::chrono::duration_cast<Clock::duration>(intervalFor(m_targetFps));
+
+    // 最近一秒的实际耗时已超出预算（如突发的慢帧）：等到最早一帧移出窗口后再处理
+    if (m_config.cpuBudgetMsPerSecond > 0.0) {
+        double windowMs = 0.0;
+        for (const auto& cost : m_recentCosts) {
+            windowMs += cost.ms;
+        }
+        if (windowMs > m_config.cpuBudgetMsPerSecond) {
+            m_nextFrameTime = std::max(m_nextFrameTime, m_recentCosts.front().finishedAt + kCostWindow);
+            m_budgetLimited = true;
+        }
+    }
+}
+
+double VisionScheduler::targetFps() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_targetFps;
+}
+
+VisionScheduler::Stats VisionScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.processedFrames = m_processedFrames;
+    stats.motionFrames = m_motionFrames;
+    stats.dominantColorFrames = m_dominantColorFrames;
+    stats.targetFps = m_targetFps;
+    stats.smoothedScore = m_smoothedScore;
+    stats.averageFrameMs = m_averageFrameMs;
+    for (const auto& cost : m_recentCosts) {
+        stats.cpuMsPerSecond += cost.ms;
+    }
+    stats.budgetLimited = m_budgetLimited;
+    return stats;
+}
+
+void VisionScheduler::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_smoothedScore = 0.0;
+    m_averageFrameMs = 0.0;
+    m_framesSinceMotion = 0;
+    m_framesSinceDominantColor = 0;
+    m_hasFrame = false;
+    m_nextFrameTime = {};
+    m_recentCosts.clear();
+    updateTargetFpsLocked();
+}
+
+void VisionScheduler::updateTargetFpsLocked() {
+    const double idleFps = std::max(m_config.idleFps, 1e-3);
+    const double activeFps = std::max(m_config.activeFps, idleFps);
+
+    // 评分在 [idleScore, activeScore] 之间时线性插值
+    double fps = idleFps;
+    if (m_smoothedScore >= m_config.activeScore) {
+        fps = activeFps;
+    } else if (m_smoothedScore > m_config.idleScore) {
+        const double t = (m_smoothedScore - m_config.idleScore) / (m_config.activeScore - m_config.idleScore);
+        fps = idleFps + t * (activeFps - idleFps);
+    }
+
+    // CPU预算：帧率 * 单帧耗时 不超过每秒预算
+    m_budgetLimited = false;
+    if (m_config.cpuBudgetMsPerSecond > 0.0 && m_averageFrameMs > 0.0) {
+        const double budgetFps = m_config.cpuBudgetMsPerSecond / m_averageFrameMs;
+        if (budgetFps < fps) {
+            fps = std::max(budgetFps, std::min(m_config.minFps, fps));
+            m_budgetLimited = true;
+        }
+    }
+    m_targetFps = fps;
+}
+
+} // namespace naw::desktop_pet::service
@@ -33,6 +33,7 @@ using naw::desktop_pet::service::types::ChatRequest;
 using naw::desktop_pet::service::types::MessageRole;
 using naw::desktop_pet::service::utils::AudioFormat;
 using naw::desktop_pet::service::utils::AudioProcessor;
+using naw::desktop_pet::service::utils::CapturedBuffer;
 using naw::desktop_pet::service::utils::CaptureOptions;
 using naw::desktop_pet::service::utils::HttpClient;
 using naw::desktop_pet::service::utils::VADCallbacks;
@@ -187,7 +188,7 @@ static bool readLineUtf8(std::string& out) { return static_cast<bool>(std::getli
 #endif
 
 struct SegmentJob {
-    std::string wavPath;
+    CapturedBuffer clip; // VAD 片段（内存 PCM，不落盘）
 };
 
 class SegmentQueue {
@@ -843,15 +844,19 @@ static std::optional<std::uint32_t> ttsPcmStreamToPlayback(const TtsConfig& tts,
     return soundId;
 }
 
-static std::optional<std::string> transcribeWavViaOpenAICompatible(const SttConfig& stt,
-                                                                  const std::string& wavPath,
+static std::optional<std::string> transcribePcmViaOpenAICompatible(const SttConfig& stt,
+                                                                  const CapturedBuffer& clip,
                                                                   std::string* errOut) {
-    std::string readErr;
-    auto wavData = readFileToString(wavPath, &readErr);
-    if (!wavData) {
-        if (errOut) *errOut = readErr;
+    // WAV 头在内存中生成，PCM 直接接入 multipart 正文
+    HttpClient::MultipartFile file;
+    file.filename = "segment.wav";
+    file.contentType = "audio/wav";
+    file.data = AudioProcessor::wavHeader(clip.stream, clip.data.size());
+    if (file.data.empty() || clip.data.empty()) {
+        if (errOut) *errOut = "invalid VAD segment";
         return std::nullopt;
     }
+    file.chunks.emplace_back(reinterpret_cast<const char*>(clip.data.data()), clip.data.size());
 
     HttpClient client(stt.baseUrl);
     std::map<std::string, std::string> headers;
@@ -863,11 +868,6 @@ static std::optional<std::string> transcribeWavViaOpenAICompatible(const SttConf
         fields["language"] = *stt.language;
     }
 
-    HttpClient::MultipartFile file;
-    file.filename = std::filesystem::path(wavPath).filename().string();
-    file.contentType = "audio/wav";
-    file.data = std::move(*wavData);
-
     std::map<std::string, HttpClient::MultipartFile> files;
     files["file"] = std::move(file);
 
@@ -990,13 +990,17 @@ int main() {
     std::thread worker([&] {
         SegmentJob job;
         std::optional<std::uint32_t> ttsStreamId;
-        // 播放门控标志在主线程 cbs.onComplete 中也会读取，所以使用外层共享变量（在 main 中定义）
+        // 播放门控标志在cbs.onSegment 中也会读取，所以使用外层共享变量（在 main 中定义）
         while (jobs.popWait(job)) {
             if (!running.load()) break;
 
             std::string sttErr;
-            auto sttText = transcribeWavViaOpenAICompatible(*sttCfg, job.wavPath, &sttErr);
+            auto sttText = transcribePcmViaOpenAICompatible(*sttCfg, job.clip, &sttErr);
             if (!sttText || sttText->empty()) {
+                // 识别成功但没有文字：VAD 误触发，计入统计
+                if (sttText) {
+                    audio.reportFalseTrigger();
+                }
 #if defined(_WIN32)
                 stderrWriter().write("\n[STT ERROR] ");
                 stderrWriter().write(sttErr);
@@ -1005,8 +1009,6 @@ int main() {
 #else
                 std::cerr << "\n[STT ERROR] " << sttErr << "\n";
 #endif
-                // 清理录音文件（避免堆积）
-                audio.removeVadFile(job.wavPath);
                 continue;
             }
 
@@ -1051,7 +1053,6 @@ int main() {
 #else
                 std::cerr << "\n[LLM1 ERROR] " << llm1Err << "\n";
 #endif
-                audio.removeVadFile(job.wavPath);
                 continue;
             }
 
@@ -1070,7 +1071,6 @@ int main() {
                           << " confidence=" << filterRes->confidence << "\n";
                 std::cout << "\n(ignored)\n" << std::flush;
 #endif
-                audio.removeVadFile(job.wavPath);
                 continue;
             }
 
@@ -1086,7 +1086,6 @@ int main() {
                 std::cerr << "\n[LLM1] ignored due to low confidence\n";
                 std::cout << "\n(ignored: low confidence)\n" << std::flush;
 #endif
-                audio.removeVadFile(job.wavPath);
                 continue;
             }
 
@@ -1102,7 +1101,6 @@ int main() {
                 std::cerr << "\n[LLM1] ignored due to too-short input\n";
                 std::cout << "\n(ignored: too short)\n" << std::flush;
 #endif
-                audio.removeVadFile(job.wavPath);
                 continue;
             }
 
@@ -1120,7 +1118,6 @@ int main() {
                 std::cerr << "\n[LLM1] ignored due to cooldown\n";
                 std::cout << "\n(ignored: cooldown)\n" << std::flush;
 #endif
-                audio.removeVadFile(job.wavPath);
                 continue;
             }
 
@@ -1243,9 +1240,6 @@ int main() {
                 lastPetResponse = std::chrono::steady_clock::now();
             }
 
-            // 清理本段录音文件
-            audio.removeVadFile(job.wavPath);
-
 #if defined(_WIN32)
             stdoutWriter().write("\n\n(continue speaking...)\n");
             stdoutWriter().flush();
@@ -1266,7 +1260,6 @@ int main() {
     vad.startHoldMs = 200;
     vad.stopHoldMs = 600;
     vad.maxBufferSeconds = 10.0f;
-    vad.outputWavPath = "vad_voice_chat.wav";
 
     VADCallbacks cbs{};
     cbs.onTrigger = [] {
@@ -1278,18 +1271,17 @@ int main() {
 #endif
     };
     // 回声门控：不暂停录音/VAD，只在“播放期间+尾音窗口”丢弃片段，避免桌宠自己说话触发 STT→LLM 自激。
-    // 注意：由于 onComplete 在 AudioProcessor 内部线程触发，这里仅做轻量判断与删除。
-    cbs.onComplete = [&](const std::string& path) {
+    // 注意：由于 onSegment 在 AudioProcessor 内部线程触发，这里仅做轻量判断。
+    cbs.onSegment = [&](const CapturedBuffer& clip) {
         const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
                                std::chrono::steady_clock::now().time_since_epoch())
                                .count();
         const auto until = ignoreUntilMs.load(std::memory_order_acquire);
         const bool active = playbackActive.load(std::memory_order_acquire);
         if (active || nowMs < until) {
-            audio.removeVadFile(path);
             return;
         }
-        jobs.push(SegmentJob{path});
+        jobs.push(SegmentJob{clip});
     };
 
     if (!audio.startPassiveListening(vad, cap, cbs)) {
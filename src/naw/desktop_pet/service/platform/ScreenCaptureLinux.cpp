@@ -0,0 +1,692 @@
+#include "naw/desktop_pet/service/platform/ScreenCaptureLinux.h"
+#include "naw/desktop_pet/service/ImageProcessor.h"
+
+#ifdef __linux__
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#ifdef NAW_HAS_XDAMAGE
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#endif
+
+#ifdef NAW_HAS_XRANDR
+#include <X11/extensions/Xrandr.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace naw::desktop_pet::service::platform {
+
+namespace {
+
+// ========== X错误捕获 ==========
+
+// Xlib默认的错误处理会直接退出进程；可能失败的请求期间临时替换为记录错误码
+int g_trappedErrorCode = 0;
+
+int trapXError(Display*, XErrorEvent* event) {
+    g_trappedErrorCode = event->error_code;
+    return 0;
+}
+
+/**
+ * @brief 在作用域内捕获X错误（调用方需持有采集锁）
+ */
+class XErrorTrap {
+public:
+    explicit XErrorTrap(Display* display) : display_(display) {
+        XSync(display_, False);
+        g_trappedErrorCode = 0;
+        previous_ = XSetErrorHandler(trapXError);
+    }
+
+    ~XErrorTrap() {
+        if (!finished_) {
+            finish();
+        }
+    }
+
+    XErrorTrap(const XErrorTrap&) = delete;
+    XErrorTrap& operator=(const XErrorTrap&) = delete;
+
+    /**
+     * @brief 同步并恢复原错误处理
+     * @return 捕获到的错误码（0表示没有错误）
+     */
+    int finish() {
+        XSync(display_, False);
+        XSetErrorHandler(previous_);
+        finished_ = true;
+        return g_trappedErrorCode;
+    }
+
+private:
+    Display* display_;
+    XErrorHandler previous_{nullptr};
+    bool finished_{false};
+};
+
+/**
+ * @brief 检查XImage是否为小端32位BGRX布局
+ */
+bool isBGRX(const XImage* image) {
+    return image->bits_per_pixel == 32 && image->byte_order == LSBFirst &&
+           image->red_mask == 0xFF0000 && image->green_mask == 0x00FF00 && image->blue_mask == 0x0000FF;
+}
+
+types::ImageView viewOf(const XImage* image) {
+    return types::ImageView(reinterpret_cast<const uint8_t*>(image->data),
+                            static_cast<uint32_t>(image->width),
+                            static_cast<uint32_t>(image->height),
+                            types::ImageFormat::BGRA,
+                            static_cast<uint32_t>(image->bytes_per_line));
+}
+
+/**
+ * @brief 把视图复制为连续存储的ImageData
+ */
+types::ImageData copyToImageData(const types::ImageView& view) {
+    types::ImageData image;
+    image.allocate(view.width, view.height, view.format);
+    const size_t rowBytes = view.rowBytes();
+    for (uint32_t y = 0; y < view.height; ++y) {
+        std::memcpy(image.data.data() + y * rowBytes, view.row(y), rowBytes);
+    }
+    return image;
+}
+
+/**
+ * @brief 把区域裁剪到边界内（结果为空时宽高为0）
+ */
+types::Rect intersect(const types::Rect& a, const types::Rect& b) {
+    const int64_t x0 = std::max<int64_t>(a.x, b.x);
+    const int64_t y0 = std::max<int64_t>(a.y, b.y);
+    const int64_t x1 = std::min<int64_t>(int64_t{a.x} + a.width, int64_t{b.x} + b.width);
+    const int64_t y1 = std::min<int64_t>(int64_t{a.y} + a.height, int64_t{b.y} + b.height);
+    types::Rect result;
+    if (x1 > x0 && y1 > y0) {
+        result.x = static_cast<int32_t>(x0);
+        result.y = static_cast<int32_t>(y0);
+        result.width = static_cast<uint32_t>(x1 - x0);
+        result.height = static_cast<uint32_t>(y1 - y0);
+    }
+    return result;
+}
+
+bool sameRect(const types::Rect& a, const types::Rect& b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+// 应用图像处理选项的辅助函数（与Windows实现一致，只做分辨率控制）
+std::optional<types::ImageData> applyImageProcessing(
+    std::optional<types::ImageData> image,
+    const CaptureOptions& options
+) {
+    if (!image.has_value() || !image->isValid()) {
+        return image;
+    }
+
+    ImageProcessor::ResolutionConfig resolutionConfig;
+    resolutionConfig.maxWidth = options.maxWidth;
+    resolutionConfig.maxHeight = options.maxHeight;
+    resolutionConfig.targetWidth = options.targetWidth;
+    resolutionConfig.targetHeight = options.targetHeight;
+    resolutionConfig.keepAspectRatio = options.keepAspectRatio;
+    resolutionConfig.adaptive = options.adaptiveResolution;
+
+    if (options.adaptiveResolution) {
+        auto [adaptiveWidth, adaptiveHeight] = ImageProcessor::calculateAdaptiveResolution(
+            image->width, image->height, options.layerType
+        );
+        resolutionConfig.targetWidth = adaptiveWidth;
+        resolutionConfig.targetHeight = adaptiveHeight;
+    }
+
+    auto processed = ImageProcessor::applyResolutionControl(
+        *image, resolutionConfig, ImageProcessor::InterpolationMethod::Linear
+    );
+    if (processed.has_value()) {
+        return processed;
+    }
+    return image;
+}
+
+} // namespace
+
+// ========== X11上下文 ==========
+
+struct ScreenCaptureLinux::X11Context {
+    Display* display{nullptr};
+    Window root{0};
+    Visual* visual{nullptr};
+    int depth{0};
+    types::Rect rootBounds;
+
+    // MIT-SHM：共享内存图像，尺寸不变时跨帧复用
+    bool shmAvailable{false};
+    XImage* shmImage{nullptr};
+    XShmSegmentInfo shmInfo{};
+    bool shmAttached{false};
+
+    // XGetImage回退：保留上一帧的图像（下一次采集时释放）
+    XImage* fallbackImage{nullptr};
+
+    // 当前缓冲中的帧（根窗口坐标）
+    bool hasFrame{false};
+    types::Rect frameBounds;
+    types::ImageView frameView;
+    std::chrono::steady_clock::time_point grabTime;  // 缓冲内容实际采集的时间
+
+#ifdef NAW_HAS_XDAMAGE
+    bool damageAvailable{false};
+    int damageEventBase{0};
+    Damage damage{0};
+    XserverRegion damageParts{0};
+#endif
+};
+
+// ========== 构造函数和析构函数 ==========
+
+ScreenCaptureLinux::ScreenCaptureLinux(const std::string& displayName)
+    : x11Context_(std::make_unique<X11Context>())
+{
+    if (initializeX11(displayName)) {
+        enumerateDisplays();
+    }
+}
+
+ScreenCaptureLinux::~ScreenCaptureLinux() {
+    cleanupX11();
+}
+
+bool ScreenCaptureLinux::initializeX11(const std::string& displayName) {
+    auto& ctx = *x11Context_;
+    ctx.display = XOpenDisplay(displayName.empty() ? nullptr : displayName.c_str());
+    if (!ctx.display) {
+        const char* env = std::getenv("DISPLAY");
+        setLastError("Failed to open X display: " +
+                     (displayName.empty() ? std::string(env ? env : "(DISPLAY not set)") : displayName));
+        return false;
+    }
+
+    const int screen = DefaultScreen(ctx.display);
+    ctx.root = RootWindow(ctx.display, screen);
+    ctx.visual = DefaultVisual(ctx.display, screen);
+    ctx.depth = DefaultDepth(ctx.display, screen);
+    ctx.rootBounds.width = static_cast<uint32_t>(DisplayWidth(ctx.display, screen));
+    ctx.rootBounds.height = static_cast<uint32_t>(DisplayHeight(ctx.display, screen));
+
+    // MIT-SHM只在本地连接可用（远程连接时XShmAttach会失败，之后回退到XGetImage）
+    ctx.shmAvailable = XShmQueryExtension(ctx.display) == True;
+
+#ifdef NAW_HAS_XDAMAGE
+    int damageErrorBase = 0;
+    int fixesEventBase = 0;
+    int fixesErrorBase = 0;
+    if (XDamageQueryExtension(ctx.display, &ctx.damageEventBase, &damageErrorBase) &&
+        XFixesQueryExtension(ctx.display, &fixesEventBase, &fixesErrorBase)) {
+        // NonEmpty：区域从空变为非空时只发一个事件，变化区域在采集时统一取出
+        ctx.damage = XDamageCreate(ctx.display, ctx.root, XDamageReportNonEmpty);
+        ctx.damageParts = XFixesCreateRegion(ctx.display, nullptr, 0);
+        ctx.damageAvailable = ctx.damage != 0 && ctx.damageParts != 0;
+    }
+#endif
+    return true;
+}
+
+void ScreenCaptureLinux::cleanupX11() {
+    if (!x11Context_ || !x11Context_->display) {
+        return;
+    }
+    auto& ctx = *x11Context_;
+    releaseShmImage();
+    if (ctx.fallbackImage) {
+        XDestroyImage(ctx.fallbackImage);
+        ctx.fallbackImage = nullptr;
+    }
+#ifdef NAW_HAS_XDAMAGE
+    if (ctx.damageParts) {
+        XFixesDestroyRegion(ctx.display, ctx.damageParts);
+    }
+    if (ctx.damage) {
+        XDamageDestroy(ctx.display, ctx.damage);
+    }
+#endif
+    XCloseDisplay(ctx.display);
+    ctx.display = nullptr;
+}
+
+// ========== 公共接口实现 ==========
+
+std::optional<types::ImageData> ScreenCaptureLinux::captureFullScreen(
+    int32_t displayId,
+    const CaptureOptions& options
+) {
+    std::optional<types::ImageData> result;
+    {
+        std::lock_guard<std::mutex> lock(captureMutex_);
+        auto bounds = displayBounds(displayId);
+        if (!bounds) {
+            setLastError("Invalid display id: " + std::to_string(displayId));
+            return std::nullopt;
+        }
+        auto view = captureRootLocked(*bounds);
+        if (!view) {
+            return std::nullopt;
+        }
+        result = copyToImageData(*view);
+    }
+    return applyImageProcessing(std::move(result), options);
+}
+
+std::optional<types::ImageView> ScreenCaptureLinux::captureFullScreenView(int32_t displayId) {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    auto bounds = displayBounds(displayId);
+    if (!bounds) {
+        setLastError("Invalid display id: " + std::to_string(displayId));
+        return std::nullopt;
+    }
+    return captureRootLocked(*bounds);
+}
+
+std::optional<types::ImageData> ScreenCaptureLinux::captureWindow(
+    types::WindowHandle handle,
+    const CaptureOptions& options
+) {
+    if (!handle) {
+        setLastError("Invalid window handle");
+        return std::nullopt;
+    }
+
+    types::Rect bounds;
+    {
+        std::lock_guard<std::mutex> lock(captureMutex_);
+        if (!isConnected()) {
+            setLastError("X display not connected");
+            return std::nullopt;
+        }
+        auto& ctx = *x11Context_;
+        const Window window = static_cast<Window>(reinterpret_cast<uintptr_t>(handle));
+
+        // 窗口可能已销毁：查询期间捕获BadWindow
+        XWindowAttributes attributes{};
+        int rootX = 0;
+        int rootY = 0;
+        Window child = 0;
+        XErrorTrap trap(ctx.display);
+        const Status status = XGetWindowAttributes(ctx.display, window, &attributes);
+        const Bool translated = status != 0 &&
+            XTranslateCoordinates(ctx.display, window, ctx.root, 0, 0, &rootX, &rootY, &child);
+        if (trap.finish() != 0 || status == 0 || !translated) {
+            setLastError("Invalid window handle");
+            return std::nullopt;
+        }
+        if (attributes.map_state != IsViewable) {
+            setLastError("Window is not viewable");
+            return std::nullopt;
+        }
+
+        // 采集窗口在屏幕上的可见内容（被遮挡的部分为遮挡它的窗口）
+        types::Rect windowRect;
+        windowRect.x = rootX;
+        windowRect.y = rootY;
+        windowRect.width = static_cast<uint32_t>(attributes.width);
+        windowRect.height = static_cast<uint32_t>(attributes.height);
+        bounds = intersect(windowRect, ctx.rootBounds);
+    }
+    return captureRegion(bounds, -1, options);
+}
+
+std::optional<types::ImageData> ScreenCaptureLinux::captureRegion(
+    const types::Rect& region,
+    int32_t displayId,
+    const CaptureOptions& options
+) {
+    if (!region.isValid()) {
+        setLastError("Invalid region");
+        return std::nullopt;
+    }
+
+    std::optional<types::ImageData> result;
+    {
+        std::lock_guard<std::mutex> lock(captureMutex_);
+        auto display = displayBounds(displayId);
+        if (!display) {
+            setLastError("Invalid display id: " + std::to_string(displayId));
+            return std::nullopt;
+        }
+
+        // 区域相对于显示器左上角
+        types::Rect absolute = region;
+        absolute.x += display->x;
+        absolute.y += display->y;
+        const types::Rect bounds = intersect(absolute, *display);
+        if (!bounds.isValid()) {
+            setLastError("Region is outside of the display");
+            return std::nullopt;
+        }
+
+        // 区域截图不是热路径：使用一次性的XGetImage，不影响全屏采集的共享内存缓冲
+        auto& ctx = *x11Context_;
+        XErrorTrap trap(ctx.display);
+        XImage* image = XGetImage(ctx.display, ctx.root, bounds.x, bounds.y,
+                                  bounds.width, bounds.height, AllPlanes, ZPixmap);
+        const int error = trap.finish();
+        if (!image || error != 0) {
+            if (image) {
+                XDestroyImage(image);
+            }
+            setLastError("XGetImage failed (error " + std::to_string(error) + ")");
+            return std::nullopt;
+        }
+        if (!isBGRX(image)) {
+            XDestroyImage(image);
+            setLastError("Unsupported X visual (expected 32-bit BGRX)");
+            return std::nullopt;
+        }
+        result = copyToImageData(viewOf(image));
+        XDestroyImage(image);
+    }
+    return applyImageProcessing(std::move(result), options);
+}
+
+std::optional<std::vector<types::Rect>> ScreenCaptureLinux::getLastDamage() const {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    return lastDamage_;
+}
+
+std::vector<types::DisplayInfo> ScreenCaptureLinux::getDisplays() {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    return displays_;
+}
+
+std::string ScreenCaptureLinux::getLastError() const {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    return lastError_;
+}
+
+bool ScreenCaptureLinux::isConnected() const {
+    return x11Context_ && x11Context_->display != nullptr;
+}
+
+std::string ScreenCaptureLinux::getCaptureMethod() const {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    return isConnected() && x11Context_->shmAvailable ? "XShm" : "XGetImage";
+}
+
+void ScreenCaptureLinux::setMaxFrameAge(std::chrono::milliseconds maxAge) {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    maxFrameAge_ = std::max(maxAge, std::chrono::milliseconds::zero());
+}
+
+bool ScreenCaptureLinux::isDamageTrackingEnabled() const {
+#ifdef NAW_HAS_XDAMAGE
+    return isConnected() && x11Context_->damageAvailable;
+#else
+    return false;
+#endif
+}
+
+// ========== 采集实现 ==========
+
+std::optional<types::ImageView> ScreenCaptureLinux::captureRootLocked(const types::Rect& bounds) {
+    if (!isConnected()) {
+        setLastError("X display not connected");
+        return std::nullopt;
+    }
+    auto& ctx = *x11Context_;
+
+    // 先取出变化区域再采集：采集期间发生的变化会留到下一帧报告，不会丢失
+    std::vector<types::Rect> damage;
+    const bool tracked = collectDamage(damage);
+    const bool sameBuffer = ctx.hasFrame && sameRect(ctx.frameBounds, bounds);
+    if (tracked && sameBuffer) {
+        std::vector<types::Rect> local;
+        for (const auto& rect : damage) {
+            types::Rect clipped = intersect(rect, bounds);
+            if (clipped.isValid()) {
+                clipped.x -= bounds.x;
+                clipped.y -= bounds.y;
+                local.push_back(clipped);
+            }
+        }
+        lastDamage_ = std::move(local);
+        if (lastDamage_->empty()) {
+            if (std::chrono::steady_clock::now() - ctx.grabTime < maxFrameAge_) {
+                // 画面没有变化：缓冲中仍是最新内容，跳过采集
+                return ctx.frameView;
+            }
+            // 太久没有DAMAGE报告：事件可能丢失，强制整帧采集并整体报告为变化
+            lastDamage_->push_back(types::Rect{0, 0, bounds.width, bounds.height});
+        }
+    } else if (tracked) {
+        // 首帧或切换了显示器：整帧视为变化
+        lastDamage_ = std::vector<types::Rect>{types::Rect{0, 0, bounds.width, bounds.height}};
+    } else {
+        lastDamage_.reset();
+    }
+
+    ctx.hasFrame = false;
+    if (ctx.shmAvailable && ensureShmImage(bounds.width, bounds.height)) {
+        XErrorTrap trap(ctx.display);
+        const Bool ok = XShmGetImage(ctx.display, ctx.root, ctx.shmImage, bounds.x, bounds.y, AllPlanes);
+        const int error = trap.finish();
+        if (!ok || error != 0) {
+            setLastError("XShmGetImage failed (error " + std::to_string(error) + ")");
+            return std::nullopt;
+        }
+        if (!isBGRX(ctx.shmImage)) {
+            setLastError("Unsupported X visual (expected 32-bit BGRX)");
+            return std::nullopt;
+        }
+        ctx.frameView = viewOf(ctx.shmImage);
+    } else {
+        if (ctx.fallbackImage) {
+            XDestroyImage(ctx.fallbackImage);
+            ctx.fallbackImage = nullptr;
+        }
+        XErrorTrap trap(ctx.display);
+        ctx.fallbackImage = XGetImage(ctx.display, ctx.root, bounds.x, bounds.y,
+                                      bounds.width, bounds.height, AllPlanes, ZPixmap);
+        const int error = trap.finish();
+        if (!ctx.fallbackImage || error != 0) {
+            setLastError("XGetImage failed (error " + std::to_string(error) + ")");
+            return std::nullopt;
+        }
+        if (!isBGRX(ctx.fallbackImage)) {
+            setLastError("Unsupported X visual (expected 32-bit BGRX)");
+            return std::nullopt;
+        }
+        ctx.frameView = viewOf(ctx.fallbackImage);
+    }
+
+    ctx.hasFrame = true;
+    ctx.frameBounds = bounds;
+    ctx.grabTime = std::chrono::steady_clock::now();
+    return ctx.frameView;
+}
+
+bool ScreenCaptureLinux::ensureShmImage(uint32_t width, uint32_t height) {
+    auto& ctx = *x11Context_;
+    if (ctx.shmImage && static_cast<uint32_t>(ctx.shmImage->width) == width &&
+        static_cast<uint32_t>(ctx.shmImage->height) == height) {
+        return true;
+    }
+    releaseShmImage();
+
+    ctx.shmImage = XShmCreateImage(ctx.display, ctx.visual, static_cast<unsigned int>(ctx.depth),
+                                   ZPixmap, nullptr, &ctx.shmInfo, width, height);
+    if (!ctx.shmImage) {
+        setLastError("XShmCreateImage failed");
+        ctx.shmAvailable = false;
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(ctx.shmImage->bytes_per_line) * ctx.shmImage->height;
+    ctx.shmInfo.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (ctx.shmInfo.shmid < 0) {
+        setLastError("shmget failed");
+        XDestroyImage(ctx.shmImage);
+        ctx.shmImage = nullptr;
+        ctx.shmAvailable = false;
+        return false;
+    }
+    ctx.shmInfo.shmaddr = static_cast<char*>(shmat(ctx.shmInfo.shmid, nullptr, 0));
+    if (ctx.shmInfo.shmaddr == reinterpret_cast<char*>(-1)) {
+        setLastError("shmat failed");
+        shmctl(ctx.shmInfo.shmid, IPC_RMID, nullptr);
+        XDestroyImage(ctx.shmImage);
+        ctx.shmImage = nullptr;
+        ctx.shmAvailable = false;
+        return false;
+    }
+    ctx.shmImage->data = ctx.shmInfo.shmaddr;
+    ctx.shmInfo.readOnly = False;
+
+    XErrorTrap trap(ctx.display);
+    XShmAttach(ctx.display, &ctx.shmInfo);
+    const int error = trap.finish();
+
+    // 服务器已附加（或附加失败）后立即标记删除：进程退出时段会被自动回收
+    shmctl(ctx.shmInfo.shmid, IPC_RMID, nullptr);
+    if (error != 0) {
+        // 远程连接等情况下不能共享内存，之后改用XGetImage
+        setLastError("XShmAttach failed, falling back to XGetImage");
+        shmdt(ctx.shmInfo.shmaddr);
+        XDestroyImage(ctx.shmImage);
+        ctx.shmImage = nullptr;
+        ctx.shmAvailable = false;
+        return false;
+    }
+    ctx.shmAttached = true;
+    return true;
+}
+
+void ScreenCaptureLinux::releaseShmImage() {
+    auto& ctx = *x11Context_;
+    if (!ctx.shmImage) {
+        return;
+    }
+    if (ctx.shmAttached) {
+        XShmDetach(ctx.display, &ctx.shmInfo);
+        XSync(ctx.display, False);
+        ctx.shmAttached = false;
+    }
+    shmdt(ctx.shmInfo.shmaddr);
+    // XShmCreateImage创建的图像销毁时不释放data（data指向共享内存）
+    XDestroyImage(ctx.shmImage);
+    ctx.shmImage = nullptr;
+    ctx.hasFrame = false;
+    ctx.frameView = {};
+}
+
+bool ScreenCaptureLinux::collectDamage(std::vector<types::Rect>& rects) {
+#ifdef NAW_HAS_XDAMAGE
+    auto& ctx = *x11Context_;
+    if (!ctx.damageAvailable) {
+        return false;
+    }
+
+    // 丢弃累积的通知事件，变化区域直接从damage对象中取出
+    XEvent event;
+    while (XCheckTypedEvent(ctx.display, ctx.damageEventBase + XDamageNotify, &event)) {
+    }
+    XDamageSubtract(ctx.display, ctx.damage, None, ctx.damageParts);
+
+    int count = 0;
+    XRectangle* parts = XFixesFetchRegion(ctx.display, ctx.damageParts, &count);
+    rects.clear();
+    rects.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        rects.push_back(types::Rect{parts[i].x, parts[i].y, parts[i].width, parts[i].height});
+    }
+    if (parts) {
+        XFree(parts);
+    }
+    return true;
+#else
+    (void)rects;
+    return false;
+#endif
+}
+
+// ========== 显示器枚举 ==========
+
+void ScreenCaptureLinux::enumerateDisplays() {
+    auto& ctx = *x11Context_;
+    displays_.clear();
+
+#ifdef NAW_HAS_XRANDR
+    int count = 0;
+    XRRMonitorInfo* monitors = XRRGetMonitors(ctx.display, ctx.root, True, &count);
+    if (monitors) {
+        for (int i = 0; i < count; ++i) {
+            types::DisplayInfo info;
+            char* name = monitors[i].name != None ? XGetAtomName(ctx.display, monitors[i].name) : nullptr;
+            info.name = name ? name : "Monitor " + std::to_string(i);
+            if (name) {
+                XFree(name);
+            }
+            info.bounds = types::Rect{monitors[i].x, monitors[i].y,
+                                      static_cast<uint32_t>(monitors[i].width),
+                                      static_cast<uint32_t>(monitors[i].height)};
+            info.isPrimary = monitors[i].primary != 0;
+            if (monitors[i].mwidth > 0 && monitors[i].mheight > 0) {
+                info.physicalWidth = static_cast<uint32_t>(monitors[i].mwidth);
+                info.physicalHeight = static_cast<uint32_t>(monitors[i].mheight);
+            }
+            displays_.push_back(std::move(info));
+        }
+        XRRFreeMonitors(monitors);
+    }
+#endif
+
+    if (displays_.empty()) {
+        // 没有RandR信息：整个根窗口作为一个显示器
+        const int screen = DefaultScreen(ctx.display);
+        types::DisplayInfo info;
+        info.name = DisplayString(ctx.display);
+        info.bounds = ctx.rootBounds;
+        info.isPrimary = true;
+        info.physicalWidth = static_cast<uint32_t>(DisplayWidthMM(ctx.display, screen));
+        info.physicalHeight = static_cast<uint32_t>(DisplayHeightMM(ctx.display, screen));
+        displays_.push_back(std::move(info));
+    }
+
+    // 主显示器排在最前（displayId 0）
+    std::stable_partition(displays_.begin(), displays_.end(),
+                          [](const types::DisplayInfo& info) { return info.isPrimary; });
+    displays_.front().isPrimary = true;
+    for (size_t i = 0; i < displays_.size(); ++i) {
+        displays_[i].id = static_cast<uint32_t>(i);
+    }
+}
+
+std::optional<types::Rect> ScreenCaptureLinux::displayBounds(int32_t displayId) const {
+    if (!isConnected()) {
+        return std::nullopt;
+    }
+    if (displayId == -1) {
+        return x11Context_->rootBounds;
+    }
+    if (displayId < 0 || static_cast<size_t>(displayId) >= displays_.size()) {
+        return std::nullopt;
+    }
+    const types::Rect bounds = intersect(displays_[static_cast<size_t>(displayId)].bounds, x11Context_->rootBounds);
+    if (!bounds.isValid()) {
+        return std::nullopt;
+    }
+    return bounds;
+}
+
+} // namespace naw::desktop_pet::service::platform
+
+#endif // __linux__
@@ -0,0 +1,190 @@
+#include "naw/desktop_pet/service/BlobStore.h"
+#include "naw/desktop_pet/service/FileContentCache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace naw::desktop_pet::service;
+namespace fs = std::filesystem;
+
+// 轻量自测断言工具（复用现有测试风格）
+namespace mini_test {
+
+inline std::string toString(const std::string& v) { return v; }
+inline std::string toString(const char* v) { return v ? std::string(v) : "null"; }
+inline std::string toString(bool v) { return v ? "true" : "false"; }
+
+template <typename T>
+std::string toString(const T& v) {
+    std::ostringstream oss;
+    oss << v;
+    return oss.str();
+}
+
+class AssertionFailed : public std::runtime_error {
+public:
+    explicit AssertionFailed(const std::string& msg) : std::runtime_error(msg) {}
+};
+
+#define CHECK_TRUE(cond)                                                                          \
+    do {                                                                                          \
+        if (!(cond))                                                                              \
+            throw mini_test::AssertionFailed(std::string("CHECK_TRUE failed: ") + #cond);         \
+    } while (0)
+
+#define CHECK_FALSE(cond) CHECK_TRUE(!(cond))
+
+#define CHECK_EQ(a, b)                                                                            \
+    do {                                                                                          \
+        const auto _va = (a);                                                                     \
+        const auto _vb = (b);                                                                     \
+        if (!(_va == _vb)) {                                                                      \
+            throw mini_test::AssertionFailed(std::string("CHECK_EQ failed: ") + #a " vs " #b +    \
+                                             " (" + mini_test::toString(_va) + " vs " +           \
+                                             mini_test::toString(_vb) + ")");                     \
+        }                                                                                         \
+    } while (0)
+
+struct TestCase {
+    std::string name;
+    std::function<void()> fn;
+};
+
+inline int run(const std::vector<TestCase>& tests) {
+    int failed = 0;
+    for (const auto& t : tests) {
+        try {
+            t.fn();
+            std::cout << "[  OK  ] " << t.name << "\n";
+        } catch (const AssertionFailed& e) {
+            failed++;
+            std::cout << "[ FAIL ] " << t.name << " :: " << e.what() << "\n";
+        } catch (const std::exception& e) {
+            failed++;
+            std::cout << "[ EXC  ] " << t.name << " :: " << e.what() << "\n";
+        } catch (...) {
+            failed++;
+            std::cout << "[ EXC  ] " << t.name << " :: unknown exception\n";
+        }
+    }
+    std::cout << "Executed " << tests.size() << " cases, failed " << failed << ".\n";
+    return failed == 0 ? 0 : 1;
+}
+
+} // namespace mini_test
+
+// ========== 测试辅助函数 ==========
+
+namespace {
+    fs::path createTempTestDir() {
+        fs::path tempDir = fs::temp_directory_path() / "BlobStoreTest";
+        if (fs::exists(tempDir)) {
+            fs::remove_all(tempDir);
+        }
+        fs::create_directories(tempDir);
+        return tempDir;
+    }
+    
+    void cleanupTempTestDir(const fs::path& dir) {
+        try {
+            if (fs::exists(dir)) {
+                fs::remove_all(dir);
+            }
+        } catch (...) {
+            // 忽略清理错误
+        }
+    }
+    
+    void writeTestFile(const fs::path& filePath, const std::string& content) {
+        fs::create_directories(filePath.parent_path());
+        std::ofstream file(filePath);
+        file << content;
+    }
+}
+
+// ========== 测试用例 ==========
+
+int main() {
+    std::vector<mini_test::TestCase> tests;
+
+    tests.push_back({"BlobStore_DeduplicatesAcrossSubsystems", []() {
+        BlobStore store;
+        {
+            auto a = store.intern(std::string(4096, 'x'), "file_cache");
+            auto b = store.internView(std::string(4096, 'x'), "tool_result_cache");
+            auto c = store.intern("other", "file_cache");
+            CHECK_TRUE(a.get() == b.get());
+            CHECK_TRUE(a.get() != c.get());
+
+            auto stats = store.getStats();
+            CHECK_EQ(stats.uniqueBlobs, 2u);
+            CHECK_EQ(stats.uniqueBytes, 4096u + 5u);
+            CHECK_EQ(stats.dedupHits, 1u);
+            CHECK_EQ(stats.subsystems["file_cache"].liveRefs, 2u);
+            CHECK_EQ(stats.subsystems["tool_result_cache"].referencedBytes, 4096u);
+            CHECK_EQ(stats.savedBytes(), 4096u);
+
+            // 释放一个引用方后缓冲仍由另一方持有
+            a.reset();
+            stats = store.getStats();
+            CHECK_EQ(stats.uniqueBytes, 4096u + 5u);
+            CHECK_EQ(stats.subsystems["file_cache"].liveRefs, 1u);
+            CHECK_EQ(*b, std::string(4096, 'x'));
+        }
+        auto stats = store.getStats();
+        CHECK_EQ(stats.uniqueBlobs, 0u);
+        CHECK_EQ(stats.uniqueBytes, 0u);
+        CHECK_EQ(stats.referencedBytes, 0u);
+    }});
+
+    tests.push_back({"BlobStore_ConcurrentInternSharesBuffer", []() {
+        BlobStore store;
+        const std::string content(2048, 'c');
+        std::vector<BlobStore::Blob> results(8);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < results.size(); ++i) {
+            threads.emplace_back([&store, &results, &content, i]() {
+                results[i] = store.internView(content, "tool_result_cache");
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (const auto& r : results) {
+            CHECK_TRUE(r != nullptr);
+            CHECK_TRUE(*r == content);
+        }
+        auto stats = store.getStats();
+        CHECK_EQ(stats.uniqueBlobs, 1u);
+        CHECK_EQ(stats.dedupHits, results.size() - 1);
+        CHECK_EQ(stats.subsystems["tool_result_cache"].liveRefs, results.size());
+    }});
+
+    tests.push_back({"BlobStore_SharedBetweenFileCaches", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            fs::path filePath = tempDir / "dedup.cpp";
+            writeTestFile(filePath, std::string(8192, 'd'));
+            FileContentCache first;
+            FileContentCache second;
+            auto c1 = first.get(filePath.string());
+            auto c2 = second.get(filePath.string());
+            CHECK_TRUE(c1 != nullptr);
+            CHECK_TRUE(c1.get() == c2.get());
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    // 运行所有测试
+    return mini_test::run(tests);
+}
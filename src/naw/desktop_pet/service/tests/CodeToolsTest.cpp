@@ -1,7 +1,11 @@
 #include "naw/desktop_pet/service/CodeTools.h"
 #include "naw/desktop_pet/service/ToolManager.h"
 #include "naw/desktop_pet/service/ErrorHandler.h"
+#include "naw/desktop_pet/service/tools/CodeToolsUtils.h"
+#include "naw/desktop_pet/service/tools/ProjectStructureCache.h"
+#include "naw/desktop_pet/service/tools/ProjectWhitelist.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -10,6 +14,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace naw::desktop_pet::service;
@@ -194,6 +199,28 @@ int main() {
         CHECK_TRUE(content.find("Line 4") != std::string::npos);
     }});
     
+    tests.push_back({"ReadFile_TrailingNewlineConsistent", [&]() {
+        ToolManager toolManager;
+        CodeTools::registerAllTools(toolManager);
+
+        fs::path testFile = testDir / "trailing_newline.txt";
+        createTestFile(testFile, "Line 1\nLine 2\n");
+
+        // 完整读取与行范围读取都返回按行拼接的文本，不保留末尾换行
+        nlohmann::json fullArgs;
+        fullArgs["path"] = testFile.string();
+        auto full = toolManager.executeTool("read_file", fullArgs);
+        CHECK_TRUE(full.has_value());
+        CHECK_EQ((*full)["content"].get<std::string>(), std::string("Line 1\nLine 2"));
+
+        nlohmann::json rangeArgs = fullArgs;
+        rangeArgs["start_line"] = 1;
+        rangeArgs["end_line"] = 2;
+        auto ranged = toolManager.executeTool("read_file", rangeArgs);
+        CHECK_TRUE(ranged.has_value());
+        CHECK_EQ((*ranged)["content"].get<std::string>(), (*full)["content"].get<std::string>());
+    }});
+
     tests.push_back({"ReadFile_FileNotFound", [&]() {
         ToolManager toolManager;
         CodeTools::registerAllTools(toolManager);
@@ -270,6 +297,123 @@ int main() {
         CHECK_TRUE(fs::exists(testFile));
     }});
     
+    tests.push_back({"WriteFile_PatchMode", [&]() {
+        ToolManager toolManager;
+        CodeTools::registerAllTools(toolManager);
+        
+        fs::path testFile = testDir / "patch_test.cpp";
+        createTestFile(testFile, "int a = 1;\nint b = 2;\nint c = 1;\n");
+        
+        // 有歧义的编辑（old_text 出现两次）不写入文件
+        nlohmann::json args;
+        args["path"] = testFile.string();
+        args["mode"] = "patch";
+        args["edits"] = nlohmann::json::array({{{"old_text", "= 1;"}, {"new_text", "= 10;"}}});
+        auto ambiguous = toolManager.executeTool("write_file", args);
+        CHECK_TRUE(ambiguous.has_value());
+        CHECK_TRUE(ambiguous->contains("error"));
+        
+        // 多个编辑按顺序应用，其中一个替换所有出现位置
+        args["edits"] = nlohmann::json::array({
+            {{"old_text", "int b = 2;"}, {"new_text", "int b = 20;"}},
+            {{"old_text", "= 1;"}, {"new_text", "= 10;"}, {"replace_all", true}}
+        });
+        auto result = toolManager.executeTool("write_file", args);
+        CHECK_TRUE(result.has_value());
+        CHECK_TRUE((*result)["success"].get<bool>());
+        CHECK_EQ((*result)["replacements"].get<size_t>(), 3u);
+        
+        std::ifstream file(testFile, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        CHECK_EQ(content, std::string("int a = 10;\nint b = 20;\nint c = 10;\n"));
+        
+        // 找不到原文时报错
+        args["edits"] = nlohmann::json::array({{{"old_text", "missing"}, {"new_text", "x"}}});
+        auto missing = toolManager.executeTool("write_file", args);
+        CHECK_TRUE(missing.has_value());
+        CHECK_TRUE(missing->contains("error"));
+    }});
+    
+    tests.push_back({"WriteFile_AtomicOverwriteInvalidatesReadCache", [&]() {
+        ToolManager toolManager;
+        CodeTools::registerAllTools(toolManager);
+        
+        fs::path atomicDir = testDir / "atomic";
+        fs::create_directories(atomicDir);
+        fs::path testFile = atomicDir / "cached.txt";
+        createTestFile(testFile, "old content");
+        
+        nlohmann::json readArgs;
+        readArgs["path"] = testFile.string();
+        auto before = toolManager.executeTool("read_file", readArgs);
+        CHECK_TRUE(before.has_value());
+        CHECK_TRUE((*before)["content"].get<std::string>().find("old content") != std::string::npos);
+        
+        // 同样大小的新内容：仅靠大小无法判断变化，需要写入时主动失效缓存
+        nlohmann::json writeArgs;
+        writeArgs["path"] = testFile.string();
+        writeArgs["content"] = "new content";
+        auto written = toolManager.executeTool("write_file", writeArgs);
+        CHECK_TRUE(written.has_value());
+        CHECK_TRUE((*written)["success"].get<bool>());
+        
+        auto after = toolManager.executeTool("read_file", readArgs);
+        CHECK_TRUE(after.has_value());
+        CHECK_TRUE((*after)["content"].get<std::string>().find("new content") != std::string::npos);
+        
+        // 不残留临时文件
+        size_t fileCount = 0;
+        for (const auto& entry : fs::directory_iterator(atomicDir)) {
+            (void)entry;
+            ++fileCount;
+        }
+        CHECK_EQ(fileCount, 1u);
+    }});
+    
+    tests.push_back({"WriteFile_CreateOnlyAndSymlinkTarget", [&]() {
+        fs::path linkDir = testDir / "link_write";
+        fs::create_directories(linkDir);
+        fs::path target = linkDir / "target.txt";
+        createTestFile(target, "old");
+        
+        // create_only：目标已存在时失败且不改动原文件，也不残留临时文件
+        std::string error;
+        CHECK_TRUE(!tools::writeFileAtomically(target, "clobbered", error, true));
+        CHECK_TRUE(!error.empty());
+        CHECK_TRUE(tools::writeFileAtomically(linkDir / "fresh.txt", "fresh", error, true));
+        {
+            std::ifstream in(target);
+            std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            CHECK_EQ(text, std::string("old"));
+        }
+        
+        // 通过符号链接覆盖：写入链接指向的文件，链接本身保留（无权限创建链接的平台跳过）
+        fs::path link = linkDir / "link.txt";
+        std::error_code ec;
+        fs::create_symlink(target, link, ec);
+        if (!ec) {
+            ToolManager toolManager;
+            CodeTools::registerAllTools(toolManager);
+            nlohmann::json writeArgs;
+            writeArgs["path"] = link.string();
+            writeArgs["content"] = "via link";
+            auto written = toolManager.executeTool("write_file", writeArgs);
+            CHECK_TRUE(written.has_value());
+            CHECK_TRUE((*written)["success"].get<bool>());
+            CHECK_TRUE(fs::is_symlink(fs::symlink_status(link)));
+            std::ifstream in(target);
+            std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            CHECK_EQ(text, std::string("via link"));
+        }
+        
+        size_t fileCount = 0;
+        for (const auto& entry : fs::directory_iterator(linkDir)) {
+            (void)entry;
+            ++fileCount;
+        }
+        CHECK_EQ(fileCount, ec ? 2u : 3u);
+    }});
+    
     // ========== list_files 工具测试 ==========
     
     tests.push_back({"ListFiles_ListDirectory", [&]() {
@@ -637,10 +781,176 @@ int main() {
         if (result->contains("structure")) {
             std::string structure = (*result)["structure"].get<std::string>();
             // 结构应该包含目录信息
-            CHECK_TRUE(structure.find("src") != std::string::npos || 
+            CHECK_TRUE(structure.find("src") != std::string::npos ||
                       structure.find("include") != std::string::npos);
         }
     }});
+
+    tests.push_back({"GetProjectStructure_Pagination", [&]() {
+        ToolManager toolManager;
+        CodeTools::registerAllTools(toolManager);
+
+        createTestFile(testDir / "CMakeLists.txt", "project(PagedProject)");
+        for (int i = 0; i < 40; ++i) {
+            createTestFile(testDir / "src" / ("paged_module_" + std::to_string(i) + ".cpp"), "int f() { return 0; }");
+        }
+
+        nlohmann::json args;
+        args["project_root"] = testDir.string();
+        args["page_tokens"] = 200;
+        args["force_refresh"] = true;
+
+        auto first = toolManager.executeTool("get_project_structure", args);
+        CHECK_TRUE(first.has_value());
+        CHECK_TRUE(first->contains("entries"));
+        CHECK_TRUE(first->value("page_tokens", size_t(0)) <= 200);
+        CHECK_TRUE(first->value("has_more", false));
+        CHECK_TRUE((*first)["next_cursor"].is_string());
+
+        // 翻页直到结束：条目按路径严格递增，不重复，总数与 total_entries 一致
+        size_t total = (*first)["total_entries"].get<size_t>();
+        std::vector<std::string> paths;
+        for (const auto& entry : (*first)["entries"]) {
+            paths.push_back(entry["path"].get<std::string>());
+        }
+        nlohmann::json page = *first;
+        int pages = 1;
+        args.erase("force_refresh");
+        while (page.value("has_more", false) && pages < 100) {
+            args["cursor"] = page["next_cursor"];
+            auto next = toolManager.executeTool("get_project_structure", args);
+            CHECK_TRUE(next.has_value());
+            CHECK_TRUE(!next->contains("error"));
+            CHECK_TRUE(!next->contains("project_name")); // 摘要字段只在第一页
+            for (const auto& entry : (*next)["entries"]) {
+                paths.push_back(entry["path"].get<std::string>());
+            }
+            page = *next;
+            ++pages;
+        }
+        CHECK_TRUE(pages > 1);
+        CHECK_EQ(paths.size(), total);
+        CHECK_TRUE(std::is_sorted(paths.begin(), paths.end()));
+        CHECK_TRUE(std::adjacent_find(paths.begin(), paths.end()) == paths.end());
+
+        // 深度限制
+        nlohmann::json shallowArgs;
+        shallowArgs["project_root"] = testDir.string();
+        shallowArgs["paginate"] = true;
+        shallowArgs["max_depth"] = 0;
+        auto shallow = toolManager.executeTool("get_project_structure", shallowArgs);
+        CHECK_TRUE(shallow.has_value());
+        for (const auto& entry : (*shallow)["entries"]) {
+            CHECK_EQ(entry["depth"].get<size_t>(), 0u);
+        }
+
+        // 无效游标
+        nlohmann::json badArgs;
+        badArgs["project_root"] = testDir.string();
+        badArgs["cursor"] = "not-a-cursor";
+        auto bad = toolManager.executeTool("get_project_structure", badArgs);
+        CHECK_TRUE(bad.has_value());
+        CHECK_TRUE(bad->contains("error"));
+    }});
+
+    tests.push_back({"ProjectStructureCache_HitSharesEntry", [&]() {
+        tools::ProjectStructureCache cache(testDir / "structure_cache");
+        nlohmann::json data{{"project_name", "Shared"}, {"source_files", {"src/a.cpp", "src/b.cpp"}}};
+        tools::ProjectFileWhitelist whitelist;
+        whitelist.sourceFiles.insert("src/a.cpp");
+        cache.put("shared-key", data, std::move(whitelist), {});
+
+        // 命中时共享同一份只读条目，数据与白名单都不复制
+        auto first = cache.get("shared-key");
+        auto second = cache.get("shared-key");
+        CHECK_TRUE(first != nullptr && second != nullptr);
+        CHECK_TRUE(first.get() == second.get());
+        CHECK_EQ(first->data["project_name"].get<std::string>(), std::string("Shared"));
+        CHECK_EQ(first->data["source_files"].size(), 2u);
+        CHECK_EQ(first->whitelist.sourceFiles.size(), 1u);
+        CHECK_TRUE(cache.get("missing-key") == nullptr);
+    }});
+
+    tests.push_back({"ProjectStructureCache_BackgroundRefresh", [&]() {
+        fs::path root = testDir / "refresh_root";
+        fs::create_directories(root);
+        fs::path tracked = root / "tracked.cpp";
+        createTestFile(tracked, "int a;\n");
+
+        tools::ProjectStructureCache cache(testDir / "refresh_cache");
+        std::unordered_map<std::string, tools::FileSnapshot> snapshots;
+        snapshots["tracked.cpp"] = tools::FileSnapshot(tracked);
+        cache.put("refresh-key", nlohmann::json::object(), tools::ProjectFileWhitelist{}, snapshots);
+
+        // 文件未变化：后台检查后缓存仍然有效
+        CHECK_TRUE(cache.scheduleCheckAndUpdate("refresh-key", root, tools::ProjectFileWhitelist{}));
+        cache.waitForRefresh();
+        CHECK_TRUE(cache.get("refresh-key") != nullptr);
+
+        // 文件大小变化：后台检查使缓存失效
+        createTestFile(tracked, "int a;\nint b;\n");
+        CHECK_TRUE(cache.scheduleCheckAndUpdate("refresh-key", root, tools::ProjectFileWhitelist{}));
+        cache.waitForRefresh();
+        CHECK_TRUE(cache.get("refresh-key") == nullptr);
+
+        // 析构时仍有检查在运行也必须安全（析构函数停止并 join 后台线程）
+        {
+            tools::ProjectStructureCache shortLived(testDir / "refresh_cache_short");
+            shortLived.put("k", nlohmann::json::object(), tools::ProjectFileWhitelist{}, snapshots);
+            shortLived.scheduleCheckAndUpdate("k", root, tools::ProjectFileWhitelist{});
+        }
+    }});
+
+    tests.push_back({"ProjectWhitelist_CompiledDecisions", [&]() {
+        using tools::ExtensionFlags;
+        using tools::ProjectFileWhitelist;
+        
+        CHECK_EQ(ProjectFileWhitelist::extensionFlags(".CPP"), ExtensionFlags::Source);
+        CHECK_EQ(ProjectFileWhitelist::extensionFlags(".py"), ExtensionFlags::Source | ExtensionFlags::Resource);
+        CHECK_EQ(ProjectFileWhitelist::extensionFlags(".hpp"), ExtensionFlags::Header);
+        CHECK_EQ(ProjectFileWhitelist::extensionFlags(".md"), ExtensionFlags::Document);
+        CHECK_EQ(ProjectFileWhitelist::extensionFlags(".unknown"), ExtensionFlags::None);
+        CHECK_EQ(ProjectFileWhitelist::extensionFlags(""), ExtensionFlags::None);
+        
+        fs::path root = testDir / "whitelist_root";
+        ProjectFileWhitelist whitelist;
+        whitelist.scanRoots.push_back(fs::absolute(root / "src"));
+        whitelist.includeDirs.insert("include/naw");
+        whitelist.resourceDirs.insert("assets");
+        whitelist.docDirs.insert("docs");
+        whitelist.configFiles.insert("CMakeLists.txt");
+        whitelist.compile(root);
+        
+        // 包含目录本身、其祖先和子目录需要扫描；名称前缀相同的兄弟目录不扫描
+        CHECK_TRUE(whitelist.shouldScanRelativeDirectory("include", root / "include", root));
+        CHECK_TRUE(whitelist.shouldScanRelativeDirectory("include/naw/detail", root / "include/naw/detail", root));
+        CHECK_TRUE(!whitelist.shouldScanRelativeDirectory("include/other", root / "include/other", root));
+        CHECK_TRUE(!whitelist.shouldScanRelativeDirectory("src2", root / "src2", root));
+        CHECK_TRUE(whitelist.shouldScanRelativeDirectory("src/deep/nested", root / "src/deep/nested", root));
+        
+        CHECK_TRUE(whitelist.classifyFile("src/deep/a.cpp").whitelisted);
+        CHECK_TRUE(!whitelist.classifyFile("src2/a.cpp").whitelisted);
+        CHECK_TRUE(whitelist.classifyFile("include/naw/x.h").whitelisted);
+        CHECK_TRUE(!whitelist.classifyFile("include/naw/notes.md").whitelisted);
+        CHECK_TRUE(whitelist.classifyFile("assets/blob.bin").isResource);
+        CHECK_TRUE(whitelist.classifyFile("docs/guide/intro.md").whitelisted);
+        CHECK_TRUE(whitelist.classifyFile("CMakeLists.txt").isConfig);
+        
+        // 旧接口与编译后的判定一致
+        CHECK_TRUE(whitelist.isWhitelisted(root / "src" / "a.cpp", root));
+        CHECK_TRUE(!whitelist.isWhitelisted(root / "src2" / "a.cpp", root));
+        
+        // 未编译的白名单：旧接口使用按根目录缓存的前缀树，重复查询结果一致
+        ProjectFileWhitelist legacy;
+        legacy.scanRoots.push_back(fs::absolute(root / "src"));
+        legacy.includeDirs.insert("include/naw");
+        for (int i = 0; i < 2; ++i) {
+            CHECK_TRUE(legacy.isWhitelisted(root / "src" / "a.cpp", root));
+            CHECK_TRUE(!legacy.isWhitelisted(root / "src2" / "a.cpp", root));
+            CHECK_TRUE(legacy.shouldScanDirectory(root / "include", root));
+            CHECK_TRUE(!legacy.shouldScanDirectory(root / "include" / "other", root));
+        }
+    }});
     
     // ========== analyze_code 工具测试 ==========
     
@@ -1,8 +1,13 @@
 #include "naw/desktop_pet/service/ContextManager.h"
 #include "naw/desktop_pet/service/ConfigManager.h"
+#include "naw/desktop_pet/service/ContextPacker.h"
 #include "naw/desktop_pet/service/types/ChatMessage.h"
 #include "naw/desktop_pet/service/types/TaskType.h"
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <sstream>
@@ -475,6 +480,165 @@ int main() {
         CHECK_TRUE(tokens > 0);
     }});
 
+    // ========== 上下文片段打包测试 ==========
+    tests.push_back({"ContextPacker_ExtractSlices", []() {
+        std::string source =
+            "#include \"a.h\"\n"
+            "\n"
+            "namespace demo {\n"
+            "\n"
+            "int add(int a, int b) {\n"
+            "    return a + b;\n"
+            "}\n"
+            "\n"
+            "class Widget {\n"
+            "public:\n"
+            "    void draw() { }\n"
+            "};\n"
+            "\n"
+            "} // namespace demo\n";
+
+        auto slices = ContextPacker::extractSlices("demo.cpp", source, 80);
+        CHECK_EQ(slices.size(), 3u);
+        CHECK_EQ(slices[0].startLine, 1u);
+        CHECK_EQ(slices[1].symbol, "add");
+        CHECK_EQ(slices[1].startLine, 5u);
+        CHECK_EQ(slices[1].endLine, 7u);
+        CHECK_EQ(slices[2].symbol, "Widget");
+        CHECK_EQ(slices[2].endLine, 12u);
+
+        // 超长片段按最大行数拆分
+        auto split = ContextPacker::extractSlices("demo.cpp", source, 2);
+        CHECK_TRUE(split.size() > slices.size());
+
+        auto pySlices = ContextPacker::extractSlices(
+            "tool.py", "import os\n\ndef run():\n    pass\n\nclass Tool:\n    x = 1\n", 80);
+        CHECK_EQ(pySlices.size(), 3u);
+        CHECK_EQ(pySlices[1].symbol, "run");
+        CHECK_EQ(pySlices[2].symbol, "Tool");
+    }});
+
+    tests.push_back({"ContextPacker_TokenizeTerms", []() {
+        auto terms = ContextPacker::tokenizeTerms("Why does parseCMakeLists fail in read_file?");
+        auto has = [&terms](const std::string& t) {
+            return std::find(terms.begin(), terms.end(), t) != terms.end();
+        };
+        CHECK_TRUE(has("parsecmakelists"));
+        CHECK_TRUE(has("parse"));
+        CHECK_TRUE(has("lists"));
+        CHECK_TRUE(has("read_file"));
+        CHECK_TRUE(has("file"));
+        CHECK_TRUE(!has("why"));
+    }});
+
+    tests.push_back({"ContextPacker_PackWithinBudget", []() {
+        utils::TokenEstimator estimator;
+        ContextPackerConfig packerConfig;
+        packerConfig.tokenBudget = 60;
+        packerConfig.recencyWeight = 0.0;
+        ContextPacker packer(estimator, "test-model", packerConfig);
+
+        std::string filler;
+        for (int i = 0; i < 40; ++i) {
+            filler += "    int unrelatedValue" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+        }
+        ContextPacker::Document doc;
+        doc.path = "engine.cpp";
+        doc.content = std::make_shared<const std::string>(
+            "void renderFrame() {\n" + filler + "}\n"
+            "\n"
+            "int computeChecksum(const char* data) {\n"
+            "    return data[0];\n"
+            "}\n");
+
+        auto packed = packer.pack("how is the checksum computed?", {doc});
+        CHECK_EQ(packed.candidateSnippets, 2u);
+        CHECK_EQ(packed.snippets.size(), 1u);
+        CHECK_EQ(packed.snippets[0].symbol, "computeChecksum");
+        CHECK_TRUE(packed.totalTokens <= 60u);
+        CHECK_TRUE(packed.render().find("engine.cpp:3") == std::string::npos);
+        CHECK_TRUE(packed.render().find("computeChecksum") != std::string::npos);
+    }});
+
+    tests.push_back({"ContextPacker_LexicalScoringBeforeCandidateCut", []() {
+        namespace fs = std::filesystem;
+        fs::path tempDir = fs::temp_directory_path() / "ContextPackerCandidateTest";
+        fs::remove_all(tempDir);
+        fs::create_directories(tempDir / "recent");
+        fs::create_directories(tempDir / "legacy");
+        std::vector<std::string> files;
+        for (int i = 0; i < 10; ++i) {
+            fs::path path = tempDir / "recent" / ("widget" + std::to_string(i) + ".cpp");
+            std::ofstream(path) << "void paintWidget" << i << "() {\n}\n";
+            files.push_back(path.string());
+        }
+        // 久未修改、文件名也不相关，只有内容里的符号与问题匹配
+        fs::path legacy = tempDir / "legacy" / "old_stuff.cpp";
+        std::ofstream(legacy) << "int decodeFrame(const char* data) {\n    return data[0];\n}\n";
+        fs::last_write_time(legacy, fs::file_time_type::clock::now() - std::chrono::hours(24 * 30));
+        files.push_back(legacy.string());
+
+        utils::TokenEstimator estimator;
+        ContextPackerConfig packerConfig;
+        packerConfig.tokenBudget = 200;
+        packerConfig.maxCandidateFiles = 3;
+        ContextPacker packer(estimator, "test-model", packerConfig, std::make_shared<FileContentCache>());
+
+        auto packed = packer.packFiles("where is decodeFrame implemented?", files, {}, nullptr);
+        fs::remove_all(tempDir);
+
+        CHECK_TRUE(packed.render().find("decodeFrame") != std::string::npos);
+        CHECK_TRUE(packed.render().find("paintWidget") == std::string::npos);
+    }});
+
+    tests.push_back({"ContextManager_BuildCodeContextPacked", []() {
+        ConfigManager cfg;
+        ContextManager manager(cfg);
+
+        CodeContext codeContext;
+        codeContext.filePaths = {"src/main.cpp"};
+        codeContext.fileContent =
+            "int helper() {\n    return 1;\n}\n\nint main() {\n    return helper();\n}\n";
+        codeContext.focusArea = "main";
+
+        auto msg = manager.buildCodeContext(codeContext, "what does main return", "test-model", 512);
+        std::string text = std::string(*msg.textView());
+        CHECK_TRUE(text.find("src/main.cpp:5-7 (main)") != std::string::npos);
+        CHECK_TRUE(text.find("Focus Area: main") != std::string::npos);
+    }});
+
+    tests.push_back({"ContextManager_BuildContextPacksProjectSnippets", []() {
+        namespace fs = std::filesystem;
+        fs::path tempDir = fs::temp_directory_path() / "ContextManagerPackerTest";
+        fs::remove_all(tempDir);
+        fs::create_directories(tempDir / "src");
+        {
+            std::ofstream(tempDir / "CMakeLists.txt") << "project(PackerTest)\n";
+            std::ofstream(tempDir / "src" / "audio.h") << "#pragma once\nvoid startAudio();\n";
+            std::ofstream(tempDir / "src" / "audio.cpp")
+                << "#include \"audio.h\"\n\nvoid startAudio() {\n    // open device\n}\n";
+            std::ofstream(tempDir / "src" / "ui.cpp") << "void drawButton() {\n}\n";
+        }
+
+        ConfigManager cfg;
+        ContextManager manager(cfg);
+        ContextConfig config;
+        config.includeProjectContext = true;
+        config.includeConversationHistory = false;
+        config.projectPath = tempDir.string();
+        config.maxTokens = 100000;
+        config.contextSnippetTokens = 200;
+
+        auto messages = manager.buildContext(config, "How does startAudio open the device?", "test-model");
+        fs::remove_all(tempDir);
+
+        CHECK_TRUE(messages.size() >= 3);
+        std::string projectText = std::string(*messages[1].textView());
+        CHECK_TRUE(projectText.find("Relevant Code:") != std::string::npos);
+        CHECK_TRUE(projectText.find("(startAudio)") != std::string::npos);
+        CHECK_TRUE(projectText.find("drawButton") == std::string::npos);
+    }});
+
     return mini_test::run(tests);
 }
 
@@ -1,4 +1,5 @@
 #include "naw/desktop_pet/service/FunctionCallingHandler.h"
+#include "naw/desktop_pet/service/BlobStore.h"
 #include "naw/desktop_pet/service/ToolManager.h"
 #include "naw/desktop_pet/service/ToolCallContext.h"
 #include "naw/desktop_pet/service/ErrorHandler.h"
@@ -711,6 +712,42 @@ int main() {
         auto cached = context.getCachedResult("test_tool", arguments);
         CHECK_TRUE(cached.has_value());
         CHECK_EQ(cached.value()["output"], "cached");
+
+        // 命中时共享同一份已解析结果
+        auto shared1 = context.findCachedResult("test_tool", arguments);
+        auto shared2 = context.findCachedResult("test_tool", arguments);
+        CHECK_TRUE(shared1 != nullptr);
+        CHECK_TRUE(shared1.get() == shared2.get());
+    }});
+
+    tests.push_back({"ToolCallContext - large strings dedup with BlobStore", []() {
+        ToolCallContext context(true, 60000);
+        std::string fileText(4096, 'x');
+        fileText += "unique-tool-result-dedup";
+        // 模拟文件缓存已持有同样的字节
+        auto fileBlob = BlobStore::shared().intern(fileText, "file_cache");
+        auto before = BlobStore::shared().getStats();
+
+        FunctionCallResult result;
+        result.toolCallId = "call_big";
+        result.toolName = "read_file";
+        result.success = true;
+        result.result = nlohmann::json{{"content", fileText}, {"line_count", 1}};
+        nlohmann::json arguments = nlohmann::json{{"path", "big.txt"}};
+        context.recordToolCall(result, arguments);
+
+        auto after = BlobStore::shared().getStats();
+        CHECK_EQ(after.uniqueBlobs, before.uniqueBlobs);
+        CHECK_TRUE(after.subsystems["tool_result_cache"].referencedBytes >= fileText.size());
+
+        auto cached = context.findCachedResult("read_file", arguments);
+        CHECK_TRUE(cached != nullptr);
+        CHECK_TRUE(*cached == result.result);
+
+        // 按值取回：重建后的结果可直接移入 FunctionCallResult
+        auto value = context.getCachedResult("read_file", arguments);
+        CHECK_TRUE(value.has_value());
+        CHECK_TRUE(*value == result.result);
     }});
 
     tests.push_back({"executeToolCalls - with context - cache hit", []() {
@@ -1,12 +1,19 @@
 #include "naw/desktop_pet/service/ImageProcessor.h"
+#include "naw/desktop_pet/service/VisionLayer0.h"
+
+#include "naw/desktop_pet/service/utils/HttpSerialization.h"
 
 #include <cassert>
 #include <iostream>
+#include <string>
 #include <vector>
 
 using naw::desktop_pet::service::ImageProcessor;
+using naw::desktop_pet::service::VisionLayer0Result;
 using naw::desktop_pet::service::types::ImageData;
 using naw::desktop_pet::service::types::ImageFormat;
+using naw::desktop_pet::service::types::ImageView;
+using naw::desktop_pet::service::types::Rect;
 
 // 创建测试图像数据
 ImageData createTestImage(uint32_t width, uint32_t height, ImageFormat format) {
@@ -284,6 +291,215 @@ void testDifferentFormats() {
     std::cout << "  Different formats tests passed!\n";
 }
 
+// 测试带padding的零拷贝视图输入
+void testStridedView() {
+    std::cout << "Testing strided image view...\n";
+    
+    auto image = createTestImage(64, 48, ImageFormat::RGB);
+    const uint32_t rowBytes = 64 * 3;
+    const uint32_t stride = rowBytes + 16;
+    std::vector<uint8_t> padded(static_cast<size_t>(stride) * 48, 0xEE);
+    for (uint32_t y = 0; y < 48; ++y) {
+        std::copy(image.data.begin() + y * rowBytes, image.data.begin() + (y + 1) * rowBytes,
+                  padded.begin() + y * stride);
+    }
+    ImageView view(padded.data(), 64, 48, ImageFormat::RGB, stride);
+    assert(view.isValid());
+    assert(!view.isContinuous());
+    
+    // 相同尺寸缩放应逐字节还原原图（padding 不应进入结果）
+    {
+        auto same = ImageProcessor::resize(view, 64, 48, ImageProcessor::InterpolationMethod::Nearest);
+        assert(same.has_value());
+        assert(same->format == ImageFormat::RGB);
+        assert(same->stride == 0);
+        assert(same->data == image.data);
+    }
+    
+    // 视图与 ImageData 的缩放结果一致
+    {
+        auto fromView = ImageProcessor::resize(view, 32, 24);
+        auto fromData = ImageProcessor::resize(image, 32, 24);
+        assert(fromView.has_value() && fromData.has_value());
+        assert(fromView->data == fromData->data);
+    }
+    
+    // 裁剪结果是非连续 ROI，输出仍应为连续存储
+    {
+        auto cropped = ImageProcessor::resizeAndCrop(view, 32, 32);
+        assert(cropped.has_value());
+        assert(cropped->width == 32 && cropped->height == 32);
+        assert(cropped->data.size() == 32 * 32 * 3);
+    }
+    
+    // 压缩
+    {
+        auto compressed = ImageProcessor::compressToPNG(view, 3);
+        assert(compressed.has_value());
+        assert(!compressed->empty());
+    }
+    
+    std::cout << "  Strided view tests passed!\n";
+}
+
+// 测试编码到复用缓冲、字节预算与 data URL
+void testEncodeBuffer() {
+    std::cout << "Testing encode into reusable buffer...\n";
+    
+    // 伪随机噪声：JPEG 体积随质量明显变化
+    auto image = createTestImage(320, 240, ImageFormat::BGR);
+    uint32_t seed = 12345;
+    for (auto& byte : image.data) {
+        seed = seed * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(seed >> 24);
+    }
+    auto view = ImageView::fromImageData(image);
+    
+    // 结果与 compressToJPEG 一致，且复用已有容量
+    std::vector<uint8_t> buffer;
+    {
+        ImageProcessor::EncodeOptions options;
+        options.quality = 85;
+        auto result = ImageProcessor::encode(view, options, buffer);
+        assert(result.has_value());
+        assert(result->bytes == buffer.size());
+        assert(result->quality == 85 && result->attempts == 1 && result->withinBudget);
+        auto reference = ImageProcessor::compressToJPEG(image, 85);
+        assert(reference.has_value() && *reference == buffer);
+        
+        buffer.reserve(buffer.size() * 2);
+        const uint8_t* storage = buffer.data();
+        result = ImageProcessor::encode(view, options, buffer);
+        assert(result.has_value());
+        assert(buffer.data() == storage);
+    }
+    
+    // 字节预算：降低质量直到满足
+    {
+        const size_t full = buffer.size();
+        ImageProcessor::EncodeOptions options;
+        options.quality = 90;
+        options.maxBytes = full / 2;
+        auto result = ImageProcessor::encode(view, options, buffer);
+        assert(result.has_value());
+        assert(result->withinBudget);
+        assert(buffer.size() <= options.maxBytes);
+        assert(result->quality < 90 && result->quality >= options.minQuality);
+        assert(result->attempts > 1);
+        std::cout << "  Budget " << options.maxBytes << " bytes -> quality " << result->quality
+                  << ", " << result->bytes << " bytes, " << result->attempts << " attempts\n";
+        
+        // 预算无法满足时返回最低质量的结果
+        options.maxBytes = 16;
+        result = ImageProcessor::encode(view, options, buffer);
+        assert(result.has_value());
+        assert(!result->withinBudget);
+        assert(result->quality == options.minQuality);
+        assert(result->bytes == buffer.size());
+    }
+    
+    // data URL：前缀正确，Base64 解码后与直接编码一致
+    {
+        ImageProcessor::EncodeOptions options;
+        options.format = ImageProcessor::EncodeFormat::PNG;
+        options.quality = 3;
+        std::string url;
+        auto result = ImageProcessor::encodeToDataUrl(view, options, url);
+        assert(result.has_value());
+        const std::string prefix = "data:image/png;base64,";
+        assert(url.compare(0, prefix.size(), prefix) == 0);
+        auto decoded = naw::desktop_pet::service::utils::decodeBase64(url.substr(prefix.size()));
+        auto png = ImageProcessor::compressToPNG(view, 3);
+        assert(decoded.has_value() && png.has_value());
+        assert(*decoded == *png);
+        assert(url.size() == prefix.size() + naw::desktop_pet::service::utils::base64EncodedSize(png->size()));
+    }
+    
+    // 无效图像
+    {
+        ImageProcessor::EncodeOptions options;
+        assert(!ImageProcessor::encode(ImageView(), options, buffer).has_value());
+    }
+    
+    std::cout << "  Encode buffer tests passed!\n";
+}
+
+// 测试按活动区域裁剪
+void testRegionCrops() {
+    std::cout << "Testing active region crops...\n";
+    
+    auto image = createTestImage(1920, 1080, ImageFormat::BGR);
+    auto view = ImageView::fromImageData(image);
+    ImageProcessor::RegionCropConfig config;
+    
+    // token 估计（512 图块规则）
+    assert(ImageProcessor::estimateImageTokens(512, 512) == 255);
+    assert(ImageProcessor::estimateImageTokens(1920, 1080) == 85 + 170 * 6);
+    
+    // 没有区域：不裁剪
+    {
+        auto result = ImageProcessor::cropActiveRegions(view, std::vector<Rect>{}, config);
+        assert(result.crops.empty());
+        assert(result.fullFrameTokens == ImageProcessor::estimateImageTokens(1920, 1080));
+    }
+    
+    // 相距较远的两个小区域：分别裁剪，像素与原图一致
+    {
+        std::vector<Rect> regions = {Rect{100, 100, 40, 40}, Rect{1700, 900, 40, 40}};
+        auto result = ImageProcessor::cropActiveRegions(view, regions, config);
+        assert(!result.fullFrame);
+        assert(result.crops.size() == 2);
+        assert(result.totalTokens < result.fullFrameTokens);
+        for (size_t i = 0; i < regions.size(); ++i) {
+            const auto& crop = result.crops[i];
+            assert(crop.region.x <= regions[i].x && crop.region.y <= regions[i].y);
+            assert(crop.region.x + crop.region.width >= regions[i].x + regions[i].width);
+            assert(crop.image.width == crop.region.width && crop.image.height == crop.region.height);
+            assert(crop.image.data[0] == view.row(crop.region.y)[crop.region.x * 3]);
+        }
+        std::cout << "  2 crops: " << result.totalTokens << " tokens (full frame " << result.fullFrameTokens
+                  << ")\n";
+    }
+    
+    // 相邻的小区域合并为一块；超过数量上限时合并
+    {
+        auto merged = ImageProcessor::planRegionCrops({Rect{100, 100, 20, 20}, Rect{250, 150, 20, 20}},
+                                                      1920, 1080, config);
+        assert(merged.size() == 1);
+        
+        std::vector<Rect> many;
+        for (int32_t i = 0; i < 10; ++i) {
+            many.push_back(Rect{i * 190, (i % 2) * 900, 30, 30});
+        }
+        auto capped = ImageProcessor::planRegionCrops(many, 1920, 1080, config);
+        assert(!capped.empty() && capped.size() <= config.maxCrops);
+    }
+    
+    // 大面积变化：退化为整帧
+    {
+        auto result = ImageProcessor::cropActiveRegions(view, std::vector<Rect>{Rect{0, 0, 1500, 900}}, config);
+        assert(result.fullFrame);
+        assert(result.crops.size() == 1);
+        assert(result.crops[0].image.width == 1920);
+    }
+    
+    // Layer 0 结果：区域从处理分辨率映射回源图像，裁剪按分辨率控制缩放
+    {
+        VisionLayer0Result layer0;
+        layer0.processingWidth = 640;
+        layer0.processingHeight = 360;
+        layer0.changedRegions.push_back(Rect{20, 20, 100, 50});
+        config.resolution.maxWidth = 256;
+        auto result = ImageProcessor::cropActiveRegions(view, layer0, config);
+        assert(result.crops.size() == 1);
+        const auto& crop = result.crops[0];
+        assert(crop.region.x <= 60 && crop.region.x + crop.region.width >= 360);
+        assert(crop.image.width == 256);
+    }
+    
+    std::cout << "  Region crop tests passed!\n";
+}
+
 int main() {
     std::cout << "=== ImageProcessor Unit Tests ===\n\n";
     
@@ -306,6 +522,15 @@ int main() {
         testDifferentFormats();
         std::cout << "\n";
         
+        testStridedView();
+        std::cout << "\n";
+        
+        testEncodeBuffer();
+        std::cout << "\n";
+        
+        testRegionCrops();
+        std::cout << "\n";
+        
         std::cout << "=== All tests passed! ===\n";
         return 0;
     } catch (const std::exception& e) {
@@ -1,5 +1,6 @@
 #include "naw/desktop_pet/service/ProjectContextCollector.h"
 #include "naw/desktop_pet/service/ErrorTypes.h"
+#include "naw/desktop_pet/service/tools/CMakeParser.h"
 
 #include <filesystem>
 #include <fstream>
@@ -8,6 +9,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace naw::desktop_pet::service;
@@ -178,6 +180,86 @@ int main() {
         cleanupTempTestDir(tempDir);
     }});
     
+    tests.push_back({"CMakeParser_TokenizeMultilineQuotedAndComments", []() {
+        std::string content =
+            "#[[ block comment\n add_executable(ignored x.cpp) ]]\n"
+            "add_library(core STATIC   # trailing comment\n"
+            "    \"src/a file.cpp\"\n"
+            "    src/b.cpp) # add_executable(also_ignored y.cpp)\n"
+            "set(MSG [=[bracket ) arg]=])\n"
+            "TARGET_LINK_LIBRARIES(core PUBLIC fmt::fmt)\n";
+        auto commands = tools::CMakeParser::tokenize(content);
+        CHECK_EQ(commands.size(), 3u);
+        CHECK_EQ(commands[0].name, std::string("add_library"));
+        CHECK_EQ(commands[0].line, 3u);
+        CHECK_EQ(commands[0].arguments.size(), 4u);
+        CHECK_EQ(commands[0].arguments[2], std::string("src/a file.cpp"));
+        CHECK_EQ(commands[1].arguments[1], std::string("bracket ) arg"));
+        CHECK_EQ(commands[2].name, std::string("target_link_libraries"));
+        CHECK_EQ(commands[2].line, 7u);
+    }});
+    
+    tests.push_back({"CMakeParser_ProjectModelAcrossSubdirectories", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            {
+                std::ofstream root(tempDir / "CMakeLists.txt");
+                root << "project(GraphProject)\n"
+                     << "find_package(Threads REQUIRED)\n"
+                     << "add_subdirectory(lib)\n"
+                     << "add_executable(app\n    src/main.cpp\n)\n"
+                     << "target_link_libraries(app PRIVATE corelib Threads::Threads)\n";
+            }
+            fs::create_directories(tempDir / "lib");
+            {
+                std::ofstream lib(tempDir / "lib" / "CMakeLists.txt");
+                lib << "add_library(corelib ${CMAKE_CURRENT_SOURCE_DIR}/core.cpp)\n"
+                    << "target_include_directories(corelib PUBLIC include)\n";
+            }
+            createTestSourceFile(tempDir / "src" / "main.cpp", "int main() { return 0; }\n");
+            createTestSourceFile(tempDir / "lib" / "core.cpp", "int core() { return 1; }\n");
+            
+            auto model = tools::CMakeParser::loadProjectModel(tempDir);
+            CHECK_EQ(model->projectName, std::string("GraphProject"));
+            CHECK_EQ(model->files.size(), 2u);
+            
+            const tools::CMakeTarget* corelib = model->findTarget("corelib");
+            CHECK_TRUE(corelib != nullptr);
+            CHECK_EQ(corelib->definedIn, std::string("lib/CMakeLists.txt"));
+            CHECK_EQ(corelib->sources.size(), 1u);
+            CHECK_EQ(corelib->sources[0], std::string("lib/core.cpp"));
+            CHECK_EQ(corelib->includeDirs[0], std::string("lib/include"));
+            
+            auto internal = model->internalDependencies("app");
+            CHECK_EQ(internal.size(), 1u);
+            CHECK_EQ(internal[0], std::string("corelib"));
+            auto external = model->externalDependencies("app");
+            CHECK_EQ(external.size(), 1u);
+            CHECK_EQ(external[0], std::string("Threads::Threads"));
+            
+            // 内容未变化时复用同一份模型
+            auto again = tools::CMakeParser::loadProjectModel(tempDir);
+            CHECK_TRUE(again.get() == model.get());
+            
+            // 子目录文件变化时重新构建
+            {
+                std::ofstream lib(tempDir / "lib" / "CMakeLists.txt", std::ios::app);
+                lib << "add_library(extra extra.cpp)\n";
+            }
+            auto updated = tools::CMakeParser::loadProjectModel(tempDir);
+            CHECK_TRUE(updated.get() != model.get());
+            CHECK_TRUE(updated->findTarget("extra") != nullptr);
+            
+            auto config = ProjectContextCollector::parseCMakeLists((tempDir / "CMakeLists.txt").string());
+            CHECK_TRUE(config["target_graph"].contains("app"));
+            CHECK_EQ(config["target_graph"]["app"]["links"].size(), 1u);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+    
     // ========== analyzeProject 测试 ==========
     
     tests.push_back({"ProjectContextCollector_AnalyzeProject", []() {
@@ -445,7 +527,423 @@ int main() {
         CHECK_EQ(ProjectContextCollector::identifyFileType("config.json"), "config");
         CHECK_EQ(ProjectContextCollector::identifyFileType("unknown.xyz"), "other");
     }});
-    
+
+    // ========== 依赖图测试 ==========
+
+    tests.push_back({"ProjectDependencyGraph_ScanDirectives", []() {
+        auto cppIncludes = ProjectDependencyGraph::scanDirectives(
+            "#include \"a.h\"\n"
+            "  #  include <dir/b.h>\n"
+            "// #include \"c.h\"\n"
+            "int x;\n",
+            false
+        );
+        CHECK_EQ(cppIncludes.size(), 2u);
+        CHECK_EQ(cppIncludes[0], "a.h");
+        CHECK_EQ(cppIncludes[1], "dir/b.h");
+
+        auto pyImports = ProjectDependencyGraph::scanDirectives("import utils\nfrom x import y\n", true);
+        CHECK_EQ(pyImports.size(), 1u);
+        CHECK_EQ(pyImports[0], "utils");
+    }});
+
+    tests.push_back({"ProjectContextCollector_DependencyGraphBuiltByAnalyze", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            fs::path includeDir = tempDir / "include";
+            fs::create_directories(includeDir);
+            createTestSourceFile(includeDir / "header.h", "#pragma once\n");
+
+            fs::path srcDir = tempDir / "src";
+            fs::create_directories(srcDir);
+            createTestSourceFile(srcDir / "main.cpp", "#include \"header.h\"\nint main() { return 0; }\n");
+            createTestSourceFile(srcDir / "other.cpp", "int other() { return 0; }\n");
+
+            ProjectContextCollector collector;
+            auto info = collector.analyzeProject(tempDir.string());
+            CHECK_TRUE(info.dependencyGraph != nullptr);
+            CHECK_TRUE(collector.getDependencyGraph(tempDir.string()) == info.dependencyGraph);
+            CHECK_EQ(info.dependencyGraph->fileCount(), 3u);
+            CHECK_EQ(info.dependencyGraph->edgeCount(), 1u);
+
+            std::string mainPath = ProjectDependencyGraph::normalizeKey((fs::absolute(srcDir) / "main.cpp").string());
+            std::string headerPath = ProjectDependencyGraph::normalizeKey((fs::absolute(includeDir) / "header.h").string());
+
+            auto includes = ProjectContextCollector::extractIncludesFromSource(mainPath, info);
+            CHECK_EQ(includes.size(), 1u);
+            CHECK_EQ(includes[0], headerPath);
+
+            auto related = ProjectContextCollector::findRelatedFiles(headerPath, info);
+            CHECK_EQ(related.size(), 1u);
+            CHECK_EQ(related[0], mainPath);
+
+            // 再次分析同一项目时复用依赖图，未变化的文件不重新扫描
+            auto info2 = collector.analyzeProject(tempDir.string());
+            CHECK_TRUE(info2.dependencyGraph == info.dependencyGraph);
+            CHECK_EQ(info2.dependencyGraph->sync(info2.sourceFiles, info2.headerFiles), 0u);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"ProjectContextCollector_DependencyGraphIncrementalUpdate", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            fs::path srcDir = fs::absolute(tempDir / "src");
+            fs::create_directories(srcDir);
+            createTestSourceFile(srcDir / "a.h", "#pragma once\n");
+            createTestSourceFile(srcDir / "b.cpp", "int b() { return 0; }\n");
+
+            ProjectContextCollector collector;
+            auto info = collector.analyzeProject(tempDir.string());
+            std::string headerPath = ProjectDependencyGraph::normalizeKey((srcDir / "a.h").string());
+            std::string sourcePath = ProjectDependencyGraph::normalizeKey((srcDir / "b.cpp").string());
+            CHECK_TRUE(info.dependencyGraph->getIncludedBy(headerPath).empty());
+
+            // 修改文件后通过变更通知增量更新
+            createTestSourceFile(srcDir / "b.cpp", "#include \"a.h\"\nint b() { return 0; }\n");
+            collector.notifyFileChanged(sourcePath);
+            auto includedBy = info.dependencyGraph->getIncludedBy(headerPath);
+            CHECK_EQ(includedBy.size(), 1u);
+            CHECK_EQ(includedBy[0], sourcePath);
+
+            // 新增文件：通过 sync 加入并解析到已有头文件
+            createTestSourceFile(srcDir / "c.cpp", "#include \"a.h\"\n");
+            auto info2 = collector.analyzeProject(tempDir.string());
+            CHECK_EQ(info2.dependencyGraph->getIncludedBy(headerPath).size(), 2u);
+
+            // 删除头文件后，引用它的边被移除
+            fs::remove(srcDir / "a.h");
+            auto info3 = collector.analyzeProject(tempDir.string());
+            CHECK_TRUE(!info3.dependencyGraph->contains(headerPath));
+            CHECK_TRUE(info3.dependencyGraph->getIncludes(sourcePath).empty());
+            CHECK_EQ(info3.dependencyGraph->edgeCount(), 0u);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"ProjectContextCollector_SharedCacheChangeNotification", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            fs::path srcDir = fs::absolute(tempDir / "src");
+            fs::create_directories(srcDir);
+            createTestSourceFile(srcDir / "a.h", "#pragma once\n");
+            createTestSourceFile(srcDir / "b.cpp", "int b() { return 0; }\n");
+
+            auto sharedCache = std::make_shared<FileContentCache>();
+            std::string headerPath = ProjectDependencyGraph::normalizeKey((srcDir / "a.h").string());
+            std::string sourcePath = ProjectDependencyGraph::normalizeKey((srcDir / "b.cpp").string());
+            {
+                ProjectContextCollector collector(sharedCache);
+                auto info = collector.analyzeProject(tempDir.string());
+
+                // 其他组件（如 write_file）通过共享缓存发出的通知会更新依赖图
+                createTestSourceFile(srcDir / "b.cpp", "#include \"a.h\"\nint b() { return 0; }\n");
+                sharedCache->notifyFileChanged(sourcePath);
+                CHECK_EQ(info.dependencyGraph->getIncludedBy(headerPath).size(), 1u);
+            }
+
+            // 收集器析构后监听者已注销，通知不会访问已销毁的对象
+            sharedCache->notifyFileChanged(sourcePath);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    // ========== 文件内容缓存测试 ==========
+
+    tests.push_back({"FileContentCache_HitAndInvalidateOnChange", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            fs::path filePath = tempDir / "a.cpp";
+            createTestSourceFile(filePath, "int a;\n");
+
+            FileContentCache cache(1024);
+            auto first = cache.get(filePath.string());
+            CHECK_TRUE(first != nullptr);
+            CHECK_EQ(*first, "int a;\n");
+
+            auto second = cache.get(filePath.string());
+            CHECK_TRUE(second == first); // 命中时共享同一缓冲区
+            CHECK_EQ(cache.getStats().hits, 1u);
+            CHECK_EQ(cache.getStats().misses, 1u);
+
+            // 大小变化后重新读取
+            createTestSourceFile(filePath, "int a = 1;\n");
+            auto third = cache.get(filePath.string());
+            CHECK_EQ(*third, "int a = 1;\n");
+            CHECK_EQ(*first, "int a;\n"); // 旧缓冲区仍由持有者保留
+
+            CHECK_TRUE(cache.get((tempDir / "missing.cpp").string()) == nullptr);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"FileContentCache_ByteBudgetLru", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            const std::string body(100, 'x');
+            for (const char* name : {"a.txt", "b.txt", "c.txt"}) {
+                createTestSourceFile(tempDir / name, body);
+            }
+
+            FileContentCache cache(250);
+            cache.get((tempDir / "a.txt").string());
+            cache.get((tempDir / "b.txt").string());
+            cache.get((tempDir / "a.txt").string()); // a 变为最近使用
+            cache.get((tempDir / "c.txt").string()); // 淘汰 b
+
+            auto stats = cache.getStats();
+            CHECK_EQ(stats.entryCount, 2u);
+            CHECK_EQ(stats.totalBytes, 200u);
+            CHECK_EQ(stats.evictions, 1u);
+
+            cache.get((tempDir / "a.txt").string());
+            CHECK_EQ(cache.getStats().hits, 2u);
+
+            // 超过预算的单个文件不缓存，但仍返回内容
+            createTestSourceFile(tempDir / "big.txt", std::string(500, 'y'));
+            auto big = cache.get((tempDir / "big.txt").string());
+            CHECK_TRUE(big != nullptr);
+            CHECK_EQ(big->size(), 500u);
+            CHECK_TRUE(cache.getStats().totalBytes <= 250u);
+
+            cache.setMaxBytes(100);
+            CHECK_EQ(cache.getStats().entryCount, 1u);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"FileContentCache_ConcurrentReadsDeduplicated", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            fs::path filePath = tempDir / "shared.cpp";
+            createTestSourceFile(filePath, std::string(64 * 1024, 'z'));
+
+            FileContentCache cache;
+            std::vector<std::thread> threads;
+            std::vector<FileContentCache::Content> results(8);
+            for (size_t i = 0; i < results.size(); ++i) {
+                threads.emplace_back([&cache, &results, &filePath, i]() {
+                    results[i] = cache.get(filePath.string());
+                });
+            }
+            for (auto& t : threads) {
+                t.join();
+            }
+
+            for (const auto& r : results) {
+                CHECK_TRUE(r != nullptr);
+                CHECK_EQ(r->size(), 64u * 1024u);
+            }
+            CHECK_EQ(cache.getStats().misses, 1u);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"FileContentCache_CachedModifyTime", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            fs::path file = tempDir / "recent.cpp";
+            createTestSourceFile(file, "int recent() { return 0; }\n");
+            const std::string path = file.string();
+
+            FileContentCache cache;
+            CHECK_FALSE(cache.cachedModifyTime(path).has_value());
+            CHECK_TRUE(cache.get(path) != nullptr);
+            auto recorded = cache.cachedModifyTime(path);
+            CHECK_TRUE(recorded.has_value());
+            CHECK_TRUE(*recorded == fs::last_write_time(file));
+            cache.invalidate(path);
+            CHECK_FALSE(cache.cachedModifyTime(path).has_value());
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"ProjectContextCollector_SharedFileCache", []() {
+        auto shared = FileContentCache::shared();
+        ProjectContextCollector collector(shared);
+        CHECK_TRUE(collector.getFileCache() == shared);
+
+        ProjectContextCollector standalone;
+        CHECK_TRUE(standalone.getFileCache() != nullptr);
+        CHECK_TRUE(standalone.getFileCache() != shared);
+        standalone.setFileCacheLimitMB(1);
+        CHECK_EQ(standalone.getFileCache()->getMaxBytes(), 1024u * 1024u);
+    }});
+
+    tests.push_back({"ProjectContextCollector_BackgroundWarmup", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            createTestSourceFile(tempDir / "CMakeLists.txt",
+                                 "project(WarmApp)\nadd_executable(warm src/main.cpp)\n");
+            createTestSourceFile(tempDir / "src" / "main.cpp", "#include \"util.h\"\nint main() { return util(); }\n");
+            createTestSourceFile(tempDir / "src" / "util.h", "inline int util() { return 0; }\n");
+
+            ProjectContextCollector collector;
+            CHECK_TRUE(collector.getWarmupStatus().state == WarmupState::Idle);
+            CHECK_TRUE(collector.startWarmup(tempDir.string()));
+            CHECK_TRUE(collector.waitForWarmup(std::chrono::seconds(30)));
+
+            auto status = collector.getWarmupStatus();
+            CHECK_TRUE(status.state == WarmupState::Ready);
+            CHECK_TRUE(status.partialAvailable);
+            CHECK_EQ(status.filesTotal, 2u);
+            CHECK_EQ(status.filesIndexed, 2u);
+            CHECK_EQ(status.toJson()["state"].get<std::string>(), std::string("ready"));
+            CHECK_FALSE(collector.startWarmup(tempDir.string()));
+
+            // 依赖图与文件内容已在预热阶段构建/预读
+            auto graph = collector.getDependencyGraph(tempDir.string());
+            CHECK_TRUE(graph != nullptr);
+            CHECK_EQ(collector.getFileCache()->getStats().entryCount, 2u);
+
+            ProjectInfo info = collector.analyzeProject(tempDir.string());
+            CHECK_EQ(info.name, std::string("WarmApp"));
+            CHECK_EQ(info.sourceFiles.size(), 1u);
+            CHECK_TRUE(info.dependencyGraph == graph);
+            CHECK_FALSE(info.partial);
+            CHECK_TRUE(info.directoryStructure.has_value());
+
+            // 新增源文件并通知后，复用的预热文件列表失效，重新扫描能看到新文件
+            fs::path extra = tempDir / "src" / "extra.cpp";
+            createTestSourceFile(extra, "#include \"util.h\"\nint extra() { return util(); }\n");
+            collector.notifyFileChanged(fs::absolute(extra).string());
+            info = collector.analyzeProject(tempDir.string());
+            CHECK_EQ(info.sourceFiles.size(), 2u);
+            CHECK_TRUE(info.dependencyGraph == graph);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"ProjectContextCollector_CancelWarmupMidScan", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            for (int i = 0; i < 200; ++i) {
+                createTestSourceFile(tempDir / ("dir" + std::to_string(i % 10)) / ("f" + std::to_string(i) + ".cpp"),
+                                     "int f" + std::to_string(i) + "() { return 0; }\n");
+            }
+
+            ProjectContextCollector collector;
+            CHECK_TRUE(collector.startWarmup(tempDir.string()));
+            collector.cancelWarmup();
+            auto status = collector.getWarmupStatus();
+            CHECK_TRUE(status.state == WarmupState::Cancelled || status.state == WarmupState::Ready);
+
+            // 取消后不复用可能不完整的结果
+            ProjectInfo info = collector.analyzeProject(tempDir.string());
+            CHECK_FALSE(info.partial);
+            CHECK_EQ(info.sourceFiles.size(), 200u);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"ProjectContextCollector_ConcurrentStartWarmup", []() {
+        fs::path tempDir = createTempTestDir();
+        fs::path dirA = tempDir / "a";
+        fs::path dirB = tempDir / "b";
+        try {
+            createTestSourceFile(dirA / "src" / "a.cpp", "int a() { return 0; }\n");
+            createTestSourceFile(dirB / "src" / "b.cpp", "int b() { return 0; }\n");
+
+            ProjectContextCollector collector;
+            std::vector<std::thread> threads;
+            for (int i = 0; i < 8; ++i) {
+                threads.emplace_back([&collector, &dirA, &dirB, i]() {
+                    collector.startWarmup((i % 2 == 0 ? dirA : dirB).string());
+                });
+            }
+            for (auto& t : threads) {
+                t.join();
+            }
+            CHECK_TRUE(collector.waitForWarmup(std::chrono::seconds(30)));
+            CHECK_TRUE(collector.getWarmupStatus().state != WarmupState::Warming);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"ProjectContextCollector_PartialSummaryNotCached", []() {
+        fs::path tempDir = createTempTestDir();
+        try {
+            createTestSourceFile(tempDir / "CMakeLists.txt", "project(PartialApp)\n");
+
+            ProjectContextCollector collector;
+            ProjectInfo partialInfo;
+            partialInfo.rootPath = tempDir.string();
+            partialInfo.name = "PartialApp";
+            partialInfo.sourceFiles = {"a.cpp"};
+            partialInfo.partial = true;
+            std::string partialSummary = collector.getProjectSummary(partialInfo);
+            CHECK_TRUE(partialSummary.find("Source Files: 1") != std::string::npos);
+
+            ProjectInfo fullInfo = partialInfo;
+            fullInfo.sourceFiles = {"a.cpp", "b.cpp"};
+            fullInfo.partial = false;
+            std::string fullSummary = collector.getProjectSummary(fullInfo);
+            CHECK_TRUE(fullSummary.find("Source Files: 2") != std::string::npos);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
+    tests.push_back({"ProjectContextCollector_ClearSharedFileCacheScoped", []() {
+        fs::path tempDir = createTempTestDir();
+        fs::path projectDir = tempDir / "project";
+        fs::path otherDir = tempDir / "other";
+        try {
+            createTestSourceFile(projectDir / "src" / "main.cpp", "int main() { return 0; }\n");
+            createTestSourceFile(otherDir / "notes.txt", "other consumer\n");
+
+            auto cache = std::make_shared<FileContentCache>();
+            ProjectContextCollector collector(cache);
+            collector.analyzeProject(projectDir.string());
+            CHECK_TRUE(cache->get(fs::absolute(projectDir / "src" / "main.cpp").string()) != nullptr);
+            CHECK_TRUE(cache->get(fs::absolute(otherDir / "notes.txt").string()) != nullptr);
+            CHECK_EQ(cache->getStats().entryCount, 2u);
+
+            // 共享缓存只清理本收集器项目目录下的条目
+            collector.clearFileCache();
+            CHECK_EQ(cache->getStats().entryCount, 1u);
+            auto misses = cache->getStats().misses;
+            CHECK_TRUE(cache->get(fs::absolute(otherDir / "notes.txt").string()) != nullptr);
+            CHECK_EQ(cache->getStats().misses, misses);
+        } catch (...) {
+            cleanupTempTestDir(tempDir);
+            throw;
+        }
+        cleanupTempTestDir(tempDir);
+    }});
+
     // 运行所有测试
     return mini_test::run(tests);
 }
@@ -1,11 +1,15 @@
 #include "naw/desktop_pet/service/ScreenCapture.h"
 #include "naw/desktop_pet/service/ImageProcessor.h"
+#include "naw/desktop_pet/service/ReplayScreenCapture.h"
 
 #ifdef _WIN32
 #include <windows.h>
 #include "naw/desktop_pet/service/platform/ScreenCaptureWindows.h"
+#elif defined(__linux__) && defined(NAW_HAS_X11_CAPTURE)
+#include "naw/desktop_pet/service/platform/ScreenCaptureLinux.h"
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cstdint>
@@ -18,6 +22,7 @@
 using naw::desktop_pet::service::ScreenCapture;
 using naw::desktop_pet::service::CaptureOptions;
 using naw::desktop_pet::service::ImageProcessor;
+using naw::desktop_pet::service::ReplayScreenCapture;
 using naw::desktop_pet::service::types::ImageData;
 using naw::desktop_pet::service::types::ImageFormat;
 using naw::desktop_pet::service::types::DisplayInfo;
@@ -101,6 +106,110 @@ void writeInt32LE(std::ofstream& file, int32_t value) {
     writeUint32LE(file, static_cast<uint32_t>(value));
 }
 
+// 测试回放/合成采集源（不需要显示器）
+void testReplayCapture() {
+    std::cout << "\n=== Test Replay Capture ===" << std::endl;
+    
+    // 合成源：每帧在不同位置画一个 16x16 的方块，变化区域只覆盖新旧方块所在的块
+    ReplayScreenCapture synthetic(256, 128, [](uint64_t index, ImageData& frame) {
+        std::fill(frame.data.begin(), frame.data.end(), 0);
+        const uint32_t x0 = static_cast<uint32_t>(index % 4) * 64;
+        for (uint32_t y = 8; y < 24; ++y) {
+            for (uint32_t x = x0; x < x0 + 16; ++x) {
+                frame.data[(y * frame.width + x) * 4 + 2] = 255;
+            }
+        }
+    });
+    
+    auto first = synthetic.captureFullScreenView();
+    assert(first.has_value() && first->width == 256 && first->height == 128);
+    auto damage = synthetic.getLastDamage();
+    assert(damage.has_value() && damage->size() == 1 && (*damage)[0].width == 256);
+    
+    auto second = synthetic.captureFullScreenView();
+    assert(second.has_value());
+    damage = synthetic.getLastDamage();
+    assert(damage.has_value() && damage->size() == 2);
+    assert((*damage)[0].x == 0 && (*damage)[0].width == 32 && (*damage)[0].height == 32);
+    assert((*damage)[1].x == 64 && (*damage)[1].width == 32);
+    
+    // 双缓冲复用：第三帧写回第一帧的缓冲
+    auto third = synthetic.captureFullScreenView();
+    assert(third.has_value() && third->data == first->data);
+    assert(synthetic.getFrameCount() == 3);
+    
+    // 回放源：相同的帧没有变化区域，不循环时播放完后失败
+    ImageData still;
+    still.allocate(64, 32, ImageFormat::BGR);
+    std::vector<ImageData> frames = {still, still};
+    frames[1].data[0] = 1;
+    ReplayScreenCapture replay({still, still, frames[1]}, false);
+    auto replayFirst = replay.captureFullScreen();
+    assert(replayFirst.has_value());
+    auto replaySecond = replay.captureFullScreen();
+    assert(replaySecond.has_value());
+    damage = replay.getLastDamage();
+    assert(damage.has_value() && damage->empty());
+    auto last = replay.captureFullScreen();
+    assert(last.has_value() && last->data[0] == 1);
+    damage = replay.getLastDamage();
+    assert(damage.has_value() && damage->size() == 1 && (*damage)[0].x == 0 && (*damage)[0].y == 0);
+    auto exhausted = replay.captureFullScreen();
+    assert(!exhausted.has_value());
+    assert(!replay.getLastError().empty());
+    
+    // 区域截图取当前帧
+    auto region = replay.captureRegion(Rect{0, 0, 8, 4});
+    assert(region.has_value() && region->width == 8 && region->height == 4 && region->data[0] == 1);
+    replay.rewind();
+    auto rewound = replay.captureFullScreen();
+    assert(rewound.has_value());
+    
+    std::cout << "Replay capture tests passed" << std::endl;
+}
+
+#if defined(__linux__) && defined(NAW_HAS_X11_CAPTURE)
+// 测试X11采集（共享内存缓冲复用与变化区域），在Xvfb下运行
+void testLinuxCapture(ScreenCapture* capture) {
+    std::cout << "\n=== Test Linux Capture ===" << std::endl;
+    
+    auto* linuxCapture = dynamic_cast<naw::desktop_pet::service::platform::ScreenCaptureLinux*>(capture);
+    if (!linuxCapture) {
+        return;
+    }
+    std::cout << "  Method: " << linuxCapture->getCaptureMethod() << std::endl;
+    std::cout << "  Damage tracking: " << (linuxCapture->isDamageTrackingEnabled() ? "Yes" : "No") << std::endl;
+    
+    auto first = capture->captureFullScreenView(0);
+    assert(first.has_value() && first->isValid());
+    assert(first->format == ImageFormat::BGRA);
+    if (linuxCapture->isDamageTrackingEnabled()) {
+        auto damage = capture->getLastDamage();
+        assert(damage.has_value() && damage->size() == 1);
+        assert((*damage)[0].width == first->width && (*damage)[0].height == first->height);
+    }
+    
+    // 连续采集复用同一块缓冲
+    auto second = capture->captureFullScreenView(0);
+    assert(second.has_value() && second->data == first->data);
+    auto damage = capture->getLastDamage();
+    std::cout << "  Damaged regions since previous frame: "
+              << (damage ? std::to_string(damage->size()) : std::string("unknown")) << std::endl;
+    
+    // 超过最大帧龄时即使没有DAMAGE报告也重新采集，并整帧报告为变化
+    if (linuxCapture->isDamageTrackingEnabled()) {
+        linuxCapture->setMaxFrameAge(std::chrono::milliseconds(0));
+        auto forced = capture->captureFullScreenView(0);
+        assert(forced.has_value());
+        auto forcedDamage = capture->getLastDamage();
+        assert(forcedDamage.has_value() && !forcedDamage->empty());
+        linuxCapture->setMaxFrameAge(std::chrono::milliseconds(1000));
+    }
+    
+    std::cout << "Linux capture tests passed" << std::endl;
+}
+#endif
+
 // 测试显示器枚举
 void testDisplayEnumeration(ScreenCapture* capture) {
     std::cout << "\n=== Test Display Enumeration ===" << std::endl;
@@ -476,13 +585,16 @@ void testPerformance(ScreenCapture* capture) {
 
 int main() {
     std::cout << "========================================" << std::endl;
-    std::cout << "ScreenCapture Test Program (Windows)" << std::endl;
+    std::cout << "ScreenCapture Test Program" << std::endl;
     std::cout << "========================================" << std::endl;
     
-    // 检查平台支持
+    // 回放源不依赖显示器，总是运行
+    testReplayCapture();
+    
+    // 检查平台支持（Linux需要X服务器，CI中可用Xvfb）
     if (!ScreenCapture::isSupported()) {
-        std::cerr << "Error: Screen capture not supported on this platform" << std::endl;
-        return 1;
+        std::cout << "Screen capture not supported in this environment, skipping platform tests" << std::endl;
+        return 0;
     }
     
     // 创建ScreenCapture实例
@@ -550,6 +662,9 @@ int main() {
     
     try {
         // 运行测试
+#if defined(__linux__) && defined(NAW_HAS_X11_CAPTURE)
+        testLinuxCapture(capture.get());
+#endif
         testDisplayEnumeration(capture.get());
         testFullScreenCapture(capture.get());
         testRegionCapture(capture.get());
@@ -904,6 +904,169 @@ int main() {
         // ErrorHandler应该已经记录了日志（我们无法直接验证，但不会崩溃）
     }});
 
+    // ========== 输出预算测试 ==========
+
+    tests.push_back({"OutputBudget_TruncateTextAndPage", []() {
+        ToolManager manager;
+        ToolOutputBudget budget;
+        budget.maxTokens = 600;
+        manager.setOutputBudget(budget);
+
+        ToolDefinition tool;
+        tool.name = "big_file";
+        tool.description = "Return a large file content";
+        tool.parametersSchema = nlohmann::json{
+            {"type", "object"},
+            {"properties", nlohmann::json::object()},
+            {"required", nlohmann::json::array()}
+        };
+        tool.handler = [](const nlohmann::json&) -> nlohmann::json {
+            std::string content;
+            for (int i = 0; i < 2000; ++i) {
+                content += "line " + std::to_string(i) + " of a very large file\n";
+            }
+            return nlohmann::json{{"path", "big.cpp"}, {"content", content}};
+        };
+        CHECK_TRUE(manager.registerTool(tool));
+        CHECK_FALSE(manager.hasTool(ToolOutputGovernor::kPagingToolName));
+
+        auto result = manager.executeTool("big_file", nlohmann::json::object());
+        CHECK_TRUE(result.has_value());
+        CHECK_TRUE(manager.getOutputGovernor().estimateTokens(*result) <= 600);
+        CHECK_EQ(result->at("path").get<std::string>(), std::string("big.cpp"));
+
+        // 保留首尾行
+        const std::string content = result->at("content").get<std::string>();
+        CHECK_TRUE(content.rfind("line 0 of", 0) == 0);
+        CHECK_TRUE(content.find("line 1999 of") != std::string::npos);
+        CHECK_TRUE(content.find("line 1000 of") == std::string::npos);
+
+        const auto& meta = result->at(ToolOutputGovernor::kMetaKey);
+        CHECK_TRUE(meta.at("truncated").get<bool>());
+        CHECK_TRUE(meta.at("total_tokens").get<size_t>() > 600);
+        CHECK_EQ(meta.at("omitted")[0].at("pointer").get<std::string>(), std::string("/content"));
+        CHECK_EQ(meta.at("omitted")[0].at("unit").get<std::string>(), std::string("lines"));
+        const std::string handle = meta.at("handle").get<std::string>();
+
+        // 分页工具已自动注册，可按行读取完整内容
+        CHECK_TRUE(manager.hasTool(ToolOutputGovernor::kPagingToolName));
+        auto page = manager.executeTool(ToolOutputGovernor::kPagingToolName,
+                                        {{"handle", handle}, {"pointer", "/content"}, {"offset", 1000}, {"page_tokens", 200}});
+        CHECK_TRUE(page.has_value());
+        CHECK_TRUE(page->at("content").get<std::string>().rfind("line 1000 of", 0) == 0);
+        CHECK_TRUE(page->at("has_more").get<bool>());
+        CHECK_TRUE(page->at("next_offset").get<size_t>() > 1000);
+
+        auto missing = manager.executeTool(ToolOutputGovernor::kPagingToolName, {{"handle", "tool_result_999"}});
+        CHECK_TRUE(missing.has_value());
+        CHECK_TRUE(missing->contains("error"));
+
+        // 预算内的结果原样返回
+        CHECK_TRUE(manager.registerTool(createAddTool()));
+        auto small = manager.executeTool("add", {{"a", 1}, {"b", 2}});
+        CHECK_TRUE(small.has_value());
+        CHECK_FALSE(small->contains(ToolOutputGovernor::kMetaKey));
+    }});
+
+    tests.push_back({"OutputBudget_FallbackPreviewUsesCompactText", []() {
+        ToolManager manager;
+        ToolOutputBudget budget;
+        budget.maxTokens = 600;
+        manager.setOutputBudget(budget);
+
+        ToolDefinition tool;
+        tool.name = "many_fields";
+        tool.description = "Return many small fields";
+        tool.parametersSchema = nlohmann::json{
+            {"type", "object"},
+            {"properties", nlohmann::json::object()},
+            {"required", nlohmann::json::array()}
+        };
+        tool.handler = [](const nlohmann::json&) -> nlohmann::json {
+            // 大量小字段无法按字段截断，只能退化为整体预览
+            nlohmann::json result = nlohmann::json::object();
+            for (int i = 0; i < 1500; ++i) {
+                result["field_" + std::to_string(i)] = i;
+            }
+            return result;
+        };
+        CHECK_TRUE(manager.registerTool(tool));
+
+        auto result = manager.executeTool("many_fields", nlohmann::json::object());
+        CHECK_TRUE(result.has_value());
+        CHECK_TRUE(manager.getOutputGovernor().estimateTokens(*result) <= 600);
+        const std::string preview = result->at("preview").get<std::string>();
+        CHECK_TRUE(preview.rfind("{\"field_", 0) == 0);
+        CHECK_TRUE(preview.find("\n  ") == std::string::npos);
+        CHECK_EQ(result->at(ToolOutputGovernor::kMetaKey).at("omitted")[0].at("pointer").get<std::string>(),
+                 std::string(""));
+    }});
+
+    tests.push_back({"OutputBudget_SearchMatchesRoundRobinAndEviction", []() {
+        ToolManager manager;
+        ToolOutputBudget budget;
+        budget.maxTokens = 800;
+        budget.maxStoredResults = 2;
+        manager.setOutputBudget(budget);
+
+        ToolDefinition tool;
+        tool.name = "search";
+        tool.description = "Return many matches";
+        tool.parametersSchema = nlohmann::json{
+            {"type", "object"},
+            {"properties", nlohmann::json::object()},
+            {"required", nlohmann::json::array()}
+        };
+        tool.handler = [](const nlohmann::json&) -> nlohmann::json {
+            nlohmann::json matches = nlohmann::json::array();
+            // a.cpp 有大量匹配，b.cpp / c.cpp 各只有一条且排在最后
+            for (int i = 0; i < 500; ++i) {
+                matches.push_back({{"file", "a.cpp"}, {"line", i + 1}, {"context", "int value = compute();"}});
+            }
+            matches.push_back({{"file", "b.cpp"}, {"line", 7}, {"context", "int value = compute();"}});
+            matches.push_back({{"file", "c.cpp"}, {"line", 9}, {"context", "int value = compute();"}});
+            return nlohmann::json{{"matches", matches}, {"total_matches", matches.size()}};
+        };
+        CHECK_TRUE(manager.registerTool(tool));
+
+        auto result = manager.executeTool("search", nlohmann::json::object());
+        CHECK_TRUE(result.has_value());
+        CHECK_TRUE(manager.getOutputGovernor().estimateTokens(*result) <= 800);
+        CHECK_EQ(result->at("total_matches").get<size_t>(), static_cast<size_t>(502));
+
+        const auto& matches = result->at("matches");
+        CHECK_TRUE(matches.size() > 2 && matches.size() < 502);
+        bool hasB = false;
+        bool hasC = false;
+        for (const auto& m : matches) {
+            hasB = hasB || m.at("file") == "b.cpp";
+            hasC = hasC || m.at("file") == "c.cpp";
+        }
+        CHECK_TRUE(hasB);
+        CHECK_TRUE(hasC);
+
+        const auto& omitted = result->at(ToolOutputGovernor::kMetaKey).at("omitted")[0];
+        CHECK_EQ(omitted.at("unit").get<std::string>(), std::string("items"));
+        CHECK_EQ(omitted.at("total").get<size_t>(), static_cast<size_t>(502));
+        CHECK_EQ(omitted.at("kept").get<size_t>(), matches.size());
+
+        // 按元素分页读取完整匹配列表
+        const std::string handle = result->at(ToolOutputGovernor::kMetaKey).at("handle").get<std::string>();
+        std::string error;
+        auto page = manager.getOutputGovernor().readPage(handle, "/matches", 495, 1000, &error);
+        CHECK_TRUE(page.has_value());
+        CHECK_EQ(page->at("items").size(), static_cast<size_t>(7));
+        CHECK_FALSE(page->at("has_more").get<bool>());
+        CHECK_EQ(page->at("items")[6].at("file").get<std::string>(), std::string("c.cpp"));
+        CHECK_FALSE(manager.getOutputGovernor().readPage(handle, "/missing", 0, 1000, &error).has_value());
+
+        // 超出保存数量后淘汰最早的结果
+        manager.executeTool("search", nlohmann::json::object());
+        manager.executeTool("search", nlohmann::json::object());
+        CHECK_EQ(manager.getOutputGovernor().storedCount(), static_cast<size_t>(2));
+        CHECK_FALSE(manager.getOutputGovernor().hasResult(handle));
+    }});
+
     return mini_test::run(tests);
 }
 
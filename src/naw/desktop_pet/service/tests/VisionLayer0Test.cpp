@@ -1,15 +1,41 @@
 #include "naw/desktop_pet/service/VisionLayer0.h"
+#include "naw/desktop_pet/service/VisionLayer1.h"
+#include "naw/desktop_pet/service/VisionKernels.h"
+#include "naw/desktop_pet/service/VisionPipeline.h"
+#include "naw/desktop_pet/service/VisionScheduler.h"
 
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <chrono>
+#include <thread>
 
+using naw::desktop_pet::service::Detection;
+using naw::desktop_pet::service::DetectionBackend;
+using naw::desktop_pet::service::TileChangeMap;
+using naw::desktop_pet::service::TileHashGrid;
+using naw::desktop_pet::service::VisionKernels;
 using naw::desktop_pet::service::VisionLayer0;
 using naw::desktop_pet::service::VisionLayer0Config;
+using naw::desktop_pet::service::VisionLayer0FrameOptions;
 using naw::desktop_pet::service::VisionLayer0Result;
+using naw::desktop_pet::service::VisionLayer1;
+using naw::desktop_pet::service::VisionLayer1Config;
+using naw::desktop_pet::service::FrameDropPolicy;
+using naw::desktop_pet::service::VisionFrame;
+using naw::desktop_pet::service::VisionPipeline;
+using naw::desktop_pet::service::VisionPipelineConfig;
+using naw::desktop_pet::service::VisionPipelineStages;
+using naw::desktop_pet::service::VisionStage;
+using naw::desktop_pet::service::VisionScheduler;
+using naw::desktop_pet::service::VisionSchedulerConfig;
 using naw::desktop_pet::service::types::ImageData;
 using naw::desktop_pet::service::types::ImageFormat;
+using naw::desktop_pet::service::types::ImageView;
+using naw::desktop_pet::service::types::Rect;
+using naw::desktop_pet::service::utils::SpscQueue;
 
 // 创建测试图像数据
 ImageData createTestImage(uint32_t width, uint32_t height, ImageFormat format, 
@@ -332,6 +358,459 @@ void testConfigUpdate() {
     std::cout << "  Config update tests passed!\n";
 }
 
+// 测试带padding的零拷贝视图输入
+void testStridedView() {
+    std::cout << "Testing strided image view...\n";
+    
+    VisionLayer0Config config;
+    config.processingWidth = 320;
+    config.processingHeight = 240;
+    config.enableAdaptiveThreshold = false;
+    
+    // 在每行末尾加入64字节padding，padding区域填充噪声，不应影响结果
+    auto base = createTestImage(640, 480, ImageFormat::RGB, 128, 128, 128);
+    auto changed = createChangedImage(base, 100, 100, 200, 200, 255, 0, 0);
+    const uint32_t rowBytes = 640 * 3;
+    const uint32_t stride = rowBytes + 64;
+    auto makePadded = [&](const ImageData& src) {
+        std::vector<uint8_t> buffer(static_cast<size_t>(stride) * src.height);
+        for (uint32_t y = 0; y < src.height; ++y) {
+            for (uint32_t i = 0; i < stride; ++i) {
+                buffer[y * stride + i] = static_cast<uint8_t>((y * 31 + i * 17) & 0xFF);
+            }
+            std::copy(src.data.begin() + y * rowBytes, src.data.begin() + (y + 1) * rowBytes,
+                      buffer.begin() + y * stride);
+        }
+        return buffer;
+    };
+    auto paddedBase = makePadded(base);
+    auto paddedChanged = makePadded(changed);
+    
+    VisionLayer0 viaView(config);
+    VisionLayer0 viaData(config);
+    viaView.processFrame(ImageView(paddedBase.data(), 640, 480, ImageFormat::RGB, stride));
+    viaData.processFrame(base);
+    auto viewResult = viaView.processFrame(ImageView(paddedChanged.data(), 640, 480, ImageFormat::RGB, stride));
+    auto dataResult = viaData.processFrame(changed);
+    
+    // 视图与连续存储的 ImageData 应得到相同结果
+    assert(viewResult.frameDiffScore > 0.0);
+    assert(viewResult.frameDiffScore == dataResult.frameDiffScore);
+    assert(viewResult.colorChangeScore == dataResult.colorChangeScore);
+    assert(viewResult.changedRegions.size() == dataResult.changedRegions.size());
+    
+    // 双缓冲交换后连续多帧仍然正确：相同帧没有变化
+    auto same = viaView.processFrame(ImageView(paddedChanged.data(), 640, 480, ImageFormat::RGB, stride));
+    assert(same.frameDiffScore == 0.0);
+    
+    // 子区域视图不复制数据
+    ImageView full(paddedChanged.data(), 640, 480, ImageFormat::RGB, stride);
+    ImageView sub = full.subView(100, 100, 1000, 200);
+    assert(sub.isValid());
+    assert(sub.width == 540 && sub.height == 200);
+    assert(sub.stride == stride);
+    assert(sub.data == full.row(100) + 300);
+    
+    std::cout << "  Strided view tests passed!\n";
+}
+
+// 测试融合内核（缩放 + 灰度 + 帧差 + 图块统计）
+void testFusedKernel() {
+    std::cout << "Testing fused downscale/diff kernel...\n";
+    
+    auto base = createTestImage(1920, 1080, ImageFormat::RGB, 90, 120, 200);
+    auto changed = createChangedImage(base, 960, 540, 120, 90, 255, 255, 255);
+    
+    VisionKernels::DownscaleDiffParams params;
+    params.dstWidth = 640;
+    params.dstHeight = 360;
+    params.diffThreshold = 25;
+    params.tileSize = 16;
+    
+    std::vector<uint8_t> prevGray(640 * 360);
+    std::vector<uint8_t> gray(640 * 360);
+    std::vector<uint8_t> bgr(640 * 360 * 3);
+    std::vector<uint8_t> mask(640 * 360);
+    TileChangeMap tiles;
+    
+    // 纯色图像：灰度值符合 BT.601，彩色输出为 BGR
+    assert(VisionKernels::downscaleGrayDiff(ImageView::fromImageData(base), params, prevGray.data(), bgr.data(),
+                                            nullptr, nullptr, tiles));
+    assert(prevGray[0] == static_cast<uint8_t>((29 * 4 * 200 + 150 * 4 * 120 + 77 * 4 * 90 + 512) >> 10));
+    assert(bgr[0] == 200 && bgr[1] == 120 && bgr[2] == 90);
+    assert(!tiles.anyChanged());
+    
+    // 相同帧：没有变化图块
+    assert(VisionKernels::downscaleGrayDiff(ImageView::fromImageData(base), params, gray.data(), nullptr,
+                                            prevGray.data(), mask.data(), tiles));
+    assert(!tiles.anyChanged());
+    assert(tiles.dirtyRegions().empty());
+    
+    // 局部变化：只有覆盖变化区域的图块是脏的，且各 SIMD 实现结果一致
+    const auto original = VisionKernels::simdLevel();
+    std::vector<uint8_t> scalarMask(640 * 360);
+    VisionKernels::setSimdLevel(VisionKernels::SimdLevel::Scalar);
+    assert(VisionKernels::downscaleGrayDiff(ImageView::fromImageData(changed), params, gray.data(), nullptr,
+                                            prevGray.data(), scalarMask.data(), tiles));
+    const auto scalarTiles = tiles.changedPixels;
+    VisionKernels::setSimdLevel(original);
+    assert(VisionKernels::downscaleGrayDiff(ImageView::fromImageData(changed), params, gray.data(), nullptr,
+                                            prevGray.data(), mask.data(), tiles));
+    assert(mask == scalarMask);
+    assert(tiles.changedPixels == scalarTiles);
+    
+    assert(tiles.anyChanged());
+    assert(tiles.dirtyTileCount() < tiles.tilesX * tiles.tilesY / 10);
+    auto regions = tiles.dirtyRegions(1);
+    assert(regions.size() == 1);
+    assert(regions[0].x <= 320 && regions[0].y <= 180);
+    assert(regions[0].x + static_cast<int32_t>(regions[0].width) >= 360);
+    assert(regions[0].y + static_cast<int32_t>(regions[0].height) >= 210);
+    
+    std::cout << "  SIMD level: " << VisionKernels::simdLevelName(original) << "\n";
+    std::cout << "  Fused kernel tests passed!\n";
+}
+
+// 测试图块哈希预检（画面不变时跳过处理，局部变化只处理脏区域）
+void testTileHash() {
+    std::cout << "Testing tile hash pre-pass...\n";
+    
+    auto base = createTestImage(1920, 1080, ImageFormat::RGB, 90, 120, 200);
+    auto changed = createChangedImage(base, 960, 540, 120, 90, 255, 255, 255);
+    
+    // 各 SIMD 实现的哈希一致；只有变化区域覆盖的图块哈希不同
+    const auto original = VisionKernels::simdLevel();
+    TileHashGrid scalarGrid, baseGrid, changedGrid;
+    VisionKernels::setSimdLevel(VisionKernels::SimdLevel::Scalar);
+    VisionKernels::hashTiles(ImageView::fromImageData(base), 64, scalarGrid);
+    VisionKernels::setSimdLevel(original);
+    VisionKernels::hashTiles(ImageView::fromImageData(base), 64, baseGrid);
+    VisionKernels::hashTiles(ImageView::fromImageData(changed), 64, changedGrid);
+    assert(scalarGrid.hashes == baseGrid.hashes);
+    assert(baseGrid.tilesX == 30 && baseGrid.tilesY == 17);
+    
+    TileChangeMap dirty;
+    assert(VisionKernels::compareTileHashes(baseGrid, baseGrid, dirty) == 0);
+    assert(VisionKernels::compareTileHashes(changedGrid, baseGrid, dirty) == 4);
+    auto sourceRegions = dirty.dirtyRegions(0);
+    assert(sourceRegions.size() == 1);
+    assert(sourceRegions[0].x == 960 && sourceRegions[0].y == 512);
+    assert(sourceRegions[0].width == 128 && sourceRegions[0].height == 128);
+    
+    // 只处理脏区域的结果与整帧处理一致
+    VisionKernels::DownscaleDiffParams params;
+    params.dstWidth = 640;
+    params.dstHeight = 360;
+    std::vector<uint8_t> prevGray(640 * 360), fullGray(640 * 360), fullMask(640 * 360);
+    TileChangeMap fullTiles, partialTiles;
+    VisionKernels::downscaleGrayDiff(ImageView::fromImageData(base), params, prevGray.data(), nullptr,
+                                     nullptr, nullptr, fullTiles);
+    VisionKernels::downscaleGrayDiff(ImageView::fromImageData(changed), params, fullGray.data(), nullptr,
+                                     prevGray.data(), fullMask.data(), fullTiles);
+    std::vector<uint8_t> partialGray = prevGray, partialMask(640 * 360, 0);
+    auto regions = VisionKernels::mapRegions(sourceRegions, 1920, 1080, 640, 360);
+    assert(VisionKernels::downscaleGrayDiff(ImageView::fromImageData(changed), params, partialGray.data(),
+                                            nullptr, prevGray.data(), partialMask.data(), partialTiles,
+                                            regions));
+    assert(partialGray == fullGray);
+    assert(partialMask == fullMask);
+    assert(partialTiles.changedPixels == fullTiles.changedPixels);
+    
+    // VisionLayer0：相同帧直接返回零评分，局部变化仍能检测到变化区域
+    VisionLayer0Config config;
+    config.enableAdaptiveThreshold = false;
+    VisionLayer0 layer0(config);
+    layer0.processFrame(base);
+    auto same = layer0.processFrame(base);
+    assert(same.frameDiffScore == 0.0 && same.motionScore == 0.0);
+    assert(same.changedRegions.empty());
+    auto partial = layer0.processFrame(changed);
+    assert(partial.frameDiffScore > 0.0);
+    assert(!partial.changedRegions.empty());
+    
+    std::cout << "  Tile hash tests passed!\n";
+}
+
+// 测试自适应帧调度（空闲降频、活跃升频、CPU预算与子阶段抽帧）
+void testScheduler() {
+    std::cout << "Testing adaptive frame scheduler...\n";
+    
+    using namespace std::chrono_literals;
+    VisionSchedulerConfig config;
+    config.idleFps = 1.0;
+    config.activeFps = 30.0;
+    config.cpuBudgetMsPerSecond = 100.0;
+    config.motionInterval = 2;
+    config.dominantColorInterval = 5;
+    VisionScheduler scheduler(config);
+    
+    auto now = VisionScheduler::Clock::time_point{} + 100s;
+    assert(scheduler.shouldProcess(now));
+    assert(scheduler.targetFps() == 1.0);
+    
+    VisionLayer0Result idle;
+    VisionLayer0Result active;
+    active.overallChangeScore = 0.5;
+    
+    // 静止画面：保持空闲帧率
+    auto options = scheduler.planFrame();
+    assert(options.runMotionDetection && options.runDominantColor);
+    scheduler.recordFrame(idle, 2ms, options, now);
+    assert(scheduler.targetFps() == 1.0);
+    assert(!scheduler.shouldProcess(now + 500ms));
+    assert(scheduler.shouldProcess(now + 1s));
+    
+    // 画面变化：立即升到活跃帧率，光流按间隔抽帧
+    now += 1s;
+    scheduler.recordFrame(active, 2ms, scheduler.planFrame(), now);
+    assert(scheduler.targetFps() == 30.0);
+    assert(scheduler.nextFrameTime() - now < 40ms);
+    int motionFrames = 0;
+    int colorFrames = 0;
+    for (int i = 0; i < 10; ++i) {
+        now += 34ms;
+        options = scheduler.planFrame();
+        motionFrames += options.runMotionDetection ? 1 : 0;
+        colorFrames += options.runDominantColor ? 1 : 0;
+        scheduler.recordFrame(active, 2ms, options, now);
+    }
+    assert(motionFrames == 5);
+    assert(colorFrames == 2);
+    
+    // 变化停止后逐渐回落到空闲帧率
+    for (int i = 0; i < 60; ++i) {
+        now += 100ms;
+        scheduler.recordFrame(idle, 2ms, scheduler.planFrame(), now);
+    }
+    assert(scheduler.targetFps() == 1.0);
+    
+    // 单帧耗时 20ms、预算 100ms/s：活跃时帧率被限制在 5fps
+    scheduler.reset();
+    for (int i = 0; i < 20; ++i) {
+        now += 200ms;
+        scheduler.recordFrame(active, 20ms, scheduler.planFrame(), now);
+    }
+    auto stats = scheduler.getStats();
+    assert(stats.budgetLimited);
+    assert(stats.targetFps > 4.9 && stats.targetFps < 5.1);
+    assert(stats.cpuMsPerSecond <= 100.0);
+    
+    // VisionLayer0：跳过光流的帧沿用上次的运动结果
+    VisionLayer0 layer0;
+    auto base = createTestImage(640, 480, ImageFormat::BGR, 100, 100, 100);
+    auto changed = createChangedImage(base, 100, 100, 200, 200);
+    VisionLayer0FrameOptions skipMotion;
+    skipMotion.runMotionDetection = false;
+    layer0.processFrame(ImageView::fromImageData(base), VisionLayer0FrameOptions{});
+    auto full = layer0.processFrame(ImageView::fromImageData(changed), VisionLayer0FrameOptions{});
+    auto skipped = layer0.processFrame(ImageView::fromImageData(base), skipMotion);
+    assert(skipped.motionScore == full.motionScore);
+    
+    std::cout << "  Scheduler tests passed!\n";
+}
+
+// 测试多阶段流水线（SPSC 队列、丢帧策略与阶段统计）
+void testPipeline() {
+    std::cout << "Testing vision pipeline...\n";
+    
+    using namespace std::chrono_literals;
+    
+    // SPSC 队列：容量取整为2的幂，满时拒绝入队，跨线程保持顺序
+    SpscQueue<int> queue(3);
+    assert(queue.capacity() == 4);
+    for (int i = 0; i < 4; ++i) {
+        int v = i;
+        assert(queue.tryPush(std::move(v)));
+    }
+    int extra = 4;
+    assert(!queue.tryPush(std::move(extra)));
+    int out = -1;
+    assert(queue.tryPop(out) && out == 0);
+    
+    SpscQueue<int> ordered(64);
+    const int count = 100000;
+    std::thread producer([&]() {
+        for (int i = 0; i < count; ++i) {
+            int v = i;
+            while (!ordered.tryPush(std::move(v))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (int expected = 0; expected < count;) {
+        if (ordered.tryPop(out)) {
+            assert(out == expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    
+    // 分析阶段比采集慢：采集按节奏继续，积压的旧帧被跳过，回调收到的帧序号递增
+    VisionPipelineConfig config;
+    config.queueCapacity = 2;
+    config.dropPolicy = FrameDropPolicy::KeepLatest;
+    config.scheduler.idleFps = 200.0;
+    config.scheduler.activeFps = 200.0;
+    config.scheduler.cpuBudgetMsPerSecond = 0.0;
+    config.enableEncode = false;
+    
+    VisionPipelineStages stages;
+    stages.capture = []() -> std::optional<ImageData> {
+        return createTestImage(64, 48, ImageFormat::BGR, 10, 20, 30);
+    };
+    stages.analyze = [](VisionFrame& frame) {
+        std::this_thread::sleep_for(20ms);
+        frame.layer0 = VisionLayer0Result{};
+        return true;
+    };
+    
+    VisionPipeline pipeline(config, stages);
+    std::vector<uint64_t> sequences;
+    pipeline.setFrameCallback([&](VisionFrame&& frame) {
+        assert(frame.layer0.has_value());
+        sequences.push_back(frame.sequence);
+    });
+    assert(pipeline.start());
+    assert(!pipeline.start());
+    std::this_thread::sleep_for(400ms);
+    pipeline.stop();
+    assert(!pipeline.isRunning());
+    
+    auto metrics = pipeline.getMetrics();
+    const auto& capture = metrics.stages[static_cast<size_t>(VisionStage::Capture)];
+    const auto& analyze = metrics.stages[static_cast<size_t>(VisionStage::Analyze)];
+    assert(!sequences.empty());
+    for (size_t i = 1; i < sequences.size(); ++i) {
+        assert(sequences[i] > sequences[i - 1]);
+    }
+    assert(capture.processed > analyze.processed);
+    assert(analyze.dropped > 0);
+    assert(analyze.averageMs >= 15.0);
+    assert(metrics.completedFrames == sequences.size());
+    
+    std::cout << "  Captured " << capture.processed << ", analyzed " << analyze.processed
+              << ", dropped " << analyze.dropped << "\n";
+    std::cout << "  Pipeline tests passed!\n";
+}
+
+// 测试用检测后端：每张图在模型坐标下返回固定的候选框
+class FakeDetectionBackend : public DetectionBackend {
+public:
+    explicit FakeDetectionBackend(std::vector<size_t>* batchSizes) : m_batchSizes(batchSizes) {}
+
+    bool load(const VisionLayer1Config&) override { m_loaded = true; return true; }
+    bool isLoaded() const override { return m_loaded; }
+
+    bool infer(const std::vector<ImageData>& batch,
+               std::vector<std::vector<Detection>>& candidates) override {
+        m_batchSizes->push_back(batch.size());
+        candidates.assign(batch.size(), {});
+        for (size_t i = 0; i < batch.size(); ++i) {
+            assert(batch[i].width == 640 && batch[i].height == 640);
+            candidates[i].push_back(makeDetection(32, 192, 608, 448, 0.9f, 1));
+            candidates[i].push_back(makeDetection(36, 196, 612, 452, 0.5f, 1));  // 重复框
+        }
+        return true;
+    }
+
+    std::string name() const override { return "fake"; }
+    std::string getLastError() const override { return {}; }
+
+    static Detection makeDetection(float x1, float y1, float x2, float y2, float score, int classId) {
+        Detection det;
+        det.x1 = x1;
+        det.y1 = y1;
+        det.x2 = x2;
+        det.y2 = y2;
+        det.score = score;
+        det.classId = classId;
+        return det;
+    }
+
+private:
+    std::vector<size_t>* m_batchSizes;
+    bool m_loaded{false};
+};
+
+// 测试 Layer 1（区域规划、NMS、坐标映射与批处理）
+void testLayer1() {
+    std::cout << "Testing Layer 1 detection...\n";
+    
+    // NMS：同类别的重叠框被抑制，不同类别互不影响
+    std::vector<Detection> dets = {
+        FakeDetectionBackend::makeDetection(1, 1, 11, 11, 0.8f, 0),
+        FakeDetectionBackend::makeDetection(0, 0, 10, 10, 0.9f, 0),
+        FakeDetectionBackend::makeDetection(1, 1, 11, 11, 0.7f, 1),
+        FakeDetectionBackend::makeDetection(50, 50, 60, 60, 0.6f, 0),
+    };
+    auto limited = dets;
+    VisionLayer1::nonMaxSuppression(dets, 0.45f);
+    assert(dets.size() == 3);
+    assert(dets[0].score == 0.9f && dets[1].classId == 1 && dets[2].x1 == 50.0f);
+    VisionLayer1::nonMaxSuppression(limited, 0.45f, 2);
+    assert(limited.size() == 2);
+    
+    // 区域规划：小区域扩展到最小边长，重叠区域合并；区域过多或过大时改为整帧
+    VisionLayer1Config config;
+    config.regionPadding = 0.0;
+    config.minRegionSize = 64;
+    config.maxBatchSize = 2;
+    config.classNames = {"person", "cat"};
+    std::vector<size_t> batchSizes;
+    VisionLayer1 layer1(config, std::make_unique<FakeDetectionBackend>(&batchSizes));
+    
+    auto planned = layer1.planRegions({Rect{100, 100, 50, 50}, Rect{130, 130, 50, 50}}, 1000, 1000);
+    assert(planned.size() == 1);
+    assert(planned[0].x == 93 && planned[0].width == 94);
+    
+    planned = layer1.planRegions({Rect{0, 0, 800, 800}}, 1000, 1000);
+    assert(planned.size() == 1 && planned[0].width == 1000 && planned[0].height == 1000);
+    
+    std::vector<Rect> scattered;
+    for (int32_t i = 0; i < 9; ++i) {
+        scattered.push_back(Rect{i * 100, 0, 10, 10});
+    }
+    planned = layer1.planRegions(scattered, 1000, 1000);
+    assert(planned.size() == 1 && planned[0].width == 1000);
+    
+    // 未初始化时不运行
+    auto frame = createTestImage(1920, 1080, ImageFormat::BGR, 10, 20, 30);
+    const auto view = ImageView::fromImageData(frame);
+    assert(!layer1.detect(view, {}).ran);
+    assert(layer1.initialize());
+    
+    // 坐标映射：200x100 区域信箱缩放到 640x640（scale 3.2，上下各留 160）
+    auto result = layer1.detect(view, {Rect{400, 300, 200, 100}});
+    assert(result.ran && result.batches == 1);
+    assert(result.analyzedRegions.size() == 1);
+    assert(result.detections.size() == 1);
+    const Detection& det = result.detections[0];
+    assert(std::abs(det.x1 - 410.0f) < 0.01f && std::abs(det.y1 - 310.0f) < 0.01f);
+    assert(std::abs(det.x2 - 590.0f) < 0.01f && std::abs(det.y2 - 390.0f) < 0.01f);
+    assert(det.label == "cat");
+    
+    // 三个互不重叠的区域按 maxBatchSize=2 分两批推理
+    batchSizes.clear();
+    result = layer1.detect(view, {Rect{0, 0, 200, 200}, Rect{600, 0, 200, 200}, Rect{1200, 0, 200, 200}});
+    assert(result.batches == 2);
+    assert((batchSizes == std::vector<size_t>{2, 1}));
+    assert(result.detections.size() == 3);
+    
+    // 只在 Layer 0 触发时运行，区域从处理分辨率换算到源图像坐标
+    VisionLayer0Result layer0;
+    layer0.processingWidth = 640;
+    layer0.processingHeight = 360;
+    layer0.changedRegions.push_back(Rect{100, 100, 40, 40});
+    assert(!layer1.process(view, layer0).ran);
+    layer0.shouldTriggerLayer1 = true;
+    result = layer1.process(view, layer0);
+    assert(result.ran);
+    assert(result.analyzedRegions.size() == 1);
+    assert(result.analyzedRegions[0].x == 300 && result.analyzedRegions[0].width == 120);
+    
+    std::cout << "  Layer 1 tests passed!\n";
+}
+
 // 性能测试
 void testPerformance() {
     std::cout << "Testing performance...\n";
@@ -397,6 +876,24 @@ int main() {
         testConfigUpdate();
         std::cout << "\n";
         
+        testStridedView();
+        std::cout << "\n";
+        
+        testFusedKernel();
+        std::cout << "\n";
+        
+        testTileHash();
+        std::cout << "\n";
+        
+        testScheduler();
+        std::cout << "\n";
+        
+        testPipeline();
+        std::cout << "\n";
+        
+        testLayer1();
+        std::cout << "\n";
+        
         testPerformance();
         std::cout << "\n";
         
@@ -5,9 +5,11 @@
 #include <cctype>
 #include <fstream>
 #include <functional>
-#include <regex>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -22,320 +24,692 @@ namespace {
         oss << std::hex << hash;
         return oss.str();
     }
-    
+
     // 读取文件内容
     std::string readFileContent(const fs::path& filePath) {
         std::ifstream file(filePath, std::ios::binary);
         if (!file.is_open()) {
             return "";
         }
-        
+
         std::ostringstream oss;
         oss << file.rdbuf();
         return oss.str();
     }
-}
 
-CMakeProjectInfo CMakeParser::parseCMakeLists(const fs::path& cmakePath, const fs::path& projectRoot) {
-    CMakeProjectInfo info;
-    
-    if (!fs::exists(cmakePath) || !fs::is_regular_file(cmakePath)) {
-        return info;
+    // 单文件解析缓存：内容哈希不变则复用解析结果
+    struct ParseCacheEntry {
+        std::string hash;
+        std::shared_ptr<const CMakeProjectInfo> info;
+    };
+
+    std::mutex g_cacheMutex;
+    std::unordered_map<std::string, ParseCacheEntry> g_parseCache;                       // key: CMakeLists路径|项目根目录
+    std::unordered_map<std::string, std::shared_ptr<const CMakeProjectModel>> g_modelCache;  // key: 项目根目录
+
+    // 目标命令中不代表文件/库的关键字
+    const std::unordered_set<std::string>& targetKeywords() {
+        static const std::unordered_set<std::string> keywords = {
+            "PRIVATE", "PUBLIC", "INTERFACE", "SYSTEM", "BEFORE", "AFTER",
+            "WIN32", "MACOSX_BUNDLE", "EXCLUDE_FROM_ALL", "STATIC", "SHARED", "MODULE", "OBJECT",
+            "IMPORTED", "GLOBAL", "ALIAS", "FILE_SET", "TYPE", "BASE_DIRS", "FILES", "HEADERS", "CXX_MODULES",
+            "LINK_PRIVATE", "LINK_PUBLIC", "LINK_INTERFACE_LIBRARIES", "debug", "optimized", "general"
+        };
+        return keywords;
     }
-    
-    try {
-        std::ifstream file(cmakePath, std::ios::in);
-        if (!file.is_open()) {
-            return info;
-        }
-        
-        std::string line;
-        std::regex projectRegex(R"(project\s*\(\s*(\w+))");
-        std::regex addExecutableRegex(R"(add_executable\s*\(\s*(\w+))");
-        std::regex addLibraryRegex(R"(add_library\s*\(\s*(\w+))");
-        std::regex findPackageRegex(R"(find_package\s*\(\s*(\w+))");
-        std::regex addSubdirectoryRegex(R"(add_subdirectory\s*\(\s*([^)]+))");
-        std::regex includeDirsRegex(R"(include_directories\s*\()");
-        std::regex targetIncludeDirsRegex(R"(target_include_directories\s*\(\s*(\w+))");
-        std::regex targetSourcesRegex(R"(target_sources\s*\(\s*(\w+))");
-        
-        while (std::getline(file, line)) {
-            // 移除注释
-            size_t commentPos = line.find('#');
-            if (commentPos != std::string::npos) {
-                line = line.substr(0, commentPos);
-            }
-            
-            // 移除前后空白
-            line.erase(0, line.find_first_not_of(" \t"));
-            line.erase(line.find_last_not_of(" \t") + 1);
-            
-            if (line.empty()) continue;
-            
-            std::smatch match;
-            
-            // 解析project()
-            if (std::regex_search(line, match, projectRegex)) {
-                info.projectName = match[1].str();
+
+    bool isKeyword(const std::string& arg) {
+        return targetKeywords().count(arg) > 0;
+    }
+
+    // 变量或生成器表达式（无法静态求值）
+    bool isUnresolvable(const std::string& arg) {
+        return arg.find("${") != std::string::npos || arg.find("$<") != std::string::npos ||
+               arg.find("$ENV{") != std::string::npos;
+    }
+
+    void appendUnique(std::vector<std::string>& target, const std::vector<std::string>& values) {
+        for (const auto& value : values) {
+            if (std::find(target.begin(), target.end(), value) == target.end()) {
+                target.push_back(value);
             }
-            
-            // 解析add_executable()
-            if (std::regex_search(line, match, addExecutableRegex)) {
-                std::string targetName = match[1].str();
-                info.targets.push_back(targetName);
-                
-                // 提取源文件参数（可能跨多行）
-                std::vector<std::string> args = extractArguments(file, line);
-                for (const auto& arg : args) {
-                    std::string normalized = normalizePath(arg, projectRoot);
-                    if (!normalized.empty() && fs::exists(projectRoot / normalized)) {
-                        info.sourceFiles.push_back(normalized);
+        }
+    }
+
+    void appendUnique(std::vector<std::string>& target, const std::string& value) {
+        if (std::find(target.begin(), target.end(), value) == target.end()) {
+            target.push_back(value);
+        }
+    }
+
+    // 检查 pos 处是否为括号开头 "[" "="* "["，返回等号个数（-1表示不是）
+    int bracketOpenLevel(const std::string& content, size_t pos) {
+        if (pos >= content.size() || content[pos] != '[') {
+            return -1;
+        }
+        size_t p = pos + 1;
+        int level = 0;
+        while (p < content.size() && content[p] == '=') {
+            ++level;
+            ++p;
+        }
+        if (p < content.size() && content[p] == '[') {
+            return level;
+        }
+        return -1;
+    }
+
+    // 词法扫描器：逐字符处理，跟踪行号
+    class CMakeLexer {
+    public:
+        explicit CMakeLexer(const std::string& content) : m_content(content) {}
+
+        std::vector<CMakeCommand> run() {
+            std::vector<CMakeCommand> commands;
+            while (m_pos < m_content.size()) {
+                char c = m_content[m_pos];
+                if (c == '#') {
+                    skipComment();
+                } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                    CMakeCommand command;
+                    command.line = m_line;
+                    size_t start = m_pos;
+                    while (m_pos < m_content.size() &&
+                           (std::isalnum(static_cast<unsigned char>(m_content[m_pos])) || m_content[m_pos] == '_')) {
+                        ++m_pos;
                     }
-                }
-            }
-            
-            // 解析add_library()
-            if (std::regex_search(line, match, addLibraryRegex)) {
-                std::string targetName = match[1].str();
-                info.targets.push_back(targetName);
-                
-                // 提取源文件参数
-                std::vector<std::string> args = extractArguments(file, line);
-                for (const auto& arg : args) {
-                    std::string normalized = normalizePath(arg, projectRoot);
-                    if (!normalized.empty() && fs::exists(projectRoot / normalized)) {
-                        info.sourceFiles.push_back(normalized);
+                    command.name = m_content.substr(start, m_pos - start);
+                    std::transform(command.name.begin(), command.name.end(), command.name.begin(),
+                                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+
+                    skipSpaces();
+                    if (m_pos < m_content.size() && m_content[m_pos] == '(') {
+                        ++m_pos;
+                        command.arguments = readArguments();
+                        commands.push_back(std::move(command));
+                    } else {
+                        // 不是命令调用，跳过本行
+                        skipLine();
                     }
+                } else {
+                    advance();
                 }
             }
-            
-            // 解析find_package()
-            if (std::regex_search(line, match, findPackageRegex)) {
-                std::string dep = match[1].str();
-                if (std::find(info.dependencies.begin(), info.dependencies.end(), dep) == info.dependencies.end()) {
-                    info.dependencies.push_back(dep);
-                }
+            return commands;
+        }
+
+    private:
+        const std::string& m_content;
+        size_t m_pos{0};
+        size_t m_line{1};
+
+        void advance() {
+            if (m_content[m_pos] == '\n') {
+                ++m_line;
             }
-            
-            // 解析add_subdirectory()
-            if (std::regex_search(line, match, addSubdirectoryRegex)) {
-                std::string subdir = match[1].str();
-                subdir = removeVariableRefs(subdir);
-                if (!subdir.empty()) {
-                    info.subdirectories.push_back(subdir);
-                }
+            ++m_pos;
+        }
+
+        void skipSpaces() {
+            while (m_pos < m_content.size() && (m_content[m_pos] == ' ' || m_content[m_pos] == '\t')) {
+                ++m_pos;
             }
-            
-            // 解析include_directories()
-            if (std::regex_search(line, match, includeDirsRegex)) {
-                std::vector<std::string> args = extractArguments(file, line);
-                for (const auto& arg : args) {
-                    std::string normalized = normalizePath(arg, projectRoot);
-                    if (!normalized.empty()) {
-                        info.includeDirs.push_back(normalized);
+        }
+
+        void skipLine() {
+            while (m_pos < m_content.size() && m_content[m_pos] != '\n') {
+                ++m_pos;
+            }
+        }
+
+        // 跳过 "#..." 行注释或 "#[[...]]" 块注释
+        void skipComment() {
+            ++m_pos;
+            int level = bracketOpenLevel(m_content, m_pos);
+            if (level >= 0) {
+                readBracket(level);
+            } else {
+                skipLine();
+            }
+        }
+
+        // 读取括号参数/块注释内容，m_pos 指向开头的 '['
+        std::string readBracket(int level) {
+            m_pos += static_cast<size_t>(level) + 2;
+            std::string close = "]" + std::string(static_cast<size_t>(level), '=') + "]";
+            size_t end = m_content.find(close, m_pos);
+            if (end == std::string::npos) {
+                end = m_content.size();
+            }
+            std::string text = m_content.substr(m_pos, end - m_pos);
+            m_line += static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+            m_pos = std::min(m_content.size(), end + close.size());
+            // 紧跟开括号的第一个换行不属于内容
+            if (!text.empty() && text.front() == '\n') {
+                text.erase(0, 1);
+            }
+            return text;
+        }
+
+        std::string readQuoted() {
+            ++m_pos;  // 跳过开头的引号
+            std::string text;
+            while (m_pos < m_content.size() && m_content[m_pos] != '"') {
+                char c = m_content[m_pos];
+                if (c == '\\' && m_pos + 1 < m_content.size()) {
+                    char next = m_content[m_pos + 1];
+                    m_pos += 2;
+                    if (next == '\n') {
+                        ++m_line;  // 续行
+                    } else if (next == 'n') {
+                        text += '\n';
+                    } else if (next == 't') {
+                        text += '\t';
+                    } else {
+                        text += next;
                     }
+                    continue;
                 }
+                text += c;
+                advance();
             }
-            
-            // 解析target_include_directories()
-            if (std::regex_search(line, match, targetIncludeDirsRegex)) {
-                std::vector<std::string> args = extractArguments(file, line);
-                // 第一个参数是target名称，跳过，后面的才是目录
-                for (size_t i = 1; i < args.size(); ++i) {
-                    std::string normalized = normalizePath(args[i], projectRoot);
-                    if (!normalized.empty()) {
-                        info.includeDirs.push_back(normalized);
-                    }
+            if (m_pos < m_content.size()) {
+                ++m_pos;  // 跳过结尾的引号
+            }
+            return text;
+        }
+
+        // 读取参数直到与命令开括号匹配的右括号
+        std::vector<std::string> readArguments() {
+            std::vector<std::string> args;
+            int depth = 1;
+            while (m_pos < m_content.size() && depth > 0) {
+                char c = m_content[m_pos];
+                if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                    advance();
+                } else if (c == '#') {
+                    skipComment();
+                } else if (c == '(') {
+                    ++depth;
+                    ++m_pos;
+                } else if (c == ')') {
+                    --depth;
+                    ++m_pos;
+                } else if (c == '"') {
+                    args.push_back(readQuoted());
+                } else if (int level = bracketOpenLevel(m_content, m_pos); level >= 0) {
+                    args.push_back(readBracket(level));
+                } else {
+                    args.push_back(readUnquoted());
                 }
             }
-            
-            // 解析target_sources()
-            if (std::regex_search(line, match, targetSourcesRegex)) {
-                std::vector<std::string> args = extractArguments(file, line);
-                // 第一个参数是target名称，跳过，后面的才是源文件
-                for (size_t i = 1; i < args.size(); ++i) {
-                    std::string normalized = normalizePath(args[i], projectRoot);
-                    if (!normalized.empty() && fs::exists(projectRoot / normalized)) {
-                        info.sourceFiles.push_back(normalized);
+            return args;
+        }
+
+        std::string readUnquoted() {
+            std::string text;
+            while (m_pos < m_content.size()) {
+                char c = m_content[m_pos];
+                if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '(' || c == ')' || c == '#') {
+                    break;
+                }
+                if (c == '\\' && m_pos + 1 < m_content.size()) {
+                    text += m_content[m_pos + 1];
+                    m_pos += 2;
+                    continue;
+                }
+                if (c == '"') {
+                    // 旧式未加引号参数中的嵌入引号：读取到闭合引号
+                    text += readQuoted();
+                    continue;
+                }
+                // 变量引用整体读取（如 "${A B}" 之外的 ${VAR}）
+                if (c == '$' && m_pos + 1 < m_content.size() && (m_content[m_pos + 1] == '{' || m_content[m_pos + 1] == '<')) {
+                    char open = m_content[m_pos + 1];
+                    char close = open == '{' ? '}' : '>';
+                    int nested = 0;
+                    while (m_pos < m_content.size()) {
+                        char ch = m_content[m_pos];
+                        text += ch;
+                        ++m_pos;
+                        if (ch == open) {
+                            ++nested;
+                        } else if (ch == close && --nested == 0) {
+                            break;
+                        }
                     }
+                    continue;
                 }
+                text += c;
+                ++m_pos;
             }
+            return text;
         }
-        
-        file.close();
-        
-        // 计算配置文件哈希
-        std::string content = readFileContent(cmakePath);
-        info.configHash = computeStringHash(content);
-        
+    };
+
+    // 返回按层级发现的所有 CMakeLists.txt 的解析结果（根目录优先）
+    using ParsedFile = std::pair<fs::path, std::shared_ptr<const CMakeProjectInfo>>;
+}
+
+// ========== CMakeProjectModel ==========
+
+const CMakeTarget* CMakeProjectModel::findTarget(const std::string& name) const {
+    auto it = targets.find(name);
+    return it != targets.end() ? &it->second : nullptr;
+}
+
+std::vector<std::string> CMakeProjectModel::internalDependencies(const std::string& name) const {
+    std::vector<std::string> result;
+    const CMakeTarget* target = findTarget(name);
+    if (!target) {
+        return result;
+    }
+    for (const auto& lib : target->linkLibraries) {
+        if (findTarget(lib) != nullptr) {
+            appendUnique(result, lib);
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> CMakeProjectModel::externalDependencies(const std::string& name) const {
+    std::vector<std::string> result;
+    const CMakeTarget* target = findTarget(name);
+    if (!target) {
+        return result;
+    }
+    for (const auto& lib : target->linkLibraries) {
+        if (findTarget(lib) == nullptr) {
+            appendUnique(result, lib);
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> CMakeProjectModel::allLinkedLibraries() const {
+    std::vector<std::string> result;
+    for (const auto& [name, target] : targets) {
+        appendUnique(result, externalDependencies(name));
+    }
+    return result;
+}
+
+// ========== CMakeParser ==========
+
+std::vector<CMakeCommand> CMakeParser::tokenize(const std::string& content) {
+    return CMakeLexer(content).run();
+}
+
+CMakeProjectInfo CMakeParser::parseContent(
+    const std::string& content,
+    const fs::path& cmakeDir,
+    const fs::path& projectRoot) {
+
+    CMakeProjectInfo info;
+    std::vector<CMakeTarget>& details = info.targetDetails;
+
+    // 获取本文件中的目标记录（target_* 命令可作用于其他文件定义的目标）
+    auto detailFor = [&details](const std::string& name) -> CMakeTarget& {
+        for (auto& detail : details) {
+            if (detail.name == name) {
+                return detail;
+            }
+        }
+        CMakeTarget detail;
+        detail.name = name;
+        details.push_back(std::move(detail));
+        return details.back();
+    };
+
+    std::string cmakeFile = pathToUtf8String((cmakeDir / "CMakeLists.txt").lexically_relative(projectRoot));
+    std::replace(cmakeFile.begin(), cmakeFile.end(), '\\', '/');
+
+    auto addPaths = [&](const std::vector<std::string>& args, size_t first, std::vector<std::string>& out) {
+        for (size_t i = first; i < args.size(); ++i) {
+            if (isKeyword(args[i])) {
+                continue;
+            }
+            std::string normalized = normalizePath(args[i], cmakeDir, projectRoot);
+            if (!normalized.empty()) {
+                appendUnique(out, normalized);
+            }
+        }
+    };
+
+    auto addValues = [](const std::vector<std::string>& args, size_t first, std::vector<std::string>& out) {
+        for (size_t i = first; i < args.size(); ++i) {
+            if (!isKeyword(args[i]) && !isUnresolvable(args[i]) && !args[i].empty()) {
+                appendUnique(out, args[i]);
+            }
+        }
+    };
+
+    for (const auto& command : tokenize(content)) {
+        const auto& name = command.name;
+        const auto& args = command.arguments;
+        if (args.empty()) {
+            continue;
+        }
+
+        if (name == "project") {
+            info.projectName = args[0];
+        } else if (name == "add_executable" || name == "add_library") {
+            CMakeTarget& target = detailFor(args[0]);
+            target.definedIn = cmakeFile;
+            bool isImported = std::find(args.begin(), args.end(), "IMPORTED") != args.end();
+            bool isAlias = args.size() > 2 && args[1] == "ALIAS";
+            bool isInterface = args.size() > 1 && args[1] == "INTERFACE";
+            if (isAlias) {
+                target.kind = "alias";
+                appendUnique(target.linkLibraries, args[2]);
+            } else if (isImported) {
+                target.kind = "imported";
+            } else if (name == "add_executable") {
+                target.kind = "executable";
+            } else {
+                target.kind = isInterface ? "interface" : "library";
+            }
+            appendUnique(info.targets, args[0]);
+            if (!isAlias && !isImported) {
+                addPaths(args, 1, target.sources);
+                appendUnique(info.sourceFiles, target.sources);
+            }
+        } else if (name == "target_sources") {
+            CMakeTarget& target = detailFor(args[0]);
+            addPaths(args, 1, target.sources);
+            appendUnique(info.sourceFiles, target.sources);
+        } else if (name == "include_directories") {
+            addPaths(args, 0, info.includeDirs);
+        } else if (name == "target_include_directories") {
+            CMakeTarget& target = detailFor(args[0]);
+            addPaths(args, 1, target.includeDirs);
+            appendUnique(info.includeDirs, target.includeDirs);
+        } else if (name == "target_link_libraries") {
+            addValues(args, 1, detailFor(args[0]).linkLibraries);
+        } else if (name == "target_compile_options") {
+            addValues(args, 1, detailFor(args[0]).compileOptions);
+        } else if (name == "target_compile_definitions") {
+            addValues(args, 1, detailFor(args[0]).compileDefinitions);
+        } else if (name == "find_package") {
+            if (!isUnresolvable(args[0])) {
+                appendUnique(info.dependencies, args[0]);
+            }
+        } else if (name == "add_subdirectory") {
+            std::string subdir = normalizePath(args[0], cmakeDir, projectRoot);
+            if (!subdir.empty()) {
+                appendUnique(info.subdirectories, subdir);
+            }
+        }
+    }
+
+    info.configHash = computeStringHash(content);
+    return info;
+}
+
+std::shared_ptr<const CMakeProjectInfo> CMakeParser::parseFileCached(
+    const fs::path& cmakePath,
+    const fs::path& projectRoot) {
+
+    std::string content = readFileContent(cmakePath);
+    std::string hash = computeStringHash(content);
+    std::string key = pathToUtf8String(cmakePath) + "|" + pathToUtf8String(projectRoot);
+
+    {
+        std::lock_guard<std::mutex> lock(g_cacheMutex);
+        auto it = g_parseCache.find(key);
+        if (it != g_parseCache.end() && it->second.hash == hash) {
+            return it->second.info;
+        }
+    }
+
+    // 在锁外解析
+    auto info = std::make_shared<const CMakeProjectInfo>(
+        parseContent(content, cmakePath.parent_path(), projectRoot));
+
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    g_parseCache[key] = ParseCacheEntry{hash, info};
+    return info;
+}
+
+CMakeProjectInfo CMakeParser::parseCMakeLists(const fs::path& cmakePath, const fs::path& projectRoot) {
+    CMakeProjectInfo info;
+
+    if (!fs::exists(cmakePath) || !fs::is_regular_file(cmakePath)) {
+        return info;
+    }
+
+    try {
+        fs::path absRoot = fs::absolute(projectRoot).lexically_normal();
+        info = *parseFileCached(fs::absolute(cmakePath).lexically_normal(), absRoot);
+
+        // 源文件列表只保留实际存在的文件（不缓存，文件可能在CMakeLists.txt不变时被创建/删除）
+        info.sourceFiles.erase(
+            std::remove_if(info.sourceFiles.begin(), info.sourceFiles.end(),
+                [&absRoot](const std::string& file) { return !fs::exists(absRoot / file); }),
+            info.sourceFiles.end());
     } catch (...) {
         // 解析失败，返回空结果
     }
-    
+
     return info;
 }
 
-std::unordered_map<std::string, CMakeProjectInfo> CMakeParser::parseAllCMakeLists(const fs::path& projectRoot) {
-    std::unordered_map<std::string, CMakeProjectInfo> results;
-    
-    try {
-        // 解析根目录的CMakeLists.txt
-        fs::path rootCMake = projectRoot / "CMakeLists.txt";
+namespace {
+    // 并行解析一组文件（每个线程写入自己负责的下标区间）
+    std::vector<std::shared_ptr<const CMakeProjectInfo>> parseFilesParallel(
+        const std::vector<fs::path>& files,
+        const std::function<std::shared_ptr<const CMakeProjectInfo>(const fs::path&)>& parseOne) {
+
+        std::vector<std::shared_ptr<const CMakeProjectInfo>> results(files.size());
+
+        // CMakeLists.txt 数量一般不多，但单个文件解析比文件扫描更重，少量文件时也可并行
+        unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+        numThreads = static_cast<unsigned int>(std::min<size_t>(numThreads, files.size()));
+        if (files.size() < 4) {
+            numThreads = 1;
+        }
+
+        auto work = [&](size_t startIdx, size_t endIdx) {
+            for (size_t i = startIdx; i < endIdx; ++i) {
+                try {
+                    results[i] = parseOne(files[i]);
+                } catch (...) {
+                    results[i] = std::make_shared<const CMakeProjectInfo>();
+                }
+            }
+        };
+
+        if (numThreads <= 1) {
+            work(0, files.size());
+            return results;
+        }
+
+        size_t filesPerThread = (files.size() + numThreads - 1) / numThreads;
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < numThreads; ++t) {
+            size_t startIdx = t * filesPerThread;
+            size_t endIdx = std::min(startIdx + filesPerThread, files.size());
+            if (startIdx >= files.size()) {
+                break;
+            }
+            threads.emplace_back(work, startIdx, endIdx);
+        }
+        for (auto& thread : threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        return results;
+    }
+
+    // 按 add_subdirectory 层级发现并解析所有 CMakeLists.txt（同一层级并行）
+    template <typename ParseOne>
+    std::vector<ParsedFile> collectCMakeFiles(const fs::path& absRoot, ParseOne parseOne) {
+        std::vector<ParsedFile> parsed;
+        std::unordered_set<std::string> visited;
+
+        std::vector<fs::path> level;
+        fs::path rootCMake = absRoot / "CMakeLists.txt";
         if (fs::exists(rootCMake)) {
-            auto info = CMakeParser::parseCMakeLists(rootCMake, projectRoot);
-            results[pathToUtf8String(rootCMake)] = info;
-            
-            // 递归解析子目录
-            for (const auto& subdir : info.subdirectories) {
-                fs::path subdirPath = projectRoot / subdir;
-                if (fs::exists(subdirPath) && fs::is_directory(subdirPath)) {
-                    fs::path subCMake = subdirPath / "CMakeLists.txt";
-                    if (fs::exists(subCMake)) {
-                        auto subInfo = CMakeParser::parseCMakeLists(subCMake, projectRoot);
-                        results[pathToUtf8String(subCMake)] = subInfo;
+            level.push_back(rootCMake);
+            visited.insert(pathToUtf8String(rootCMake));
+        }
+
+        while (!level.empty()) {
+            auto results = parseFilesParallel(level, parseOne);
+            std::vector<fs::path> nextLevel;
+            for (size_t i = 0; i < level.size(); ++i) {
+                for (const auto& subdir : results[i]->subdirectories) {
+                    fs::path subCMake = (absRoot / subdir / "CMakeLists.txt").lexically_normal();
+                    if (visited.insert(pathToUtf8String(subCMake)).second && fs::exists(subCMake)) {
+                        nextLevel.push_back(subCMake);
                     }
                 }
+                parsed.emplace_back(level[i], std::move(results[i]));
             }
+            level = std::move(nextLevel);
         }
-    } catch (...) {
-        // 忽略错误
+        return parsed;
     }
-    
-    return results;
 }
 
-std::string CMakeParser::computeFileHash(const fs::path& filePath) {
+std::unordered_map<std::string, CMakeProjectInfo> CMakeParser::parseAllCMakeLists(const fs::path& projectRoot) {
+    std::unordered_map<std::string, CMakeProjectInfo> results;
+
     try {
-        std::string content = readFileContent(filePath);
-        return computeStringHash(content);
+        fs::path absRoot = fs::absolute(projectRoot).lexically_normal();
+        auto parsed = collectCMakeFiles(absRoot, [&absRoot](const fs::path& cmakePath) {
+            return std::make_shared<const CMakeProjectInfo>(CMakeParser::parseCMakeLists(cmakePath, absRoot));
+        });
+        for (auto& [path, info] : parsed) {
+            results[pathToUtf8String(path)] = *info;
+        }
     } catch (...) {
-        return "";
+        // 忽略错误
     }
+
+    return results;
 }
 
-std::vector<std::string> CMakeParser::extractArguments(std::ifstream& file, std::string& line) {
-    std::vector<std::string> args;
-    
-    // 查找开括号后的内容
-    size_t openParen = line.find('(');
-    if (openParen == std::string::npos) {
-        return args;
-    }
-    
-    std::string currentArg;
-    int parenDepth = 1;
-    size_t pos = openParen + 1;
-    
-    // 处理当前行的剩余部分
-    while (pos < line.length() && parenDepth > 0) {
-        char c = line[pos];
-        if (c == '(') {
-            parenDepth++;
-            currentArg += c;
-        } else if (c == ')') {
-            parenDepth--;
-            if (parenDepth > 0) {
-                currentArg += c;
-            }
-        } else if (c == ' ' || c == '\t') {
-            if (!currentArg.empty()) {
-                // 移除引号
-                if (currentArg.front() == '"' && currentArg.back() == '"') {
-                    currentArg = currentArg.substr(1, currentArg.length() - 2);
-                }
-                args.push_back(currentArg);
-                currentArg.clear();
+std::shared_ptr<const CMakeProjectModel> CMakeParser::loadProjectModel(const fs::path& projectRoot) {
+    auto model = std::make_shared<CMakeProjectModel>();
+
+    try {
+        fs::path absRoot = fs::absolute(projectRoot).lexically_normal();
+        std::string rootKey = pathToUtf8String(absRoot);
+
+        auto parsed = collectCMakeFiles(absRoot, [&absRoot](const fs::path& cmakePath) {
+            return CMakeParser::parseFileCached(cmakePath, absRoot);
+        });
+
+        std::string hashInput;
+        for (const auto& [path, info] : parsed) {
+            hashInput += pathToUtf8String(path) + ":" + info->configHash + ";";
+        }
+        std::string combinedHash = parsed.empty() ? "" : computeStringHash(hashInput);
+
+        {
+            std::lock_guard<std::mutex> lock(g_cacheMutex);
+            auto it = g_modelCache.find(rootKey);
+            if (it != g_modelCache.end() && it->second->combinedHash == combinedHash) {
+                return it->second;
             }
-        } else {
-            currentArg += c;
         }
-        pos++;
-    }
-    
-    // 如果括号未闭合，继续读取下一行
-    while (parenDepth > 0 && std::getline(file, line)) {
-        // 移除注释
-        size_t commentPos = line.find('#');
-        if (commentPos != std::string::npos) {
-            line = line.substr(0, commentPos);
-        }
-        
-        pos = 0;
-        while (pos < line.length() && parenDepth > 0) {
-            char c = line[pos];
-            if (c == '(') {
-                parenDepth++;
-                currentArg += c;
-            } else if (c == ')') {
-                parenDepth--;
-                if (parenDepth > 0) {
-                    currentArg += c;
-                }
-            } else if (c == ' ' || c == '\t') {
-                if (!currentArg.empty()) {
-                    if (currentArg.front() == '"' && currentArg.back() == '"') {
-                        currentArg = currentArg.substr(1, currentArg.length() - 2);
-                    }
-                    args.push_back(currentArg);
-                    currentArg.clear();
+
+        // 合并各文件的目标信息（按发现顺序，根目录优先）
+        model->combinedHash = combinedHash;
+        for (const auto& [path, info] : parsed) {
+            if (model->projectName.empty()) {
+                model->projectName = info->projectName;
+            }
+            appendUnique(model->dependencies, info->dependencies);
+
+            for (const auto& detail : info->targetDetails) {
+                CMakeTarget& target = model->targets[detail.name];
+                target.name = detail.name;
+                if (!detail.kind.empty() && target.kind.empty()) {
+                    target.kind = detail.kind;
+                    target.definedIn = detail.definedIn;
                 }
-            } else {
-                currentArg += c;
+                appendUnique(target.sources, detail.sources);
+                appendUnique(target.includeDirs, detail.includeDirs);
+                appendUnique(target.linkLibraries, detail.linkLibraries);
+                appendUnique(target.compileOptions, detail.compileOptions);
+                appendUnique(target.compileDefinitions, detail.compileDefinitions);
             }
-            pos++;
+            model->files[pathToUtf8String(path)] = *info;
         }
+
+        std::lock_guard<std::mutex> lock(g_cacheMutex);
+        g_modelCache[rootKey] = model;
+    } catch (...) {
+        // 忽略错误，返回已合并的部分
     }
-    
-    // 添加最后一个参数
-    if (!currentArg.empty()) {
-        if (currentArg.front() == '"' && currentArg.back() == '"') {
-            currentArg = currentArg.substr(1, currentArg.length() - 2);
-        }
-        args.push_back(currentArg);
+
+    return model;
+}
+
+std::string CMakeParser::computeFileHash(const fs::path& filePath) {
+    try {
+        std::string content = readFileContent(filePath);
+        return computeStringHash(content);
+    } catch (...) {
+        return "";
     }
-    
-    return args;
 }
 
-std::string CMakeParser::normalizePath(const std::string& path, const fs::path& projectRoot) {
-    std::string normalized = removeVariableRefs(path);
-    
-    // 移除引号
-    if (normalized.front() == '"' && normalized.back() == '"') {
-        normalized = normalized.substr(1, normalized.length() - 2);
+void CMakeParser::clearCache() {
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    g_parseCache.clear();
+    g_modelCache.clear();
+}
+
+std::string CMakeParser::normalizePath(const std::string& path, const fs::path& cmakeDir, const fs::path& projectRoot) {
+    std::string normalized = path;
+
+    // 展开目录相关的内置变量
+    auto replaceAll = [&normalized](const std::string& from, const std::string& to) {
+        size_t pos = 0;
+        while ((pos = normalized.find(from, pos)) != std::string::npos) {
+            normalized.replace(pos, from.size(), to);
+            pos += to.size();
+        }
+    };
+    std::string dirStr = pathToUtf8String(cmakeDir);
+    std::string rootStr = pathToUtf8String(projectRoot);
+    replaceAll("${CMAKE_CURRENT_SOURCE_DIR}", dirStr);
+    replaceAll("${CMAKE_CURRENT_LIST_DIR}", dirStr);
+    replaceAll("${PROJECT_SOURCE_DIR}", rootStr);
+    replaceAll("${CMAKE_SOURCE_DIR}", rootStr);
+
+    // 其他变量和生成器表达式无法静态求值
+    if (isUnresolvable(normalized)) {
+        return "";
     }
-    
-    // 处理相对路径
-    if (!normalized.empty() && normalized[0] != '/') {
-        // 已经是相对路径，直接返回
-        return normalized;
+
+    normalized.erase(0, normalized.find_first_not_of(" \t"));
+    normalized.erase(normalized.find_last_not_of(" \t") + 1);
+    if (normalized.empty()) {
+        return "";
     }
-    
-    // 如果是绝对路径，转换为相对路径
+
     try {
-        fs::path absPath(normalized);
-        if (absPath.is_absolute()) {
-            fs::path relPath = fs::relative(absPath, projectRoot);
-            return pathToUtf8String(relPath);
+        fs::path resolved = pathFromUtf8String(normalized);
+        if (resolved.is_relative()) {
+            resolved = cmakeDir / resolved;
+        }
+        fs::path relPath = resolved.lexically_normal().lexically_relative(projectRoot);
+        std::string relStr = pathToUtf8String(relPath);
+        std::replace(relStr.begin(), relStr.end(), '\\', '/');
+        // 项目外的路径不纳入
+        if (relStr.empty() || relStr.rfind("..", 0) == 0) {
+            return "";
         }
+        if (relStr.size() > 1 && relStr.back() == '/') {
+            relStr.pop_back();
+        }
+        return relStr;
     } catch (...) {
-        // 转换失败，返回原路径
+        return "";
     }
-    
-    return normalized;
-}
-
-std::string CMakeParser::removeVariableRefs(const std::string& str) {
-    std::string result = str;
-    
-    // 简单处理：移除 ${VAR} 形式的变量引用，保留其他部分
-    std::regex varRegex(R"(\$\{[^}]+\})");
-    result = std::regex_replace(result, varRegex, "");
-    
-    // 移除多余的空白
-    result.erase(0, result.find_first_not_of(" \t"));
-    result.erase(result.find_last_not_of(" \t") + 1);
-    
-    return result;
 }
-
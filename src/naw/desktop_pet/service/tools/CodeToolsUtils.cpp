@@ -1,6 +1,7 @@
 #include "naw/desktop_pet/service/tools/CodeToolsUtils.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <filesystem>
 #include <fstream>
@@ -13,6 +14,12 @@
 
 #if defined(_WIN32)
 #include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 namespace fs = std::filesystem;
@@ -123,8 +130,6 @@ bool matchesPattern(const std::string& filename, const std::string& pattern) {
 }
 
 std::vector<std::string> readFileLines(const fs::path& path, int startLine, int endLine) {
-    std::vector<std::string> lines;
-    
     // 以二进制模式读取文件，以便检测编码
     std::ifstream file(path, std::ios::in | std::ios::binary);
     
@@ -134,15 +139,22 @@ std::vector<std::string> readFileLines(const fs::path& path, int startLine, int
         throw std::runtime_error("无法打开文件: " + utf8Path);
     }
 
-    // 读取文件内容到字节数组
+    // 读取文件内容
     file.seekg(0, std::ios::end);
     size_t fileSize = static_cast<size_t>(file.tellg());
     file.seekg(0, std::ios::beg);
     
-    std::vector<unsigned char> content(fileSize);
-    file.read(reinterpret_cast<char*>(content.data()), fileSize);
+    std::string content(fileSize, '\0');
+    file.read(content.data(), fileSize);
     file.close();
     
+    return splitFileContentLines(content, startLine, endLine);
+}
+
+std::vector<std::string> splitFileContentLines(const std::string& rawContent, int startLine, int endLine) {
+    std::vector<std::string> lines;
+    std::vector<unsigned char> content(rawContent.begin(), rawContent.end());
+    
     // 检测文件编码
     FileEncoding encoding = detectFileEncoding(content);
     
@@ -150,7 +162,6 @@ std::vector<std::string> readFileLines(const fs::path& path, int startLine, int
     std::optional<std::string> utf8Content = convertToUtf8(content, encoding);
     if (!utf8Content.has_value()) {
         // 如果转换失败，尝试直接使用原始内容（可能是UTF-8）
-        std::string rawContent(content.begin(), content.end());
         // 清理无效UTF-8字符
         utf8Content = sanitizeUtf8String(rawContent);
     }
@@ -563,5 +574,136 @@ std::pair<size_t, size_t> getUtf8CharRange(const std::string& str, size_t startC
     return {startByte, endByte};
 }
 
+bool writeFileAtomically(const fs::path& requestedPath, std::string_view content, std::string& error, bool createOnly) {
+    static std::atomic<unsigned long long> tempCounter{0};
+
+    // 目标是符号链接时替换链接指向的文件，保留链接本身（重命名会把链接换成普通文件）
+    fs::path path = requestedPath;
+    std::error_code ec;
+    if (!createOnly && fs::is_symlink(fs::symlink_status(requestedPath, ec))) {
+        path = fs::canonical(requestedPath, ec);
+        if (ec) {
+            error = "无法解析符号链接目标: " + pathToUtf8String(requestedPath) + " (" + ec.message() + ")";
+            return false;
+        }
+    }
+
+    fs::path parent = path.parent_path();
+#if defined(_WIN32)
+    unsigned long processId = GetCurrentProcessId();
+#else
+    unsigned long processId = static_cast<unsigned long>(::getpid());
+#endif
+    // 临时文件放在同一目录，保证重命名不跨文件系统
+    std::string tempName = "." + pathToUtf8String(path.filename()) + ".tmp" +
+                           std::to_string(processId) + "_" + std::to_string(tempCounter.fetch_add(1));
+    fs::path tempPath = parent.empty() ? fs::path(tempName) : parent / tempName;
+
+#if defined(_WIN32)
+    HANDLE handle = CreateFileW(tempPath.wstring().c_str(), GENERIC_WRITE, 0, nullptr,
+                                CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error = "无法创建临时文件: " + pathToUtf8String(tempPath);
+        return false;
+    }
+
+    bool ok = true;
+    size_t offset = 0;
+    while (ok && offset < content.size()) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(content.size() - offset, 1u << 30));
+        DWORD written = 0;
+        ok = WriteFile(handle, content.data() + offset, chunk, &written, nullptr) && written > 0;
+        offset += written;
+    }
+    ok = ok && FlushFileBuffers(handle);
+    CloseHandle(handle);
+
+    if (!ok) {
+        DeleteFileW(tempPath.wstring().c_str());
+        error = "写入临时文件失败: " + pathToUtf8String(tempPath);
+        return false;
+    }
+
+    // 仅创建时不带 MOVEFILE_REPLACE_EXISTING，目标已存在则失败
+    DWORD moveFlags = createOnly ? MOVEFILE_WRITE_THROUGH : (MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+    if (!MoveFileExW(tempPath.wstring().c_str(), path.wstring().c_str(), moveFlags)) {
+        DWORD lastError = GetLastError();
+        DeleteFileW(tempPath.wstring().c_str());
+        if (createOnly && (lastError == ERROR_ALREADY_EXISTS || lastError == ERROR_FILE_EXISTS)) {
+            error = "目标文件已存在: " + pathToUtf8String(path);
+        } else {
+            error = "无法替换目标文件: " + pathToUtf8String(path);
+        }
+        return false;
+    }
+    return true;
+#else
+    // 覆盖已有文件时保留其权限位
+    mode_t mode = 0666;
+    struct stat existing {};
+    bool replacing = ::stat(path.c_str(), &existing) == 0;
+    if (replacing) {
+        mode = existing.st_mode & 07777;
+    }
+
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+    if (fd < 0) {
+        error = "无法创建临时文件: " + pathToUtf8String(tempPath) + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    if (replacing) {
+        ::fchmod(fd, mode);  // 不受 umask 影响
+    }
+
+    size_t offset = 0;
+    while (offset < content.size()) {
+        ssize_t written = ::write(fd, content.data() + offset, content.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = std::string("写入临时文件失败: ") + std::strerror(errno);
+            ::close(fd);
+            ::unlink(tempPath.c_str());
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+
+    if (::fsync(fd) != 0 || ::close(fd) != 0) {
+        error = std::string("刷新临时文件失败: ") + std::strerror(errno);
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+
+    if (createOnly) {
+        // link() 在目标已存在时以 EEXIST 失败，检查与发布是同一个原子操作
+        if (::link(tempPath.c_str(), path.c_str()) != 0) {
+            int linkErrno = errno;
+            ::unlink(tempPath.c_str());
+            if (linkErrno == EEXIST) {
+                error = "目标文件已存在: " + pathToUtf8String(path);
+            } else {
+                error = "无法创建目标文件: " + pathToUtf8String(path) + " (" + std::strerror(linkErrno) + ")";
+            }
+            return false;
+        }
+        ::unlink(tempPath.c_str());
+    } else if (::rename(tempPath.c_str(), path.c_str()) != 0) {
+        error = "无法替换目标文件: " + pathToUtf8String(path) + " (" + std::strerror(errno) + ")";
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+
+    // 刷新目录项，保证重命名本身持久化（失败不影响结果）
+    int dirFd = ::open(parent.empty() ? "." : parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+#endif
+}
+
 } // namespace naw::desktop_pet::service::tools
 
@@ -5,13 +5,19 @@
 #include "naw/desktop_pet/service/tools/ProjectWhitelist.h"
 #include "naw/desktop_pet/service/tools/ProjectStructureCache.h"
 #include "naw/desktop_pet/service/ToolManager.h"
+#include "naw/desktop_pet/service/utils/TokenCounter.h"
 
 #include <algorithm>
 #include <cctype>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
-#include <future>
+#include <atomic>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <regex>
 #include <set>
@@ -119,9 +125,18 @@ namespace {
         size_t memoryEstimate = 0;
         bool timedOut = false;
         bool memoryLimitHit = false;
+        bool cancelled = false;
+        const std::atomic<bool>* cancelFlag = nullptr;  // 外部取消标志（后台预热使用），可为空
         
         PerformanceStats() : startTime(std::chrono::steady_clock::now()) {}
         
+        bool isCancelled() {
+            if (!cancelled && cancelFlag && cancelFlag->load()) {
+                cancelled = true;
+            }
+            return cancelled;
+        }
+        
         bool isTimeout(int maxSeconds) const {
             auto now = std::chrono::steady_clock::now();
             auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - startTime);
@@ -392,7 +407,7 @@ namespace {
     // ==================== CMake解析 ====================
     
     /**
-     * @brief 解析CMakeLists.txt
+     * @brief 解析CMakeLists.txt（使用共享的项目模型缓存）
      */
     nlohmann::json parseCMakeLists(const fs::path& cmakePath) {
         nlohmann::json result;
@@ -404,51 +419,16 @@ namespace {
             return result;
         }
         
-        try {
-            std::ifstream file(cmakePath, std::ios::in);
-            if (!file.is_open()) {
-                return result;
-            }
-            
-            std::string line;
-            std::regex projectRegex(R"(project\s*\(\s*(\w+))");
-            std::regex addExecutableRegex(R"(add_executable\s*\(\s*(\w+))");
-            std::regex addLibraryRegex(R"(add_library\s*\(\s*(\w+))");
-            std::regex findPackageRegex(R"(find_package\s*\(\s*(\w+))");
-            
-            std::unordered_set<std::string> seenDeps;
-            
-            while (std::getline(file, line)) {
-                size_t commentPos = line.find('#');
-                if (commentPos != std::string::npos) {
-                    line = line.substr(0, commentPos);
-                }
-                
-                std::smatch match;
-                
-                if (std::regex_search(line, match, projectRegex)) {
-                    result["project_name"] = match[1].str();
-                }
-                
-                if (std::regex_search(line, match, addExecutableRegex)) {
-                    result["targets"].push_back(match[1].str());
-                }
-                
-                if (std::regex_search(line, match, addLibraryRegex)) {
-                    result["targets"].push_back(match[1].str());
-                }
-                
-                if (std::regex_search(line, match, findPackageRegex)) {
-                    std::string dep = match[1].str();
-                    if (seenDeps.find(dep) == seenDeps.end()) {
-                        seenDeps.insert(dep);
-                        result["dependencies"].push_back(dep);
-                    }
-                }
+        auto model = CMakeParser::loadProjectModel(cmakePath.parent_path());
+        result["project_name"] = model->projectName;
+        for (const auto& [name, target] : model->targets) {
+            if (target.kind == "executable" || target.kind == "library" || target.kind == "interface") {
+                result["targets"].push_back(name);
             }
-            
-            file.close();
-        } catch (...) {}
+        }
+        for (const auto& dep : model->dependencies) {
+            result["dependencies"].push_back(dep);
+        }
         
         return result;
     }
@@ -514,6 +494,9 @@ namespace {
             }
             
             for (const auto& scanRoot : scanRoots) {
+                if (stats.isCancelled()) {
+                    break;
+                }
                 if (!fs::exists(scanRoot) || !fs::is_directory(scanRoot)) {
                     continue;
                 }
@@ -533,6 +516,11 @@ namespace {
                         break;
                     }
                     
+                    // 取消检查（进入每个目录时）
+                    if (entry.is_directory() && stats.isCancelled()) {
+                        break;
+                    }
+                    
                     // 迭代次数检查
                     if (++iterationCount > SafetyLimits::MAX_ITERATIONS) {
                         result["warning"] = "达到最大迭代次数限制(" + 
@@ -547,41 +535,37 @@ namespace {
                     }
                     
                     try {
-                    // 计算深度
-                    try {
-                        fs::path relPath = fs::relative(entry.path(), projectRoot);
-                        if (!relPath.empty() && relPath != ".") {
-                            size_t depth = 0;
-                            for (const auto& component : relPath) {
-                                if (component != "." && component != "..") {
-                                    depth++;
-                                }
-                            }
-                            if (depth > SafetyLimits::MAX_DEPTH) {
-                                dirIter.disable_recursion_pending();
-                                continue;
-                            }
+                    // 相对路径只计算一次（纯词法运算），深度、白名单判定和输出共用
+                    const std::string relPathStr = ProjectFileWhitelist::relativeKey(entry.path(), projectRoot);
+                    if (!relPathStr.empty()) {
+                        size_t depth = static_cast<size_t>(std::count(relPathStr.begin(), relPathStr.end(), '/')) + 1;
+                        if (depth > SafetyLimits::MAX_DEPTH) {
+                            dirIter.disable_recursion_pending();
+                            continue;
                         }
-                    } catch (...) {
-                        continue;
                     }
                     
                     // 跳过符号链接
-                    if (fs::is_symlink(entry)) {
+                    if (entry.is_symlink()) {
                         dirIter.disable_recursion_pending();
                         continue;
                     }
                     
+                    const bool isDirectory = entry.is_directory();
+                    const bool isRegularFile = !isDirectory && entry.is_regular_file();
+                    
                     // 检查是否应该排除（先检查白名单，再检查用户自定义规则）
                     bool shouldExclude = false;
+                    FileDecision decision;
                     
-                    // 1. 检查白名单
-                    if (fs::is_directory(entry)) {
-                        if (!whitelist.shouldScanDirectory(entry.path(), projectRoot)) {
+                    // 1. 检查白名单（前缀树 + 扩展名表查找）
+                    if (isDirectory) {
+                        if (!whitelist.shouldScanRelativeDirectory(relPathStr, entry.path(), projectRoot)) {
                             shouldExclude = true;
                         }
-                    } else if (fs::is_regular_file(entry)) {
-                        if (!whitelist.isWhitelisted(entry.path(), projectRoot)) {
+                    } else if (isRegularFile) {
+                        decision = whitelist.classifyFile(relPathStr);
+                        if (!decision.whitelisted) {
                             shouldExclude = true;
                         }
                     }
@@ -594,30 +578,29 @@ namespace {
                     
                     if (shouldExclude) {
                         stats.filesFiltered++;
-                        if (fs::is_directory(entry)) {
+                        if (isDirectory) {
                             dirIter.disable_recursion_pending();
                         }
                         continue;
                     }
                     
                     // 更新统计
-                    if (fs::is_directory(entry)) {
+                    if (isDirectory) {
                         stats.dirsScanned++;
-                    } else if (fs::is_regular_file(entry)) {
+                    } else if (isRegularFile) {
                         stats.filesScanned++;
                     }
                     
                     // 构建目录结构
                     if (pathCount < MAX_PATHS && structure.str().size() < SafetyLimits::MAX_STRUCTURE_SIZE) {
-                        std::string relPathStr = pathCache.getRelativePath(entry.path());
                         if (!relPathStr.empty() && structurePaths.find(relPathStr) == structurePaths.end()) {
                             structurePaths.insert(relPathStr);
                             
-                            if (detailLevel != "minimal" || fs::is_directory(entry)) {
+                            if (detailLevel != "minimal" || isDirectory) {
                                 size_t newSize = structure.str().size() + relPathStr.size() + 2;
                                 if (newSize < SafetyLimits::MAX_STRUCTURE_SIZE) {
                                     structure << relPathStr;
-                                    if (fs::is_directory(entry)) {
+                                    if (isDirectory) {
                                         structure << "/";
                                     }
                                     structure << "\n";
@@ -629,57 +612,23 @@ namespace {
                     }
                     
                     // 收集文件列表
-                    if (includeFiles && fs::is_regular_file(entry)) {
+                    if (includeFiles && isRegularFile) {
                         size_t currentCount = sourceFiles.size() + headerFiles.size();
                         if (currentCount >= maxFiles) {
                             stats.filesSkipped++;
                             continue;
                         }
                         
-                        // 检查是否在白名单中
-                        if (!whitelist.isWhitelisted(entry.path(), projectRoot)) {
-                            continue;
-                        }
-                        
-                        std::string ext = pathToUtf8String(entry.path().extension());
-                        std::transform(ext.begin(), ext.end(), ext.begin(), 
-                                      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-                        
-                        bool isCppSource = ProjectFileWhitelist::isSourceFileExtension(ext);
-                        bool isCppHeader = ProjectFileWhitelist::isHeaderFileExtension(ext);
+                        bool isCppSource = (decision.extensionFlags & ExtensionFlags::Source) != 0;
+                        bool isCppHeader = (decision.extensionFlags & ExtensionFlags::Header) != 0;
                         
                         // 收集源文件、头文件、配置文件、文档文件和资源文件
-                        if (!isCppSource && !isCppHeader) {
-                            
-                            fs::path relPath = fs::relative(entry.path(), projectRoot);
-                            std::string relPathStr = pathToUtf8String(relPath);
-                            std::replace(relPathStr.begin(), relPathStr.end(), '\\', '/');
-                            
-                            // 检查是否是配置文件、文档文件或资源文件
-                            bool isConfig = (whitelist.configFiles.find(relPathStr) != whitelist.configFiles.end());
-                            bool isDoc = (whitelist.docFiles.find(relPathStr) != whitelist.docFiles.end()) ||
-                                        ProjectFileWhitelist::isDocumentFileExtension(ext);
-                            bool isResource = ProjectFileWhitelist::isResourceFileExtension(ext);
-                            
-                            // 检查是否在资源目录下
-                            for (const auto& resourceDir : whitelist.resourceDirs) {
-                                if (relPathStr.find(resourceDir) == 0) {
-                                    isResource = true;
-                                    break;
-                                }
-                            }
-                            
-                            if (!isConfig && !isDoc && !isResource) {
-                                continue;  // 不是我们关心的文件类型
-                            }
+                        if (!isCppSource && !isCppHeader &&
+                            !decision.isConfig && !decision.isDocument && !decision.isResource) {
+                            continue;  // 不是我们关心的文件类型
                         }
                         
-                        std::string pathStr;
-                        if (useRelativePaths) {
-                            pathStr = pathCache.getRelativePath(entry.path());
-                        } else {
-                            pathStr = pathToUtf8String(entry.path());
-                        }
+                        std::string pathStr = useRelativePaths ? relPathStr : pathToUtf8String(entry.path());
                         
                         if (pathStr.empty() || seenPaths.find(pathStr) != seenPaths.end()) {
                             continue;
@@ -692,21 +641,12 @@ namespace {
                             sourceFiles.push_back(pathStr);
                         } else if (isCppHeader) {
                             headerFiles.push_back(pathStr);
-                        } else {
-                            // 检查是否是文档文件或资源文件（ext已在上面定义）
-                            
-                            fs::path relPath = fs::relative(entry.path(), projectRoot);
-                            std::string relPathStr = pathToUtf8String(relPath);
-                            std::replace(relPathStr.begin(), relPathStr.end(), '\\', '/');
-                            
-                            if (ProjectFileWhitelist::isDocumentFileExtension(ext) ||
-                                whitelist.docFiles.find(relPathStr) != whitelist.docFiles.end()) {
-                                docFiles.push_back(pathStr);
-                            } else if (ProjectFileWhitelist::isResourceFileExtension(ext)) {
-                                resourceFiles.push_back(pathStr);
-                            }
-                            // 配置文件已经在configFiles中，不需要单独列出
+                        } else if (decision.isDocument) {
+                            docFiles.push_back(pathStr);
+                        } else if (decision.extensionFlags & ExtensionFlags::Resource) {
+                            resourceFiles.push_back(pathStr);
                         }
+                        // 配置文件已经在configFiles中，不需要单独列出
                     }
                     
                     } catch (const fs::filesystem_error&) {
@@ -771,217 +711,580 @@ static ProjectStructureCache& getCacheManager() {
     return cache;
 }
 
-static nlohmann::json handleGetProjectStructure(const nlohmann::json& arguments) {
-    try {
-        // 提取参数
-        bool includeFiles = arguments.value("include_files", true);
-        bool includeDependencies = arguments.value("include_dependencies", true);
-        bool useRelativePaths = arguments.value("use_relative_paths", true);
-        std::string detailLevel = arguments.value("detail_level", "normal");
-        size_t maxFiles = arguments.value("max_files", SafetyLimits::MAX_FILES);
-        size_t maxOutputSize = arguments.value("max_output_size", SafetyLimits::MAX_OUTPUT_SIZE);
-        bool forceRefresh = arguments.value("force_refresh", false);
-        bool disableSmartFiltering = arguments.value("disable_smart_filtering", false);
+// ==================== 分页输出 ====================
+
+namespace {
+    constexpr size_t DEFAULT_PAGE_TOKENS = 2000;   // 默认每页Token上限
+    constexpr size_t MIN_PAGE_TOKENS = 200;        // 每页Token下限
+    constexpr size_t MAX_PAGE_TOKENS = 16000;      // 每页Token上限
+    
+    /**
+     * @brief 分页条目
+     */
+    struct StructureEntry {
+        std::string path;
+        std::string type;   // dir / source / header / doc / resource / file
+        size_t depth{0};    // 路径深度（根目录下为0）
+    };
+    
+    size_t pathDepth(const std::string& path) {
+        std::string trimmed = path;
+        while (!trimmed.empty() && trimmed.back() == '/') {
+            trimmed.pop_back();
+        }
+        return static_cast<size_t>(std::count(trimmed.begin(), trimmed.end(), '/'));
+    }
+    
+    /**
+     * @brief 将完整结构展开为按路径排序的条目列表
+     */
+    std::vector<StructureEntry> collectStructureEntries(const nlohmann::json& full, size_t maxDepth) {
+        std::map<std::string, std::string> entries;  // 路径 -> 类型（有序）
         
-        // 提取自定义过滤模式
-        std::vector<std::string> excludePatterns;
-        if (arguments.contains("exclude_patterns") && arguments["exclude_patterns"].is_array()) {
-            for (const auto& pattern : arguments["exclude_patterns"]) {
-                if (pattern.is_string()) {
-                    excludePatterns.push_back(pattern.get<std::string>());
+        auto addList = [&entries, &full](const char* field, const char* type) {
+            if (!full.contains(field) || !full[field].is_array()) {
+                return;
+            }
+            for (const auto& item : full[field]) {
+                if (item.is_string()) {
+                    std::string path = item.get<std::string>();
+                    std::replace(path.begin(), path.end(), '\\', '/');
+                    entries[path] = type;
                 }
             }
-        }
+        };
+        addList("source_files", "source");
+        addList("header_files", "header");
+        addList("doc_files", "doc");
+        addList("resource_files", "resource");
         
-        std::vector<std::string> includePatterns;
-        if (arguments.contains("include_patterns") && arguments["include_patterns"].is_array()) {
-            for (const auto& pattern : arguments["include_patterns"]) {
-                if (pattern.is_string()) {
-                    includePatterns.push_back(pattern.get<std::string>());
+        if (full.contains("structure") && full["structure"].is_string()) {
+            std::istringstream iss(full["structure"].get<std::string>());
+            std::string line;
+            while (std::getline(iss, line)) {
+                if (line.empty()) {
+                    continue;
+                }
+                std::replace(line.begin(), line.end(), '\\', '/');
+                if (line.back() == '/') {
+                    line.pop_back();
+                    if (!line.empty()) {
+                        entries.emplace(line, "dir");
+                    }
+                } else {
+                    entries.emplace(line, "file");
                 }
             }
         }
         
-        // 确定项目根目录
-        fs::path projectRoot;
-        if (arguments.contains("project_root") && arguments["project_root"].is_string()) {
-            projectRoot = fs::path(arguments["project_root"].get<std::string>());
-        } else {
-            projectRoot = detectProjectRoot(fs::current_path());
-        }
-        
-        projectRoot = fs::absolute(projectRoot);
-        
-        // 验证项目根目录
-        if (!fs::exists(projectRoot)) {
-            return nlohmann::json{{"error", "项目根目录不存在: " + pathToUtf8String(projectRoot)}};
+        std::vector<StructureEntry> result;
+        result.reserve(entries.size());
+        for (auto& [path, type] : entries) {
+            size_t depth = pathDepth(path);
+            if (depth <= maxDepth) {
+                result.push_back({path, type, depth});
+            }
         }
-        
-        if (!fs::is_directory(projectRoot)) {
-            return nlohmann::json{{"error", "项目根路径不是目录: " + pathToUtf8String(projectRoot)}};
+        return result;
+    }
+    
+    std::string toHex(const std::string& input) {
+        static const char* digits = "0123456789abcdef";
+        std::string out;
+        out.reserve(input.size() * 2);
+        for (unsigned char c : input) {
+            out += digits[c >> 4];
+            out += digits[c & 0x0F];
         }
-        
-        // 检查网络路径
-        if (isNetworkPath(projectRoot)) {
-            return nlohmann::json{{"error", "不支持网络路径，请使用本地路径"}};
+        return out;
+    }
+    
+    bool fromHex(const std::string& input, std::string& out) {
+        if (input.size() % 2 != 0) {
+            return false;
         }
-        
-        // 构建项目白名单（智能过滤）
-        ProjectFileWhitelist whitelist;
-        bool useSmartFiltering = !disableSmartFiltering;
-        
-        if (useSmartFiltering) {
-            // 默认扫描目录和排除目录（包含文档和资源目录）
-            std::vector<std::string> scanSrcDirs = {
-                "src", "include", "config", 
-                "docs", "doc", "documentation",  // 文档目录
-                "resources", "assets", "res", "data"  // 资源目录
+        out.clear();
+        out.reserve(input.size() / 2);
+        for (size_t i = 0; i < input.size(); i += 2) {
+            auto hexValue = [](char c) {
+                if (c >= '0' && c <= '9') return c - '0';
+                if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+                if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+                return -1;
             };
-            std::vector<std::string> excludeDirs = {"third_party", "build", "cmake-build-*", ".git"};
-            
-            whitelist = buildProjectWhitelist(projectRoot, true, true, scanSrcDirs, excludeDirs);
-        } else {
-            // 禁用智能过滤时，使用空白名单（会回退到全量扫描）
-            whitelist.scanRoots.push_back(projectRoot);
+            int hi = hexValue(input[i]);
+            int lo = hexValue(input[i + 1]);
+            if (hi < 0 || lo < 0) {
+                return false;
+            }
+            out += static_cast<char>((hi << 4) | lo);
         }
+        return true;
+    }
+    
+    /**
+     * @brief 分页快照：首页时将完整结构展开、排序并按深度过滤一次，后续页直接从快照取条目
+     */
+    struct StructureSnapshot {
+        std::string cacheKey;    // 生成快照时的结构缓存键
+        std::string signature;   // 影响结构内容的请求参数（不含分页参数）
+        size_t maxDepth{0};
+        nlohmann::json header;   // root_path / project_name / dependencies / cached
+        std::vector<StructureEntry> entries;
+        std::chrono::steady_clock::time_point created;
+    };
+    
+    /**
+     * @brief 最近的分页快照（LRU，超时失效）
+     */
+    class StructureSnapshotStore {
+    public:
+        static constexpr size_t MAX_SNAPSHOTS = 8;
+        static constexpr std::chrono::minutes TTL{10};
         
-        // 生成缓存键
-        std::string cacheKey = ProjectStructureCache::generateKey(
-            projectRoot, detailLevel, whitelist.combinedHash);
-        
-        // 尝试从缓存获取（如果不强制刷新）
-        auto& cacheManager = getCacheManager();
-        nlohmann::json result;
+        std::string put(std::shared_ptr<const StructureSnapshot> snapshot) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::string id = snapshot->cacheKey + "-" + std::to_string(++m_sequence);
+            m_snapshots.emplace_front(id, std::move(snapshot));
+            while (m_snapshots.size() > MAX_SNAPSHOTS) {
+                m_snapshots.pop_back();
+            }
+            return id;
+        }
         
-        if (!forceRefresh) {
-            auto cached = cacheManager.get(cacheKey);
-            if (cached.has_value() && !cached->isExpired()) {
-                // 缓存命中，立即返回
-                result = cached->data;
-                
-                // 确保必要的字段存在（向后兼容）
-                if (!result.contains("files_skipped")) {
-                    result["files_skipped"] = 0;
-                }
-                if (!result.contains("files_filtered")) {
-                    result["files_filtered"] = 0;
-                }
-                if (!result.contains("source_files")) {
-                    result["source_files"] = nlohmann::json::array();
-                }
-                if (!result.contains("header_files")) {
-                    result["header_files"] = nlohmann::json::array();
+        std::shared_ptr<const StructureSnapshot> find(const std::string& id) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto now = std::chrono::steady_clock::now();
+            for (auto it = m_snapshots.begin(); it != m_snapshots.end(); ++it) {
+                if (it->first != id) {
+                    continue;
                 }
-                if (!result.contains("structure")) {
-                    result["structure"] = "";
+                if (now - it->second->created > TTL) {
+                    m_snapshots.erase(it);
+                    return nullptr;
                 }
-                
-                // 后台异步检查更新（存储future以避免立即销毁）
-                auto future = std::async(std::launch::async, [&cacheManager, cacheKey, projectRoot, &whitelist]() {
-                    try {
-                        cacheManager.checkAndUpdate(cacheKey, projectRoot, whitelist);
-                    } catch (...) {
-                        // 忽略后台更新错误
-                    }
-                });
-                (void)future;  // 避免未使用变量警告
-                
-                result["cached"] = true;
-                return result;
+                m_snapshots.splice(m_snapshots.begin(), m_snapshots, it);
+                return m_snapshots.front().second;
             }
+            return nullptr;
         }
         
-        // 缓存未命中或强制刷新，执行扫描
-        result["root_path"] = useRelativePaths ? "." : pathToUtf8String(projectRoot);
-        result["project_name"] = "";
-        result["cached"] = false;
+    private:
+        std::mutex m_mutex;
+        std::list<std::pair<std::string, std::shared_ptr<const StructureSnapshot>>> m_snapshots;
+        uint64_t m_sequence{0};
+    };
+    
+    StructureSnapshotStore& getSnapshotStore() {
+        static StructureSnapshotStore store;
+        return store;
+    }
+    
+    /**
+     * @brief 生成游标：快照ID + 最大深度 + 上一页最后一个路径
+     *
+     * 游标按路径续读（而不是按偏移），因此快照失效后重新生成时也不会重复或跳过未变化的条目。
+     */
+    std::string encodeCursor(const std::string& snapshotId, size_t maxDepth, const std::string& lastPath) {
+        return snapshotId + "." + std::to_string(maxDepth) + "." + toHex(lastPath);
+    }
+    
+    bool decodeCursor(const std::string& cursor, size_t maxDepth, std::string& snapshotId, std::string& lastPath) {
+        const size_t pathDot = cursor.rfind('.');
+        if (pathDot == std::string::npos || pathDot == 0) {
+            return false;
+        }
+        const size_t depthDot = cursor.rfind('.', pathDot - 1);
+        if (depthDot == std::string::npos || depthDot == 0) {
+            return false;
+        }
+        if (cursor.substr(depthDot + 1, pathDot - depthDot - 1) != std::to_string(maxDepth)) {
+            return false;
+        }
+        snapshotId = cursor.substr(0, depthDot);
+        return fromHex(cursor.substr(pathDot + 1), lastPath);
+    }
+    
+    bool isPaginatedRequest(const nlohmann::json& arguments) {
+        return arguments.value("paginate", false) ||
+               (arguments.contains("cursor") && arguments["cursor"].is_string()) ||
+               arguments.contains("page_tokens");
+    }
+    
+    /**
+     * @brief 影响结构内容的请求参数（去掉分页与刷新参数），用于确认游标属于同一请求
+     */
+    std::string requestSignature(const nlohmann::json& arguments) {
+        nlohmann::json copy = arguments;
+        for (const char* key : {"cursor", "page_tokens", "paginate", "force_refresh", "max_output_size"}) {
+            copy.erase(key);
+        }
+        return copy.dump();
+    }
+    
+    std::shared_ptr<const StructureSnapshot> makeSnapshot(const nlohmann::json& full,
+                                                          const std::string& cacheKey,
+                                                          const std::string& signature,
+                                                          size_t maxDepth) {
+        auto snapshot = std::make_shared<StructureSnapshot>();
+        snapshot->cacheKey = cacheKey;
+        snapshot->signature = signature;
+        snapshot->maxDepth = maxDepth;
+        snapshot->header["root_path"] = full.value("root_path", "");
+        snapshot->header["project_name"] = full.value("project_name", "");
+        if (full.contains("dependencies")) {
+            snapshot->header["dependencies"] = full["dependencies"];
+        }
+        snapshot->header["cached"] = full.value("cached", false);
+        snapshot->entries = collectStructureEntries(full, maxDepth);
+        snapshot->created = std::chrono::steady_clock::now();
+        return snapshot;
+    }
+    
+    /**
+     * @brief 从快照中截取一页
+     *
+     * 条目已按路径排序，逐条累加Token估算，达到每页上限时停止并返回 next_cursor。
+     * 第一页附带项目名、依赖等摘要字段，后续页只包含条目。
+     */
+    nlohmann::json renderStructurePage(const StructureSnapshot& snapshot,
+                                       const std::string& snapshotId,
+                                       bool firstPage,
+                                       const std::string& lastPath,
+                                       size_t pageTokens) {
+        static const utils::TokenEstimator estimator;
         
-        // 解析CMakeLists.txt
-        fs::path cmakePath = projectRoot / "CMakeLists.txt";
-        nlohmann::json cmakeConfig = parseCMakeLists(cmakePath);
-        if (includeDependencies) {
-            result["cmake_config"] = cmakeConfig;
-            if (!cmakeConfig["project_name"].empty()) {
-                result["project_name"] = cmakeConfig["project_name"];
+        const auto& entries = snapshot.entries;
+        auto begin = entries.begin();
+        if (!firstPage) {
+            begin = std::upper_bound(entries.begin(), entries.end(), lastPath,
+                [](const std::string& path, const StructureEntry& entry) { return path < entry.path; });
+        }
+        
+        nlohmann::json page;
+        page["root_path"] = snapshot.header.value("root_path", "");
+        if (firstPage) {
+            page["project_name"] = snapshot.header.value("project_name", "");
+            if (snapshot.header.contains("dependencies")) {
+                page["dependencies"] = snapshot.header["dependencies"];
             }
         }
+        page["cached"] = firstPage ? snapshot.header.value("cached", false) : true;
+        page["total_entries"] = entries.size();
+        page["max_depth"] = snapshot.maxDepth;
         
-        // 初始化性能监控和缓存
-        PerformanceStats stats;
-        PathCache pathCache(projectRoot);
+        // 估算固定部分的Token
+        size_t usedTokens = estimator.estimateTokens("default", page.dump());
+        nlohmann::json items = nlohmann::json::array();
+        auto it = begin;
+        for (; it != entries.end(); ++it) {
+            nlohmann::json item{{"path", it->path}, {"type", it->type}, {"depth", it->depth}};
+            size_t itemTokens = estimator.estimateTokens("default", item.dump());
+            // 每页至少包含一个条目
+            if (!items.empty() && usedTokens + itemTokens > pageTokens) {
+                break;
+            }
+            usedTokens += itemTokens;
+            items.push_back(std::move(item));
+        }
         
-        // 扫描项目结构（基于白名单）
-        nlohmann::json scanResult = scanProjectStructure(
-            projectRoot, includeFiles, useRelativePaths, detailLevel,
-            maxFiles, excludePatterns, includePatterns, stats, pathCache, whitelist
-        );
+        page["entries"] = std::move(items);
+        page["offset"] = static_cast<size_t>(begin - entries.begin());
+        page["page_tokens"] = usedTokens;
+        page["has_more"] = it != entries.end();
+        if (it != entries.end()) {
+            page["next_cursor"] = encodeCursor(snapshotId, snapshot.maxDepth, std::prev(it)->path);
+        } else {
+            page["next_cursor"] = nullptr;
+        }
+        return page;
+    }
+}
+
+/**
+ * @brief 获取完整项目结构（缓存命中时直接返回缓存的结构）
+ * @param arguments 工具参数
+ * @param cacheKey 输出本次使用的缓存键（用于分页游标）
+ * @return 项目结构；失败时返回包含 error 字段的对象
+ */
+static nlohmann::json collectProjectStructure(const nlohmann::json& arguments, std::string& cacheKey,
+                                              const std::atomic<bool>* cancel = nullptr) {
+    // 提取参数
+    bool includeFiles = arguments.value("include_files", true);
+    bool includeDependencies = arguments.value("include_dependencies", true);
+    bool useRelativePaths = arguments.value("use_relative_paths", true);
+    std::string detailLevel = arguments.value("detail_level", "normal");
+    size_t maxFiles = arguments.value("max_files", SafetyLimits::MAX_FILES);
+    bool forceRefresh = arguments.value("force_refresh", false);
+    bool disableSmartFiltering = arguments.value("disable_smart_filtering", false);
+    
+    // 提取自定义过滤模式
+    std::vector<std::string> excludePatterns;
+    if (arguments.contains("exclude_patterns") && arguments["exclude_patterns"].is_array()) {
+        for (const auto& pattern : arguments["exclude_patterns"]) {
+            if (pattern.is_string()) {
+                excludePatterns.push_back(pattern.get<std::string>());
+            }
+        }
+    }
+    
+    std::vector<std::string> includePatterns;
+    if (arguments.contains("include_patterns") && arguments["include_patterns"].is_array()) {
+        for (const auto& pattern : arguments["include_patterns"]) {
+            if (pattern.is_string()) {
+                includePatterns.push_back(pattern.get<std::string>());
+            }
+        }
+    }
+    
+    // 确定项目根目录
+    fs::path projectRoot;
+    if (arguments.contains("project_root") && arguments["project_root"].is_string()) {
+        projectRoot = fs::path(arguments["project_root"].get<std::string>());
+    } else {
+        projectRoot = detectProjectRoot(fs::current_path());
+    }
+    
+    projectRoot = fs::absolute(projectRoot);
+    
+    // 验证项目根目录
+    if (!fs::exists(projectRoot)) {
+        return nlohmann::json{{"error", "项目根目录不存在: " + pathToUtf8String(projectRoot)}};
+    }
+    
+    if (!fs::is_directory(projectRoot)) {
+        return nlohmann::json{{"error", "项目根路径不是目录: " + pathToUtf8String(projectRoot)}};
+    }
+    
+    // 检查网络路径
+    if (isNetworkPath(projectRoot)) {
+        return nlohmann::json{{"error", "不支持网络路径，请使用本地路径"}};
+    }
+    
+    // 构建项目白名单（智能过滤）
+    ProjectFileWhitelist whitelist;
+    bool useSmartFiltering = !disableSmartFiltering;
+    
+    if (useSmartFiltering) {
+        // 默认扫描目录和排除目录（包含文档和资源目录）
+        std::vector<std::string> scanSrcDirs = {
+            "src", "include", "config", 
+            "docs", "doc", "documentation",  // 文档目录
+            "resources", "assets", "res", "data"  // 资源目录
+        };
+        std::vector<std::string> excludeDirs = {"third_party", "build", "cmake-build-*", ".git"};
         
-        // 收集文件快照（用于增量更新）
-        std::unordered_map<std::string, FileSnapshot> snapshots;
-        try {
-            for (const auto& srcFile : scanResult["source_files"]) {
-                if (srcFile.is_string()) {
-                    fs::path filePath = projectRoot / srcFile.get<std::string>();
-                    if (fs::exists(filePath)) {
-                        std::string relPath = srcFile.get<std::string>();
-                        snapshots[relPath] = FileSnapshot(filePath);
-                    }
-                }
+        whitelist = buildProjectWhitelist(projectRoot, true, true, scanSrcDirs, excludeDirs);
+    } else {
+        // 禁用智能过滤时，使用空白名单（会回退到全量扫描）
+        whitelist.scanRoots.push_back(projectRoot);
+    }
+    
+    // 生成缓存键
+    cacheKey = ProjectStructureCache::generateKey(
+        projectRoot, detailLevel, whitelist.combinedHash);
+    
+    // 尝试从缓存获取（如果不强制刷新）
+    auto& cacheManager = getCacheManager();
+    nlohmann::json result;
+    
+    if (!forceRefresh) {
+        auto cached = cacheManager.get(cacheKey);
+        if (cached && !cached->isExpired()) {
+            // 缓存命中，立即返回
+            result = cached->data;
+            
+            // 确保必要的字段存在（向后兼容）
+            if (!result.contains("files_skipped")) {
+                result["files_skipped"] = 0;
             }
-            for (const auto& headerFile : scanResult["header_files"]) {
-                if (headerFile.is_string()) {
-                    fs::path filePath = projectRoot / headerFile.get<std::string>();
-                    if (fs::exists(filePath)) {
-                        std::string relPath = headerFile.get<std::string>();
-                        snapshots[relPath] = FileSnapshot(filePath);
-                    }
+            if (!result.contains("files_filtered")) {
+                result["files_filtered"] = 0;
+            }
+            if (!result.contains("source_files")) {
+                result["source_files"] = nlohmann::json::array();
+            }
+            if (!result.contains("header_files")) {
+                result["header_files"] = nlohmann::json::array();
+            }
+            if (!result.contains("structure")) {
+                result["structure"] = "";
+            }
+            
+            // 后台检查更新：由缓存自身的刷新线程执行，不阻塞本次返回；同一时刻只运行一个检查
+            cacheManager.scheduleCheckAndUpdate(cacheKey, projectRoot, std::move(whitelist));
+            
+            result["cached"] = true;
+            return result;
+        }
+    }
+    
+    // 缓存未命中或强制刷新，执行扫描
+    result["root_path"] = useRelativePaths ? "." : pathToUtf8String(projectRoot);
+    result["project_name"] = "";
+    result["cached"] = false;
+    
+    // 解析CMakeLists.txt
+    fs::path cmakePath = projectRoot / "CMakeLists.txt";
+    nlohmann::json cmakeConfig = parseCMakeLists(cmakePath);
+    if (includeDependencies) {
+        result["cmake_config"] = cmakeConfig;
+        if (!cmakeConfig["project_name"].empty()) {
+            result["project_name"] = cmakeConfig["project_name"];
+        }
+    }
+    
+    // 初始化性能监控和缓存
+    PerformanceStats stats;
+    stats.cancelFlag = cancel;
+    PathCache pathCache(projectRoot);
+    
+    // 扫描项目结构（基于白名单）
+    nlohmann::json scanResult = scanProjectStructure(
+        projectRoot, includeFiles, useRelativePaths, detailLevel,
+        maxFiles, excludePatterns, includePatterns, stats, pathCache, whitelist
+    );
+    
+    // 被取消的扫描结果不完整，不写入缓存
+    if (stats.isCancelled()) {
+        return nlohmann::json{{"error", "扫描已取消"}};
+    }
+    
+    // 收集文件快照（用于增量更新）
+    std::unordered_map<std::string, FileSnapshot> snapshots;
+    try {
+        for (const auto& srcFile : scanResult["source_files"]) {
+            if (srcFile.is_string()) {
+                fs::path filePath = projectRoot / srcFile.get<std::string>();
+                if (fs::exists(filePath)) {
+                    std::string relPath = srcFile.get<std::string>();
+                    snapshots[relPath] = FileSnapshot(filePath);
                 }
             }
-        } catch (...) {
-            // 忽略快照收集错误
         }
-        
-        // 合并结果
-        result["source_files"] = scanResult["source_files"];
-        result["header_files"] = scanResult["header_files"];
-        if (scanResult.contains("doc_files")) {
-            result["doc_files"] = scanResult["doc_files"];
+        for (const auto& headerFile : scanResult["header_files"]) {
+            if (headerFile.is_string()) {
+                fs::path filePath = projectRoot / headerFile.get<std::string>();
+                if (fs::exists(filePath)) {
+                    std::string relPath = headerFile.get<std::string>();
+                    snapshots[relPath] = FileSnapshot(filePath);
+                }
+            }
         }
-        if (scanResult.contains("resource_files")) {
-            result["resource_files"] = scanResult["resource_files"];
+    } catch (...) {
+        // 忽略快照收集错误
+    }
+    
+    // 合并结果
+    result["source_files"] = scanResult["source_files"];
+    result["header_files"] = scanResult["header_files"];
+    if (scanResult.contains("doc_files")) {
+        result["doc_files"] = scanResult["doc_files"];
+    }
+    if (scanResult.contains("resource_files")) {
+        result["resource_files"] = scanResult["resource_files"];
+    }
+    result["structure"] = scanResult["structure"];
+    
+    if (scanResult.contains("warning")) {
+        result["warning"] = scanResult["warning"];
+    }
+    
+    // 更新缓存（使用移动语义）
+    try {
+        cacheManager.put(cacheKey, result, std::move(whitelist), snapshots);
+    } catch (...) {
+        // 缓存更新失败不影响结果返回
+    }
+    
+    // 添加统计信息（在根级别添加关键统计字段以满足测试要求）
+    result["files_filtered"] = stats.filesFiltered;
+    result["files_skipped"] = stats.filesSkipped;
+    
+    result["stats"] = {
+        {"files_scanned", stats.filesScanned},
+        {"dirs_scanned", stats.dirsScanned},
+        {"files_filtered", stats.filesFiltered},
+        {"files_skipped", stats.filesSkipped},
+        {"elapsed_seconds", stats.getElapsedSeconds()},
+        {"timed_out", stats.timedOut},
+        {"memory_limit_hit", stats.memoryLimitHit}
+    };
+    
+    // 提取依赖
+    if (includeDependencies && cmakeConfig.contains("dependencies")) {
+        result["dependencies"] = cmakeConfig["dependencies"];
+    } else {
+        result["dependencies"] = nlohmann::json::array();
+    }
+    
+    return result;
+}
+
+/**
+ * @brief 分页请求：首页（或快照失效时）收集一次结构并生成快照，后续页只读快照，不重新收集
+ */
+static nlohmann::json handleStructurePage(const nlohmann::json& arguments) {
+    size_t maxDepth = SafetyLimits::MAX_DEPTH;
+    if (arguments.contains("max_depth") && arguments["max_depth"].is_number_integer()) {
+        maxDepth = static_cast<size_t>(std::max<int64_t>(0, arguments["max_depth"].get<int64_t>()));
+    }
+    size_t pageTokens = DEFAULT_PAGE_TOKENS;
+    if (arguments.contains("page_tokens") && arguments["page_tokens"].is_number_integer()) {
+        pageTokens = static_cast<size_t>(std::max<int64_t>(0, arguments["page_tokens"].get<int64_t>()));
+    }
+    pageTokens = std::clamp(pageTokens, MIN_PAGE_TOKENS, MAX_PAGE_TOKENS);
+    
+    static const char* invalidCursor = "无效的分页游标（项目、detail_level 或 max_depth 已变化），请不带 cursor 重新请求";
+    const std::string signature = requestSignature(arguments);
+    std::string snapshotId;
+    std::string lastPath;
+    bool firstPage = true;
+    if (arguments.contains("cursor") && arguments["cursor"].is_string() &&
+        !arguments["cursor"].get<std::string>().empty()) {
+        if (!decodeCursor(arguments["cursor"].get<std::string>(), maxDepth, snapshotId, lastPath)) {
+            return nlohmann::json{{"error", invalidCursor}};
         }
-        result["structure"] = scanResult["structure"];
+        firstPage = false;
         
-        if (scanResult.contains("warning")) {
-            result["warning"] = scanResult["warning"];
+        // 快照仍在：直接续读
+        if (!arguments.value("force_refresh", false)) {
+            if (auto snapshot = getSnapshotStore().find(snapshotId)) {
+                if (snapshot->signature != signature) {
+                    return nlohmann::json{{"error", invalidCursor}};
+                }
+                return renderStructurePage(*snapshot, snapshotId, false, lastPath, pageTokens);
+            }
         }
+    }
+    
+    std::string cacheKey;
+    nlohmann::json full = collectProjectStructure(arguments, cacheKey);
+    if (full.contains("error")) {
+        return full;
+    }
+    // 快照已失效：确认游标来自同一项目与配置后，在新快照上按路径续读
+    if (!firstPage && snapshotId.compare(0, cacheKey.size() + 1, cacheKey + "-") != 0) {
+        return nlohmann::json{{"error", invalidCursor}};
+    }
+    auto snapshot = makeSnapshot(full, cacheKey, signature, maxDepth);
+    const std::string newId = getSnapshotStore().put(snapshot);
+    return renderStructurePage(*snapshot, newId, firstPage, lastPath, pageTokens);
+}
+
+static nlohmann::json handleGetProjectStructure(const nlohmann::json& arguments) {
+    try {
+        size_t maxOutputSize = arguments.value("max_output_size", SafetyLimits::MAX_OUTPUT_SIZE);
         
-        // 更新缓存（使用移动语义）
-        try {
-            cacheManager.put(cacheKey, result, std::move(whitelist), snapshots);
-        } catch (...) {
-            // 缓存更新失败不影响结果返回
+        // 分页模式：按游标返回一页条目
+        if (isPaginatedRequest(arguments)) {
+            return handleStructurePage(arguments);
         }
         
-        // 添加统计信息（在根级别添加关键统计字段以满足测试要求）
-        result["files_filtered"] = stats.filesFiltered;
-        result["files_skipped"] = stats.filesSkipped;
-        
-        result["stats"] = {
-            {"files_scanned", stats.filesScanned},
-            {"dirs_scanned", stats.dirsScanned},
-            {"files_filtered", stats.filesFiltered},
-            {"files_skipped", stats.filesSkipped},
-            {"elapsed_seconds", stats.getElapsedSeconds()},
-            {"timed_out", stats.timedOut},
-            {"memory_limit_hit", stats.memoryLimitHit}
-        };
-        
-        // 提取依赖
-        if (includeDependencies && cmakeConfig.contains("dependencies")) {
-            result["dependencies"] = cmakeConfig["dependencies"];
-        } else {
-            result["dependencies"] = nlohmann::json::array();
+        std::string cacheKey;
+        nlohmann::json result = collectProjectStructure(arguments, cacheKey);
+        if (result.contains("error")) {
+            return result;
         }
         
         // 输出大小控制
@@ -1065,6 +1368,16 @@ static nlohmann::json handleGetProjectStructure(const nlohmann::json& arguments)
 
 // ==================== 工具注册 ====================
 
+bool CodeTools::prewarmProjectStructure(const std::string& projectRoot, const std::atomic<bool>* cancel) {
+    try {
+        std::string cacheKey;
+        nlohmann::json result = collectProjectStructure(nlohmann::json{{"project_root", projectRoot}}, cacheKey, cancel);
+        return !result.contains("error");
+    } catch (...) {
+        return false;
+    }
+}
+
 void CodeTools::registerGetProjectStructureTool(ToolManager& toolManager) {
     ToolDefinition tool;
     tool.name = "get_project_structure";
@@ -1096,7 +1409,12 @@ void CodeTools::registerGetProjectStructureTool(ToolManager& toolManager) {
 - 对于大型项目，建议使用 detail_level="minimal" 或 "normal"
 - 可通过 exclude_patterns 排除特定目录以提高性能
 - 使用 force_refresh=true 强制刷新缓存
-- 使用 disable_smart_filtering=true 可回退到全量扫描（不推荐）)";
+- 使用 disable_smart_filtering=true 可回退到全量扫描（不推荐）
+
+分页模式（推荐用于大型项目）：
+- 传入 paginate=true 或 page_tokens 开启；返回按路径排序的 entries 列表
+- 每页大小按Token限制（page_tokens，默认2000），max_depth 限制路径深度
+- 若 has_more=true，将 next_cursor 作为 cursor 传入获取下一页（基于缓存的目录树，不重复扫描）)";
     
     tool.parametersSchema = nlohmann::json{
         {"type", "object"},
@@ -1159,6 +1477,28 @@ void CodeTools::registerGetProjectStructureTool(ToolManager& toolManager) {
                 {"type", "boolean"},
                 {"default", false},
                 {"description", "是否禁用智能过滤（回退到全量扫描，不推荐）"}
+            }},
+            {"paginate", {
+                {"type", "boolean"},
+                {"default", false},
+                {"description", "是否使用分页模式（返回 entries 列表和 next_cursor）"}
+            }},
+            {"cursor", {
+                {"type", "string"},
+                {"description", "分页游标（上一页返回的 next_cursor），传入时自动使用分页模式"}
+            }},
+            {"page_tokens", {
+                {"type", "integer"},
+                {"minimum", 200},
+                {"maximum", 16000},
+                {"default", 2000},
+                {"description", "分页模式下每页的最大Token数"}
+            }},
+            {"max_depth", {
+                {"type", "integer"},
+                {"minimum", 0},
+                {"maximum", 8},
+                {"description", "分页模式下的最大路径深度（0表示只列出根目录下的条目）"}
             }}
         }},
         {"required", nlohmann::json::array()}
@@ -34,6 +34,14 @@ ProjectStructureCache::ProjectStructureCache(const fs::path& cacheDir) : cacheDi
     }
 }
 
+ProjectStructureCache::~ProjectStructureCache() {
+    stopRequested_.store(true);
+    std::lock_guard<std::mutex> lock(refreshMutex_);
+    if (refreshThread_.joinable()) {
+        refreshThread_.join();
+    }
+}
+
 std::string ProjectStructureCache::generateKey(
     const fs::path& projectRoot,
     const std::string& detailLevel,
@@ -47,16 +55,15 @@ std::string ProjectStructureCache::generateKey(
     return computeHash(oss.str());
 }
 
-std::optional<CacheEntry> ProjectStructureCache::get(const std::string& key) {
+std::shared_ptr<const CacheEntry> ProjectStructureCache::get(const std::string& key) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     // 先检查内存缓存
     auto it = memoryCache_.find(key);
     if (it != memoryCache_.end()) {
-        if (!it->second.isExpired()) {
+        if (!it->second->isExpired()) {
             stats_.hitCount++;
-            // 使用移动语义返回
-            return std::make_optional<CacheEntry>(std::move(it->second));
+            return it->second;
         } else {
             // 已过期，从内存中移除
             memoryCache_.erase(it);
@@ -66,19 +73,14 @@ std::optional<CacheEntry> ProjectStructureCache::get(const std::string& key) {
     // 从文件系统加载
     auto entryOpt = loadFromFile(key);
     if (entryOpt.has_value() && !entryOpt->isExpired()) {
-        // 加载到内存缓存（使用移动语义）
-        CacheEntry entry = std::move(entryOpt.value());
-        memoryCache_[key] = std::move(entry);
+        auto entry = std::make_shared<const CacheEntry>(std::move(entryOpt.value()));
+        memoryCache_[key] = entry;
         stats_.hitCount++;
-        // 从内存缓存返回（使用移动语义）
-        auto it = memoryCache_.find(key);
-        if (it != memoryCache_.end()) {
-            return std::make_optional<CacheEntry>(std::move(it->second));
-        }
+        return entry;
     }
     
     stats_.missCount++;
-    return std::nullopt;
+    return nullptr;
 }
 
 void ProjectStructureCache::put(
@@ -102,37 +104,40 @@ void ProjectStructureCache::put(
     // 保存到文件系统（在移动之前）
     saveToFile(key, entry);
     
-    // 保存到内存缓存（使用移动语义）
-    memoryCache_[key] = std::move(entry);
+    // 保存到内存缓存（之后只读共享）
+    memoryCache_[key] = std::make_shared<const CacheEntry>(std::move(entry));
     
     stats_.totalEntries = memoryCache_.size();
 }
 
-std::optional<CacheEntry> ProjectStructureCache::checkAndUpdate(
+std::shared_ptr<const CacheEntry> ProjectStructureCache::checkAndUpdate(
     const std::string& key,
     const fs::path& projectRoot,
     const ProjectFileWhitelist& whitelist) {
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    
+    // get()/invalidate() 内部自行加锁，这里不能再持有 mutex_
     // 获取现有缓存
     auto cached = get(key);
-    if (!cached.has_value()) {
-        return std::nullopt;
+    if (!cached) {
+        return nullptr;
     }
     
-    // 检查配置文件哈希是否变化（在移动之前）
+    // 检查配置文件哈希是否变化
     std::string cachedHash = cached->whitelist.combinedHash;
     if (cachedHash != whitelist.combinedHash) {
         // 配置文件变化，缓存失效
         invalidate(key);
-        return std::nullopt;
+        return nullptr;
     }
     
     // 检查文件快照，找出变化的文件
     std::vector<std::string> changedFiles;
     
     for (const auto& [filePath, oldSnapshot] : cached->snapshots) {
+        if (stopRequested_.load(std::memory_order_relaxed)) {
+            // 检查被中断，无法断定缓存是否失效，保持原样
+            return cached;
+        }
         fs::path fullPath = projectRoot / filePath;
         FileSnapshot newSnapshot(fullPath);
         
@@ -146,21 +151,59 @@ std::optional<CacheEntry> ProjectStructureCache::checkAndUpdate(
     // 实际实现中可以只更新变化的部分
     if (!changedFiles.empty()) {
         invalidate(key);
-        return std::nullopt;
+        return nullptr;
     }
     
-    // 没有变化，返回缓存（使用移动语义）
-    return std::move(cached);
+    // 没有变化，返回缓存
+    return cached;
 }
 
-void ProjectStructureCache::invalidate(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool ProjectStructureCache::scheduleCheckAndUpdate(
+    const std::string& key,
+    const fs::path& projectRoot,
+    ProjectFileWhitelist&& whitelist) {
     
+    std::lock_guard<std::mutex> lock(refreshMutex_);
+    if (stopRequested_.load() || refreshRunning_.load()) {
+        return false;
+    }
+    // 上一次检查已结束，回收其线程
+    if (refreshThread_.joinable()) {
+        refreshThread_.join();
+    }
+    
+    refreshRunning_.store(true);
+    try {
+        refreshThread_ = std::thread([this, key, projectRoot, whitelist = std::move(whitelist)]() {
+            try {
+                checkAndUpdate(key, projectRoot, whitelist);
+            } catch (...) {
+                // 忽略后台更新错误
+            }
+            refreshRunning_.store(false);
+        });
+    } catch (...) {
+        refreshRunning_.store(false);
+        return false;
+    }
+    return true;
+}
+
+void ProjectStructureCache::waitForRefresh() {
+    std::lock_guard<std::mutex> lock(refreshMutex_);
+    if (refreshThread_.joinable()) {
+        refreshThread_.join();
+    }
+}
+
+void ProjectStructureCache::invalidate(const std::string& key) {
     if (key.empty()) {
         clear();
         return;
     }
     
+    std::lock_guard<std::mutex> lock(mutex_);
+    
     // 从内存缓存移除
     memoryCache_.erase(key);
     
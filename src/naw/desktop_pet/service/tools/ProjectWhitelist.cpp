@@ -2,6 +2,7 @@
 #include "naw/desktop_pet/service/tools/CodeToolsUtils.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <filesystem>
 #include <functional>
@@ -24,183 +25,397 @@ namespace {
     std::string combineHashes(const std::string& hash1, const std::string& hash2) {
         return computeStringHash(hash1 + "|" + hash2);
     }
-}
-
-namespace naw::desktop_pet::service::tools {
-
-bool ProjectFileWhitelist::isWhitelisted(const fs::path& filePath, const fs::path& projectRoot) const {
-    try {
-        fs::path relPath = fs::relative(filePath, projectRoot);
-        if (relPath.empty() || relPath == ".") {
-            return false;
-        }
-        
-        std::string relPathStr = pathToUtf8String(relPath);
-        std::replace(relPathStr.begin(), relPathStr.end(), '\\', '/');
-        
-        // 检查是否在源文件列表中
-        if (sourceFiles.find(relPathStr) != sourceFiles.end()) {
-            return true;
-        }
+    
+    using naw::desktop_pet::service::tools::ExtensionFlags;
+    
+    /**
+     * @brief 扩展名完美哈希表
+     * 
+     * 构造时搜索一个使所有已知扩展名互不冲突的种子，查询时只需一次哈希和一次比较。
+     * 搜索次数有上限；找不到时退化为线性探测表（查询多几次比较，结果不变）。
+     */
+    class ExtensionTable {
+    public:
+        static constexpr size_t TABLE_SIZE = 128;   // 2的幂，约为扩展名数量的3倍
+        static constexpr size_t MAX_EXT_LENGTH = 8;  // 含点
+        static constexpr uint32_t MAX_SEED_ATTEMPTS = 4096;
         
-        // 检查是否在配置文件中
-        if (configFiles.find(relPathStr) != configFiles.end()) {
-            return true;
+        ExtensionTable() {
+            const std::pair<const char*, uint8_t> entries[] = {
+                {".cpp", ExtensionFlags::Source}, {".cc", ExtensionFlags::Source},
+                {".cxx", ExtensionFlags::Source}, {".c", ExtensionFlags::Source},
+                {".c++", ExtensionFlags::Source}, {".java", ExtensionFlags::Source},
+                {".py", ExtensionFlags::Source | ExtensionFlags::Resource},
+                {".js", ExtensionFlags::Source | ExtensionFlags::Resource},
+                {".ts", ExtensionFlags::Source}, {".go", ExtensionFlags::Source},
+                {".rs", ExtensionFlags::Source},
+                {".h", ExtensionFlags::Header}, {".hpp", ExtensionFlags::Header},
+                {".hxx", ExtensionFlags::Header}, {".h++", ExtensionFlags::Header},
+                {".hh", ExtensionFlags::Header},
+                {".md", ExtensionFlags::Document}, {".txt", ExtensionFlags::Document},
+                {".rst", ExtensionFlags::Document}, {".adoc", ExtensionFlags::Document},
+                {".org", ExtensionFlags::Document}, {".pdf", ExtensionFlags::Document},
+                {".doc", ExtensionFlags::Document}, {".docx", ExtensionFlags::Document},
+                {".html", ExtensionFlags::Document}, {".htm", ExtensionFlags::Document},
+                {".png", ExtensionFlags::Resource}, {".jpg", ExtensionFlags::Resource},
+                {".jpeg", ExtensionFlags::Resource}, {".gif", ExtensionFlags::Resource},
+                {".svg", ExtensionFlags::Resource}, {".ico", ExtensionFlags::Resource},
+                {".bmp", ExtensionFlags::Resource}, {".json", ExtensionFlags::Resource},
+                {".xml", ExtensionFlags::Resource}, {".yaml", ExtensionFlags::Resource},
+                {".yml", ExtensionFlags::Resource}, {".toml", ExtensionFlags::Resource},
+                {".ini", ExtensionFlags::Resource}, {".conf", ExtensionFlags::Resource},
+                {".sh", ExtensionFlags::Resource}, {".bat", ExtensionFlags::Resource},
+                {".ps1", ExtensionFlags::Resource}, {".css", ExtensionFlags::Resource}
+            };
+            
+            for (m_seed = 0; m_seed < MAX_SEED_ATTEMPTS; ++m_seed) {
+                m_slots.fill(Slot{});
+                bool collision = false;
+                for (const auto& [ext, flags] : entries) {
+                    Slot& slot = m_slots[index(ext)];
+                    if (slot.flags != ExtensionFlags::None) {
+                        collision = true;
+                        break;
+                    }
+                    slot.key = ext;
+                    slot.flags = flags;
+                }
+                if (!collision) {
+                    m_perfect = true;
+                    return;
+                }
+            }
+            
+            // 线性探测兜底（表的装载率约 1/3，探测链很短）
+            m_seed = 0;
+            m_slots.fill(Slot{});
+            for (const auto& [ext, flags] : entries) {
+                size_t i = index(ext);
+                while (m_slots[i].flags != ExtensionFlags::None) {
+                    i = (i + 1) & (TABLE_SIZE - 1);
+                }
+                m_slots[i].key = ext;
+                m_slots[i].flags = flags;
+            }
         }
         
-        // 检查是否在包含目录下
-        for (const auto& includeDir : includeDirs) {
-            if (relPathStr.find(includeDir) == 0) {
-                // 检查文件扩展名
-                std::string ext = pathToUtf8String(filePath.extension());
-                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-                if (isHeaderFileExtension(ext) || isSourceFileExtension(ext)) {
-                    return true;
+        uint8_t lookup(std::string_view ext) const {
+            if (ext.empty() || ext.size() > MAX_EXT_LENGTH) {
+                return ExtensionFlags::None;
+            }
+            char lower[MAX_EXT_LENGTH];
+            for (size_t i = 0; i < ext.size(); ++i) {
+                lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(ext[i])));
+            }
+            std::string_view key(lower, ext.size());
+            size_t i = index(key);
+            if (m_perfect) {
+                return m_slots[i].key == key ? m_slots[i].flags : ExtensionFlags::None;
+            }
+            for (; m_slots[i].flags != ExtensionFlags::None; i = (i + 1) & (TABLE_SIZE - 1)) {
+                if (m_slots[i].key == key) {
+                    return m_slots[i].flags;
                 }
             }
+            return ExtensionFlags::None;
         }
         
-        // 检查文件扩展名（源文件、头文件、文档文件、资源文件）
-        std::string ext = pathToUtf8String(filePath.extension());
-        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    private:
+        struct Slot {
+            std::string_view key;
+            uint8_t flags{ExtensionFlags::None};
+        };
         
-        if (isSourceFileExtension(ext) || isHeaderFileExtension(ext) || 
-            isDocumentFileExtension(ext) || isResourceFileExtension(ext)) {
-            // 检查是否在任何扫描根目录下
-            for (const auto& scanRoot : scanRoots) {
-                try {
-                    fs::path absPath = fs::absolute(filePath);
-                    fs::path absScanRoot = fs::absolute(scanRoot);
-                    // 使用路径比较而不是字符串比较，避免路径分隔符问题
-                    try {
-                        fs::path relToRoot = fs::relative(absPath, absScanRoot);
-                        // 如果文件在扫描根目录下，relative 不会包含 ".."
-                        if (!relToRoot.empty() && relToRoot.string().find("..") != 0) {
-                            return true;
-                        }
-                    } catch (...) {
-                        // 如果 relative 失败，回退到字符串比较
-                        std::string absPathStr = absPath.string();
-                        std::string scanRootStr = absScanRoot.string();
-                        // 规范化路径分隔符
-                        std::replace(absPathStr.begin(), absPathStr.end(), '\\', '/');
-                        std::replace(scanRootStr.begin(), scanRootStr.end(), '\\', '/');
-                        if (absPathStr.find(scanRootStr) == 0) {
-                            return true;
-                        }
-                    }
-                } catch (...) {
-                    // 忽略错误
-                }
+        std::array<Slot, TABLE_SIZE> m_slots{};
+        uint32_t m_seed{0};
+        bool m_perfect{false};
+        
+        // FNV-1a，以种子扰动初始值
+        size_t index(std::string_view key) const {
+            uint32_t hash = 2166136261u ^ (m_seed * 0x9E3779B9u);
+            for (char c : key) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 16777619u;
             }
+            return (hash ^ (hash >> 15)) & (TABLE_SIZE - 1);
+        }
+    };
+    
+    const ExtensionTable& extensionTable() {
+        static const ExtensionTable table;
+        return table;
+    }
+    
+    // 与 fs::path::extension() 一致：以点开头且只有一个点的文件名（如 .gitignore）没有扩展名
+    std::string_view extensionOf(std::string_view relPath) {
+        size_t slash = relPath.find_last_of('/');
+        std::string_view filename = slash == std::string_view::npos ? relPath : relPath.substr(slash + 1);
+        size_t dot = filename.find_last_of('.');
+        if (dot == std::string_view::npos || dot == 0 || filename == "..") {
+            return {};
+        }
+        return filename.substr(dot);
+    }
+    
+    std::string_view parentOf(std::string_view relPath) {
+        size_t slash = relPath.find_last_of('/');
+        return slash == std::string_view::npos ? std::string_view{} : relPath.substr(0, slash);
+    }
+}
+
+namespace naw::desktop_pet::service::tools {
+
+// ========== WhitelistDirectoryTrie ==========
+
+WhitelistDirectoryTrie::WhitelistDirectoryTrie() {
+    clear();
+}
+
+void WhitelistDirectoryTrie::clear() {
+    m_nodes.clear();
+    m_nodes.emplace_back();
+}
+
+void WhitelistDirectoryTrie::insert(std::string_view relPath, uint8_t flag) {
+    if (relPath == ".") {
+        relPath = {};
+    }
+    
+    uint32_t current = 0;
+    size_t pos = 0;
+    while (pos < relPath.size()) {
+        // 包含目录的每个祖先都需要被扫描才能到达包含目录
+        if (flag == IncludeDir) {
+            m_nodes[current].flags |= IncludeAncestor;
         }
         
-        // 检查是否在文档文件集合中
-        if (docFiles.find(relPathStr) != docFiles.end()) {
-            return true;
+        size_t slash = relPath.find('/', pos);
+        std::string_view component = relPath.substr(pos, slash == std::string_view::npos ? std::string_view::npos : slash - pos);
+        pos = slash == std::string_view::npos ? relPath.size() : slash + 1;
+        if (component.empty() || component == ".") {
+            continue;
         }
         
-        // 检查是否在资源目录下
-        for (const auto& resourceDir : resourceDirs) {
-            if (relPathStr.find(resourceDir) == 0) {
-                return true;
-            }
+        auto it = m_nodes[current].children.find(component);
+        if (it != m_nodes[current].children.end()) {
+            current = it->second;
+        } else {
+            uint32_t next = static_cast<uint32_t>(m_nodes.size());
+            m_nodes[current].children.emplace(std::string(component), next);
+            m_nodes.emplace_back();
+            current = next;
+        }
+    }
+    m_nodes[current].flags |= flag;
+}
+
+uint8_t WhitelistDirectoryTrie::lookup(std::string_view relPath) const {
+    constexpr uint8_t inherited = ScanRoot | IncludeDir | ResourceDir | DocumentDir;
+    
+    uint32_t current = 0;
+    uint8_t result = m_nodes[0].flags & inherited;
+    size_t pos = 0;
+    while (pos < relPath.size()) {
+        size_t slash = relPath.find('/', pos);
+        std::string_view component = relPath.substr(pos, slash == std::string_view::npos ? std::string_view::npos : slash - pos);
+        pos = slash == std::string_view::npos ? relPath.size() : slash + 1;
+        if (component.empty() || component == ".") {
+            continue;
         }
         
-        return false;
-    } catch (...) {
+        auto it = m_nodes[current].children.find(component);
+        if (it == m_nodes[current].children.end()) {
+            return result;  // 更深的路径只继承已匹配祖先的标志
+        }
+        current = it->second;
+        result |= m_nodes[current].flags & inherited;
+    }
+    return result | (m_nodes[current].flags & IncludeAncestor);
+}
+
+// ========== ProjectFileWhitelist ==========
+
+std::string ProjectFileWhitelist::relativeKey(const fs::path& path, const fs::path& projectRoot) {
+    fs::path absPath = fs::absolute(path).lexically_normal();
+    fs::path absRoot = fs::absolute(projectRoot).lexically_normal();
+    if (!absRoot.has_filename() && absRoot.has_parent_path() && absRoot != absRoot.root_path()) {
+        absRoot = absRoot.parent_path();  // 去掉结尾的分隔符
+    }
+    
+    fs::path relPath = absPath.lexically_relative(absRoot);
+    if (relPath.empty() || relPath == ".") {
+        return "";
+    }
+    std::string relPathStr = pathToUtf8String(relPath);
+    std::replace(relPathStr.begin(), relPathStr.end(), '\\', '/');
+    if (relPathStr == ".." || relPathStr.rfind("../", 0) == 0) {
+        return "";
+    }
+    if (relPathStr.size() > 1 && relPathStr.back() == '/') {
+        relPathStr.pop_back();
+    }
+    return relPathStr;
+}
+
+void ProjectFileWhitelist::compile(const fs::path& projectRoot) {
+    compiledRoot = fs::absolute(projectRoot).lexically_normal();
+    buildTrie(compiledRoot, directoryTrie);
+    if (rootTrieCache) {
+        std::lock_guard<std::mutex> lock(rootTrieCache->mutex);
+        rootTrieCache->tries.clear();
+    }
+}
+
+void ProjectFileWhitelist::buildTrie(const fs::path& absRoot, WhitelistDirectoryTrie& trie) const {
+    trie.clear();
+    for (const auto& scanRoot : scanRoots) {
+        fs::path absScanRoot = fs::absolute(scanRoot).lexically_normal();
+        fs::path relPath = absScanRoot.lexically_relative(absRoot);
+        std::string relPathStr = pathToUtf8String(relPath);
+        std::replace(relPathStr.begin(), relPathStr.end(), '\\', '/');
+        // 项目外的扫描根目录不会在项目遍历中出现
+        if (relPath.empty() || relPathStr == ".." || relPathStr.rfind("../", 0) == 0) {
+            continue;
+        }
+        trie.insert(relPathStr, WhitelistDirectoryTrie::ScanRoot);
+    }
+    for (const auto& includeDir : includeDirs) {
+        trie.insert(includeDir, WhitelistDirectoryTrie::IncludeDir);
+    }
+    for (const auto& resourceDir : resourceDirs) {
+        trie.insert(resourceDir, WhitelistDirectoryTrie::ResourceDir);
+    }
+    for (const auto& docDir : docDirs) {
+        trie.insert(docDir, WhitelistDirectoryTrie::DocumentDir);
+    }
+}
+
+std::shared_ptr<const WhitelistDirectoryTrie> ProjectFileWhitelist::trieForRoot(const fs::path& absRoot) const {
+    const std::string key = absRoot.string();
+    if (rootTrieCache) {
+        std::lock_guard<std::mutex> lock(rootTrieCache->mutex);
+        auto it = rootTrieCache->tries.find(key);
+        if (it != rootTrieCache->tries.end()) {
+            return it->second;
+        }
+    }
+    
+    // 锁外编译；并发未命中时各自编译，结果相同
+    auto trie = std::make_shared<WhitelistDirectoryTrie>();
+    buildTrie(absRoot, *trie);
+    if (rootTrieCache) {
+        std::lock_guard<std::mutex> lock(rootTrieCache->mutex);
+        if (rootTrieCache->tries.size() >= RootTrieCache::MAX_ROOTS) {
+            rootTrieCache->tries.clear();
+        }
+        rootTrieCache->tries.emplace(key, trie);
+    }
+    return trie;
+}
+
+FileDecision ProjectFileWhitelist::classifyFile(const std::string& relPath) const {
+    return classifyWithTrie(relPath, directoryTrie);
+}
+
+FileDecision ProjectFileWhitelist::classifyWithTrie(const std::string& relPath, const WhitelistDirectoryTrie& trie) const {
+    FileDecision decision;
+    if (relPath.empty()) {
+        return decision;
+    }
+    
+    decision.extensionFlags = extensionFlags(extensionOf(relPath));
+    uint8_t dirFlags = trie.lookup(parentOf(relPath));
+    const uint8_t ext = decision.extensionFlags;
+    
+    decision.isConfig = configFiles.find(relPath) != configFiles.end();
+    bool listedDoc = docFiles.find(relPath) != docFiles.end() ||
+                     ((dirFlags & WhitelistDirectoryTrie::DocumentDir) && (ext & ExtensionFlags::Document));
+    decision.isDocument = listedDoc || (ext & ExtensionFlags::Document);
+    decision.isResource = (ext & ExtensionFlags::Resource) || (dirFlags & WhitelistDirectoryTrie::ResourceDir);
+    
+    decision.whitelisted =
+        sourceFiles.find(relPath) != sourceFiles.end() ||
+        decision.isConfig ||
+        ((dirFlags & WhitelistDirectoryTrie::IncludeDir) && (ext & (ExtensionFlags::Source | ExtensionFlags::Header))) ||
+        ((dirFlags & WhitelistDirectoryTrie::ScanRoot) && ext != ExtensionFlags::None) ||
+        listedDoc ||
+        (dirFlags & WhitelistDirectoryTrie::ResourceDir);
+    return decision;
+}
+
+bool ProjectFileWhitelist::shouldScanRelativeDirectory(
+    const std::string& relPath,
+    const fs::path& dirPath,
+    const fs::path& projectRoot) const {
+    return shouldScanWithTrie(relPath, dirPath, projectRoot, directoryTrie);
+}
+
+bool ProjectFileWhitelist::shouldScanWithTrie(
+    const std::string& relPath,
+    const fs::path& dirPath,
+    const fs::path& projectRoot,
+    const WhitelistDirectoryTrie& trie) const {
+    
+    // 检查是否被gitignore忽略
+    if (gitIgnoreParser && gitIgnoreParser->isIgnored(dirPath, projectRoot)) {
         return false;
     }
+    
+    constexpr uint8_t scanFlags = WhitelistDirectoryTrie::ScanRoot |
+                                  WhitelistDirectoryTrie::IncludeDir |
+                                  WhitelistDirectoryTrie::IncludeAncestor;
+    return (trie.lookup(relPath) & scanFlags) != 0;
 }
 
-bool ProjectFileWhitelist::shouldScanDirectory(const fs::path& dirPath, const fs::path& projectRoot) const {
+bool ProjectFileWhitelist::isWhitelisted(const fs::path& filePath, const fs::path& projectRoot) const {
     try {
-        // 检查是否被gitignore忽略
-        if (gitIgnoreParser && gitIgnoreParser->isIgnored(dirPath, projectRoot)) {
+        std::string relPathStr = relativeKey(filePath, projectRoot);
+        if (relPathStr.empty()) {
             return false;
         }
         
-        // 检查是否在任何扫描根目录下
-        fs::path absDirPath = fs::absolute(dirPath);
-        for (const auto& scanRoot : scanRoots) {
-            try {
-                if (absDirPath.string().find(scanRoot.string()) == 0) {
-                    return true;
-                }
-            } catch (...) {
-                // 忽略错误
-            }
+        // 未编译或根目录不同时使用按根目录缓存的前缀树（常规路径由 buildProjectWhitelist 预先编译）
+        fs::path absRoot = fs::absolute(projectRoot).lexically_normal();
+        if (compiledRoot != absRoot) {
+            return classifyWithTrie(relPathStr, *trieForRoot(absRoot)).whitelisted;
         }
-        
-        // 检查是否在包含目录下
-        fs::path relPath = fs::relative(dirPath, projectRoot);
-        if (!relPath.empty() && relPath != ".") {
-            std::string relPathStr = pathToUtf8String(relPath);
-            std::replace(relPathStr.begin(), relPathStr.end(), '\\', '/');
-            
-            for (const auto& includeDir : includeDirs) {
-                if (relPathStr.find(includeDir) == 0 || includeDir.find(relPathStr) == 0) {
-                    return true;
-                }
-            }
-        }
-        
+        return classifyFile(relPathStr).whitelisted;
+    } catch (...) {
         return false;
+    }
+}
+
+bool ProjectFileWhitelist::shouldScanDirectory(const fs::path& dirPath, const fs::path& projectRoot) const {
+    try {
+        std::string relPathStr = relativeKey(dirPath, projectRoot);
+        fs::path absRoot = fs::absolute(projectRoot).lexically_normal();
+        if (compiledRoot != absRoot) {
+            return shouldScanWithTrie(relPathStr, dirPath, projectRoot, *trieForRoot(absRoot));
+        }
+        return shouldScanRelativeDirectory(relPathStr, dirPath, projectRoot);
     } catch (...) {
         return false;
     }
 }
 
+uint8_t ProjectFileWhitelist::extensionFlags(std::string_view ext) {
+    return extensionTable().lookup(ext);
+}
+
 bool ProjectFileWhitelist::isSourceFileExtension(const std::string& ext) {
-    static const std::vector<std::string> sourceExts = {
-        ".cpp", ".cc", ".cxx", ".c", ".c++",
-        ".java", ".py", ".js", ".ts", ".go", ".rs"
-    };
-    
-        std::string lowerExt = ext;
-        std::transform(lowerExt.begin(), lowerExt.end(), lowerExt.begin(), 
-                      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    
-    return std::find(sourceExts.begin(), sourceExts.end(), lowerExt) != sourceExts.end();
+    return (extensionFlags(ext) & ExtensionFlags::Source) != 0;
 }
 
 bool ProjectFileWhitelist::isHeaderFileExtension(const std::string& ext) {
-    static const std::vector<std::string> headerExts = {
-        ".h", ".hpp", ".hxx", ".h++", ".hh"
-    };
-    
-        std::string lowerExt = ext;
-        std::transform(lowerExt.begin(), lowerExt.end(), lowerExt.begin(), 
-                      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    
-    return std::find(headerExts.begin(), headerExts.end(), lowerExt) != headerExts.end();
+    return (extensionFlags(ext) & ExtensionFlags::Header) != 0;
 }
 
 bool ProjectFileWhitelist::isDocumentFileExtension(const std::string& ext) {
-    static const std::vector<std::string> docExts = {
-        ".md", ".txt", ".rst", ".adoc", ".org",
-        ".pdf", ".doc", ".docx", ".html", ".htm"
-    };
-    
-        std::string lowerExt = ext;
-        std::transform(lowerExt.begin(), lowerExt.end(), lowerExt.begin(), 
-                      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    
-    return std::find(docExts.begin(), docExts.end(), lowerExt) != docExts.end();
+    return (extensionFlags(ext) & ExtensionFlags::Document) != 0;
 }
 
 bool ProjectFileWhitelist::isResourceFileExtension(const std::string& ext) {
-    static const std::vector<std::string> resourceExts = {
-        ".png", ".jpg", ".jpeg", ".gif", ".svg", ".ico", ".bmp",
-        ".json", ".xml", ".yaml", ".yml", ".toml", ".ini", ".conf",
-        ".sh", ".bat", ".ps1", ".py", ".js", ".css"
-    };
-    
-        std::string lowerExt = ext;
-        std::transform(lowerExt.begin(), lowerExt.end(), lowerExt.begin(), 
-                      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    
-    return std::find(resourceExts.begin(), resourceExts.end(), lowerExt) != resourceExts.end();
+    return (extensionFlags(ext) & ExtensionFlags::Resource) != 0;
 }
 
 ProjectFileWhitelist buildProjectWhitelist(
@@ -219,10 +434,21 @@ ProjectFileWhitelist buildProjectWhitelist(
         if (useCMakeSources) {
             whitelist.cmakeInfo = CMakeParser::parseCMakeLists(
                 absProjectRoot / "CMakeLists.txt", absProjectRoot);
-            whitelist.cmakeHash = whitelist.cmakeInfo.configHash;
+            
+            // 项目模型包含所有子目录CMakeLists.txt中的目标，任一文件变化都会改变哈希
+            auto cmakeModel = CMakeParser::loadProjectModel(absProjectRoot);
+            whitelist.cmakeHash = cmakeModel->combinedHash.empty()
+                ? whitelist.cmakeInfo.configHash : cmakeModel->combinedHash;
+            
+            std::vector<std::string> cmakeSources = whitelist.cmakeInfo.sourceFiles;
+            std::vector<std::string> cmakeIncludeDirs = whitelist.cmakeInfo.includeDirs;
+            for (const auto& [name, target] : cmakeModel->targets) {
+                cmakeSources.insert(cmakeSources.end(), target.sources.begin(), target.sources.end());
+                cmakeIncludeDirs.insert(cmakeIncludeDirs.end(), target.includeDirs.begin(), target.includeDirs.end());
+            }
             
             // 添加CMake中定义的源文件
-            for (const auto& srcFile : whitelist.cmakeInfo.sourceFiles) {
+            for (const auto& srcFile : cmakeSources) {
                 fs::path srcPath = absProjectRoot / srcFile;
                 if (fs::exists(srcPath)) {
                     fs::path relPath = fs::relative(srcPath, absProjectRoot);
@@ -233,7 +459,7 @@ ProjectFileWhitelist buildProjectWhitelist(
             }
             
             // 添加包含目录
-            for (const auto& includeDir : whitelist.cmakeInfo.includeDirs) {
+            for (const auto& includeDir : cmakeIncludeDirs) {
                 fs::path includePath = absProjectRoot / includeDir;
                 if (fs::exists(includePath)) {
                     fs::path relPath = fs::relative(includePath, absProjectRoot);
@@ -324,27 +550,11 @@ ProjectFileWhitelist buildProjectWhitelist(
             }
         }
         
-        // 扫描文档目录中的文档文件
+        // 标记文档目录（其中的文档文件在遍历时由前缀树判定，无需预先递归扫描）
         for (const auto& docDirName : docDirs) {
             fs::path docDirPath = absProjectRoot / docDirName;
             if (fs::exists(docDirPath) && fs::is_directory(docDirPath)) {
-                try {
-                    for (const auto& entry : fs::recursive_directory_iterator(docDirPath,
-                            fs::directory_options::skip_permission_denied)) {
-                        if (entry.is_regular_file()) {
-                            std::string ext = pathToUtf8String(entry.path().extension());
-                            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-                            if (ProjectFileWhitelist::isDocumentFileExtension(ext)) {
-                                fs::path relPath = fs::relative(entry.path(), absProjectRoot);
-                                std::string relPathStr = pathToUtf8String(relPath);
-                                std::replace(relPathStr.begin(), relPathStr.end(), '\\', '/');
-                                whitelist.docFiles.insert(relPathStr);
-                            }
-                        }
-                    }
-                } catch (...) {
-                    // 忽略错误
-                }
+                whitelist.docDirs.insert(docDirName);
             }
         }
         
@@ -353,7 +563,10 @@ ProjectFileWhitelist buildProjectWhitelist(
             whitelist.scanRoots.push_back(absProjectRoot);
         }
         
-        // 6. 计算组合哈希
+        // 6. 编译目录判定前缀树
+        whitelist.compile(absProjectRoot);
+        
+        // 7. 计算组合哈希
         whitelist.combinedHash = combineHashes(whitelist.cmakeHash, whitelist.gitignoreHash);
         
     } catch (...) {
@@ -1,7 +1,9 @@
 #include "naw/desktop_pet/service/CodeTools.h"
+#include "naw/desktop_pet/service/FileContentCache.h"
 #include "naw/desktop_pet/service/tools/CodeToolsUtils.h"
 #include "naw/desktop_pet/service/ToolManager.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <nlohmann/json.hpp>
@@ -52,8 +54,15 @@ static nlohmann::json handleReadFile(const nlohmann::json& arguments) {
             endLine = arguments["end_line"].get<int>();
         }
         
+        // 读取文件（通过共享的文件内容缓存，与 ProjectContextCollector 共用同一份缓冲区）
+        auto rawContent = FileContentCache::shared()->get(filePath.string());
+        if (!rawContent) {
+            return nlohmann::json{{"error", "无法打开文件: " + sanitizeUtf8String(pathStr)}};
+        }
+        std::vector<std::string> allLines = splitFileContentLines(*rawContent);
+        
         // 验证行范围
-        int totalLines = countFileLines(filePath);
+        int totalLines = static_cast<int>(allLines.size());
         if (startLine > 0 && startLine > totalLines) {
             return nlohmann::json{{"error", "起始行号超出文件范围"}};
         }
@@ -61,12 +70,16 @@ static nlohmann::json handleReadFile(const nlohmann::json& arguments) {
             return nlohmann::json{{"error", "结束行号小于起始行号"}};
         }
         
-        // 读取文件
+        const bool fullRead = startLine <= 0 && endLine <= 0;
         std::vector<std::string> lines;
-        if (startLine > 0 || endLine > 0) {
-            lines = readFileLines(filePath, startLine, endLine);
+        if (!fullRead) {
+            size_t first = startLine > 0 ? static_cast<size_t>(startLine - 1) : 0;
+            size_t last = endLine > 0 ? std::min(static_cast<size_t>(endLine), allLines.size()) : allLines.size();
+            if (first < last) {
+                lines.assign(allLines.begin() + first, allLines.begin() + last);
+            }
         } else {
-            lines = readFileLines(filePath);
+            lines = std::move(allLines);
         }
         
         // 构建结果
@@ -77,6 +90,7 @@ static nlohmann::json handleReadFile(const nlohmann::json& arguments) {
         }
         
         nlohmann::json result;
+        // 内容始终为按行拼接的文本（不含末尾换行）；与其他缓存的共享由结果缓存对该字符串的 intern 完成
         result["content"] = content.str();
         // 使用原始路径字符串（已经是UTF-8），并清理无效UTF-8字符，确保JSON序列化成功
         result["path"] = sanitizeUtf8String(pathStr);
@@ -1,4 +1,5 @@
 #include "naw/desktop_pet/service/CodeTools.h"
+#include "naw/desktop_pet/service/FileContentCache.h"
 #include "naw/desktop_pet/service/tools/CodeToolsUtils.h"
 #include "naw/desktop_pet/service/ToolManager.h"
 
@@ -14,18 +15,73 @@ namespace fs = std::filesystem;
 using namespace naw::desktop_pet::service;
 using namespace naw::desktop_pet::service::tools;
 
+namespace {
+    /**
+     * @brief 通知代码工具缓存文件已变更（内容缓存失效、依赖图增量更新）
+     */
+    void notifyFileWritten(const fs::path& filePath) {
+        FileContentCache::shared()->notifyFileChanged(filePath.string());
+    }
+
+    /**
+     * @brief 依次应用编辑（每个编辑基于前一个编辑的结果）
+     * @param text 文件内容（输入输出）
+     * @param edits 编辑列表 [{old_text, new_text, replace_all}]
+     * @param replacements 实际替换次数（输出）
+     * @return 错误信息，成功返回空字符串
+     */
+    std::string applyEdits(std::string& text, const nlohmann::json& edits, size_t& replacements) {
+        replacements = 0;
+        for (size_t index = 0; index < edits.size(); ++index) {
+            const auto& edit = edits[index];
+            std::string label = "edits[" + std::to_string(index) + "]";
+            if (!edit.is_object() || !edit.contains("old_text") || !edit["old_text"].is_string() ||
+                !edit.contains("new_text") || !edit["new_text"].is_string()) {
+                return label + " 需要字符串字段 old_text 和 new_text";
+            }
+
+            const auto& oldText = edit["old_text"].get_ref<const std::string&>();
+            const auto& newText = edit["new_text"].get_ref<const std::string&>();
+            bool replaceAll = edit.value("replace_all", false);
+            if (oldText.empty()) {
+                return label + " 的 old_text 不能为空";
+            }
+
+            size_t first = text.find(oldText);
+            if (first == std::string::npos) {
+                return label + " 的 old_text 在文件中不存在";
+            }
+            if (!replaceAll && text.find(oldText, first + 1) != std::string::npos) {
+                return label + " 的 old_text 在文件中出现多次，请提供更多上下文或设置 replace_all";
+            }
+
+            // 单次遍历构建结果，避免多次原地替换的二次方开销
+            std::string result;
+            result.reserve(text.size() + (newText.size() > oldText.size() ? newText.size() - oldText.size() : 0));
+            size_t pos = 0;
+            size_t match = first;
+            while (match != std::string::npos) {
+                result.append(text, pos, match - pos);
+                result += newText;
+                pos = match + oldText.size();
+                ++replacements;
+                match = replaceAll ? text.find(oldText, pos) : std::string::npos;
+            }
+            result.append(text, pos, std::string::npos);
+            text = std::move(result);
+        }
+        return "";
+    }
+}
+
 static nlohmann::json handleWriteFile(const nlohmann::json& arguments) {
     try {
         // 提取参数
         if (!arguments.contains("path") || !arguments["path"].is_string()) {
             return nlohmann::json{{"error", "缺少必需参数: path"}};
         }
-        if (!arguments.contains("content") || !arguments["content"].is_string()) {
-            return nlohmann::json{{"error", "缺少必需参数: content"}};
-        }
         
         std::string pathStr = arguments["path"].get<std::string>();
-        std::string content = arguments["content"].get<std::string>();
         // 从 UTF-8 字符串构造路径（Windows 上正确处理编码）
         fs::path filePath = pathFromUtf8String(pathStr);
         
@@ -40,6 +96,47 @@ static nlohmann::json handleWriteFile(const nlohmann::json& arguments) {
             createDirs = arguments["create_directories"].get<bool>();
         }
         
+        // 补丁模式：只传编辑内容，不需要完整文件
+        if (mode == "patch") {
+            if (!arguments.contains("edits") || !arguments["edits"].is_array() || arguments["edits"].empty()) {
+                return nlohmann::json{{"error", "patch 模式需要非空的 edits 数组"}};
+            }
+            
+            auto original = FileContentCache::shared()->get(filePath.string());
+            if (!original) {
+                return nlohmann::json{{"error", "文件不存在，无法应用补丁: " + sanitizeUtf8String(pathStr)}};
+            }
+            
+            std::string text = *original;
+            size_t replacements = 0;
+            std::string editError = applyEdits(text, arguments["edits"], replacements);
+            if (!editError.empty()) {
+                return nlohmann::json{{"error", sanitizeUtf8String(editError)}};
+            }
+            
+            std::string writeError;
+            if (!writeFileAtomically(filePath, text, writeError)) {
+                return nlohmann::json{{"error", sanitizeUtf8String(writeError)}};
+            }
+            notifyFileWritten(filePath);
+            
+            nlohmann::json result;
+            result["success"] = true;
+            result["path"] = sanitizeUtf8String(pathStr);
+            result["bytes_written"] = text.size();
+            result["mode"] = "patch";
+            result["edits_applied"] = arguments["edits"].size();
+            result["replacements"] = replacements;
+            result["message"] = "补丁应用成功";
+            return result;
+        }
+        
+        if (!arguments.contains("content") || !arguments["content"].is_string()) {
+            return nlohmann::json{{"error", "缺少必需参数: content"}};
+        }
+        // 直接引用参数中的字符串，避免复制大文件内容
+        const std::string& content = arguments["content"].get_ref<const std::string&>();
+        
         int startLine = 0;
         int endLine = -1;
         if (arguments.contains("start_line") && arguments["start_line"].is_number_integer()) {
@@ -96,60 +193,59 @@ static nlohmann::json handleWriteFile(const nlohmann::json& arguments) {
                 }
             }
             
-            // 写入文件（使用UTF-8模式）
-            std::ofstream file(filePath, std::ios::out | std::ios::trunc | std::ios::binary);
-            if (!file.is_open()) {
-                return nlohmann::json{{"error", "无法打开文件进行写入: " + sanitizeUtf8String(pathStr)}};
-            }
-            
-            size_t bytesWritten = 0;
+            std::string newText;
             for (size_t i = 0; i < newLines.size(); ++i) {
                 if (i > 0) {
-                    file << "\n";
-                    bytesWritten += 1;
+                    newText += "\n";
                 }
-                file << newLines[i];
-                bytesWritten += newLines[i].size();
+                newText += newLines[i];
             }
-            file.close();
+            
+            // 原子写入（写临时文件后重命名）
+            std::string writeError;
+            if (!writeFileAtomically(filePath, newText, writeError)) {
+                return nlohmann::json{{"error", sanitizeUtf8String(writeError)}};
+            }
+            notifyFileWritten(filePath);
             
             nlohmann::json result;
             result["success"] = true;
             result["path"] = sanitizeUtf8String(pathStr);  // 使用原始路径字符串（已经是UTF-8）
-            result["bytes_written"] = bytesWritten;
+            result["bytes_written"] = newText.size();
             result["mode"] = "line_replace";
             result["message"] = "成功替换行范围 " + std::to_string(startLine) + "-" + std::to_string(endLine);
             return result;
         }
         
-        // 普通写入模式（使用二进制模式确保UTF-8内容正确写入）
-        std::ios_base::openmode openMode = std::ios::out | std::ios::binary;
         if (mode == "append") {
-            openMode |= std::ios::app;
-        } else if (mode == "create_only") {
-            if (fs::exists(filePath)) {
-                return nlohmann::json{{"error", "文件已存在，无法使用 create_only 模式: " + sanitizeUtf8String(pathStr)}};
+            // 追加只在文件末尾增加内容，读取方最多看到旧内容加部分新内容，不会看到被截断的文件
+            std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::app);
+            if (!file.is_open()) {
+                return nlohmann::json{{"error", "无法打开文件进行写入: " + sanitizeUtf8String(pathStr)}};
+            }
+            file.write(content.data(), static_cast<std::streamsize>(content.size()));
+            file.close();
+            if (file.fail()) {
+                return nlohmann::json{{"error", "写入文件失败: " + sanitizeUtf8String(pathStr)}};
             }
-            openMode |= std::ios::trunc;
         } else {
-            // overwrite
-            openMode |= std::ios::trunc;
-        }
-        
-        std::ofstream file(filePath, openMode);
-        if (!file.is_open()) {
-            return nlohmann::json{{"error", "无法打开文件进行写入: " + sanitizeUtf8String(pathStr)}};
+            if (mode == "create_only" && fs::exists(filePath)) {
+                return nlohmann::json{{"error", "文件已存在，无法使用 create_only 模式: " + sanitizeUtf8String(pathStr)}};
+            }
+            
+            // overwrite / create_only：原子写入（二进制原样写入UTF-8内容）
+            // create_only 的存在性检查在发布时原子完成，上面的检查只用于提前给出友好提示
+            std::string writeError;
+            if (!writeFileAtomically(filePath, content, writeError, mode == "create_only")) {
+                return nlohmann::json{{"error", sanitizeUtf8String(writeError)}};
+            }
         }
-        
-        // 直接写入UTF-8内容（二进制模式）
-        file.write(content.data(), content.size());
-        size_t bytesWritten = content.size();
-        file.close();
+        notifyFileWritten(filePath);
         
         nlohmann::json result;
         result["success"] = true;
         result["path"] = sanitizeUtf8String(pathStr);  // 使用原始路径字符串（已经是UTF-8）
-        result["bytes_written"] = bytesWritten;
+        result["bytes_written"] = content.size();
         result["mode"] = mode;
         result["message"] = "文件写入成功";
         return result;
@@ -166,7 +262,9 @@ static nlohmann::json handleWriteFile(const nlohmann::json& arguments) {
 void CodeTools::registerWriteFileTool(ToolManager& toolManager) {
     ToolDefinition tool;
     tool.name = "write_file";
-    tool.description = "写入文本文件。支持覆盖、追加、仅创建等模式，以及行范围替换。";
+    tool.description = "写入文本文件。支持覆盖、追加、仅创建等模式，以及行范围替换。"
+                       "覆盖写入是原子的（写临时文件后替换）。修改大文件时优先使用 patch 模式，"
+                       "只传 edits（old_text 必须在文件中唯一出现，除非设置 replace_all），无需发送完整文件内容。";
     tool.parametersSchema = nlohmann::json{
         {"type", "object"},
         {"properties", {
@@ -176,11 +274,11 @@ void CodeTools::registerWriteFileTool(ToolManager& toolManager) {
             }},
             {"content", {
                 {"type", "string"},
-                {"description", "要写入的内容"}
+                {"description", "要写入的内容（patch 模式下不需要）"}
             }},
             {"mode", {
                 {"type", "string"},
-                {"enum", {"overwrite", "append", "create_only"}},
+                {"enum", {"overwrite", "append", "create_only", "patch"}},
                 {"default", "overwrite"},
                 {"description", "写入模式"}
             }},
@@ -198,9 +296,22 @@ void CodeTools::registerWriteFileTool(ToolManager& toolManager) {
                 {"type", "boolean"},
                 {"default", false},
                 {"description", "是否自动创建目录"}
+            }},
+            {"edits", {
+                {"type", "array"},
+                {"description", "patch 模式的编辑列表，按顺序应用"},
+                {"items", {
+                    {"type", "object"},
+                    {"properties", {
+                        {"old_text", {{"type", "string"}, {"description", "要替换的原文（需精确匹配）"}}},
+                        {"new_text", {{"type", "string"}, {"description", "替换后的内容"}}},
+                        {"replace_all", {{"type", "boolean"}, {"default", false}, {"description", "是否替换所有出现位置"}}}
+                    }},
+                    {"required", {"old_text", "new_text"}}
+                }}
             }}
         }},
-        {"required", {"path", "content"}}
+        {"required", {"path"}}
     };
     tool.handler = handleWriteFile;
     tool.permissionLevel = PermissionLevel::Public;
@@ -0,0 +1,535 @@
+#include "naw/desktop_pet/service/utils/AudioKernels.h"
+
+#include "naw/desktop_pet/service/utils/AudioProcessor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NAW_AUDIO_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NAW_TARGET_AVX2
+#else
+#define NAW_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace naw::desktop_pet::service::utils {
+
+namespace {
+
+constexpr float kS16Scale = 1.0f / 32768.0f;
+// 平方和等累加量在单精度下按块累加的样本数，块间合并到双精度
+constexpr std::size_t kFloatBlock = 1024;
+
+/**
+ * S16 归一化值 |v|/32768 >= t 等价于 |v| >= ceil(t*32768)（乘以2的幂是精确的），
+ * 因此阈值比较可在整数域完成。返回 0 表示所有样本都满足，32769 表示没有样本满足。
+ */
+std::int32_t s16Threshold(float t) {
+    if (std::isnan(t)) {
+        return 32769;
+    }
+    if (!(t > 0.0f)) {
+        return 0;
+    }
+    const float scaled = t * 32768.0f;
+    if (scaled > 32768.0f) {
+        return 32769;
+    }
+    return static_cast<std::int32_t>(std::ceil(scaled));
+}
+
+inline std::int16_t floatToS16(float v) {
+    const float clamped = std::min(32767.0f, std::max(-32768.0f, v));
+    return static_cast<std::int16_t>(std::lrint(clamped));
+}
+
+// ========== 标量实现 ==========
+
+void measureS16Scalar(const void* pcm, std::size_t samples, float clipThreshold, PcmLevel& level) {
+    const auto* p = static_cast<const std::int16_t*>(pcm);
+    const std::int32_t clip = s16Threshold(clipThreshold);
+    std::int32_t peak = 0;
+    std::uint64_t sum = 0;
+    std::size_t clipped = 0;
+    for (std::size_t i = 0; i < samples; ++i) {
+        const std::int32_t v = p[i];
+        const std::int32_t a = v < 0 ? -v : v;
+        peak = std::max(peak, a);
+        sum += static_cast<std::uint64_t>(v * v);
+        clipped += a >= clip ? 1 : 0;
+    }
+    level.peak = std::max(level.peak, static_cast<float>(peak) * kS16Scale);
+    // 平方和在整数域精确累加，最后一次缩放到归一化值
+    level.sumSquares += static_cast<double>(sum) * (1.0 / (32768.0 * 32768.0));
+    level.clipped += clipped;
+}
+
+void measureF32Scalar(const void* pcm, std::size_t samples, float clipThreshold, PcmLevel& level) {
+    const auto* p = static_cast<const float*>(pcm);
+    float peak = level.peak;
+    double sum = 0.0;
+    std::size_t clipped = 0;
+    for (std::size_t i = 0; i < samples; ++i) {
+        const float v = p[i];
+        const float a = std::fabs(v);
+        peak = std::max(peak, a);
+        sum += static_cast<double>(v) * static_cast<double>(v);
+        clipped += a >= clipThreshold ? 1 : 0;
+    }
+    level.peak = peak;
+    level.sumSquares += sum;
+    level.clipped += clipped;
+}
+
+void toFloatS16Scalar(const void* pcm, std::size_t count, std::uint32_t stride, float* out) {
+    const auto* p = static_cast<const std::int16_t*>(pcm);
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<float>(p[i * stride]) * kS16Scale;
+    }
+}
+
+void toFloatF32Scalar(const void* pcm, std::size_t count, std::uint32_t stride, float* out) {
+    const auto* p = static_cast<const float*>(pcm);
+    if (stride == 1) {
+        std::memcpy(out, p, count * sizeof(float));
+        return;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = p[i * stride];
+    }
+}
+
+void fromFloatS16Scalar(const float* in, std::size_t samples, void* out) {
+    auto* p = static_cast<std::int16_t*>(out);
+    for (std::size_t i = 0; i < samples; ++i) {
+        p[i] = floatToS16(in[i] * 32768.0f);
+    }
+}
+
+void fromFloatF32(const float* in, std::size_t samples, void* out) {
+    std::memcpy(out, in, samples * sizeof(float));
+}
+
+void applyGainS16Scalar(void* pcm, std::size_t samples, float gain) {
+    auto* p = static_cast<std::int16_t*>(pcm);
+    for (std::size_t i = 0; i < samples; ++i) {
+        p[i] = floatToS16(static_cast<float>(p[i]) * gain);
+    }
+}
+
+void applyGainF32Scalar(void* pcm, std::size_t samples, float gain) {
+    auto* p = static_cast<float*>(pcm);
+    for (std::size_t i = 0; i < samples; ++i) {
+        const float v = p[i] * gain;
+        p[i] = std::isfinite(v) ? v : 0.0f;
+    }
+}
+
+std::size_t firstAboveS16Scalar(const void* pcm, std::size_t samples, float threshold) {
+    const auto* p = static_cast<const std::int16_t*>(pcm);
+    const std::int32_t thr = s16Threshold(threshold);
+    for (std::size_t i = 0; i < samples; ++i) {
+        const std::int32_t v = p[i];
+        if ((v < 0 ? -v : v) >= thr) {
+            return i;
+        }
+    }
+    return samples;
+}
+
+std::size_t lastAboveS16Scalar(const void* pcm, std::size_t samples, float threshold) {
+    const auto* p = static_cast<const std::int16_t*>(pcm);
+    const std::int32_t thr = s16Threshold(threshold);
+    for (std::size_t i = samples; i-- > 0;) {
+        const std::int32_t v = p[i];
+        if ((v < 0 ? -v : v) >= thr) {
+            return i;
+        }
+    }
+    return samples;
+}
+
+std::size_t firstAboveF32Scalar(const void* pcm, std::size_t samples, float threshold) {
+    const auto* p = static_cast<const float*>(pcm);
+    for (std::size_t i = 0; i < samples; ++i) {
+        if (std::fabs(p[i]) >= threshold) {
+            return i;
+        }
+    }
+    return samples;
+}
+
+std::size_t lastAboveF32Scalar(const void* pcm, std::size_t samples, float threshold) {
+    const auto* p = static_cast<const float*>(pcm);
+    for (std::size_t i = samples; i-- > 0;) {
+        if (std::fabs(p[i]) >= threshold) {
+            return i;
+        }
+    }
+    return samples;
+}
+
+#if defined(NAW_AUDIO_X86)
+
+// ========== AVX2 实现 ==========
+
+NAW_TARGET_AVX2 inline float hmaxPs(__m256 v) {
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+}
+
+NAW_TARGET_AVX2 inline double hsumPs(__m256 v) {
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, v);
+    double sum = 0.0;
+    for (float lane : lanes) {
+        sum += lane;
+    }
+    return sum;
+}
+
+// 8 个 int16 -> 8 个归一化 float
+NAW_TARGET_AVX2 inline __m256 loadS16AsFloat(const std::int16_t* p) {
+    const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(kS16Scale));
+}
+
+// 两组 8 个 float（已缩放到 S16 范围）-> 16 个 int16（饱和、就近取整）
+NAW_TARGET_AVX2 inline __m256i packFloatToS16(__m256 lo, __m256 hi) {
+    const __m256 minV = _mm256_set1_ps(-32768.0f);
+    const __m256 maxV = _mm256_set1_ps(32767.0f);
+    // max_ps 在任一操作数为 NaN 时返回第二个操作数，与标量 std::max(-32768, NaN) 的结果一致
+    lo = _mm256_min_ps(_mm256_max_ps(lo, minV), maxV);
+    hi = _mm256_min_ps(_mm256_max_ps(hi, minV), maxV);
+    const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(lo), _mm256_cvtps_epi32(hi));
+    // packs 按 128 位通道交错，重排为顺序输出
+    return _mm256_permute4x64_epi64(packed, 0xD8);
+}
+
+NAW_TARGET_AVX2 void measureS16AVX2(const void* pcm, std::size_t samples, float clipThreshold, PcmLevel& level) {
+    const auto* p = static_cast<const std::int16_t*>(pcm);
+    const std::int32_t clip = s16Threshold(clipThreshold);
+    // clip 为 32769 时没有样本满足；为 0 时所有样本满足（|v| 按无符号比较）
+    const __m256i clipV = _mm256_set1_epi16(static_cast<std::int16_t>(static_cast<std::uint16_t>(std::min(clip, 32768))));
+    const bool clipNone = clip > 32768;
+    __m256i peakV = _mm256_setzero_si256();
+    __m256i sumLo = _mm256_setzero_si256();
+    __m256i sumHi = _mm256_setzero_si256();
+    const __m256i zero = _mm256_setzero_si256();
+    std::size_t clipped = 0;
+    std::size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        // abs(-32768) 的结果 0x8000 按无符号解释正好是 32768
+        const __m256i a = _mm256_abs_epi16(v);
+        peakV = _mm256_max_epu16(peakV, a);
+        // 相邻两个平方之和最大为 2^31，按无符号 32 位解释不会溢出，再零扩展到 64 位累加
+        const __m256i sq = _mm256_madd_epi16(v, v);
+        sumLo = _mm256_add_epi64(sumLo, _mm256_unpacklo_epi32(sq, zero));
+        sumHi = _mm256_add_epi64(sumHi, _mm256_unpackhi_epi32(sq, zero));
+        if (!clipNone) {
+            const __m256i ge = _mm256_cmpeq_epi16(_mm256_max_epu16(a, clipV), a);
+            clipped += static_cast<std::size_t>(std::popcount(static_cast<std::uint32_t>(_mm256_movemask_epi8(ge)))) / 2;
+        }
+    }
+    alignas(32) std::uint16_t peaks[16];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(peaks), peakV);
+    std::int32_t peak = 0;
+    for (std::uint16_t v : peaks) {
+        peak = std::max<std::int32_t>(peak, v);
+    }
+    alignas(32) std::uint64_t sums[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums), _mm256_add_epi64(sumLo, sumHi));
+    std::uint64_t sum = sums[0] + sums[1] + sums[2] + sums[3];
+    for (; i < samples; ++i) {
+        const std::int32_t v = p[i];
+        const std::int32_t a = v < 0 ? -v : v;
+        peak = std::max(peak, a);
+        sum += static_cast<std::uint64_t>(v * v);
+        clipped += a >= clip ? 1 : 0;
+    }
+    level.peak = std::max(level.peak, static_cast<float>(peak) * kS16Scale);
+    level.sumSquares += static_cast<double>(sum) * (1.0 / (32768.0 * 32768.0));
+    level.clipped += clipped;
+}
+
+NAW_TARGET_AVX2 void measureF32AVX2(const void* pcm, std::size_t samples, float clipThreshold, PcmLevel& level) {
+    const auto* p = static_cast<const float*>(pcm);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 clipV = _mm256_set1_ps(clipThreshold);
+    __m256 peakV = _mm256_set1_ps(level.peak);
+    double sum = 0.0;
+    std::size_t clipped = 0;
+    std::size_t i = 0;
+    while (i + 16 <= samples) {
+        const std::size_t blockEnd = std::min(samples, i + kFloatBlock) & ~static_cast<std::size_t>(15);
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        for (; i < blockEnd; i += 16) {
+            const __m256 v0 = _mm256_loadu_ps(p + i);
+            const __m256 v1 = _mm256_loadu_ps(p + i + 8);
+            const __m256 a0 = _mm256_and_ps(v0, absMask);
+            const __m256 a1 = _mm256_and_ps(v1, absMask);
+            // NaN 时 max_ps 返回第二个操作数（当前峰值），与标量 std::max(peak, NaN) 一致
+            peakV = _mm256_max_ps(a0, peakV);
+            peakV = _mm256_max_ps(a1, peakV);
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(v0, v0));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(v1, v1));
+            const int m0 = _mm256_movemask_ps(_mm256_cmp_ps(a0, clipV, _CMP_GE_OQ));
+            const int m1 = _mm256_movemask_ps(_mm256_cmp_ps(a1, clipV, _CMP_GE_OQ));
+            clipped += static_cast<std::size_t>(std::popcount(static_cast<std::uint32_t>(m0)) +
+                                                std::popcount(static_cast<std::uint32_t>(m1)));
+        }
+        sum += hsumPs(_mm256_add_ps(acc0, acc1));
+    }
+    float peak = hmaxPs(peakV);
+    for (; i < samples; ++i) {
+        const float v = p[i];
+        const float a = std::fabs(v);
+        peak = std::max(peak, a);
+        sum += static_cast<double>(v) * static_cast<double>(v);
+        clipped += a >= clipThreshold ? 1 : 0;
+    }
+    level.peak = peak;
+    level.sumSquares += sum;
+    level.clipped += clipped;
+}
+
+NAW_TARGET_AVX2 void toFloatS16AVX2(const void* pcm, std::size_t count, std::uint32_t stride, float* out) {
+    if (stride != 1) {
+        toFloatS16Scalar(pcm, count, stride, out);
+        return;
+    }
+    const auto* p = static_cast<const std::int16_t*>(pcm);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, loadS16AsFloat(p + i));
+    }
+    for (; i < count; ++i) {
+        out[i] = static_cast<float>(p[i]) * kS16Scale;
+    }
+}
+
+NAW_TARGET_AVX2 void fromFloatS16AVX2(const float* in, std::size_t samples, void* out) {
+    auto* p = static_cast<std::int16_t*>(out);
+    const __m256 scale = _mm256_set1_ps(32768.0f);
+    std::size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        const __m256 lo = _mm256_mul_ps(_mm256_loadu_ps(in + i), scale);
+        const __m256 hi = _mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), packFloatToS16(lo, hi));
+    }
+    for (; i < samples; ++i) {
+        p[i] = floatToS16(in[i] * 32768.0f);
+    }
+}
+
+NAW_TARGET_AVX2 void applyGainS16AVX2(void* pcm, std::size_t samples, float gain) {
+    auto* p = static_cast<std::int16_t*>(pcm);
+    const __m256 g = _mm256_set1_ps(gain);
+    std::size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        const __m128i* src = reinterpret_cast<const __m128i*>(p + i);
+        const __m256 lo = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(src))), g);
+        const __m256 hi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(src + 1))), g);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), packFloatToS16(lo, hi));
+    }
+    for (; i < samples; ++i) {
+        p[i] = floatToS16(static_cast<float>(p[i]) * gain);
+    }
+}
+
+NAW_TARGET_AVX2 void applyGainF32AVX2(void* pcm, std::size_t samples, float gain) {
+    auto* p = static_cast<float*>(pcm);
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 zero = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(p + i), g);
+        // 有限值 v - v == 0；Inf/NaN 得到 NaN，比较结果为假，对应样本置0
+        const __m256 finite = _mm256_cmp_ps(_mm256_sub_ps(v, v), zero, _CMP_EQ_OQ);
+        _mm256_storeu_ps(p + i, _mm256_and_ps(v, finite));
+    }
+    for (; i < samples; ++i) {
+        const float v = p[i] * gain;
+        p[i] = std::isfinite(v) ? v : 0.0f;
+    }
+}
+
+// 16 个 S16 样本中 |v| >= thr 的位掩码（每个样本2位）
+NAW_TARGET_AVX2 inline std::uint32_t aboveMaskS16(const std::int16_t* p, __m256i thr) {
+    const __m256i a = _mm256_abs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_max_epu16(a, thr), a)));
+}
+
+NAW_TARGET_AVX2 std::size_t firstAboveS16AVX2(const void* pcm, std::size_t samples, float threshold) {
+    const std::int32_t thr = s16Threshold(threshold);
+    if (thr > 32768 || thr == 0) {
+        return thr == 0 || samples == 0 ? 0 : samples;
+    }
+    const auto* p = static_cast<const std::int16_t*>(pcm);
+    const __m256i thrV = _mm256_set1_epi16(static_cast<std::int16_t>(static_cast<std::uint16_t>(thr)));
+    std::size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        const std::uint32_t mask = aboveMaskS16(p + i, thrV);
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask)) / 2;
+        }
+    }
+    return i + firstAboveS16Scalar(p + i, samples - i, threshold);
+}
+
+NAW_TARGET_AVX2 std::size_t lastAboveS16AVX2(const void* pcm, std::size_t samples, float threshold) {
+    const std::int32_t thr = s16Threshold(threshold);
+    if (thr > 32768 || thr == 0) {
+        return thr == 0 && samples > 0 ? samples - 1 : samples;
+    }
+    const auto* p = static_cast<const std::int16_t*>(pcm);
+    const __m256i thrV = _mm256_set1_epi16(static_cast<std::int16_t>(static_cast<std::uint16_t>(thr)));
+    // 先用标量处理不足16个的尾部，再从后向前整块扫描
+    std::size_t end = samples & ~static_cast<std::size_t>(15);
+    for (std::size_t i = samples; i-- > end;) {
+        const std::int32_t v = p[i];
+        if ((v < 0 ? -v : v) >= thr) {
+            return i;
+        }
+    }
+    while (end >= 16) {
+        end -= 16;
+        const std::uint32_t mask = aboveMaskS16(p + end, thrV);
+        if (mask != 0) {
+            return end + static_cast<std::size_t>(31 - std::countl_zero(mask)) / 2;
+        }
+    }
+    return samples;
+}
+
+NAW_TARGET_AVX2 std::size_t firstAboveF32AVX2(const void* pcm, std::size_t samples, float threshold) {
+    const auto* p = static_cast<const float*>(pcm);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 thr = _mm256_set1_ps(threshold);
+    std::size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m256 a = _mm256_and_ps(_mm256_loadu_ps(p + i), absMask);
+        const int mask = _mm256_movemask_ps(_mm256_cmp_ps(a, thr, _CMP_GE_OQ));
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(static_cast<std::uint32_t>(mask)));
+        }
+    }
+    return i + firstAboveF32Scalar(p + i, samples - i, threshold);
+}
+
+NAW_TARGET_AVX2 std::size_t lastAboveF32AVX2(const void* pcm, std::size_t samples, float threshold) {
+    const auto* p = static_cast<const float*>(pcm);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 thr = _mm256_set1_ps(threshold);
+    std::size_t end = samples & ~static_cast<std::size_t>(7);
+    for (std::size_t i = samples; i-- > end;) {
+        if (std::fabs(p[i]) >= threshold) {
+            return i;
+        }
+    }
+    while (end >= 8) {
+        end -= 8;
+        const __m256 a = _mm256_and_ps(_mm256_loadu_ps(p + end), absMask);
+        const int mask = _mm256_movemask_ps(_mm256_cmp_ps(a, thr, _CMP_GE_OQ));
+        if (mask != 0) {
+            return end + static_cast<std::size_t>(31 - std::countl_zero(static_cast<std::uint32_t>(mask)));
+        }
+    }
+    return samples;
+}
+
+bool cpuSupportsAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // NAW_AUDIO_X86
+
+bool isSupported(AudioKernels::SimdLevel level) {
+    switch (level) {
+        case AudioKernels::SimdLevel::Scalar:
+            return true;
+        case AudioKernels::SimdLevel::AVX2:
+#if defined(NAW_AUDIO_X86)
+            return cpuSupportsAVX2();
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+std::atomic<int> g_audioSimdLevel{-1};
+
+constexpr AudioKernels::PcmKernels kScalarS16{measureS16Scalar, toFloatS16Scalar, fromFloatS16Scalar,
+                                              applyGainS16Scalar, firstAboveS16Scalar, lastAboveS16Scalar};
+constexpr AudioKernels::PcmKernels kScalarF32{measureF32Scalar, toFloatF32Scalar, fromFloatF32,
+                                              applyGainF32Scalar, firstAboveF32Scalar, lastAboveF32Scalar};
+#if defined(NAW_AUDIO_X86)
+constexpr AudioKernels::PcmKernels kAvx2S16{measureS16AVX2, toFloatS16AVX2, fromFloatS16AVX2,
+                                            applyGainS16AVX2, firstAboveS16AVX2, lastAboveS16AVX2};
+constexpr AudioKernels::PcmKernels kAvx2F32{measureF32AVX2, toFloatF32Scalar, fromFloatF32,
+                                            applyGainF32AVX2, firstAboveF32AVX2, lastAboveF32AVX2};
+#endif
+
+} // namespace
+
+AudioKernels::SimdLevel AudioKernels::simdLevel() {
+    int level = g_audioSimdLevel.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = static_cast<int>(isSupported(SimdLevel::AVX2) ? SimdLevel::AVX2 : SimdLevel::Scalar);
+        g_audioSimdLevel.store(level, std::memory_order_relaxed);
+    }
+    return static_cast<SimdLevel>(level);
+}
+
+void AudioKernels::setSimdLevel(SimdLevel level) {
+    g_audioSimdLevel.store(static_cast<int>(isSupported(level) ? level : SimdLevel::Scalar),
+                           std::memory_order_relaxed);
+}
+
+const char* AudioKernels::simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+const AudioKernels::PcmKernels& AudioKernels::kernels(AudioFormat format) {
+    const bool s16 = format == AudioFormat::S16;
+#if defined(NAW_AUDIO_X86)
+    if (simdLevel() == SimdLevel::AVX2) {
+        return s16 ? kAvx2S16 : kAvx2F32;
+    }
+#endif
+    return s16 ? kScalarS16 : kScalarF32;
+}
+
+} // namespace naw::desktop_pet::service::utils
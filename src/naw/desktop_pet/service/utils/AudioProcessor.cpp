@@ -1,5 +1,7 @@
 #include "naw/desktop_pet/service/utils/AudioProcessor.h"
 
+#include "naw/desktop_pet/service/utils/AudioKernels.h"
+
 #include <algorithm>
 #include <atomic>
 #include <chrono>
@@ -279,40 +281,15 @@ AudioStats AudioProcessor::analyzePcm(const AudioStreamConfig& stream, const voi
     st.frames = static_cast<std::uint64_t>(frames);
     st.durationSeconds = stream.sampleRate ? (static_cast<double>(frames) / static_cast<double>(stream.sampleRate)) : 0.0;
 
-    double accum = 0.0;
-    float peak = 0.0f;
-    std::size_t clippedCount = 0;
     const float clipThreshold = 0.999f;
+    PcmLevel level;
+    AudioKernels::kernels(stream.format).measure(pcm, samples, clipThreshold, level);
 
-    if (stream.format == AudioFormat::S16) {
-        const auto* p = static_cast<const std::int16_t*>(pcm);
-        for (std::size_t i = 0; i < samples; ++i) {
-            const float v = static_cast<float>(p[i]) / 32768.0f;
-            const float a = std::abs(v);
-            peak = std::max(peak, a);
-            accum += static_cast<double>(v) * static_cast<double>(v);
-            if (a >= clipThreshold) {
-                clippedCount++;
-            }
-        }
-    } else {
-        const auto* p = static_cast<const float*>(pcm);
-        for (std::size_t i = 0; i < samples; ++i) {
-            const float v = p[i];
-            const float a = std::abs(v);
-            peak = std::max(peak, a);
-            accum += static_cast<double>(v) * static_cast<double>(v);
-            if (a >= clipThreshold) {
-                clippedCount++;
-            }
-        }
-    }
-
-    const double rms = std::sqrt(accum / static_cast<double>(samples));
-    st.peakAbs = peak;
+    const double rms = std::sqrt(level.sumSquares / static_cast<double>(samples));
+    st.peakAbs = level.peak;
     st.rms = static_cast<float>(rms);
     st.dbfs = dbfsFromRms(static_cast<float>(rms));
-    st.clippedSampleRatio = samples ? static_cast<float>(static_cast<double>(clippedCount) / static_cast<double>(samples)) : 0.0f;
+    st.clippedSampleRatio = samples ? static_cast<float>(static_cast<double>(level.clipped) / static_cast<double>(samples)) : 0.0f;
 
     st.isSilent = (st.rms <= 1e-4f);
     st.isLikelyClipped = (st.peakAbs >= 0.999f && st.clippedSampleRatio >= 0.002f);
@@ -330,20 +307,7 @@ bool AudioProcessor::applyGainInPlace(const AudioStreamConfig& stream, std::vect
     }
     const std::size_t bps = bytesPerSampleFor(stream.format);
     const std::size_t samples = pcm.size() / bps;
-    if (stream.format == AudioFormat::S16) {
-        auto* p = reinterpret_cast<std::int16_t*>(pcm.data());
-        for (std::size_t i = 0; i < samples; ++i) {
-            const float v = static_cast<float>(p[i]) * gain;
-            const float clamped = std::min(32767.0f, std::max(-32768.0f, v));
-            p[i] = static_cast<std::int16_t>(std::lrint(clamped));
-        }
-    } else {
-        auto* p = reinterpret_cast<float*>(pcm.data());
-        for (std::size_t i = 0; i < samples; ++i) {
-            const float v = p[i] * gain;
-            p[i] = std::isfinite(v) ? v : 0.0f;
-        }
-    }
+    AudioKernels::kernels(stream.format).applyGain(pcm.data(), samples, gain);
     return true;
 }
 
@@ -415,9 +379,7 @@ bool AudioProcessor::initialize(const AudioStreamConfig& playbackConfig) {
 void AudioProcessor::shutdown() {
     stopAll();
 
-    if (captureDevice_ != nullptr) {
-        stopCapture();
-    }
+    stopCapture();
     
     // *** 清理 VAD 文件 ***
     cleanupOldVadFiles();
@@ -433,15 +395,6 @@ void AudioProcessor::shutdown() {
         captureContext_ = nullptr;
     }
 
-    // *** 清理输出音频缓冲区 ***
-    {
-        std::lock_guard<std::mutex> lock(outputBuffer_.mutex);
-        outputBuffer_.data.clear();
-        outputBuffer_.capacityBytes = 0;
-        outputBuffer_.sizeBytes = 0;
-        outputBuffer_.writePos = 0;
-    }
-    
     isPlaying_.store(false);
     engine_ = nullptr;
     initialized_ = false;
@@ -482,7 +435,6 @@ std::optional<std::uint32_t> AudioProcessor::playFile(const std::string& path, c
     addSoundHandle(id, sound);
     ma_sound_start(sound);
     isPlaying_.store(true);
-    ensureOutputBufferCapacity(playbackConfig_);
     return id;
 }
 
@@ -522,7 +474,6 @@ std::optional<std::uint32_t> AudioProcessor::playMemory(const void* data, std::s
     }
     ma_sound_start(sound);
     isPlaying_.store(true);
-    ensureOutputBufferCapacity(playbackConfig_);
     return id;
 }
 
@@ -570,7 +521,6 @@ std::optional<std::uint32_t> AudioProcessor::startStream(const AudioStreamConfig
     }
     ma_sound_start(sound);
     isPlaying_.store(true);
-    ensureOutputBufferCapacity(cfg);
     return id;
 }
 
@@ -733,44 +683,124 @@ void AudioProcessor::dataCallbackCapture(void* pUserData, const void* pInput, st
 }
 
 void AudioProcessor::onCaptureFrames(const void* pInput, std::uint32_t frameCount) {
-    if (!capturing_ || pInput == nullptr) {
+    // 设备回调线程：只做电平计量与无锁环形缓冲写入，不加锁、不分配内存、不做 I/O
+    if (!capturing_.load(std::memory_order_acquire) || pInput == nullptr || frameCount == 0) {
         return;
     }
 
+    captureFramesTotal_.fetch_add(frameCount, std::memory_order_relaxed);
+    const auto samples = static_cast<std::size_t>(frameCount) * captureOptions_.stream.channels;
+    PcmLevel level;
+    captureKernels_->measure(pInput, samples, 2.0f, level);
+    capturePeak_.store(std::min(level.peak, 1.0f), std::memory_order_relaxed);
+    captureLevelDb_.store(dbfsFromRms(static_cast<float>(std::sqrt(level.sumSquares / static_cast<double>(samples)))),
+                          std::memory_order_relaxed);
+
+    const auto bytes = static_cast<std::size_t>(frameCount) * captureBytesPerFrame_;
+    if (!captureRing_.write(pInput, bytes)) {
+        // 消费线程跟不上：整块丢弃并计数，绝不在此等待
+        captureFramesDropped_.fetch_add(frameCount, std::memory_order_relaxed);
+        captureOverruns_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    captureSignal_.fetch_add(1, std::memory_order_release);
+    captureSignal_.notify_one();
+}
+
+namespace {
+// 当前线程若为某个 AudioProcessor 的录音消费线程，指向该实例
+thread_local const AudioProcessor* tlsCaptureWorkerOwner = nullptr;
+} // namespace
+
+void AudioProcessor::captureWorkerLoop() {
+    tlsCaptureWorkerOwner = this;
+    const std::size_t bytesPerFrame = captureBytesPerFrame_;
+    const std::size_t blockFrames = std::max<std::uint32_t>(captureOptions_.stream.periodSizeInFrames, 256);
+    std::vector<std::uint8_t> block(blockFrames * bytesPerFrame);
+
+    for (;;) {
+        // 先取信号值再读空缓冲，之后的写入必然改变信号值，wait 不会错过唤醒
+        const auto signal = captureSignal_.load(std::memory_order_acquire);
+        std::size_t bytes = 0;
+        while ((bytes = captureRing_.read(block.data(), block.size())) > 0) {
+            processCaptureFrames(block.data(), static_cast<std::uint32_t>(bytes / bytesPerFrame));
+        }
+        if (!captureWorkerRunning_.load(std::memory_order_acquire)) {
+            break;
+        }
+        captureSignal_.wait(signal, std::memory_order_acquire);
+    }
+}
+
+void AudioProcessor::stopCaptureWorker() {
+    if (!captureWorker_.joinable()) {
+        return;
+    }
+    captureWorkerRunning_.store(false, std::memory_order_release);
+    captureSignal_.fetch_add(1, std::memory_order_release);
+    captureSignal_.notify_one();
+    captureWorker_.join();
+}
+
+CaptureRealtimeStats AudioProcessor::captureStats() const {
+    CaptureRealtimeStats stats;
+    stats.framesCaptured = captureFramesTotal_.load(std::memory_order_relaxed);
+    stats.framesDropped = captureFramesDropped_.load(std::memory_order_relaxed);
+    stats.overruns = captureOverruns_.load(std::memory_order_relaxed);
+    stats.levelDb = captureLevelDb_.load(std::memory_order_relaxed);
+    stats.peak = capturePeak_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioProcessor::processCaptureFrames(const void* pInput, std::uint32_t frameCount) {
     const auto bytesPerFrame = frameSizeBytes(captureOptions_.stream);
     const auto bytesToCopy = static_cast<std::size_t>(frameCount) * bytesPerFrame;
 
     if (passiveListening_) {
-        // VAD 模式：写环形缓冲，做能量检测和状态机
+        // VAD 模式：取第一声道转 float，先消除自身播放的回声，之后的检测、状态机与录音都基于残差
+        const std::uint32_t channels = captureOptions_.stream.channels == 0 ? 1 : captureOptions_.stream.channels;
+        monoScratch_.resize(frameCount);
+        captureKernels_->toFloat(pInput, frameCount, channels, monoScratch_.data());
+        if (vadConfig_.echoCanceller.enabled) {
+            pInput = cancelEcho(frameCount);
+        }
         const float db = computeDb(pInput, frameCount);
         lastDb_ = db;
-        
-        // 如果正在播放，先进行回声检测
-        if (isPlaying_.load()) {
-            float correlation = computeCorrelation(pInput, frameCount);
-            
-            if (correlation >= correlationThreshold_) {
-                // 高相关性：认为是回声，不触发VAD
-                pushRing(pInput, bytesToCopy);
-                return;  // 跳过VAD检测
-            } else if (db >= vadConfig_.startThresholdDb) {
-                // 低相关性但能量高：外部音频，停止播放
-                fadeOutAndStopAll();
-                isPlaying_.store(false);
-                // 继续执行VAD逻辑
-            }
+
+        // 语音判定：频谱 VAD（自适应噪声底 + 频谱平坦度 + 拖尾），或固定 dB 阈值
+        bool speech = false;
+        bool silence = false;
+        std::uint64_t voiced = 0;
+        if (vadConfig_.spectral.enabled) {
+            speech = vadDetector_.process(monoScratch_.data(), frameCount);
+            silence = !speech;
+            voiced = vadDetector_.voicedFrames() - lastVoicedFrames_;
+            lastVoicedFrames_ = vadDetector_.voicedFrames();
+            const auto& frame = vadDetector_.lastFrame();
+            std::lock_guard<std::mutex> lock(vadStatsMutex_);
+            vadStats_.levelDb = frame.levelDb;
+            vadStats_.noiseFloorDb = frame.noiseFloorDb;
+            vadStats_.snrDb = frame.snrDb;
+            vadStats_.flatness = frame.flatness;
+        } else {
+            speech = db >= vadConfig_.startThresholdDb;
+            silence = db <= vadConfig_.stopThresholdDb;
+            voiced = speech ? frameCount : 0;
         }
-        
+
         pushRing(pInput, bytesToCopy);
 
         // 状态机
         if (vadState_ == VADState::Listening) {
-            if (db >= vadConfig_.startThresholdDb) {
+            if (speech) {
                 currentAboveFrames_ += frameCount;
                 currentBelowFrames_ = 0;
+                pendingVoicedFrames_ += voiced;
                 if (currentAboveFrames_ >= startHoldFrames_) {
                     // 触发收集
                     vadState_ = VADState::Collecting;
+                    segmentVoicedFrames_ = pendingVoicedFrames_;
+                    pendingVoicedFrames_ = 0;
                     collectingBuffer_.clear();
                     // 预留近 maxBufferSeconds 的内容
                     const auto ringBytes = ring_.sizeBytes;
@@ -800,6 +830,18 @@ void AudioProcessor::onCaptureFrames(const void* pInput, std::uint32_t frameCoun
                                              static_cast<const std::uint8_t*>(pInput),
                                              static_cast<const std::uint8_t*>(pInput) + bytesToCopy);
 
+                    // 播放期间残差仍触发：用户在插话，淡出播放让出通道
+                    const bool bargeIn = isPlaying_.load();
+                    if (bargeIn) {
+                        fadeOutAndStopAll();
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(vadStatsMutex_);
+                        vadStats_.triggers++;
+                        if (bargeIn) {
+                            vadStats_.bargeIns++;
+                        }
+                    }
                     if (vadCallbacks_.onTrigger) {
                         vadCallbacks_.onTrigger();
                     }
@@ -808,6 +850,7 @@ void AudioProcessor::onCaptureFrames(const void* pInput, std::uint32_t frameCoun
                 }
             } else {
                 currentAboveFrames_ = 0;
+                pendingVoicedFrames_ = 0;
             }
             return;
         }
@@ -818,25 +861,65 @@ void AudioProcessor::onCaptureFrames(const void* pInput, std::uint32_t frameCoun
                                      static_cast<const std::uint8_t*>(pInput),
                                      static_cast<const std::uint8_t*>(pInput) + bytesToCopy);
 
-            if (db <= vadConfig_.stopThresholdDb) {
+            segmentVoicedFrames_ += voiced;
+            if (silence) {
                 currentBelowFrames_ += frameCount;
             } else {
                 currentBelowFrames_ = 0;
             }
 
             if (currentBelowFrames_ >= stopHoldFrames_) {
+                // 有效语音太短（敲击、咳嗽等瞬态）：不上传，计为误触发
+                if (segmentVoicedFrames_ < minSpeechFrames_) {
+                    std::cout << "[VAD] skip short segment\n";
+                    collectingBuffer_.clear();
+                    {
+                        std::lock_guard<std::mutex> lock(vadStatsMutex_);
+                        vadStats_.falseTriggers++;
+                    }
+                    currentBelowFrames_ = 0;
+                    currentAboveFrames_ = 0;
+                    vadState_ = VADState::Listening;
+                    return;
+                }
+
                 // *** 关键修复：生成唯一文件名 ***
                 AudioStreamConfig stream = captureOptions_.stream;
                 std::vector<std::uint8_t> pcm = std::move(collectingBuffer_);
-                // 裁剪前后静音，避免播放空白
-                if (!trimSilence(stream, pcm, vadConfig_.stopThresholdDb)) {
+                // 裁剪前后静音，避免播放空白；频谱 VAD 下阈值不高于噪声底 + 6dB，安静环境中的轻声不会被整段裁掉
+                float trimDb = vadConfig_.stopThresholdDb;
+                if (vadConfig_.spectral.enabled) {
+                    trimDb = std::min(trimDb, vadDetector_.lastFrame().noiseFloorDb + 6.0f);
+                }
+                if (!trimSilence(stream, pcm, trimDb)) {
                     std::cout << "[VAD] skip silent segment\n";
+                    {
+                        std::lock_guard<std::mutex> lock(vadStatsMutex_);
+                        vadStats_.falseTriggers++;
+                    }
                     currentBelowFrames_ = 0;
                     currentAboveFrames_ = 0;
                     vadState_ = VADState::Listening;
                     return;
                 }
+                {
+                    std::lock_guard<std::mutex> lock(vadStatsMutex_);
+                    vadStats_.segments++;
+                }
                 
+                // 内存交付：不落盘，由上层直接上传
+                // 分离线程只持有回调副本与片段，不访问 this（AudioProcessor 可能先于线程析构）
+                if (vadCallbacks_.onSegment) {
+                    std::thread([cb = vadCallbacks_.onSegment, clip = CapturedBuffer{stream, std::move(pcm)}]() {
+                        cb(clip);
+                    }).detach();
+                    currentBelowFrames_ = 0;
+                    currentAboveFrames_ = 0;
+                    resetRingAfterCapture(frameSizeBytes(stream), 0.5);
+                    vadState_ = VADState::Listening;
+                    return;
+                }
+
                 // 生成唯一的输出路径（带时间戳和计数器）
                 const std::string outPath = generateUniqueVadPath(vadConfig_.outputWavPath);
                 auto writePromise = std::make_shared<std::promise<void>>();
@@ -892,9 +975,17 @@ void AudioProcessor::onCaptureFrames(const void* pInput, std::uint32_t frameCoun
 }
 
 bool AudioProcessor::startCapture(const CaptureOptions& opts) {
-    if (capturing_) {
+    if (tlsCaptureWorkerOwner == this) {
+        // 消费线程不能等待自身退出，也不能在仍在读取时重置环形缓冲
+        reportError(opts, AudioErrorCode::InvalidArgs, "startCapture: cannot restart capture from a capture callback");
+        return false;
+    }
+    std::lock_guard<std::mutex> control(captureControlMutex_);
+    if (capturing_.load(std::memory_order_acquire)) {
         return true;
     }
+    // 回收在回调中停止后尚未释放的设备与消费线程，保证环形缓冲始终只有一个读者
+    releaseCaptureLocked();
 
     // 确保存在用于枚举输入设备的上下文
     if (captureContext_ == nullptr) {
@@ -969,29 +1060,61 @@ bool AudioProcessor::startCapture(const CaptureOptions& opts) {
             captureBuffer_.reserve(captureOptions_.maxFramesInBuffer * bpf);
         }
     }
-    capturing_ = ma_device_start(device) == MA_SUCCESS;
-    if (!capturing_) {
+
+    // 按设备实际格式选定一次 DSP 内核，之后每个回调不再按样本判断格式
+    captureKernels_ = &AudioKernels::kernels(captureOptions_.stream.format);
+
+    // 环形缓冲至少容纳 1 秒或 8 个周期，吸收消费线程的短暂停顿
+    captureBytesPerFrame_ = frameSizeBytes(captureOptions_.stream);
+    const std::size_t ringFrames = std::max<std::size_t>(captureOptions_.stream.sampleRate,
+                                                         static_cast<std::size_t>(period) * 8);
+    captureRing_.reset(ringFrames * captureBytesPerFrame_);
+    captureFramesTotal_.store(0, std::memory_order_relaxed);
+    captureFramesDropped_.store(0, std::memory_order_relaxed);
+    captureOverruns_.store(0, std::memory_order_relaxed);
+    captureLevelDb_.store(-90.0f, std::memory_order_relaxed);
+    capturePeak_.store(0.0f, std::memory_order_relaxed);
+    captureWorkerRunning_.store(true, std::memory_order_release);
+    captureWorker_ = std::thread(&AudioProcessor::captureWorkerLoop, this);
+
+    capturing_.store(true, std::memory_order_release);
+    if (ma_device_start(device) != MA_SUCCESS) {
+        capturing_.store(false, std::memory_order_release);
+        stopCaptureWorker();
         ma_device_uninit(device);
         delete device;
         captureDevice_ = nullptr;
         reportError(opts, AudioErrorCode::DeviceStartFailed, "startCapture: ma_device_start failed");
+        return false;
     }
-    return capturing_;
+    return true;
 }
 
 void AudioProcessor::stopCapture() {
-    if (!capturing_ || captureDevice_ == nullptr) {
+    if (tlsCaptureWorkerOwner == this) {
+        // 在 onData/VAD 回调中停止：只停止接收新数据并让消费线程在本块处理完后退出，
+        // 设备与线程由下一次 startCapture/stopCapture/shutdown 在拥有方线程回收（不自我 join、不分离）
+        capturing_.store(false, std::memory_order_release);
+        captureWorkerRunning_.store(false, std::memory_order_release);
         return;
     }
+    std::lock_guard<std::mutex> control(captureControlMutex_);
+    releaseCaptureLocked();
+}
 
-    auto* device = toDevice(captureDevice_);
-    if (ma_device_stop(device) != MA_SUCCESS) {
-        reportError(captureOptions_, AudioErrorCode::DeviceStopFailed, "stopCapture: ma_device_stop failed");
+void AudioProcessor::releaseCaptureLocked() {
+    capturing_.store(false, std::memory_order_release);
+    if (captureDevice_ != nullptr) {
+        auto* device = toDevice(captureDevice_);
+        if (ma_device_stop(device) != MA_SUCCESS) {
+            reportError(captureOptions_, AudioErrorCode::DeviceStopFailed, "stopCapture: ma_device_stop failed");
+        }
+        ma_device_uninit(device);
+        delete device;
+        captureDevice_ = nullptr;
     }
-    ma_device_uninit(device);
-    delete device;
-    captureDevice_ = nullptr;
-    capturing_ = false;
+    // 设备已停止，不会再有写入；消费线程处理完剩余数据后退出，返回时已 join
+    stopCaptureWorker();
 
     if (captureContext_ != nullptr) {
         ma_context_uninit(toContext(captureContext_));
@@ -1110,32 +1233,50 @@ bool AudioProcessor::writePcmToWav(const std::string& path,
     return result == MA_SUCCESS && framesWritten == frames;
 }
 
+std::string AudioProcessor::wavHeader(const AudioStreamConfig& stream, std::size_t dataBytes) {
+    const std::size_t bps = bytesPerSampleFor(stream.format);
+    if (stream.channels == 0 || stream.sampleRate == 0 || dataBytes > 0xFFFFFFFFu - 36u) {
+        return {};
+    }
+    const auto blockAlign = static_cast<std::uint32_t>(bps * stream.channels);
+
+    std::string header;
+    header.reserve(44);
+    const auto put32 = [&header](std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) {
+            header.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+        }
+    };
+    const auto put16 = [&header](std::uint32_t v) {
+        header.push_back(static_cast<char>(v & 0xFF));
+        header.push_back(static_cast<char>((v >> 8) & 0xFF));
+    };
+    header.append("RIFF");
+    put32(static_cast<std::uint32_t>(36 + dataBytes));
+    header.append("WAVEfmt ");
+    put32(16);
+    put16(stream.format == AudioFormat::S16 ? 1u : 3u); // 1=PCM, 3=IEEE float
+    put16(stream.channels);
+    put32(stream.sampleRate);
+    put32(stream.sampleRate * blockAlign);
+    put16(blockAlign);
+    put16(static_cast<std::uint32_t>(bps * 8));
+    header.append("data");
+    put32(static_cast<std::uint32_t>(dataBytes));
+    return header;
+}
+
 float AudioProcessor::computeDb(const void* pcm, std::uint32_t frames) const {
     if (pcm == nullptr || frames == 0) {
         return -90.0f;
     }
 
-    const auto fmt = captureOptions_.stream.format;
-    const auto channels = captureOptions_.stream.channels;
-    const auto samples = static_cast<std::size_t>(frames) * channels;
-
-    double accum = 0.0;
+    const auto samples = static_cast<std::size_t>(frames) * captureOptions_.stream.channels;
+    const auto& kernels = captureKernels_ != nullptr ? *captureKernels_ : AudioKernels::kernels(captureOptions_.stream.format);
+    PcmLevel level;
+    kernels.measure(pcm, samples, 2.0f, level);
 
-    if (fmt == AudioFormat::S16) {
-        const auto* p = static_cast<const std::int16_t*>(pcm);
-        for (std::size_t i = 0; i < samples; ++i) {
-            const float v = static_cast<float>(p[i]) / 32768.0f;
-            accum += v * v;
-        }
-    } else {
-        const auto* p = static_cast<const float*>(pcm);
-        for (std::size_t i = 0; i < samples; ++i) {
-            const float v = p[i];
-            accum += v * v;
-        }
-    }
-
-    const double rms = std::sqrt(accum / static_cast<double>(samples));
+    const double rms = std::sqrt(level.sumSquares / static_cast<double>(samples));
     return dbfsFromRms(static_cast<float>(rms));
 }
 
@@ -1153,34 +1294,13 @@ bool AudioProcessor::trimSilence(const AudioStreamConfig& stream,
     const std::size_t bytesPerSample = ma_get_bytes_per_sample(toMiniaudioFormat(stream.format));
     const std::size_t totalSamples = pcm.size() / bytesPerSample;
 
-    auto sampleValue = [&](std::size_t idx) -> float {
-        if (stream.format == AudioFormat::S16) {
-            const auto* p = reinterpret_cast<const std::int16_t*>(pcm.data());
-            return std::abs(static_cast<float>(p[idx]) / 32768.0f);
-        }
-        const auto* p = reinterpret_cast<const float*>(pcm.data());
-        return std::abs(p[idx]);
-    };
-
-    std::size_t first = totalSamples;
-    for (std::size_t i = 0; i < totalSamples; ++i) {
-        if (sampleValue(i) >= threshold) {
-            first = i;
-            break;
-        }
-    }
+    const auto& kernels = AudioKernels::kernels(stream.format);
+    const std::size_t first = kernels.firstAbove(pcm.data(), totalSamples, threshold);
     if (first == totalSamples) {
         pcm.clear();
         return false; // 全部静音
     }
-
-    std::size_t last = 0;
-    for (std::size_t i = totalSamples; i-- > 0;) {
-        if (sampleValue(i) >= threshold) {
-            last = i;
-            break;
-        }
-    }
+    const std::size_t last = kernels.lastAbove(pcm.data(), totalSamples, threshold);
 
     const std::size_t startFrame = first / stream.channels;
     const std::size_t endFrame = last / stream.channels;
@@ -1307,6 +1427,25 @@ bool AudioProcessor::startPassiveListening(const VADConfig& vadCfg,
     startHoldFrames_ = static_cast<std::uint64_t>((static_cast<double>(vadConfig_.startHoldMs) / 1000.0) * sr);
     stopHoldFrames_ = static_cast<std::uint64_t>((static_cast<double>(vadConfig_.stopHoldMs) / 1000.0) * sr);
 
+    minSpeechFrames_ = static_cast<std::uint64_t>((static_cast<double>(vadConfig_.minSpeechMs) / 1000.0) * sr);
+    vadDetector_.configure(captureOptions_.stream.sampleRate, vadConfig_.spectral);
+    lastVoicedFrames_ = 0;
+    pendingVoicedFrames_ = 0;
+    segmentVoicedFrames_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(vadStatsMutex_);
+        vadStats_ = VADStats{};
+    }
+
+    // 回声消除器在消费线程进入 VAD 模式前配置好，之后才开放远端参考写入
+    disableFarEnd();
+    echoCanceller_.configure(captureOptions_.stream.sampleRate, vadConfig_.echoCanceller);
+    {
+        std::lock_guard<std::mutex> lock(echoStatsMutex_);
+        echoStats_ = echoCanceller_.stats();
+    }
+    farEndEnabled_.store(vadConfig_.echoCanceller.enabled);
+
     vadState_ = VADState::Listening;
     passiveListening_.store(true);
     return true;
@@ -1317,6 +1456,9 @@ void AudioProcessor::stopPassiveListening() {
         return;
     }
     passiveListening_.store(false);
+    disableFarEnd();
+    // 先停止录音（等待消费线程退出），再清理其访问的 VAD 状态
+    stopCapture();
     vadState_ = VADState::Idle;
     collectingBuffer_.clear();
     ring_.data.clear();
@@ -1325,7 +1467,6 @@ void AudioProcessor::stopPassiveListening() {
     ring_.writePos = 0;
     currentAboveFrames_ = 0;
     currentBelowFrames_ = 0;
-    stopCapture();
     
     // *** 停止时清理所有录音文件 ***
     cleanupOldVadFiles();
@@ -1410,26 +1551,13 @@ bool AudioProcessor::removeVadFile(const std::string& path) {
     }
 }
 
-// *** 回声抑制实现 ***
+// *** 回声消除实现 ***
 
-void AudioProcessor::ensureOutputBufferCapacity(const AudioStreamConfig& config) {
-    std::lock_guard<std::mutex> lock(outputBuffer_.mutex);
-    
-    // 计算需要的容量：保留 echoDelayMs_ + 一些余量（总共约500ms）
-    const std::uint32_t sampleRate = config.sampleRate != 0 ? config.sampleRate : 48000;
-    const std::size_t bytesPerFrame = frameSizeBytes(config);
-    const std::size_t targetBytes = static_cast<std::size_t>((500.0 / 1000.0) * sampleRate * bytesPerFrame);
-    
-    // 如果格式不匹配或容量不足，重新分配
-    if (outputBuffer_.capacityBytes < targetBytes || 
-        outputBuffer_.config.sampleRate != config.sampleRate ||
-        outputBuffer_.config.channels != config.channels ||
-        outputBuffer_.config.format != config.format) {
-        outputBuffer_.data.resize(targetBytes, 0);
-        outputBuffer_.capacityBytes = targetBytes;
-        outputBuffer_.writePos = 0;
-        outputBuffer_.sizeBytes = 0;
-        outputBuffer_.config = config;
+void AudioProcessor::disableFarEnd() {
+    farEndEnabled_.store(false);
+    // 与 recordOutputAudio 的“先登记、再检查开关”配对：此后不会再有新的写入
+    while (farEndWriters_.load() > 0) {
+        std::this_thread::yield();
     }
 }
 
@@ -1437,138 +1565,64 @@ void AudioProcessor::recordOutputAudio(const void* pcm, std::size_t bytes, const
     if (pcm == nullptr || bytes == 0) {
         return;
     }
-    
-    // 确保缓冲区容量足够（在锁外进行，避免死锁）
-    if (outputBuffer_.capacityBytes == 0 || outputBuffer_.config.sampleRate != config.sampleRate ||
-        outputBuffer_.config.channels != config.channels || outputBuffer_.config.format != config.format) {
-        ensureOutputBufferCapacity(config);
-    }
-    
-    std::lock_guard<std::mutex> lock(outputBuffer_.mutex);
-    
-    if (outputBuffer_.capacityBytes == 0) {
-        return;
-    }
-    
-    const auto* src = static_cast<const std::uint8_t*>(pcm);
-    std::size_t remaining = bytes;
-    
-    while (remaining > 0) {
-        const std::size_t space = outputBuffer_.capacityBytes - outputBuffer_.writePos;
-        const std::size_t chunk = std::min(space, remaining);
-        
-        std::copy(src, src + chunk, outputBuffer_.data.begin() + outputBuffer_.writePos);
-        outputBuffer_.writePos = (outputBuffer_.writePos + chunk) % outputBuffer_.capacityBytes;
-        src += chunk;
-        remaining -= chunk;
-        
-        outputBuffer_.sizeBytes = std::min(outputBuffer_.sizeBytes + chunk, outputBuffer_.capacityBytes);
+    farEndWriters_.fetch_add(1);
+    if (farEndEnabled_.load()) {
+        // 取第一声道转换为 float，分段写入回声消除器（栈上缓冲，不加锁、不分配）
+        const auto& kernels = AudioKernels::kernels(config.format);
+        const std::uint32_t channels = config.channels == 0 ? 1 : config.channels;
+        const std::size_t bytesPerFrame = frameSizeBytes(config);
+        const auto* src = static_cast<const std::uint8_t*>(pcm);
+        std::size_t frames = bytesPerFrame == 0 ? 0 : bytes / bytesPerFrame;
+        float mono[512];
+        while (frames > 0) {
+            const std::size_t chunk = std::min<std::size_t>(frames, 512);
+            kernels.toFloat(src, chunk, channels, mono);
+            echoCanceller_.pushFarEnd(mono, chunk, config.sampleRate);
+            src += chunk * bytesPerFrame;
+            frames -= chunk;
+        }
     }
+    farEndWriters_.fetch_sub(1);
 }
 
-float AudioProcessor::computeCorrelation(const void* inputPcm, std::uint32_t inputFrames) const {
-    if (inputPcm == nullptr || inputFrames == 0) {
-        return 0.0f;
-    }
-    
-    std::lock_guard<std::mutex> lock(outputBuffer_.mutex);
-    
-    if (outputBuffer_.sizeBytes == 0 || outputBuffer_.capacityBytes == 0) {
-        return 0.0f; // 没有输出音频可比较
-    }
-    
-    // 检查格式是否匹配（简化：只检查格式和声道数，采样率差异通过延迟补偿）
-    const auto inputFmt = captureOptions_.stream.format;
-    const auto inputChannels = captureOptions_.stream.channels;
-    const auto outputFmt = outputBuffer_.config.format;
-    const auto outputChannels = outputBuffer_.config.channels;
-    
-    // 如果格式不匹配，返回低相关性
-    if (inputFmt != outputFmt || inputChannels != outputChannels) {
-        return 0.0f;
-    }
-    
-    // 计算延迟帧数（回声延迟）
-    const std::uint32_t sampleRate = captureOptions_.stream.sampleRate != 0 ? captureOptions_.stream.sampleRate : 48000;
-    const std::uint32_t delayFrames = static_cast<std::uint32_t>((echoDelayMs_ / 1000.0) * sampleRate);
-    
-    const std::size_t bytesPerFrame = frameSizeBytes(captureOptions_.stream);
-    const std::size_t inputBytes = static_cast<std::size_t>(inputFrames) * bytesPerFrame;
-    
-    // 确保有足够的数据进行比较（需要至少 inputBytes + 延迟的数据）
-    const std::size_t requiredBytes = inputBytes + delayFrames * bytesPerFrame;
-    if (outputBuffer_.sizeBytes < requiredBytes) {
-        return 0.0f;
-    }
-    
-    // 从输出缓冲区中提取延迟后的数据
-    const std::size_t cap = outputBuffer_.capacityBytes;
-    const std::size_t startPos = (outputBuffer_.writePos + cap - outputBuffer_.sizeBytes + delayFrames * bytesPerFrame) % cap;
-    
-    // 计算归一化互相关（NCC）
-    double sumX = 0.0, sumY = 0.0, sumXY = 0.0, sumX2 = 0.0, sumY2 = 0.0;
-    std::size_t samples = 0;
-    
-    const std::size_t totalSamples = inputFrames * inputChannels;
-    const std::size_t bytesPerSample = bytesPerSampleFor(inputFmt);
-    
-    // 为了性能，只比较第一个声道
-    for (std::size_t i = 0; i < totalSamples; i += inputChannels) {
-        float x = 0.0f, y = 0.0f;
-        
-        // 读取输入样本（第一个声道）
-        if (inputFmt == AudioFormat::S16) {
-            const auto* p = static_cast<const std::int16_t*>(inputPcm);
-            x = static_cast<float>(p[i]) / 32768.0f;
-        } else {
-            const auto* p = static_cast<const float*>(inputPcm);
-            x = p[i];
-        }
-        
-        // 读取输出样本（第一个声道）
-        const std::size_t outputSampleIdx = i; // 样本索引（不是字节索引）
-        const std::size_t outputByteIdx = (startPos + outputSampleIdx * bytesPerSample) % cap;
-        
-        // 检查是否跨越边界
-        if (outputByteIdx + bytesPerSample <= cap) {
-            if (inputFmt == AudioFormat::S16) {
-                const auto* p = reinterpret_cast<const std::int16_t*>(outputBuffer_.data.data() + outputByteIdx);
-                y = static_cast<float>(p[0]) / 32768.0f;
-            } else {
-                const auto* p = reinterpret_cast<const float*>(outputBuffer_.data.data() + outputByteIdx);
-                y = p[0];
-            }
-        } else {
-            // 处理环形缓冲的边界情况：需要分两次读取
-            // 简化处理：跳过边界样本
-            continue;
+const void* AudioProcessor::cancelEcho(std::uint32_t frameCount) {
+    const auto& stream = captureOptions_.stream;
+    const std::uint32_t channels = stream.channels == 0 ? 1 : stream.channels;
+    const std::size_t bytesPerFrame = frameSizeBytes(stream);
+
+    echoCanceller_.process(monoScratch_.data(), frameCount);
+
+    residualPcm_.resize(static_cast<std::size_t>(frameCount) * bytesPerFrame);
+    if (channels == 1) {
+        captureKernels_->fromFloat(monoScratch_.data(), frameCount, residualPcm_.data());
+    } else {
+        echoInterleaved_.resize(static_cast<std::size_t>(frameCount) * channels);
+        for (std::uint32_t f = 0; f < frameCount; ++f) {
+            std::fill_n(echoInterleaved_.begin() + static_cast<std::ptrdiff_t>(f) * channels, channels, monoScratch_[f]);
         }
-        
-        sumX += x;
-        sumY += y;
-        sumXY += x * y;
-        sumX2 += x * x;
-        sumY2 += y * y;
-        samples++;
+        captureKernels_->fromFloat(echoInterleaved_.data(), echoInterleaved_.size(), residualPcm_.data());
     }
-    
-    if (samples == 0 || samples < 10) { // 至少需要10个样本
-        return 0.0f;
-    }
-    
-    // 计算 Pearson 相关系数
-    const double meanX = sumX / samples;
-    const double meanY = sumY / samples;
-    const double covXY = (sumXY / samples) - (meanX * meanY);
-    const double varX = (sumX2 / samples) - (meanX * meanX);
-    const double varY = (sumY2 / samples) - (meanY * meanY);
-    
-    if (varX <= 1e-9 || varY <= 1e-9) {
-        return 0.0f;
+
+    {
+        std::lock_guard<std::mutex> lock(echoStatsMutex_);
+        echoStats_ = echoCanceller_.stats();
     }
-    
-    const double correlation = covXY / std::sqrt(varX * varY);
-    return static_cast<float>(std::max(-1.0, std::min(1.0, correlation)));
+    return residualPcm_.data();
+}
+
+EchoCancellerStats AudioProcessor::echoCancellerStats() const {
+    std::lock_guard<std::mutex> lock(echoStatsMutex_);
+    return echoStats_;
+}
+
+VADStats AudioProcessor::vadStats() const {
+    std::lock_guard<std::mutex> lock(vadStatsMutex_);
+    return vadStats_;
+}
+
+void AudioProcessor::reportFalseTrigger() {
+    std::lock_guard<std::mutex> lock(vadStatsMutex_);
+    vadStats_.falseTriggers++;
 }
 
 void AudioProcessor::fadeOutAndStopAll() {
@@ -1587,9 +1641,10 @@ void AudioProcessor::fadeOutAndStopAll() {
     }
     
     // 对每个音频进行淡出
-    std::atomic<int> remaining{static_cast<int>(ids.size())};
+    // 计数器由各淡出线程共享持有，调用方返回后仍然有效
+    auto remaining = std::make_shared<std::atomic<int>>(static_cast<int>(ids.size()));
     for (auto id : ids) {
-        std::thread([this, id, &remaining]() {
+        std::thread([this, id, remaining]() {
             const float fadeDuration = 0.2f; // 200ms淡出
             const int steps = 20;
             const float stepVolume = 1.0f / steps;
@@ -1605,7 +1660,7 @@ void AudioProcessor::fadeOutAndStopAll() {
             }
             stop(id);
             
-            if (--remaining == 0) {
+            if (--*remaining == 0) {
                 isPlaying_.store(false);
             }
         }).detach();
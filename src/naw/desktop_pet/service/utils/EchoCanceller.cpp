@@ -0,0 +1,453 @@
+#include "naw/desktop_pet/service/utils/EchoCanceller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace naw::desktop_pet::service::utils {
+
+namespace {
+
+using Complex = Fft::Complex;
+
+// 直接展开的复数运算，避免 std::complex 乘法的 Inf/NaN 处理开销
+inline Complex mul(Complex a, Complex b) {
+    return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+}
+
+inline Complex mulConj(Complex a, Complex b) {
+    return {a.real() * b.real() + a.imag() * b.imag(), a.imag() * b.real() - a.real() * b.imag()};
+}
+
+inline float norm2(Complex a) { return a.real() * a.real() + a.imag() * a.imag(); }
+
+std::size_t nextPow2(std::size_t v) {
+    std::size_t p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+
+double energy(const float* x, std::size_t n) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += static_cast<double>(x[i]) * static_cast<double>(x[i]);
+    }
+    return sum;
+}
+
+constexpr float kFarActiveEnergyPerSample = 1e-8f;  // 约 -80 dBFS
+constexpr float kDelayConfidenceThreshold = 5.0f;   // GCC-PHAT 峰值/均值 低于此值不采信
+constexpr double kConvergedErleDb = 6.0;            // ERLE 超过此值视为滤波器已收敛
+constexpr std::uint32_t kDoubleTalkHoldBlocks = 8;  // 双讲判定后的保持块数
+constexpr std::uint32_t kDivergeBlocks = 8;         // 残差持续大于近端时重置滤波器
+
+} // namespace
+
+void EchoCanceller::configure(std::uint32_t sampleRate, const EchoCancellerConfig& config) {
+    m_config = config;
+    m_config.stepSize = std::clamp(m_config.stepSize, 0.01f, 1.0f);
+    m_sampleRate = sampleRate == 0 ? 48000u : sampleRate;
+
+    m_block = nextPow2(std::max<std::uint32_t>(config.blockSize, 32));
+    const std::size_t tailFrames = static_cast<std::size_t>(config.tailMs) * m_sampleRate / 1000;
+    m_partitions = std::max<std::size_t>(1, (tailFrames + m_block - 1) / m_block);
+    // 延迟估计的误差由滤波器前部吸收：整体延迟向前留出最多一个块
+    m_headroom = std::min(m_block, m_partitions * m_block / 4);
+
+    const std::size_t maxDelay = static_cast<std::size_t>(config.maxDelayMs) * m_sampleRate / 1000;
+    m_delayWindow = nextPow2(std::max(2 * maxDelay, 4 * m_block));
+    // 远端可能领先近端（播放缓冲），最多保留半秒，超出部分丢弃
+    m_maxFarAhead = m_sampleRate / 2;
+    const std::size_t history = nextPow2(m_delayWindow + maxDelay + (m_partitions + 3) * m_block + m_maxFarAhead);
+    m_farHistory.assign(history, 0.0f);
+    m_micHistory.assign(history, 0.0f);
+    m_historyMask = history - 1;
+
+    // 远端参考环形缓冲：按 48kHz 及以上留 1 秒
+    m_farRing.reset(std::max<std::size_t>(m_sampleRate, 48000) * sizeof(float));
+    m_farRaw.reserve(m_sampleRate);
+
+    m_fft = Fft(2 * m_block);
+    const std::size_t bins = m_fft.bins();
+    m_weights.assign(m_partitions * bins, Complex{});
+    m_farSpectra.assign(m_partitions * bins, Complex{});
+    m_power.assign(bins, 0.0f);
+    m_timeBuf.assign(2 * m_block, 0.0f);
+    m_specBuf.assign(bins, Complex{});
+    m_errSpec.assign(bins, Complex{});
+
+    m_delayFft = Fft(2 * m_delayWindow);
+    m_delayMic.assign(2 * m_delayWindow, 0.0f);
+    m_delayFar.assign(2 * m_delayWindow, 0.0f);
+    m_delayMicSpec.assign(m_delayFft.bins(), Complex{});
+    m_delayFarSpec.assign(m_delayFft.bins(), Complex{});
+    m_delayCorr.assign(2 * m_delayWindow, 0.0f);
+
+    reset();
+}
+
+void EchoCanceller::reset() {
+    float discard[256];
+    while (m_farRing.read(discard, sizeof(discard)) > 0) {
+    }
+    m_farRaw.clear();
+    m_resamplePos = 0.0;
+    m_resamplePrev = 0.0f;
+    m_farWritePos = 0;
+    m_farJitter = m_block;
+
+    m_inFifo.clear();
+    // 输出固定延迟一个块：预先放入 N 个0
+    m_outFifo.assign(m_block, 0.0f);
+    m_outHead = 0;
+
+    std::fill(m_farHistory.begin(), m_farHistory.end(), 0.0f);
+    std::fill(m_micHistory.begin(), m_micHistory.end(), 0.0f);
+    m_frames = 0;
+    const std::size_t initialDelay = static_cast<std::size_t>(m_config.initialDelayMs) * m_sampleRate / 1000;
+    m_bulkDelay = initialDelay > m_headroom ? initialDelay - m_headroom : 0;
+    m_lastFarActive = 0;
+    m_hasFarActivity = false;
+
+    resetFilter();
+    std::fill(m_power.begin(), m_power.end(), 0.0f);
+    m_micPowerSmoothed = 0.0;
+    m_errPowerSmoothed = 0.0;
+    m_doubleTalkHold = 0;
+    m_divergeCount = 0;
+
+    m_nextDelayUpdate = m_delayWindow;
+    m_pendingDelay = 0;
+    m_pendingVotes = 0;
+
+    m_stats = EchoCancellerStats{};
+    m_farRingDropped.store(0, std::memory_order_relaxed);
+    m_stats.delayMs = static_cast<float>(m_config.initialDelayMs);
+}
+
+void EchoCanceller::resetFilter() {
+    std::fill(m_weights.begin(), m_weights.end(), Complex{});
+    std::fill(m_farSpectra.begin(), m_farSpectra.end(), Complex{});
+    m_spectraHead = 0;
+    m_constrainIndex = 0;
+    m_micPowerSmoothed = 0.0;
+    m_errPowerSmoothed = 0.0;
+}
+
+bool EchoCanceller::pushFarEnd(const float* mono, std::size_t frames, std::uint32_t sampleRate) {
+    if (m_sampleRate == 0 || mono == nullptr || frames == 0) {
+        return false;
+    }
+    m_farRate.store(sampleRate == 0 ? m_sampleRate : sampleRate, std::memory_order_relaxed);
+    if (!m_farRing.write(mono, frames * sizeof(float))) {
+        m_farRingDropped.fetch_add(frames, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void EchoCanceller::appendFarSample(float sample) {
+    if (m_farWritePos >= m_frames + m_maxFarAhead) {
+        m_stats.farEndDropped++;
+        return;
+    }
+    m_farHistory[m_farWritePos & m_historyMask] = sample;
+    m_farWritePos++;
+}
+
+void EchoCanceller::drainFarEnd() {
+    for (;;) {
+        const std::size_t available = m_farRing.size() / sizeof(float);
+        if (available == 0) {
+            break;
+        }
+        const std::size_t offset = m_farRaw.size();
+        m_farRaw.resize(offset + available);
+        const std::size_t bytes = m_farRing.read(m_farRaw.data() + offset, available * sizeof(float));
+        m_farRaw.resize(offset + bytes / sizeof(float));
+    }
+    if (m_farRaw.empty()) {
+        return;
+    }
+
+    // 远端落后近端超过抖动余量（播放中断）：中间补0，从当前近端位置继续；
+    // 余量以内视为回调抖动，继续顺序写入，迟到的样本仍落在原来的位置
+    if (m_farWritePos + m_farJitter < m_frames) {
+        for (std::uint64_t i = m_farWritePos; i < m_frames && i < m_farWritePos + m_farHistory.size(); ++i) {
+            m_farHistory[i & m_historyMask] = 0.0f;
+        }
+        if (m_farWritePos > 0) {
+            m_stats.farEndGaps++;
+        }
+        m_farWritePos = m_frames;
+    }
+
+    const std::uint32_t rate = m_farRate.load(std::memory_order_relaxed);
+    if (rate == 0 || rate == m_sampleRate) {
+        for (const float sample : m_farRaw) {
+            appendFarSample(sample);
+        }
+    } else {
+        // 线性插值重采样到近端采样率：位置 -1 表示上一批的最后一个样本
+        const double step = static_cast<double>(rate) / static_cast<double>(m_sampleRate);
+        const double last = static_cast<double>(m_farRaw.size() - 1);
+        double pos = m_resamplePos;
+        while (pos < last) {
+            const double floorPos = std::floor(pos);
+            const auto i = static_cast<std::ptrdiff_t>(floorPos);
+            const float frac = static_cast<float>(pos - floorPos);
+            const float a = i < 0 ? m_resamplePrev : m_farRaw[static_cast<std::size_t>(i)];
+            const float b = m_farRaw[static_cast<std::size_t>(i + 1)];
+            appendFarSample(a + (b - a) * frac);
+            pos += step;
+        }
+        m_resamplePos = pos - static_cast<double>(m_farRaw.size());
+    }
+    m_resamplePrev = m_farRaw.back();
+    m_farRaw.clear();
+}
+
+bool EchoCanceller::process(float* mic, std::size_t frames) {
+    if (!m_config.enabled || m_sampleRate == 0 || mic == nullptr || frames == 0) {
+        return false;
+    }
+    m_farJitter = std::max(m_farJitter, frames + m_block);
+    drainFarEnd();
+
+    m_inFifo.insert(m_inFifo.end(), mic, mic + frames);
+    std::size_t consumed = 0;
+    while (m_inFifo.size() - consumed >= m_block) {
+        const std::size_t offset = m_outFifo.size();
+        m_outFifo.resize(offset + m_block);
+        processBlock(m_inFifo.data() + consumed, m_outFifo.data() + offset);
+        consumed += m_block;
+    }
+    if (consumed > 0) {
+        m_inFifo.erase(m_inFifo.begin(), m_inFifo.begin() + static_cast<std::ptrdiff_t>(consumed));
+    }
+
+    std::copy_n(m_outFifo.begin() + static_cast<std::ptrdiff_t>(m_outHead), frames, mic);
+    m_outHead += frames;
+    if (m_outHead >= m_block) {
+        m_outFifo.erase(m_outFifo.begin(), m_outFifo.begin() + static_cast<std::ptrdiff_t>(m_outHead));
+        m_outHead = 0;
+    }
+    return m_stats.farEndActive;
+}
+
+void EchoCanceller::processBlock(const float* mic, float* out) {
+    const std::size_t n = m_block;
+    double farEnergy = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        m_micHistory[(m_frames + i) & m_historyMask] = mic[i];
+        const float far = farHistoryAt(m_frames + i);
+        farEnergy += static_cast<double>(far) * far;
+    }
+    if (farEnergy > kFarActiveEnergyPerSample * static_cast<double>(n)) {
+        m_lastFarActive = m_frames + n;
+        m_hasFarActivity = true;
+    }
+    m_frames += n;
+
+    if (m_frames >= m_nextDelayUpdate) {
+        estimateDelay();
+        m_nextDelayUpdate = m_frames + static_cast<std::uint64_t>(m_config.delayUpdateMs) * m_sampleRate / 1000;
+    }
+
+    // 远端信号影响 [bulk, bulk + headroom + tail) 之后的近端；超出范围则直通
+    const std::size_t reach = m_bulkDelay + m_headroom + m_partitions * n + n;
+    const bool active = m_hasFarActivity && m_frames - m_lastFarActive <= reach;
+    m_stats.farEndActive = active;
+    if (!active) {
+        std::copy_n(mic, n, out);
+        m_stats.doubleTalk = false;
+        return;
+    }
+
+    // 1. 最新远端块（延迟 bulk）的频谱放入分块历史
+    const std::size_t bins = m_fft.bins();
+    for (std::size_t i = 0; i < 2 * n; ++i) {
+        const std::uint64_t back = m_bulkDelay + 2 * n - i;
+        m_timeBuf[i] = m_frames >= back ? farHistoryAt(m_frames - back) : 0.0f;
+    }
+    m_spectraHead = (m_spectraHead + 1) % m_partitions;
+    Complex* newest = m_farSpectra.data() + m_spectraHead * bins;
+    m_fft.forward(m_timeBuf.data(), newest);
+    for (std::size_t k = 0; k < bins; ++k) {
+        m_power[k] = 0.9f * m_power[k] + 0.1f * norm2(newest[k]);
+    }
+
+    // 2. 回声估计 Y = Σ W_p · X_{t-p}，重叠保留取后半段
+    std::fill(m_specBuf.begin(), m_specBuf.end(), Complex{});
+    for (std::size_t p = 0; p < m_partitions; ++p) {
+        const Complex* x = m_farSpectra.data() + ((m_spectraHead + m_partitions - p) % m_partitions) * bins;
+        const Complex* w = m_weights.data() + p * bins;
+        for (std::size_t k = 0; k < bins; ++k) {
+            m_specBuf[k] += mul(w[k], x[k]);
+        }
+    }
+    m_fft.inverse(m_specBuf.data(), m_timeBuf.data());
+
+    double micPower = 0.0;
+    double errPower = 0.0;
+    double echoPower = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const float echo = m_timeBuf[n + i];
+        const float e = mic[i] - echo;
+        out[i] = e;
+        micPower += static_cast<double>(mic[i]) * mic[i];
+        errPower += static_cast<double>(e) * e;
+        echoPower += static_cast<double>(echo) * echo;
+    }
+
+    // 3. 收敛、双讲与发散判定
+    m_micPowerSmoothed = 0.95 * m_micPowerSmoothed + 0.05 * micPower;
+    m_errPowerSmoothed = 0.95 * m_errPowerSmoothed + 0.05 * errPower;
+    const double erle = 10.0 * std::log10((m_micPowerSmoothed + 1e-12) / (m_errPowerSmoothed + 1e-12));
+    m_stats.erleDb = static_cast<float>(erle);
+    if (erle > kConvergedErleDb && errPower > 0.5 * echoPower) {
+        // 已收敛时残差接近甚至超过回声估计：近端有语音
+        m_doubleTalkHold = kDoubleTalkHoldBlocks;
+    }
+    if (errPower > 2.0 * micPower + 1e-9) {
+        if (++m_divergeCount >= kDivergeBlocks) {
+            resetFilter();
+            m_divergeCount = 0;
+            std::copy_n(mic, n, out);
+            return;
+        }
+    } else {
+        m_divergeCount = 0;
+    }
+    m_stats.doubleTalk = m_doubleTalkHold > 0;
+    if (m_doubleTalkHold > 0) {
+        m_doubleTalkHold--;
+        return;
+    }
+
+    // 4. NLMS 更新：W_p += μ · E · conj(X_{t-p}) / (P · Pxx + δ)
+    std::fill(m_timeBuf.begin(), m_timeBuf.begin() + static_cast<std::ptrdiff_t>(n), 0.0f);
+    std::copy_n(out, n, m_timeBuf.begin() + static_cast<std::ptrdiff_t>(n));
+    m_fft.forward(m_timeBuf.data(), m_errSpec.data());
+    const float delta = 1e-6f * static_cast<float>(2 * n);
+    const float partitions = static_cast<float>(m_partitions);
+    for (std::size_t k = 0; k < bins; ++k) {
+        m_errSpec[k] *= m_config.stepSize / (partitions * m_power[k] + delta);
+    }
+    for (std::size_t p = 0; p < m_partitions; ++p) {
+        const Complex* x = m_farSpectra.data() + ((m_spectraHead + m_partitions - p) % m_partitions) * bins;
+        Complex* w = m_weights.data() + p * bins;
+        for (std::size_t k = 0; k < bins; ++k) {
+            w[k] += mulConj(m_errSpec[k], x[k]);
+        }
+    }
+
+    // 5. 梯度约束：每块轮流把一个分块的冲激响应后半段清零，保证线性卷积
+    Complex* w = m_weights.data() + m_constrainIndex * bins;
+    m_fft.inverse(w, m_timeBuf.data());
+    std::fill(m_timeBuf.begin() + static_cast<std::ptrdiff_t>(n), m_timeBuf.end(), 0.0f);
+    m_fft.forward(m_timeBuf.data(), w);
+    m_constrainIndex = (m_constrainIndex + 1) % m_partitions;
+}
+
+void EchoCanceller::estimateDelay() {
+    const std::size_t window = m_delayWindow;
+    if (m_frames < window || !m_hasFarActivity || m_frames - m_lastFarActive > window / 2) {
+        return;
+    }
+    const std::uint64_t start = m_frames - window;
+    for (std::size_t i = 0; i < window; ++i) {
+        m_delayMic[i] = m_micHistory[(start + i) & m_historyMask];
+        m_delayFar[i] = farHistoryAt(start + i);
+    }
+    std::fill(m_delayMic.begin() + static_cast<std::ptrdiff_t>(window), m_delayMic.end(), 0.0f);
+    std::fill(m_delayFar.begin() + static_cast<std::ptrdiff_t>(window), m_delayFar.end(), 0.0f);
+    if (energy(m_delayFar.data(), window) < kFarActiveEnergyPerSample * static_cast<double>(window) * 100.0 ||
+        energy(m_delayMic.data(), window) < kFarActiveEnergyPerSample * static_cast<double>(window)) {
+        return;
+    }
+
+    m_delayFft.forward(m_delayMic.data(), m_delayMicSpec.data());
+    m_delayFft.forward(m_delayFar.data(), m_delayFarSpec.data());
+
+    // PHAT 加权：只保留相位；远端几乎没有能量的频点置0，避免放大噪声
+    float maxFar = 0.0f;
+    for (const auto& f : m_delayFarSpec) {
+        maxFar = std::max(maxFar, norm2(f));
+    }
+    const float floorFar = maxFar * 1e-6f;
+    for (std::size_t k = 0; k < m_delayMicSpec.size(); ++k) {
+        if (norm2(m_delayFarSpec[k]) <= floorFar) {
+            m_delayMicSpec[k] = Complex{};
+            continue;
+        }
+        const Complex g = mulConj(m_delayMicSpec[k], m_delayFarSpec[k]);
+        const float mag = std::sqrt(norm2(g));
+        m_delayMicSpec[k] = mag > 1e-20f ? g / mag : Complex{};
+    }
+    m_delayFft.inverse(m_delayMicSpec.data(), m_delayCorr.data());
+
+    // r[τ] 对应 近端[n] ≈ 远端[n-τ]，只搜索非负延迟
+    const std::size_t maxDelay = std::min(window, static_cast<std::size_t>(m_config.maxDelayMs) * m_sampleRate / 1000);
+    std::size_t best = 0;
+    float bestValue = m_delayCorr[0];
+    double sumAbs = 0.0;
+    for (std::size_t tau = 0; tau <= maxDelay; ++tau) {
+        const float v = m_delayCorr[tau];
+        sumAbs += std::fabs(v);
+        if (v > bestValue) {
+            bestValue = v;
+            best = tau;
+        }
+    }
+    const double meanAbs = sumAbs / static_cast<double>(maxDelay + 1);
+    const float confidence = meanAbs > 0.0 ? static_cast<float>(bestValue / meanAbs) : 0.0f;
+    m_stats.delayConfidence = confidence;
+    if (confidence < kDelayConfidenceThreshold) {
+        return;
+    }
+
+    // 连续两次估计一致才采用，避免偶发的错误峰值打乱已收敛的滤波器
+    const std::size_t tolerance = m_block / 4;
+    const std::size_t diff = best > m_pendingDelay ? best - m_pendingDelay : m_pendingDelay - best;
+    if (m_pendingVotes > 0 && diff <= tolerance) {
+        m_pendingVotes++;
+    } else {
+        m_pendingDelay = best;
+        m_pendingVotes = 1;
+    }
+    if (m_pendingVotes >= 2) {
+        applyDelay(m_pendingDelay);
+    }
+}
+
+void EchoCanceller::applyDelay(std::size_t delaySamples) {
+    m_stats.delayMs = static_cast<float>(delaySamples) * 1000.0f / static_cast<float>(m_sampleRate);
+    // 延迟仍落在滤波器覆盖范围的前半段内时不动，由滤波器自身跟踪，避免打断已收敛的系数；
+    // 下界就是 m_bulkDelay，否则 m_bulkDelay 为0时小于下界的短延迟会被反复重新对齐、滤波器永不收敛
+    const std::size_t lower = m_bulkDelay;
+    const std::size_t upper = m_bulkDelay + m_headroom + m_partitions * m_block / 2;
+    if (delaySamples >= lower && delaySamples <= upper) {
+        return;
+    }
+    m_bulkDelay = delaySamples > m_headroom ? delaySamples - m_headroom : 0;
+    // 回声路径整体移动，旧的滤波器系数不再对齐
+    std::fill(m_weights.begin(), m_weights.end(), Complex{});
+    m_micPowerSmoothed = 0.0;
+    m_errPowerSmoothed = 0.0;
+
+    // 按新的延迟重建分块频谱历史，使下一块的回声估计立即对齐
+    const std::size_t bins = m_fft.bins();
+    const std::size_t n = m_block;
+    for (std::size_t p = 0; p < m_partitions; ++p) {
+        const std::size_t slot = (m_spectraHead + m_partitions - p) % m_partitions;
+        for (std::size_t i = 0; i < 2 * n; ++i) {
+            const std::uint64_t back = m_bulkDelay + (p + 2) * n - i;
+            m_timeBuf[i] = m_frames >= back ? farHistoryAt(m_frames - back) : 0.0f;
+        }
+        m_fft.forward(m_timeBuf.data(), m_farSpectra.data() + slot * bins);
+    }
+}
+
+} // namespace naw::desktop_pet::service::utils
@@ -0,0 +1,113 @@
+#include "naw/desktop_pet/service/utils/Fft.h"
+
+#include <cmath>
+#include <utility>
+
+namespace naw::desktop_pet::service::utils {
+
+namespace {
+
+// 直接展开的复数乘法：std::complex 的 operator* 为处理 Inf/NaN 会调用较慢的库函数
+inline Fft::Complex mul(Fft::Complex a, Fft::Complex b) {
+    return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+}
+
+} // namespace
+
+Fft::Fft(std::size_t size) {
+    m_size = 4;
+    while (m_size < size) {
+        m_size <<= 1;
+    }
+    const std::size_t half = m_size / 2;
+    const double pi = std::acos(-1.0);
+
+    m_twiddles.resize(half / 2);
+    for (std::size_t k = 0; k < m_twiddles.size(); ++k) {
+        const double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(half);
+        m_twiddles[k] = Complex(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+    m_realTwiddles.resize(half + 1);
+    for (std::size_t k = 0; k <= half; ++k) {
+        const double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(m_size);
+        m_realTwiddles[k] = Complex(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+
+    std::size_t bits = 0;
+    while ((std::size_t{1} << bits) < half) {
+        ++bits;
+    }
+    m_bitReverse.resize(half);
+    for (std::size_t i = 0; i < half; ++i) {
+        std::size_t r = 0;
+        for (std::size_t b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitReverse[i] = r;
+    }
+    m_work.resize(half);
+}
+
+void Fft::transform(Complex* data, bool inverse) const {
+    const std::size_t n = m_size / 2;
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t r = m_bitReverse[i];
+        if (i < r) {
+            std::swap(data[i], data[r]);
+        }
+    }
+    for (std::size_t len = 2; len <= n; len <<= 1) {
+        const std::size_t halfLen = len / 2;
+        const std::size_t step = n / len;
+        for (std::size_t start = 0; start < n; start += len) {
+            for (std::size_t j = 0; j < halfLen; ++j) {
+                Complex w = m_twiddles[j * step];
+                if (inverse) {
+                    w = std::conj(w);
+                }
+                const Complex t = mul(w, data[start + j + halfLen]);
+                data[start + j + halfLen] = data[start + j] - t;
+                data[start + j] += t;
+            }
+        }
+    }
+}
+
+void Fft::forward(const float* in, Complex* out) {
+    const std::size_t half = m_size / 2;
+    for (std::size_t i = 0; i < half; ++i) {
+        m_work[i] = Complex(in[2 * i], in[2 * i + 1]);
+    }
+    transform(m_work.data(), false);
+
+    // 拆分：偶样本谱 E = (Z[k] + conj(Z[m-k]))/2，奇样本谱 O = (Z[k] - conj(Z[m-k]))/(2i)
+    for (std::size_t k = 0; k <= half; ++k) {
+        const Complex z = m_work[k == half ? 0 : k];
+        const Complex zc = std::conj(m_work[k == 0 ? 0 : half - k]);
+        const Complex even = 0.5f * (z + zc);
+        const Complex diff = z - zc;
+        const Complex odd(0.5f * diff.imag(), -0.5f * diff.real());
+        out[k] = even + mul(m_realTwiddles[k], odd);
+    }
+}
+
+void Fft::inverse(const Complex* in, float* out) {
+    const std::size_t half = m_size / 2;
+    // 合并：E = (X[k] + conj(X[m-k]))/2，O = (X[k] - conj(X[m-k])) * conj(w^k)/2，Z = E + iO
+    for (std::size_t k = 0; k < half; ++k) {
+        const Complex x = in[k];
+        const Complex xc = std::conj(in[half - k]);
+        const Complex even = 0.5f * (x + xc);
+        const Complex odd = mul(0.5f * (x - xc), std::conj(m_realTwiddles[k]));
+        m_work[k] = Complex(even.real() - odd.imag(), even.imag() + odd.real());
+    }
+    transform(m_work.data(), true);
+
+    const float scale = 1.0f / static_cast<float>(half);
+    for (std::size_t i = 0; i < half; ++i) {
+        out[2 * i] = m_work[i].real() * scale;
+        out[2 * i + 1] = m_work[i].imag() * scale;
+    }
+}
+
+} // namespace naw::desktop_pet::service::utils
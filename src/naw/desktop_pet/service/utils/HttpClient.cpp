@@ -104,13 +104,13 @@ HttpResponse HttpClient::get(const std::string& path,
 }
 
 HttpResponse HttpClient::post(const std::string& path,
-                             const std::string& body,
+                             std::string body,
                              const std::string& contentType,
                              const std::map<std::string, std::string>& headers) {
     HttpRequest request;
     request.method = HttpMethod::POST;
     request.url = buildFullUrl(path);
-    request.body = body;
+    request.body = std::move(body);
     request.timeoutMs = m_timeoutMs;
     request.followRedirects = m_followRedirects;
     
@@ -405,8 +405,8 @@ HttpResponse HttpClient::postMultipart(const std::string& path,
         return false;
     };
 
-    std::ostringstream body;
-    // 文本字段
+    // 先校验并估算总长度，正文一次分配后顺序追加（文件数据只拷贝一次）
+    std::size_t total = boundary.size() + 8;
     for (const auto& [k, v] : fields) {
         if (hasCtrl(k) || hasCtrl(v)) {
             HttpResponse resp;
@@ -414,11 +414,8 @@ HttpResponse HttpClient::postMultipart(const std::string& path,
             resp.error = "Invalid multipart field";
             return resp;
         }
-        body << "--" << boundary << "\r\n";
-        body << "Content-Disposition: form-data; name=\"" << k << "\"\r\n\r\n";
-        body << v << "\r\n";
+        total += boundary.size() + k.size() + v.size() + 64;
     }
-    // 文件字段（简化：内存数据）
     for (const auto& [k, f] : files) {
         if (hasCtrl(k) || hasCtrl(f.filename) || hasCtrl(f.contentType)) {
             HttpResponse resp;
@@ -426,17 +423,37 @@ HttpResponse HttpClient::postMultipart(const std::string& path,
             resp.error = "Invalid multipart file field";
             return resp;
         }
-        body << "--" << boundary << "\r\n";
-        body << "Content-Disposition: form-data; name=\"" << k << "\"; filename=\"" << f.filename << "\"\r\n";
-        body << "Content-Type: " << (f.contentType.empty() ? "application/octet-stream" : f.contentType) << "\r\n\r\n";
-        body << f.data << "\r\n";
+        total += boundary.size() + k.size() + f.filename.size() + f.contentType.size() + f.data.size() + 128;
+        for (const auto& chunk : f.chunks) {
+            total += chunk.size();
+        }
+    }
+
+    std::string body;
+    body.reserve(total);
+    // 文本字段
+    for (const auto& [k, v] : fields) {
+        body.append("--").append(boundary).append("\r\n");
+        body.append("Content-Disposition: form-data; name=\"").append(k).append("\"\r\n\r\n");
+        body.append(v).append("\r\n");
+    }
+    // 文件字段
+    for (const auto& [k, f] : files) {
+        body.append("--").append(boundary).append("\r\n");
+        body.append("Content-Disposition: form-data; name=\"").append(k).append("\"; filename=\"").append(f.filename).append("\"\r\n");
+        body.append("Content-Type: ").append(f.contentType.empty() ? "application/octet-stream" : f.contentType).append("\r\n\r\n");
+        body.append(f.data);
+        for (const auto& chunk : f.chunks) {
+            body.append(chunk);
+        }
+        body.append("\r\n");
     }
-    body << "--" << boundary << "--\r\n";
+    body.append("--").append(boundary).append("--\r\n");
 
     auto mergedHeaders = mergeHeaders(headers);
     mergedHeaders["Content-Type"] = "multipart/form-data; boundary=" + boundary;
 
-    return post(path, body.str(), mergedHeaders["Content-Type"], mergedHeaders);
+    return post(path, std::move(body), mergedHeaders["Content-Type"], mergedHeaders);
 }
 
 // ========== 私有方法 ==========
@@ -1,12 +1,316 @@
 #include "naw/desktop_pet/service/utils/HttpSerialization.h"
 
 #include <array>
+#include <atomic>
 #include <sstream>
 #include <iomanip>
 #include <cctype>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NAW_BASE64_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NAW_TARGET_SSSE3
+#define NAW_TARGET_AVX2
+#else
+#define NAW_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define NAW_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
 namespace naw::desktop_pet::service::utils {
 
+namespace {
+
+constexpr char kBase64Table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+constexpr uint8_t kBase64Pad = 64;       // '='：解码结束
+constexpr uint8_t kBase64Invalid = 255;  // 非字母表字符
+
+constexpr std::array<uint8_t, 256> makeDecodeTable() {
+    std::array<uint8_t, 256> table{};
+    for (auto& v : table) {
+        v = kBase64Invalid;
+    }
+    for (uint8_t i = 0; i < 64; ++i) {
+        table[static_cast<uint8_t>(kBase64Table[i])] = i;
+    }
+    table[static_cast<uint8_t>('=')] = kBase64Pad;
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> kBase64DecodeTable = makeDecodeTable();
+
+// 标量编码完整的3字节组，返回已消耗的输入字节数
+size_t encodeBlocksScalar(const uint8_t* src, size_t size, char* dst) {
+    size_t i = 0;
+    while (i + 2 < size) {
+        const uint32_t triple = (uint32_t{src[i]} << 16) | (uint32_t{src[i + 1]} << 8) | src[i + 2];
+        dst[0] = kBase64Table[(triple >> 18) & 0x3F];
+        dst[1] = kBase64Table[(triple >> 12) & 0x3F];
+        dst[2] = kBase64Table[(triple >> 6) & 0x3F];
+        dst[3] = kBase64Table[triple & 0x3F];
+        dst += 4;
+        i += 3;
+    }
+    return i;
+}
+
+#if defined(NAW_BASE64_X86)
+
+// ========== SSSE3/AVX2 实现 ==========
+// 编码：每 12 字节输入在一个 128 位通道内重排为 16 个 6 位索引，再用 pshufb 查偏移表转成字符。
+// 解码：按高/低半字节查表同时完成字符校验与 6 位值还原，再用乘加把 4 个 6 位值拼成 3 字节。
+// 遇到非字母表字符（包括 '='）的块交给标量代码处理，由标量代码区分填充与非法字符。
+
+NAW_TARGET_SSSE3
+inline __m128i encodeUnpackSSSE3(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+NAW_TARGET_SSSE3
+inline __m128i encodeTranslateSSSE3(__m128i indices) {
+    __m128i offsetIndex = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i lessThan26 = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    offsetIndex = _mm_or_si128(offsetIndex, _mm_and_si128(lessThan26, _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                          '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, offsetIndex), indices);
+}
+
+NAW_TARGET_SSSE3
+size_t encodeBlocksSSSE3(const uint8_t* src, size_t size, char* dst) {
+    size_t i = 0;
+    // 每次读取16字节、使用其中12字节
+    for (; i + 16 <= size; i += 12, dst += 16) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), encodeTranslateSSSE3(encodeUnpackSSSE3(in)));
+    }
+    return i;
+}
+
+NAW_TARGET_AVX2
+size_t encodeBlocksAVX2(const uint8_t* src, size_t size, char* dst) {
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+        _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m256i offsets = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                      '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0));
+    size_t i = 0;
+    // 两个通道各处理12字节：低通道读 [i, i+16)，高通道读 [i+12, i+28)
+    for (; i + 28 <= size; i += 24, dst += 32) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        in = _mm256_shuffle_epi8(in, shuffle);
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i offsetIndex = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i lessThan26 = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        offsetIndex = _mm256_or_si256(offsetIndex, _mm256_and_si256(lessThan26, _mm256_set1_epi8(13)));
+        const __m256i chars = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, offsetIndex), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), chars);
+    }
+    return i;
+}
+
+// 字符校验表：lut_lo[低半字节] & lut_hi[高半字节] 非0 表示非字母表字符
+#define NAW_BASE64_LUT_LO 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, \
+                          0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+#define NAW_BASE64_LUT_HI 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, \
+                          0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+// 字符到6位值的偏移（按高半字节，'/' 单独修正）
+#define NAW_BASE64_LUT_ROLL 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+
+NAW_TARGET_SSSE3
+inline bool decodeCheckSSSE3(__m128i in, __m128i& hiNibbles) {
+    const __m128i lutLo = _mm_setr_epi8(NAW_BASE64_LUT_LO);
+    const __m128i lutHi = _mm_setr_epi8(NAW_BASE64_LUT_HI);
+    hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+    const __m128i loNibbles = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+    const __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lutLo, loNibbles), _mm_shuffle_epi8(lutHi, hiNibbles));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) == 0xFFFF;
+}
+
+NAW_TARGET_SSSE3
+size_t decodeBlocksSSSE3(const char* src, size_t size, uint8_t* dst, size_t dstSize) {
+    const __m128i lutRoll = _mm_setr_epi8(NAW_BASE64_LUT_ROLL);
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 16 <= size && o + 16 <= dstSize; i += 16, o += 12) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i hiNibbles;
+        if (!decodeCheckSSSE3(in, hiNibbles)) {
+            break;
+        }
+        const __m128i isSlash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+        in = _mm_add_epi8(in, _mm_shuffle_epi8(lutRoll, _mm_add_epi8(isSlash, hiNibbles)));
+        const __m128i pairs = _mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140));
+        const __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        const __m128i out = _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                                                  -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + o), out);
+    }
+    return i;
+}
+
+NAW_TARGET_AVX2
+size_t decodeBlocksAVX2(const char* src, size_t size, uint8_t* dst, size_t dstSize) {
+    const __m256i lutLo = _mm256_broadcastsi128_si256(_mm_setr_epi8(NAW_BASE64_LUT_LO));
+    const __m256i lutHi = _mm256_broadcastsi128_si256(_mm_setr_epi8(NAW_BASE64_LUT_HI));
+    const __m256i lutRoll = _mm256_broadcastsi128_si256(_mm_setr_epi8(NAW_BASE64_LUT_ROLL));
+    const __m256i pack = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 32 <= size && o + 32 <= dstSize; i += 32, o += 24) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+        const __m256i loNibbles = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+        if (!_mm256_testz_si256(_mm256_shuffle_epi8(lutLo, loNibbles), _mm256_shuffle_epi8(lutHi, hiNibbles))) {
+            break;
+        }
+        const __m256i isSlash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+        in = _mm256_add_epi8(in, _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(isSlash, hiNibbles)));
+        const __m256i pairs = _mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140));
+        const __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        // 每个通道的12字节拼接到低24字节
+        const __m256i out = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(words, pack), lanes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + o), out);
+    }
+    return i;
+}
+
+// 只校验：返回从头开始连续的字母表字符所在的完整块长度
+NAW_TARGET_SSSE3
+size_t scanBlocksSSSE3(const char* src, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i hiNibbles;
+        if (!decodeCheckSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), hiNibbles)) {
+            break;
+        }
+    }
+    return i;
+}
+
+NAW_TARGET_AVX2
+size_t scanBlocksAVX2(const char* src, size_t size) {
+    const __m256i lutLo = _mm256_broadcastsi128_si256(_mm_setr_epi8(NAW_BASE64_LUT_LO));
+    const __m256i lutHi = _mm256_broadcastsi128_si256(_mm_setr_epi8(NAW_BASE64_LUT_HI));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask);
+        const __m256i loNibbles = _mm256_and_si256(in, mask);
+        if (!_mm256_testz_si256(_mm256_shuffle_epi8(lutLo, loNibbles), _mm256_shuffle_epi8(lutHi, hiNibbles))) {
+            break;
+        }
+    }
+    return i;
+}
+
+bool cpuSupports(Base64SimdLevel level) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    if (level == Base64SimdLevel::SSSE3) {
+        return (info[2] & (1 << 9)) != 0;
+    }
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (maxLeaf < 7 || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return level == Base64SimdLevel::SSSE3 ? __builtin_cpu_supports("ssse3") : __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // NAW_BASE64_X86
+
+bool isSupported(Base64SimdLevel level) {
+    switch (level) {
+        case Base64SimdLevel::Scalar:
+            return true;
+        case Base64SimdLevel::SSSE3:
+        case Base64SimdLevel::AVX2:
+#if defined(NAW_BASE64_X86)
+            return cpuSupports(level);
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+// -1 表示尚未检测
+std::atomic<int> g_base64SimdLevel{-1};
+
+// 编码完整的3字节组（SIMD 处理主体，标量处理剩余的组），返回已消耗的输入字节数
+size_t encodeBlocks(const uint8_t* src, size_t size, char* dst) {
+    size_t i = 0;
+#if defined(NAW_BASE64_X86)
+    switch (base64SimdLevel()) {
+        case Base64SimdLevel::AVX2:
+            i = encodeBlocksAVX2(src, size, dst);
+            break;
+        case Base64SimdLevel::SSSE3:
+            i = encodeBlocksSSSE3(src, size, dst);
+            break;
+        case Base64SimdLevel::Scalar:
+            break;
+    }
+#endif
+    return i + encodeBlocksScalar(src + i, size - i, dst + i / 3 * 4);
+}
+
+// 返回 text 中第一个 '=' 之前的字符数，遇到非法字符返回 std::nullopt
+std::optional<size_t> scanBase64(std::string_view text) {
+    size_t i = 0;
+#if defined(NAW_BASE64_X86)
+    switch (base64SimdLevel()) {
+        case Base64SimdLevel::AVX2:
+            i = scanBlocksAVX2(text.data(), text.size());
+            break;
+        case Base64SimdLevel::SSSE3:
+            i = scanBlocksSSSE3(text.data(), text.size());
+            break;
+        case Base64SimdLevel::Scalar:
+            break;
+    }
+#endif
+    for (; i < text.size(); ++i) {
+        const uint8_t v = kBase64DecodeTable[static_cast<uint8_t>(text[i])];
+        if (v == kBase64Pad) {
+            break;
+        }
+        if (v == kBase64Invalid) {
+            return std::nullopt;
+        }
+    }
+    return i;
+}
+
+} // namespace
+
 std::string encodeUrlComponent(const std::string& value) {
     auto isUnreserved = [](unsigned char c) {
         return std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~';
@@ -54,67 +358,63 @@ std::optional<nlohmann::json> parseJsonSafe(const std::string& text, std::string
     }
 }
 
-std::string encodeBase64(const std::vector<uint8_t>& data) {
-    static constexpr char kTable[] =
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    std::string out;
-    out.reserve(((data.size() + 2) / 3) * 4);
+void appendBase64(const uint8_t* data, size_t size, std::string& out) {
+    const size_t offset = out.size();
+    out.resize(offset + base64EncodedSize(size));
+    char* dst = out.data() + offset;
 
-    size_t i = 0;
-    while (i + 2 < data.size()) {
-        uint32_t triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
-        out.push_back(kTable[(triple >> 18) & 0x3F]);
-        out.push_back(kTable[(triple >> 12) & 0x3F]);
-        out.push_back(kTable[(triple >> 6) & 0x3F]);
-        out.push_back(kTable[triple & 0x3F]);
-        i += 3;
-    }
-
-    if (i < data.size()) {
-        uint32_t triple = 0;
-        triple |= data[i] << 16;
-        if (i + 1 < data.size()) {
-            triple |= data[i + 1] << 8;
-        }
-        out.push_back(kTable[(triple >> 18) & 0x3F]);
-        out.push_back(kTable[(triple >> 12) & 0x3F]);
-        if (i + 1 < data.size()) {
-            out.push_back(kTable[(triple >> 6) & 0x3F]);
-        } else {
-            out.push_back('=');
+    const size_t i = encodeBlocks(data, size, dst);
+    dst += i / 3 * 4;
+    if (i < size) {
+        uint32_t triple = uint32_t{data[i]} << 16;
+        if (i + 1 < size) {
+            triple |= uint32_t{data[i + 1]} << 8;
         }
-        out.push_back('=');
+        dst[0] = kBase64Table[(triple >> 18) & 0x3F];
+        dst[1] = kBase64Table[(triple >> 12) & 0x3F];
+        dst[2] = i + 1 < size ? kBase64Table[(triple >> 6) & 0x3F] : '=';
+        dst[3] = '=';
     }
+}
 
+std::string encodeBase64(const std::vector<uint8_t>& data) {
+    std::string out;
+    appendBase64(data.data(), data.size(), out);
     return out;
 }
 
 std::string encodeBase64(const std::string& data) {
-    return encodeBase64(std::vector<uint8_t>(data.begin(), data.end()));
-}
-
-std::optional<std::vector<uint8_t>> decodeBase64(const std::string& text) {
-    auto decodeChar = [](char c) -> int {
-        if (c >= 'A' && c <= 'Z') return c - 'A';
-        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
-        if (c >= '0' && c <= '9') return c - '0' + 52;
-        if (c == '+') return 62;
-        if (c == '/') return 63;
-        if (c == '=') return -1;
-        return -2; // invalid
-    };
-
-    std::vector<uint8_t> output;
-    output.reserve((text.size() / 4) * 3);
+    std::string out;
+    appendBase64(reinterpret_cast<const uint8_t*>(data.data()), data.size(), out);
+    return out;
+}
 
+std::optional<std::vector<uint8_t>> decodeBase64(std::string_view text) {
+    // 按上界分配，多留的空间供 SIMD 整块写入，结束时截断到实际长度
+    std::vector<uint8_t> output(text.size() / 4 * 3 + 3);
+    size_t i = 0;
+#if defined(NAW_BASE64_X86)
+    switch (base64SimdLevel()) {
+        case Base64SimdLevel::AVX2:
+            i = decodeBlocksAVX2(text.data(), text.size(), output.data(), output.size());
+            break;
+        case Base64SimdLevel::SSSE3:
+            i = decodeBlocksSSSE3(text.data(), text.size(), output.data(), output.size());
+            break;
+        case Base64SimdLevel::Scalar:
+            break;
+    }
+#endif
+    // SIMD 每块的字符数是4的倍数，剩余部分从完整的组边界开始
+    size_t o = i / 4 * 3;
     uint32_t buffer = 0;
     int bitsCollected = 0;
-    for (char c : text) {
-        int val = decodeChar(c);
-        if (val == -2) {
-            return std::nullopt; // invalid char
+    for (; i < text.size(); ++i) {
+        const uint8_t val = kBase64DecodeTable[static_cast<uint8_t>(text[i])];
+        if (val == kBase64Invalid) {
+            return std::nullopt;
         }
-        if (val == -1) {
+        if (val == kBase64Pad) {
             // padding; stop processing further chars
             break;
         }
@@ -122,10 +422,64 @@ std::optional<std::vector<uint8_t>> decodeBase64(const std::string& text) {
         bitsCollected += 6;
         if (bitsCollected >= 8) {
             bitsCollected -= 8;
-            output.push_back(static_cast<uint8_t>((buffer >> bitsCollected) & 0xFF));
+            output[o++] = static_cast<uint8_t>((buffer >> bitsCollected) & 0xFF);
         }
     }
+    output.resize(o);
     return output;
 }
 
+std::optional<size_t> base64DecodedSize(std::string_view text) {
+    const auto chars = scanBase64(text);
+    if (!chars) {
+        return std::nullopt;
+    }
+    // 每个字符6位，不足8位的尾部丢弃（与 decodeBase64 一致）
+    return *chars / 4 * 3 + (*chars % 4) * 3 / 4;
+}
+
+void Base64Encoder::update(const uint8_t* data, size_t size, std::string& out) {
+    if (m_pendingSize > 0) {
+        uint8_t group[3] = {m_pending[0], m_pending[1], 0};
+        while (m_pendingSize < 3 && size > 0) {
+            group[m_pendingSize++] = *data++;
+            --size;
+        }
+        if (m_pendingSize < 3) {
+            m_pending[0] = group[0];
+            m_pending[1] = group[1];
+            return;
+        }
+        appendBase64(group, 3, out);
+        m_pendingSize = 0;
+    }
+    const size_t whole = size / 3 * 3;
+    appendBase64(data, whole, out);
+    m_pendingSize = size - whole;
+    for (size_t k = 0; k < m_pendingSize; ++k) {
+        m_pending[k] = data[whole + k];
+    }
+}
+
+void Base64Encoder::finish(std::string& out) {
+    appendBase64(m_pending, m_pendingSize, out);
+    m_pendingSize = 0;
+}
+
+Base64SimdLevel base64SimdLevel() {
+    int level = g_base64SimdLevel.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = static_cast<int>(isSupported(Base64SimdLevel::AVX2)    ? Base64SimdLevel::AVX2
+                                 : isSupported(Base64SimdLevel::SSSE3) ? Base64SimdLevel::SSSE3
+                                                                       : Base64SimdLevel::Scalar);
+        g_base64SimdLevel.store(level, std::memory_order_relaxed);
+    }
+    return static_cast<Base64SimdLevel>(level);
+}
+
+void setBase64SimdLevel(Base64SimdLevel level) {
+    g_base64SimdLevel.store(static_cast<int>(isSupported(level) ? level : Base64SimdLevel::Scalar),
+                            std::memory_order_relaxed);
+}
+
 } // namespace naw::desktop_pet::service::utils
@@ -0,0 +1,197 @@
+#include "naw/desktop_pet/service/utils/VoiceActivityDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace naw::desktop_pet::service::utils {
+
+namespace {
+
+constexpr double kBandLowHz = 250.0;
+constexpr double kBandHighHz = 4000.0;
+constexpr std::size_t kBandCount = 8;
+constexpr double kNoiseFallRate = 0.3; // 低于噪声底时每帧向当前能量靠近的比例
+
+} // namespace
+
+void VoiceActivityDetector::configure(std::uint32_t sampleRate, const SpectralVadConfig& config) {
+    m_config = config;
+    if (m_config.stopSnrDb > m_config.startSnrDb) {
+        m_config.stopSnrDb = m_config.startSnrDb;
+    }
+    m_sampleRate = sampleRate == 0 ? 48000u : sampleRate;
+
+    // 帧长取不小于 20ms 的2的幂，帧移为一半
+    m_frameSize = 128;
+    while (m_frameSize < m_sampleRate / 50) {
+        m_frameSize <<= 1;
+    }
+    m_hop = m_frameSize / 2;
+    m_fft = Fft(m_frameSize);
+
+    const double pi = std::acos(-1.0);
+    m_window.resize(m_frameSize);
+    m_windowPower = 0.0;
+    for (std::size_t i = 0; i < m_frameSize; ++i) {
+        const double w = 0.5 - 0.5 * std::cos(2.0 * pi * static_cast<double>(i) / static_cast<double>(m_frameSize));
+        m_window[i] = static_cast<float>(w);
+        m_windowPower += w * w;
+    }
+
+    // 250–4000Hz（不超过奈奎斯特）按对数间隔划分，每个频带至少一个频点
+    const double binHz = static_cast<double>(m_sampleRate) / static_cast<double>(m_frameSize);
+    const std::size_t low = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(kBandLowHz / binHz)));
+    const std::size_t high = std::max(low + 1, std::min(m_fft.bins() - 1, static_cast<std::size_t>(kBandHighHz / binHz) + 1));
+    m_bandEdges.clear();
+    m_bandEdges.push_back(low);
+    for (std::size_t b = 1; b <= kBandCount; ++b) {
+        const double ratio = static_cast<double>(b) / static_cast<double>(kBandCount);
+        auto edge = static_cast<std::size_t>(std::lround(static_cast<double>(low) * std::pow(static_cast<double>(high) / static_cast<double>(low), ratio)));
+        edge = std::min(high, edge);
+        if (edge > m_bandEdges.back()) {
+            m_bandEdges.push_back(edge);
+        }
+    }
+    m_bandEnergy.assign(m_bandEdges.size() - 1, 0.0);
+    m_noise.assign(m_bandEdges.size() - 1, 0.0);
+
+    const double hopSeconds = static_cast<double>(m_hop) / static_cast<double>(m_sampleRate);
+    m_riseFactor = std::pow(10.0, m_config.noiseRiseDbPerSec * hopSeconds / 10.0);
+    m_speechRiseFactor = std::pow(10.0, 0.25 * m_config.noiseRiseDbPerSec * hopSeconds / 10.0);
+    m_hangoverFrames = static_cast<std::uint32_t>(std::ceil(m_config.hangoverMs / 1000.0 / hopSeconds));
+    m_calibrationFrames = std::max<std::uint32_t>(1, static_cast<std::uint32_t>(std::ceil(m_config.calibrationMs / 1000.0 / hopSeconds)));
+
+    m_pending.reserve(m_frameSize * 4);
+    m_timeBuf.assign(m_frameSize, 0.0f);
+    m_spec.assign(m_fft.bins(), Fft::Complex{});
+    reset();
+}
+
+void VoiceActivityDetector::reset() {
+    m_pending.clear();
+    m_pendingHead = 0;
+    std::fill(m_noise.begin(), m_noise.end(), 0.0);
+    m_framesSeen = 0;
+    m_hangover = 0;
+    m_speech = false;
+    m_voicedFrames = 0;
+    m_last = SpectralVadFrame{};
+}
+
+bool VoiceActivityDetector::process(const float* mono, std::size_t frames) {
+    if (m_frameSize == 0 || mono == nullptr) {
+        return m_speech;
+    }
+    for (std::size_t offset = 0; offset < frames;) {
+        // 分段追加，保证缓冲不超过预留容量
+        const std::size_t room = m_pending.capacity() - m_pending.size();
+        const std::size_t take = std::min(frames - offset, room);
+        m_pending.insert(m_pending.end(), mono + offset, mono + offset + take);
+        offset += take;
+        while (m_pending.size() - m_pendingHead >= m_frameSize) {
+            analyze(m_pending.data() + m_pendingHead);
+            m_pendingHead += m_hop;
+        }
+        m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<std::ptrdiff_t>(m_pendingHead));
+        m_pendingHead = 0;
+    }
+    return m_speech;
+}
+
+float VoiceActivityDetector::bandPowerToDb(double power) const {
+    // 单边谱能量 -> 时域均方（Parseval，扣除窗能量），与 RMS dBFS 同一标度
+    const double meanSquare = 2.0 * power / (static_cast<double>(m_frameSize) * m_windowPower);
+    return static_cast<float>(10.0 * std::log10(meanSquare + 1e-12));
+}
+
+void VoiceActivityDetector::analyze(const float* frame) {
+    for (std::size_t i = 0; i < m_frameSize; ++i) {
+        m_timeBuf[i] = frame[i] * m_window[i];
+    }
+    m_fft.forward(m_timeBuf.data(), m_spec.data());
+
+    const std::size_t bands = m_bandEnergy.size();
+    double total = 0.0;
+    for (std::size_t b = 0; b < bands; ++b) {
+        double sum = 0.0;
+        for (std::size_t k = m_bandEdges[b]; k < m_bandEdges[b + 1]; ++k) {
+            sum += static_cast<double>(std::norm(m_spec[k]));
+        }
+        m_bandEnergy[b] = sum;
+        total += sum;
+    }
+    const double minNoise = 1e-12 * static_cast<double>(m_frameSize) * m_windowPower;
+    m_last.levelDb = bandPowerToDb(total);
+
+    if (m_framesSeen < m_calibrationFrames) {
+        // 校准期：快速收敛到当前环境噪声
+        for (std::size_t b = 0; b < bands; ++b) {
+            m_noise[b] = m_framesSeen == 0 ? m_bandEnergy[b] : 0.5 * m_noise[b] + 0.5 * m_bandEnergy[b];
+            m_noise[b] = std::max(m_noise[b], minNoise);
+        }
+        m_framesSeen++;
+        double noiseTotal = 0.0;
+        for (const double n : m_noise) {
+            noiseTotal += n;
+        }
+        m_last.noiseFloorDb = bandPowerToDb(noiseTotal);
+        m_last.snrDb = 0.0f;
+        m_last.flatness = 1.0f;
+        m_last.voiced = false;
+        return;
+    }
+    m_framesSeen++;
+
+    // 频带平均信噪比与按噪声底白化后的频谱平坦度（几何均值/算术均值）
+    double snrSum = 0.0;
+    double logSum = 0.0;
+    double linSum = 0.0;
+    std::size_t bins = 0;
+    for (std::size_t b = 0; b < bands; ++b) {
+        const double ratio = m_bandEnergy[b] / m_noise[b];
+        snrSum += ratio > 1.0 ? 10.0 * std::log10(ratio) : 0.0;
+        const double perBinNoise = m_noise[b] / static_cast<double>(m_bandEdges[b + 1] - m_bandEdges[b]);
+        for (std::size_t k = m_bandEdges[b]; k < m_bandEdges[b + 1]; ++k) {
+            const double q = static_cast<double>(std::norm(m_spec[k])) / perBinNoise + 1e-9;
+            logSum += std::log(q);
+            linSum += q;
+            ++bins;
+        }
+    }
+    const double snrDb = snrSum / static_cast<double>(bands);
+    const double flatness = bins == 0 ? 1.0 : std::exp(logSum / static_cast<double>(bins)) / (linSum / static_cast<double>(bins));
+
+    const double threshold = m_speech ? m_config.stopSnrDb : m_config.startSnrDb;
+    const bool voiced = m_last.levelDb >= m_config.minLevelDb && snrDb >= threshold &&
+                        flatness <= static_cast<double>(m_config.maxFlatness);
+    if (voiced) {
+        m_hangover = m_hangoverFrames;
+        m_speech = true;
+        m_voicedFrames += m_hop;
+    } else if (m_hangover > 0) {
+        m_hangover--;
+    } else {
+        m_speech = false;
+    }
+
+    // 噪声底：低于时快速下降；高于时缓慢上升（语音帧更慢），且不超过当前能量
+    double noiseTotal = 0.0;
+    for (std::size_t b = 0; b < bands; ++b) {
+        double& noise = m_noise[b];
+        const double energy = m_bandEnergy[b];
+        if (energy < noise) {
+            noise += kNoiseFallRate * (energy - noise);
+        } else {
+            noise = std::min(energy, noise * (voiced ? m_speechRiseFactor : m_riseFactor));
+        }
+        noise = std::max(noise, minNoise);
+        noiseTotal += noise;
+    }
+
+    m_last.noiseFloorDb = bandPowerToDb(noiseTotal);
+    m_last.snrDb = static_cast<float>(snrDb);
+    m_last.flatness = static_cast<float>(flatness);
+    m_last.voiced = voiced;
+}
+
+} // namespace naw::desktop_pet::service::utils
@@ -1,18 +1,36 @@
 #include "naw/desktop_pet/service/utils/AudioProcessor.h"
+#include "naw/desktop_pet/service/utils/AudioKernels.h"
+#include "naw/desktop_pet/service/utils/EchoCanceller.h"
+#include "naw/desktop_pet/service/utils/Fft.h"
+#include "naw/desktop_pet/service/utils/SpscQueue.h"
+#include "naw/desktop_pet/service/utils/VoiceActivityDetector.h"
 
+#include <atomic>
 #include <cmath>
+#include <complex>
+#include <cstdlib>
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 #include <cstring>
 
 using naw::desktop_pet::service::utils::AudioErrorCode;
 using naw::desktop_pet::service::utils::AudioFormat;
+using naw::desktop_pet::service::utils::AudioKernels;
 using naw::desktop_pet::service::utils::AudioProcessor;
 using naw::desktop_pet::service::utils::AudioStreamConfig;
+using naw::desktop_pet::service::utils::EchoCanceller;
+using naw::desktop_pet::service::utils::EchoCancellerConfig;
+using naw::desktop_pet::service::utils::Fft;
+using naw::desktop_pet::service::utils::PcmLevel;
+using naw::desktop_pet::service::utils::SpectralVadConfig;
+using naw::desktop_pet::service::utils::SpscByteRing;
+using naw::desktop_pet::service::utils::VoiceActivityDetector;
 
 // 轻量断言工具（与 utils/tests/TokenCounterTest 保持一致风格）
 namespace mini_test {
@@ -149,6 +167,40 @@ static void testTrimSilence() {
     CHECK_TRUE(afterFrames > 0);
 }
 
+static void testWavHeader() {
+    const auto le32 = [](const std::string& h, std::size_t off) {
+        std::uint32_t v = 0;
+        for (int i = 3; i >= 0; --i) {
+            v = (v << 8) | static_cast<std::uint8_t>(h[off + static_cast<std::size_t>(i)]);
+        }
+        return v;
+    };
+    const auto le16 = [](const std::string& h, std::size_t off) {
+        return static_cast<std::uint32_t>(static_cast<std::uint8_t>(h[off])) |
+               (static_cast<std::uint32_t>(static_cast<std::uint8_t>(h[off + 1])) << 8);
+    };
+
+    const auto pcm = makeS16SinePcm(16000, 1, 0.1, 440.0, 0.5);
+    const auto h = AudioProcessor::wavHeader(makeCfg(AudioFormat::S16, 16000, 1), pcm.size());
+    CHECK_EQ(h.size(), std::size_t{44});
+    CHECK_TRUE(h.compare(0, 4, "RIFF") == 0 && h.compare(8, 8, "WAVEfmt ") == 0 && h.compare(36, 4, "data") == 0);
+    CHECK_EQ(le32(h, 4), static_cast<std::uint32_t>(36 + pcm.size()));
+    CHECK_EQ(le16(h, 20), 1u);     // PCM
+    CHECK_EQ(le16(h, 22), 1u);     // 声道
+    CHECK_EQ(le32(h, 24), 16000u); // 采样率
+    CHECK_EQ(le32(h, 28), 32000u); // 字节率
+    CHECK_EQ(le16(h, 32), 2u);     // 块对齐
+    CHECK_EQ(le16(h, 34), 16u);
+    CHECK_EQ(le32(h, 40), static_cast<std::uint32_t>(pcm.size()));
+
+    const auto f = AudioProcessor::wavHeader(makeCfg(AudioFormat::F32, 48000, 2), 4800);
+    CHECK_EQ(le16(f, 20), 3u); // IEEE float
+    CHECK_EQ(le16(f, 32), 8u);
+    CHECK_EQ(le16(f, 34), 32u);
+
+    CHECK_TRUE(AudioProcessor::wavHeader(makeCfg(AudioFormat::S16, 16000, 0), 100).empty());
+}
+
 static void testStreamErrorLastError() {
     AudioProcessor audio;
     CHECK_TRUE(audio.initialize());
@@ -172,12 +224,297 @@ static void testStreamErrorLastError() {
     audio.shutdown();
 }
 
+static void testCaptureByteRing() {
+    SpscByteRing ring(100); // 向上取整为 128
+    CHECK_EQ(ring.capacity(), static_cast<std::size_t>(128));
+
+    // 跨越环尾的写入/读取保持字节顺序
+    std::vector<std::uint8_t> in(96), out(96);
+    for (std::size_t i = 0; i < in.size(); ++i) in[i] = static_cast<std::uint8_t>(i);
+    CHECK_TRUE(ring.write(in.data(), in.size()));
+    CHECK_EQ(ring.read(out.data(), 64), static_cast<std::size_t>(64));
+    CHECK_TRUE(ring.write(in.data(), 64));
+    CHECK_EQ(ring.size(), static_cast<std::size_t>(96));
+    // 空间不足时整块拒绝，不写入部分数据
+    CHECK_TRUE(!ring.write(in.data(), 40));
+    CHECK_EQ(ring.size(), static_cast<std::size_t>(96));
+    CHECK_EQ(ring.read(out.data(), out.size()), static_cast<std::size_t>(96));
+    CHECK_EQ(out[0], static_cast<std::uint8_t>(64));
+    CHECK_EQ(out[32], static_cast<std::uint8_t>(0));
+    CHECK_EQ(out[95], static_cast<std::uint8_t>(63));
+    CHECK_EQ(ring.read(out.data(), out.size()), static_cast<std::size_t>(0));
+
+    // 生产者/消费者并发：模拟设备回调按整帧写入，满则计入丢帧
+    SpscByteRing shared(4096);
+    const std::size_t blockBytes = 64;
+    const std::size_t blocks = 20000;
+    std::atomic<std::size_t> dropped{0};
+    std::thread producer([&] {
+        std::vector<std::uint8_t> block(blockBytes);
+        for (std::size_t b = 0; b < blocks; ++b) {
+            for (std::size_t i = 0; i < blockBytes; ++i) block[i] = static_cast<std::uint8_t>(b);
+            if (!shared.write(block.data(), block.size())) dropped++;
+        }
+    });
+    std::size_t received = 0;
+    bool inOrder = true;
+    std::uint8_t lastTag = 0;
+    std::vector<std::uint8_t> chunk(blockBytes);
+    while (received + dropped.load() * blockBytes < blocks * blockBytes) {
+        if (shared.read(chunk.data(), chunk.size()) != chunk.size()) {
+            std::this_thread::yield();
+            continue;
+        }
+        // 每块内容一致，且块标签单调（丢块只会跳过，不会乱序）
+        for (auto v : chunk) inOrder = inOrder && v == chunk[0];
+        const auto tag = static_cast<std::uint8_t>(chunk[0] - lastTag);
+        inOrder = inOrder && (received == 0 || tag != 0);
+        lastTag = chunk[0];
+        received += chunk.size();
+    }
+    producer.join();
+    CHECK_TRUE(inOrder);
+    CHECK_EQ(received + dropped.load() * blockBytes, blocks * blockBytes);
+}
+
+static void testDspKernelsMatchScalar() {
+    // 覆盖满幅、-32768、静音段与非16整除的长度
+    const std::size_t n = 1000 + 13;
+    std::vector<std::int16_t> s16(n);
+    std::vector<float> f32(n);
+    std::srand(7);
+    for (std::size_t i = 0; i < n; ++i) {
+        const int r = (std::rand() % 65536) - 32768;
+        s16[i] = static_cast<std::int16_t>(i < 100 ? 0 : r);
+        f32[i] = i < 100 ? 0.0f : static_cast<float>(r) / 30000.0f; // 部分样本超出 [-1,1]
+    }
+    s16[500] = -32768;
+    s16[501] = 32767;
+
+    const auto saved = AudioKernels::simdLevel();
+    for (auto fmt : {AudioFormat::S16, AudioFormat::F32}) {
+        const void* pcm = fmt == AudioFormat::S16 ? static_cast<const void*>(s16.data()) : f32.data();
+        std::vector<PcmLevel> levels;
+        std::vector<std::size_t> firsts, lasts;
+        std::vector<std::vector<float>> converted, gained;
+        std::vector<std::vector<std::int16_t>> packed;
+        for (auto level : {AudioKernels::SimdLevel::Scalar, AudioKernels::SimdLevel::AVX2}) {
+            AudioKernels::setSimdLevel(level);
+            const auto& k = AudioKernels::kernels(fmt);
+            PcmLevel lv;
+            k.measure(pcm, n, 0.999f, lv);
+            levels.push_back(lv);
+            firsts.push_back(k.firstAbove(pcm, n, 0.5f));
+            lasts.push_back(k.lastAbove(pcm, n, 0.5f));
+            std::vector<float> fl(n);
+            k.toFloat(pcm, n, 1, fl.data());
+            converted.push_back(fl);
+            std::vector<std::int16_t> s(n);
+            AudioKernels::kernels(AudioFormat::S16).fromFloat(fl.data(), n, s.data());
+            packed.push_back(s);
+            std::vector<std::uint8_t> bytes(static_cast<const std::uint8_t*>(pcm),
+                                            static_cast<const std::uint8_t*>(pcm) + n * (fmt == AudioFormat::S16 ? 2 : 4));
+            k.applyGain(bytes.data(), n, 1.7f);
+            std::vector<float> g(n);
+            k.toFloat(bytes.data(), n, 1, g.data());
+            gained.push_back(g);
+        }
+        CHECK_EQ(levels[0].peak, levels[1].peak);
+        CHECK_EQ(levels[0].clipped, levels[1].clipped);
+        CHECK_TRUE(std::abs(levels[0].sumSquares - levels[1].sumSquares) <= 1e-5 * levels[0].sumSquares);
+        CHECK_EQ(firsts[0], firsts[1]);
+        CHECK_EQ(lasts[0], lasts[1]);
+        CHECK_TRUE(firsts[0] >= 100 && firsts[0] < n);
+        CHECK_TRUE(converted[0] == converted[1]);
+        CHECK_TRUE(packed[0] == packed[1]);
+        CHECK_TRUE(gained[0] == gained[1]);
+    }
+    CHECK_EQ(AudioKernels::kernels(AudioFormat::S16).firstAbove(s16.data(), 100, 0.01f), static_cast<std::size_t>(100));
+
+    AudioKernels::setSimdLevel(saved);
+}
+
+struct SyntheticEchoResult {
+    double erleDb{0.0};         // 远端单讲段的回声抑制量
+    double nearEndDiffDb{0.0};  // 近端单讲段输出与近端信号的能量差
+    float delayMs{0.0f};        // 估计的延迟
+};
+
+// 远端经 delay 个样本延迟与衰减的随机冲激响应到达麦克风，外加底噪；前5秒远端单讲，最后一秒近端单讲
+static SyntheticEchoResult runSyntheticEcho(std::uint32_t sr, std::size_t delay) {
+    const double pi = std::acos(-1.0);
+    const std::size_t total = sr * 6;
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<float> far(total, 0.0f), near(total, 0.0f), mic(total, 0.0f);
+    float lp = 0.0f;
+    for (std::size_t i = 0; i < sr * 5; ++i) {
+        lp = 0.7f * lp + 0.3f * noise(rng);
+        far[i] = 0.3f * lp;
+    }
+    std::vector<float> path(300);
+    for (std::size_t k = 0; k < path.size(); ++k) {
+        path[k] = 0.4f * std::exp(-static_cast<float>(k) / 50.0f) * noise(rng);
+    }
+    for (std::size_t i = sr * 5; i < total; ++i) {
+        near[i] = 0.1f * std::sin(static_cast<float>(2.0 * pi) * 300.0f * static_cast<float>(i) / sr);
+    }
+    for (std::size_t i = 0; i < total; ++i) {
+        float echo = 0.0f;
+        for (std::size_t k = 0; k < path.size() && k + delay <= i; ++k) {
+            echo += path[k] * far[i - delay - k];
+        }
+        mic[i] = echo + near[i] + 0.001f * noise(rng);
+    }
+
+    EchoCanceller aec;
+    EchoCancellerConfig cfg;
+    aec.configure(sr, cfg);
+    std::vector<float> out(mic);
+    const std::size_t period = 320;
+    for (std::size_t pos = 0; pos + period <= total; pos += period) {
+        CHECK_TRUE(aec.pushFarEnd(far.data() + pos, period, sr));
+        aec.process(out.data() + pos, period);
+    }
+    const std::size_t latency = cfg.blockSize;
+    auto energyDb = [](const float* x, std::size_t n) {
+        double sum = 1e-12;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += static_cast<double>(x[i]) * x[i];
+        }
+        return 10.0 * std::log10(sum);
+    };
+    SyntheticEchoResult result;
+    result.erleDb = energyDb(mic.data() + sr * 3, sr * 2) - energyDb(out.data() + sr * 3 + latency, sr * 2);
+    const std::size_t tail = sr * 5 + sr / 2;
+    result.nearEndDiffDb = std::abs(energyDb(out.data() + tail + latency, sr / 4) - energyDb(near.data() + tail, sr / 4));
+    result.delayMs = aec.stats().delayMs;
+    return result;
+}
+
+static void testEchoCanceller() {
+    const double pi = std::acos(-1.0);
+    // FFT：与直接 DFT 一致，逆变换还原
+    {
+        Fft fft(64);
+        std::vector<float> x(64), back(64);
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            x[i] = std::sin(0.37f * static_cast<float>(i)) + 0.25f * static_cast<float>(i % 5);
+        }
+        std::vector<Fft::Complex> spec(fft.bins());
+        fft.forward(x.data(), spec.data());
+        for (std::size_t k = 0; k < fft.bins(); k += 7) {
+            std::complex<double> ref;
+            for (std::size_t i = 0; i < x.size(); ++i) {
+                ref += std::polar(static_cast<double>(x[i]), -2.0 * pi * static_cast<double>(k * i) / 64.0);
+            }
+            CHECK_TRUE(std::abs(ref - std::complex<double>(spec[k])) < 1e-3);
+        }
+        fft.inverse(spec.data(), back.data());
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            CHECK_TRUE(std::abs(back[i] - x[i]) < 1e-5f);
+        }
+    }
+
+    // 40ms 延迟：延迟估计准确，近端单讲段应原样（延迟一个块）通过
+    const std::uint32_t sr = 16000;
+    auto longDelay = runSyntheticEcho(sr, 640);
+    CHECK_TRUE(longDelay.erleDb > 15.0);
+    CHECK_TRUE(std::abs(longDelay.delayMs - 40.0f) < 2.0f);
+    CHECK_TRUE(longDelay.nearEndDiffDb < 0.5);
+
+    // 短于一个块的延迟（0ms、1ms）同样要收敛，不能被反复重新对齐
+    for (const std::size_t delay : {std::size_t{0}, std::size_t{16}}) {
+        auto shortDelay = runSyntheticEcho(sr, delay);
+        CHECK_TRUE(shortDelay.erleDb > 15.0);
+        CHECK_TRUE(shortDelay.nearEndDiffDb < 0.5);
+    }
+
+    // 消费端停滞时参考缓冲写满，被拒绝的帧计入 farEndDropped
+    {
+        EchoCanceller stalled;
+        stalled.configure(sr, EchoCancellerConfig{});
+        std::vector<float> chunk(320, 0.1f);
+        std::size_t rejected = 0;
+        for (int i = 0; i < 400; ++i) {
+            if (!stalled.pushFarEnd(chunk.data(), chunk.size(), sr)) {
+                rejected += chunk.size();
+            }
+        }
+        CHECK_TRUE(rejected > 0);
+        CHECK_EQ(stalled.stats().farEndDropped, static_cast<std::uint64_t>(rejected));
+    }
+}
+
+static void testSpectralVad() {
+    // 风扇噪声（-37dBFS，超过旧的固定阈值）持续存在；3–4s 有键盘敲击；5–6.5s 有带谐波的“语音”
+    const double pi = std::acos(-1.0);
+    const std::uint32_t sr = 16000;
+    const std::size_t total = sr * 8;
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<float> x(total);
+    float lp = 0.0f;
+    for (std::size_t i = 0; i < total; ++i) {
+        lp = 0.95f * lp + 0.05f * noise(rng);
+        x[i] = 0.08f * lp + 0.01f * noise(rng);
+    }
+    for (std::size_t t = sr * 3; t < sr * 4; t += sr * 15 / 100) {
+        for (std::size_t j = 0; j < 80; ++j) {
+            x[t + j] += 0.3f * noise(rng) * std::exp(-static_cast<float>(j) / 15.0f);
+        }
+    }
+    for (std::size_t i = sr * 5; i < sr * 13 / 2; ++i) {
+        const double t = static_cast<double>(i) / sr;
+        const double f0 = 140.0 + 10.0 * std::sin(2.0 * pi * 3.0 * t);
+        double v = 0.0;
+        for (int h = 1; h * f0 < 3800.0; ++h) {
+            v += std::sin(2.0 * pi * h * f0 * t) / h;
+        }
+        x[i] += static_cast<float>(0.05 * v * (0.5 + 0.5 * std::sin(2.0 * pi * 4.0 * t)));
+    }
+
+    VoiceActivityDetector vad;
+    vad.configure(sr, SpectralVadConfig{});
+    const std::size_t period = 320;
+    std::uint64_t voicedNoise = 0;
+    std::uint64_t voicedClicks = 0;
+    std::uint64_t voicedSpeech = 0;
+    std::size_t speechBatches = 0;
+    for (std::size_t pos = 0; pos + period <= total; pos += period) {
+        const std::uint64_t before = vad.voicedFrames();
+        const bool speech = vad.process(x.data() + pos, period);
+        const std::uint64_t voiced = vad.voicedFrames() - before;
+        if (pos < sr * 3 || (pos >= sr * 4 && pos < sr * 5)) {
+            voicedNoise += voiced;
+            CHECK_TRUE(!speech);
+        } else if (pos < sr * 4) {
+            voicedClicks += voiced;
+        } else if (pos >= sr * 5 + sr / 10 && pos < sr * 13 / 2) {
+            voicedSpeech += voiced;
+            speechBatches += speech ? 1 : 0;
+        }
+    }
+    CHECK_EQ(voicedNoise, static_cast<std::uint64_t>(0));
+    // 敲击的有效语音远低于默认 minSpeechMs（250ms），不会被当作片段上传
+    CHECK_TRUE(voicedClicks < sr / 8);
+    CHECK_TRUE(voicedSpeech > sr / 2);
+    CHECK_TRUE(speechBatches * period > sr * 13 / 10);
+    // 噪声底跟踪到风扇电平附近
+    CHECK_TRUE(std::abs(vad.lastFrame().noiseFloorDb - (-44.0f)) < 6.0f);
+}
+
 int main() {
     std::vector<mini_test::TestCase> cases{
         {"Validate PCM buffer", testValidatePcm},
         {"Analyze/normalize/gain", testAnalyzeNormalizeGain},
         {"Trim silence", testTrimSilence},
+        {"WAV header in memory", testWavHeader},
         {"Stream error & lastError", testStreamErrorLastError},
+        {"Capture byte ring (SPSC)", testCaptureByteRing},
+        {"DSP kernels match scalar", testDspKernelsMatchScalar},
+        {"Echo canceller (FFT/NLMS/GCC-PHAT)", testEchoCanceller},
+        {"Spectral VAD (noise floor/flatness)", testSpectralVad},
     };
     return mini_test::run(cases);
 }
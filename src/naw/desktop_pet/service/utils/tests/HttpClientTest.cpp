@@ -4,6 +4,7 @@
 
 #include "httplib.h"
 
+#include <algorithm>
 #include <chrono>
 #include <future>
 #include <iostream>
@@ -216,6 +217,64 @@ int main() {
                          CHECK_EQ(round, data);
                      }});
 
+    tests.push_back({"Base64SimdMatchesScalar", []() {
+                         std::vector<uint8_t> data(1000);
+                         for (size_t i = 0; i < data.size(); ++i) {
+                             data[i] = static_cast<uint8_t>(i * 131 + 7);
+                         }
+                         const auto original = base64SimdLevel();
+                         setBase64SimdLevel(Base64SimdLevel::Scalar);
+                         std::vector<std::string> expected;
+                         for (size_t n = 0; n <= 100; ++n) {
+                             expected.push_back(encodeBase64(std::vector<uint8_t>(data.begin(), data.begin() + n)));
+                         }
+                         expected.push_back(encodeBase64(data));
+                         for (auto level : {Base64SimdLevel::Scalar, Base64SimdLevel::SSSE3, Base64SimdLevel::AVX2}) {
+                             setBase64SimdLevel(level);
+                             for (size_t n = 0; n < expected.size(); ++n) {
+                                 const size_t size = n <= 100 ? n : data.size();
+                                 std::vector<uint8_t> chunk(data.begin(), data.begin() + size);
+                                 CHECK_EQ(encodeBase64(chunk), expected[n]);
+                                 auto decoded = decodeBase64(expected[n]);
+                                 CHECK_TRUE(decoded.has_value());
+                                 CHECK_TRUE(*decoded == chunk);
+                             }
+                             // 非法字符出现在 SIMD 块内部时仍能被识别
+                             std::string bad = expected.back();
+                             bad[40] = '@';
+                             CHECK_TRUE(!decodeBase64(bad).has_value());
+                             CHECK_TRUE(!base64DecodedSize(bad).has_value());
+                         }
+                         setBase64SimdLevel(original);
+                     }});
+
+    tests.push_back({"Base64DecodedSizeMatchesDecode", []() {
+                         for (const std::string text : {"", "QQ", "QUI", "QUJD", "QUJDRA==", "QUJDRA", "QUJDRA=ignored",
+                                                        "Q", "QUJD\n"}) {
+                             auto decoded = decodeBase64(text);
+                             auto size = base64DecodedSize(text);
+                             CHECK_EQ(size.has_value(), decoded.has_value());
+                             if (decoded) {
+                                 CHECK_EQ(*size, decoded->size());
+                             }
+                         }
+                     }});
+
+    tests.push_back({"Base64EncoderStreaming", []() {
+                         std::string data = "streaming base64 encoder splits input at arbitrary boundaries";
+                         const auto expected = encodeBase64(data);
+                         const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+                         for (size_t chunk = 1; chunk <= 7; ++chunk) {
+                             Base64Encoder encoder;
+                             std::string out;
+                             for (size_t pos = 0; pos < data.size(); pos += chunk) {
+                                 encoder.update(bytes + pos, std::min(chunk, data.size() - pos), out);
+                             }
+                             encoder.finish(out);
+                             CHECK_EQ(out, expected);
+                         }
+                     }});
+
     tests.push_back({"MergeHeadersUsesDefaultWhenConflict", []() {
                          HttpClient client("https://example.com");
                          client.setDefaultHeader("User-Agent", "UA1");